@@ -16,6 +16,8 @@
 
 #include "location/lbs/contexthub/nanoapps/nearby/adv_report_cache.h"
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
 #include "chre_api/chre.h"
@@ -25,15 +27,43 @@
 
 namespace nearby {
 
+AdvReportCache &AdvReportCache::operator=(AdvReportCache &&other) {
+  if (&other == this) {
+    return *this;
+  }
+  Clear();
+  cache_reports_ = std::move(other.cache_reports_);
+  cache_entries_ = std::move(other.cache_entries_);
+  expiry_heap_ = std::move(other.expiry_heap_);
+  index_ = other.index_;
+  index_capacity_ = other.index_capacity_;
+  arena_ = other.arena_;
+  arena_size_ = other.arena_size_;
+  arena_capacity_ = other.arena_capacity_;
+  arena_garbage_size_ = other.arena_garbage_size_;
+  cache_expire_nanosec_ = other.cache_expire_nanosec_;
+  other.index_ = nullptr;
+  other.index_capacity_ = 0;
+  other.arena_ = nullptr;
+  other.arena_size_ = 0;
+  other.arena_capacity_ = 0;
+  other.arena_garbage_size_ = 0;
+  return *this;
+}
+
 void AdvReportCache::Clear() {
   // Release all resources.
-  for (const auto &report : cache_reports_) {
-    if (report.dataLength == 0) {
-      continue;
-    }
-    chreHeapFree(const_cast<uint8_t *>(report.data));
-  }
   cache_reports_.clear();
+  cache_entries_.clear();
+  expiry_heap_.clear();
+  chreHeapFree(index_);
+  index_ = nullptr;
+  index_capacity_ = 0;
+  chreHeapFree(arena_);
+  arena_ = nullptr;
+  arena_size_ = 0;
+  arena_capacity_ = 0;
+  arena_garbage_size_ = 0;
 }
 
 void AdvReportCache::Refresh() {
@@ -41,21 +71,12 @@ void AdvReportCache::Refresh() {
     return;
   }
 
+  // The oldest report is at the top of the expiry heap, so this stops at the
+  // first report that has not expired.
   uint64_t current_time = chreGetTime();
-  size_t index = 0;
-  while (index < cache_reports_.size()) {
-    if (current_time - cache_reports_[index].timestamp >
-        cache_expire_nanosec_) {
-      // TODO(b/285043291): Refactor cache element by wrapper struct/class
-      // which deallocates data in its destructor.
-      chreHeapFree(const_cast<uint8_t *>(cache_reports_[index].data));
-      // The index does not need to increase because the current element is
-      // replaced by the end of the element and the list is resized.
-      cache_reports_.swap(index, cache_reports_.size() - 1);
-      cache_reports_.resize(cache_reports_.size() - 1);
-    } else {
-      ++index;
-    }
+  while (!expiry_heap_.empty() && HeapTimestamp(0) < current_time &&
+         current_time - HeapTimestamp(0) > cache_expire_nanosec_) {
+    Remove(expiry_heap_[0]);
   }
 }
 
@@ -69,59 +90,263 @@ void AdvReportCache::Push(const chreBleAdvertisingReport &event_report) {
 #ifdef NEARBY_PROFILE
   ashProfileBegin(&profile_data_);
 #endif
-  bool is_duplicate = false;
-  for (auto &cache_report : cache_reports_) {
-    if (cache_report.addressType == event_report.addressType &&
-        memcmp(cache_report.address, event_report.address,
-               CHRE_BLE_ADDRESS_LEN) == 0 &&
-        cache_report.dataLength == event_report.dataLength &&
-        memcmp(cache_report.data, event_report.data, cache_report.dataLength) ==
-            0) {
-      // Updates RSSI by max value in the duplicated report.
-      if (cache_report.rssi == CHRE_BLE_RSSI_NONE ||
-          (event_report.rssi != CHRE_BLE_RSSI_NONE &&
-           event_report.rssi > cache_report.rssi)) {
-        cache_report.rssi = event_report.rssi;
-      }
-      // Updates timestamp to latest in the duplicated report.
-      if (event_report.timestamp > cache_report.timestamp) {
-        cache_report.timestamp = event_report.timestamp;
-      }
-      is_duplicate = true;
-      break;
+  uint32_t hash = HashKey(event_report);
+  size_t index = Find(event_report, hash);
+  if (index < cache_reports_.size()) {
+    chreBleAdvertisingReport &cache_report = cache_reports_[index];
+    // Updates RSSI by max value in the duplicated report.
+    if (cache_report.rssi == CHRE_BLE_RSSI_NONE ||
+        (event_report.rssi != CHRE_BLE_RSSI_NONE &&
+         event_report.rssi > cache_report.rssi)) {
+      cache_report.rssi = event_report.rssi;
     }
-  }
-  if (!is_duplicate) {
+    // Updates timestamp to latest in the duplicated report.
+    if (event_report.timestamp > cache_report.timestamp) {
+      cache_report.timestamp = event_report.timestamp;
+      HeapSiftDown(cache_entries_[index].heap_index);
+    }
+    LOGD("Duplicated report in advertising reports cache");
+  } else {
     LOGD("Adds to advertising reports cache");
-    // Copies advertise report by value.
+    index = cache_reports_.size();
+    if (index == kMaxCacheCount ||
+        (2 * (index + 1) > index_capacity_ &&
+         !ResizeIndex(index_capacity_ == 0 ? kMinIndexCapacity
+                                           : 2 * index_capacity_))) {
+      LOGE("Pushes advertise report failed!");
+      Refresh();
+      return;
+    }
+    // Copies advertise report by value, and its data into the arena.
     chreBleAdvertisingReport new_report = event_report;
-    // Allocates advertise data and copy it.
-    uint16_t dataLength = event_report.dataLength;
-    uint8_t *data = nullptr;
-    if (dataLength > 0) {
-      data =
-          static_cast<uint8_t *>(chreHeapAlloc(sizeof(uint8_t) * dataLength));
-      if (data == nullptr) {
+    if (event_report.dataLength > 0) {
+      new_report.data = CopyToArena(event_report.data, event_report.dataLength);
+      if (new_report.data == nullptr) {
         LOGE("Memory allocation failed!");
-        // Clean up expired cache elements for which heap memory is allocated.
+        // Clean up expired cache elements to reclaim arena space.
         Refresh();
         return;
       }
-      memcpy(data, event_report.data, dataLength);
-      new_report.data = data;
     }
-    if (!cache_reports_.push_back(std::move(new_report))) {
+    CacheEntry entry = {hash, static_cast<uint16_t>(expiry_heap_.size())};
+    if (!cache_reports_.push_back(new_report)) {
+      LOGE("Pushes advertise report failed!");
+      arena_garbage_size_ += new_report.dataLength;
+    } else if (!cache_entries_.push_back(entry) ||
+               !expiry_heap_.push_back(static_cast<uint16_t>(index))) {
       LOGE("Pushes advertise report failed!");
-      if (data != nullptr) {
-        chreHeapFree(const_cast<uint8_t *>(data));
+      if (cache_entries_.size() > index) {
+        cache_entries_.pop_back();
       }
+      cache_reports_.pop_back();
+      arena_garbage_size_ += new_report.dataLength;
+    } else {
+      InsertIntoIndex(hash, index);
+      HeapSiftUp(entry.heap_index);
     }
-  } else {
-    LOGD("Duplicated report in advertising reports cache");
   }
 #ifdef NEARBY_PROFILE
   ashProfileEnd(&profile_data_, nullptr /* output */);
 #endif
 }
 
+uint32_t AdvReportCache::HashKey(const chreBleAdvertisingReport &report) {
+  // 32-bit FNV-1a.
+  constexpr uint32_t kPrime = 16777619;
+  uint32_t hash = 2166136261;
+  hash = (hash ^ report.addressType) * kPrime;
+  for (size_t i = 0; i < CHRE_BLE_ADDRESS_LEN; i++) {
+    hash = (hash ^ report.address[i]) * kPrime;
+  }
+  for (size_t i = 0; i < report.dataLength; i++) {
+    hash = (hash ^ report.data[i]) * kPrime;
+  }
+  return hash;
+}
+
+bool AdvReportCache::IsSameKey(const chreBleAdvertisingReport &report,
+                               const chreBleAdvertisingReport &other) {
+  return report.addressType == other.addressType &&
+         memcmp(report.address, other.address, CHRE_BLE_ADDRESS_LEN) == 0 &&
+         report.dataLength == other.dataLength &&
+         (report.dataLength == 0 ||
+          memcmp(report.data, other.data, report.dataLength) == 0);
+}
+
+size_t AdvReportCache::Find(const chreBleAdvertisingReport &report,
+                            uint32_t hash) const {
+  if (index_capacity_ == 0) {
+    return cache_reports_.size();
+  }
+  size_t mask = index_capacity_ - 1;
+  for (size_t slot = hash & mask; index_[slot] != kEmptySlot;
+       slot = (slot + 1) & mask) {
+    size_t report_index = index_[slot] - 1;
+    if (cache_entries_[report_index].hash == hash &&
+        IsSameKey(cache_reports_[report_index], report)) {
+      return report_index;
+    }
+  }
+  return cache_reports_.size();
+}
+
+size_t AdvReportCache::FindSlot(uint32_t hash, size_t report_index) const {
+  size_t mask = index_capacity_ - 1;
+  size_t slot = hash & mask;
+  while (index_[slot] != report_index + 1) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void AdvReportCache::InsertIntoIndex(uint32_t hash, size_t report_index) {
+  size_t mask = index_capacity_ - 1;
+  size_t slot = hash & mask;
+  while (index_[slot] != kEmptySlot) {
+    slot = (slot + 1) & mask;
+  }
+  index_[slot] = static_cast<uint16_t>(report_index + 1);
+}
+
+void AdvReportCache::RemoveFromIndex(size_t slot) {
+  size_t mask = index_capacity_ - 1;
+  size_t hole = slot;
+  for (size_t next = (hole + 1) & mask; index_[next] != kEmptySlot;
+       next = (next + 1) & mask) {
+    // The report at next can fill the hole if the hole is between its home
+    // slot and next, i.e. if it was probed past the hole.
+    size_t home = cache_entries_[index_[next] - 1].hash & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      index_[hole] = index_[next];
+      hole = next;
+    }
+  }
+  index_[hole] = kEmptySlot;
+}
+
+bool AdvReportCache::ResizeIndex(size_t capacity) {
+  auto *index =
+      static_cast<uint16_t *>(chreHeapAlloc(capacity * sizeof(uint16_t)));
+  if (index == nullptr) {
+    return false;
+  }
+  memset(index, 0, capacity * sizeof(uint16_t));
+  chreHeapFree(index_);
+  index_ = index;
+  index_capacity_ = capacity;
+  for (size_t i = 0; i < cache_entries_.size(); i++) {
+    InsertIntoIndex(cache_entries_[i].hash, i);
+  }
+  return true;
+}
+
+const uint8_t *AdvReportCache::CopyToArena(const uint8_t *data,
+                                           uint16_t length) {
+  if (length > arena_capacity_ - arena_size_) {
+    // Moves the data of the cached reports to a new arena, dropping the data
+    // of the removed reports, with at least as much room left as used so that
+    // the copies are amortized.
+    size_t used_size = arena_size_ - arena_garbage_size_;
+    size_t capacity = std::max(arena_capacity_, kMinArenaCapacity);
+    while (capacity < 2 * (used_size + length)) {
+      capacity *= 2;
+    }
+    auto *arena = static_cast<uint8_t *>(chreHeapAlloc(capacity));
+    if (arena == nullptr) {
+      return nullptr;
+    }
+    size_t size = 0;
+    for (chreBleAdvertisingReport &report : cache_reports_) {
+      if (report.dataLength > 0) {
+        memcpy(&arena[size], report.data, report.dataLength);
+        report.data = &arena[size];
+        size += report.dataLength;
+      }
+    }
+    chreHeapFree(arena_);
+    arena_ = arena;
+    arena_size_ = size;
+    arena_capacity_ = capacity;
+    arena_garbage_size_ = 0;
+  }
+
+  uint8_t *copy = &arena_[arena_size_];
+  memcpy(copy, data, length);
+  arena_size_ += length;
+  return copy;
+}
+
+void AdvReportCache::HeapSwap(size_t heap_index, size_t other_heap_index) {
+  uint16_t report_index = expiry_heap_[heap_index];
+  uint16_t other_report_index = expiry_heap_[other_heap_index];
+  expiry_heap_[heap_index] = other_report_index;
+  expiry_heap_[other_heap_index] = report_index;
+  cache_entries_[other_report_index].heap_index =
+      static_cast<uint16_t>(heap_index);
+  cache_entries_[report_index].heap_index =
+      static_cast<uint16_t>(other_heap_index);
+}
+
+void AdvReportCache::HeapSiftUp(size_t heap_index) {
+  while (heap_index > 0) {
+    size_t parent = (heap_index - 1) / 2;
+    if (HeapTimestamp(parent) <= HeapTimestamp(heap_index)) {
+      break;
+    }
+    HeapSwap(heap_index, parent);
+    heap_index = parent;
+  }
+}
+
+void AdvReportCache::HeapSiftDown(size_t heap_index) {
+  size_t size = expiry_heap_.size();
+  while (true) {
+    size_t smallest = heap_index;
+    size_t left = 2 * heap_index + 1;
+    size_t right = left + 1;
+    if (left < size && HeapTimestamp(left) < HeapTimestamp(smallest)) {
+      smallest = left;
+    }
+    if (right < size && HeapTimestamp(right) < HeapTimestamp(smallest)) {
+      smallest = right;
+    }
+    if (smallest == heap_index) {
+      break;
+    }
+    HeapSwap(heap_index, smallest);
+    heap_index = smallest;
+  }
+}
+
+void AdvReportCache::Remove(size_t report_index) {
+  RemoveFromIndex(FindSlot(cache_entries_[report_index].hash, report_index));
+  arena_garbage_size_ += cache_reports_[report_index].dataLength;
+
+  // Removes the report from the expiry heap, moving the last element of the
+  // heap to its position.
+  size_t heap_index = cache_entries_[report_index].heap_index;
+  size_t last_heap_index = expiry_heap_.size() - 1;
+  if (heap_index != last_heap_index) {
+    HeapSwap(heap_index, last_heap_index);
+    expiry_heap_.pop_back();
+    HeapSiftDown(heap_index);
+    HeapSiftUp(heap_index);
+  } else {
+    expiry_heap_.pop_back();
+  }
+
+  // Moves the last report to the index of the removed one.
+  size_t last_index = cache_reports_.size() - 1;
+  if (report_index != last_index) {
+    const CacheEntry &last_entry = cache_entries_[last_index];
+    index_[FindSlot(last_entry.hash, last_index)] =
+        static_cast<uint16_t>(report_index + 1);
+    expiry_heap_[last_entry.heap_index] = static_cast<uint16_t>(report_index);
+    cache_reports_[report_index] = cache_reports_[last_index];
+    cache_entries_[report_index] = last_entry;
+  }
+  cache_reports_.pop_back();
+  cache_entries_.pop_back();
+}
+
 }  // namespace nearby
@@ -22,9 +22,12 @@
 #include <ash/profile.h>
 #endif
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <utility>
 
+#include "chre_api/chre.h"
 #include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
 
 namespace nearby {
@@ -48,15 +51,7 @@ class AdvReportCache {
   }
 
   // Move assignment operator
-  AdvReportCache &operator=(AdvReportCache &&other) {
-    if (&other == this) {
-      return *this;
-    }
-    Clear();
-    cache_reports_ = std::move(other.cache_reports_);
-    cache_expire_nanosec_ = other.cache_expire_nanosec_;
-    return *this;
-  }
+  AdvReportCache &operator=(AdvReportCache &&other);
 
   // Releases all resources {cache element, heap memory} in cache.
   void Clear();
@@ -65,6 +60,12 @@ class AdvReportCache {
   // unique key which is {advertiser address and data}.
   // Among advertise report with the same key, latest one will be placed at the
   // same index of existing report in advertise reports cache.
+  // Duplicates are found through a hash index in O(1) on average, and the data
+  // is copied into an arena shared by all the cached reports.
+  // At most kMaxCacheCount (65534) distinct reports are cached. Once the cache
+  // is full, a new report is dropped and the expired reports are removed to
+  // make room for the next ones. Duplicates of cached reports are still
+  // merged.
   void Push(const chreBleAdvertisingReport &report);
 
   // Return advertise reports in cache after refreshing the cache elements.
@@ -86,7 +87,8 @@ class AdvReportCache {
         cache_expire_millisec * chre::kOneMillisecondInNanoseconds;
   }
 
-  // Removes cached elements older than the cache timeout.
+  // Removes cached elements older than the cache timeout, in
+  // O(expired * log(size)).
   void Refresh();
 
   // Removes cached elements older than the cache timeout if cache count is
@@ -107,7 +109,92 @@ class AdvReportCache {
   // cache elements exired.
   static constexpr size_t kRefreshCacheCountThreshold = 8;
 
+  // Marks an empty slot in the hash index.
+  static constexpr uint16_t kEmptySlot = 0;
+
+  // Maximum number of cached reports, as the hash index and the expiry heap
+  // store report indices in uint16_t, with kEmptySlot reserved.
+  static constexpr size_t kMaxCacheCount = UINT16_MAX - 1;
+
+  // Minimum capacity of the hash index, which must be a power of two.
+  static constexpr size_t kMinIndexCapacity = 16;
+
+  // Minimum capacity of the data arena in bytes.
+  static constexpr size_t kMinArenaCapacity = 256;
+
+  // Bookkeeping of a cached report, at the same index as the report in
+  // cache_reports_.
+  struct CacheEntry {
+    // Hash of the deduplication key {address type, address, data}.
+    uint32_t hash;
+    // Position of the report in expiry_heap_.
+    uint16_t heap_index;
+  };
+
+  // Returns the hash of the deduplication key of a report.
+  static uint32_t HashKey(const chreBleAdvertisingReport &report);
+
+  // Returns true if two reports have the same deduplication key.
+  static bool IsSameKey(const chreBleAdvertisingReport &report,
+                        const chreBleAdvertisingReport &other);
+
+  // Returns the index of the cached report with the same deduplication key as
+  // the report, or cache_reports_.size() if there is none.
+  size_t Find(const chreBleAdvertisingReport &report, uint32_t hash) const;
+
+  // Returns the slot of the hash index holding the report index.
+  size_t FindSlot(uint32_t hash, size_t report_index) const;
+
+  // Inserts a report index into the hash index.
+  void InsertIntoIndex(uint32_t hash, size_t report_index);
+
+  // Empties a slot of the hash index, shifting back the following slots of the
+  // probe sequence so that lookups do not need tombstones.
+  void RemoveFromIndex(size_t slot);
+
+  // Rebuilds the hash index with a new capacity, which must be a power of two
+  // and larger than the number of cached reports. Returns false if the
+  // allocation failed, in which case the index is unchanged.
+  bool ResizeIndex(size_t capacity);
+
+  // Copies data into the arena, compacting and growing it if needed. Returns
+  // nullptr if the allocation failed.
+  const uint8_t *CopyToArena(const uint8_t *data, uint16_t length);
+
+  // Returns the timestamp of the report at a position of expiry_heap_.
+  uint64_t HeapTimestamp(size_t heap_index) const {
+    return cache_reports_[expiry_heap_[heap_index]].timestamp;
+  }
+
+  // Swaps two positions of expiry_heap_.
+  void HeapSwap(size_t heap_index, size_t other_heap_index);
+
+  // Restores the heap order for a report whose timestamp decreased or that
+  // was just added.
+  void HeapSiftUp(size_t heap_index);
+
+  // Restores the heap order for a report whose timestamp increased.
+  void HeapSiftDown(size_t heap_index);
+
+  // Removes a cached report, moving the last one to its index.
+  void Remove(size_t report_index);
+
   chre::DynamicVector<chreBleAdvertisingReport> cache_reports_;
+  chre::DynamicVector<CacheEntry> cache_entries_;
+  // Min-heap of the indices of the cached reports ordered by timestamp, so that
+  // refreshing the cache only visits the expired reports.
+  chre::DynamicVector<uint16_t> expiry_heap_;
+  // Open-addressing hash index with linear probing, holding the index of each
+  // cached report plus one at a slot derived from its CacheEntry::hash. Its
+  // capacity is a power of two, at least twice the number of cached reports.
+  uint16_t *index_ = nullptr;
+  size_t index_capacity_ = 0;
+  // Arena holding the data of the cached reports back to back. The data of
+  // removed reports is reclaimed when the arena is compacted, once full.
+  uint8_t *arena_ = nullptr;
+  size_t arena_size_ = 0;
+  size_t arena_capacity_ = 0;
+  size_t arena_garbage_size_ = 0;
   // Current cache timeout value.
   uint64_t cache_expire_nanosec_ = kMaxExpireTimeNanoSec;
 #ifdef NEARBY_PROFILE
@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/adv_report_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include "chre/platform/linux/virtual_clock.h"
+#include "chre/util/time.h"
+#include "chre_api/chre.h"
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace {
+
+using chre::Nanoseconds;
+using chre::platform_linux::VirtualClock;
+using chre::platform_linux::VirtualClockSingleton;
+
+constexpr uint64_t kMillisecondInNanoseconds = 1000000;
+
+// A report with a 6-byte address and data derived from the device and payload
+// identifiers, as the reports of a crowded scan would be.
+struct TestReport {
+  chreBleAdvertisingReport report;
+  uint8_t data[31];
+
+  TestReport(uint32_t device, uint32_t payload, uint16_t data_length,
+             int8_t rssi, uint64_t timestamp) {
+    memset(&report, 0, sizeof(report));
+    report.timestamp = timestamp;
+    report.addressType = CHRE_BLE_ADDRESS_TYPE_RANDOM;
+    for (size_t i = 0; i < 4; i++) {
+      report.address[i] = static_cast<uint8_t>(device >> (8 * i));
+    }
+    report.address[5] = 0xc0;
+    for (size_t i = 0; i < sizeof(data); i++) {
+      data[i] = static_cast<uint8_t>(payload * 31 + i);
+    }
+    report.dataLength = data_length;
+    report.data = data;
+    report.rssi = rssi;
+  }
+};
+
+// The linear cache AdvReportCache used to implement, as a reference for the
+// contents of the cache.
+class LinearAdvReportCache {
+ public:
+  explicit LinearAdvReportCache(uint64_t cache_expire_nanosec)
+      : cache_expire_nanosec_(cache_expire_nanosec) {}
+
+  ~LinearAdvReportCache() {
+    for (const auto &report : cache_reports_) {
+      delete[] report.data;
+    }
+  }
+
+  void Push(const chreBleAdvertisingReport &event_report) {
+    for (auto &cache_report : cache_reports_) {
+      if (cache_report.addressType == event_report.addressType &&
+          memcmp(cache_report.address, event_report.address,
+                 CHRE_BLE_ADDRESS_LEN) == 0 &&
+          cache_report.dataLength == event_report.dataLength &&
+          memcmp(cache_report.data, event_report.data,
+                 cache_report.dataLength) == 0) {
+        if (cache_report.rssi == CHRE_BLE_RSSI_NONE ||
+            (event_report.rssi != CHRE_BLE_RSSI_NONE &&
+             event_report.rssi > cache_report.rssi)) {
+          cache_report.rssi = event_report.rssi;
+        }
+        cache_report.timestamp =
+            std::max(cache_report.timestamp, event_report.timestamp);
+        return;
+      }
+    }
+    chreBleAdvertisingReport new_report = event_report;
+    auto *data = new uint8_t[event_report.dataLength];
+    memcpy(data, event_report.data, event_report.dataLength);
+    new_report.data = data;
+    cache_reports_.push_back(new_report);
+  }
+
+  void Refresh() {
+    uint64_t current_time = chreGetTime();
+    for (size_t i = 0; i < cache_reports_.size();) {
+      if (current_time - cache_reports_[i].timestamp > cache_expire_nanosec_) {
+        delete[] cache_reports_[i].data;
+        cache_reports_[i] = cache_reports_.back();
+        cache_reports_.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+
+  const std::vector<chreBleAdvertisingReport> &GetAdvReports() {
+    Refresh();
+    return cache_reports_;
+  }
+
+ private:
+  std::vector<chreBleAdvertisingReport> cache_reports_;
+  uint64_t cache_expire_nanosec_;
+};
+
+using ReportKey = std::tuple<std::vector<uint8_t>, std::vector<uint8_t>,
+                             int8_t, uint64_t>;
+
+// Returns the cached reports as sorted keys, as the order of the reports in
+// the cache is not specified.
+template <typename Reports>
+std::vector<ReportKey> SortedKeys(const Reports &reports) {
+  std::vector<ReportKey> keys;
+  for (const auto &report : reports) {
+    keys.emplace_back(
+        std::vector<uint8_t>(report.address,
+                             report.address + CHRE_BLE_ADDRESS_LEN),
+        std::vector<uint8_t>(report.data, report.data + report.dataLength),
+        report.rssi, report.timestamp);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+// A crowded scan: every batch holds reports from a few hundred devices
+// rotating their payloads, with many duplicates within and across batches.
+std::vector<TestReport> MakeCrowdedBatch(uint64_t start_nanosec,
+                                         uint32_t batch, size_t num_devices,
+                                         size_t reports_per_batch) {
+  std::vector<TestReport> reports;
+  reports.reserve(reports_per_batch);
+  uint64_t timestamp = start_nanosec + batch * 100 * kMillisecondInNanoseconds;
+  for (size_t i = 0; i < reports_per_batch; i++) {
+    uint32_t device = static_cast<uint32_t>((i * 7919 + batch * 31) %
+                                            num_devices);
+    uint32_t payload = device + (batch / 8);
+    auto data_length = static_cast<uint16_t>(8 + device % 24);
+    auto rssi = static_cast<int8_t>(-40 - static_cast<int>((i + batch) % 50));
+    reports.emplace_back(device, payload, data_length, rssi,
+                         timestamp + i * 1000);
+  }
+  return reports;
+}
+
+}  // namespace
+
+namespace nearby {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(RUN_IN_NANOAPP, 0);
+
+// Runs the function sent to it, as the cache allocates from the heap of the
+// nanoapp using it.
+class CacheTestNanoapp : public chre::TestNanoapp {
+ public:
+  void handleEvent(uint32_t, uint16_t event_type,
+                   const void *event_data) override {
+    if (event_type == CHRE_EVENT_TEST_EVENT) {
+      auto *event = static_cast<const TestEvent *>(event_data);
+      if (event->type == RUN_IN_NANOAPP) {
+        (**static_cast<std::function<void()> *const *>(event->data))();
+        chre::TestEventQueueSingleton::get()->pushEvent(RUN_IN_NANOAPP);
+      }
+    }
+  }
+};
+
+// Runs each test in a nanoapp on the virtual clock, which only moves with
+// SetTime().
+class AdvReportCacheTest : public chre::TestBase {
+ protected:
+  bool useVirtualTime() const override {
+    return true;
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 60 * chre::kOneSecondInNanoseconds;
+  }
+
+  void RunInNanoapp(std::function<void()> body) {
+    uint64_t app_id = chre::loadNanoapp(chre::MakeUnique<CacheTestNanoapp>());
+    std::function<void()> *body_ptr = &body;
+    chre::sendEventToNanoapp(app_id, RUN_IN_NANOAPP, body_ptr);
+    waitForEvent(RUN_IN_NANOAPP);
+    chre::unloadNanoapp(app_id);
+  }
+
+  // Moves the virtual clock forward to a time, from the nanoapp.
+  static void SetTime(uint64_t time_nanosec) {
+    VirtualClock *clock = VirtualClockSingleton::get();
+    clock->addAlarm(Nanoseconds(time_nanosec), [] {});
+    ASSERT_TRUE(clock->advance());
+    ASSERT_EQ(chreGetTime(), time_nanosec);
+  }
+};
+
+TEST_F(AdvReportCacheTest, DeduplicatesByAddressAndData) {
+  RunInNanoapp([] {
+    AdvReportCache cache;
+    TestReport report(1, 1, 10, -60, 100);
+    TestReport louder(1, 1, 10, -50, 50);
+    TestReport other_data(1, 2, 10, -70, 100);
+    TestReport other_device(2, 1, 10, -70, 100);
+    TestReport no_rssi(2, 1, 10, CHRE_BLE_RSSI_NONE, 200);
+
+    cache.Push(report.report);
+    cache.Push(louder.report);
+    cache.Push(other_data.report);
+    cache.Push(other_device.report);
+    cache.Push(no_rssi.report);
+
+    auto &reports = cache.GetAdvReports();
+    ASSERT_EQ(reports.size(), 3);
+    for (const auto &cached : reports) {
+      if (memcmp(cached.address, report.report.address, CHRE_BLE_ADDRESS_LEN) ==
+              0 &&
+          memcmp(cached.data, report.data, 10) == 0) {
+        EXPECT_EQ(cached.rssi, -50);
+        EXPECT_EQ(cached.timestamp, 100);
+      } else if (memcmp(cached.address, other_device.report.address,
+                        CHRE_BLE_ADDRESS_LEN) == 0) {
+        EXPECT_EQ(cached.rssi, -70);
+        EXPECT_EQ(cached.timestamp, 200);
+      }
+      // The data is copied into the cache.
+      EXPECT_NE(cached.data, report.data);
+      EXPECT_NE(cached.data, other_data.data);
+      EXPECT_NE(cached.data, other_device.data);
+    }
+  });
+}
+
+TEST_F(AdvReportCacheTest, RefreshRemovesExpiredReportsOnly) {
+  RunInNanoapp([] {
+    AdvReportCache cache;
+    cache.SetCacheTimeout(1000 /* cache_expire_millisec */);
+    for (uint32_t i = 0; i < 64; i++) {
+      TestReport report(i, i, 16, -60, i * 100 * kMillisecondInNanoseconds);
+      cache.Push(report.report);
+    }
+    // Refreshes device 3 so that it outlives the other early ones.
+    TestReport refreshed(3, 3, 16, -60, 3500 * kMillisecondInNanoseconds);
+    cache.Push(refreshed.report);
+
+    SetTime(4000 * kMillisecondInNanoseconds);
+    auto &reports = cache.GetAdvReports();
+    // Devices 30 to 63 and the refreshed device 3 are at most 1 s old.
+    EXPECT_EQ(reports.size(), 35);
+    for (const auto &report : reports) {
+      EXPECT_TRUE(report.timestamp >= 3000 * kMillisecondInNanoseconds);
+    }
+
+    SetTime(10000 * kMillisecondInNanoseconds);
+    EXPECT_TRUE(cache.GetAdvReports().empty());
+
+    // The cache is still usable once empty.
+    TestReport report(1, 1, 16, -60, chreGetTime());
+    cache.Push(report.report);
+    EXPECT_EQ(cache.GetAdvReports().size(), 1);
+  });
+}
+
+TEST_F(AdvReportCacheTest, MoveAssignmentTransfersReports) {
+  RunInNanoapp([] {
+    AdvReportCache source;
+    for (uint32_t i = 0; i < 20; i++) {
+      TestReport report(i, i, 20, -60, 0);
+      source.Push(report.report);
+    }
+    std::vector<ReportKey> keys = SortedKeys(source.GetAdvReports());
+
+    AdvReportCache destination;
+    TestReport report(100, 100, 20, -60, 0);
+    destination.Push(report.report);
+    destination = std::move(source);
+    EXPECT_EQ(SortedKeys(destination.GetAdvReports()), keys);
+
+    // Duplicates are still found after the move.
+    TestReport duplicate(5, 5, 20, -60, 0);
+    destination.Push(duplicate.report);
+    EXPECT_EQ(destination.GetAdvReports().size(), 20);
+  });
+}
+
+TEST_F(AdvReportCacheTest, CrowdedScanMatchesLinearCache) {
+  RunInNanoapp([] {
+    // Replays a crowded scan of 400 devices: 64 batches of 256 reports pushed
+    // every 100 ms, reading the cache after each batch as
+    // AppManager::HandleMatchAdvReports() does.
+    constexpr size_t kNumDevices = 400;
+    constexpr size_t kReportsPerBatch = 256;
+    constexpr uint32_t kNumBatches = 64;
+    constexpr uint64_t kTimeoutMillisec = 1500;
+
+    uint64_t start = chreGetTime();
+    std::vector<std::vector<TestReport>> batches;
+    for (uint32_t batch = 0; batch < kNumBatches; batch++) {
+      batches.push_back(
+          MakeCrowdedBatch(start, batch, kNumDevices, kReportsPerBatch));
+    }
+
+    AdvReportCache cache;
+    cache.SetCacheTimeout(kTimeoutMillisec);
+    LinearAdvReportCache linear_cache(kTimeoutMillisec *
+                                      kMillisecondInNanoseconds);
+    for (uint32_t batch = 0; batch < kNumBatches; batch++) {
+      SetTime(start + (batch * 100 + 50) * kMillisecondInNanoseconds);
+      for (const TestReport &report : batches[batch]) {
+        cache.Push(report.report);
+        linear_cache.Push(report.report);
+      }
+      ASSERT_EQ(SortedKeys(cache.GetAdvReports()),
+                SortedKeys(linear_cache.GetAdvReports()))
+          << "batch " << batch;
+    }
+  });
+}
+
+}  // namespace
+}  // namespace nearby
@@ -40,6 +40,26 @@ class Crypto {
   virtual bool verify(const ByteArray &input, const ByteArray &key,
                       const ByteArray &signature) const = 0;
 
+  // Tries a batch of keys against one encrypted identity: decrypts it with
+  // each key as decrypt() does, and verifies the result against the signature
+  // of the same index as verify() does. Places the decrypted identity in
+  // identity, which must have the length of encrypted_identity, and returns
+  // the index of the first key that matches, or num_keys if none does.
+  // Implementations can override it to share the work that does not depend on
+  // the key, or reuse the work done for a key across calls.
+  virtual size_t FindKey(const ByteArray &encrypted_identity,
+                         const ByteArray &salt, const ByteArray keys[],
+                         const ByteArray signatures[], size_t num_keys,
+                         ByteArray &identity) const {
+    for (size_t i = 0; i < num_keys; i++) {
+      if (decrypt(encrypted_identity, salt, keys[i], identity) &&
+          verify(identity, keys[i], signatures[i])) {
+        return i;
+      }
+    }
+    return num_keys;
+  }
+
   virtual ~Crypto() = default;
 };
 
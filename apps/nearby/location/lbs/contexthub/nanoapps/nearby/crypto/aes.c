@@ -17,7 +17,6 @@
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
 
 #include <stdalign.h>
-#include <stdbool.h>
 #include <string.h>
 
 #define AES_128_KEY_NUM_ROUNDS 10
@@ -186,16 +185,27 @@ int aesInitForEncr(struct AesContext *ctx, const uint32_t *k) {
   return 0;
 }
 
-void aesEncr(struct AesContext *ctx, const uint32_t *src, uint32_t *dst) {
+inline static void storeBe32(uint8_t *p, uint32_t value) {
+  p[0] = (uint8_t)(value >> 24);
+  p[1] = (uint8_t)(value >> 16);
+  p[2] = (uint8_t)(value >> 8);
+  p[3] = (uint8_t)value;
+}
+
+// AES rounds on a block held as big-endian words, i.e. in the byte order of
+// the specification
+static void aesEncrWords(const struct AesContext *ctx, const uint32_t *src,
+                         uint32_t *dst) {
   uint32_t x0, x1, x2, x3;  // we CAN use an array, but then GCC will not use
                             // registers. so we use separate vars. sigh...
-  uint32_t *k = ctx->round_key, i;
+  const uint32_t *k = ctx->round_key;
+  uint32_t i;
 
   // setup
-  x0 = BSWAP32(*src++) ^ *k++;
-  x1 = BSWAP32(*src++) ^ *k++;
-  x2 = BSWAP32(*src++) ^ *k++;
-  x3 = BSWAP32(*src++) ^ *k++;
+  x0 = src[0] ^ *k++;
+  x1 = src[1] ^ *k++;
+  x2 = src[2] ^ *k++;
+  x3 = src[3] ^ *k++;
 
   // all-but-last round
   for (i = 0; i < ctx->aes_num_rounds - 1; i++) {
@@ -227,31 +237,39 @@ void aesEncr(struct AesContext *ctx, const uint32_t *src, uint32_t *dst) {
   }
 
   // last round
-  *dst++ = BSWAP32(*k++ ^ (((uint32_t)(FwdSbox[(x0 >> 24) & 0xff])) << 24) ^
-                   (((uint32_t)(FwdSbox[(x1 >> 16) & 0xff])) << 16) ^
-                   (((uint32_t)(FwdSbox[(x2 >> 8) & 0xff])) << 8) ^
-                   (((uint32_t)(FwdSbox[(x3 >> 0) & 0xff])) << 0));
-
-  *dst++ = BSWAP32(*k++ ^ (((uint32_t)(FwdSbox[(x1 >> 24) & 0xff])) << 24) ^
-                   (((uint32_t)(FwdSbox[(x2 >> 16) & 0xff])) << 16) ^
-                   (((uint32_t)(FwdSbox[(x3 >> 8) & 0xff])) << 8) ^
-                   (((uint32_t)(FwdSbox[(x0 >> 0) & 0xff])) << 0));
-
-  *dst++ = BSWAP32(*k++ ^ (((uint32_t)(FwdSbox[(x2 >> 24) & 0xff])) << 24) ^
-                   (((uint32_t)(FwdSbox[(x3 >> 16) & 0xff])) << 16) ^
-                   (((uint32_t)(FwdSbox[(x0 >> 8) & 0xff])) << 8) ^
-                   (((uint32_t)(FwdSbox[(x1 >> 0) & 0xff])) << 0));
-
-  *dst++ = BSWAP32(*k++ ^ (((uint32_t)(FwdSbox[(x3 >> 24) & 0xff])) << 24) ^
-                   (((uint32_t)(FwdSbox[(x0 >> 16) & 0xff])) << 16) ^
-                   (((uint32_t)(FwdSbox[(x1 >> 8) & 0xff])) << 8) ^
-                   (((uint32_t)(FwdSbox[(x2 >> 0) & 0xff])) << 0));
+  dst[0] = *k++ ^ (((uint32_t)(FwdSbox[(x0 >> 24) & 0xff])) << 24) ^
+           (((uint32_t)(FwdSbox[(x1 >> 16) & 0xff])) << 16) ^
+           (((uint32_t)(FwdSbox[(x2 >> 8) & 0xff])) << 8) ^
+           (((uint32_t)(FwdSbox[(x3 >> 0) & 0xff])) << 0);
+
+  dst[1] = *k++ ^ (((uint32_t)(FwdSbox[(x1 >> 24) & 0xff])) << 24) ^
+           (((uint32_t)(FwdSbox[(x2 >> 16) & 0xff])) << 16) ^
+           (((uint32_t)(FwdSbox[(x3 >> 8) & 0xff])) << 8) ^
+           (((uint32_t)(FwdSbox[(x0 >> 0) & 0xff])) << 0);
+
+  dst[2] = *k++ ^ (((uint32_t)(FwdSbox[(x2 >> 24) & 0xff])) << 24) ^
+           (((uint32_t)(FwdSbox[(x3 >> 16) & 0xff])) << 16) ^
+           (((uint32_t)(FwdSbox[(x0 >> 8) & 0xff])) << 8) ^
+           (((uint32_t)(FwdSbox[(x1 >> 0) & 0xff])) << 0);
+
+  dst[3] = *k++ ^ (((uint32_t)(FwdSbox[(x3 >> 24) & 0xff])) << 24) ^
+           (((uint32_t)(FwdSbox[(x0 >> 16) & 0xff])) << 16) ^
+           (((uint32_t)(FwdSbox[(x1 >> 8) & 0xff])) << 8) ^
+           (((uint32_t)(FwdSbox[(x2 >> 0) & 0xff])) << 0);
+}
+
+void aesEncr(struct AesContext *ctx, const uint32_t *src, uint32_t *dst) {
+  uint32_t block[AES_BLOCK_WORDS];
+
+  for (uint32_t i = 0; i < AES_BLOCK_WORDS; i++) block[i] = BSWAP32(src[i]);
+  aesEncrWords(ctx, block, block);
+  for (uint32_t i = 0; i < AES_BLOCK_WORDS; i++) dst[i] = BSWAP32(block[i]);
 }
 
 int aesCtrInit(struct AesCtrContext *ctx, const void *k, const void *iv,
                enum AesKeyType key_type) {
   const uint32_t *p_k;
-  uint32_t aligned_k[AES_BLOCK_WORDS];
+  uint32_t aligned_k[AES_KEY_MAX_WORDS];
 
   if (AES_128_KEY_TYPE == key_type) {
     ctx->aes.aes_key_words = AES_128_KEY_WORDS;
@@ -266,77 +284,65 @@ int aesCtrInit(struct AesCtrContext *ctx, const void *k, const void *iv,
   if (IS_ALIGNED(k, uint32_t)) {
     p_k = (const uint32_t *)k;
   } else {
-    memcpy(aligned_k, k, sizeof(aligned_k));
+    memcpy(aligned_k, k, ctx->aes.aes_key_words * sizeof(uint32_t));
     p_k = aligned_k;
   }
 
-  memcpy(ctx->iv, iv, sizeof(ctx->iv));
+  aesCtrSetIv(ctx, iv);
   return aesInitForEncr(&ctx->aes, p_k);
 }
 
+void aesCtrSetIv(struct AesCtrContext *ctx, const void *iv) {
+  // the counter block is kept as big-endian words, so that it is encrypted
+  // and incremented without any byte swapping
+  const uint8_t *p_iv = (const uint8_t *)iv;
+  for (uint32_t i = 0; i < AES_BLOCK_WORDS; i++, p_iv += sizeof(uint32_t)) {
+    ctx->iv[i] = ((uint32_t)p_iv[0] << 24) | ((uint32_t)p_iv[1] << 16) |
+                 ((uint32_t)p_iv[2] << 8) | (uint32_t)p_iv[3];
+  }
+}
+
 void aesCtr(struct AesCtrContext *ctx, const void *src, void *dst,
             size_t data_len) {
   const uint8_t *p_src_pos = (const uint8_t *)src;
   uint8_t *p_dst_pos = (uint8_t *)dst;
-  const bool is_src_aligned = IS_ALIGNED(src, uint32_t);
-  const bool is_dst_aligned = IS_ALIGNED(dst, uint32_t);
-  const uint32_t *p_src;
-  uint32_t *p_dst;
-  uint32_t aligned_src[AES_BLOCK_WORDS];
-  uint32_t aligned_dst[AES_BLOCK_WORDS];
-  size_t bytes_to_process = data_len;
-
-  while (bytes_to_process > 0) {
-    size_t chunk_bytes_len =
-        (bytes_to_process < AES_BLOCK_SIZE) ? bytes_to_process : AES_BLOCK_SIZE;
-
-    // if source is not aligned or size is not multiple of words,
-    // copy it to stack
-    if (is_src_aligned && (chunk_bytes_len % sizeof(uint32_t) == 0)) {
-      // Cast to "void *" first to prevent the -Wcast-align compiling
-      // error when casting the uint8_t pointer to the uint32_t pointer.
-      // Note, we already verified the alignment above before casting.
-      p_src = (const uint32_t *)(void *)p_src_pos;
-    } else {
-      memcpy(aligned_src, p_src_pos, chunk_bytes_len);
-      p_src = aligned_src;
-    }
+  uint32_t key_stream[AES_BLOCK_WORDS];
+  uint8_t key_stream_bytes[AES_BLOCK_SIZE];
 
-    // if destination is not aligned or full block size,
-    // copy results to stack
-    if (is_dst_aligned && chunk_bytes_len == AES_BLOCK_SIZE) {
-      // Cast to "void *" first to prevent the -Wcast-align compiling
-      // error when casting the uint8_t pointer to the uint32_t pointer.
-      // Note, we already verified the alignment above before casting.
-      p_dst = (uint32_t *)(void *)p_dst_pos;
-    } else {
-      p_dst = aligned_dst;
-    }
+  while (data_len > 0) {
+    size_t chunk_bytes_len =
+        (data_len < AES_BLOCK_SIZE) ? data_len : AES_BLOCK_SIZE;
 
     // encrypt/decrypt by AES/CTR mode
     // encryption and decryption are same operation in AES/CTR mode
-    size_t num_words =
-        (chunk_bytes_len + (sizeof(uint32_t) - 1)) / sizeof(uint32_t);
-    aesEncr(&ctx->aes, ctx->iv, p_dst);
-    for (size_t i = 0; i < num_words; i++) {
-      p_dst[i] ^= p_src[i];
+    aesEncrWords(&ctx->aes, ctx->iv, key_stream);
+    for (size_t i = 0; i < AES_BLOCK_WORDS; i++) {
+      storeBe32(&key_stream_bytes[i * sizeof(uint32_t)], key_stream[i]);
     }
-
-    // if p_dst is aligned_dst, we used stack
-    // then, copy stack to destination by safe way
-    if (p_dst == aligned_dst) {
-      memcpy(p_dst_pos, aligned_dst, chunk_bytes_len);
+    if (chunk_bytes_len == AES_BLOCK_SIZE) {
+      // XOR a word at a time. memcpy() handles unaligned source and
+      // destination, and is compiled to plain loads and stores
+      for (size_t i = 0; i < AES_BLOCK_SIZE; i += sizeof(uint32_t)) {
+        uint32_t word, key_word;
+        memcpy(&word, p_src_pos + i, sizeof(word));
+        memcpy(&key_word, key_stream_bytes + i, sizeof(key_word));
+        word ^= key_word;
+        memcpy(p_dst_pos + i, &word, sizeof(word));
+      }
+    } else {
+      for (size_t i = 0; i < chunk_bytes_len; i++) {
+        p_dst_pos[i] = p_src_pos[i] ^ key_stream_bytes[i];
+      }
     }
 
     // update position and left bytes
     p_dst_pos += chunk_bytes_len;
     p_src_pos += chunk_bytes_len;
-    bytes_to_process -= chunk_bytes_len;
+    data_len -= chunk_bytes_len;
 
-    // increase AES block counter
-    for (int i = AES_BLOCK_SIZE - 1; i >= 0; i--) {
-      ((uint8_t *)ctx->iv)[i]++;
-      if (((uint8_t *)ctx->iv)[i]) break;
+    // increase AES block counter, a 128-bit big-endian integer
+    for (int i = AES_BLOCK_WORDS - 1; i >= 0; i--) {
+      if (++ctx->iv[i] != 0) break;
     }
   }
 }
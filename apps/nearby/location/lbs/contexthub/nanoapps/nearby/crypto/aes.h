@@ -27,6 +27,8 @@ extern "C" {
  *
  * External APIs:
  *  - aesCtrInit() for AES/CTR initialization
+ *  - aesCtrSetIv() for restarting AES/CTR with a new counter block, reusing
+ *    the round keys
  *  - aesCtr() for AES/CTR encryption and decryption
  */
 
@@ -56,6 +58,7 @@ void aesEncr(struct AesContext *ctx, const uint32_t *src, uint32_t *dst);
 // AES-CTR context
 struct AesCtrContext {
   struct AesContext aes;
+  // counter block, as big-endian words
   uint32_t iv[AES_BLOCK_WORDS];
 };
 
@@ -77,6 +80,19 @@ struct AesCtrContext {
 int aesCtrInit(struct AesCtrContext *ctx, const void *k, const void *iv,
                enum AesKeyType key_type);
 
+/**
+ * aesCtrSetIv:
+ * @ctx: AES/CTR context initialized
+ * @iv: AES/CTR 16 byte counter block.
+ *     the size must fit exactly 16 bytes.
+ *
+ * Replaces the counter block, keeping the round keys created by aesCtrInit()
+ * so that the same key can be used with many counter blocks
+ *
+ * Returns:
+ */
+void aesCtrSetIv(struct AesCtrContext *ctx, const void *iv);
+
 /**
  * aesCtr:
  * @ctx: AES/CTR context initialized
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hkdf.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hmac.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/sha2.h"
+
+namespace {
+
+std::vector<uint8_t> FromHex(const char *hex) {
+  std::vector<uint8_t> bytes;
+  for (size_t i = 0; hex[i] != '\0' && hex[i + 1] != '\0'; i += 2) {
+    bytes.push_back(
+        static_cast<uint8_t>(std::stoul(std::string(&hex[i], 2), nullptr, 16)));
+  }
+  return bytes;
+}
+
+std::vector<uint8_t> FromString(const char *str) {
+  return std::vector<uint8_t>(str, str + strlen(str));
+}
+
+std::vector<uint8_t> Sha256(const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> hash(SHA2_HASH_SIZE);
+  sha256(data.data(), data.size(), hash.data(), hash.size());
+  return hash;
+}
+
+std::vector<uint8_t> HmacSha256(const std::vector<uint8_t> &key,
+                                const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> hash(SHA2_HASH_SIZE);
+  hmacSha256(key.data(), key.size(), data.data(), data.size(), hash.data(),
+             hash.size());
+  return hash;
+}
+
+std::vector<uint8_t> AesCtr(const std::vector<uint8_t> &key,
+                            const std::vector<uint8_t> &iv,
+                            const std::vector<uint8_t> &input,
+                            AesKeyType key_type) {
+  std::vector<uint8_t> output(input.size());
+  AesCtrContext ctx;
+  EXPECT_EQ(aesCtrInit(&ctx, key.data(), iv.data(), key_type), 0);
+  aesCtr(&ctx, input.data(), output.data(), input.size());
+  return output;
+}
+
+// NIST SP 800-38A, F.5.1 and F.5.5.
+constexpr char kAesCtrIv[] = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+constexpr char kAesCtrPlainText[] =
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+constexpr char kAes128Key[] = "2b7e151628aed2a6abf7158809cf4f3c";
+constexpr char kAes128CtrCipherText[] =
+    "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+    "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee";
+constexpr char kAes256Key[] =
+    "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4";
+constexpr char kAes256CtrCipherText[] =
+    "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+    "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6";
+
+}  // namespace
+
+TEST(CryptoTest, Sha256KnownAnswers) {
+  EXPECT_EQ(Sha256({}),
+            FromHex("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b"
+                    "7852b855"));
+  EXPECT_EQ(Sha256(FromString("abc")),
+            FromHex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61"
+                    "f20015ad"));
+  EXPECT_EQ(Sha256(FromString(
+                "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")),
+            FromHex("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd4"
+                    "19db06c1"));
+  EXPECT_EQ(Sha256(std::vector<uint8_t>(1000000, 'a')),
+            FromHex("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39cc"
+                    "c7112cd0"));
+}
+
+TEST(CryptoTest, Sha256StreamingMatchesOneShot) {
+  std::vector<uint8_t> data(300);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i * 7 + 3);
+  }
+  // Covers the padding of messages ending around the length field.
+  for (size_t length : {0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 300}) {
+    std::vector<uint8_t> message(data.begin(), data.begin() + length);
+    std::vector<uint8_t> expected = Sha256(message);
+    for (size_t chunk : {1, 3, 17, 64, 100}) {
+      Sha2Context ctx;
+      sha2init(&ctx);
+      for (size_t i = 0; i < length; i += chunk) {
+        sha2processBytes(&ctx, &message[i], std::min(chunk, length - i));
+      }
+      std::vector<uint8_t> hash(SHA2_HASH_SIZE);
+      sha2finish(&ctx, hash.data(), hash.size());
+      EXPECT_EQ(hash, expected) << "length " << length << ", chunk " << chunk;
+    }
+  }
+}
+
+TEST(CryptoTest, HmacSha256KnownAnswers) {
+  // RFC 4231, test cases 1, 2 and 6.
+  EXPECT_EQ(HmacSha256(std::vector<uint8_t>(20, 0x0b), FromString("Hi There")),
+            FromHex("b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c"
+                    "2e32cff7"));
+  EXPECT_EQ(HmacSha256(FromString("Jefe"),
+                       FromString("what do ya want for nothing?")),
+            FromHex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b9"
+                    "64ec3843"));
+  EXPECT_EQ(
+      HmacSha256(std::vector<uint8_t>(131, 0xaa),
+                 FromString("Test Using Larger Than Block-Size Key - Hash Key "
+                            "First")),
+      FromHex("60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f5"
+              "4"));
+}
+
+TEST(CryptoTest, HmacKeyIsReusable) {
+  std::vector<uint8_t> key = FromString("Jefe");
+  HmacKey hmac_key;
+  hmacKeyInit(&hmac_key, key.data(), key.size());
+  for (const char *message : {"", "what do ya want for nothing?", "abc"}) {
+    std::vector<uint8_t> data = FromString(message);
+    HmacContext ctx;
+    hmacInitWithKey(&ctx, &hmac_key);
+    hmacUpdate(&ctx, data.data(), data.size());
+    std::vector<uint8_t> hash(SHA2_HASH_SIZE);
+    hmacFinish(&ctx, hash.data(), hash.size());
+    EXPECT_EQ(hash, HmacSha256(key, data)) << message;
+  }
+}
+
+TEST(CryptoTest, HkdfKnownAnswers) {
+  // RFC 5869, test cases 1 and 3.
+  std::vector<uint8_t> ikm(22, 0x0b);
+  std::vector<uint8_t> salt = FromHex("000102030405060708090a0b0c");
+  std::vector<uint8_t> info = FromHex("f0f1f2f3f4f5f6f7f8f9");
+  std::vector<uint8_t> okm(42);
+  hkdf(salt.data(), salt.size(), ikm.data(), ikm.size(), info.data(),
+       info.size(), okm.data(), okm.size());
+  EXPECT_EQ(okm, FromHex("3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db0"
+                         "2d56ecc4c5bf34007208d5b887185865"));
+
+  hkdf(nullptr, 0, ikm.data(), ikm.size(), nullptr, 0, okm.data(), okm.size());
+  EXPECT_EQ(okm, FromHex("8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec345"
+                         "4e5f3c738d2d9d201395faa4b61a96c8"));
+}
+
+TEST(CryptoTest, AesCtrKnownAnswers) {
+  EXPECT_EQ(AesCtr(FromHex(kAes128Key), FromHex(kAesCtrIv),
+                   FromHex(kAesCtrPlainText), AES_128_KEY_TYPE),
+            FromHex(kAes128CtrCipherText));
+  EXPECT_EQ(AesCtr(FromHex(kAes256Key), FromHex(kAesCtrIv),
+                   FromHex(kAesCtrPlainText), AES_256_KEY_TYPE),
+            FromHex(kAes256CtrCipherText));
+  // Decryption is the same operation.
+  EXPECT_EQ(AesCtr(FromHex(kAes128Key), FromHex(kAesCtrIv),
+                   FromHex(kAes128CtrCipherText), AES_128_KEY_TYPE),
+            FromHex(kAesCtrPlainText));
+}
+
+TEST(CryptoTest, AesCtrPartialAndUnalignedBlocks) {
+  std::vector<uint8_t> key = FromHex(kAes128Key);
+  std::vector<uint8_t> iv = FromHex(kAesCtrIv);
+  std::vector<uint8_t> expected = FromHex(kAes128CtrCipherText);
+  std::vector<uint8_t> plain_text = FromHex(kAesCtrPlainText);
+  for (size_t offset : {0, 1, 3}) {
+    for (size_t length : {1, 15, 16, 17, 37, 64}) {
+      std::vector<uint8_t> input(length + offset);
+      std::vector<uint8_t> output(length + offset);
+      memcpy(&input[offset], plain_text.data(), length);
+      AesCtrContext ctx;
+      ASSERT_EQ(aesCtrInit(&ctx, key.data(), iv.data(), AES_128_KEY_TYPE), 0);
+      aesCtr(&ctx, &input[offset], &output[offset], length);
+      EXPECT_EQ(0, memcmp(&output[offset], expected.data(), length))
+          << "offset " << offset << ", length " << length;
+    }
+  }
+}
+
+TEST(CryptoTest, AesCtrCounterCarries) {
+  // The counter is a 128-bit big-endian integer: the second block of a counter
+  // ending with 0xffffffff is the first block of the incremented counter.
+  std::vector<uint8_t> key = FromHex(kAes128Key);
+  std::vector<uint8_t> iv = FromHex("000000000000000000000001ffffffff");
+  std::vector<uint8_t> next_iv = FromHex("00000000000000000000000200000000");
+  std::vector<uint8_t> zeros(32, 0);
+  std::vector<uint8_t> key_stream = AesCtr(key, iv, zeros, AES_128_KEY_TYPE);
+  std::vector<uint8_t> next_key_stream =
+      AesCtr(key, next_iv, std::vector<uint8_t>(16, 0), AES_128_KEY_TYPE);
+  EXPECT_EQ(std::vector<uint8_t>(key_stream.begin() + 16, key_stream.end()),
+            next_key_stream);
+}
@@ -19,28 +19,48 @@
 #include <string.h>
 
 static void sha2InitHmacKeyUpdate(struct HmacContext *ctx) {
-  // initialize sha2 context and update hmac keys to the sha2 context
-  sha2init(&ctx->sha2ctx);
-  sha2processBytes(&ctx->sha2ctx, ctx->k_ipad, sizeof(ctx->k_ipad));
+  // initialize sha2 context as if the inner padded key was processed
+  sha2initWithState(&ctx->sha2ctx, ctx->key.istate, SHA2_BLOCK_SIZE);
 }
 
-void hmacInit(struct HmacContext *ctx, const void *inKey, const size_t keyLen) {
+void hmacKeyInit(struct HmacKey *key, const void *inKey, const size_t keyLen) {
+  uint8_t k[SHA2_BLOCK_SIZE];
+  uint8_t k_pad[SHA2_BLOCK_SIZE];
+  struct Sha2Context sha2ctx;
+
   // initialize hmac keys
-  memset(ctx->k, 0, sizeof(ctx->k));
-  memset(ctx->k_ipad, 0x36, sizeof(ctx->k_ipad));
-  memset(ctx->k_opad, 0x5c, sizeof(ctx->k_opad));
-  memcpy(ctx->k, inKey, keyLen);
-  ctx->is_hmac_updated = false;
+  memset(k, 0, sizeof(k));
+  if (keyLen > SHA2_BLOCK_SIZE) {
+    sha256(inKey, (uint32_t)keyLen, k, SHA2_HASH_SIZE);
+  } else if (keyLen > 0) {
+    memcpy(k, inKey, keyLen);
+  }
+
+  // XOR key with ipad and opad values, and keep the states after hashing them
+  for (size_t i = 0; i < SHA2_BLOCK_SIZE; i++) k_pad[i] = k[i] ^ 0x36;
+  sha2init(&sha2ctx);
+  sha2processBytes(&sha2ctx, k_pad, sizeof(k_pad));
+  memcpy(key->istate, sha2ctx.h, sizeof(key->istate));
+
+  for (size_t i = 0; i < SHA2_BLOCK_SIZE; i++) k_pad[i] = k[i] ^ 0x5c;
+  sha2init(&sha2ctx);
+  sha2processBytes(&sha2ctx, k_pad, sizeof(k_pad));
+  memcpy(key->ostate, sha2ctx.h, sizeof(key->ostate));
+}
 
-  // XOR key with ipad and opad values
-  for (size_t i = 0; i < SHA2_BLOCK_SIZE; i++) {
-    ctx->k_ipad[i] ^= ctx->k[i];
-    ctx->k_opad[i] ^= ctx->k[i];
+void hmacInitWithKey(struct HmacContext *ctx, const struct HmacKey *key) {
+  if (&ctx->key != key) {
+    ctx->key = *key;
   }
-  // initialize sha2 context and update hmac keys to the sha2 context
+  ctx->is_hmac_updated = false;
   sha2InitHmacKeyUpdate(ctx);
 }
 
+void hmacInit(struct HmacContext *ctx, const void *inKey, const size_t keyLen) {
+  hmacKeyInit(&ctx->key, inKey, keyLen);
+  hmacInitWithKey(ctx, &ctx->key);
+}
+
 void hmacUpdate(struct HmacContext *ctx, const void *inData,
                 const size_t dataLen) {
   // update the input data to the sha2 context
@@ -62,13 +82,14 @@ void hmacUpdateHashInit(struct HmacContext *ctx, const void *inData,
 }
 
 void hmacFinish(struct HmacContext *ctx, void *outHash, const size_t hashLen) {
+  uint8_t ihash[SHA2_HASH_SIZE];
+
   // finish inner sha256
-  sha2finish(&ctx->sha2ctx, ctx->ihash, sizeof(ctx->ihash));
+  sha2finish(&ctx->sha2ctx, ihash, sizeof(ihash));
 
-  // perform outer sha256
-  sha2init(&ctx->sha2ctx);
-  sha2processBytes(&ctx->sha2ctx, ctx->k_opad, sizeof(ctx->k_opad));
-  sha2processBytes(&ctx->sha2ctx, ctx->ihash, sizeof(ctx->ihash));
+  // perform outer sha256, resuming after the outer padded key
+  sha2initWithState(&ctx->sha2ctx, ctx->key.ostate, SHA2_BLOCK_SIZE);
+  sha2processBytes(&ctx->sha2ctx, ihash, sizeof(ihash));
   sha2finish(&ctx->sha2ctx, outHash, (uint32_t)hashLen);
 }
 
@@ -27,6 +27,8 @@ extern "C" {
  *
  * External separated APIs:
  *  - hmacInit() for initializing hmac keys and hash context
+ *  - hmacKeyInit() and hmacInitWithKey() for initializing the hmac keys once
+ *    and reusing them for many messages
  *  - hmacUpdate() for updating input data
  *  - hmacUpdateHashInit() for initializing hash context and updating input data
  *  - hmacFinish() for generating HMAC-SHA256 keyed-hash output
@@ -39,11 +41,15 @@ extern "C" {
 
 #include "location/lbs/contexthub/nanoapps/nearby/crypto/sha2.h"
 
+// HMAC key, as the SHA256 states after hashing the padded key XORed with
+// ipad and opad, so that each message only costs its own blocks
+struct HmacKey {
+  uint32_t istate[SHA2_HASH_WORDS];
+  uint32_t ostate[SHA2_HASH_WORDS];
+};
+
 struct HmacContext {
-  uint8_t k[SHA2_BLOCK_SIZE];
-  uint8_t k_ipad[SHA2_BLOCK_SIZE];
-  uint8_t k_opad[SHA2_BLOCK_SIZE];
-  uint8_t ihash[SHA2_HASH_SIZE];
+  struct HmacKey key;
   struct Sha2Context sha2ctx;
   bool is_hmac_updated;
 };
@@ -79,6 +85,31 @@ void hmacSha256(const void *inKey, size_t keyLen, const void *inData,
  */
 void hmacInit(struct HmacContext *ctx, const void *inKey, size_t keyLen);
 
+/**
+ * hmacKeyInit:
+ * @key: HMAC key
+ * @inKey: input key byte array
+ * @keyLen: number of bytes of the input key array.
+ *     keys longer than SHA2_BLOCK_SIZE are hashed first.
+ *
+ * Initializes hmac keys, which can be used by hmacInitWithKey() any number of
+ * times
+ *
+ * Returns:
+ */
+void hmacKeyInit(struct HmacKey *key, const void *inKey, size_t keyLen);
+
+/**
+ * hmacInitWithKey:
+ * @ctx: HMAC context
+ * @key: HMAC key initialized by hmacKeyInit()
+ *
+ * Initializes hash context with hmac keys initialized beforehand
+ *
+ * Returns:
+ */
+void hmacInitWithKey(struct HmacContext *ctx, const struct HmacKey *key);
+
 /**
  * hmacUpdate:
  * @ctx: HMAC context
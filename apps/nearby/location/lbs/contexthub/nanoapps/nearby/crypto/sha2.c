@@ -18,20 +18,6 @@
 
 #include <string.h>
 
-inline static uint32_t BSWAP32(uint32_t value) {
-#if defined(__clang__) || \
-    (defined(__GNUC__) && \
-     ((__GNUC__ == 4 && __GNUC_MINOR__ >= 8) || __GNUC__ >= 5))
-  return __builtin_bswap32(value);
-#else
-  uint32_t Byte0 = value & 0x000000FF;
-  uint32_t Byte1 = value & 0x0000FF00;
-  uint32_t Byte2 = value & 0x00FF0000;
-  uint32_t Byte3 = value & 0xFF000000;
-  return (Byte0 << 24) | (Byte1 << 8) | (Byte2 >> 8) | (Byte3 >> 24);
-#endif
-}
-
 void sha2init(struct Sha2Context *ctx) {
   ctx->h[0] = 0x6a09e667;
   ctx->h[1] = 0xbb67ae85;
@@ -45,6 +31,13 @@ void sha2init(struct Sha2Context *ctx) {
   ctx->bufBytesUsed = 0;
 }
 
+void sha2initWithState(struct Sha2Context *ctx,
+                       const uint32_t state[SHA2_HASH_WORDS], size_t msgLen) {
+  memcpy(ctx->h, state, sizeof(ctx->h));
+  ctx->msgLen = msgLen;
+  ctx->bufBytesUsed = 0;
+}
+
 #ifdef ARM
 
 #define STRINFIGY2(b) #b
@@ -71,7 +64,42 @@ inline static uint32_t ror(uint32_t val, uint32_t by) {
 
 #endif
 
-static void sha2processBlock(struct Sha2Context *ctx) {
+// SHA specification uses big-endian words, whatever the host byte order
+inline static uint32_t loadBe32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+inline static void storeBe32(uint8_t *p, uint32_t value) {
+  p[0] = (uint8_t)(value >> 24);
+  p[1] = (uint8_t)(value >> 16);
+  p[2] = (uint8_t)(value >> 8);
+  p[3] = (uint8_t)value;
+}
+
+#define SHA2_CH(e, f, g) ((g) ^ ((e) & ((f) ^ (g))))
+#define SHA2_MAJ(a, b, c) (((a) & (b)) | ((c) & ((a) | (b))))
+#define SHA2_BSIG0(x) (ror(x, 2) ^ ror(x, 13) ^ ror(x, 22))
+#define SHA2_BSIG1(x) (ror(x, 6) ^ ror(x, 11) ^ ror(x, 25))
+#define SHA2_SSIG0(x) (ror(x, 7) ^ ror(x, 18) ^ ((x) >> 3))
+#define SHA2_SSIG1(x) (ror(x, 17) ^ ror(x, 19) ^ ((x) >> 10))
+
+// the message schedule only keeps the last 16 words, w[i & 15] is replaced by
+// w[i] in round i
+#define SHA2_EXPAND(w, i)                                                   \
+  ((w)[(i)&15] += SHA2_SSIG1((w)[((i)-2) & 15]) + (w)[((i)-7) & 15] +      \
+                  SHA2_SSIG0((w)[((i)-15) & 15]))
+
+// one round, with the working variables renamed instead of shifted
+#define SHA2_ROUND(a, b, c, d, e, f, g, h, ki, wi)          \
+  do {                                                      \
+    h += SHA2_BSIG1(e) + SHA2_CH(e, f, g) + (ki) + (wi);    \
+    d += h;                                                 \
+    h += SHA2_BSIG0(a) + SHA2_MAJ(a, b, c);                 \
+  } while (0)
+
+static void sha2processBlock(uint32_t state[SHA2_HASH_WORDS],
+                             const uint8_t *block) {
   static const uint32_t k[] = {
       0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
       0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
@@ -85,61 +113,53 @@ static void sha2processBlock(struct Sha2Context *ctx) {
       0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
       0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
   };
+  uint32_t w[16];
   uint32_t i, a, b, c, d, e, f, g, h;
 
-  // input and output streams are little-endian
-  // SHA specification uses big-endian
-  // byteswap the input
-  for (i = 0; i < SHA2_BLOCK_SIZE / sizeof(uint32_t); i++)
-    ctx->w[i] = BSWAP32(ctx->w[i]);
-
-  // expand input
-  for (; i < SHA2_WORDS_CTX_SIZE; i++) {
-    uint32_t s0 = ror(ctx->w[i - 15], 7) ^ ror(ctx->w[i - 15], 18) ^
-                  (ctx->w[i - 15] >> 3);
-    uint32_t s1 =
-        ror(ctx->w[i - 2], 17) ^ ror(ctx->w[i - 2], 19) ^ (ctx->w[i - 2] >> 10);
-    ctx->w[i] = ctx->w[i - 16] + s0 + ctx->w[i - 7] + s1;
-  }
+  for (i = 0; i < 16; i++) w[i] = loadBe32(block + i * sizeof(uint32_t));
 
   // init working variables
-  a = ctx->h[0];
-  b = ctx->h[1];
-  c = ctx->h[2];
-  d = ctx->h[3];
-  e = ctx->h[4];
-  f = ctx->h[5];
-  g = ctx->h[6];
-  h = ctx->h[7];
-
-  // 64 rounds
-  for (i = 0; i < 64; i++) {
-    uint32_t s1 = ror(e, 6) ^ ror(e, 11) ^ ror(e, 25);
-    uint32_t ch = (e & f) ^ ((~e) & g);
-    uint32_t temp1 = h + s1 + ch + k[i] + ctx->w[i];
-    uint32_t s0 = ror(a, 2) ^ ror(a, 13) ^ ror(a, 22);
-    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
-    uint32_t temp2 = s0 + maj;
-
-    h = g;
-    g = f;
-    f = e;
-    e = d + temp1;
-    d = c;
-    c = b;
-    b = a;
-    a = temp1 + temp2;
+  a = state[0];
+  b = state[1];
+  c = state[2];
+  d = state[3];
+  e = state[4];
+  f = state[5];
+  g = state[6];
+  h = state[7];
+
+  // 64 rounds, 8 at a time so that the working variables are back in place
+  // at the end of each iteration
+  for (i = 0; i < 64; i += 8) {
+    if (i >= 16) {
+      SHA2_EXPAND(w, i + 0);
+      SHA2_EXPAND(w, i + 1);
+      SHA2_EXPAND(w, i + 2);
+      SHA2_EXPAND(w, i + 3);
+      SHA2_EXPAND(w, i + 4);
+      SHA2_EXPAND(w, i + 5);
+      SHA2_EXPAND(w, i + 6);
+      SHA2_EXPAND(w, i + 7);
+    }
+    SHA2_ROUND(a, b, c, d, e, f, g, h, k[i + 0], w[(i + 0) & 15]);
+    SHA2_ROUND(h, a, b, c, d, e, f, g, k[i + 1], w[(i + 1) & 15]);
+    SHA2_ROUND(g, h, a, b, c, d, e, f, k[i + 2], w[(i + 2) & 15]);
+    SHA2_ROUND(f, g, h, a, b, c, d, e, k[i + 3], w[(i + 3) & 15]);
+    SHA2_ROUND(e, f, g, h, a, b, c, d, k[i + 4], w[(i + 4) & 15]);
+    SHA2_ROUND(d, e, f, g, h, a, b, c, k[i + 5], w[(i + 5) & 15]);
+    SHA2_ROUND(c, d, e, f, g, h, a, b, k[i + 6], w[(i + 6) & 15]);
+    SHA2_ROUND(b, c, d, e, f, g, h, a, k[i + 7], w[(i + 7) & 15]);
   }
 
   // put result back into context
-  ctx->h[0] += a;
-  ctx->h[1] += b;
-  ctx->h[2] += c;
-  ctx->h[3] += d;
-  ctx->h[4] += e;
-  ctx->h[5] += f;
-  ctx->h[6] += g;
-  ctx->h[7] += h;
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
 }
 
 void sha2processBytes(struct Sha2Context *ctx, const void *inData,
@@ -150,7 +170,16 @@ void sha2processBytes(struct Sha2Context *ctx, const void *inData,
   while (dataLen) {
     size_t bytesToCopy;
 
-    // step 1: copy data into context if there is space & there is data
+    // step 1: process full blocks straight from the input when the buffer is
+    // empty, without copying them into the context
+    if (ctx->bufBytesUsed == 0 && dataLen >= SHA2_BLOCK_SIZE) {
+      sha2processBlock(ctx->h, inBytes);
+      inBytes += SHA2_BLOCK_SIZE;
+      dataLen -= SHA2_BLOCK_SIZE;
+      continue;
+    }
+
+    // step 2: copy data into context if there is space & there is data
     bytesToCopy = dataLen;
     if (bytesToCopy > SHA2_BLOCK_SIZE - ctx->bufBytesUsed)
       bytesToCopy = SHA2_BLOCK_SIZE - ctx->bufBytesUsed;
@@ -159,42 +188,46 @@ void sha2processBytes(struct Sha2Context *ctx, const void *inData,
     dataLen -= bytesToCopy;
     ctx->bufBytesUsed += bytesToCopy;
 
-    // step 2: if there is a full block, process it
+    // step 3: if there is a full block, process it
     if (ctx->bufBytesUsed == SHA2_BLOCK_SIZE) {
-      sha2processBlock(ctx);
+      sha2processBlock(ctx->h, ctx->b);
       ctx->bufBytesUsed = 0;
     }
   }
 }
 
 void sha2finish(struct Sha2Context *ctx, void *outHash, uint32_t hashLen) {
-  uint8_t appendend = 0x80;
-  uint64_t dataLenInBits = ctx->msgLen * 8;
+  uint64_t dataLenInBits = (uint64_t)ctx->msgLen * 8;
+  uint8_t hash[SHA2_HASH_SIZE];
   uint32_t minHashLen;
 
   // append the one
-  sha2processBytes(ctx, &appendend, 1);
-
-  // append the zeroes
-  appendend = 0;
-  while (ctx->bufBytesUsed != 56) sha2processBytes(ctx, &appendend, 1);
+  ctx->b[ctx->bufBytesUsed++] = 0x80;
+
+  // append the zeroes, in an extra block if the length does not fit
+  if (ctx->bufBytesUsed > SHA2_BLOCK_SIZE - sizeof(dataLenInBits)) {
+    memset(ctx->b + ctx->bufBytesUsed, 0,
+           SHA2_BLOCK_SIZE - ctx->bufBytesUsed);
+    sha2processBlock(ctx->h, ctx->b);
+    ctx->bufBytesUsed = 0;
+  }
+  memset(ctx->b + ctx->bufBytesUsed, 0,
+         SHA2_BLOCK_SIZE - sizeof(dataLenInBits) - ctx->bufBytesUsed);
 
-  // append the length in bits (we can safely write into context since we're
-  // sure where to write to (we're definitely 56-bytes into a block)
+  // append the length in bits
   for (uint32_t i = 0; i < 8; i++, dataLenInBits >>= 8)
     ctx->b[63 - i] = (uint8_t)(dataLenInBits);
 
   // process last block
-  sha2processBlock(ctx);
+  sha2processBlock(ctx->h, ctx->b);
+  ctx->bufBytesUsed = 0;
 
-  // input and output streams are little-endian
   // SHA specification uses big-endian
-  // copy the final hash to the output after byteswap
-  for (uint32_t i = 0; i < sizeof(ctx->h) / sizeof(uint32_t); i++)
-    ctx->h[i] = BSWAP32(ctx->h[i]);
+  for (uint32_t i = 0; i < SHA2_HASH_WORDS; i++)
+    storeBe32(hash + i * sizeof(uint32_t), ctx->h[i]);
 
   minHashLen = (hashLen > SHA2_HASH_SIZE) ? SHA2_HASH_SIZE : hashLen;
-  memcpy(outHash, ctx->h, minHashLen);
+  memcpy(outHash, hash, minHashLen);
 }
 
 void sha256(const void *inData, const uint32_t dataLen, void *outHash,
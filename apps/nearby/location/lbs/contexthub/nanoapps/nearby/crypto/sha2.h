@@ -27,6 +27,7 @@ extern "C" {
  *
  * External separated APIs:
  *  - sha2init() for SHA256 initialization
+ *  - sha2initWithState() for resuming from a saved intermediate hash state
  *  - sha2processBytes() for updating input data
  *  - sha2finish() for generating SHA256 hash output
  *
@@ -38,7 +39,7 @@ extern "C" {
 #include <stdint.h>
 
 #define SHA2_BLOCK_SIZE 64U      // in bytes
-#define SHA2_WORDS_CTX_SIZE 64U  // in words
+#define SHA2_WORDS_CTX_SIZE 16U  // in words
 
 #define SHA2_HASH_SIZE 32U  // in bytes
 #define SHA2_HASH_WORDS 8U  // in words
@@ -80,6 +81,22 @@ void sha256(const void *inData, uint32_t dataLen, void *outHash,
  */
 void sha2init(struct Sha2Context *ctx);
 
+/**
+ * sha2initWithState:
+ * @ctx: SHA256 context
+ * @state: intermediate hash state, i.e. ctx->h after processing whole blocks
+ * @msgLen: number of bytes processed to reach the state.
+ *     it must be a multiple of SHA2_BLOCK_SIZE.
+ *
+ * Initializes the SHA256 context as if the bytes hashed to the state had been
+ * processed, e.g. to reuse the hashing of a constant prefix such as an HMAC
+ * padded key
+ *
+ * Returns:
+ */
+void sha2initWithState(struct Sha2Context *ctx,
+                       const uint32_t state[SHA2_HASH_WORDS], size_t msgLen);
+
 /**
  * sha2processBytes:
  * @ctx: SHA256 context initialized
@@ -46,6 +46,10 @@ bool Filter::Update(const uint8_t *message, uint32_t message_size) {
     LOGE("Failed to decode a Filters message.");
     return false;
   }
+#ifdef ENABLE_PRESENCE
+  // The keys derived from the previous certificates are no longer needed.
+  presence_crypto_.ClearKeyCache();
+#endif
   // Print filters for debug.
   LOGD_SENSITIVE_INFO("BLE filters counter %d", ble_filters_.filter_count);
   if (ble_filters_.filter_count > 0) {
@@ -124,7 +128,7 @@ void Filter::MatchBle(
 #ifdef ENABLE_PRESENCE
     if (MatchPresenceV0(ble_filters_.filter[filter_index], record, &result) ||
         MatchPresenceV1(ble_filters_.filter[filter_index], record,
-                        PresenceCryptoMicImpl(), &result)) {
+                        presence_crypto_, &result)) {
       LOGD("Filter result TX power %" PRId32 ", RSSI %" PRId32, result.tx_power,
            result.rssi);
 
@@ -17,6 +17,9 @@
 #ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FILTER_H_
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_FILTER_H_
 
+#ifdef ENABLE_PRESENCE
+#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_mic.h"
+#endif
 #include "location/lbs/contexthub/nanoapps/nearby/proto/ble_filter.nanopb.h"
 #include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
 
@@ -48,6 +51,11 @@ class Filter {
   nearby_BleFilters ble_filters_ = nearby_BleFilters_init_zero;
   // BLE Scan interval. Default to 1 minute.
   uint64_t scan_interval_ms_ = 60 * 1000;
+#ifdef ENABLE_PRESENCE
+  // Kept across advertisements so that the keys derived from the certificates
+  // are reused.
+  PresenceCryptoMicImpl presence_crypto_;
+#endif
 };
 
 }  // namespace nearby
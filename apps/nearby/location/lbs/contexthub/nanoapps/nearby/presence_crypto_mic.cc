@@ -33,36 +33,21 @@ namespace nearby {
 bool PresenceCryptoMicImpl::decrypt(const ByteArray &input,
                                     const ByteArray &salt, const ByteArray &key,
                                     ByteArray &output) const {
-  if (salt.length != kSaltSize && salt.length != kEncryptionInfoSize - 1) {
-    LOGE("Invalid salt size");
-    return false;
-  }
   if (input.length != output.length) {
     LOGE("Output length is not equal to input length.");
     return false;
   }
 
-  // Generate a 32 bytes decryption key from authenticity_key
-  uint8_t decryption_key[kAesKeySize] = {0};
-  hkdf(reinterpret_cast<const uint8_t *>(kHkdfSalt), STR_LEN_NO_TERM(kHkdfSalt),
-       key.data, key.length, reinterpret_cast<const uint8_t *>(kAesKeyInfo),
-       STR_LEN_NO_TERM(kAesKeyInfo), decryption_key,
-       ARRAY_SIZE(decryption_key));
-
   // Generate nonce
   uint8_t nonce[kAdvNonceSizeSaltDe] = {0};
-  hkdf(reinterpret_cast<const uint8_t *>(kHkdfSalt), STR_LEN_NO_TERM(kHkdfSalt),
-       salt.data, salt.length,
-       reinterpret_cast<const uint8_t *>(kAdvNonceInfoSaltDe),
-       STR_LEN_NO_TERM(kAdvNonceInfoSaltDe), nonce, ARRAY_SIZE(nonce));
-
-  // Decrypt the input cipher text using the decryption key
-  struct AesCtrContext ctx;
-  if (aesCtrInit(&ctx, decryption_key, nonce, AES_128_KEY_TYPE) < 0) {
-    LOGE("aesCtrInit() is failed");
+  if (!DeriveNonce(salt, nonce)) {
     return false;
   }
-  aesCtr(&ctx, input.data, output.data, output.length);
+
+  // Decrypt the input cipher text using the decryption key derived from the
+  // authenticity key
+  DerivedKeys storage;
+  DecryptWithKeys(input, nonce, GetDerivedKeys(key, storage), output);
   return true;
 }
 
@@ -71,7 +56,6 @@ bool PresenceCryptoMicImpl::decrypt(const ByteArray &input,
 bool PresenceCryptoMicImpl::verify(const ByteArray &metadataKey,
                                    const ByteArray &authenticityKey,
                                    const ByteArray &tag) const {
-  UNUSED_VAR(authenticityKey);
   if (metadataKey.data == nullptr || tag.data == nullptr) {
     LOGE("Null pointer was found in input parameter");
     return false;
@@ -80,16 +64,123 @@ bool PresenceCryptoMicImpl::verify(const ByteArray &metadataKey,
     LOGE("Invalid signature size");
     return false;
   }
-  // Generates a 32 bytes HMAC tag from the data
+  DerivedKeys storage;
+  return VerifyWithKeys(metadataKey, GetDerivedKeys(authenticityKey, storage),
+                        tag);
+}
+
+size_t PresenceCryptoMicImpl::FindKey(const ByteArray &encrypted_identity,
+                                      const ByteArray &salt,
+                                      const ByteArray keys[],
+                                      const ByteArray signatures[],
+                                      size_t num_keys,
+                                      ByteArray &identity) const {
+  if (encrypted_identity.length != identity.length) {
+    LOGE("Output length is not equal to input length.");
+    return num_keys;
+  }
+
+  // The nonce only depends on the advertisement.
+  uint8_t nonce[kAdvNonceSizeSaltDe] = {0};
+  if (!DeriveNonce(salt, nonce)) {
+    return num_keys;
+  }
+
+  for (size_t i = 0; i < num_keys; i++) {
+    if (signatures[i].data == nullptr ||
+        signatures[i].length != SHA2_HASH_SIZE) {
+      LOGE("Invalid signature size");
+      continue;
+    }
+    DerivedKeys storage;
+    const DerivedKeys &derived_keys = GetDerivedKeys(keys[i], storage);
+    DecryptWithKeys(encrypted_identity, nonce, derived_keys, identity);
+    if (VerifyWithKeys(identity, derived_keys, signatures[i])) {
+      return i;
+    }
+  }
+  return num_keys;
+}
+
+const PresenceCryptoMicImpl::DerivedKeys &PresenceCryptoMicImpl::GetDerivedKeys(
+    const ByteArray &authenticity_key, DerivedKeys &storage) const {
+  bool cacheable = authenticity_key.length <= kMaxCachedAuthenticityKeySize;
+  if (cacheable) {
+    for (const DerivedKeys &keys : key_cache_) {
+      if (keys.authenticity_key_length == authenticity_key.length &&
+          memcmp(keys.authenticity_key, authenticity_key.data,
+                 authenticity_key.length) == 0) {
+        return keys;
+      }
+    }
+  }
+
+  // Generate a 16 bytes decryption key from authenticity_key
+  uint8_t decryption_key[kAesKeySize] = {0};
+  hkdf(reinterpret_cast<const uint8_t *>(kHkdfSalt), STR_LEN_NO_TERM(kHkdfSalt),
+       authenticity_key.data, authenticity_key.length,
+       reinterpret_cast<const uint8_t *>(kAesKeyInfo),
+       STR_LEN_NO_TERM(kAesKeyInfo), decryption_key,
+       ARRAY_SIZE(decryption_key));
+  struct AesCtrContext ctx;
+  uint8_t zero_iv[AES_BLOCK_SIZE] = {0};
+  aesCtrInit(&ctx, decryption_key, zero_iv, AES_128_KEY_TYPE);
+  storage.aes = ctx.aes;
+
+  // Generates a 32 bytes HMAC key for the metadata encryption key tag
   uint8_t hmac_key[kHmacKeySize] = {0};
   hkdf(reinterpret_cast<const uint8_t *>(kHkdfSalt), STR_LEN_NO_TERM(kHkdfSalt),
-       authenticityKey.data, authenticityKey.length, kMetadataKeyHmacKeyInfo,
+       authenticity_key.data, authenticity_key.length, kMetadataKeyHmacKeyInfo,
        STR_LEN_NO_TERM(kMetadataKeyHmacKeyInfo), hmac_key,
        ARRAY_SIZE(hmac_key));
+  hmacKeyInit(&storage.metadata_key_hmac_key, hmac_key, ARRAY_SIZE(hmac_key));
+
+  if (!cacheable) {
+    return storage;
+  }
+  memcpy(storage.authenticity_key, authenticity_key.data,
+         authenticity_key.length);
+  storage.authenticity_key_length = authenticity_key.length;
+  if (key_cache_.size() < kMaxCachedKeys) {
+    return key_cache_.push_back(storage) ? key_cache_.back() : storage;
+  }
+  DerivedKeys &evicted_keys = key_cache_[next_evicted_key_];
+  next_evicted_key_ = (next_evicted_key_ + 1) % kMaxCachedKeys;
+  evicted_keys = storage;
+  return evicted_keys;
+}
+
+bool PresenceCryptoMicImpl::DeriveNonce(const ByteArray &salt,
+                                        uint8_t nonce[]) const {
+  if (salt.length != kSaltSize && salt.length != kEncryptionInfoSize - 1) {
+    LOGE("Invalid salt size");
+    return false;
+  }
+  hkdf(reinterpret_cast<const uint8_t *>(kHkdfSalt), STR_LEN_NO_TERM(kHkdfSalt),
+       salt.data, salt.length,
+       reinterpret_cast<const uint8_t *>(kAdvNonceInfoSaltDe),
+       STR_LEN_NO_TERM(kAdvNonceInfoSaltDe), nonce, kAdvNonceSizeSaltDe);
+  return true;
+}
+
+void PresenceCryptoMicImpl::DecryptWithKeys(const ByteArray &input,
+                                            const uint8_t nonce[],
+                                            const DerivedKeys &keys,
+                                            ByteArray &output) {
+  struct AesCtrContext ctx;
+  ctx.aes = keys.aes;
+  aesCtrSetIv(&ctx, nonce);
+  aesCtr(&ctx, input.data, output.data, output.length);
+}
 
+bool PresenceCryptoMicImpl::VerifyWithKeys(const ByteArray &metadata_key,
+                                           const DerivedKeys &keys,
+                                           const ByteArray &tag) {
   uint8_t hmac_tag[SHA2_HASH_SIZE];
-  hmacSha256(hmac_key, ARRAY_SIZE(hmac_key), metadataKey.data,
-             metadataKey.length, hmac_tag, sizeof(hmac_tag));
+  struct HmacContext ctx;
+  hmacInitWithKey(&ctx, &keys.metadata_key_hmac_key);
+  hmacUpdate(&ctx, metadata_key.data, metadata_key.length);
+  hmacFinish(&ctx, hmac_tag, sizeof(hmac_tag));
 
   // Verifies the generated HMAC tag matching the signature
   volatile uint8_t diff = 0;
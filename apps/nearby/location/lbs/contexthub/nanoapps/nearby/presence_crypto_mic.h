@@ -15,7 +15,13 @@
  */
 #ifndef LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_MIC_H_
 #define LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_MIC_H_
+#include <cstddef>
+#include <cstdint>
+
 #include "location/lbs/contexthub/nanoapps/nearby/crypto.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hmac.h"
+#include "third_party/contexthub/chre/util/include/chre/util/dynamic_vector.h"
 
 namespace nearby {
 static constexpr size_t kSaltSize = 2;
@@ -31,8 +37,58 @@ class PresenceCryptoMicImpl : public Crypto {
   // at the end of the advertisement.
   bool verify(const ByteArray &input, const ByteArray &key,
               const ByteArray &signature) const override;
+  // Tries a batch of authenticity keys against one advertisement. The nonce
+  // derived from the salt is computed once for all the keys, and the keys
+  // derived from each authenticity key are cached across calls, so that each
+  // key only costs one AES block and one HMAC of the identity.
+  size_t FindKey(const ByteArray &encrypted_identity, const ByteArray &salt,
+                 const ByteArray keys[], const ByteArray signatures[],
+                 size_t num_keys, ByteArray &identity) const override;
+
+  // Drops the keys derived from the authenticity keys used so far, e.g. when
+  // the credentials are replaced.
+  void ClearKeyCache() {
+    key_cache_.clear();
+    next_evicted_key_ = 0;
+  }
 
  private:
+  // Maximum size of the authenticity keys whose derived keys are cached.
+  static constexpr size_t kMaxCachedAuthenticityKeySize = 32;
+
+  // Keys derived from an authenticity key, which do not depend on the
+  // advertisement.
+  struct DerivedKeys {
+    uint8_t authenticity_key[kMaxCachedAuthenticityKeySize];
+    size_t authenticity_key_length;
+    // Round keys of the AES key decrypting the section.
+    struct AesContext aes;
+    // HMAC key computing the metadata key tag.
+    struct HmacKey metadata_key_hmac_key;
+  };
+
+  // Maximum number of cached derived keys, i.e. the maximum number of
+  // certificates of all filters.
+  static constexpr size_t kMaxCachedKeys = 30;
+
+  // Returns the keys derived from an authenticity key, from the cache if it
+  // was used before. Otherwise derives them into storage and caches them.
+  // The returned reference is valid until the next call.
+  const DerivedKeys &GetDerivedKeys(const ByteArray &authenticity_key,
+                                    DerivedKeys &storage) const;
+
+  // Derives the nonce of an advertisement from its salt. Returns false if the
+  // salt is invalid.
+  bool DeriveNonce(const ByteArray &salt, uint8_t nonce[]) const;
+
+  // Decrypts input with the derived keys and the nonce of the advertisement.
+  static void DecryptWithKeys(const ByteArray &input, const uint8_t nonce[],
+                              const DerivedKeys &keys, ByteArray &output);
+
+  // Verifies the HMAC tag of the metadata key with the derived keys.
+  static bool VerifyWithKeys(const ByteArray &metadata_key,
+                             const DerivedKeys &keys, const ByteArray &tag);
+
   static constexpr char kAesKeyInfo[] = "Unsigned Section AES key";
   static constexpr size_t kAesKeySize = 16;
   static constexpr size_t kEncryptionInfoSize = 17;
@@ -44,6 +100,11 @@ class PresenceCryptoMicImpl : public Crypto {
   // are merged.
   static constexpr char kMetadataKeyHmacKeyInfo[] =
       "Unsigned Section metadata key HMAC key";
+
+  // Derived keys of the most recently used authenticity keys, evicted in
+  // round robin once full.
+  mutable chre::DynamicVector<DerivedKeys> key_cache_;
+  mutable size_t next_evicted_key_ = 0;
 };
 }  // namespace nearby
 #endif  // LOCATION_LBS_CONTEXTHUB_NANOAPPS_NEARBY_PRESENCE_CRYPTO_MIC_H_
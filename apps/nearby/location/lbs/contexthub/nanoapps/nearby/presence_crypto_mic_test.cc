@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "location/lbs/contexthub/nanoapps/nearby/presence_crypto_mic.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "location/lbs/contexthub/nanoapps/nearby/byte_array.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/aes.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hkdf.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/hmac.h"
+#include "location/lbs/contexthub/nanoapps/nearby/crypto/sha2.h"
+
+namespace nearby {
+namespace {
+
+constexpr size_t kAuthenticityKeyLength = 32;
+constexpr size_t kIdentityLength = 16;
+constexpr size_t kSaltLength = 2;
+// The maximum number of certificates of a filter times the maximum number of
+// filters.
+constexpr size_t kNumCertificates = 30;
+
+constexpr char kHkdfSalt[] = "Google Nearby";
+
+std::vector<uint8_t> Hkdf(const std::vector<uint8_t> &key, const char *info,
+                          size_t length) {
+  std::vector<uint8_t> output(length);
+  hkdf(reinterpret_cast<const uint8_t *>(kHkdfSalt), strlen(kHkdfSalt),
+       key.data(), key.size(), reinterpret_cast<const uint8_t *>(info),
+       strlen(info), output.data(), output.size());
+  return output;
+}
+
+// A certificate and an advertisement encrypted with it, computed from the
+// Presence v1 specification with the crypto primitives only.
+struct TestCertificate {
+  std::vector<uint8_t> authenticity_key;
+  std::vector<uint8_t> metadata_encryption_key_tag;
+  std::vector<uint8_t> identity;
+
+  // Certificates with seeds that differ modulo 256 have different keys.
+  explicit TestCertificate(uint32_t seed)
+      : authenticity_key(kAuthenticityKeyLength), identity(kIdentityLength) {
+    for (size_t i = 0; i < authenticity_key.size(); i++) {
+      authenticity_key[i] = static_cast<uint8_t>(seed * 97 + i * 13);
+    }
+    for (size_t i = 0; i < identity.size(); i++) {
+      identity[i] = static_cast<uint8_t>(seed * 31 + i);
+    }
+    std::vector<uint8_t> hmac_key = Hkdf(
+        authenticity_key, "Unsigned Section metadata key HMAC key", 32);
+    metadata_encryption_key_tag.resize(SHA2_HASH_SIZE);
+    hmacSha256(hmac_key.data(), hmac_key.size(), identity.data(),
+               identity.size(), metadata_encryption_key_tag.data(),
+               metadata_encryption_key_tag.size());
+  }
+
+  std::vector<uint8_t> Encrypt(const std::vector<uint8_t> &salt,
+                               const std::vector<uint8_t> &plain_text) const {
+    std::vector<uint8_t> aes_key =
+        Hkdf(authenticity_key, "Unsigned Section AES key", 16);
+    std::vector<uint8_t> nonce = Hkdf(salt, "Unsigned Section IV", 16);
+    std::vector<uint8_t> cipher_text(plain_text.size());
+    struct AesCtrContext ctx;
+    aesCtrInit(&ctx, aes_key.data(), nonce.data(), AES_128_KEY_TYPE);
+    aesCtr(&ctx, plain_text.data(), cipher_text.data(), plain_text.size());
+    return cipher_text;
+  }
+};
+
+ByteArray ToByteArray(std::vector<uint8_t> &bytes) {
+  return ByteArray(bytes.data(), bytes.size());
+}
+
+class PresenceCryptoMicTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (uint32_t i = 0; i < kNumCertificates; i++) {
+      certificates_.emplace_back(i);
+    }
+    for (TestCertificate &certificate : certificates_) {
+      keys_.push_back(ToByteArray(certificate.authenticity_key));
+      tags_.push_back(ToByteArray(certificate.metadata_encryption_key_tag));
+    }
+  }
+
+  std::vector<TestCertificate> certificates_;
+  std::vector<ByteArray> keys_;
+  std::vector<ByteArray> tags_;
+};
+
+TEST_F(PresenceCryptoMicTest, DecryptsAndVerifiesAdvertisement) {
+  PresenceCryptoMicImpl crypto;
+  std::vector<uint8_t> salt = {0x12, 0x34};
+  std::vector<uint8_t> plain_text(kIdentityLength + 20);
+  for (size_t i = 0; i < plain_text.size(); i++) {
+    plain_text[i] = (i < kIdentityLength) ? certificates_[3].identity[i]
+                                          : static_cast<uint8_t>(i);
+  }
+  std::vector<uint8_t> cipher_text = certificates_[3].Encrypt(salt, plain_text);
+
+  // Twice, the second time with the cached keys.
+  for (int i = 0; i < 2; i++) {
+    std::vector<uint8_t> output(cipher_text.size());
+    ByteArray output_array = ToByteArray(output);
+    ASSERT_TRUE(crypto.decrypt(ToByteArray(cipher_text), ToByteArray(salt),
+                               keys_[3], output_array));
+    EXPECT_EQ(output, plain_text);
+    output.resize(kIdentityLength);
+    EXPECT_TRUE(crypto.verify(ToByteArray(output), keys_[3], tags_[3]));
+    EXPECT_FALSE(crypto.verify(ToByteArray(output), keys_[4], tags_[3]));
+    EXPECT_FALSE(crypto.verify(ToByteArray(output), keys_[3], tags_[4]));
+  }
+
+  std::vector<uint8_t> output(cipher_text.size());
+  ByteArray output_array = ToByteArray(output);
+  std::vector<uint8_t> invalid_salt = {0x12, 0x34, 0x56};
+  EXPECT_FALSE(crypto.decrypt(ToByteArray(cipher_text),
+                              ToByteArray(invalid_salt), keys_[3],
+                              output_array));
+}
+
+TEST_F(PresenceCryptoMicTest, FindKeyMatchesDecryptAndVerify) {
+  PresenceCryptoMicImpl crypto;
+  std::vector<uint8_t> salt = {0xab, 0xcd};
+  std::vector<uint8_t> identity(kIdentityLength);
+  ByteArray identity_array = ToByteArray(identity);
+
+  for (size_t matching = 0; matching < kNumCertificates; matching += 7) {
+    std::vector<uint8_t> encrypted_identity =
+        certificates_[matching].Encrypt(salt, certificates_[matching].identity);
+    size_t index = crypto.FindKey(ToByteArray(encrypted_identity),
+                                  ToByteArray(salt), keys_.data(), tags_.data(),
+                                  kNumCertificates, identity_array);
+    EXPECT_EQ(index, matching);
+    EXPECT_EQ(identity, certificates_[matching].identity);
+
+    // The default implementation finds the same key.
+    size_t default_index = crypto.Crypto::FindKey(
+        ToByteArray(encrypted_identity), ToByteArray(salt), keys_.data(),
+        tags_.data(), kNumCertificates, identity_array);
+    EXPECT_EQ(default_index, matching);
+  }
+
+  // An advertisement from an unknown certificate matches no key.
+  TestCertificate unknown(200);
+  std::vector<uint8_t> encrypted_identity =
+      unknown.Encrypt(salt, unknown.identity);
+  EXPECT_EQ(crypto.FindKey(ToByteArray(encrypted_identity), ToByteArray(salt),
+                           keys_.data(), tags_.data(), kNumCertificates,
+                           identity_array),
+            kNumCertificates);
+
+  // The cached keys are still correct once replaced.
+  crypto.ClearKeyCache();
+  encrypted_identity =
+      certificates_[1].Encrypt(salt, certificates_[1].identity);
+  EXPECT_EQ(crypto.FindKey(ToByteArray(encrypted_identity), ToByteArray(salt),
+                           keys_.data(), tags_.data(), kNumCertificates,
+                           identity_array),
+            1);
+}
+
+}  // namespace
+}  // namespace nearby
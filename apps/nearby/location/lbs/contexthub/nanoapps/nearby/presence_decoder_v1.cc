@@ -39,6 +39,15 @@ namespace nearby {
 bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
                                const Crypto &crypto, const ByteArray &key,
                                const ByteArray &metadata_encryption_key_tag) {
+  size_t matched_key_index;
+  return Decode(encoded_data, crypto, &key, &metadata_encryption_key_tag,
+                1 /* num_keys */, &matched_key_index);
+}
+
+bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
+                               const Crypto &crypto, const ByteArray keys[],
+                               const ByteArray metadata_encryption_key_tags[],
+                               size_t num_keys, size_t *matched_key_index) {
   LOGI("Start V1 Decoding");
 
   // 1 + 1 + 1 + 2 + 2 + 16
@@ -91,14 +100,18 @@ bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
        i < (identity_data_index + DataElementHeaderV1::kIdentityLength); i++) {
     LOGD_SENSITIVE_INFO("%" PRIi8, data[i]);
   }
-  LOGD_SENSITIVE_INFO("metadata encryption key tag:");
-  for (size_t i = 0; i < metadata_encryption_key_tag.length; i++) {
-    LOGD_SENSITIVE_INFO("%" PRIi8, metadata_encryption_key_tag.data[i]);
-  }
   LOGD_SENSITIVE_INFO("SALT [ %" PRIi8 ", %" PRIi8 "]", salt[0], salt[1]);
-  LOGD_SENSITIVE_INFO("authenticity key:");
-  for (size_t i = 0; i < key.length; i++) {
-    LOGD_SENSITIVE_INFO("%" PRIi8, key.data[i]);
+  for (size_t key_index = 0; key_index < num_keys; key_index++) {
+    LOGD_SENSITIVE_INFO("metadata encryption key tag:");
+    for (size_t i = 0; i < metadata_encryption_key_tags[key_index].length;
+         i++) {
+      LOGD_SENSITIVE_INFO("%" PRIi8,
+                          metadata_encryption_key_tags[key_index].data[i]);
+    }
+    LOGD_SENSITIVE_INFO("authenticity key:");
+    for (size_t i = 0; i < keys[key_index].length; i++) {
+      LOGD_SENSITIVE_INFO("%" PRIi8, keys[key_index].data[i]);
+    }
   }
 #endif
   if (!de_header.has_value()) {
@@ -119,21 +132,27 @@ bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
   size_t cipher_text_length = data_size - cipher_text_index - kMicLength;
   ByteArray cipher_text(&data[cipher_text_index], cipher_text_length);
 
+  // Finds the key of the identity before decrypting the Data Elements, which
+  // are only decrypted with the matching key.
+  ByteArray salt_byte_array(salt, DataElementHeaderV1::kSaltLength);
+  ByteArray identity_byte_array(identity, sizeof(identity));
+  size_t key_index = crypto.FindKey(
+      ByteArray(cipher_text.data, DataElementHeaderV1::kIdentityLength),
+      salt_byte_array, keys, metadata_encryption_key_tags, num_keys,
+      identity_byte_array);
+  if (key_index >= num_keys) {
+    LOGW("Metadata encryption key not matched.");
+    return false;
+  }
+  *matched_key_index = key_index;
+
   // Decodes Data Elements including identity
   ByteArray decrypted_byte_array(decryption_output_buffer, cipher_text_length);
-  if (!crypto.decrypt(cipher_text,
-                      ByteArray(salt, DataElementHeaderV1::kSaltLength), key,
+  if (!crypto.decrypt(cipher_text, salt_byte_array, keys[key_index],
                       decrypted_byte_array)) {
     LOGE("Fail to decrypt data elements.");
     return false;
   }
-  memcpy(identity, decrypted_byte_array.data,
-         DataElementHeaderV1::kIdentityLength);
-  if (!crypto.verify(ByteArray(identity, sizeof(identity)), key,
-                     metadata_encryption_key_tag)) {
-    LOGW("Metadata encryption key not matched.");
-    return false;
-  }
 
 #ifdef LOG_INCLUDE_SENSITIVE_INFO
   LOGD_SENSITIVE_INFO("decrypted identity:");
@@ -153,8 +172,8 @@ bool PresenceDecoderV1::Decode(const ByteArray &encoded_data,
       (int)decrypted_byte_array.length);
   LOGD_SENSITIVE_INFO("Salt bytes: %" PRIi8 " %" PRIu8, salt[0], salt[1]);
   LOGD_SENSITIVE_INFO("authenticity key:");
-  for (size_t i = 0; i < key.length; i++) {
-    LOGD_SENSITIVE_INFO("%" PRIi8, key.data[i]);
+  for (size_t i = 0; i < keys[key_index].length; i++) {
+    LOGD_SENSITIVE_INFO("%" PRIi8, keys[key_index].data[i]);
   }
 #endif
 
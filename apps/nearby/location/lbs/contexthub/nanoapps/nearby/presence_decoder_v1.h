@@ -79,6 +79,13 @@ struct PresenceDecoderV1 {
   bool Decode(const ByteArray &encoded_data, const Crypto &crypto,
               const ByteArray &key,
               const ByteArray &metadata_encryption_key_tag);
+  // Same as above, but tries each key of keys with the metadata encryption key
+  // tag of the same index, and decodes with the first key that matches. The
+  // index of that key is placed in matched_key_index when decoding succeeds.
+  bool Decode(const ByteArray &encoded_data, const Crypto &crypto,
+              const ByteArray keys[],
+              const ByteArray metadata_encryption_key_tags[], size_t num_keys,
+              size_t *matched_key_index);
   // Helper function to decode Presence data elements from data.
   // Returns true if decoding succeeds.
   bool DecodeDataElements(uint8_t data[], size_t data_size);
@@ -190,46 +190,53 @@ bool MatchPresenceV1(const nearby_BleFilter &filter,
   LOGD_SENSITIVE_INFO("Filter Presence V1 with %" PRIu16 " certificates",
                       filter.certificate_count);
   PresenceDecoderV1 decoder;
+  // All the certificates are tried at once, so that the work that does not
+  // depend on the certificate is only done once per advertisement.
+  size_t num_certificates = static_cast<size_t>(filter.certificate_count);
+  ByteArray authenticity_keys[ARRAY_SIZE(filter.certificate)];
+  ByteArray metadata_encryption_key_tags[ARRAY_SIZE(filter.certificate)];
+  if (num_certificates > ARRAY_SIZE(filter.certificate)) {
+    num_certificates = ARRAY_SIZE(filter.certificate);
+  }
+  for (size_t cert_index = 0; cert_index < num_certificates; cert_index++) {
+    authenticity_keys[cert_index] = ByteArray(
+        const_cast<uint8_t *>(filter.certificate[cert_index].authenticity_key),
+        kAuthenticityKeyLength);
+    LOGD_SENSITIVE_INFO("certificate metadata encryption key tag:");
+    for (size_t i = 0; i < kMetaDataEncryptionTagLength; i++) {
+      LOGD_SENSITIVE_INFO(
+          "%" PRIi8,
+          filter.certificate[cert_index].metadata_encryption_key_tag[i]);
+    }
+    metadata_encryption_key_tags[cert_index] = ByteArray(
+        const_cast<uint8_t *>(
+            filter.certificate[cert_index].metadata_encryption_key_tag),
+        kMetaDataEncryptionTagLength);
+  }
   for (const auto &ble_service_data : scan_record.service_data) {
     if (ble_service_data.uuid == PresenceServiceData::kUuid) {
-      for (int cert_index = 0; cert_index < filter.certificate_count;
-           cert_index++) {
-        ByteArray authenticity_key(
-            const_cast<uint8_t *>(
-                filter.certificate[cert_index].authenticity_key),
-            kAuthenticityKeyLength);
-        LOGD_SENSITIVE_INFO("certificate metadata encryption key tag:");
+      size_t cert_index;
+      if (decoder.Decode(ByteArray(const_cast<uint8_t *>(ble_service_data.data),
+                                   ble_service_data.length),
+                         crypto, authenticity_keys,
+                         metadata_encryption_key_tags, num_certificates,
+                         &cert_index)) {
+        result->has_public_credential = true;
+        result->public_credential.has_encrypted_metadata_tag = true;
         for (size_t i = 0; i < kMetaDataEncryptionTagLength; i++) {
-          LOGD_SENSITIVE_INFO(
-              "%" PRIi8,
-              filter.certificate[cert_index].metadata_encryption_key_tag[i]);
+          result->public_credential.encrypted_metadata_tag[i] =
+              metadata_encryption_key_tags[cert_index].data[i];
         }
-        ByteArray metadata_encryption_key_tag(
-            const_cast<uint8_t *>(
-                filter.certificate[cert_index].metadata_encryption_key_tag),
-            kMetaDataEncryptionTagLength);
-        if (decoder.Decode(
-                ByteArray(const_cast<uint8_t *>(ble_service_data.data),
-                          ble_service_data.length),
-                crypto, authenticity_key, metadata_encryption_key_tag)) {
-          result->has_public_credential = true;
-          result->public_credential.has_encrypted_metadata_tag = true;
-          for (size_t i = 0; i < kMetaDataEncryptionTagLength; i++) {
-            result->public_credential.encrypted_metadata_tag[i] =
-                metadata_encryption_key_tag.data[i];
-          }
-          result->public_credential.has_authenticity_key = true;
-          for (size_t i = 0; i < kAuthenticityKeyLength; i++) {
-            result->public_credential.authenticity_key[i] =
-                authenticity_key.data[i];
-          }
-          // TODO(b/244786064): remove unused fields.
-          result->public_credential.has_secret_id = true;
-          result->public_credential.has_encrypted_metadata = true;
-          result->public_credential.has_public_key = true;
-          LOGD("Succeeded to decode Presence advertisement v1.");
-          break;
+        result->public_credential.has_authenticity_key = true;
+        for (size_t i = 0; i < kAuthenticityKeyLength; i++) {
+          result->public_credential.authenticity_key[i] =
+              authenticity_keys[cert_index].data[i];
         }
+        // TODO(b/244786064): remove unused fields.
+        result->public_credential.has_secret_id = true;
+        result->public_credential.has_encrypted_metadata = true;
+        result->public_credential.has_public_key = true;
+        LOGD("Succeeded to decode Presence advertisement v1.");
       }
     }
   }
@@ -111,6 +111,10 @@ $(1)_TOKEN_MAP = $$(if $(CHRE_TOKENIZED_LOGGING_ENABLED), \
 $(1)_TOKEN_MAP_CSV = $$(if $(CHRE_TOKENIZED_LOGGING_ENABLED), \
                         $(OUT)/$(1)/$(OUTPUT_NAME)_log_database.csv,)
 
+# Optional deferred string log formats
+$(1)_LOG_FORMATS = $$(if $(CHRE_DEFERRED_STRING_LOGGING_ENABLED), \
+                      $(OUT)/$(1)/$(OUTPUT_NAME)_log_formats.elf,)
+
 # Top-level Build Rule #########################################################
 
 # Define the phony target.
@@ -129,6 +133,9 @@ $(1)_header: $$($(1)_HEADER)
 .PHONY: $(1)_token_map
 $(1)_token_map: $$($(1)_TOKEN_MAP)
 
+.PHONY: $(1)_log_formats
+$(1)_log_formats: $$($(1)_LOG_FORMATS)
+
 .PHONY: $(1)_flags
 $(1)_flags: $$((1)_FLAGS)
 
@@ -136,7 +143,8 @@ $(1)_flags: $$((1)_FLAGS)
 ifeq ($(IS_ARCHIVE_ONLY_BUILD),true)
 $(1): $(1)_flags $(1)_ar $(1)_token_map
 else
-$(1): $(1)_flags $(1)_ar $(1)_so $(1)_bin $(1)_header $(1)_token_map
+$(1): $(1)_flags $(1)_ar $(1)_so $(1)_bin $(1)_header $(1)_token_map \
+      $(1)_log_formats
 endif
 
 # If building the runtime, simply add the archive and shared object to the all
@@ -243,6 +251,17 @@ $$($(1)_TOKEN_MAP): $$($(1)_AR)
 	$(V)$(TOKEN_MAP_GEN_CMD) $$($(1)_TOKEN_MAP) $$($(1)_AR) 2>&1
 	$(V)$(TOKEN_MAP_CSV_GEN_CMD) $$($(1)_TOKEN_MAP_CSV) $$($(1)_AR) 2>&1
 
+# Deferred String Log Formats ##################################################
+
+# The host formats deferred string logs with the format strings of the linked
+# CHRE binary, which must be installed as
+# /vendor/etc/chre/libchre_log_formats.elf. Archive only builds are linked by
+# the platform build, which must install its own unstripped image instead.
+
+$$($(1)_LOG_FORMATS): $$($(1)_SO)
+	@echo " [LOG_FORMATS] $$@"
+	$(V)cp $$< $$@
+
 # Rust #########################################################################
 
 ifeq ($(IS_BUILD_REQUIRING_RUST),)
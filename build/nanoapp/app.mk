@@ -98,6 +98,9 @@ endif
 COMMON_CFLAGS += -I$(CHRE_PREFIX)/chre_api/include
 COMMON_CFLAGS += -I$(CHRE_PREFIX)/chre_api/include/chre_api
 
+# Add the extensions of this CHRE implementation to the include search path.
+COMMON_CFLAGS += -I$(CHRE_PREFIX)/platform/shared/extensions/include
+
 # Don't pull in the utils folder if not desired
 ifneq ($(NANOAPP_NO_UTILS_INCLUDE),true)
 COMMON_CFLAGS += -I$(CHRE_PREFIX)/util/include
@@ -0,0 +1,41 @@
+#
+# CHRE Microbenchmark Build Variant
+#
+
+include $(CHRE_PREFIX)/build/clean_build_template_args.mk
+
+TARGET_NAME = google_x86_benchmark
+TARGET_CFLAGS = -DCHRE_MESSAGE_TO_HOST_MAX_SIZE=2048
+TARGET_CFLAGS += -DCHRE_FIRST_SUPPORTED_API_VERSION=CHRE_API_VERSION_1_2
+TARGET_VARIANT_SRCS = $(BENCHMARK_COMMON_SRCS)
+TARGET_VARIANT_SRCS += $(BENCHMARK_SRCS)
+
+TARGET_PLATFORM_ID = 0x476f6f676c000001
+
+TARGET_CFLAGS += $(SIM_CFLAGS)
+TARGET_VARIANT_SRCS += $(SIM_SRCS)
+
+ifneq ($(filter $(TARGET_NAME)% all, $(MAKECMDGOALS)),)
+
+ifeq ($(ANDROID_BUILD_TOP),)
+$(error "You should supply an ANDROID_BUILD_TOP environment variable \
+         containing a path to the Android source tree. This is typically \
+         provided by initializing the Android build environment.")
+endif
+include $(CHRE_PREFIX)/build/arch/x86.mk
+
+TARGET_CFLAGS += $(BENCHMARK_CFLAGS)
+TARGET_CFLAGS += $(shell pkg-config --cflags benchmark)
+
+# Instruct the build to link a final executable.
+TARGET_BUILD_BIN = true
+
+# Link in libraries for the final executable. Google Benchmark is taken from
+# the host and provides main().
+TARGET_BIN_LDFLAGS += -lrt -ldl
+TARGET_BIN_LDFLAGS += -lpthread
+TARGET_BIN_LDFLAGS += -lbenchmark_main
+TARGET_BIN_LDFLAGS += $(shell pkg-config --libs benchmark)
+
+include $(CHRE_PREFIX)/build/build_template.mk
+endif
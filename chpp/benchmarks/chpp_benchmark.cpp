@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "chpp/app.h"
+#include "chpp/crc.h"
+#include "chpp/link.h"
+#include "chpp/transport.h"
+
+namespace {
+
+constexpr size_t kLinkMtuBytes = 1280;
+
+//! The number of distinct sequence numbers of the transport.
+constexpr size_t kNumSequenceNumbers = UINT8_MAX + 1;
+
+//! A link that drops everything the transport sends, so that only the RX path
+//! is measured.
+struct NullLinkState {
+  uint8_t txBuffer[kLinkMtuBytes];
+};
+
+void init(void * /*linkContext*/,
+          struct ChppTransportState * /*transportContext*/) {}
+
+void deinit(void * /*linkContext*/) {}
+
+enum ChppLinkErrorCode send(void * /*linkContext*/, size_t /*len*/) {
+  return CHPP_LINK_ERROR_NONE_SENT;
+}
+
+void doWork(void * /*linkContext*/, uint32_t /*signal*/) {}
+
+void reset(void * /*linkContext*/) {}
+
+struct ChppLinkConfiguration getConfig(void * /*linkContext*/) {
+  return ChppLinkConfiguration{
+      .txBufferLen = kLinkMtuBytes,
+      .rxBufferLen = kLinkMtuBytes,
+  };
+}
+
+uint8_t *getTxBuffer(void *linkContext) {
+  return static_cast<NullLinkState *>(linkContext)->txBuffer;
+}
+
+const struct ChppLinkApi kNullLinkApi = {
+    .init = &init,
+    .deinit = &deinit,
+    .send = &send,
+    .doWork = &doWork,
+    .reset = &reset,
+    .getConfig = &getConfig,
+    .getTxBuffer = &getTxBuffer,
+};
+
+//! Frames a payload as a CHPP transport packet, see transport.h.
+std::vector<uint8_t> makePacket(uint8_t attributes, uint8_t seq,
+                                const uint8_t *payload, uint16_t payloadLen) {
+  ChppTransportHeader header = {
+      .flags = CHPP_TRANSPORT_FLAG_FINISHED_DATAGRAM,
+      .packetCode = static_cast<uint8_t>(CHPP_ATTR_AND_ERROR_TO_PACKET_CODE(
+          attributes, CHPP_TRANSPORT_ERROR_NONE)),
+      .ackSeq = 0,
+      .seq = seq,
+      .length = payloadLen,
+      .reserved = 0,
+  };
+  ChppTransportFooter footer;
+  footer.checksum = chppCrc32(0, reinterpret_cast<const uint8_t *>(&header),
+                              sizeof(header));
+  footer.checksum = chppCrc32(footer.checksum, payload, payloadLen);
+
+  std::vector<uint8_t> packet = {CHPP_PREAMBLE_BYTE_FIRST,
+                                 CHPP_PREAMBLE_BYTE_SECOND};
+  const auto *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+  packet.insert(packet.end(), headerBytes, headerBytes + sizeof(header));
+  packet.insert(packet.end(), payload, payload + payloadLen);
+  const auto *footerBytes = reinterpret_cast<const uint8_t *>(&footer);
+  packet.insert(packet.end(), footerBytes, footerBytes + sizeof(footer));
+  return packet;
+}
+
+//! A transport and app layer that completed their reset, without a work
+//! thread, so that received packets are processed in the calling thread.
+class ChppReceiver {
+ public:
+  ChppReceiver() {
+    memset(&mLinkState, 0, sizeof(mLinkState));
+    chppTransportInit(&mTransportContext, &mAppContext, &mLinkState,
+                      &kNullLinkApi);
+    chppAppInitWithClientServiceSet(&mAppContext, &mTransportContext,
+                                    /*clientServiceSet=*/{});
+
+    ChppTransportConfiguration config = {};
+    config.version.major = 1;
+    std::vector<uint8_t> resetAck = makePacket(
+        CHPP_TRANSPORT_ATTR_RESET_ACK, /* seq= */ 0,
+        reinterpret_cast<const uint8_t *>(&config), sizeof(config));
+    receive(resetAck);
+  }
+
+  ~ChppReceiver() {
+    chppAppDeinit(&mAppContext);
+    chppTransportDeinit(&mTransportContext);
+  }
+
+  void receive(const std::vector<uint8_t> &packet) {
+    chppRxDataCb(&mTransportContext, packet.data(), packet.size());
+  }
+
+ private:
+  ChppTransportState mTransportContext = {};
+  ChppAppState mAppContext = {};
+  NullLinkState mLinkState;
+};
+
+void BM_ChppCrc32(benchmark::State &state) {
+  const size_t size = static_cast<size_t>(state.range(0));
+  std::vector<uint8_t> buffer(size, 0xa5);
+
+  for (auto _ : state) {
+    uint32_t crc = chppCrc32(0, buffer.data(), buffer.size());
+    benchmark::DoNotOptimize(crc);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_ChppCrc32)->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_ChppTransportRxDatagram(benchmark::State &state) {
+  const auto payloadLen = static_cast<uint16_t>(state.range(0));
+  auto receiver = std::make_unique<ChppReceiver>();
+
+  // Datagrams without a handle are dropped by the app layer once the
+  // transport has validated and reassembled them. A zeroed app header has
+  // CHPP_HANDLE_NONE and no error.
+  std::vector<uint8_t> payload(payloadLen, 0xa5);
+  memset(payload.data(), 0, sizeof(ChppAppHeader));
+  std::vector<std::vector<uint8_t>> packets;
+  for (size_t seq = 0; seq < kNumSequenceNumbers; seq++) {
+    packets.push_back(makePacket(CHPP_TRANSPORT_ATTR_NONE,
+                                 static_cast<uint8_t>(seq), payload.data(),
+                                 payloadLen));
+  }
+
+  // The reset-ack had sequence number 0.
+  size_t seq = 1;
+  for (auto _ : state) {
+    receiver->receive(packets[seq]);
+    seq = (seq + 1) % kNumSequenceNumbers;
+  }
+  state.SetBytesProcessed(state.iterations() * payloadLen);
+}
+BENCHMARK(BM_ChppTransportRxDatagram)->Arg(16)->Arg(256)->Arg(1024);
+
+}  // namespace
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/core/audio_capture_ring.h"
+
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+
+#include "chre/core/audio_util.h"
+#include "chre/platform/log.h"
+#include "chre/platform/memory.h"
+#include "chre/util/dynamic_vector.h"
+#include "chre/util/memory.h"
+#include "chre/util/time.h"
+
+namespace chre {
+
+static_assert(std::is_standard_layout<
+                  AudioCaptureRing::Window::TaggedEvent>::value,
+              "The event must be at the start of the tagged event");
+
+//! Samples shared by a ring and the windows created from it, referenced by
+//! both. Outlives the ring until its last window is destroyed.
+struct AudioCaptureRing::Storage : public RefBase<Storage> {
+  Storage(uint8_t *samplesIn, uint32_t capacityIn, uint8_t sampleSizeIn)
+      : samples(samplesIn), capacity(capacityIn), sampleSize(sampleSizeIn) {}
+
+  ~Storage() override {
+    memoryFree(samples);
+  }
+
+  //! Twice the capacity, for the copy of the samples following the ring.
+  uint8_t *samples;
+
+  //! The number of samples that the ring can hold.
+  uint32_t capacity;
+
+  //! The size of one sample, in bytes.
+  uint8_t sampleSize;
+
+  //! The windows using the samples.
+  DynamicVector<Window *> windows;
+};
+
+namespace {
+
+uint8_t getSampleSize(uint8_t format) {
+  return (format == CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM) ? 2 : 1;
+}
+
+const uint8_t *getEventSamples(const struct chreAudioDataEvent &event) {
+  return (event.format == CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM)
+             ? reinterpret_cast<const uint8_t *>(event.samplesS16)
+             : event.samplesULaw8;
+}
+
+/**
+ * Writes samples at an index of the ring and one capacity later. The samples
+ * must not go past the end of the ring.
+ */
+void writeSamples(AudioCaptureRing::Storage *storage, uint32_t index,
+                  const uint8_t *samples, uint32_t numSamples) {
+  size_t offset = static_cast<size_t>(index) * storage->sampleSize;
+  size_t mirrorOffset =
+      static_cast<size_t>(index + storage->capacity) * storage->sampleSize;
+  size_t size = static_cast<size_t>(numSamples) * storage->sampleSize;
+  memcpy(storage->samples + offset, samples, size);
+  memcpy(storage->samples + mirrorOffset, samples, size);
+}
+
+}  // namespace
+
+AudioCaptureRing::Window::Window(Storage *storageIn, uint64_t startPositionIn)
+    : storage(storageIn), startPosition(startPositionIn) {
+  taggedEvent.window = this;
+  storage->incRef();
+}
+
+AudioCaptureRing::Window::~Window() {
+  size_t index = storage->windows.find(this);
+  if (index < storage->windows.size()) {
+    storage->windows.erase(index);
+  }
+  storage->decRef();
+}
+
+AudioCaptureRing::AudioCaptureRing(AudioCaptureRing &&other)
+    : mStorage(other.mStorage),
+      mFormat(other.mFormat),
+      mSampleRate(other.mSampleRate),
+      mSize(other.mSize),
+      mEndPosition(other.mEndPosition),
+      mEndTimestamp(other.mEndTimestamp) {
+  other.mStorage = nullptr;
+  other.mSize = 0;
+}
+
+AudioCaptureRing::~AudioCaptureRing() {
+  clear();
+}
+
+bool AudioCaptureRing::reserve(uint32_t maxWindowSamples, uint8_t format) {
+  if (mStorage != nullptr && mStorage->capacity >= maxWindowSamples &&
+      mFormat == format) {
+    return true;
+  }
+
+  clear();
+  uint8_t sampleSize = getSampleSize(format);
+  uint8_t *samples = static_cast<uint8_t *>(
+      memoryAlloc(2 * static_cast<size_t>(maxWindowSamples) * sampleSize));
+  Storage *storage =
+      (samples == nullptr)
+          ? nullptr
+          : memoryAlloc<Storage>(samples, maxWindowSamples, sampleSize);
+  if (storage == nullptr) {
+    LOG_OOM();
+    memoryFree(samples);
+    return false;
+  }
+
+  mStorage = storage;
+  mFormat = format;
+  return true;
+}
+
+void AudioCaptureRing::clear() {
+  if (mStorage != nullptr) {
+    // The windows using the storage no longer block appending to the ring.
+    mStorage->windows.clear();
+    mStorage->decRef();
+    mStorage = nullptr;
+  }
+  mSize = 0;
+}
+
+bool AudioCaptureRing::canAppend(const struct chreAudioDataEvent &event) const {
+  if (mStorage == nullptr) {
+    return true;
+  }
+
+  bool gap;
+  uint64_t endPosition = mEndPosition + countNewSamples(event, &gap);
+  uint64_t firstKeptPosition = (endPosition > mStorage->capacity)
+                                   ? endPosition - mStorage->capacity
+                                   : 0;
+  for (const Window *window : mStorage->windows) {
+    if (window->startPosition < firstKeptPosition) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AudioCaptureRing::append(const struct chreAudioDataEvent &event) {
+  if (mStorage == nullptr || event.format != mFormat) {
+    LOGE("Dropping audio data event of format %" PRIu8, event.format);
+    return;
+  }
+
+  bool gap;
+  uint32_t numSamples = countNewSamples(event, &gap);
+  if (gap) {
+    mSize = 0;
+  }
+
+  const uint8_t *samples =
+      getEventSamples(event) +
+      static_cast<size_t>(event.sampleCount - numSamples) * mStorage->sampleSize;
+  uint32_t index = static_cast<uint32_t>(mEndPosition % mStorage->capacity);
+  uint32_t numSamplesToEnd = mStorage->capacity - index;
+  if (numSamples <= numSamplesToEnd) {
+    writeSamples(mStorage, index, samples, numSamples);
+  } else {
+    writeSamples(mStorage, index, samples, numSamplesToEnd);
+    writeSamples(mStorage, 0,
+                 samples + static_cast<size_t>(numSamplesToEnd) *
+                               mStorage->sampleSize,
+                 numSamples - numSamplesToEnd);
+  }
+
+  mEndPosition += numSamples;
+  mSize = (mSize + numSamples < mStorage->capacity) ? mSize + numSamples
+                                                    : mStorage->capacity;
+  mSampleRate = event.sampleRate;
+  mEndTimestamp = event.timestamp + AudioUtil::getDurationFromSampleCountAndRate(
+                                        event.sampleCount, event.sampleRate)
+                                        .toRawNanoseconds();
+}
+
+AudioCaptureRing::Window *AudioCaptureRing::createWindow(uint32_t handle,
+                                                         uint32_t numSamples) {
+  if (mStorage == nullptr || mSize == 0) {
+    return nullptr;
+  }
+
+  if (numSamples > mSize) {
+    numSamples = mSize;
+  }
+  uint64_t startPosition = mEndPosition - numSamples;
+  auto *window = memoryAlloc<Window>(mStorage, startPosition);
+  if (window == nullptr) {
+    LOG_OOM();
+    return nullptr;
+  } else if (!mStorage->windows.push_back(window)) {
+    LOG_OOM();
+    window->decRef();
+    return nullptr;
+  }
+
+  const uint8_t *samples = getSamples(startPosition, numSamples);
+  struct chreAudioDataEvent &event = *window->getEvent();
+  memset(&event, 0, sizeof(event));
+  event.version = CHRE_AUDIO_DATA_EVENT_VERSION;
+  event.handle = handle;
+  event.timestamp = getTimestamp(startPosition);
+  event.sampleRate = mSampleRate;
+  event.sampleCount = numSamples;
+  event.format = mFormat;
+  if (mFormat == CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM) {
+    event.samplesS16 = reinterpret_cast<const int16_t *>(samples);
+  } else {
+    event.samplesULaw8 = samples;
+  }
+
+  return window;
+}
+
+const uint8_t *AudioCaptureRing::getSamples(uint64_t position,
+                                            uint32_t numSamples) const {
+  if (mStorage == nullptr || position < mEndPosition - mSize ||
+      position + numSamples > mEndPosition) {
+    return nullptr;
+  }
+  return mStorage->samples +
+         static_cast<size_t>(position % mStorage->capacity) *
+             mStorage->sampleSize;
+}
+
+uint64_t AudioCaptureRing::getTimestamp(uint64_t position) const {
+  uint32_t numSamplesToEnd = static_cast<uint32_t>(mEndPosition - position);
+  return mEndTimestamp - AudioUtil::getDurationFromSampleCountAndRate(
+                             numSamplesToEnd, mSampleRate)
+                             .toRawNanoseconds();
+}
+
+uint32_t AudioCaptureRing::getCapacity() const {
+  return (mStorage == nullptr) ? 0 : mStorage->capacity;
+}
+
+size_t AudioCaptureRing::getNumWindows() const {
+  return (mStorage == nullptr) ? 0 : mStorage->windows.size();
+}
+
+uint32_t AudioCaptureRing::countNewSamples(
+    const struct chreAudioDataEvent &event, bool *gap) const {
+  uint32_t numSamples = event.sampleCount;
+  *gap = false;
+  if (mSize > 0 && event.sampleRate == mSampleRate) {
+    // The samples of the event that are already in the ring, rounded to the
+    // nearest sample
+    int64_t overlapNs = static_cast<int64_t>(mEndTimestamp - event.timestamp);
+    int64_t halfSecond = static_cast<int64_t>(kOneSecondInNanoseconds / 2);
+    int64_t overlap =
+        (overlapNs * mSampleRate + (overlapNs < 0 ? -halfSecond : halfSecond)) /
+        static_cast<int64_t>(kOneSecondInNanoseconds);
+    if (overlap < 0) {
+      *gap = true;
+    } else if (static_cast<uint64_t>(overlap) >= numSamples) {
+      numSamples = 0;
+    } else {
+      numSamples -= static_cast<uint32_t>(overlap);
+    }
+  } else if (mSize > 0) {
+    *gap = true;
+  }
+
+  uint32_t capacity = (mStorage == nullptr) ? 0 : mStorage->capacity;
+  return (numSamples < capacity) ? numSamples : capacity;
+}
+
+}  // namespace chre
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/core/audio_feature_extractor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "chre/platform/log.h"
+#include "chre/platform/memory.h"
+#include "chre_api/chre/audio.h"
+#include "kiss_fftr.h"
+
+static_assert(sizeof(kiss_fft_scalar) == sizeof(int16_t),
+              "Kiss FFT must be built with FIXED_POINT");
+static_assert(sizeof(kiss_fft_cpx) == 2 * sizeof(int16_t),
+              "The spectrum is stored as interleaved int16_t");
+
+namespace chre {
+namespace {
+
+constexpr float kPi = 3.14159265f;
+
+//! The number of fractional bits of the window and filterbank weights.
+constexpr int kWeightShift = 15;
+
+int16_t decodeULaw(uint8_t sample) {
+  sample = ~sample;
+  int32_t magnitude = (((sample & 0x0f) << 3) + 0x84) << ((sample & 0x70) >> 4);
+  return static_cast<int16_t>((sample & 0x80) ? (0x84 - magnitude)
+                                              : (magnitude - 0x84));
+}
+
+float hzToMel(float hz) {
+  return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+float melToHz(float mel) {
+  return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+/**
+ * @return The base 2 logarithm of a value in Q8, or 0 for 0.
+ */
+int16_t log2Q8(uint64_t value) {
+  if (value == 0) {
+    return 0;
+  }
+
+  int msb = 63 - __builtin_clzll(value);
+  // The bits following the most significant one, as a fraction f in Q16
+  uint32_t fraction =
+      static_cast<uint32_t>((msb >= 16) ? (value >> (msb - 16))
+                                        : (value << (16 - msb))) &
+      0xffff;
+  // log2(1 + f) ~= f + 0.3466 * f * (1 - f), within 0.01
+  uint32_t correction = static_cast<uint32_t>(
+      (((static_cast<uint64_t>(fraction) * (65536 - fraction)) >> 16) *
+       22714) >>
+      16);
+  return static_cast<int16_t>((msb << 8) + ((fraction + correction) >> 8));
+}
+
+}  // namespace
+
+AudioFeatureExtractor::~AudioFeatureExtractor() {
+  release();
+}
+
+bool AudioFeatureExtractor::isValidConfiguration(uint32_t frameSize,
+                                                 uint32_t hopSize,
+                                                 uint16_t numBins) {
+  bool isPowerOf2 = (frameSize & (frameSize - 1)) == 0;
+  return frameSize >= 2 && isPowerOf2 &&
+         frameSize <= CHRE_AUDIO_FEATURE_MAX_FRAME_SIZE && hopSize > 0 &&
+         hopSize <= frameSize && numBins > 0 && numBins <= frameSize / 2;
+}
+
+bool AudioFeatureExtractor::init(uint32_t sampleRate, uint32_t frameSize,
+                                 uint16_t numBins) {
+  release();
+
+  size_t fftConfigSize = 0;
+  kiss_fftr_alloc(static_cast<int>(frameSize), 0 /* inverse_fft */, nullptr,
+                  &fftConfigSize);
+  uint32_t numFftBins = frameSize / 2 + 1;
+  void *fftConfig = memoryAlloc(fftConfigSize);
+  mWindow = static_cast<int16_t *>(memoryAlloc(frameSize * sizeof(int16_t)));
+  mFrame = static_cast<int16_t *>(memoryAlloc(frameSize * sizeof(int16_t)));
+  mSpectrum =
+      static_cast<int16_t *>(memoryAlloc(2 * numFftBins * sizeof(int16_t)));
+  mMelBands = static_cast<MelBand *>(memoryAlloc(numBins * sizeof(MelBand)));
+  if (fftConfig == nullptr || mWindow == nullptr || mFrame == nullptr ||
+      mSpectrum == nullptr || mMelBands == nullptr) {
+    LOG_OOM();
+    memoryFree(fftConfig);
+    release();
+    return false;
+  }
+
+  mFftConfig = kiss_fftr_alloc(static_cast<int>(frameSize),
+                               0 /* inverse_fft */, fftConfig, &fftConfigSize);
+  mFrameSize = frameSize;
+  mNumBins = numBins;
+
+  for (uint32_t i = 0; i < frameSize; i++) {
+    float weight =
+        0.5f - 0.5f * cosf(2.0f * kPi * static_cast<float>(i) /
+                           static_cast<float>(frameSize));
+    mWindow[i] = static_cast<int16_t>(weight * ((1 << kWeightShift) - 1));
+  }
+
+  // The band edges, in FFT bins, are evenly spaced on the mel scale from 0 Hz
+  // to the Nyquist frequency. Each band spans the bins strictly between the
+  // centers of its neighbors, whose weights are positive, or else the bin
+  // nearest to its center. The DC bin is never part of a band.
+  float maxMel = hzToMel(static_cast<float>(sampleRate) / 2.0f);
+  auto getEdgeBin = [&](uint32_t edge) {
+    float hz = melToHz(maxMel * static_cast<float>(edge) /
+                       static_cast<float>(numBins + 1));
+    return hz * static_cast<float>(frameSize) / static_cast<float>(sampleRate);
+  };
+
+  uint32_t numWeights = 0;
+  for (uint16_t band = 0; band < numBins; band++) {
+    float left = getEdgeBin(band);
+    float right = getEdgeBin(band + 2);
+    auto firstBin = static_cast<uint16_t>(floorf(left) + 1.0f);
+    auto lastBin = static_cast<uint16_t>(ceilf(right) - 1.0f);
+    if (lastBin < firstBin) {
+      firstBin = static_cast<uint16_t>(
+          std::max(1L, lroundf(getEdgeBin(band + 1))));
+      lastBin = firstBin;
+    }
+    if (lastBin >= numFftBins) {
+      lastBin = static_cast<uint16_t>(numFftBins - 1);
+    }
+    mMelBands[band].firstBin = firstBin;
+    mMelBands[band].numBins = static_cast<uint16_t>(lastBin - firstBin + 1);
+    mMelBands[band].weightOffset = numWeights;
+    numWeights += mMelBands[band].numBins;
+  }
+
+  mMelWeights =
+      static_cast<uint16_t *>(memoryAlloc(numWeights * sizeof(uint16_t)));
+  if (mMelWeights == nullptr) {
+    LOG_OOM();
+    release();
+    return false;
+  }
+
+  for (uint16_t band = 0; band < numBins; band++) {
+    float left = getEdgeBin(band);
+    float center = getEdgeBin(band + 1);
+    float right = getEdgeBin(band + 2);
+    const MelBand &melBand = mMelBands[band];
+    for (uint16_t i = 0; i < melBand.numBins; i++) {
+      float bin = static_cast<float>(melBand.firstBin + i);
+      float weight = (bin <= center) ? (bin - left) / (center - left)
+                                     : (right - bin) / (right - center);
+      if (melBand.numBins == 1) {
+        weight = 1.0f;
+      }
+      mMelWeights[melBand.weightOffset + i] =
+          static_cast<uint16_t>(weight * ((1 << kWeightShift) - 1));
+    }
+  }
+
+  return true;
+}
+
+void AudioFeatureExtractor::computeFrame(const uint8_t *samples,
+                                         uint8_t format,
+                                         int16_t *logMelEnergies) {
+  if (format == CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM) {
+    memcpy(mFrame, samples, mFrameSize * sizeof(int16_t));
+  } else {
+    for (uint32_t i = 0; i < mFrameSize; i++) {
+      mFrame[i] = decodeULaw(samples[i]);
+    }
+  }
+
+  // The offset of the microphone is removed before windowing, as the window
+  // would otherwise spread it into the lowest bands.
+  int32_t sum = 0;
+  for (uint32_t i = 0; i < mFrameSize; i++) {
+    sum += mFrame[i];
+  }
+  int32_t mean = sum / static_cast<int32_t>(mFrameSize);
+  for (uint32_t i = 0; i < mFrameSize; i++) {
+    int32_t sample = ((mFrame[i] - mean) * mWindow[i]) >> kWeightShift;
+    mFrame[i] = static_cast<int16_t>(
+        std::min<int32_t>(std::max<int32_t>(sample, INT16_MIN), INT16_MAX));
+  }
+
+  kiss_fftr(mFftConfig, mFrame, reinterpret_cast<kiss_fft_cpx *>(mSpectrum));
+
+  for (uint16_t band = 0; band < mNumBins; band++) {
+    const MelBand &melBand = mMelBands[band];
+    const uint16_t *weights = &mMelWeights[melBand.weightOffset];
+    const int16_t *spectrum = &mSpectrum[2 * melBand.firstBin];
+    uint64_t energy = 0;
+    for (uint16_t i = 0; i < melBand.numBins; i++) {
+      int32_t real = spectrum[2 * i];
+      int32_t imaginary = spectrum[2 * i + 1];
+      uint32_t power = static_cast<uint32_t>(real * real) +
+                       static_cast<uint32_t>(imaginary * imaginary);
+      energy += static_cast<uint64_t>(power) * weights[i];
+    }
+    // The energy is in Q15, an energy of 0 gives that of 2^-15.
+    logMelEnergies[band] =
+        static_cast<int16_t>(log2Q8(energy) - (kWeightShift << 8));
+  }
+}
+
+void AudioFeatureExtractor::release() {
+  memoryFree(mFftConfig);
+  memoryFree(mWindow);
+  memoryFree(mFrame);
+  memoryFree(mSpectrum);
+  memoryFree(mMelBands);
+  memoryFree(mMelWeights);
+  mFftConfig = nullptr;
+  mWindow = nullptr;
+  mFrame = nullptr;
+  mSpectrum = nullptr;
+  mMelBands = nullptr;
+  mMelWeights = nullptr;
+  mFrameSize = 0;
+  mNumBins = 0;
+}
+
+}  // namespace chre
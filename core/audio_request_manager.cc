@@ -16,9 +16,13 @@
 
 #include "chre/core/audio_request_manager.h"
 
+#include <cstring>
+
 #include "chre/core/audio_util.h"
 #include "chre/core/event_loop_manager.h"
+#include "chre/platform/assert.h"
 #include "chre/platform/fatal_error.h"
+#include "chre/platform/memory.h"
 #include "chre/platform/system_time.h"
 #include "chre/util/nested_data_ptr.h"
 #include "chre/util/system/debug_dump.h"
@@ -67,6 +71,65 @@ bool AudioRequestManager::configureSource(const Nanoapp *nanoapp,
                            Nanoseconds(deliveryInterval));
 }
 
+bool AudioRequestManager::configureFeatures(const Nanoapp *nanoapp,
+                                            uint32_t handle, bool enable,
+                                            uint64_t deliveryInterval,
+                                            uint32_t frameSize,
+                                            uint32_t hopSize,
+                                            uint16_t numBins) {
+  AudioFeatureConfig featureConfig;
+  uint32_t numSamples = 0;
+  bool success = false;
+  if (handle >= mAudioRequestLists.size()) {
+    LOGE("Provided audio handle out of range");
+  } else if (enable) {
+    chreAudioSource audioSource;
+    if (!mPlatformAudio.getAudioSource(handle, &audioSource)) {
+      LOGE("Failed to query for audio source");
+    } else if (!AudioFeatureExtractor::isValidConfiguration(frameSize, hopSize,
+                                                            numBins)) {
+      LOGE("Invalid audio features: frameSize %" PRIu32 ", hopSize %" PRIu32
+           ", numBins %" PRIu16,
+           frameSize, hopSize, numBins);
+    } else {
+      uint32_t maxNumSamples = AudioUtil::getSampleCountFromRateAndDuration(
+          audioSource.sampleRate, Nanoseconds(audioSource.maxBufferDuration));
+      uint64_t hopDurationNs =
+          (hopSize * kOneSecondInNanoseconds) / audioSource.sampleRate;
+
+      // Each capture overlaps the previous one by a frame, so that the frames
+      // straddling two captures are delivered too.
+      numSamples = AudioUtil::getSampleCountFromRateAndDuration(
+                       audioSource.sampleRate, Nanoseconds(deliveryInterval)) +
+                   frameSize;
+      if (numSamples > maxNumSamples) {
+        numSamples = maxNumSamples;
+      }
+
+      if (frameSize > maxNumSamples) {
+        LOGE("Audio feature frame of %" PRIu32 " samples exceeds the %" PRIu32
+             " samples of the source",
+             frameSize, maxNumSamples);
+      } else if (deliveryInterval < hopDurationNs) {
+        LOGE("Audio feature delivery interval shorter than a hop");
+      } else {
+        featureConfig.frameSize = frameSize;
+        featureConfig.hopSize = hopSize;
+        featureConfig.numBins = numBins;
+        success = true;
+      }
+    }
+  } else {
+    // Disabling the request, no need to validate the configuration.
+    success = true;
+  }
+
+  return success &&
+         doConfigureSource(nanoapp->getInstanceId(), handle, enable,
+                           numSamples, Nanoseconds(deliveryInterval),
+                           &featureConfig);
+}
+
 void AudioRequestManager::handleAudioDataEvent(
     const struct chreAudioDataEvent *audioDataEvent) {
   uint32_t handle = audioDataEvent->handle;
@@ -91,9 +154,7 @@ void AudioRequestManager::handleAudioDataEvent(
       const_cast<struct chreAudioDataEvent *>(audioDataEvent);
   if (!EventLoopManagerSingleton::get()->deferCallback(
           SystemCallbackType::AudioHandleDataEvent, event, callback)) {
-    EventLoopManagerSingleton::get()
-        ->getAudioRequestManager()
-        .handleFreeAudioDataEvent(event);
+    mPlatformAudio.releaseAudioDataEvent(event);
   }
 }
 
@@ -120,17 +181,20 @@ void AudioRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
     struct chreAudioSource source;
     mPlatformAudio.getAudioSource(handle, &source);
 
+    const AudioCaptureRing &ring = mAudioRequestLists[i].ring;
     Nanoseconds timeSinceLastAudioEvent =
         SystemTime::getMonotonicTime() -
         mAudioRequestLists[i].lastEventTimestamp;
     debugDump.print(
         " handle=%" PRIu32 ", name=\"%s\", available=%d, sampleRate=%" PRIu32
         ", buffer(ms)=[%" PRIu64 ",%" PRIu64 "], format=%" PRIu8
-        ", timeSinceLastAudioEvent(ms)=%" PRIu64 "\n",
+        ", timeSinceLastAudioEvent(ms)=%" PRIu64 ", ring=%" PRIu32 "/%" PRIu32
+        ", windows=%zu\n",
         handle, source.name, mAudioRequestLists[i].available, source.sampleRate,
         Milliseconds(Nanoseconds(source.minBufferDuration)).getMilliseconds(),
         Milliseconds(Nanoseconds(source.maxBufferDuration)).getMilliseconds(),
-        source.format, Milliseconds(timeSinceLastAudioEvent).getMilliseconds());
+        source.format, Milliseconds(timeSinceLastAudioEvent).getMilliseconds(),
+        ring.getSize(), ring.getCapacity(), ring.getNumWindows());
 
     for (const auto &request : mAudioRequestLists[i].requests) {
       for (const auto &instanceId : request.instanceIds) {
@@ -139,6 +203,13 @@ void AudioRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
                         instanceId, request.numSamples,
                         Milliseconds(Nanoseconds(request.deliveryInterval))
                             .getMilliseconds());
+        if (request.isFeatureRequest()) {
+          debugDump.print("   features: frameSize=%" PRIu32
+                          ", hopSize=%" PRIu32 ", numBins=%" PRIu16 "\n",
+                          request.featureConfig.frameSize,
+                          request.featureConfig.hopSize,
+                          request.featureConfig.numBins);
+        }
       }
     }
   }
@@ -175,23 +246,29 @@ bool AudioRequestManager::validateConfigureSourceArguments(
   return success;
 }
 
-bool AudioRequestManager::doConfigureSource(uint16_t instanceId,
-                                            uint32_t handle, bool enable,
-                                            uint32_t numSamples,
-                                            Nanoseconds deliveryInterval) {
+bool AudioRequestManager::doConfigureSource(
+    uint16_t instanceId, uint32_t handle, bool enable, uint32_t numSamples,
+    Nanoseconds deliveryInterval, const AudioFeatureConfig *featureConfig) {
   size_t requestIndex;
   size_t requestInstanceIdIndex;
   auto *audioRequest = findAudioRequestByInstanceId(
-      handle, instanceId, &requestIndex, &requestInstanceIdIndex);
+      handle, instanceId, featureConfig != nullptr /* features */,
+      &requestIndex, &requestInstanceIdIndex);
 
   AudioRequestList &requestList = mAudioRequestLists[handle];
   size_t lastNumRequests = requestList.requests.size();
 
+  if (enable && !reserveCaptureRing(handle, instanceId, numSamples,
+                                    featureConfig != nullptr /* features */)) {
+    LOGE("Failed to reserve audio capture ring for handle %" PRIu32, handle);
+    return false;
+  }
+
   bool success = false;
   if (audioRequest == nullptr) {
     if (enable) {
-      success =
-          createAudioRequest(handle, instanceId, numSamples, deliveryInterval);
+      success = createAudioRequest(handle, instanceId, numSamples,
+                                   deliveryInterval, featureConfig);
     } else {
       LOGW("Nanoapp disabling nonexistent audio request");
     }
@@ -211,11 +288,15 @@ bool AudioRequestManager::doConfigureSource(uint16_t instanceId,
     if (!enable) {
       success = true;
     } else {
-      success =
-          createAudioRequest(handle, instanceId, numSamples, deliveryInterval);
+      success = createAudioRequest(handle, instanceId, numSamples,
+                                   deliveryInterval, featureConfig);
     }
   }
 
+  if (!usesCaptureRing(requestList)) {
+    requestList.ring.clear();
+  }
+
   if (success &&
       (EventLoopManagerSingleton::get()->getSettingManager().getSettingEnabled(
           Setting::MICROPHONE))) {
@@ -226,6 +307,39 @@ bool AudioRequestManager::doConfigureSource(uint16_t instanceId,
   return success;
 }
 
+bool AudioRequestManager::usesCaptureRing(const AudioRequestList &requestList) {
+  return requestList.requests.size() > 1 ||
+         (requestList.requests.size() == 1 &&
+          (requestList.requests[0].isFeatureRequest() ||
+           getNumMulticastEvents(requestList.requests[0]) > 1));
+}
+
+bool AudioRequestManager::reserveCaptureRing(uint32_t handle,
+                                             uint16_t instanceId,
+                                             uint32_t numSamples,
+                                             bool features) {
+  AudioRequestList &requestList = mAudioRequestLists[handle];
+
+  // The request of the nanoapp is replaced by the new one.
+  bool shared = features;
+  uint32_t maxNumSamples = numSamples;
+  for (const AudioRequest &request : requestList.requests) {
+    bool replaced = request.isFeatureRequest() == features &&
+                    request.instanceIds.size() == 1 &&
+                    request.instanceIds[0] == instanceId;
+    if (!replaced) {
+      shared = true;
+      if (request.numSamples > maxNumSamples) {
+        maxNumSamples = request.numSamples;
+      }
+    }
+  }
+
+  struct chreAudioSource source;
+  return !shared || (mPlatformAudio.getAudioSource(handle, &source) &&
+                     requestList.ring.reserve(maxNumSamples, source.format));
+}
+
 void AudioRequestManager::updatePlatformHandleEnabled(uint32_t handle,
                                                       size_t lastNumRequests) {
   size_t numRequests = mAudioRequestLists[handle].requests.size();
@@ -236,15 +350,15 @@ void AudioRequestManager::updatePlatformHandleEnabled(uint32_t handle,
   }
 }
 
-bool AudioRequestManager::createAudioRequest(uint32_t handle,
-                                             uint16_t instanceId,
-                                             uint32_t numSamples,
-                                             Nanoseconds deliveryInterval) {
+bool AudioRequestManager::createAudioRequest(
+    uint32_t handle, uint16_t instanceId, uint32_t numSamples,
+    Nanoseconds deliveryInterval, const AudioFeatureConfig *featureConfig) {
   AudioRequestList &requestList = mAudioRequestLists[handle];
 
   size_t matchingRequestIndex;
   auto *matchingAudioRequest = findAudioRequestByConfiguration(
-      handle, numSamples, deliveryInterval, &matchingRequestIndex);
+      handle, numSamples, deliveryInterval, featureConfig,
+      &matchingRequestIndex);
 
   bool success = false;
   if (matchingAudioRequest != nullptr) {
@@ -262,6 +376,10 @@ bool AudioRequestManager::createAudioRequest(uint32_t handle,
     } else if (!requestList.requests.back().instanceIds.push_back(instanceId)) {
       requestList.requests.pop_back();
       LOG_OOM();
+    } else if (featureConfig != nullptr &&
+               !initAudioFeatureRequest(handle, *featureConfig,
+                                        requestList.requests.back())) {
+      requestList.requests.pop_back();
     } else {
       success = true;
     }
@@ -271,26 +389,46 @@ bool AudioRequestManager::createAudioRequest(uint32_t handle,
     bool suspended = !EventLoopManagerSingleton::get()
                           ->getSettingManager()
                           .getSettingEnabled(Setting::MICROPHONE);
-    postAudioSamplingChangeEvent(instanceId, handle, requestList.available,
-                                 suspended);
+    postAudioSamplingChangeEvent(&instanceId, 1 /* numInstanceIds */, handle,
+                                 requestList.available, suspended);
   }
 
   return success;
 }
 
+bool AudioRequestManager::initAudioFeatureRequest(
+    uint32_t handle, const AudioFeatureConfig &featureConfig,
+    AudioRequest &request) {
+  struct chreAudioSource source;
+  bool success = false;
+  request.featureConfig = featureConfig;
+  request.featureExtractor = MakeUnique<AudioFeatureExtractor>();
+  if (request.featureExtractor.isNull()) {
+    LOG_OOM();
+  } else if (mPlatformAudio.getAudioSource(handle, &source)) {
+    success = request.featureExtractor->init(
+        source.sampleRate, featureConfig.frameSize, featureConfig.numBins);
+  }
+  return success;
+}
+
 uint32_t AudioRequestManager::disableAllAudioRequests(const Nanoapp *nanoapp) {
   uint32_t numRequestDisabled = 0;
 
   const uint32_t numRequests = static_cast<uint32_t>(mAudioRequestLists.size());
   for (uint32_t handle = 0; handle < numRequests; ++handle) {
-    AudioRequest *audioRequest = findAudioRequestByInstanceId(
-        handle, nanoapp->getInstanceId(), nullptr /*index*/, nullptr
-        /*instanceIdIndex*/);
-
-    if (audioRequest != nullptr) {
-      numRequestDisabled++;
-      doConfigureSource(nanoapp->getInstanceId(), handle, false /*enable*/,
-                        0 /*numSamples*/, Nanoseconds() /*deliveryInterval*/);
+    for (bool features : {false, true}) {
+      AudioRequest *audioRequest = findAudioRequestByInstanceId(
+          handle, nanoapp->getInstanceId(), features, nullptr /*index*/,
+          nullptr /*instanceIdIndex*/);
+
+      if (audioRequest != nullptr) {
+        numRequestDisabled++;
+        AudioFeatureConfig featureConfig;
+        doConfigureSource(nanoapp->getInstanceId(), handle, false /*enable*/,
+                          0 /*numSamples*/, Nanoseconds() /*deliveryInterval*/,
+                          features ? &featureConfig : nullptr);
+      }
     }
   }
 
@@ -300,14 +438,15 @@ uint32_t AudioRequestManager::disableAllAudioRequests(const Nanoapp *nanoapp) {
 AudioRequestManager::AudioRequest *
 AudioRequestManager::findAudioRequestByInstanceId(uint32_t handle,
                                                   uint16_t instanceId,
-                                                  size_t *index,
+                                                  bool features, size_t *index,
                                                   size_t *instanceIdIndex) {
   AudioRequest *foundAudioRequest = nullptr;
   auto &requests = mAudioRequestLists[handle].requests;
   for (size_t i = 0; i < requests.size(); i++) {
     auto &audioRequest = requests[i];
     size_t foundInstanceIdIndex = audioRequest.instanceIds.find(instanceId);
-    if (foundInstanceIdIndex != audioRequest.instanceIds.size()) {
+    if (audioRequest.isFeatureRequest() == features &&
+        foundInstanceIdIndex != audioRequest.instanceIds.size()) {
       foundAudioRequest = &audioRequest;
       if (index != nullptr) {
         *index = i;
@@ -325,12 +464,17 @@ AudioRequestManager::findAudioRequestByInstanceId(uint32_t handle,
 AudioRequestManager::AudioRequest *
 AudioRequestManager::findAudioRequestByConfiguration(
     uint32_t handle, uint32_t numSamples, Nanoseconds deliveryInterval,
-    size_t *index) {
+    const AudioFeatureConfig *featureConfig, size_t *index) {
   AudioRequest *foundAudioRequest = nullptr;
   auto &requests = mAudioRequestLists[handle].requests;
   for (size_t i = 0; i < requests.size(); i++) {
     auto &audioRequest = requests[i];
-    if (audioRequest.numSamples == numSamples &&
+    bool featuresMatch =
+        (featureConfig == nullptr)
+            ? !audioRequest.isFeatureRequest()
+            : (audioRequest.isFeatureRequest() &&
+               audioRequest.featureConfig == *featureConfig);
+    if (featuresMatch && audioRequest.numSamples == numSamples &&
         audioRequest.deliveryInterval == deliveryInterval) {
       foundAudioRequest = &audioRequest;
       *index = i;
@@ -362,22 +506,76 @@ void AudioRequestManager::handleAudioDataEventSync(
   uint32_t handle = event->handle;
   if (handle < mAudioRequestLists.size()) {
     auto &reqList = mAudioRequestLists[handle];
-    AudioRequest *nextAudioRequest = reqList.nextAudioRequest;
-    if (nextAudioRequest != nullptr) {
-      postAudioDataEventFatal(event, nextAudioRequest->instanceIds);
-      nextAudioRequest->nextEventTimestamp =
-          SystemTime::getMonotonicTime() + nextAudioRequest->deliveryInterval;
-    } else {
+    if (!reqList.dataEventRequested || reqList.pendingDataEvent != nullptr) {
       LOGW("Received audio data event with no pending audio request");
       mPlatformAudio.releaseAudioDataEvent(event);
+      scheduleNextAudioDataEvent(handle);
+    } else if (usesCaptureRing(reqList) && !reqList.ring.canAppend(*event)) {
+      // Processed once nanoapps release the samples it would overwrite.
+      reqList.pendingDataEvent = event;
+    } else {
+      processAudioDataEvent(handle, event);
     }
-
-    scheduleNextAudioDataEvent(handle);
   } else {
     LOGE("Audio data event handle out of range: %" PRIu32, handle);
   }
 }
 
+void AudioRequestManager::processAudioDataEvent(
+    uint32_t handle, struct chreAudioDataEvent *event) {
+  auto &reqList = mAudioRequestLists[handle];
+  reqList.dataEventRequested = false;
+  if (!usesCaptureRing(reqList)) {
+    // A single request gets the event itself, as there is nothing to share.
+    AudioRequest *request = findNextAudioRequest(handle);
+    if (request == nullptr) {
+      mPlatformAudio.releaseAudioDataEvent(event);
+    } else {
+      postPlatformAudioDataEventFatal(event, *request);
+      request->nextEventTimestamp =
+          SystemTime::getMonotonicTime() + request->deliveryInterval;
+    }
+    scheduleNextAudioDataEvent(handle);
+    return;
+  }
+
+  reqList.ring.append(*event);
+  mPlatformAudio.releaseAudioDataEvent(event);
+
+  // Serve the request the event was requested for, and any other request due
+  // shortly after it rather than requesting another event for it.
+  AudioRequest *nextRequest = findNextAudioRequest(handle);
+  if (nextRequest != nullptr) {
+    Nanoseconds timeNow = SystemTime::getMonotonicTime();
+    Nanoseconds dueTime = (nextRequest->nextEventTimestamp > timeNow)
+                              ? nextRequest->nextEventTimestamp
+                              : timeNow;
+    for (auto &request : reqList.requests) {
+      Nanoseconds slack(request.deliveryInterval.toRawNanoseconds() /
+                        kDeliveryIntervalSlackDivisor);
+      if (request.nextEventTimestamp <= dueTime + slack) {
+        if (request.isFeatureRequest()) {
+          postAudioFeatureEventFatal(handle, request);
+        } else {
+          postAudioDataEventFatal(handle, request);
+        }
+        request.nextEventTimestamp = timeNow + request.deliveryInterval;
+      }
+    }
+  }
+
+  scheduleNextAudioDataEvent(handle);
+}
+
+void AudioRequestManager::releasePendingAudioDataEvent(uint32_t handle) {
+  auto &reqList = mAudioRequestLists[handle];
+  if (reqList.pendingDataEvent != nullptr) {
+    mPlatformAudio.releaseAudioDataEvent(reqList.pendingDataEvent);
+    reqList.pendingDataEvent = nullptr;
+    reqList.dataEventRequested = false;
+  }
+}
+
 void AudioRequestManager::handleAudioAvailabilitySync(uint32_t handle,
                                                       bool available) {
   if (handle < mAudioRequestLists.size()) {
@@ -404,18 +602,30 @@ void AudioRequestManager::scheduleNextAudioDataEvent(uint32_t handle) {
 
   auto &reqList = mAudioRequestLists[handle];
   AudioRequest *nextRequest = findNextAudioRequest(handle);
+  if (nextRequest == nullptr) {
+    releasePendingAudioDataEvent(handle);
+  } else if (reqList.pendingDataEvent != nullptr) {
+    // Scheduled again once the pending event is processed.
+    return;
+  }
 
-  // Clear the next request and it will be reset below if needed.
-  reqList.nextAudioRequest = nullptr;
+  // Clear the request and it will be set below if needed.
+  reqList.dataEventRequested = false;
   if (reqList.available && (nextRequest != nullptr)) {
+    uint32_t numSamples = 0;
+    for (const auto &request : reqList.requests) {
+      if (request.numSamples > numSamples) {
+        numSamples = request.numSamples;
+      }
+    }
+
     Nanoseconds curTime = SystemTime::getMonotonicTime();
     Nanoseconds eventDelay = Nanoseconds(0);
     if (nextRequest->nextEventTimestamp > curTime) {
       eventDelay = nextRequest->nextEventTimestamp - curTime;
     }
-    reqList.nextAudioRequest = nextRequest;
-    mPlatformAudio.requestAudioDataEvent(handle, nextRequest->numSamples,
-                                         eventDelay);
+    reqList.dataEventRequested = true;
+    mPlatformAudio.requestAudioDataEvent(handle, numSamples, eventDelay);
   } else {
     mPlatformAudio.cancelAudioDataEventRequest(handle);
   }
@@ -425,61 +635,159 @@ void AudioRequestManager::postAudioSamplingChangeEvents(uint32_t handle,
                                                         bool suspended) {
   const auto &requestList = mAudioRequestLists[handle];
   for (const auto &request : requestList.requests) {
-    for (const auto &instanceId : request.instanceIds) {
-      postAudioSamplingChangeEvent(instanceId, handle, requestList.available,
-                                   suspended);
+    const DynamicVector<uint16_t> &instanceIds = request.instanceIds;
+    for (size_t i = 0; i < instanceIds.size(); i += kMaxMulticastTargets) {
+      size_t numInstanceIds = instanceIds.size() - i;
+      if (numInstanceIds > kMaxMulticastTargets) {
+        numInstanceIds = kMaxMulticastTargets;
+      }
+      postAudioSamplingChangeEvent(&instanceIds[i], numInstanceIds, handle,
+                                   requestList.available, suspended);
     }
   }
 }
 
-void AudioRequestManager::postAudioSamplingChangeEvent(uint16_t instanceId,
-                                                       uint32_t handle,
-                                                       bool available,
-                                                       bool suspended) {
+void AudioRequestManager::postAudioSamplingChangeEvent(
+    const uint16_t *instanceIds, size_t numInstanceIds, uint32_t handle,
+    bool available, bool suspended) {
   auto *event = memoryAlloc<struct chreAudioSourceStatusEvent>();
   event->handle = handle;
   event->status.enabled = true;
   event->status.suspended = !available || suspended;
 
-  EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+  EventLoopManagerSingleton::get()->getEventLoop().postMulticastEventOrDie(
       CHRE_EVENT_AUDIO_SAMPLING_CHANGE, event, freeEventDataCallback,
-      instanceId);
+      instanceIds, numInstanceIds);
 }
 
-void AudioRequestManager::postAudioDataEventFatal(
-    struct chreAudioDataEvent *event,
-    const DynamicVector<uint16_t> &instanceIds) {
-  if (instanceIds.empty()) {
+void AudioRequestManager::postEventToRequestOrDie(
+    uint16_t eventType, void *eventData,
+    chreEventCompleteFunction *freeCallback, const AudioRequest &request) {
+  const DynamicVector<uint16_t> &instanceIds = request.instanceIds;
+  for (size_t i = 0; i < instanceIds.size(); i += kMaxMulticastTargets) {
+    size_t numTargets = instanceIds.size() - i;
+    if (numTargets > kMaxMulticastTargets) {
+      numTargets = kMaxMulticastTargets;
+    }
+    EventLoopManagerSingleton::get()->getEventLoop().postMulticastEventOrDie(
+        eventType, eventData, freeCallback, &instanceIds[i], numTargets);
+  }
+}
+
+void AudioRequestManager::postPlatformAudioDataEventFatal(
+    struct chreAudioDataEvent *event, const AudioRequest &request) {
+  if (request.instanceIds.empty()) {
     LOGW("Received audio data event for no clients");
     mPlatformAudio.releaseAudioDataEvent(event);
   } else {
-    for (const auto &instanceId : instanceIds) {
-      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
-          CHRE_EVENT_AUDIO_DATA, event, freeAudioDataEventCallback, instanceId);
+    // A single multicast event, released by its free callback.
+    CHRE_ASSERT(getNumMulticastEvents(request) == 1);
+    postEventToRequestOrDie(CHRE_EVENT_AUDIO_DATA, event,
+                            freePlatformAudioDataEventCallback, request);
+  }
+}
+
+void AudioRequestManager::postAudioDataEventFatal(
+    uint32_t handle, const AudioRequest &request) {
+  AudioCaptureRing &ring = mAudioRequestLists[handle].ring;
+  if (request.instanceIds.empty()) {
+    LOGW("Received audio data event for no clients");
+  } else if (ring.getSize() == 0) {
+    LOGW("No audio data to deliver for handle %" PRIu32, handle);
+  } else {
+    AudioCaptureRing::Window *window =
+        ring.createWindow(handle, request.numSamples);
+    if (window == nullptr) {
+      LOGE("Skipping audio data delivery for handle %" PRIu32, handle);
+      return;
     }
 
-    mAudioDataEventRefCounts.emplace_back(
-        event, static_cast<uint32_t>(instanceIds.size()));
+    // Each multicast event holds a reference until it is freed, once all its
+    // nanoapps processed it.
+    for (size_t i = 0; i < getNumMulticastEvents(request); i++) {
+      window->incRef();
+    }
+    postEventToRequestOrDie(CHRE_EVENT_AUDIO_DATA, window->getEvent(),
+                            freeAudioDataEventCallback, request);
+    window->decRef();
+  }
+}
+
+void AudioRequestManager::postAudioFeatureEventFatal(uint32_t handle,
+                                                     AudioRequest &request) {
+  const AudioCaptureRing &ring = mAudioRequestLists[handle].ring;
+  const AudioFeatureConfig &config = request.featureConfig;
+  uint64_t endPosition = ring.getEndPosition();
+  uint64_t startPosition = endPosition - ring.getSize();
+  if (request.nextFramePosition < startPosition) {
+    // Samples were missed, restart from the oldest ones.
+    request.nextFramePosition = startPosition;
+  }
+
+  if (request.instanceIds.empty()) {
+    LOGW("Received audio data event for no clients");
+  } else if (request.nextFramePosition + config.frameSize > endPosition) {
+    LOGW("No audio features to deliver for handle %" PRIu32, handle);
+  } else {
+    uint64_t numFrames =
+        (endPosition - config.frameSize - request.nextFramePosition) /
+            config.hopSize +
+        1;
+    if (numFrames > UINT16_MAX) {
+      numFrames = UINT16_MAX;
+    }
+
+    size_t numEnergies = static_cast<size_t>(numFrames) * config.numBins;
+    auto *featureEvent = static_cast<AudioFeatureEvent *>(memoryAlloc(
+        sizeof(AudioFeatureEvent) + numEnergies * sizeof(int16_t)));
+    if (featureEvent == nullptr) {
+      // The frames stay in the ring for the next delivery, if not overwritten.
+      LOG_OOM();
+      return;
+    }
+
+    auto *logMelEnergies = reinterpret_cast<int16_t *>(featureEvent + 1);
+    struct chreextAudioFeatureEvent &event = featureEvent->event;
+    memset(&event, 0, sizeof(event));
+    event.version = CHREEXT_AUDIO_FEATURE_EVENT_VERSION;
+    event.handle = handle;
+    event.timestamp = ring.getTimestamp(request.nextFramePosition);
+    event.sampleRate = ring.getSampleRate();
+    event.frameSize = config.frameSize;
+    event.hopSize = config.hopSize;
+    event.numBins = config.numBins;
+    event.numFrames = static_cast<uint16_t>(numFrames);
+    event.logMelEnergies = logMelEnergies;
+
+    for (uint16_t i = 0; i < event.numFrames; i++) {
+      request.featureExtractor->computeFrame(
+          ring.getSamples(request.nextFramePosition, config.frameSize),
+          ring.getFormat(), &logMelEnergies[i * config.numBins]);
+      request.nextFramePosition += config.hopSize;
+    }
+
+    featureEvent->refCount =
+        static_cast<uint32_t>(getNumMulticastEvents(request));
+    postEventToRequestOrDie(CHREEXT_EVENT_AUDIO_FEATURES, &featureEvent->event,
+                            freeAudioFeatureEventCallback, request);
   }
 }
 
 void AudioRequestManager::handleFreeAudioDataEvent(
     struct chreAudioDataEvent *audioDataEvent) {
-  size_t audioDataEventRefCountIndex =
-      mAudioDataEventRefCounts.find(AudioDataEventRefCount(audioDataEvent));
-  if (audioDataEventRefCountIndex == mAudioDataEventRefCounts.size()) {
+  uint32_t handle = audioDataEvent->handle;
+  if (handle >= mAudioRequestLists.size()) {
     LOGE("Freeing invalid audio data event");
   } else {
-    auto &audioDataEventRefCount =
-        mAudioDataEventRefCounts[audioDataEventRefCountIndex];
-    if (audioDataEventRefCount.refCount == 0) {
-      LOGE("Attempting to free an event with zero published events");
-    } else {
-      audioDataEventRefCount.refCount--;
-      if (audioDataEventRefCount.refCount == 0) {
-        mAudioDataEventRefCounts.erase(audioDataEventRefCountIndex);
-        mPlatformAudio.releaseAudioDataEvent(audioDataEvent);
-      }
+    // The window is destroyed with its last reference, which may unblock the
+    // pending event.
+    AudioCaptureRing::fromEvent(audioDataEvent)->decRef();
+
+    auto &reqList = mAudioRequestLists[handle];
+    struct chreAudioDataEvent *pendingEvent = reqList.pendingDataEvent;
+    if (pendingEvent != nullptr && reqList.ring.canAppend(*pendingEvent)) {
+      reqList.pendingDataEvent = nullptr;
+      processAudioDataEvent(handle, pendingEvent);
     }
   }
 }
@@ -493,6 +801,25 @@ void AudioRequestManager::freeAudioDataEventCallback(uint16_t eventType,
       .handleFreeAudioDataEvent(event);
 }
 
+void AudioRequestManager::freePlatformAudioDataEventCallback(uint16_t eventType,
+                                                             void *eventData) {
+  UNUSED_VAR(eventType);
+  auto *event = static_cast<struct chreAudioDataEvent *>(eventData);
+  EventLoopManagerSingleton::get()
+      ->getAudioRequestManager()
+      .mPlatformAudio.releaseAudioDataEvent(event);
+}
+
+void AudioRequestManager::freeAudioFeatureEventCallback(uint16_t eventType,
+                                                        void *eventData) {
+  UNUSED_VAR(eventType);
+  auto *featureEvent = static_cast<AudioFeatureEvent *>(eventData);
+  featureEvent->refCount--;
+  if (featureEvent->refCount == 0) {
+    memoryFree(featureEvent);
+  }
+}
+
 void AudioRequestManager::onSettingChanged(Setting setting, bool enabled) {
   if (setting == Setting::MICROPHONE) {
     for (size_t i = 0; i < mAudioRequestLists.size(); ++i) {
@@ -501,6 +828,8 @@ void AudioRequestManager::onSettingChanged(Setting setting, bool enabled) {
         if (!enabled) {
           LOGD("Canceling data event request for handle %" PRIu32, handle);
           postAudioSamplingChangeEvents(handle, true /* suspended */);
+          releasePendingAudioDataEvent(handle);
+          mAudioRequestLists[i].dataEventRequested = false;
           mPlatformAudio.cancelAudioDataEventRequest(handle);
         } else {
           LOGD("Scheduling data event for handle %" PRIu32, handle);
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/core/init.h"
+#include "chre/core/nanoapp.h"
+#include "chre/platform/linux/task_util/task_manager.h"
+#include "chre/platform/static_nanoapp_init.h"
+#include "chre/util/system/napp_permissions.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+
+namespace chre {
+namespace {
+
+constexpr uint64_t kBenchmarkAppId = 0x476f6f676c00beefULL;
+constexpr uint16_t kBenchmarkEventType = CHRE_EVENT_FIRST_USER_VALUE;
+
+//! Written by the event loop thread, read by the benchmark thread.
+std::atomic<uint32_t> gNumEventsHandled;
+std::atomic<bool> gNanoappStarted;
+
+bool nanoappStart() {
+  return true;
+}
+
+void nanoappHandleEvent(uint32_t /* senderInstanceId */, uint16_t eventType,
+                        const void * /* eventData */) {
+  if (eventType == kBenchmarkEventType) {
+    gNumEventsHandled.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void nanoappEnd() {}
+
+}  // namespace
+}  // namespace chre
+
+CHRE_STATIC_NANOAPP_INIT(EventLoopBenchmark, chre::kBenchmarkAppId, 0,
+                         chre::NanoappPermissions::CHRE_PERMS_NONE);
+
+namespace chre {
+namespace {
+
+void finishLoadingNanoappCallback(SystemCallbackType /* type */,
+                                  UniquePtr<Nanoapp> &&nanoapp) {
+  EventLoopManagerSingleton::get()->getEventLoop().startNanoapp(nanoapp);
+  gNanoappStarted.store(true, std::memory_order_release);
+}
+
+void noOpTimerCallback(uint16_t /* type */, void * /* data */,
+                       void * /* extraData */) {}
+
+//! Runs CHRE with its event loop in a separate thread, as in the simulation
+//! tests, and the benchmark nanoapp loaded.
+class ChreRuntime {
+ public:
+  ChreRuntime() {
+    TaskManagerSingleton::init();
+    chre::init();
+    EventLoopManagerSingleton::get()->lateInit();
+    mChreThread = std::thread(
+        []() { EventLoopManagerSingleton::get()->getEventLoop().run(); });
+
+    gNanoappStarted = false;
+    EventLoopManagerSingleton::get()->deferCallback(
+        SystemCallbackType::FinishLoadingNanoapp,
+        initializeStaticNanoappEventLoopBenchmark(),
+        finishLoadingNanoappCallback);
+    while (!gNanoappStarted.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    EventLoopManagerSingleton::get()
+        ->getEventLoop()
+        .findNanoappInstanceIdByAppId(kBenchmarkAppId, &mInstanceId);
+  }
+
+  ~ChreRuntime() {
+    EventLoopManagerSingleton::get()->getEventLoop().stop();
+    mChreThread.join();
+    chre::deinit();
+    TaskManagerSingleton::deinit();
+  }
+
+  uint16_t getNanoappInstanceId() const {
+    return mInstanceId;
+  }
+
+ private:
+  std::thread mChreThread;
+  uint16_t mInstanceId = kInvalidInstanceId;
+};
+
+//! Posts batches of events to the nanoapp and waits until all of them were
+//! delivered, which includes waking up the event loop thread.
+void BM_EventLoopPostAndDistribute(benchmark::State &state) {
+  const auto batchSize = static_cast<uint32_t>(state.range(0));
+  ChreRuntime runtime;
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  uint32_t numEventsPosted = gNumEventsHandled.load();
+
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < batchSize; i++) {
+      eventLoop.postEventOrDie(kBenchmarkEventType, /* eventData= */ nullptr,
+                               /* freeCallback= */ nullptr,
+                               runtime.getNanoappInstanceId());
+    }
+    numEventsPosted += batchSize;
+    while (gNumEventsHandled.load(std::memory_order_acquire) !=
+           numEventsPosted) {
+      std::this_thread::yield();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_EventLoopPostAndDistribute)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(64)
+    ->UseRealTime();
+
+//! Sets timers in a shuffled order of expiration and cancels them, which
+//! keeps the underlying system timer pointed at the earliest one.
+void BM_TimerPoolSetAndCancel(benchmark::State &state) {
+  constexpr size_t kMaxTimers = 16;
+  const auto numTimers = static_cast<size_t>(state.range(0));
+  ChreRuntime runtime;
+  TimerPool &timerPool =
+      EventLoopManagerSingleton::get()->getEventLoop().getTimerPool();
+  TimerHandle handles[kMaxTimers];
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < numTimers; i++) {
+      // The timers are far enough in the future to never expire while the
+      // benchmark runs.
+      Nanoseconds duration =
+          Seconds(3600) + Milliseconds((i * 7) % numTimers);
+      handles[i] = timerPool.setSystemTimer(
+          duration, noOpTimerCallback, SystemCallbackType::FirstCallbackType,
+          /* data= */ nullptr);
+    }
+    for (size_t i = 0; i < numTimers; i++) {
+      timerPool.cancelSystemTimer(handles[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * numTimers);
+}
+BENCHMARK(BM_TimerPoolSetAndCancel)->Arg(1)->Arg(4)->Arg(16);
+
+}  // namespace
+}  // namespace chre
@@ -39,6 +39,38 @@ bool broadcasterFiltersMatch(
                  sizeof(filter.broadcasterAddress)) == 0);
 }
 
+/**
+ * @return true if the data of the report holds an AD structure matching the
+ *     generic filter, as defined in chreBleGenericFilter.
+ */
+bool reportMatchesGenericFilter(const chreBleAdvertisingReport &report,
+                                const chreBleGenericFilter &filter) {
+  // Each AD structure is made of a length byte, followed by the AD type and
+  // the AD data. A zero length marks the end of the significant part.
+  size_t offset = 0;
+  while (offset < report.dataLength) {
+    size_t structureLen = report.data[offset];
+    if (structureLen == 0 || structureLen > report.dataLength - offset - 1) {
+      break;
+    }
+
+    const uint8_t *adData = &report.data[offset + 2];
+    size_t adDataLen = structureLen - 1;
+    if (report.data[offset + 1] == filter.type && adDataLen >= filter.len) {
+      bool matches = true;
+      for (size_t i = 0; i < filter.len && matches; i++) {
+        matches = (adData[i] & filter.dataMask[i]) ==
+                  (filter.data[i] & filter.dataMask[i]);
+      }
+      if (matches) {
+        return true;
+      }
+    }
+    offset += structureLen + 1;
+  }
+  return false;
+}
+
 }  // namespace
 
 BleRequest::BleRequest()
@@ -235,6 +267,33 @@ bool BleRequest::isEnabled() const {
   return mEnabled;
 }
 
+bool BleRequest::matchesAllReports() const {
+  return mRssiThreshold == CHRE_BLE_RSSI_THRESHOLD_NONE &&
+         mGenericFilters.empty() && mBroadcasterFilters.empty();
+}
+
+bool BleRequest::matchesReport(const chreBleAdvertisingReport &report) const {
+  if (report.rssi < mRssiThreshold) {
+    return false;
+  }
+  if (mGenericFilters.empty() && mBroadcasterFilters.empty()) {
+    return true;
+  }
+
+  for (const chreBleGenericFilter &filter : mGenericFilters) {
+    if (reportMatchesGenericFilter(report, filter)) {
+      return true;
+    }
+  }
+  for (const chreBleBroadcasterAddressFilter &filter : mBroadcasterFilters) {
+    if (memcmp(report.address, filter.broadcasterAddress,
+               sizeof(report.address)) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 const void *BleRequest::getCookie() const {
   return mCookie;
 }
@@ -270,14 +270,138 @@ void BleRequestManager::freeAdvertisingEventCallback(uint16_t /* eventType */,
       .handleFreeAdvertisingEvent(event);
 }
 
+void BleRequestManager::freeNanoappAdvertisingEventCallback(
+    uint16_t /* eventType */, void *eventData) {
+  auto *nanoappEvent = reinterpret_cast<NanoappAdvertisementEvent *>(
+      static_cast<chreBleAdvertisementEvent *>(eventData));
+  SharedAdvertisementEvent *shared = nanoappEvent->shared;
+  if (--shared->numPendingEvents == 0) {
+    EventLoopManagerSingleton::get()
+        ->getBleRequestManager()
+        .handleFreeAdvertisingEvent(shared->platformEvent);
+    memoryFree(shared->storage);
+  }
+}
+
 void BleRequestManager::handleAdvertisementEvent(
     struct chreBleAdvertisementEvent *event) {
+  auto callback = [](uint16_t /*type*/, void *data, void * /*extraData*/) {
+    EventLoopManagerSingleton::get()
+        ->getBleRequestManager()
+        .handleAdvertisementEventSync(
+            static_cast<chreBleAdvertisementEvent *>(data));
+  };
+
+  if (!EventLoopManagerSingleton::get()->deferCallback(
+          SystemCallbackType::BleAdvertisementEvent, event, callback)) {
+    handleFreeAdvertisingEvent(event);
+  }
+}
+
+void BleRequestManager::handleAdvertisementEventSync(
+    struct chreBleAdvertisementEvent *event) {
   for (uint16_t i = 0; i < event->numReports; i++) {
     populateLegacyAdvertisingReportFields(
         const_cast<chreBleAdvertisingReport &>(event->reports[i]));
   }
-  EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
-      CHRE_EVENT_BLE_ADVERTISEMENT, event, freeAdvertisingEventCallback);
+
+  // Count the events and the report copies first to allocate them at once.
+  size_t numEvents = 0;
+  size_t numReportCopies = 0;
+  for (const BleRequest &request : mRequests.getRequests()) {
+    if (!isAdvertisementRecipient(request)) {
+      continue;
+    }
+    if (request.matchesAllReports()) {
+      numEvents += (event->numReports > 0) ? 1 : 0;
+      continue;
+    }
+
+    size_t numMatches = 0;
+    for (uint16_t i = 0; i < event->numReports; i++) {
+      numMatches += request.matchesReport(event->reports[i]) ? 1 : 0;
+    }
+    numEvents += (numMatches > 0) ? 1 : 0;
+    numReportCopies += numMatches;
+  }
+
+  if (numEvents == 0) {
+    handleFreeAdvertisingEvent(event);
+    return;
+  }
+
+  // The reports are first as they have the strictest alignment.
+  static_assert(alignof(chreBleAdvertisingReport) >=
+                    alignof(NanoappAdvertisementEvent),
+                "Misaligned NanoappAdvertisementEvent");
+  static_assert(alignof(NanoappAdvertisementEvent) >=
+                    alignof(SharedAdvertisementEvent),
+                "Misaligned SharedAdvertisementEvent");
+  void *storage = memoryAlloc(
+      numReportCopies * sizeof(chreBleAdvertisingReport) +
+      numEvents * sizeof(NanoappAdvertisementEvent) +
+      sizeof(SharedAdvertisementEvent));
+  if (storage == nullptr) {
+    // Nanoapps must handle reports that do not match their filters, as these
+    // are best-effort, so fall back to broadcasting the platform event.
+    LOG_OOM();
+    EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+        CHRE_EVENT_BLE_ADVERTISEMENT, event, freeAdvertisingEventCallback);
+    return;
+  }
+
+  auto *reportCopies = static_cast<chreBleAdvertisingReport *>(storage);
+  auto *nanoappEvents = reinterpret_cast<NanoappAdvertisementEvent *>(
+      reportCopies + numReportCopies);
+  auto *shared =
+      reinterpret_cast<SharedAdvertisementEvent *>(nanoappEvents + numEvents);
+  shared->platformEvent = event;
+  shared->storage = storage;
+  shared->numPendingEvents = numEvents;
+
+  for (const BleRequest &request : mRequests.getRequests()) {
+    if (!isAdvertisementRecipient(request)) {
+      continue;
+    }
+
+    // The copies only hold the report fields: the advertising data is still
+    // that of the platform event.
+    const chreBleAdvertisingReport *reports = event->reports;
+    uint16_t numReports = event->numReports;
+    if (!request.matchesAllReports()) {
+      reports = reportCopies;
+      numReports = 0;
+      for (uint16_t i = 0; i < event->numReports; i++) {
+        if (request.matchesReport(event->reports[i])) {
+          reportCopies[numReports++] = event->reports[i];
+        }
+      }
+      reportCopies += numReports;
+    }
+
+    if (numReports > 0) {
+      NanoappAdvertisementEvent *nanoappEvent = nanoappEvents++;
+      nanoappEvent->event.reserved = 0;
+      nanoappEvent->event.numReports = numReports;
+      nanoappEvent->event.reports = reports;
+      nanoappEvent->shared = shared;
+      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+          CHRE_EVENT_BLE_ADVERTISEMENT, &nanoappEvent->event,
+          freeNanoappAdvertisingEventCallback, request.getInstanceId());
+    }
+  }
+}
+
+bool BleRequestManager::isAdvertisementRecipient(
+    const BleRequest &request) const {
+  if (!request.isEnabled()) {
+    return false;
+  }
+  const Nanoapp *nanoapp =
+      EventLoopManagerSingleton::get()->getEventLoop().findNanoappByInstanceId(
+          request.getInstanceId());
+  return nanoapp != nullptr &&
+         nanoapp->isRegisteredForBroadcastEvent(CHRE_EVENT_BLE_ADVERTISEMENT);
 }
 
 void BleRequestManager::handlePlatformChange(bool enable, uint8_t errorCode) {
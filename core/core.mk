@@ -19,6 +19,7 @@ COMMON_SRCS += $(CHRE_PREFIX)/core/host_endpoint_manager.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/init.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/log.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/nanoapp.cc
+COMMON_SRCS += $(CHRE_PREFIX)/core/power_policy.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/settings.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/static_nanoapps.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/system_health_monitor.cc
@@ -26,6 +27,8 @@ COMMON_SRCS += $(CHRE_PREFIX)/core/timer_pool.cc
 
 # Optional audio support.
 ifeq ($(CHRE_AUDIO_SUPPORT_ENABLED), true)
+COMMON_SRCS += $(CHRE_PREFIX)/core/audio_capture_ring.cc
+COMMON_SRCS += $(CHRE_PREFIX)/core/audio_feature_extractor.cc
 COMMON_SRCS += $(CHRE_PREFIX)/core/audio_request_manager.cc
 endif
 
@@ -78,9 +81,15 @@ endif
 
 # GoogleTest Source Files ######################################################
 
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/audio_capture_ring_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/audio_feature_extractor_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/audio_util_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/ble_request_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/memory_manager_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/request_multiplexer_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/sensor_request_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/core/tests/wifi_scan_request_test.cc
+
+# Benchmark Source Files #######################################################
+
+BENCHMARK_SRCS += $(CHRE_PREFIX)/core/benchmarks/event_loop_benchmark.cc
@@ -71,9 +71,11 @@ void DebugDumpManager::appendNanoappLog(const Nanoapp &nanoapp,
 
 void DebugDumpManager::collectFrameworkDebugDumps() {
   auto *eventLoopManager = EventLoopManagerSingleton::get();
-  eventLoopManager->getMemoryManager().logStateToBuffer(mDebugDump);
   eventLoopManager->getEventLoop().handleNanoappWakeupBuckets();
-  eventLoopManager->getEventLoop().logStateToBuffer(mDebugDump);
+  if (!sendStructuredDebugDump()) {
+    eventLoopManager->getMemoryManager().logStateToBuffer(mDebugDump);
+    eventLoopManager->getEventLoop().logStateToBuffer(mDebugDump);
+  }
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
   eventLoopManager->getSensorRequestManager().logStateToBuffer(mDebugDump);
 #endif  // CHRE_SENSORS_SUPPORT_ENABLED
@@ -96,14 +98,25 @@ void DebugDumpManager::collectFrameworkDebugDumps() {
   logStateToBuffer(mDebugDump);
 }
 
-void DebugDumpManager::sendFrameworkDebugDumps() {
-  for (size_t i = 0; i < mDebugDump.getBuffers().size(); i++) {
-    const auto &buff = mDebugDump.getBuffers()[i];
-    sendDebugDump(buff.get(), false /*complete*/);
+bool DebugDumpManager::sendDebugDumpBuffer(const char *buffer, void *cookie) {
+  return static_cast<DebugDumpManager *>(cookie)->sendDebugDump(
+      buffer, false /*complete*/);
+}
+
+void DebugDumpManager::flushDebugDump() {
+  if (!mDebugDump.flush()) {
+    LOGE("Failed to send debug dump buffers");
+  }
+  if (mDebugDump.getNumDroppedStrings() > 0) {
+    LOGW("Dropped %zu debug dump strings", mDebugDump.getNumDroppedStrings());
   }
 
-  // Clear out buffers before nanoapp debug dumps to reduce peak memory usage.
+  // Release the buffers while no debug dump is being collected.
   mDebugDump.clear();
+}
+
+void DebugDumpManager::sendFrameworkDebugDumps() {
+  flushDebugDump();
 
   // Mark the beginning of nanoapp debug dumps
   mDebugDump.print("\n\nNanoapp debug dumps:");
@@ -111,21 +124,11 @@ void DebugDumpManager::sendFrameworkDebugDumps() {
 }
 
 void DebugDumpManager::sendNanoappDebugDumps() {
-  // Avoid buffer underflow when mDebugDump failed to allocate buffers.
-  size_t numBuffers = mDebugDump.getBuffers().size();
-  if (numBuffers > 0) {
-    for (size_t i = 0; i < numBuffers - 1; i++) {
-      const auto &buff = mDebugDump.getBuffers()[i];
-      sendDebugDump(buff.get(), false /*complete*/);
-    }
+  flushDebugDump();
+  if (!sendDebugDump("", true /*complete*/)) {
+    LOGE("Failed to complete the debug dump");
   }
 
-  const char *debugStr =
-      (numBuffers > 0) ? mDebugDump.getBuffers().back().get() : "";
-  sendDebugDump(debugStr, true /*complete*/);
-
-  // Clear current session debug dumps and release memory.
-  mDebugDump.clear();
   mLastNanoappId.reset();
   mCollectingNanoappDebugDumps = false;
 }
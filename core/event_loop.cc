@@ -339,6 +339,24 @@ void EventLoop::postEventOrDie(uint16_t eventType, void *eventData,
   }
 }
 
+void EventLoop::postMulticastEventOrDie(uint16_t eventType, void *eventData,
+                                        chreEventCompleteFunction *freeCallback,
+                                        const uint16_t *targetInstanceIds,
+                                        size_t numTargets) {
+  if (mRunning) {
+    Event *event = nullptr;
+    if (!hasNoSpaceForHighPriorityEvent()) {
+      event = mEventPool.allocate(eventType, eventData, freeCallback,
+                                  targetInstanceIds, numTargets);
+    }
+    if (event == nullptr || !mEvents.push(event)) {
+      FATAL_ERROR("Failed to post critical system event 0x%" PRIx16, eventType);
+    }
+  } else if (freeCallback != nullptr) {
+    freeCallback(eventType, eventData);
+  }
+}
+
 bool EventLoop::postSystemEvent(uint16_t eventType, void *eventData,
                                 SystemEventCallbackFunction *callback,
                                 void *extraData) {
@@ -518,16 +536,16 @@ void EventLoop::distributeEvent(Event *event) {
   for (const UniquePtr<Nanoapp> &app : mNanoapps) {
     if ((event->targetInstanceId == chre::kBroadcastInstanceId &&
          app->isRegisteredForBroadcastEvent(event)) ||
-        event->targetInstanceId == app->getInstanceId()) {
+        event->isTargetedAt(app->getInstanceId())) {
       eventDelivered = true;
       deliverNextEvent(app, event);
     }
   }
-  // Log if an event unicast to a nanoapp isn't delivered, as this is could be
-  // a bug (e.g. something isn't properly keeping track of when nanoapps are
-  // unloaded), though it could just be a harmless transient issue (e.g. race
-  // condition with nanoapp unload, where we post an event to a nanoapp just
-  // after queues are flushed while it's unloading)
+  // Log if an event unicast or multicast to nanoapps isn't delivered to any of
+  // them, as this is could be a bug (e.g. something isn't properly keeping
+  // track of when nanoapps are unloaded), though it could just be a harmless
+  // transient issue (e.g. race condition with nanoapp unload, where we post an
+  // event to a nanoapp just after queues are flushed while it's unloading)
   if (!eventDelivered && event->targetInstanceId != kBroadcastInstanceId &&
       event->targetInstanceId != kSystemInstanceId) {
     LOGW("Dropping event 0x%" PRIx16 " from instanceId %" PRIu16 "->%" PRIu16,
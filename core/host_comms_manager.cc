@@ -155,6 +155,10 @@ void HostCommsManager::freeAllReliableMessagesFromNanoapp(
 }
 
 void HostCommsManager::flushNanoappMessages(Nanoapp &nanoapp) {
+  // Batched messages are sent before the reliable messages, which keeps them
+  // in order
+  flushMessageBatch();
+
   // First we remove all of the outgoing reliable message transactions from the
   // transaction manager, which triggers sending any pending reliable messages
   removeAllTransactionsFromNanoapp(nanoapp);
@@ -180,6 +184,20 @@ void HostCommsManager::resetBlameForNanoappHostWakeup() {
   mIsNanoappBlamedForWakeup = false;
 }
 
+void HostCommsManager::onHostAwake() {
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+  auto callback = [](uint16_t /*type*/, void * /*data*/,
+                     void * /*extraData*/) {
+    EventLoopManagerSingleton::get()
+        ->getHostCommsManager()
+        .flushMessageBatch();
+  };
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::HostMessageBatchFlush, /* data= */ nullptr,
+      callback);
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+}
+
 bool HostCommsManager::sendMessageToHostFromNanoapp(
     Nanoapp *nanoapp, void *messageData, size_t messageSize,
     uint32_t messageType, uint16_t hostEndpoint, uint32_t messagePermissions,
@@ -211,11 +229,23 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
   bool success = false;
   if (isReliable) {
 #ifdef CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
+    // The first attempt to send the message may happen within add()
+    mReliableMessageBeingAdded = msgToHost;
     success = mTransactionManager.add(nanoapp->getInstanceId(),
                                       &msgToHost->messageSequenceNumber);
+    mReliableMessageBeingAdded = nullptr;
+    if (success) {
+      // Can't fail: the index has the capacity for all the messages
+      mReliableMessagesToHost.insert(msgToHost->messageSequenceNumber,
+                                     msgToHost);
+    }
 #endif  // CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
   } else {
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+    success = batchMessageToHostFromNanoapp(nanoapp, msgToHost);
+#else
     success = doSendMessageToHostFromNanoapp(nanoapp, msgToHost);
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
   }
 
   if (!success) {
@@ -228,10 +258,21 @@ void HostCommsManager::sendMessageToNanoappFromHost(
     uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
     const void *messageData, size_t messageSize, bool isReliable,
     uint32_t messageSequenceNumber) {
+  sendMessageToNanoappFromHost(appId, messageType, hostEndpoint, messageData,
+                               messageSize, isReliable, messageSequenceNumber,
+                               /* releaseFunction= */ nullptr,
+                               /* releaseData= */ nullptr);
+}
+
+void HostCommsManager::sendMessageToNanoappFromHost(
+    uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
+    const void *messageData, size_t messageSize, bool isReliable,
+    uint32_t messageSequenceNumber, HostMessageReleaseFunction *releaseFunction,
+    void *releaseData) {
   std::pair<chreError, MessageFromHost *> output =
       validateAndCraftMessageFromHostToNanoapp(
           appId, messageType, hostEndpoint, messageData, messageSize,
-          isReliable, messageSequenceNumber);
+          isReliable, messageSequenceNumber, releaseFunction, releaseData);
   chreError error = output.first;
   MessageFromHost *craftedMessage = output.second;
 
@@ -259,7 +300,9 @@ void HostCommsManager::sendMessageToNanoappFromHost(
 #endif  // CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
 
     if (craftedMessage != nullptr) {
-      mMessagePool.deallocate(craftedMessage);
+      freeMessageFromHost(craftedMessage);
+    } else if (releaseFunction != nullptr) {
+      releaseFunction(releaseData);
     }
   }
 }
@@ -267,10 +310,18 @@ void HostCommsManager::sendMessageToNanoappFromHost(
 MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
     uint64_t appId, uint16_t hostEndpoint, uint32_t messageType,
     const void *messageData, uint32_t messageSize, bool isReliable,
-    uint32_t messageSequenceNumber) {
+    uint32_t messageSequenceNumber, HostMessageReleaseFunction *releaseFunction,
+    void *releaseData) {
   MessageFromHost *msgFromHost = mMessagePool.allocate();
   if (msgFromHost == nullptr) {
     LOG_OOM();
+  } else if (releaseFunction != nullptr) {
+    // The nanoapp only gets a const pointer to the message data, so it is not
+    // modified even though Buffer takes a non-const pointer
+    msgFromHost->message.wrap(
+        static_cast<uint8_t *>(const_cast<void *>(messageData)), messageSize);
+    msgFromHost->releaseFunction = releaseFunction;
+    msgFromHost->releaseData = releaseData;
   } else if (!msgFromHost->message.copy_array(
                  static_cast<const uint8_t *>(messageData), messageSize)) {
     LOGE("Couldn't allocate %" PRIu32
@@ -279,7 +330,9 @@ MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
          messageSize, hostEndpoint, messageType);
     mMessagePool.deallocate(msgFromHost);
     msgFromHost = nullptr;
-  } else {
+  }
+
+  if (msgFromHost != nullptr) {
     msgFromHost->appId = appId;
     msgFromHost->fromHostData.messageType = messageType;
     msgFromHost->fromHostData.messageSize = messageSize;
@@ -305,7 +358,8 @@ std::pair<chreError, MessageFromHost *>
 HostCommsManager::validateAndCraftMessageFromHostToNanoapp(
     uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
     const void *messageData, size_t messageSize, bool isReliable,
-    uint32_t messageSequenceNumber) {
+    uint32_t messageSequenceNumber, HostMessageReleaseFunction *releaseFunction,
+    void *releaseData) {
   chreError error = CHRE_ERROR_NONE;
   MessageFromHost *craftedMessage = nullptr;
 
@@ -322,7 +376,7 @@ HostCommsManager::validateAndCraftMessageFromHostToNanoapp(
     craftedMessage = craftNanoappMessageFromHost(
         appId, hostEndpoint, messageType, messageData,
         static_cast<uint32_t>(messageSize), isReliable,
-        messageSequenceNumber);
+        messageSequenceNumber, releaseFunction, releaseData);
     if (craftedMessage == nullptr) {
       LOGE("Out of memory - rejecting message to app ID 0x%016" PRIx64
             "(size %zu)",
@@ -363,15 +417,25 @@ void HostCommsManager::deliverNanoappMessageFromHost(
         craftedMessage->messageSequenceNumber,
         craftedMessage->fromHostData.hostEndpoint, error.value());
   }
-  mMessagePool.deallocate(craftedMessage);
+  freeMessageFromHost(craftedMessage);
 
 #ifdef CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
   mDuplicateMessageDetector.removeOldEntries();
 #endif  // CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
 }
 
+void HostCommsManager::freeMessageFromHost(MessageFromHost *msgFromHost) {
+  if (msgFromHost->releaseFunction != nullptr) {
+    msgFromHost->releaseFunction(msgFromHost->releaseData);
+  }
+  mMessagePool.deallocate(msgFromHost);
+}
+
 bool HostCommsManager::doSendMessageToHostFromNanoapp(
     Nanoapp *nanoapp, MessageToHost *msgToHost) {
+  // Messages sent on their own must not overtake the batched ones
+  flushMessageBatch();
+
   bool hostWasAwake = EventLoopManagerSingleton::get()
                           ->getEventLoop()
                           .getPowerControlManager()
@@ -394,16 +458,114 @@ bool HostCommsManager::doSendMessageToHostFromNanoapp(
   return true;
 }
 
+bool HostCommsManager::batchMessageToHostFromNanoapp(
+    [[maybe_unused]] Nanoapp *nanoapp,
+    [[maybe_unused]] MessageToHost *msgToHost) {
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+  size_t messageSize = msgToHost->message.size();
+  if (messageSize > kMaxMessageBatchSize) {
+    return doSendMessageToHostFromNanoapp(nanoapp, msgToHost);
+  }
+  if (mMessageBatchSize + messageSize > kMaxMessageBatchSize) {
+    flushMessageBatch();
+  }
+
+  msgToHost->toHostData.wokeHost = false;
+  mMessageBatch.push_back(msgToHost);
+  mMessageBatchSize += messageSize;
+  nanoapp->blameHostMessageSent();
+
+  if (mMessageBatch.full()) {
+    flushMessageBatch();
+  } else if (mMessageBatch.size() == 1) {
+    // The first message sets the deadline of the batch. While the host is
+    // asleep, messages wait longer so that they don't wake it up on their own.
+    mMessageBatchFirstSenderInstanceId = nanoapp->getInstanceId();
+    bool hostIsAwake = EventLoopManagerSingleton::get()
+                           ->getEventLoop()
+                           .getPowerControlManager()
+                           .hostIsAwake();
+    Milliseconds latency(hostIsAwake
+                             ? CHRE_HOST_MESSAGE_BATCH_LATENCY_MS
+                             : CHRE_HOST_MESSAGE_BATCH_ASLEEP_LATENCY_MS);
+    auto callback = [](uint16_t /*type*/, void * /*data*/,
+                       void * /*extraData*/) {
+      HostCommsManager &manager =
+          EventLoopManagerSingleton::get()->getHostCommsManager();
+      manager.mMessageBatchTimerHandle = CHRE_TIMER_INVALID;
+      manager.flushMessageBatch();
+    };
+    mMessageBatchTimerHandle =
+        EventLoopManagerSingleton::get()->setDelayedCallback(
+            SystemCallbackType::HostMessageBatchFlush, /* data= */ nullptr,
+            callback, latency);
+    if (mMessageBatchTimerHandle == CHRE_TIMER_INVALID) {
+      LOGE("Failed to set the host message batch timer");
+      flushMessageBatch();
+    }
+  }
+  return true;
+#else
+  return false;
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+}
+
+void HostCommsManager::flushMessageBatch() {
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+  if (mMessageBatchTimerHandle != CHRE_TIMER_INVALID) {
+    EventLoopManagerSingleton::get()->cancelDelayedCallback(
+        mMessageBatchTimerHandle);
+    mMessageBatchTimerHandle = CHRE_TIMER_INVALID;
+  }
+  if (mMessageBatch.empty()) {
+    return;
+  }
+
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  bool hostWasAwake = eventLoop.getPowerControlManager().hostIsAwake();
+  bool wokeHost = !hostWasAwake && !mIsNanoappBlamedForWakeup;
+  mMessageBatch[0]->toHostData.wokeHost = wokeHost;
+
+  if (HostLink::sendMessageBatch(mMessageBatch.data(), mMessageBatch.size())) {
+    if (wokeHost) {
+      eventLoop.handleNanoappWakeupBuckets();
+      mIsNanoappBlamedForWakeup = true;
+      Nanoapp *nanoapp =
+          eventLoop.findNanoappByInstanceId(mMessageBatchFirstSenderInstanceId);
+      if (nanoapp != nullptr) {
+        nanoapp->blameHostWakeup();
+      }
+    }
+  } else {
+    // The nanoapps were told that their messages were accepted, so they are
+    // completed as any message the platform failed to send
+    LOGE("Failed to send a batch of %zu messages to the host",
+         mMessageBatch.size());
+    for (MessageToHost *message : mMessageBatch) {
+      onMessageToHostCompleteInternal(message);
+    }
+  }
+
+  mMessageBatch.resize(0);
+  mMessageBatchSize = 0;
+  mMessageBatchFirstSenderInstanceId = kInvalidInstanceId;
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+}
+
 MessageToHost *HostCommsManager::findMessageToHostBySeq(
-    uint32_t messageSequenceNumber) {
-  return mMessagePool.find(
-      [](HostMessage *inputMessage, void *data) {
-        NestedDataPtr<uint32_t> targetMessageSequenceNumber(data);
-        return inputMessage->isReliable && !inputMessage->fromHost &&
-               inputMessage->messageSequenceNumber ==
-                   targetMessageSequenceNumber;
-      },
-      NestedDataPtr<uint32_t>(messageSequenceNumber));
+    [[maybe_unused]] uint32_t messageSequenceNumber) {
+#ifdef CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
+  if (mReliableMessageBeingAdded != nullptr &&
+      mReliableMessageBeingAdded->messageSequenceNumber ==
+          messageSequenceNumber) {
+    return mReliableMessageBeingAdded;
+  }
+  MessageToHost *const *message =
+      mReliableMessagesToHost.find(messageSequenceNumber);
+  return (message == nullptr) ? nullptr : *message;
+#else
+  return nullptr;
+#endif  // CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
 }
 
 void HostCommsManager::freeMessageToHost(MessageToHost *msgToHost) {
@@ -496,6 +658,14 @@ void HostCommsManager::onMessageToHostCompleteInternal(
   // the caller (HostLink) only gets a const pointer
   auto *msgToHost = const_cast<MessageToHost *>(message);
 
+#ifdef CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
+  // Reliable messages are only completed from the event loop thread, and must
+  // not be found by their sequence number anymore.
+  if (msgToHost->isReliable) {
+    mReliableMessagesToHost.erase(msgToHost->messageSequenceNumber, msgToHost);
+  }
+#endif  // CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
+
   // TODO(b/346345637): add an assertion that HostLink does not own the memory,
   // which is technically possible if a reliable message timed out before it
   // was released
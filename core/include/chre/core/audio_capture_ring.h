@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_CORE_AUDIO_CAPTURE_RING_H_
+#define CHRE_CORE_AUDIO_CAPTURE_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/util/system/ref_base.h"
+#include "chre_api/chre/audio.h"
+
+namespace chre {
+
+/**
+ * The audio captured from one audio source, shared by all the nanoapps that
+ * requested audio from it.
+ *
+ * The audio data events from the platform are appended to the ring, skipping
+ * the samples that are already in it: the events of a source usually overlap,
+ * as each one holds the most recent samples of the source at the time it was
+ * requested. Each nanoapp then gets a window of the most recent samples of
+ * the ring, as a chreAudioDataEvent pointing into the ring rather than a copy
+ * of the samples, so nanoapps asking for overlapping windows share the same
+ * samples.
+ *
+ * The ring holds the largest window. The samples are written twice, at their
+ * position in the ring and one ring capacity later, so that any window of up
+ * to the capacity is contiguous in memory. Appending an event that would
+ * overwrite the samples of a window still held by a nanoapp must wait for the
+ * window to be released (see canAppend()).
+ *
+ * Windows are reference counted: each event delivering a window to nanoapps
+ * holds a reference, and the window is destroyed when the last one is
+ * released.
+ * Windows in turn hold a reference to the storage of their samples, so that
+ * they stay valid when the ring allocates new storage.
+ *
+ * This class is not thread-safe: it must only be used from the event loop
+ * thread.
+ */
+class AudioCaptureRing {
+ public:
+  struct Storage;
+
+  /**
+   * A window of the most recent samples of the ring, delivered to nanoapps.
+   */
+  struct Window : public RefBase<Window> {
+    //! The event delivered to nanoapps, followed by the window it belongs to
+    //! so that fromEvent() finds it. Must stay standard-layout.
+    struct TaggedEvent {
+      struct chreAudioDataEvent event;
+      Window *window;
+    };
+
+    Window(Storage *storageIn, uint64_t startPositionIn);
+    ~Window() override;
+
+    struct chreAudioDataEvent *getEvent() {
+      return &taggedEvent.event;
+    }
+
+    const struct chreAudioDataEvent *getEvent() const {
+      return &taggedEvent.event;
+    }
+
+    //! The event delivered to nanoapps, which points to the samples in the
+    //! ring.
+    TaggedEvent taggedEvent;
+
+    //! The storage of the samples, referenced by the window.
+    Storage *storage;
+
+    //! The position of the first sample of the window in the ring, counted
+    //! from the first sample ever appended.
+    uint64_t startPosition;
+  };
+
+  AudioCaptureRing() = default;
+  AudioCaptureRing(AudioCaptureRing &&other);
+  AudioCaptureRing(const AudioCaptureRing &) = delete;
+  AudioCaptureRing &operator=(const AudioCaptureRing &) = delete;
+  ~AudioCaptureRing();
+
+  /**
+   * Makes sure that the ring can provide windows of up to a number of
+   * samples. If the ring is too small, new storage is allocated and the ring
+   * is emptied. The samples of the windows held by nanoapps stay valid until
+   * the windows are released.
+   *
+   * @param maxWindowSamples The largest window that will be requested.
+   * @param format The format of the samples, CHRE_AUDIO_DATA_FORMAT_*.
+   * @return false if the storage could not be allocated.
+   */
+  bool reserve(uint32_t maxWindowSamples, uint8_t format);
+
+  /**
+   * Empties the ring and releases its storage, which is freed once the
+   * windows using it are destroyed.
+   */
+  void clear();
+
+  /**
+   * @return Whether the event can be appended without overwriting the samples
+   *         of a window held by a nanoapp.
+   */
+  bool canAppend(const struct chreAudioDataEvent &event) const;
+
+  /**
+   * Appends the samples of an event that are not already in the ring. If the
+   * event does not start before the end of the ring (missed samples), the ring
+   * is emptied first. The event may be released once this returns.
+   *
+   * @param event An event of the format given to reserve().
+   */
+  void append(const struct chreAudioDataEvent &event);
+
+  /**
+   * Creates a window of the most recent samples of the ring.
+   *
+   * @param handle The handle of the audio source, set in the event.
+   * @param numSamples The number of samples of the window, at most the one
+   *        given to reserve(). The window has fewer samples if the ring does
+   *        not have that many.
+   * @return The window, with one reference held by the caller, or nullptr if
+   *         the ring is empty or out of memory.
+   */
+  Window *createWindow(uint32_t handle, uint32_t numSamples);
+
+  /**
+   * @return The window of an event created by createWindow().
+   */
+  static Window *fromEvent(struct chreAudioDataEvent *event) {
+    return reinterpret_cast<Window::TaggedEvent *>(event)->window;
+  }
+
+  /**
+   * @param position The position of the first sample, counted from the first
+   *        sample ever appended.
+   * @param numSamples The number of samples.
+   * @return The samples, contiguous in memory and valid until the next event
+   *         is appended, or nullptr if they are not all in the ring.
+   */
+  const uint8_t *getSamples(uint64_t position, uint32_t numSamples) const;
+
+  /**
+   * @param position The position of a sample in the ring.
+   * @return The timestamp of the sample.
+   */
+  uint64_t getTimestamp(uint64_t position) const;
+
+  //! @return The position of the sample following the last sample of the
+  //!         ring.
+  uint64_t getEndPosition() const {
+    return mEndPosition;
+  }
+
+  //! @return The format of the samples, CHRE_AUDIO_DATA_FORMAT_*.
+  uint8_t getFormat() const {
+    return mFormat;
+  }
+
+  //! @return The sample rate of the samples in the ring, in Hz.
+  uint32_t getSampleRate() const {
+    return mSampleRate;
+  }
+
+  //! @return The number of samples that the ring can hold.
+  uint32_t getCapacity() const;
+
+  //! @return The number of samples in the ring.
+  uint32_t getSize() const {
+    return mSize;
+  }
+
+  //! @return The number of windows held by nanoapps.
+  size_t getNumWindows() const;
+
+ private:
+  /**
+   * Counts the samples of an event that are not in the ring yet.
+   *
+   * @param event The event to append.
+   * @param gap Set to true if there are missing samples between the end of
+   *        the ring and the event.
+   * @return The number of samples at the end of the event to append.
+   */
+  uint32_t countNewSamples(const struct chreAudioDataEvent &event,
+                           bool *gap) const;
+
+  //! The storage of the samples, referenced by the ring, or nullptr if none
+  //! is allocated.
+  Storage *mStorage = nullptr;
+
+  //! The format of the samples.
+  uint8_t mFormat = 0;
+
+  //! The sample rate of the samples in the ring, in Hz.
+  uint32_t mSampleRate = 0;
+
+  //! The number of samples in the ring.
+  uint32_t mSize = 0;
+
+  //! The position of the sample following the last sample of the ring,
+  //! counted from the first sample ever appended.
+  uint64_t mEndPosition = 0;
+
+  //! The timestamp of the sample following the last sample of the ring.
+  uint64_t mEndTimestamp = 0;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_CORE_AUDIO_CAPTURE_RING_H_
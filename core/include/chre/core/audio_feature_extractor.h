@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_CORE_AUDIO_FEATURE_EXTRACTOR_H_
+#define CHRE_CORE_AUDIO_FEATURE_EXTRACTOR_H_
+
+#include <cstdint>
+
+#include "chre/util/non_copyable.h"
+
+struct kiss_fftr_state;
+
+/**
+ * The largest frame of audio samples that nanoapps can request features of.
+ * This default value can be overridden in the variant-specific makefile.
+ */
+#ifndef CHRE_AUDIO_FEATURE_MAX_FRAME_SIZE
+#define CHRE_AUDIO_FEATURE_MAX_FRAME_SIZE 1024
+#endif
+
+namespace chre {
+
+/**
+ * Computes the log-mel energies of frames of audio samples, as delivered to
+ * nanoapps in CHREEXT_EVENT_AUDIO_FEATURES.
+ *
+ * Each frame, less its mean, is weighted by a Hann window, transformed by the
+ * fixed-point real FFT of Kiss FFT, and its power spectrum summed into
+ * triangular mel bands, which exclude the DC bin.
+ * The energies are returned as their base 2 logarithm in Q8. Only the window
+ * and the filterbank are computed with floating point, by init().
+ */
+class AudioFeatureExtractor : public NonCopyable {
+ public:
+  ~AudioFeatureExtractor();
+
+  /**
+   * @param frameSize The number of samples of a frame, a power of 2.
+   * @param hopSize The number of samples between the starts of frames.
+   * @param numBins The number of mel bands.
+   * @return Whether the configuration is supported.
+   */
+  static bool isValidConfiguration(uint32_t frameSize, uint32_t hopSize,
+                                   uint16_t numBins);
+
+  /**
+   * Allocates the state needed to compute frames of a valid configuration.
+   *
+   * @param sampleRate The sample rate of the audio, in Hz.
+   * @param frameSize The number of samples of a frame.
+   * @param numBins The number of mel bands.
+   * @return false if out of memory.
+   */
+  bool init(uint32_t sampleRate, uint32_t frameSize, uint16_t numBins);
+
+  /**
+   * Computes the log-mel energies of one frame.
+   *
+   * @param samples frameSize samples.
+   * @param format The format of the samples, CHRE_AUDIO_DATA_FORMAT_*.
+   * @param logMelEnergies Filled with numBins energies, as the base 2
+   *        logarithm of the energy of each band in Q8.
+   */
+  void computeFrame(const uint8_t *samples, uint8_t format,
+                    int16_t *logMelEnergies);
+
+  uint32_t getFrameSize() const {
+    return mFrameSize;
+  }
+
+  uint16_t getNumBins() const {
+    return mNumBins;
+  }
+
+ private:
+  //! The FFT bins that a mel band sums, with their weights.
+  struct MelBand {
+    //! The first FFT bin of the band.
+    uint16_t firstBin;
+
+    //! The number of FFT bins of the band.
+    uint16_t numBins;
+
+    //! The offset of the weights of the band in mMelWeights.
+    uint32_t weightOffset;
+  };
+
+  void release();
+
+  uint32_t mFrameSize = 0;
+  uint16_t mNumBins = 0;
+
+  //! The Kiss FFT state, allocated by the extractor.
+  struct kiss_fftr_state *mFftConfig = nullptr;
+
+  //! The Hann window in Q15, mFrameSize values.
+  int16_t *mWindow = nullptr;
+
+  //! The windowed frame, mFrameSize values.
+  int16_t *mFrame = nullptr;
+
+  //! The spectrum, mFrameSize / 2 + 1 interleaved real and imaginary values.
+  int16_t *mSpectrum = nullptr;
+
+  //! The mel bands, mNumBins values.
+  MelBand *mMelBands = nullptr;
+
+  //! The weights of the FFT bins of all the mel bands in Q15.
+  uint16_t *mMelWeights = nullptr;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_CORE_AUDIO_FEATURE_EXTRACTOR_H_
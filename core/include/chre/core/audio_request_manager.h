@@ -19,12 +19,16 @@
 
 #include <cstdint>
 
+#include "chre/core/audio_capture_ring.h"
+#include "chre/core/audio_feature_extractor.h"
 #include "chre/core/nanoapp.h"
 #include "chre/core/settings.h"
 #include "chre/platform/platform_audio.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/non_copyable.h"
+#include "chre/util/unique_ptr.h"
 #include "chre_api/chre/audio.h"
+#include "chre_ext/audio_features.h"
 
 namespace chre {
 
@@ -73,6 +77,27 @@ class AudioRequestManager : public NonCopyable {
   bool configureSource(const Nanoapp *nanoapp, uint32_t handle, bool enable,
                        uint64_t bufferDuration, uint64_t deliveryInterval);
 
+  /**
+   * Updates the current request for audio features from a nanoapp for a given
+   * audio source. A nanoapp may request both audio data and audio features of
+   * the same source.
+   *
+   * @param nanoapp A non-null pointer to the nanoapp requesting this change.
+   * @param handle The audio source handle for which this request is directed
+   *        toward.
+   * @param enable true if enabling the features, false if disabling.
+   * @param deliveryInterval How frequently to deliver the features.
+   * @param frameSize The number of samples of each frame.
+   * @param hopSize The number of samples between the starts of frames.
+   * @param numBins The number of mel bands of each frame.
+   * @return true if the request was successful, false otherwise.
+   *
+   * @see chreextAudioConfigureFeatures()
+   */
+  bool configureFeatures(const Nanoapp *nanoapp, uint32_t handle, bool enable,
+                         uint64_t deliveryInterval, uint32_t frameSize,
+                         uint32_t hopSize, uint16_t numBins);
+
   /**
    * Disables all the active requests for a nanoapp.
    *
@@ -128,6 +153,21 @@ class AudioRequestManager : public NonCopyable {
   }
 
  private:
+  /**
+   * The audio features delivered for a request, all zero for a request of
+   * audio data.
+   */
+  struct AudioFeatureConfig {
+    uint32_t frameSize = 0;
+    uint32_t hopSize = 0;
+    uint16_t numBins = 0;
+
+    bool operator==(const AudioFeatureConfig &other) const {
+      return frameSize == other.frameSize && hopSize == other.hopSize &&
+             numBins == other.numBins;
+    }
+  };
+
   /**
    * One instance of an audio request from a nanoapp.
    */
@@ -149,6 +189,35 @@ class AudioRequestManager : public NonCopyable {
 
     //! The expected timestamp of the next event delivery.
     Nanoseconds nextEventTimestamp;
+
+    //! The audio features delivered for this request.
+    AudioFeatureConfig featureConfig;
+
+    //! Computes the features of this request, null for a request of audio
+    //! data.
+    UniquePtr<AudioFeatureExtractor> featureExtractor;
+
+    //! The position in the ring of the first sample of the next frame of
+    //! features to deliver.
+    uint64_t nextFramePosition = 0;
+
+    bool isFeatureRequest() const {
+      return !featureExtractor.isNull();
+    }
+  };
+
+  /**
+   * A CHREEXT_EVENT_AUDIO_FEATURES event, followed in memory by its log-mel
+   * energies.
+   */
+  struct AudioFeatureEvent {
+    //! The event delivered to nanoapps. Must be the first member, see
+    //! freeAudioFeatureEventCallback().
+    struct chreextAudioFeatureEvent event;
+
+    //! The number of multicast events delivering the event that were not
+    //! freed yet.
+    uint32_t refCount;
   };
 
   /**
@@ -163,46 +232,26 @@ class AudioRequestManager : public NonCopyable {
     //! The timestamp when the last audio data event was received.
     Nanoseconds lastEventTimestamp;
 
-    //! The request to post the next event to.
-    AudioRequest *nextAudioRequest = nullptr;
-
-    //! The list of requests for this source that are currently open.
-    DynamicVector<AudioRequest> requests;
-  };
-
-  /**
-   * Keep track of the number of times an audio data event is published to a
-   * nanoapp.
-   *
-   * TODO: Add support for multicast events to the core event loop to avoid this
-   * kind of logic from appearing in the AudioRequestManager.
-   */
-  struct AudioDataEventRefCount {
-    AudioDataEventRefCount(struct chreAudioDataEvent *eventIn,
-                           const uint32_t refCountIn = 0)
-        : event(eventIn), refCount(refCountIn) {}
+    //! Whether an audio data event was requested from the platform.
+    bool dataEventRequested = false;
 
-    /**
-     * @param audioDataEventRefCount The other object to perform an equality
-     *        comparison against.
-     * @return true if the supplied AudioDataEventRefCount is tracking the same
-     *         published event as current object.
-     */
-    bool operator==(const AudioDataEventRefCount &other) const {
-      return (event == other.event);
-    }
+    //! An audio data event from the platform that can't be appended to the
+    //! ring until nanoapps release the windows it would overwrite.
+    struct chreAudioDataEvent *pendingDataEvent = nullptr;
 
-    //! The event that is ref counted here.
-    struct chreAudioDataEvent *event;
+    //! The audio captured for all the requests of this source, which the
+    //! audio data events delivered to nanoapps are windows of. Only used when
+    //! the source is shared, see usesCaptureRing().
+    AudioCaptureRing ring;
 
-    //! The number of outstanding published events.
-    uint32_t refCount;
+    //! The list of requests for this source that are currently open.
+    DynamicVector<AudioRequest> requests;
   };
 
-  //! Maps published audio data events to a refcount that is used to determine
-  //! when to let the platform audio implementation know that this audio data
-  //! event no longer needed.
-  DynamicVector<AudioDataEventRefCount> mAudioDataEventRefCounts;
+  //! The fraction of its delivery interval by which a request may be served
+  //! early, so that requests due at about the same time share a platform
+  //! audio data event.
+  static constexpr uint64_t kDeliveryIntervalSlackDivisor = 16;
 
   //! Maps audio handles to requests from multiple nanoapps for an audio source.
   //! The array index implies the audio handle which is being managed.
@@ -237,10 +286,37 @@ class AudioRequestManager : public NonCopyable {
    * @param enable true if enabling the source, false if disabling.
    * @param numSamples The number of samples being requested.
    * @param deliveryInterval When to deliver the samples.
+   * @param featureConfig The features being requested, or nullptr to request
+   *        audio data.
    * @return true if successful, false otherwise.
    */
   bool doConfigureSource(uint16_t instanceId, uint32_t handle, bool enable,
-                         uint32_t numSamples, Nanoseconds deliveryInterval);
+                         uint32_t numSamples, Nanoseconds deliveryInterval,
+                         const AudioFeatureConfig *featureConfig = nullptr);
+
+  /**
+   * Whether the audio data events of a source go through its capture ring.
+   * They do when the source has several requests, which share the captured
+   * samples, a request for features, which are computed from the ring, or a
+   * request with too many nanoapps for a single multicast event. Otherwise
+   * the events from the platform are delivered as is, in one multicast event.
+   *
+   * @param requestList The requests of the source.
+   */
+  static bool usesCaptureRing(const AudioRequestList &requestList);
+
+  /**
+   * Makes sure that the capture ring of a source can serve the requests of
+   * the source once a request is configured, before the request is changed.
+   *
+   * @param handle The audio source that is being configured.
+   * @param instanceId The instanceId of the nanoapp making the request.
+   * @param numSamples The number of samples being requested.
+   * @param features true if audio features are being requested.
+   * @return false if the ring is needed and could not be allocated.
+   */
+  bool reserveCaptureRing(uint32_t handle, uint16_t instanceId,
+                          uint32_t numSamples, bool features);
 
   /**
    * Notify the platform if a given handle has been enabled or disabled.
@@ -259,10 +335,25 @@ class AudioRequestManager : public NonCopyable {
    * @param instanceId The instance ID that will own this request.
    * @param numSamples The number of samples requested.
    * @param deliveryInterval When to deliver the samples.
+   * @param featureConfig The features requested, or nullptr to request audio
+   *        data.
    * @return true if successful, false otherwise.
    */
   bool createAudioRequest(uint32_t handle, uint16_t instanceId,
-                          uint32_t numSamples, Nanoseconds deliveryInterval);
+                          uint32_t numSamples, Nanoseconds deliveryInterval,
+                          const AudioFeatureConfig *featureConfig);
+
+  /**
+   * Sets up a new request to compute and deliver audio features.
+   *
+   * @param handle The audio source of the request.
+   * @param featureConfig The features requested.
+   * @param request The new request.
+   * @return false if out of memory.
+   */
+  bool initAudioFeatureRequest(uint32_t handle,
+                               const AudioFeatureConfig &featureConfig,
+                               AudioRequest &request);
 
   /**
    * Finds an audio request for a given audio handle and nanoapp instance ID. If
@@ -272,6 +363,8 @@ class AudioRequestManager : public NonCopyable {
    *     caller to be less than the size of the mAudioRequestLists member.
    * @param instanceId The nanoapp instance ID that owns the existing request
    *     for this handle.
+   * @param features true to find the request for audio features of the
+   *     nanoapp, false for its request for audio data.
    * @param index Populated with the index of the request if it was found.
    * @param instanceIdIndex Populated with the index of the instance ID within
    *        the returned audio request if it was found.
@@ -279,7 +372,8 @@ class AudioRequestManager : public NonCopyable {
    *     found.
    */
   AudioRequest *findAudioRequestByInstanceId(uint32_t handle,
-                                             uint16_t instanceId, size_t *index,
+                                             uint16_t instanceId, bool features,
+                                             size_t *index,
                                              size_t *instanceIdIndex);
 
   /**
@@ -290,14 +384,15 @@ class AudioRequestManager : public NonCopyable {
    *        caller to be less than the size of the mAudioRequestLists member.
    * @param numSamples The number of samples to match for.
    * @param deliveryInterval The delivery interval to match for.
+   * @param featureConfig The features to match for, or nullptr to match a
+   *        request for audio data.
    * @param index Populated with the index of the request if it was found.
    * @return The AudioRequest for this handle and configuration, nullptr if not
    *     found.
    */
-  AudioRequest *findAudioRequestByConfiguration(uint32_t handle,
-                                                uint32_t numSamples,
-                                                Nanoseconds deliveryInterval,
-                                                size_t *index);
+  AudioRequest *findAudioRequestByConfiguration(
+      uint32_t handle, uint32_t numSamples, Nanoseconds deliveryInterval,
+      const AudioFeatureConfig *featureConfig, size_t *index);
 
   /**
    * Finds the next expiring request for audio data for a given handle.
@@ -316,6 +411,26 @@ class AudioRequestManager : public NonCopyable {
    */
   void handleAudioDataEventSync(struct chreAudioDataEvent *event);
 
+  /**
+   * Appends an audio data event from the platform to the ring of its source,
+   * releases it, and delivers a window of the ring to every request that is
+   * due. If the source does not use its ring, delivers the event as is to its
+   * request instead.
+   *
+   * @param handle The audio source of the event.
+   * @param event The audio data event from the platform.
+   */
+  void processAudioDataEvent(uint32_t handle,
+                             struct chreAudioDataEvent *event);
+
+  /**
+   * Releases the audio data event from the platform held until it can be
+   * appended to the ring, if any.
+   *
+   * @param handle The audio source of the event.
+   */
+  void releasePendingAudioDataEvent(uint32_t handle);
+
   /**
    * Handles audio availability from the platform synchronously. This is
    * invoked on the CHRE thread through a deferred callback. Refer to
@@ -325,7 +440,8 @@ class AudioRequestManager : public NonCopyable {
 
   /**
    * Iterates the list of outstanding requests for the provided handle and
-   * schedules the next request to the platform.
+   * schedules the next request to the platform. A single platform event of
+   * the largest number of samples requested serves all the requests.
    *
    * @param handle the audio source for which to schedule a request.
    */
@@ -341,32 +457,80 @@ class AudioRequestManager : public NonCopyable {
   void postAudioSamplingChangeEvents(uint32_t handle, bool suspended);
 
   /**
-   * Posts a CHRE_EVENT_AUDIO_SAMPLING_CHANGE event to the specified nanoapp.
+   * Posts a CHRE_EVENT_AUDIO_SAMPLING_CHANGE event to the specified nanoapps,
+   * as a single multicast event.
    *
-   * @param instanceId The instance ID of the nanoapp to post to.
+   * @param instanceIds The instance IDs of the nanoapps to post to.
+   * @param numInstanceIds The number of nanoapps, at most
+   *        kMaxMulticastTargets.
    * @param handle The handle for the audio source that is changing.
    * @param available true if audio is available for the supplied handle, false
    *        otherwise.
    * @param suspended Boolean value that indicates if the source is suspended
    */
-  void postAudioSamplingChangeEvent(uint16_t instanceId, uint32_t handle,
+  void postAudioSamplingChangeEvent(const uint16_t *instanceIds,
+                                    size_t numInstanceIds, uint32_t handle,
                                     bool available, bool suspended);
 
   /**
-   * Posts the provided audio data event to a nanoapp with the given instance ID
-   * and fails fatally if the event is not posted. Fatal error is an acceptable
-   * error handling mechanism here because there is no way to satisfy the
-   * requirements of the API without posting an event.
+   * Posts an event to all the nanoapps of a request, as one multicast event
+   * per kMaxMulticastTargets nanoapps, and fails fatally if an event is not
+   * posted. The free callback is invoked once per multicast event.
    *
-   * @param audioDataEvent The audio data event to send to a nanoapp.
-   * @param instanceIds The list of nanoapp instance IDs to direct the event to.
+   * @param eventType The type of the event.
+   * @param eventData The event, which must stay valid until the free callback
+   *        of every multicast event is invoked.
+   * @param freeCallback Invoked once each multicast event is processed.
+   * @param request The request to post to.
    */
-  void postAudioDataEventFatal(struct chreAudioDataEvent *event,
-                               const DynamicVector<uint16_t> &instanceIds);
+  static void postEventToRequestOrDie(uint16_t eventType, void *eventData,
+                                      chreEventCompleteFunction *freeCallback,
+                                      const AudioRequest &request);
+
+  //! @return The number of multicast events posted to a request by
+  //! postEventToRequestOrDie().
+  static size_t getNumMulticastEvents(const AudioRequest &request) {
+    return (request.instanceIds.size() + kMaxMulticastTargets - 1) /
+           kMaxMulticastTargets;
+  }
 
   /**
-   * Invoked by the freeAudioDataEventCallback to decrement the reference count
-   * of the most recently published event and free it if unreferenced.
+   * Posts an audio data event from the platform to the nanoapps of a request
+   * in a single multicast event and fails fatally if the event is not posted.
+   * The event is released by the free callback of the multicast event.
+   *
+   * @param event The audio data event from the platform.
+   * @param request The request to post the event to.
+   */
+  void postPlatformAudioDataEventFatal(struct chreAudioDataEvent *event,
+                                       const AudioRequest &request);
+
+  /**
+   * Posts a window of the most recent samples of a source to the nanoapps of
+   * a request and fails fatally if the event is not posted. Fatal error is an
+   * acceptable error handling mechanism here because there is no way to
+   * satisfy the requirements of the API without posting an event. If the
+   * window can't be allocated, this delivery is skipped.
+   *
+   * @param handle The audio source of the request.
+   * @param request The request to post a window of its number of samples to.
+   */
+  void postAudioDataEventFatal(uint32_t handle, const AudioRequest &request);
+
+  /**
+   * Posts the features of the frames of the ring that were not delivered yet
+   * to the nanoapps of a request, computed once for all of them, and fails
+   * fatally if the event is not posted. If the event can't be allocated, this
+   * delivery is skipped and its frames are left for the next one.
+   *
+   * @param handle The audio source of the request.
+   * @param request The request for audio features to post to.
+   */
+  void postAudioFeatureEventFatal(uint32_t handle, AudioRequest &request);
+
+  /**
+   * Invoked by the freeAudioDataEventCallback to release the reference of a
+   * multicast event to a published window.
    *
    * @param audioDataEvent the audio data event to process.
    */
@@ -379,6 +543,25 @@ class AudioRequestManager : public NonCopyable {
    * @param eventData a pointer to the scan event to release.
    */
   static void freeAudioDataEventCallback(uint16_t eventType, void *eventData);
+
+  /**
+   * Releases an audio data event from the platform, delivered as is to
+   * nanoapps, after they have consumed it.
+   *
+   * @param eventType the type of event being freed.
+   * @param eventData a pointer to the audio data event to release.
+   */
+  static void freePlatformAudioDataEventCallback(uint16_t eventType,
+                                                 void *eventData);
+
+  /**
+   * Releases an audio feature event once all its nanoapps consumed it.
+   *
+   * @param eventType the type of event being freed.
+   * @param eventData a pointer to the AudioFeatureEvent to release.
+   */
+  static void freeAudioFeatureEventCallback(uint16_t eventType,
+                                            void *eventData);
 };
 
 }  // namespace chre
@@ -125,6 +125,23 @@ class BleRequest : public NonCopyable {
    */
   bool isEnabled() const;
 
+  /**
+   * @return true if this request has no RSSI threshold and no filter, in which
+   *     case every advertising report matches it.
+   */
+  bool matchesAllReports() const;
+
+  /**
+   * Matches an advertising report against the filters of this request, as
+   * defined in chreBleScanFilterV1_9: the RSSI of the report must be at least
+   * the RSSI threshold, and the report must match any of the generic or
+   * broadcaster address filters, if there are any.
+   *
+   * @param report The advertising report.
+   * @return true if the report matches this request.
+   */
+  bool matchesReport(const chreBleAdvertisingReport &report) const;
+
   /**
    * Prints state in a string buffer. Must only be called from the context of
    * the main CHRE thread.
@@ -152,7 +152,18 @@ class BleRequestManager : public NonCopyable {
   static void freeAdvertisingEventCallback(uint16_t eventType, void *eventData);
 
   /**
-   * Handles a CHRE BLE advertisement event.
+   * Releases an advertising event delivered to a single nanoapp, and the
+   * platform event it was built from once all the nanoapps it was delivered to
+   * have processed it.
+   *
+   * @param eventType the type of event being freed.
+   * @param eventData a pointer to the NanoappAdvertisementEvent to release.
+   */
+  static void freeNanoappAdvertisingEventCallback(uint16_t eventType,
+                                                  void *eventData);
+
+  /**
+   * Handles a CHRE BLE advertisement event. May be called from any thread.
    *
    * @param event The BLE advertisement event containing BLE advertising
    *              reports. This memory is guaranteed not to be modified until it
@@ -246,6 +257,29 @@ class BleRequestManager : public NonCopyable {
     bool isActive = false;
   };
 
+  //! The platform advertisement event shared by the advertisement events
+  //! delivered to each nanoapp.
+  struct SharedAdvertisementEvent {
+    //! The event received from the platform, which owns the advertising data.
+    chreBleAdvertisementEvent *platformEvent;
+    //! The allocation holding this struct, the NanoappAdvertisementEvents and
+    //! the copies of the reports.
+    void *storage;
+    //! The number of NanoappAdvertisementEvents that have not been freed yet.
+    size_t numPendingEvents;
+  };
+
+  //! An advertisement event delivered to a single nanoapp, holding the reports
+  //! matching the filters of the nanoapp. Its reports either are those of the
+  //! platform event, or copies referencing the advertising data of the
+  //! platform event.
+  struct NanoappAdvertisementEvent {
+    //! The event delivered to the nanoapp. Must be the first member, as the
+    //! free callback receives a pointer to it.
+    chreBleAdvertisementEvent event;
+    SharedAdvertisementEvent *shared;
+  };
+
   // Multiplexer used to keep track of BLE requests from nanoapps.
   BleRequestMultiplexer mRequests;
 
@@ -403,6 +437,24 @@ class BleRequestManager : public NonCopyable {
    */
   void handlePlatformChangeSync(bool enable, uint8_t errorCode);
 
+  /**
+   * Delivers the reports of an advertisement event to the nanoapps whose scan
+   * filters they match. Each nanoapp receives an event holding only the
+   * reports matching its own filters, rather than the reports matching the
+   * filters of any nanoapp, which is what the platform filters for. Must be
+   * called from the context of the main CHRE thread.
+   *
+   * @see handleAdvertisementEvent
+   */
+  void handleAdvertisementEventSync(struct chreBleAdvertisementEvent *event);
+
+  /**
+   * @param request A request from a nanoapp.
+   * @return true if advertisement events must be delivered to the nanoapp that
+   *     made the request.
+   */
+  bool isAdvertisementRecipient(const BleRequest &request) const;
+
   /**
    * Dispatches pending BLE requests from nanoapps.
    */
@@ -26,6 +26,16 @@
 #include "chre/util/optional.h"
 #include "chre/util/system/debug_dump.h"
 
+/**
+ * The number of buffers that the debug dumps are streamed through, bounding
+ * the memory used by a debug dump session to as many times
+ * kDebugDumpStrMaxSize.
+ * This default value can be overridden in the variant-specific makefile.
+ */
+#ifndef CHRE_DEBUG_DUMP_NUM_BUFFERS
+#define CHRE_DEBUG_DUMP_NUM_BUFFERS 2
+#endif
+
 namespace chre {
 
 /**
@@ -46,8 +56,11 @@ class DebugDumpManager : public PlatformDebugDumpManager {
                         va_list args);
 
  private:
-  //! Utility to hold the framework and nanoapp debug dumps.
-  DebugDumpWrapper mDebugDump{kDebugDumpStrMaxSize};
+  //! Utility to hold the framework and nanoapp debug dumps. Each buffer is
+  //! sent to the host as soon as it fills up.
+  DebugDumpWrapper mDebugDump{kDebugDumpStrMaxSize,
+                              CHRE_DEBUG_DUMP_NUM_BUFFERS,
+                              sendDebugDumpBuffer, this};
 
   //! Whether the DebugDumpManager is collecting nanoapp debug dumps.
   bool mCollectingNanoappDebugDumps = false;
@@ -56,6 +69,19 @@ class DebugDumpManager : public PlatformDebugDumpManager {
   //! session.
   Optional<uint32_t> mLastNanoappId;
 
+  /**
+   * Sends a buffer of mDebugDump that filled up to the host.
+   *
+   * @see DebugDumpWrapper::FlushCallback
+   */
+  static bool sendDebugDumpBuffer(const char *buffer, void *cookie);
+
+  /**
+   * Sends the content of mDebugDump that is yet to be sent and releases its
+   * buffers.
+   */
+  void flushDebugDump();
+
   /**
    * Collect CHRE framework debug dumps.
    */
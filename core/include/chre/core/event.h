@@ -22,8 +22,17 @@
 #include "chre/util/non_copyable.h"
 #include "chre_api/chre/event.h"
 
+#include <cstddef>
 #include <cstdint>
 
+/**
+ * The largest number of nanoapps a multicast event can be delivered to.
+ * This default value can be overridden in the variant-specific makefile.
+ */
+#ifndef CHRE_EVENT_MAX_MULTICAST_TARGETS
+#define CHRE_EVENT_MAX_MULTICAST_TARGETS 4
+#endif
+
 namespace chre {
 
 //! Instance ID used for events sent by the system
@@ -41,6 +50,11 @@ constexpr uint16_t kInvalidInstanceId = kBroadcastInstanceId;
 //! registered for it.
 constexpr uint16_t kDefaultTargetGroupMask = UINT16_MAX;
 
+//! The largest number of nanoapps a multicast event can be delivered to.
+constexpr size_t kMaxMulticastTargets = CHRE_EVENT_MAX_MULTICAST_TARGETS;
+static_assert(kMaxMulticastTargets >= 2 && kMaxMulticastTargets <= UINT8_MAX,
+              "Multicast events must target 2 to 255 nanoapps");
+
 class Event : public NonCopyable {
  public:
   Event() = delete;
@@ -64,6 +78,30 @@ class Event : public NonCopyable {
     CHRE_ASSERT(targetAppGroupMask_ > 0);
   }
 
+  // Events sent by the system to a set of nanoapps, delivered to each of them
+  // before the free callback is invoked once
+  Event(uint16_t eventType_, void *eventData_,
+        chreEventCompleteFunction *freeCallback_,
+        const uint16_t *targetInstanceIds_, size_t numTargets_)
+      : eventType(eventType_),
+        receivedTimeMillis(getTimeMillis()),
+        eventData(eventData_),
+        freeCallback(freeCallback_),
+        senderInstanceId(kSystemInstanceId),
+        targetInstanceId(targetInstanceIds_[0]),
+        targetAppGroupMask(kDefaultTargetGroupMask),
+        isLowPriority(false),
+        numExtraTargets(static_cast<uint8_t>(numTargets_ - 1)) {
+    CHRE_ASSERT(numTargets_ > 0 && numTargets_ <= kMaxMulticastTargets);
+    for (size_t i = 0; i < numTargets_; i++) {
+      CHRE_ASSERT(targetInstanceIds_[i] != kSystemInstanceId &&
+                  targetInstanceIds_[i] != kBroadcastInstanceId);
+      if (i > 0) {
+        extraTargetInstanceIds[i - 1] = targetInstanceIds_[i];
+      }
+    }
+  }
+
   // Alternative constructor used for system-internal events (e.g. deferred
   // callbacks)
   Event(uint16_t eventType_, void *eventData_,
@@ -94,6 +132,21 @@ class Event : public NonCopyable {
     return (mRefCount == 0);
   }
 
+  //! @return true if the event is targeted at the given nanoapp, as its single
+  //! target or one of its multicast targets. Broadcast events are not
+  //! targeted at any nanoapp in particular.
+  bool isTargetedAt(uint16_t instanceId) const {
+    if (targetInstanceId == instanceId) {
+      return true;
+    }
+    for (uint8_t i = 0; i < numExtraTargets; i++) {
+      if (extraTargetInstanceIds[i] == instanceId) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   //! @return true if this event has an associated callback which needs to be
   //! called prior to deallocating the event
   bool hasFreeCallback() {
@@ -150,6 +203,14 @@ class Event : public NonCopyable {
 
   const bool isLowPriority;
 
+  //! The number of targets of a multicast event besides targetInstanceId, 0
+  //! for other events.
+  const uint8_t numExtraTargets = 0;
+
+  //! The targets of a multicast event besides targetInstanceId, inline so
+  //! that the event takes a single slot of the event pool.
+  uint16_t extraTargetInstanceIds[kMaxMulticastTargets - 1];
+
  private:
   uint8_t mRefCount = 0;
 };
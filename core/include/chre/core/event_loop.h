@@ -219,6 +219,31 @@ class EventLoop : public NonCopyable {
                       uint16_t targetInstanceId = kBroadcastInstanceId,
                       uint16_t targetGroupMask = kDefaultTargetGroupMask);
 
+  /**
+   * Posts a single event to a set of nanoapps that are currently running,
+   * rather than one event per nanoapp. The free callback is invoked once, after
+   * all the nanoapps processed the event. Like postEventOrDie(), failing to
+   * post the event while the event loop thread is running is a fatal error.
+   *
+   * Safe to call from any thread.
+   *
+   * @param eventType Event type identifier, which implies the type of eventData
+   * @param eventData The data being posted
+   * @param freeCallback Function to invoke to when the event has been processed
+   *        by all recipients; this must be safe to call immediately, to handle
+   *        the case where CHRE is shutting down
+   * @param targetInstanceIds The instance IDs of the destinations of this
+   *        event
+   * @param numTargets The number of destinations, in the range [1,
+   *        kMaxMulticastTargets]
+   *
+   * @see postEventOrDie
+   */
+  void postMulticastEventOrDie(uint16_t eventType, void *eventData,
+                               chreEventCompleteFunction *freeCallback,
+                               const uint16_t *targetInstanceIds,
+                               size_t numTargets);
+
   /**
    * Posts an event to a nanoapp that is currently running (or all nanoapps if
    * the target instance ID is kBroadcastInstanceId). If the event fails to
@@ -362,6 +387,27 @@ class EventLoop : public NonCopyable {
     return mNumDroppedLowPriEvents;
   }
 
+  //! @return The number of events waiting to be distributed. Safe to call
+  //!     from any thread.
+  size_t getNumPendingEvents() {
+    return mEvents.size();
+  }
+
+  //! @return The number of events of the event pool.
+  static constexpr size_t getEventPoolSize() {
+    return kMaxEventCount;
+  }
+
+  //! @return The last time the nanoapp wakeup buckets were cycled.
+  Nanoseconds getTimeLastWakeupBucketCycled() const {
+    return mTimeLastWakeupBucketCycled;
+  }
+
+  //! @return The time interval of nanoapp wakeup buckets.
+  static constexpr Nanoseconds getWakeupBucketInterval() {
+    return kIntervalWakeupBucket;
+  }
+
  private:
 #ifdef CHRE_STATIC_EVENT_LOOP
   //! The maximum number of events that can be active in the system.
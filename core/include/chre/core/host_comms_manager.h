@@ -26,12 +26,53 @@
 #include "chre/platform/host_link.h"
 #include "chre/util/buffer.h"
 #include "chre/util/duplicate_message_detector.h"
+#include "chre/util/fixed_size_vector.h"
 #include "chre/util/non_copyable.h"
+#include "chre/util/sequence_number_index.h"
 #include "chre/util/synchronized_memory_pool.h"
 #include "chre/util/time.h"
 #include "chre/util/transaction_manager.h"
 #include "chre_api/chre/event.h"
 
+// The maximum number of messages to or from the host that can be outstanding
+// at any given time. This default value can be overridden in the
+// variant-specific makefile.
+#ifndef CHRE_MAX_OUTSTANDING_HOST_MESSAGES
+#define CHRE_MAX_OUTSTANDING_HOST_MESSAGES 32
+#endif
+
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
+// The maximum number of messages from nanoapps to the host sent together in a
+// single batch. This default value can be overridden in the variant-specific
+// makefile.
+#ifndef CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES
+#define CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES 8
+#endif
+
+// The maximum total size of the data of the messages in a batch, in bytes.
+// Larger messages are sent on their own. This default value can be overridden
+// in the variant-specific makefile.
+#ifndef CHRE_HOST_MESSAGE_BATCH_MAX_SIZE
+#define CHRE_HOST_MESSAGE_BATCH_MAX_SIZE 1024
+#endif
+
+// How long a message may wait in a batch for more messages while the host is
+// awake, in milliseconds. This default value can be overridden in the
+// variant-specific makefile.
+#ifndef CHRE_HOST_MESSAGE_BATCH_LATENCY_MS
+#define CHRE_HOST_MESSAGE_BATCH_LATENCY_MS 5
+#endif
+
+// How long a message may wait in a batch while the host is asleep, in
+// milliseconds, unless the host wakes up before. This default value can be
+// overridden in the variant-specific makefile.
+#ifndef CHRE_HOST_MESSAGE_BATCH_ASLEEP_LATENCY_MS
+#define CHRE_HOST_MESSAGE_BATCH_ASLEEP_LATENCY_MS 1000
+#endif
+
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
 namespace chre {
 
 //! Only valid for messages from host to CHRE - indicates that the sender of the
@@ -42,6 +83,15 @@ constexpr uint16_t kHostEndpointUnspecified = CHRE_HOST_ENDPOINT_UNSPECIFIED;
 //! registered clients of the Context Hub HAL, which is the default behavior.
 constexpr uint16_t kHostEndpointBroadcast = CHRE_HOST_ENDPOINT_BROADCAST;
 
+/**
+ * Releases the data of a message from the host that was retained by reference
+ * rather than copied, once the message is no longer needed.
+ *
+ * @param releaseData The platform-supplied pointer given along with the
+ *        message.
+ */
+typedef void(HostMessageReleaseFunction)(void *releaseData);
+
 /**
  * Data associated with a message either to or from the host.
  */
@@ -101,6 +151,12 @@ struct HostMessage : public NonCopyable {
 
   //! Application-defined message data.
   Buffer<uint8_t> message;
+
+  //! Only valid for messages from the host. If not null, message wraps data
+  //! owned by the platform, which is released by calling this function with
+  //! releaseData once the message is freed.
+  HostMessageReleaseFunction *releaseFunction = nullptr;
+  void *releaseData = nullptr;
 };
 
 typedef HostMessage MessageFromHost;
@@ -161,6 +217,15 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
    */
   void resetBlameForNanoappHostWakeup();
 
+  /**
+   * Invoked by the platform when the host wakes up. If messages to the host
+   * are batched, sends the pending batch rather than waiting for more
+   * messages, as the host is awake anyway.
+   *
+   * This function is safe to call from any thread.
+   */
+  void onHostAwake();
+
   /**
    * Formulates a MessageToHost using the supplied message contents and
    * passes it to HostLink for transmission to the host.
@@ -222,6 +287,32 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
                                     bool isReliable,
                                     uint32_t messageSequenceNumber);
 
+  /**
+   * Posts a message to the queue for later delivery to the addressed nanoapp,
+   * like sendMessageToNanoappFromHost() above, but without copying the message
+   * data. This avoids an allocation and a copy for large messages, when the
+   * platform can hand over the buffer it received the message in.
+   *
+   * The message data must stay valid until releaseFunction is called with
+   * releaseData. This happens once the nanoapp has handled the message, from
+   * the event loop thread, or if the message can't be delivered, possibly from
+   * the calling thread before this function returns.
+   *
+   * This function is safe to call from any thread.
+   *
+   * @param releaseFunction Non-null function releasing the message data
+   * @param releaseData Pointer passed to releaseFunction
+   *
+   * @see sendMessageToNanoappFromHost for the other parameters.
+   */
+  void sendMessageToNanoappFromHost(uint64_t appId, uint32_t messageType,
+                                    uint16_t hostEndpoint,
+                                    const void *messageData, size_t messageSize,
+                                    bool isReliable,
+                                    uint32_t messageSequenceNumber,
+                                    HostMessageReleaseFunction *releaseFunction,
+                                    void *releaseData);
+
  private:
   //! How many times we'll try sending a reliable message before giving up.
   static constexpr uint16_t kReliableMessageMaxAttempts = 4;
@@ -241,7 +332,8 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
       kReliableMessageTimeout * 3;
 
   //! The maximum number of messages we can have outstanding at any given time.
-  static constexpr size_t kMaxOutstandingMessages = 32;
+  static constexpr size_t kMaxOutstandingMessages =
+      CHRE_MAX_OUTSTANDING_HOST_MESSAGES;
 
   //! Ensures that we do not blame more than once per host wakeup. This is
   //! checked before calling host blame to make sure it is set once. The power
@@ -260,8 +352,44 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
 
   //! The transaction manager for reliable messages.
   TransactionManager<kMaxOutstandingMessages, TimerPool> mTransactionManager;
+
+  //! Index from the message sequence number of each reliable message to the
+  //! host to the message, so that findMessageToHostBySeq() does not scan
+  //! mMessagePool. Only accessed from the event loop thread.
+  SequenceNumberIndex<kMaxOutstandingMessages, MessageToHost *>
+      mReliableMessagesToHost;
+
+  //! The reliable message being added to mTransactionManager, which may be
+  //! sent before it is added to mReliableMessagesToHost.
+  MessageToHost *mReliableMessageBeingAdded = nullptr;
 #endif  // CHRE_RELIABLE_MESSAGE_SUPPORT_ENABLED
 
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+  //! The maximum number of messages in a batch.
+  static constexpr size_t kMaxMessageBatchCount =
+      CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES;
+
+  //! The maximum total size of the data of the messages in a batch.
+  static constexpr size_t kMaxMessageBatchSize =
+      CHRE_HOST_MESSAGE_BATCH_MAX_SIZE;
+
+  //! The non-reliable messages to the host waiting to be sent as a batch, in
+  //! the order they were sent by nanoapps. Only accessed from the event loop
+  //! thread.
+  FixedSizeVector<MessageToHost *, kMaxMessageBatchCount> mMessageBatch;
+
+  //! The total size of the data of the messages in mMessageBatch.
+  size_t mMessageBatchSize = 0;
+
+  //! The instance ID of the sender of the first message in mMessageBatch,
+  //! which is blamed if sending the batch wakes up the host.
+  uint16_t mMessageBatchFirstSenderInstanceId = kInvalidInstanceId;
+
+  //! The timer sending mMessageBatch once its latency budget has elapsed, or
+  //! CHRE_TIMER_INVALID if the batch is empty.
+  TimerHandle mMessageBatchTimerHandle = CHRE_TIMER_INVALID;
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
   /**
    * Allocates and populates the event structure used to notify a nanoapp of an
    * incoming message from the host.
@@ -269,14 +397,17 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
    * Used to implement sendMessageToNanoappFromHost() - see that
    * function for parameter documentation.
    *
-   * All parameters must be sanitized before invoking this function.
+   * All parameters must be sanitized before invoking this function. If
+   * releaseFunction is not null, the message data is retained by reference
+   * instead of being copied, and released when the message is freed.
    *
    * @see sendMessageToNanoappFromHost
    */
   MessageFromHost *craftNanoappMessageFromHost(
       uint64_t appId, uint16_t hostEndpoint, uint32_t messageType,
       const void *messageData, uint32_t messageSize, bool isReliable,
-      uint32_t messageSequenceNumber);
+      uint32_t messageSequenceNumber,
+      HostMessageReleaseFunction *releaseFunction, void *releaseData);
 
   /**
    * Checks if the message could be sent to the nanoapp from the host. Crafts
@@ -288,11 +419,11 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
    *         allocated and must be freed by the caller.
    */
   std::pair<chreError, MessageFromHost *>
-  validateAndCraftMessageFromHostToNanoapp(uint64_t appId, uint32_t messageType,
-                                           uint16_t hostEndpoint,
-                                           const void *messageData,
-                                           size_t messageSize, bool isReliable,
-                                           uint32_t messageSequenceNumber);
+  validateAndCraftMessageFromHostToNanoapp(
+      uint64_t appId, uint32_t messageType, uint16_t hostEndpoint,
+      const void *messageData, size_t messageSize, bool isReliable,
+      uint32_t messageSequenceNumber,
+      HostMessageReleaseFunction *releaseFunction, void *releaseData);
 
   /**
    * Posts a crafted event, craftedMessage, to a nanoapp for processing, and
@@ -306,6 +437,14 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
    */
   void deliverNanoappMessageFromHost(MessageFromHost *craftedMessage);
 
+  /**
+   * Releases the data of a message from the host if it was retained by
+   * reference, and deallocates the message.
+   *
+   * @param msgFromHost The message to free.
+   */
+  void freeMessageFromHost(MessageFromHost *msgFromHost);
+
   /**
    * Sends a message to the host from a nanoapp. This method also
    * appropriately blames the nanoapp for sending a message or
@@ -320,6 +459,28 @@ class HostCommsManager : public HostLink, private TransactionManagerCallback {
   bool doSendMessageToHostFromNanoapp(Nanoapp *nanoapp,
                                       MessageToHost *msgToHost);
 
+  /**
+   * Adds a non-reliable message to the host to the pending batch, or sends it
+   * on its own if it is too large to be batched. The batch is sent once it is
+   * full, or once the first message in it has waited for its latency budget.
+   * Blames the nanoapp for sending the message.
+   *
+   * @param nanoapp The sender of this message.
+   * @param msgToHost The message to send.
+   *
+   * @return Whether the message was successfully batched or sent.
+   */
+  bool batchMessageToHostFromNanoapp(Nanoapp *nanoapp,
+                                     MessageToHost *msgToHost);
+
+  /**
+   * Sends the pending batch of messages to the host, if any, and blames the
+   * sender of the first message if this wakes up the host. If the platform
+   * fails to send the batch, the messages are completed (and freed) as if
+   * they had been sent.
+   */
+  void flushMessageBatch();
+
   /**
    * Find the message to the host associated with the message sequence number,
    * if it exists. Returns nullptr otherwise.
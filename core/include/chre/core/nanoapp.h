@@ -94,6 +94,34 @@ class Nanoapp : public PlatformNanoapp {
     return mPeakAllocatedBytes;
   }
 
+  /**
+   * @return The longest time spent handling an event, in milliseconds.
+   */
+  uint64_t getMaxEventProcessTime() const {
+    return mEventProcessTime.getMax();
+  }
+
+  /**
+   * @return The total time spent handling events since boot, in milliseconds.
+   */
+  uint64_t getEventProcessTimeSinceBoot() const {
+    return mEventProcessTimeSinceBoot;
+  }
+
+  /**
+   * @return The number of host wakeups the nanoapp triggered since boot.
+   */
+  uint32_t getNumWakeupsSinceBoot() const {
+    return mNumWakeupsSinceBoot;
+  }
+
+  /**
+   * @return The number of messages the nanoapp sent to the host since boot.
+   */
+  uint32_t getNumMessagesSentSinceBoot() const {
+    return mNumMessagesSentSinceBoot;
+  }
+
   /**
    * Sets the total number of bytes the nanoapp has allocated. Also, modifies
    * the peak allocated bytes if the current total is higher than the peak.
@@ -112,6 +140,17 @@ class Nanoapp : public PlatformNanoapp {
    */
   bool isRegisteredForBroadcastEvent(const Event *event) const;
 
+  /**
+   * @param eventType The type of the broadcast event.
+   * @param targetGroupIdMask The group IDs the event would target.
+   * @return true if the nanoapp should receive a broadcast event of this type
+   *     targeting these group IDs. Not valid for
+   *     CHRE_EVENT_HOST_ENDPOINT_NOTIFICATION, which depends on the event data.
+   */
+  bool isRegisteredForBroadcastEvent(
+      uint16_t eventType,
+      uint16_t targetGroupIdMask = kDefaultTargetGroupMask) const;
+
   /**
    * Updates the Nanoapp's registration so that it will receive broadcast events
    * with the given event type.
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_CORE_POWER_POLICY_H_
+#define CHRE_CORE_POWER_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/util/non_copyable.h"
+#include "chre/util/time.h"
+
+/**
+ * The shortest expected idle time of the event loop for which the power
+ * policy lets the platform enter its low-power state.
+ * This default value can be overridden in the variant-specific makefile.
+ */
+#ifndef CHRE_POWER_POLICY_MIN_LOW_POWER_TIME_MS
+#define CHRE_POWER_POLICY_MIN_LOW_POWER_TIME_MS 5
+#endif
+
+namespace chre {
+
+/**
+ * Decides when the platform enters and leaves its low-power state (e.g. island
+ * mode, DRAM access removed) around the processing of events, for
+ * PowerControlManager implementations to apply.
+ *
+ * Entering the low-power state as soon as the event queue is empty makes the
+ * platform switch states for every event of a burst. Instead, the policy stays
+ * in the active state while events are pending, and when the queue empties,
+ * until the next event predicted from the timers and the enabled sensors is
+ * due in less than the minimum low-power time.
+ */
+class PowerPolicy : public NonCopyable {
+ public:
+  enum class State : uint8_t {
+    Active,
+    LowPower,
+  };
+
+  /**
+   * @param minLowPowerTime The shortest expected idle time for which the
+   *        low-power state is entered. Zero enters it whenever the event queue
+   *        is empty.
+   */
+  explicit PowerPolicy(
+      Nanoseconds minLowPowerTime =
+          Milliseconds(CHRE_POWER_POLICY_MIN_LOW_POWER_TIME_MS))
+      : mMinLowPowerTime(minLowPowerTime) {}
+
+  /**
+   * To be called before the event loop processes an event.
+   *
+   * @return The state to be in, always State::Active.
+   */
+  State onEventLoopProcessStart();
+
+  /**
+   * To be called after the event loop processed an event.
+   *
+   * @param numPendingEvents The current size of the event queue.
+   * @param timeToNextEvent The time until the next event is expected, see
+   *        predictTimeToNextEvent().
+   * @return The state to be in.
+   */
+  State onEventLoopProcessEnd(size_t numPendingEvents,
+                              Nanoseconds timeToNextEvent);
+
+  /**
+   * Predicts the time until the next event from the expiration of the next
+   * timer and the delivery period of the enabled sensors. Must only be called
+   * from the context of the main CHRE thread.
+   *
+   * @return The predicted time, or Nanoseconds(UINT64_MAX) if no event is
+   *         expected.
+   */
+  static Nanoseconds predictTimeToNextEvent();
+
+  State getState() const {
+    return mState;
+  }
+
+  /**
+   * @return The number of changes of state since the policy was created.
+   */
+  uint32_t getNumTransitions() const {
+    return mNumTransitions;
+  }
+
+ private:
+  void setState(State state);
+
+  const Nanoseconds mMinLowPowerTime;
+
+  //! The event loop starts out idle.
+  State mState = State::LowPower;
+
+  uint32_t mNumTransitions = 0;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_CORE_POWER_POLICY_H_
@@ -248,6 +248,17 @@ class SensorRequestManager : public NonCopyable {
    */
   void logStateToBuffer(DebugDumpWrapper &debugDump) const;
 
+  /**
+   * Returns the shortest time between two deliveries of sensor data among the
+   * sensors enabled in active continuous mode, i.e. the larger of the interval
+   * and the latency of their maximal request. Must only be called from the
+   * context of the main CHRE thread.
+   *
+   * @return The shortest delivery period, or Nanoseconds(UINT64_MAX) if no
+   *         sensor is enabled in active continuous mode.
+   */
+  Nanoseconds getMinDataDeliveryPeriod() const;
+
   /**
    * Releases the sensor data event back to the platform. Also removes any
    * requests for a one-shot sensor if the sensor type corresponds to a one-shot
@@ -119,6 +119,12 @@ class TimerPool : public NonCopyable {
     return cancelTimer(kSystemInstanceId, timerHandle);
   }
 
+  /**
+   * @return The time at which the next timer expires, or
+   *         Nanoseconds(UINT64_MAX) if there is no timer.
+   */
+  Nanoseconds getNextExpirationTime();
+
  private:
   // Allows TestTimer to access hasNanoappTimers.
   friend class TestTimer;
@@ -66,17 +66,18 @@ bool Nanoapp::isRegisteredForBroadcastEvent(const Event *event) const {
         static_cast<const chreHostEndpointNotification *>(event->eventData);
     registered = isRegisteredForHostEndpointNotifications(data->hostEndpointId);
   } else {
-    size_t foundIndex = registrationIndex(eventType);
-    if (foundIndex < mRegisteredEvents.size()) {
-      const EventRegistration &reg = mRegisteredEvents[foundIndex];
-      if (targetGroupIdMask & reg.groupIdMask) {
-        registered = true;
-      }
-    }
+    registered = isRegisteredForBroadcastEvent(eventType, targetGroupIdMask);
   }
   return registered;
 }
 
+bool Nanoapp::isRegisteredForBroadcastEvent(uint16_t eventType,
+                                            uint16_t targetGroupIdMask) const {
+  size_t foundIndex = registrationIndex(eventType);
+  return foundIndex < mRegisteredEvents.size() &&
+         (targetGroupIdMask & mRegisteredEvents[foundIndex].groupIdMask) != 0;
+}
+
 void Nanoapp::registerForBroadcastEvent(uint16_t eventType,
                                         uint16_t groupIdMask) {
   size_t foundIndex = registrationIndex(eventType);
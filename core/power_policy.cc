@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/core/power_policy.h"
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/system_time.h"
+
+namespace chre {
+
+PowerPolicy::State PowerPolicy::onEventLoopProcessStart() {
+  setState(State::Active);
+  return mState;
+}
+
+PowerPolicy::State PowerPolicy::onEventLoopProcessEnd(
+    size_t numPendingEvents, Nanoseconds timeToNextEvent) {
+  // Only predicted events are used to stay active, as they are certain to end
+  // the wait: a timer expires or a sensor delivers its data.
+  if (numPendingEvents == 0 && timeToNextEvent >= mMinLowPowerTime) {
+    setState(State::LowPower);
+  }
+  return mState;
+}
+
+Nanoseconds PowerPolicy::predictTimeToNextEvent() {
+  auto *eventLoopManager = EventLoopManagerSingleton::get();
+  Nanoseconds now = SystemTime::getMonotonicTime();
+  Nanoseconds nextTimer =
+      eventLoopManager->getEventLoop().getTimerPool().getNextExpirationTime();
+  Nanoseconds timeToNextEvent =
+      (nextTimer > now) ? nextTimer - now : Nanoseconds(0);
+
+#ifdef CHRE_SENSORS_SUPPORT_ENABLED
+  Nanoseconds sensorPeriod =
+      eventLoopManager->getSensorRequestManager().getMinDataDeliveryPeriod();
+  if (sensorPeriod < timeToNextEvent) {
+    timeToNextEvent = sensorPeriod;
+  }
+#endif  // CHRE_SENSORS_SUPPORT_ENABLED
+
+  return timeToNextEvent;
+}
+
+void PowerPolicy::setState(State state) {
+  if (mState != state) {
+    mState = state;
+    mNumTransitions++;
+  }
+}
+
+}  // namespace chre
@@ -562,6 +562,22 @@ void SensorRequestManager::handleBiasEvent(uint32_t sensorHandle,
   }
 }
 
+Nanoseconds SensorRequestManager::getMinDataDeliveryPeriod() const {
+  Nanoseconds minPeriod(UINT64_MAX);
+  for (const Sensor &sensor : mSensors) {
+    const SensorRequest &request = sensor.getMaximalRequest();
+    if (request.getMode() == SensorMode::ActiveContinuous) {
+      Nanoseconds period = (request.getInterval() > request.getLatency())
+                               ? request.getInterval()
+                               : request.getLatency();
+      if (period < minPeriod) {
+        minPeriod = period;
+      }
+    }
+  }
+  return minPeriod;
+}
+
 void SensorRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
   debugDump.print("\nSensors:\n");
   for (uint8_t i = 0; i < mSensors.size(); i++) {
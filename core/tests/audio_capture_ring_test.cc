@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "chre/core/audio_capture_ring.h"
+
+using chre::AudioCaptureRing;
+
+namespace {
+
+constexpr uint32_t kSampleRate = 16000;
+constexpr uint64_t kSamplePeriodNs = 1000000000 / kSampleRate;
+
+//! A u-law audio data event of the samples [start, start + count), each
+//! holding the low byte of its index.
+class TestEvent {
+ public:
+  TestEvent(uint64_t start, uint32_t count) : mSamples(count) {
+    for (uint32_t i = 0; i < count; i++) {
+      mSamples[i] = static_cast<uint8_t>(start + i);
+    }
+    mEvent.version = CHRE_AUDIO_DATA_EVENT_VERSION;
+    mEvent.handle = 0;
+    mEvent.timestamp = start * kSamplePeriodNs;
+    mEvent.sampleRate = kSampleRate;
+    mEvent.sampleCount = count;
+    mEvent.format = CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW;
+    mEvent.samplesULaw8 = mSamples.data();
+  }
+
+  const chreAudioDataEvent &get() const {
+    return mEvent;
+  }
+
+ private:
+  std::vector<uint8_t> mSamples;
+  chreAudioDataEvent mEvent = {};
+};
+
+//! Checks that a window holds the samples [start, start + count).
+void expectWindow(const AudioCaptureRing::Window *window, uint64_t start,
+                  uint32_t count) {
+  ASSERT_NE(window, nullptr);
+  const chreAudioDataEvent *event = window->getEvent();
+  EXPECT_EQ(event->sampleCount, count);
+  EXPECT_EQ(event->timestamp, start * kSamplePeriodNs);
+  for (uint32_t i = 0; i < event->sampleCount; i++) {
+    ASSERT_EQ(event->samplesULaw8[i], static_cast<uint8_t>(start + i));
+  }
+}
+
+}  // namespace
+
+TEST(AudioCaptureRing, OverlappingEventsAreAppendedOnce) {
+  AudioCaptureRing ring;
+  ASSERT_TRUE(ring.reserve(100, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+  EXPECT_EQ(ring.getCapacity(), 100u);
+
+  ring.append(TestEvent(0, 100).get());
+  ring.append(TestEvent(60, 100).get());
+  EXPECT_EQ(ring.getSize(), 100u);
+  EXPECT_EQ(ring.getEndPosition(), 160u);
+
+  AudioCaptureRing::Window *window = ring.createWindow(0, 100);
+  expectWindow(window, 60, 100);
+  window->decRef();
+}
+
+TEST(AudioCaptureRing, WindowsWrappingAroundAreContiguous) {
+  AudioCaptureRing ring;
+  ASSERT_TRUE(ring.reserve(100, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+
+  for (uint64_t start = 0; start < 1000; start += 70) {
+    ring.append(TestEvent(start, 100).get());
+    AudioCaptureRing::Window *window = ring.createWindow(0, 100);
+    expectWindow(window, start, 100);
+    AudioCaptureRing::Window *smallWindow = ring.createWindow(0, 30);
+    expectWindow(smallWindow, start + 70, 30);
+    window->decRef();
+    smallWindow->decRef();
+  }
+}
+
+TEST(AudioCaptureRing, GapEmptiesTheRing) {
+  AudioCaptureRing ring;
+  ASSERT_TRUE(ring.reserve(100, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+
+  ring.append(TestEvent(0, 50).get());
+  ring.append(TestEvent(80, 50).get());
+  EXPECT_EQ(ring.getSize(), 50u);
+
+  AudioCaptureRing::Window *window = ring.createWindow(0, 100);
+  expectWindow(window, 80, 50);
+  window->decRef();
+}
+
+TEST(AudioCaptureRing, HeldWindowBlocksOverwrite) {
+  AudioCaptureRing ring;
+  ASSERT_TRUE(ring.reserve(100, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+
+  ring.append(TestEvent(0, 100).get());
+  AudioCaptureRing::Window *window = ring.createWindow(0, 60);
+  ASSERT_TRUE(ring.canAppend(TestEvent(80, 40).get()));
+  ring.append(TestEvent(80, 40).get());
+  EXPECT_FALSE(ring.canAppend(TestEvent(100, 100).get()));
+  expectWindow(window, 40, 60);
+
+  window->decRef();
+  EXPECT_EQ(ring.getNumWindows(), 0u);
+  EXPECT_TRUE(ring.canAppend(TestEvent(100, 100).get()));
+}
+
+TEST(AudioCaptureRing, WindowsOutliveReallocation) {
+  AudioCaptureRing ring;
+  ASSERT_TRUE(ring.reserve(100, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+  ring.append(TestEvent(0, 100).get());
+  AudioCaptureRing::Window *window = ring.createWindow(0, 100);
+
+  ASSERT_TRUE(ring.reserve(400, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+  EXPECT_EQ(ring.getCapacity(), 400u);
+  EXPECT_EQ(ring.getSize(), 0u);
+  EXPECT_EQ(ring.getNumWindows(), 0u);
+  expectWindow(window, 0, 100);
+  window->decRef();
+}
+
+TEST(AudioCaptureRing, WindowIsDestroyedWithItsLastReference) {
+  AudioCaptureRing ring;
+  ASSERT_TRUE(ring.reserve(100, CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW));
+  ring.append(TestEvent(0, 100).get());
+  AudioCaptureRing::Window *window = ring.createWindow(0, 100);
+  EXPECT_EQ(AudioCaptureRing::fromEvent(window->getEvent()), window);
+
+  window->incRef();
+  window->decRef();
+  EXPECT_EQ(ring.getNumWindows(), 1u);
+  window->decRef();
+  EXPECT_EQ(ring.getNumWindows(), 0u);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "chre/core/audio_feature_extractor.h"
+#include "chre_api/chre/audio.h"
+
+using chre::AudioFeatureExtractor;
+
+namespace {
+
+constexpr uint32_t kSampleRate = 16000;
+constexpr uint32_t kFrameSize = 512;
+constexpr uint16_t kNumBins = 40;
+
+//! Returns 16-bit PCM samples of a sine wave, as bytes.
+std::vector<uint8_t> makeSine(float frequency, uint32_t numSamples) {
+  std::vector<uint8_t> bytes(numSamples * sizeof(int16_t));
+  auto *samples = reinterpret_cast<int16_t *>(bytes.data());
+  for (uint32_t i = 0; i < numSamples; i++) {
+    samples[i] = static_cast<int16_t>(
+        8000.0f * sinf(2.0f * 3.14159265f * frequency * static_cast<float>(i) /
+                       static_cast<float>(kSampleRate)));
+  }
+  return bytes;
+}
+
+}  // namespace
+
+TEST(AudioFeatureExtractor, ValidatesConfiguration) {
+  EXPECT_TRUE(AudioFeatureExtractor::isValidConfiguration(512, 256, 40));
+  EXPECT_TRUE(AudioFeatureExtractor::isValidConfiguration(
+      CHRE_AUDIO_FEATURE_MAX_FRAME_SIZE, 1, 1));
+  EXPECT_FALSE(AudioFeatureExtractor::isValidConfiguration(500, 256, 40));
+  EXPECT_FALSE(AudioFeatureExtractor::isValidConfiguration(
+      CHRE_AUDIO_FEATURE_MAX_FRAME_SIZE * 2, 256, 40));
+  EXPECT_FALSE(AudioFeatureExtractor::isValidConfiguration(512, 0, 40));
+  EXPECT_FALSE(AudioFeatureExtractor::isValidConfiguration(512, 1024, 40));
+  EXPECT_FALSE(AudioFeatureExtractor::isValidConfiguration(512, 256, 0));
+  EXPECT_FALSE(AudioFeatureExtractor::isValidConfiguration(512, 256, 257));
+}
+
+TEST(AudioFeatureExtractor, SineHasMostEnergyInItsBand) {
+  AudioFeatureExtractor extractor;
+  ASSERT_TRUE(extractor.init(kSampleRate, kFrameSize, kNumBins));
+
+  int16_t lowEnergies[kNumBins];
+  int16_t highEnergies[kNumBins];
+  extractor.computeFrame(makeSine(300.0f, kFrameSize).data(),
+                         CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM,
+                         lowEnergies);
+  extractor.computeFrame(makeSine(4000.0f, kFrameSize).data(),
+                         CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM,
+                         highEnergies);
+
+  auto peak = [](const int16_t *energies) {
+    uint16_t peakBin = 0;
+    for (uint16_t i = 1; i < kNumBins; i++) {
+      if (energies[i] > energies[peakBin]) {
+        peakBin = i;
+      }
+    }
+    return peakBin;
+  };
+  uint16_t lowPeak = peak(lowEnergies);
+  uint16_t highPeak = peak(highEnergies);
+  EXPECT_LT(lowPeak, kNumBins / 4);
+  EXPECT_GT(highPeak, kNumBins / 2);
+  EXPECT_LT(highPeak, kNumBins - 1);
+
+  // The peak stands well above the bands far from it, 8.0 in Q8 being a
+  // factor of 256 in energy.
+  EXPECT_GT(lowEnergies[lowPeak] - lowEnergies[kNumBins - 1], 8 << 8);
+  EXPECT_GT(highEnergies[highPeak] - highEnergies[0], 8 << 8);
+}
+
+TEST(AudioFeatureExtractor, SilenceGivesTheFloor) {
+  AudioFeatureExtractor extractor;
+  ASSERT_TRUE(extractor.init(kSampleRate, kFrameSize, kNumBins));
+
+  std::vector<uint8_t> pcmSilence(kFrameSize * sizeof(int16_t), 0);
+  // 0xff is the u-law encoding of 0.
+  std::vector<uint8_t> uLawSilence(kFrameSize, 0xff);
+  int16_t energies[kNumBins];
+  extractor.computeFrame(pcmSilence.data(),
+                         CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM, energies);
+  for (int16_t energy : energies) {
+    EXPECT_EQ(energy, -(15 << 8));
+  }
+
+  extractor.computeFrame(uLawSilence.data(), CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW,
+                         energies);
+  for (int16_t energy : energies) {
+    EXPECT_EQ(energy, -(15 << 8));
+  }
+}
+
+TEST(AudioFeatureExtractor, DcDoesNotRaiseTheLowestBand) {
+  AudioFeatureExtractor extractor;
+  ASSERT_TRUE(extractor.init(kSampleRate, kFrameSize, kNumBins));
+
+  std::vector<int16_t> pcmOffset(kFrameSize, 8000);
+  // 0x80 is the u-law encoding of the largest positive value.
+  std::vector<uint8_t> uLawOffset(kFrameSize, 0x80);
+  int16_t energies[kNumBins];
+  extractor.computeFrame(reinterpret_cast<const uint8_t *>(pcmOffset.data()),
+                         CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM, energies);
+  EXPECT_EQ(energies[0], -(15 << 8));
+
+  extractor.computeFrame(uLawOffset.data(), CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW,
+                         energies);
+  EXPECT_EQ(energies[0], -(15 << 8));
+
+  // An offset added to a sine leaves all its bands unchanged.
+  std::vector<uint8_t> sine = makeSine(300.0f, kFrameSize);
+  int16_t sineEnergies[kNumBins];
+  extractor.computeFrame(sine.data(), CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM,
+                         sineEnergies);
+  auto *sineSamples = reinterpret_cast<int16_t *>(sine.data());
+  for (uint32_t i = 0; i < kFrameSize; i++) {
+    sineSamples[i] = static_cast<int16_t>(sineSamples[i] + 8000);
+  }
+  extractor.computeFrame(sine.data(), CHRE_AUDIO_DATA_FORMAT_16_BIT_SIGNED_PCM,
+                         energies);
+  for (uint16_t i = 0; i < kNumBins; i++) {
+    EXPECT_NEAR(energies[i], sineEnergies[i], 1 << 4);
+  }
+}
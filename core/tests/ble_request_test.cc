@@ -153,3 +153,95 @@ TEST(BleRequest, GetScanFilter) {
   EXPECT_EQ(0, memcmp(scanFilters.get(), retFilter.genericFilters,
                       sizeof(chreBleGenericFilter)));
 }
+
+TEST(BleRequest, MatchesReportWithGenericFilters) {
+  chreBleGenericFilter genericFilters[2] = {};
+  genericFilters[0].type = CHRE_BLE_AD_TYPE_SERVICE_DATA_WITH_UUID_16_LE;
+  genericFilters[0].len = 2;
+  genericFilters[0].data[0] = 0x2c;
+  genericFilters[0].data[1] = 0xfe;
+  genericFilters[0].dataMask[0] = 0xff;
+  genericFilters[0].dataMask[1] = 0xff;
+  genericFilters[1].type = CHRE_BLE_AD_TYPE_MANUFACTURER_DATA;
+  genericFilters[1].len = 3;
+  genericFilters[1].data[0] = 0xe0;
+  genericFilters[1].data[2] = 0x10;
+  genericFilters[1].dataMask[0] = 0xff;
+  genericFilters[1].dataMask[1] = 0xff;
+  genericFilters[1].dataMask[2] = 0xf0;
+  chreBleScanFilterV1_9 filter = {};
+  filter.rssiThreshold = CHRE_BLE_RSSI_THRESHOLD_NONE;
+  filter.genericFilterCount = 2;
+  filter.genericFilters = genericFilters;
+  BleRequest request(0 /* instanceId */, true /* enable */,
+                     CHRE_BLE_SCAN_MODE_BACKGROUND, 0 /* reportDelayMs */,
+                     &filter, nullptr /* cookie */);
+  EXPECT_FALSE(request.matchesAllReports());
+
+  // Flags, then service data for the UUID 0xfe2c.
+  const uint8_t serviceData[] = {0x02, 0x01, 0x06, 0x05, 0x16,
+                                 0x2c, 0xfe, 0xaa, 0xbb};
+  // Manufacturer data of 0x00e0 with its third byte only partially masked.
+  const uint8_t manufacturerData[] = {0x04, 0xff, 0xe0, 0x00, 0x1f};
+  const uint8_t otherManufacturerData[] = {0x04, 0xff, 0xe0, 0x00, 0x2f};
+  // The service data is truncated, and must not be read past the end.
+  const uint8_t truncatedData[] = {0x05, 0x16, 0x2c, 0xfe};
+  // The zero length marks the end of the significant part.
+  const uint8_t paddedData[] = {0x00, 0x03, 0x16, 0x2c, 0xfe};
+
+  chreBleAdvertisingReport report = {};
+  report.data = serviceData;
+  report.dataLength = sizeof(serviceData);
+  EXPECT_TRUE(request.matchesReport(report));
+  report.data = manufacturerData;
+  report.dataLength = sizeof(manufacturerData);
+  EXPECT_TRUE(request.matchesReport(report));
+  report.data = otherManufacturerData;
+  report.dataLength = sizeof(otherManufacturerData);
+  EXPECT_FALSE(request.matchesReport(report));
+  report.data = truncatedData;
+  report.dataLength = sizeof(truncatedData);
+  EXPECT_FALSE(request.matchesReport(report));
+  report.data = paddedData;
+  report.dataLength = sizeof(paddedData);
+  EXPECT_FALSE(request.matchesReport(report));
+  report.data = nullptr;
+  report.dataLength = 0;
+  EXPECT_FALSE(request.matchesReport(report));
+}
+
+TEST(BleRequest, MatchesReportWithBroadcasterFiltersAndRssiThreshold) {
+  chreBleBroadcasterAddressFilter broadcasterFilter = {
+      {0x01, 0x02, 0x03, 0xab, 0xcd, 0xef}};
+  chreBleScanFilterV1_9 filter = {};
+  filter.rssiThreshold = -70;
+  filter.broadcasterAddressFilterCount = 1;
+  filter.broadcasterAddressFilters = &broadcasterFilter;
+  BleRequest request(0 /* instanceId */, true /* enable */,
+                     CHRE_BLE_SCAN_MODE_BACKGROUND, 0 /* reportDelayMs */,
+                     &filter, nullptr /* cookie */);
+
+  chreBleAdvertisingReport report = {};
+  memcpy(report.address, broadcasterFilter.broadcasterAddress,
+         sizeof(report.address));
+  report.rssi = -60;
+  EXPECT_TRUE(request.matchesReport(report));
+  report.rssi = CHRE_BLE_RSSI_NONE;
+  EXPECT_TRUE(request.matchesReport(report));
+  report.rssi = -80;
+  EXPECT_FALSE(request.matchesReport(report));
+  report.rssi = -60;
+  report.address[5] = 0xee;
+  EXPECT_FALSE(request.matchesReport(report));
+}
+
+TEST(BleRequest, MatchesAllReportsWithoutFilter) {
+  BleRequest request(0 /* instanceId */, true /* enable */,
+                     CHRE_BLE_SCAN_MODE_BACKGROUND, 0 /* reportDelayMs */,
+                     nullptr /* filter */, nullptr /* cookie */);
+  EXPECT_TRUE(request.matchesAllReports());
+
+  chreBleAdvertisingReport report = {};
+  report.rssi = -127;
+  EXPECT_TRUE(request.matchesReport(report));
+}
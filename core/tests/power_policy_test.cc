@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+
+#include "chre/core/power_policy.h"
+
+using chre::Milliseconds;
+using chre::Nanoseconds;
+using chre::PowerPolicy;
+using State = chre::PowerPolicy::State;
+
+namespace {
+
+constexpr Nanoseconds kNoEventExpected(UINT64_MAX);
+
+}  // namespace
+
+TEST(PowerPolicy, StaysActiveWhileEventsArePending) {
+  PowerPolicy policy(Milliseconds(5));
+  EXPECT_EQ(policy.getState(), State::LowPower);
+
+  EXPECT_EQ(policy.onEventLoopProcessStart(), State::Active);
+  EXPECT_EQ(policy.onEventLoopProcessEnd(3, kNoEventExpected), State::Active);
+  EXPECT_EQ(policy.onEventLoopProcessStart(), State::Active);
+  EXPECT_EQ(policy.onEventLoopProcessEnd(0, kNoEventExpected),
+            State::LowPower);
+  EXPECT_EQ(policy.getNumTransitions(), 2);
+}
+
+TEST(PowerPolicy, StaysActiveUntilALongIdleIsPredicted) {
+  PowerPolicy policy(Milliseconds(5));
+
+  policy.onEventLoopProcessStart();
+  EXPECT_EQ(policy.onEventLoopProcessEnd(0, Milliseconds(1)), State::Active);
+  policy.onEventLoopProcessStart();
+  EXPECT_EQ(policy.onEventLoopProcessEnd(0, Milliseconds(4)), State::Active);
+  policy.onEventLoopProcessStart();
+  EXPECT_EQ(policy.onEventLoopProcessEnd(0, Milliseconds(5)),
+            State::LowPower);
+  EXPECT_EQ(policy.getNumTransitions(), 2);
+}
+
+TEST(PowerPolicy, ZeroMinimumTimeEntersLowPowerWhenIdle) {
+  PowerPolicy policy(Nanoseconds(0));
+
+  policy.onEventLoopProcessStart();
+  EXPECT_EQ(policy.onEventLoopProcessEnd(0, Nanoseconds(0)), State::LowPower);
+  policy.onEventLoopProcessStart();
+  EXPECT_EQ(policy.onEventLoopProcessEnd(1, Nanoseconds(0)), State::Active);
+  EXPECT_EQ(policy.getNumTransitions(), 3);
+}
+
+TEST(PowerPolicy, BurstOfTimerEventsEntersLowPowerOnce) {
+  // A burst of 100 events 1 ms apart, then a long idle, as with a nanoapp
+  // using a periodic timer for a while.
+  constexpr uint32_t kNumEvents = 100;
+  PowerPolicy perEventPolicy(Nanoseconds(0));
+  PowerPolicy policy(Milliseconds(5));
+  for (uint32_t i = 0; i < kNumEvents; i++) {
+    Nanoseconds timeToNextEvent =
+        (i + 1 < kNumEvents) ? Nanoseconds(Milliseconds(1)) : kNoEventExpected;
+    for (PowerPolicy *p : {&perEventPolicy, &policy}) {
+      p->onEventLoopProcessStart();
+      p->onEventLoopProcessEnd(0, timeToNextEvent);
+    }
+  }
+
+  EXPECT_EQ(perEventPolicy.getNumTransitions(), 2 * kNumEvents);
+  EXPECT_EQ(policy.getNumTransitions(), 2);
+}
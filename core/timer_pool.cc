@@ -311,6 +311,12 @@ void TimerPool::rescheduleAndRemoveExpiredTimersLocked(
   }
 }
 
+Nanoseconds TimerPool::getNextExpirationTime() {
+  LockGuard<Mutex> lock(mMutex);
+  return mTimerRequests.empty() ? Nanoseconds(UINT64_MAX)
+                                : mTimerRequests.top().expirationTime;
+}
+
 bool TimerPool::hasNanoappTimers(uint16_t instanceId) {
   LockGuard<Mutex> lock(mMutex);
 
@@ -129,6 +129,14 @@ void FbsDaemonBase::onMessageReceived(const unsigned char *messageBuffer,
         reinterpret_cast<const uint8_t *>(logDataBuffer.data());
     uint32_t numLogsDropped = logMessage->num_logs_dropped;
     getLogger().logV2(logData, logDataBuffer.size(), numLogsDropped);
+  } else if (messageType == fbs::ChreMessage::LogMessageV3) {
+    const auto *logMessage = container->message.AsLogMessageV3();
+    const std::vector<int8_t> &logDataBuffer = logMessage->buffer;
+    const auto *logData =
+        reinterpret_cast<const uint8_t *>(logDataBuffer.data());
+    getLogger().logV3(logData, logDataBuffer.size(), logMessage->compression,
+                      logMessage->uncompressed_size,
+                      logMessage->num_logs_dropped);
   } else if (messageType == fbs::ChreMessage::TimeSyncRequest) {
     sendTimeSync(true /* logOnError */);
   } else if (messageType == fbs::ChreMessage::LowPowerMicAccessRequest) {
@@ -143,6 +151,8 @@ void FbsDaemonBase::onMessageReceived(const unsigned char *messageBuffer,
   } else if (messageType == fbs::ChreMessage::NanConfigurationRequest) {
     handleNanConfigurationRequest(
         container->message.AsNanConfigurationRequest());
+  } else if (messageType == fbs::ChreMessage::NanoappMessageBatch) {
+    handleNanoappMessageBatch(*container->message.AsNanoappMessageBatch());
   } else if (messageType == fbs::ChreMessage::NanoappTokenDatabaseInfo) {
     // TODO(b/242760291): Use this info to map nanoapp log detokenizers with
     // instance ID in log message parser.
@@ -156,6 +166,21 @@ void FbsDaemonBase::onMessageReceived(const unsigned char *messageBuffer,
   }
 }
 
+void FbsDaemonBase::handleNanoappMessageBatch(
+    const fbs::NanoappMessageBatchT &batch) {
+  // Clients only know individual nanoapp messages, so the batch is split into
+  // the messages it was made of, sent in order.
+  for (const std::unique_ptr<fbs::NanoappMessageT> &message : batch.messages) {
+    flatbuffers::FlatBufferBuilder builder(message->message.size() + 128);
+    HostProtocolHost::encodeNanoappMessage(
+        builder, message->app_id, message->message_type,
+        message->host_endpoint, message->message.data(),
+        message->message.size(), message->permissions,
+        message->message_permissions, message->woke_host);
+    mServer.sendToAllClients(builder.GetBufferPointer(), builder.GetSize());
+  }
+}
+
 void FbsDaemonBase::handleDaemonMessage(const uint8_t *message) {
   std::unique_ptr<fbs::MessageContainerT> container =
       fbs::UnPackMessageContainer(message);
@@ -19,6 +19,9 @@
 #include <inttypes.h>
 #include <string.h>
 
+#include <iomanip>
+#include <sstream>
+
 #include "chre_host/log.h"
 
 using flatbuffers::FlatBufferBuilder;
@@ -83,6 +86,11 @@ bool HostProtocolHost::decodeMessageFromChre(const void *message,
         handlers.handleDebugDumpResponse(*msg.AsDebugDumpResponse());
         break;
 
+      case fbs::ChreMessage::StructuredDebugDumpData:
+        handlers.handleStructuredDebugDumpData(
+            *msg.AsStructuredDebugDumpData());
+        break;
+
       case fbs::ChreMessage::SelfTestResponse:
         handlers.handleSelfTestResponse(*msg.AsSelfTestResponse());
         break;
@@ -144,6 +152,78 @@ void HostProtocolHost::encodeDebugDumpRequest(FlatBufferBuilder &builder) {
   finalize(builder, fbs::ChreMessage::DebugDumpRequest, request.Union());
 }
 
+std::string HostProtocolHost::formatStructuredDebugDump(
+    const fbs::StructuredDebugDumpDataT &data) {
+  std::ostringstream out;
+  out << "\nNanoapp heap usage: " << data.nanoapp_heap_allocated_bytes
+      << " bytes allocated, " << data.nanoapp_heap_peak_allocated_bytes
+      << " peak bytes allocated, count " << data.nanoapp_heap_allocation_count
+      << "\n";
+
+  out << "\nEvent Loop:\n"
+      << "  Max event pool usage: " << data.max_event_pool_usage << "/"
+      << data.event_pool_size << "\n"
+      << "  Number of low priority events dropped: "
+      << data.num_dropped_low_priority_events << "\n"
+      << "  Nanoapp host wakeup tracking: cycled "
+      << data.wakeup_bucket_cycled_mins_ago
+      << " mins ago, bucketDuration=" << data.wakeup_bucket_duration_mins
+      << "mins\n";
+
+  out << "\nNanoapps:\n";
+  if (data.nanoapps.empty()) {
+    return out.str();
+  }
+
+  // Formats a version as major.minor, or major.minor.patch.
+  auto formatVersion = [](uint32_t version, bool withPatch) {
+    std::string str = std::to_string((version >> 24) & 0xff) + "." +
+                      std::to_string((version >> 16) & 0xff);
+    if (withPatch) {
+      str += "." + std::to_string(version & 0xffff);
+    }
+    return str;
+  };
+
+  // Returns the string of a byte vector, or an empty string if it is absent.
+  auto toString = [](const std::vector<int8_t> &vector) {
+    const char *str = getStringFromByteVector(vector);
+    return (str != nullptr) ? str : "";
+  };
+
+  for (const auto &nanoapp : data.nanoapps) {
+    out << " Id=" << nanoapp->instance_id << " 0x" << std::hex
+        << std::setfill('0') << std::setw(16) << nanoapp->app_id << std::dec
+        << std::setfill(' ') << " " << toString(nanoapp->name) << " ("
+        << toString(nanoapp->vendor)
+        << ") @ build: " << toString(nanoapp->build) << " v"
+        << formatVersion(nanoapp->version, true /*withPatch*/) << " tgtAPI="
+        << formatVersion(nanoapp->target_api_version, false /*withPatch*/)
+        << "\n";
+  }
+
+  out << "\n" << std::setw(17) << "Nanoapp" << std::setw(9) << ""
+      << "| Mem Alloc (Bytes) |  Event Time (Ms)\n"
+      << std::setw(26) << ""
+      << "| Current |     Max |     Max |   Total\n";
+  for (const auto &nanoapp : data.nanoapps) {
+    out << std::setw(25) << toString(nanoapp->name) << " | " << std::setw(7)
+        << nanoapp->allocated_bytes << " | " << std::setw(7)
+        << nanoapp->peak_allocated_bytes << " | " << std::setw(7)
+        << nanoapp->max_event_time_ms << " | " << std::setw(7)
+        << nanoapp->total_event_time_ms << "\n";
+  }
+
+  out << "\n" << std::setw(26) << " Nanoapp " << "| Total w/u | Total Msgs\n";
+  for (const auto &nanoapp : data.nanoapps) {
+    out << std::setw(25) << toString(nanoapp->name) << " | " << std::setw(9)
+        << nanoapp->num_wakeups << " | " << std::setw(10)
+        << nanoapp->num_messages_sent << "\n";
+  }
+
+  return out.str();
+}
+
 bool HostProtocolHost::extractHostClientIdAndType(
     const void *message, size_t messageLen, uint16_t *hostClientId,
     ::chre::fbs::ChreMessage *messageType) {
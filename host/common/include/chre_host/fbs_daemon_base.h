@@ -94,6 +94,15 @@ class FbsDaemonBase : public ChreDaemonBase {
    */
   void handleDaemonMessage(const uint8_t *message) override;
 
+  /**
+   * Handles a batch of messages from nanoapps by sending each message of the
+   * batch to the clients as an individual NanoappMessage.
+   *
+   * @param batch The batch of messages.
+   */
+  void handleNanoappMessageBatch(
+      const ::chre::fbs::NanoappMessageBatchT &batch);
+
   /**
    * Platform-specific method to actually do the message sending requested by
    * sendMessageToChre.
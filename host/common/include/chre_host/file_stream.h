@@ -17,6 +17,7 @@
 #ifndef CHRE_HOST_FILE_STREAM_H_
 #define CHRE_HOST_FILE_STREAM_H_
 
+#include <cstdint>
 #include <vector>
 
 namespace android {
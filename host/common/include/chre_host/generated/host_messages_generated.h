@@ -17,6 +17,10 @@ struct MessageDeliveryStatus;
 struct MessageDeliveryStatusBuilder;
 struct MessageDeliveryStatusT;
 
+struct NanoappMessageBatch;
+struct NanoappMessageBatchBuilder;
+struct NanoappMessageBatchT;
+
 struct HubInfoRequest;
 struct HubInfoRequestBuilder;
 struct HubInfoRequestT;
@@ -81,6 +85,14 @@ struct DebugDumpResponse;
 struct DebugDumpResponseBuilder;
 struct DebugDumpResponseT;
 
+struct DebugDumpNanoapp;
+struct DebugDumpNanoappBuilder;
+struct DebugDumpNanoappT;
+
+struct StructuredDebugDumpData;
+struct StructuredDebugDumpDataBuilder;
+struct StructuredDebugDumpDataT;
+
 struct TimeSyncRequest;
 struct TimeSyncRequestBuilder;
 struct TimeSyncRequestT;
@@ -101,6 +113,10 @@ struct LogMessageV2;
 struct LogMessageV2Builder;
 struct LogMessageV2T;
 
+struct LogMessageV3;
+struct LogMessageV3Builder;
+struct LogMessageV3T;
+
 struct SelfTestRequest;
 struct SelfTestRequestBuilder;
 struct SelfTestRequestT;
@@ -266,33 +282,36 @@ enum class LogType : int8_t {
   TOKENIZED = 1,
   BLUETOOTH = 2,
   NANOAPP_TOKENIZED = 3,
+  DEFERRED_STRING = 4,
   MIN = STRING,
-  MAX = NANOAPP_TOKENIZED
+  MAX = DEFERRED_STRING
 };
 
-inline const LogType (&EnumValuesLogType())[4] {
+inline const LogType (&EnumValuesLogType())[5] {
   static const LogType values[] = {
     LogType::STRING,
     LogType::TOKENIZED,
     LogType::BLUETOOTH,
-    LogType::NANOAPP_TOKENIZED
+    LogType::NANOAPP_TOKENIZED,
+    LogType::DEFERRED_STRING
   };
   return values;
 }
 
 inline const char * const *EnumNamesLogType() {
-  static const char * const names[5] = {
+  static const char * const names[6] = {
     "STRING",
     "TOKENIZED",
     "BLUETOOTH",
     "NANOAPP_TOKENIZED",
+    "DEFERRED_STRING",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameLogType(LogType e) {
-  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::NANOAPP_TOKENIZED)) return "";
+  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::DEFERRED_STRING)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesLogType()[index];
 }
@@ -327,6 +346,38 @@ inline const char *EnumNameBtSnoopDirection(BtSnoopDirection e) {
   return EnumNamesBtSnoopDirection()[index];
 }
 
+/// The compression applied to the buffer of a LogMessageV3.
+enum class LogCompression : int8_t {
+  NONE = 0,
+  /// LZ4 block format, without the LZ4 frame header.
+  LZ4_BLOCK = 1,
+  MIN = NONE,
+  MAX = LZ4_BLOCK
+};
+
+inline const LogCompression (&EnumValuesLogCompression())[2] {
+  static const LogCompression values[] = {
+    LogCompression::NONE,
+    LogCompression::LZ4_BLOCK
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesLogCompression() {
+  static const char * const names[3] = {
+    "NONE",
+    "LZ4_BLOCK",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameLogCompression(LogCompression e) {
+  if (flatbuffers::IsOutRange(e, LogCompression::NONE, LogCompression::LZ4_BLOCK)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesLogCompression()[index];
+}
+
 /// A union that joins together all possible messages. Note that in FlatBuffers,
 /// unions have an implicit type
 enum class ChreMessage : uint8_t {
@@ -363,11 +414,14 @@ enum class ChreMessage : uint8_t {
   PulseResponse = 30,
   NanoappTokenDatabaseInfo = 31,
   MessageDeliveryStatus = 32,
+  LogMessageV3 = 33,
+  NanoappMessageBatch = 34,
+  StructuredDebugDumpData = 35,
   MIN = NONE,
-  MAX = MessageDeliveryStatus
+  MAX = StructuredDebugDumpData
 };
 
-inline const ChreMessage (&EnumValuesChreMessage())[33] {
+inline const ChreMessage (&EnumValuesChreMessage())[36] {
   static const ChreMessage values[] = {
     ChreMessage::NONE,
     ChreMessage::NanoappMessage,
@@ -401,13 +455,16 @@ inline const ChreMessage (&EnumValuesChreMessage())[33] {
     ChreMessage::PulseRequest,
     ChreMessage::PulseResponse,
     ChreMessage::NanoappTokenDatabaseInfo,
-    ChreMessage::MessageDeliveryStatus
+    ChreMessage::MessageDeliveryStatus,
+    ChreMessage::LogMessageV3,
+    ChreMessage::NanoappMessageBatch,
+    ChreMessage::StructuredDebugDumpData
   };
   return values;
 }
 
 inline const char * const *EnumNamesChreMessage() {
-  static const char * const names[34] = {
+  static const char * const names[37] = {
     "NONE",
     "NanoappMessage",
     "HubInfoRequest",
@@ -441,13 +498,16 @@ inline const char * const *EnumNamesChreMessage() {
     "PulseResponse",
     "NanoappTokenDatabaseInfo",
     "MessageDeliveryStatus",
+    "LogMessageV3",
+    "NanoappMessageBatch",
+    "StructuredDebugDumpData",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameChreMessage(ChreMessage e) {
-  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::MessageDeliveryStatus)) return "";
+  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::StructuredDebugDumpData)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesChreMessage()[index];
 }
@@ -584,6 +644,18 @@ template<> struct ChreMessageTraits<chre::fbs::MessageDeliveryStatus> {
   static const ChreMessage enum_value = ChreMessage::MessageDeliveryStatus;
 };
 
+template<> struct ChreMessageTraits<chre::fbs::LogMessageV3> {
+  static const ChreMessage enum_value = ChreMessage::LogMessageV3;
+};
+
+template<> struct ChreMessageTraits<chre::fbs::NanoappMessageBatch> {
+  static const ChreMessage enum_value = ChreMessage::NanoappMessageBatch;
+};
+
+template<> struct ChreMessageTraits<chre::fbs::StructuredDebugDumpData> {
+  static const ChreMessage enum_value = ChreMessage::StructuredDebugDumpData;
+};
+
 struct ChreMessageUnion {
   ChreMessage type;
   void *value;
@@ -872,6 +944,30 @@ struct ChreMessageUnion {
     return type == ChreMessage::MessageDeliveryStatus ?
       reinterpret_cast<const chre::fbs::MessageDeliveryStatusT *>(value) : nullptr;
   }
+  chre::fbs::LogMessageV3T *AsLogMessageV3() {
+    return type == ChreMessage::LogMessageV3 ?
+      reinterpret_cast<chre::fbs::LogMessageV3T *>(value) : nullptr;
+  }
+  const chre::fbs::LogMessageV3T *AsLogMessageV3() const {
+    return type == ChreMessage::LogMessageV3 ?
+      reinterpret_cast<const chre::fbs::LogMessageV3T *>(value) : nullptr;
+  }
+  chre::fbs::NanoappMessageBatchT *AsNanoappMessageBatch() {
+    return type == ChreMessage::NanoappMessageBatch ?
+      reinterpret_cast<chre::fbs::NanoappMessageBatchT *>(value) : nullptr;
+  }
+  const chre::fbs::NanoappMessageBatchT *AsNanoappMessageBatch() const {
+    return type == ChreMessage::NanoappMessageBatch ?
+      reinterpret_cast<const chre::fbs::NanoappMessageBatchT *>(value) : nullptr;
+  }
+  chre::fbs::StructuredDebugDumpDataT *AsStructuredDebugDumpData() {
+    return type == ChreMessage::StructuredDebugDumpData ?
+      reinterpret_cast<chre::fbs::StructuredDebugDumpDataT *>(value) : nullptr;
+  }
+  const chre::fbs::StructuredDebugDumpDataT *AsStructuredDebugDumpData() const {
+    return type == ChreMessage::StructuredDebugDumpData ?
+      reinterpret_cast<const chre::fbs::StructuredDebugDumpDataT *>(value) : nullptr;
+  }
 };
 
 bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj, ChreMessage type);
@@ -1188,6 +1284,79 @@ inline flatbuffers::Offset<MessageDeliveryStatus> CreateMessageDeliveryStatus(
 
 flatbuffers::Offset<MessageDeliveryStatus> CreateMessageDeliveryStatus(flatbuffers::FlatBufferBuilder &_fbb, const MessageDeliveryStatusT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct NanoappMessageBatchT : public flatbuffers::NativeTable {
+  typedef NanoappMessageBatch TableType;
+  std::vector<std::unique_ptr<chre::fbs::NanoappMessageT>> messages;
+  NanoappMessageBatchT() {
+  }
+};
+
+/// A batch of messages from nanoapps to the host, sent in a single transport
+/// transaction to reduce the per-message overhead. The host demultiplexes it
+/// into the individual messages, in order.
+struct NanoappMessageBatch FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef NanoappMessageBatchT NativeTableType;
+  typedef NanoappMessageBatchBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_MESSAGES = 4
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *messages() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *>(VT_MESSAGES);
+  }
+  flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *mutable_messages() {
+    return GetPointer<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *>(VT_MESSAGES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffsetRequired(verifier, VT_MESSAGES) &&
+           verifier.VerifyVector(messages()) &&
+           verifier.VerifyVectorOfTables(messages()) &&
+           verifier.EndTable();
+  }
+  NanoappMessageBatchT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(NanoappMessageBatchT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<NanoappMessageBatch> Pack(flatbuffers::FlatBufferBuilder &_fbb, const NanoappMessageBatchT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct NanoappMessageBatchBuilder {
+  typedef NanoappMessageBatch Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_messages(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> messages) {
+    fbb_.AddOffset(NanoappMessageBatch::VT_MESSAGES, messages);
+  }
+  explicit NanoappMessageBatchBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  NanoappMessageBatchBuilder &operator=(const NanoappMessageBatchBuilder &);
+  flatbuffers::Offset<NanoappMessageBatch> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<NanoappMessageBatch>(end);
+    fbb_.Required(o, NanoappMessageBatch::VT_MESSAGES);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<NanoappMessageBatch> CreateNanoappMessageBatch(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> messages = 0) {
+  NanoappMessageBatchBuilder builder_(_fbb);
+  builder_.add_messages(messages);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<NanoappMessageBatch> CreateNanoappMessageBatchDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *messages = nullptr) {
+  auto messages__ = messages ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::NanoappMessage>>(*messages) : 0;
+  return chre::fbs::CreateNanoappMessageBatch(
+      _fbb,
+      messages__);
+}
+
+flatbuffers::Offset<NanoappMessageBatch> CreateNanoappMessageBatch(flatbuffers::FlatBufferBuilder &_fbb, const NanoappMessageBatchT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct HubInfoRequestT : public flatbuffers::NativeTable {
   typedef HubInfoRequest TableType;
   HubInfoRequestT() {
@@ -2841,6 +3010,518 @@ inline flatbuffers::Offset<DebugDumpResponse> CreateDebugDumpResponse(
 
 flatbuffers::Offset<DebugDumpResponse> CreateDebugDumpResponse(flatbuffers::FlatBufferBuilder &_fbb, const DebugDumpResponseT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct DebugDumpNanoappT : public flatbuffers::NativeTable {
+  typedef DebugDumpNanoapp TableType;
+  uint64_t app_id;
+  uint16_t instance_id;
+  uint32_t version;
+  uint32_t target_api_version;
+  std::vector<int8_t> name;
+  std::vector<int8_t> vendor;
+  std::vector<int8_t> build;
+  bool is_system;
+  uint32_t allocated_bytes;
+  uint32_t peak_allocated_bytes;
+  uint64_t max_event_time_ms;
+  uint64_t total_event_time_ms;
+  uint32_t num_wakeups;
+  uint32_t num_messages_sent;
+  DebugDumpNanoappT()
+      : app_id(0),
+        instance_id(0),
+        version(0),
+        target_api_version(0),
+        is_system(false),
+        allocated_bytes(0),
+        peak_allocated_bytes(0),
+        max_event_time_ms(0),
+        total_event_time_ms(0),
+        num_wakeups(0),
+        num_messages_sent(0) {
+  }
+};
+
+/// The state of a nanoapp, part of a StructuredDebugDumpData.
+struct DebugDumpNanoapp FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef DebugDumpNanoappT NativeTableType;
+  typedef DebugDumpNanoappBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_APP_ID = 4,
+    VT_INSTANCE_ID = 6,
+    VT_VERSION = 8,
+    VT_TARGET_API_VERSION = 10,
+    VT_NAME = 12,
+    VT_VENDOR = 14,
+    VT_BUILD = 16,
+    VT_IS_SYSTEM = 18,
+    VT_ALLOCATED_BYTES = 20,
+    VT_PEAK_ALLOCATED_BYTES = 22,
+    VT_MAX_EVENT_TIME_MS = 24,
+    VT_TOTAL_EVENT_TIME_MS = 26,
+    VT_NUM_WAKEUPS = 28,
+    VT_NUM_MESSAGES_SENT = 30
+  };
+  uint64_t app_id() const {
+    return GetField<uint64_t>(VT_APP_ID, 0);
+  }
+  bool mutate_app_id(uint64_t _app_id) {
+    return SetField<uint64_t>(VT_APP_ID, _app_id, 0);
+  }
+  uint16_t instance_id() const {
+    return GetField<uint16_t>(VT_INSTANCE_ID, 0);
+  }
+  bool mutate_instance_id(uint16_t _instance_id) {
+    return SetField<uint16_t>(VT_INSTANCE_ID, _instance_id, 0);
+  }
+  uint32_t version() const {
+    return GetField<uint32_t>(VT_VERSION, 0);
+  }
+  bool mutate_version(uint32_t _version) {
+    return SetField<uint32_t>(VT_VERSION, _version, 0);
+  }
+  uint32_t target_api_version() const {
+    return GetField<uint32_t>(VT_TARGET_API_VERSION, 0);
+  }
+  bool mutate_target_api_version(uint32_t _target_api_version) {
+    return SetField<uint32_t>(VT_TARGET_API_VERSION, _target_api_version, 0);
+  }
+  /// Null-terminated ASCII name of the nanoapp
+  const flatbuffers::Vector<int8_t> *name() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_NAME);
+  }
+  flatbuffers::Vector<int8_t> *mutable_name() {
+    return GetPointer<flatbuffers::Vector<int8_t> *>(VT_NAME);
+  }
+  /// Null-terminated ASCII name of the nanoapp vendor
+  const flatbuffers::Vector<int8_t> *vendor() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_VENDOR);
+  }
+  flatbuffers::Vector<int8_t> *mutable_vendor() {
+    return GetPointer<flatbuffers::Vector<int8_t> *>(VT_VENDOR);
+  }
+  /// Null-terminated ASCII build of the nanoapp, as identified by the platform
+  const flatbuffers::Vector<int8_t> *build() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_BUILD);
+  }
+  flatbuffers::Vector<int8_t> *mutable_build() {
+    return GetPointer<flatbuffers::Vector<int8_t> *>(VT_BUILD);
+  }
+  bool is_system() const {
+    return GetField<uint8_t>(VT_IS_SYSTEM, 0) != 0;
+  }
+  bool mutate_is_system(bool _is_system) {
+    return SetField<uint8_t>(VT_IS_SYSTEM, static_cast<uint8_t>(_is_system), 0);
+  }
+  /// Current and peak heap usage, in bytes
+  uint32_t allocated_bytes() const {
+    return GetField<uint32_t>(VT_ALLOCATED_BYTES, 0);
+  }
+  bool mutate_allocated_bytes(uint32_t _allocated_bytes) {
+    return SetField<uint32_t>(VT_ALLOCATED_BYTES, _allocated_bytes, 0);
+  }
+  uint32_t peak_allocated_bytes() const {
+    return GetField<uint32_t>(VT_PEAK_ALLOCATED_BYTES, 0);
+  }
+  bool mutate_peak_allocated_bytes(uint32_t _peak_allocated_bytes) {
+    return SetField<uint32_t>(VT_PEAK_ALLOCATED_BYTES, _peak_allocated_bytes, 0);
+  }
+  /// Longest and total time spent handling events since boot, in
+  /// milliseconds
+  uint64_t max_event_time_ms() const {
+    return GetField<uint64_t>(VT_MAX_EVENT_TIME_MS, 0);
+  }
+  bool mutate_max_event_time_ms(uint64_t _max_event_time_ms) {
+    return SetField<uint64_t>(VT_MAX_EVENT_TIME_MS, _max_event_time_ms, 0);
+  }
+  uint64_t total_event_time_ms() const {
+    return GetField<uint64_t>(VT_TOTAL_EVENT_TIME_MS, 0);
+  }
+  bool mutate_total_event_time_ms(uint64_t _total_event_time_ms) {
+    return SetField<uint64_t>(VT_TOTAL_EVENT_TIME_MS, _total_event_time_ms, 0);
+  }
+  /// Number of host wakeups and of messages sent to the host since boot
+  uint32_t num_wakeups() const {
+    return GetField<uint32_t>(VT_NUM_WAKEUPS, 0);
+  }
+  bool mutate_num_wakeups(uint32_t _num_wakeups) {
+    return SetField<uint32_t>(VT_NUM_WAKEUPS, _num_wakeups, 0);
+  }
+  uint32_t num_messages_sent() const {
+    return GetField<uint32_t>(VT_NUM_MESSAGES_SENT, 0);
+  }
+  bool mutate_num_messages_sent(uint32_t _num_messages_sent) {
+    return SetField<uint32_t>(VT_NUM_MESSAGES_SENT, _num_messages_sent, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint64_t>(verifier, VT_APP_ID) &&
+           VerifyField<uint16_t>(verifier, VT_INSTANCE_ID) &&
+           VerifyField<uint32_t>(verifier, VT_VERSION) &&
+           VerifyField<uint32_t>(verifier, VT_TARGET_API_VERSION) &&
+           VerifyOffset(verifier, VT_NAME) &&
+           verifier.VerifyVector(name()) &&
+           VerifyOffset(verifier, VT_VENDOR) &&
+           verifier.VerifyVector(vendor()) &&
+           VerifyOffset(verifier, VT_BUILD) &&
+           verifier.VerifyVector(build()) &&
+           VerifyField<uint8_t>(verifier, VT_IS_SYSTEM) &&
+           VerifyField<uint32_t>(verifier, VT_ALLOCATED_BYTES) &&
+           VerifyField<uint32_t>(verifier, VT_PEAK_ALLOCATED_BYTES) &&
+           VerifyField<uint64_t>(verifier, VT_MAX_EVENT_TIME_MS) &&
+           VerifyField<uint64_t>(verifier, VT_TOTAL_EVENT_TIME_MS) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_WAKEUPS) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_MESSAGES_SENT) &&
+           verifier.EndTable();
+  }
+  DebugDumpNanoappT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(DebugDumpNanoappT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<DebugDumpNanoapp> Pack(flatbuffers::FlatBufferBuilder &_fbb, const DebugDumpNanoappT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct DebugDumpNanoappBuilder {
+  typedef DebugDumpNanoapp Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_app_id(uint64_t app_id) {
+    fbb_.AddElement<uint64_t>(DebugDumpNanoapp::VT_APP_ID, app_id, 0);
+  }
+  void add_instance_id(uint16_t instance_id) {
+    fbb_.AddElement<uint16_t>(DebugDumpNanoapp::VT_INSTANCE_ID, instance_id, 0);
+  }
+  void add_version(uint32_t version) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_VERSION, version, 0);
+  }
+  void add_target_api_version(uint32_t target_api_version) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_TARGET_API_VERSION, target_api_version, 0);
+  }
+  void add_name(flatbuffers::Offset<flatbuffers::Vector<int8_t>> name) {
+    fbb_.AddOffset(DebugDumpNanoapp::VT_NAME, name);
+  }
+  void add_vendor(flatbuffers::Offset<flatbuffers::Vector<int8_t>> vendor) {
+    fbb_.AddOffset(DebugDumpNanoapp::VT_VENDOR, vendor);
+  }
+  void add_build(flatbuffers::Offset<flatbuffers::Vector<int8_t>> build) {
+    fbb_.AddOffset(DebugDumpNanoapp::VT_BUILD, build);
+  }
+  void add_is_system(bool is_system) {
+    fbb_.AddElement<uint8_t>(DebugDumpNanoapp::VT_IS_SYSTEM, static_cast<uint8_t>(is_system), 0);
+  }
+  void add_allocated_bytes(uint32_t allocated_bytes) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_ALLOCATED_BYTES, allocated_bytes, 0);
+  }
+  void add_peak_allocated_bytes(uint32_t peak_allocated_bytes) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_PEAK_ALLOCATED_BYTES, peak_allocated_bytes, 0);
+  }
+  void add_max_event_time_ms(uint64_t max_event_time_ms) {
+    fbb_.AddElement<uint64_t>(DebugDumpNanoapp::VT_MAX_EVENT_TIME_MS, max_event_time_ms, 0);
+  }
+  void add_total_event_time_ms(uint64_t total_event_time_ms) {
+    fbb_.AddElement<uint64_t>(DebugDumpNanoapp::VT_TOTAL_EVENT_TIME_MS, total_event_time_ms, 0);
+  }
+  void add_num_wakeups(uint32_t num_wakeups) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_NUM_WAKEUPS, num_wakeups, 0);
+  }
+  void add_num_messages_sent(uint32_t num_messages_sent) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_NUM_MESSAGES_SENT, num_messages_sent, 0);
+  }
+  explicit DebugDumpNanoappBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  DebugDumpNanoappBuilder &operator=(const DebugDumpNanoappBuilder &);
+  flatbuffers::Offset<DebugDumpNanoapp> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<DebugDumpNanoapp>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<DebugDumpNanoapp> CreateDebugDumpNanoapp(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint64_t app_id = 0,
+    uint16_t instance_id = 0,
+    uint32_t version = 0,
+    uint32_t target_api_version = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> name = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> vendor = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> build = 0,
+    bool is_system = false,
+    uint32_t allocated_bytes = 0,
+    uint32_t peak_allocated_bytes = 0,
+    uint64_t max_event_time_ms = 0,
+    uint64_t total_event_time_ms = 0,
+    uint32_t num_wakeups = 0,
+    uint32_t num_messages_sent = 0) {
+  DebugDumpNanoappBuilder builder_(_fbb);
+  builder_.add_total_event_time_ms(total_event_time_ms);
+  builder_.add_max_event_time_ms(max_event_time_ms);
+  builder_.add_app_id(app_id);
+  builder_.add_num_messages_sent(num_messages_sent);
+  builder_.add_num_wakeups(num_wakeups);
+  builder_.add_peak_allocated_bytes(peak_allocated_bytes);
+  builder_.add_allocated_bytes(allocated_bytes);
+  builder_.add_build(build);
+  builder_.add_vendor(vendor);
+  builder_.add_name(name);
+  builder_.add_target_api_version(target_api_version);
+  builder_.add_version(version);
+  builder_.add_instance_id(instance_id);
+  builder_.add_is_system(is_system);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<DebugDumpNanoapp> CreateDebugDumpNanoappDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint64_t app_id = 0,
+    uint16_t instance_id = 0,
+    uint32_t version = 0,
+    uint32_t target_api_version = 0,
+    const std::vector<int8_t> *name = nullptr,
+    const std::vector<int8_t> *vendor = nullptr,
+    const std::vector<int8_t> *build = nullptr,
+    bool is_system = false,
+    uint32_t allocated_bytes = 0,
+    uint32_t peak_allocated_bytes = 0,
+    uint64_t max_event_time_ms = 0,
+    uint64_t total_event_time_ms = 0,
+    uint32_t num_wakeups = 0,
+    uint32_t num_messages_sent = 0) {
+  auto name__ = name ? _fbb.CreateVector<int8_t>(*name) : 0;
+  auto vendor__ = vendor ? _fbb.CreateVector<int8_t>(*vendor) : 0;
+  auto build__ = build ? _fbb.CreateVector<int8_t>(*build) : 0;
+  return chre::fbs::CreateDebugDumpNanoapp(
+      _fbb,
+      app_id,
+      instance_id,
+      version,
+      target_api_version,
+      name__,
+      vendor__,
+      build__,
+      is_system,
+      allocated_bytes,
+      peak_allocated_bytes,
+      max_event_time_ms,
+      total_event_time_ms,
+      num_wakeups,
+      num_messages_sent);
+}
+
+flatbuffers::Offset<DebugDumpNanoapp> CreateDebugDumpNanoapp(flatbuffers::FlatBufferBuilder &_fbb, const DebugDumpNanoappT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct StructuredDebugDumpDataT : public flatbuffers::NativeTable {
+  typedef StructuredDebugDumpData TableType;
+  uint32_t max_event_pool_usage;
+  uint32_t event_pool_size;
+  uint32_t num_dropped_low_priority_events;
+  uint64_t wakeup_bucket_cycled_mins_ago;
+  uint64_t wakeup_bucket_duration_mins;
+  uint32_t nanoapp_heap_allocated_bytes;
+  uint32_t nanoapp_heap_peak_allocated_bytes;
+  uint32_t nanoapp_heap_allocation_count;
+  std::vector<std::unique_ptr<chre::fbs::DebugDumpNanoappT>> nanoapps;
+  StructuredDebugDumpDataT()
+      : max_event_pool_usage(0),
+        event_pool_size(0),
+        num_dropped_low_priority_events(0),
+        wakeup_bucket_cycled_mins_ago(0),
+        wakeup_bucket_duration_mins(0),
+        nanoapp_heap_allocated_bytes(0),
+        nanoapp_heap_peak_allocated_bytes(0),
+        nanoapp_heap_allocation_count(0) {
+  }
+};
+
+/// The state of the CHRE framework that debug dumps otherwise format as text
+/// on the hub: the event loop, nanoapp heap usage and the nanoapps. Sent
+/// between the DebugDumpData messages of a debug dump session and rendered
+/// to text by the host, which can also use the fields directly.
+struct StructuredDebugDumpData FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef StructuredDebugDumpDataT NativeTableType;
+  typedef StructuredDebugDumpDataBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_MAX_EVENT_POOL_USAGE = 4,
+    VT_EVENT_POOL_SIZE = 6,
+    VT_NUM_DROPPED_LOW_PRIORITY_EVENTS = 8,
+    VT_WAKEUP_BUCKET_CYCLED_MINS_AGO = 10,
+    VT_WAKEUP_BUCKET_DURATION_MINS = 12,
+    VT_NANOAPP_HEAP_ALLOCATED_BYTES = 14,
+    VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES = 16,
+    VT_NANOAPP_HEAP_ALLOCATION_COUNT = 18,
+    VT_NANOAPPS = 20
+  };
+  /// Peak and total number of events of the event pool
+  uint32_t max_event_pool_usage() const {
+    return GetField<uint32_t>(VT_MAX_EVENT_POOL_USAGE, 0);
+  }
+  bool mutate_max_event_pool_usage(uint32_t _max_event_pool_usage) {
+    return SetField<uint32_t>(VT_MAX_EVENT_POOL_USAGE, _max_event_pool_usage, 0);
+  }
+  uint32_t event_pool_size() const {
+    return GetField<uint32_t>(VT_EVENT_POOL_SIZE, 0);
+  }
+  bool mutate_event_pool_size(uint32_t _event_pool_size) {
+    return SetField<uint32_t>(VT_EVENT_POOL_SIZE, _event_pool_size, 0);
+  }
+  uint32_t num_dropped_low_priority_events() const {
+    return GetField<uint32_t>(VT_NUM_DROPPED_LOW_PRIORITY_EVENTS, 0);
+  }
+  bool mutate_num_dropped_low_priority_events(uint32_t _num_dropped_low_priority_events) {
+    return SetField<uint32_t>(VT_NUM_DROPPED_LOW_PRIORITY_EVENTS, _num_dropped_low_priority_events, 0);
+  }
+  /// Minutes since the nanoapp host wakeup buckets were last cycled, and
+  /// duration of a bucket in minutes
+  uint64_t wakeup_bucket_cycled_mins_ago() const {
+    return GetField<uint64_t>(VT_WAKEUP_BUCKET_CYCLED_MINS_AGO, 0);
+  }
+  bool mutate_wakeup_bucket_cycled_mins_ago(uint64_t _wakeup_bucket_cycled_mins_ago) {
+    return SetField<uint64_t>(VT_WAKEUP_BUCKET_CYCLED_MINS_AGO, _wakeup_bucket_cycled_mins_ago, 0);
+  }
+  uint64_t wakeup_bucket_duration_mins() const {
+    return GetField<uint64_t>(VT_WAKEUP_BUCKET_DURATION_MINS, 0);
+  }
+  bool mutate_wakeup_bucket_duration_mins(uint64_t _wakeup_bucket_duration_mins) {
+    return SetField<uint64_t>(VT_WAKEUP_BUCKET_DURATION_MINS, _wakeup_bucket_duration_mins, 0);
+  }
+  /// Heap usage of all nanoapps
+  uint32_t nanoapp_heap_allocated_bytes() const {
+    return GetField<uint32_t>(VT_NANOAPP_HEAP_ALLOCATED_BYTES, 0);
+  }
+  bool mutate_nanoapp_heap_allocated_bytes(uint32_t _nanoapp_heap_allocated_bytes) {
+    return SetField<uint32_t>(VT_NANOAPP_HEAP_ALLOCATED_BYTES, _nanoapp_heap_allocated_bytes, 0);
+  }
+  uint32_t nanoapp_heap_peak_allocated_bytes() const {
+    return GetField<uint32_t>(VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES, 0);
+  }
+  bool mutate_nanoapp_heap_peak_allocated_bytes(uint32_t _nanoapp_heap_peak_allocated_bytes) {
+    return SetField<uint32_t>(VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES, _nanoapp_heap_peak_allocated_bytes, 0);
+  }
+  uint32_t nanoapp_heap_allocation_count() const {
+    return GetField<uint32_t>(VT_NANOAPP_HEAP_ALLOCATION_COUNT, 0);
+  }
+  bool mutate_nanoapp_heap_allocation_count(uint32_t _nanoapp_heap_allocation_count) {
+    return SetField<uint32_t>(VT_NANOAPP_HEAP_ALLOCATION_COUNT, _nanoapp_heap_allocation_count, 0);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *nanoapps() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *>(VT_NANOAPPS);
+  }
+  flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *mutable_nanoapps() {
+    return GetPointer<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *>(VT_NANOAPPS);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_MAX_EVENT_POOL_USAGE) &&
+           VerifyField<uint32_t>(verifier, VT_EVENT_POOL_SIZE) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_DROPPED_LOW_PRIORITY_EVENTS) &&
+           VerifyField<uint64_t>(verifier, VT_WAKEUP_BUCKET_CYCLED_MINS_AGO) &&
+           VerifyField<uint64_t>(verifier, VT_WAKEUP_BUCKET_DURATION_MINS) &&
+           VerifyField<uint32_t>(verifier, VT_NANOAPP_HEAP_ALLOCATED_BYTES) &&
+           VerifyField<uint32_t>(verifier, VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES) &&
+           VerifyField<uint32_t>(verifier, VT_NANOAPP_HEAP_ALLOCATION_COUNT) &&
+           VerifyOffset(verifier, VT_NANOAPPS) &&
+           verifier.VerifyVector(nanoapps()) &&
+           verifier.VerifyVectorOfTables(nanoapps()) &&
+           verifier.EndTable();
+  }
+  StructuredDebugDumpDataT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(StructuredDebugDumpDataT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<StructuredDebugDumpData> Pack(flatbuffers::FlatBufferBuilder &_fbb, const StructuredDebugDumpDataT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct StructuredDebugDumpDataBuilder {
+  typedef StructuredDebugDumpData Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_max_event_pool_usage(uint32_t max_event_pool_usage) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_MAX_EVENT_POOL_USAGE, max_event_pool_usage, 0);
+  }
+  void add_event_pool_size(uint32_t event_pool_size) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_EVENT_POOL_SIZE, event_pool_size, 0);
+  }
+  void add_num_dropped_low_priority_events(uint32_t num_dropped_low_priority_events) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NUM_DROPPED_LOW_PRIORITY_EVENTS, num_dropped_low_priority_events, 0);
+  }
+  void add_wakeup_bucket_cycled_mins_ago(uint64_t wakeup_bucket_cycled_mins_ago) {
+    fbb_.AddElement<uint64_t>(StructuredDebugDumpData::VT_WAKEUP_BUCKET_CYCLED_MINS_AGO, wakeup_bucket_cycled_mins_ago, 0);
+  }
+  void add_wakeup_bucket_duration_mins(uint64_t wakeup_bucket_duration_mins) {
+    fbb_.AddElement<uint64_t>(StructuredDebugDumpData::VT_WAKEUP_BUCKET_DURATION_MINS, wakeup_bucket_duration_mins, 0);
+  }
+  void add_nanoapp_heap_allocated_bytes(uint32_t nanoapp_heap_allocated_bytes) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NANOAPP_HEAP_ALLOCATED_BYTES, nanoapp_heap_allocated_bytes, 0);
+  }
+  void add_nanoapp_heap_peak_allocated_bytes(uint32_t nanoapp_heap_peak_allocated_bytes) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES, nanoapp_heap_peak_allocated_bytes, 0);
+  }
+  void add_nanoapp_heap_allocation_count(uint32_t nanoapp_heap_allocation_count) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NANOAPP_HEAP_ALLOCATION_COUNT, nanoapp_heap_allocation_count, 0);
+  }
+  void add_nanoapps(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>>> nanoapps) {
+    fbb_.AddOffset(StructuredDebugDumpData::VT_NANOAPPS, nanoapps);
+  }
+  explicit StructuredDebugDumpDataBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  StructuredDebugDumpDataBuilder &operator=(const StructuredDebugDumpDataBuilder &);
+  flatbuffers::Offset<StructuredDebugDumpData> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<StructuredDebugDumpData>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<StructuredDebugDumpData> CreateStructuredDebugDumpData(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t max_event_pool_usage = 0,
+    uint32_t event_pool_size = 0,
+    uint32_t num_dropped_low_priority_events = 0,
+    uint64_t wakeup_bucket_cycled_mins_ago = 0,
+    uint64_t wakeup_bucket_duration_mins = 0,
+    uint32_t nanoapp_heap_allocated_bytes = 0,
+    uint32_t nanoapp_heap_peak_allocated_bytes = 0,
+    uint32_t nanoapp_heap_allocation_count = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>>> nanoapps = 0) {
+  StructuredDebugDumpDataBuilder builder_(_fbb);
+  builder_.add_wakeup_bucket_duration_mins(wakeup_bucket_duration_mins);
+  builder_.add_wakeup_bucket_cycled_mins_ago(wakeup_bucket_cycled_mins_ago);
+  builder_.add_nanoapps(nanoapps);
+  builder_.add_nanoapp_heap_allocation_count(nanoapp_heap_allocation_count);
+  builder_.add_nanoapp_heap_peak_allocated_bytes(nanoapp_heap_peak_allocated_bytes);
+  builder_.add_nanoapp_heap_allocated_bytes(nanoapp_heap_allocated_bytes);
+  builder_.add_num_dropped_low_priority_events(num_dropped_low_priority_events);
+  builder_.add_event_pool_size(event_pool_size);
+  builder_.add_max_event_pool_usage(max_event_pool_usage);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<StructuredDebugDumpData> CreateStructuredDebugDumpDataDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t max_event_pool_usage = 0,
+    uint32_t event_pool_size = 0,
+    uint32_t num_dropped_low_priority_events = 0,
+    uint64_t wakeup_bucket_cycled_mins_ago = 0,
+    uint64_t wakeup_bucket_duration_mins = 0,
+    uint32_t nanoapp_heap_allocated_bytes = 0,
+    uint32_t nanoapp_heap_peak_allocated_bytes = 0,
+    uint32_t nanoapp_heap_allocation_count = 0,
+    const std::vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *nanoapps = nullptr) {
+  auto nanoapps__ = nanoapps ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>>(*nanoapps) : 0;
+  return chre::fbs::CreateStructuredDebugDumpData(
+      _fbb,
+      max_event_pool_usage,
+      event_pool_size,
+      num_dropped_low_priority_events,
+      wakeup_bucket_cycled_mins_ago,
+      wakeup_bucket_duration_mins,
+      nanoapp_heap_allocated_bytes,
+      nanoapp_heap_peak_allocated_bytes,
+      nanoapp_heap_allocation_count,
+      nanoapps__);
+}
+
+flatbuffers::Offset<StructuredDebugDumpData> CreateStructuredDebugDumpData(flatbuffers::FlatBufferBuilder &_fbb, const StructuredDebugDumpDataT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct TimeSyncRequestT : public flatbuffers::NativeTable {
   typedef TimeSyncRequest TableType;
   TimeSyncRequestT() {
@@ -3076,7 +3757,8 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   ///                           [EI(Upper nibble) | Level(Lower nibble)]
   ///                            * Log Type
   ///                              (0 = No encoding, 1 = Tokenized log,
-  ///                               2 = BT snoop log, 3 = Nanoapp Tokenized log)
+  ///                               2 = BT snoop log, 3 = Nanoapp Tokenized log,
+  ///                               4 = Deferred string log)
   ///                            * LogBuffer log level (1 = error, 2 = warn,
   ///                                                   3 = info,  4 = debug,
   ///                                                   5 = verbose)
@@ -3111,6 +3793,21 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   ///   were to be sent, a buffer of size 27 bytes would be to encoded as:
   ///   [InstanceId (2B) | Size(1B) | Data(24B)].
   ///
+  /// * Deferred string logs: CHRE system logs whose printf-style formatting is
+  ///   deferred to the host. The first byte indicates the size of the data to
+  ///   follow. The data starts with the little-endian int32_t offset of the
+  ///   format string from the chreLogFormatAnchor symbol in the CHRE binary,
+  ///   followed by the arguments in the order they are consumed by the format
+  ///   string: [Size(1B) | FormatOffset(4B) | Args(Size - 4B)]. Arguments are
+  ///   encoded as follows:
+  ///   - Signed integers (%d, %i and '*' width/precision): zigzag varint
+  ///   - Unsigned integers, characters and pointers: varint
+  ///   - Floating point values: little-endian IEEE-754 double (8B)
+  ///   - Strings: NULL terminated, at most as long as the precision of the
+  ///     conversion if it has one
+  ///   A log whose arguments do not fit in the entry is sent as a string log
+  ///   instead.
+  ///
   /// This pattern repeats until the end of the buffer for multiple log
   /// messages. The last byte will always be a null-terminator. There are no
   /// padding bytes between these fields. Treat this like a packed struct and be
@@ -3187,6 +3884,131 @@ inline flatbuffers::Offset<LogMessageV2> CreateLogMessageV2Direct(
 
 flatbuffers::Offset<LogMessageV2> CreateLogMessageV2(flatbuffers::FlatBufferBuilder &_fbb, const LogMessageV2T *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct LogMessageV3T : public flatbuffers::NativeTable {
+  typedef LogMessageV3 TableType;
+  std::vector<int8_t> buffer;
+  chre::fbs::LogCompression compression;
+  uint32_t uncompressed_size;
+  uint32_t num_logs_dropped;
+  LogMessageV3T()
+      : compression(chre::fbs::LogCompression::NONE),
+        uncompressed_size(0),
+        num_logs_dropped(0) {
+  }
+};
+
+/// Represents V3 log messages from CHRE, whose log buffer may be compressed.
+struct LogMessageV3 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef LogMessageV3T NativeTableType;
+  typedef LogMessageV3Builder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_BUFFER = 4,
+    VT_COMPRESSION = 6,
+    VT_UNCOMPRESSED_SIZE = 8,
+    VT_NUM_LOGS_DROPPED = 10
+  };
+  /// A buffer containing log data in the format described in LogMessageV2,
+  /// compressed as indicated by the compression field.
+  const flatbuffers::Vector<int8_t> *buffer() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_BUFFER);
+  }
+  flatbuffers::Vector<int8_t> *mutable_buffer() {
+    return GetPointer<flatbuffers::Vector<int8_t> *>(VT_BUFFER);
+  }
+  /// The compression applied to the buffer.
+  chre::fbs::LogCompression compression() const {
+    return static_cast<chre::fbs::LogCompression>(GetField<int8_t>(VT_COMPRESSION, 0));
+  }
+  bool mutate_compression(chre::fbs::LogCompression _compression) {
+    return SetField<int8_t>(VT_COMPRESSION, static_cast<int8_t>(_compression), 0);
+  }
+  /// The size of the buffer once decompressed.
+  uint32_t uncompressed_size() const {
+    return GetField<uint32_t>(VT_UNCOMPRESSED_SIZE, 0);
+  }
+  bool mutate_uncompressed_size(uint32_t _uncompressed_size) {
+    return SetField<uint32_t>(VT_UNCOMPRESSED_SIZE, _uncompressed_size, 0);
+  }
+  /// The number of logs dropped since CHRE started
+  uint32_t num_logs_dropped() const {
+    return GetField<uint32_t>(VT_NUM_LOGS_DROPPED, 0);
+  }
+  bool mutate_num_logs_dropped(uint32_t _num_logs_dropped) {
+    return SetField<uint32_t>(VT_NUM_LOGS_DROPPED, _num_logs_dropped, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_BUFFER) &&
+           verifier.VerifyVector(buffer()) &&
+           VerifyField<int8_t>(verifier, VT_COMPRESSION) &&
+           VerifyField<uint32_t>(verifier, VT_UNCOMPRESSED_SIZE) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_LOGS_DROPPED) &&
+           verifier.EndTable();
+  }
+  LogMessageV3T *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(LogMessageV3T *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<LogMessageV3> Pack(flatbuffers::FlatBufferBuilder &_fbb, const LogMessageV3T* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct LogMessageV3Builder {
+  typedef LogMessageV3 Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_buffer(flatbuffers::Offset<flatbuffers::Vector<int8_t>> buffer) {
+    fbb_.AddOffset(LogMessageV3::VT_BUFFER, buffer);
+  }
+  void add_compression(chre::fbs::LogCompression compression) {
+    fbb_.AddElement<int8_t>(LogMessageV3::VT_COMPRESSION, static_cast<int8_t>(compression), 0);
+  }
+  void add_uncompressed_size(uint32_t uncompressed_size) {
+    fbb_.AddElement<uint32_t>(LogMessageV3::VT_UNCOMPRESSED_SIZE, uncompressed_size, 0);
+  }
+  void add_num_logs_dropped(uint32_t num_logs_dropped) {
+    fbb_.AddElement<uint32_t>(LogMessageV3::VT_NUM_LOGS_DROPPED, num_logs_dropped, 0);
+  }
+  explicit LogMessageV3Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  LogMessageV3Builder &operator=(const LogMessageV3Builder &);
+  flatbuffers::Offset<LogMessageV3> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<LogMessageV3>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LogMessageV3> CreateLogMessageV3(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> buffer = 0,
+    chre::fbs::LogCompression compression = chre::fbs::LogCompression::NONE,
+    uint32_t uncompressed_size = 0,
+    uint32_t num_logs_dropped = 0) {
+  LogMessageV3Builder builder_(_fbb);
+  builder_.add_num_logs_dropped(num_logs_dropped);
+  builder_.add_uncompressed_size(uncompressed_size);
+  builder_.add_buffer(buffer);
+  builder_.add_compression(compression);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<LogMessageV3> CreateLogMessageV3Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int8_t> *buffer = nullptr,
+    chre::fbs::LogCompression compression = chre::fbs::LogCompression::NONE,
+    uint32_t uncompressed_size = 0,
+    uint32_t num_logs_dropped = 0) {
+  auto buffer__ = buffer ? _fbb.CreateVector<int8_t>(*buffer) : 0;
+  return chre::fbs::CreateLogMessageV3(
+      _fbb,
+      buffer__,
+      compression,
+      uncompressed_size,
+      num_logs_dropped);
+}
+
+flatbuffers::Offset<LogMessageV3> CreateLogMessageV3(flatbuffers::FlatBufferBuilder &_fbb, const LogMessageV3T *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct SelfTestRequestT : public flatbuffers::NativeTable {
   typedef SelfTestRequest TableType;
   SelfTestRequestT() {
@@ -4010,6 +4832,15 @@ struct MessageContainer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const chre::fbs::MessageDeliveryStatus *message_as_MessageDeliveryStatus() const {
     return message_type() == chre::fbs::ChreMessage::MessageDeliveryStatus ? static_cast<const chre::fbs::MessageDeliveryStatus *>(message()) : nullptr;
   }
+  const chre::fbs::LogMessageV3 *message_as_LogMessageV3() const {
+    return message_type() == chre::fbs::ChreMessage::LogMessageV3 ? static_cast<const chre::fbs::LogMessageV3 *>(message()) : nullptr;
+  }
+  const chre::fbs::NanoappMessageBatch *message_as_NanoappMessageBatch() const {
+    return message_type() == chre::fbs::ChreMessage::NanoappMessageBatch ? static_cast<const chre::fbs::NanoappMessageBatch *>(message()) : nullptr;
+  }
+  const chre::fbs::StructuredDebugDumpData *message_as_StructuredDebugDumpData() const {
+    return message_type() == chre::fbs::ChreMessage::StructuredDebugDumpData ? static_cast<const chre::fbs::StructuredDebugDumpData *>(message()) : nullptr;
+  }
   void *mutable_message() {
     return GetPointer<void *>(VT_MESSAGE);
   }
@@ -4166,6 +4997,18 @@ template<> inline const chre::fbs::MessageDeliveryStatus *MessageContainer::mess
   return message_as_MessageDeliveryStatus();
 }
 
+template<> inline const chre::fbs::LogMessageV3 *MessageContainer::message_as<chre::fbs::LogMessageV3>() const {
+  return message_as_LogMessageV3();
+}
+
+template<> inline const chre::fbs::NanoappMessageBatch *MessageContainer::message_as<chre::fbs::NanoappMessageBatch>() const {
+  return message_as_NanoappMessageBatch();
+}
+
+template<> inline const chre::fbs::StructuredDebugDumpData *MessageContainer::message_as<chre::fbs::StructuredDebugDumpData>() const {
+  return message_as_StructuredDebugDumpData();
+}
+
 struct MessageContainerBuilder {
   typedef MessageContainer Table;
   flatbuffers::FlatBufferBuilder &fbb_;
@@ -4286,6 +5129,32 @@ inline flatbuffers::Offset<MessageDeliveryStatus> CreateMessageDeliveryStatus(fl
       _error_code);
 }
 
+inline NanoappMessageBatchT *NanoappMessageBatch::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  std::unique_ptr<chre::fbs::NanoappMessageBatchT> _o = std::unique_ptr<chre::fbs::NanoappMessageBatchT>(new NanoappMessageBatchT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void NanoappMessageBatch::UnPackTo(NanoappMessageBatchT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = messages(); if (_e) { _o->messages.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->messages[_i] = std::unique_ptr<chre::fbs::NanoappMessageT>(_e->Get(_i)->UnPack(_resolver)); } } }
+}
+
+inline flatbuffers::Offset<NanoappMessageBatch> NanoappMessageBatch::Pack(flatbuffers::FlatBufferBuilder &_fbb, const NanoappMessageBatchT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateNanoappMessageBatch(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<NanoappMessageBatch> CreateNanoappMessageBatch(flatbuffers::FlatBufferBuilder &_fbb, const NanoappMessageBatchT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const NanoappMessageBatchT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _messages = _fbb.CreateVector<flatbuffers::Offset<chre::fbs::NanoappMessage>> (_o->messages.size(), [](size_t i, _VectorArgs *__va) { return CreateNanoappMessage(*__va->__fbb, __va->__o->messages[i].get(), __va->__rehasher); }, &_va );
+  return chre::fbs::CreateNanoappMessageBatch(
+      _fbb,
+      _messages);
+}
+
 inline HubInfoRequestT *HubInfoRequest::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   std::unique_ptr<chre::fbs::HubInfoRequestT> _o = std::unique_ptr<chre::fbs::HubInfoRequestT>(new HubInfoRequestT());
   UnPackTo(_o.get(), _resolver);
@@ -4801,6 +5670,121 @@ inline flatbuffers::Offset<DebugDumpResponse> CreateDebugDumpResponse(flatbuffer
       _data_count);
 }
 
+inline DebugDumpNanoappT *DebugDumpNanoapp::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  std::unique_ptr<chre::fbs::DebugDumpNanoappT> _o = std::unique_ptr<chre::fbs::DebugDumpNanoappT>(new DebugDumpNanoappT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void DebugDumpNanoapp::UnPackTo(DebugDumpNanoappT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = app_id(); _o->app_id = _e; }
+  { auto _e = instance_id(); _o->instance_id = _e; }
+  { auto _e = version(); _o->version = _e; }
+  { auto _e = target_api_version(); _o->target_api_version = _e; }
+  { auto _e = name(); if (_e) { _o->name.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->name[_i] = _e->Get(_i); } } }
+  { auto _e = vendor(); if (_e) { _o->vendor.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->vendor[_i] = _e->Get(_i); } } }
+  { auto _e = build(); if (_e) { _o->build.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->build[_i] = _e->Get(_i); } } }
+  { auto _e = is_system(); _o->is_system = _e; }
+  { auto _e = allocated_bytes(); _o->allocated_bytes = _e; }
+  { auto _e = peak_allocated_bytes(); _o->peak_allocated_bytes = _e; }
+  { auto _e = max_event_time_ms(); _o->max_event_time_ms = _e; }
+  { auto _e = total_event_time_ms(); _o->total_event_time_ms = _e; }
+  { auto _e = num_wakeups(); _o->num_wakeups = _e; }
+  { auto _e = num_messages_sent(); _o->num_messages_sent = _e; }
+}
+
+inline flatbuffers::Offset<DebugDumpNanoapp> DebugDumpNanoapp::Pack(flatbuffers::FlatBufferBuilder &_fbb, const DebugDumpNanoappT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateDebugDumpNanoapp(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<DebugDumpNanoapp> CreateDebugDumpNanoapp(flatbuffers::FlatBufferBuilder &_fbb, const DebugDumpNanoappT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const DebugDumpNanoappT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _app_id = _o->app_id;
+  auto _instance_id = _o->instance_id;
+  auto _version = _o->version;
+  auto _target_api_version = _o->target_api_version;
+  auto _name = _o->name.size() ? _fbb.CreateVector(_o->name) : 0;
+  auto _vendor = _o->vendor.size() ? _fbb.CreateVector(_o->vendor) : 0;
+  auto _build = _o->build.size() ? _fbb.CreateVector(_o->build) : 0;
+  auto _is_system = _o->is_system;
+  auto _allocated_bytes = _o->allocated_bytes;
+  auto _peak_allocated_bytes = _o->peak_allocated_bytes;
+  auto _max_event_time_ms = _o->max_event_time_ms;
+  auto _total_event_time_ms = _o->total_event_time_ms;
+  auto _num_wakeups = _o->num_wakeups;
+  auto _num_messages_sent = _o->num_messages_sent;
+  return chre::fbs::CreateDebugDumpNanoapp(
+      _fbb,
+      _app_id,
+      _instance_id,
+      _version,
+      _target_api_version,
+      _name,
+      _vendor,
+      _build,
+      _is_system,
+      _allocated_bytes,
+      _peak_allocated_bytes,
+      _max_event_time_ms,
+      _total_event_time_ms,
+      _num_wakeups,
+      _num_messages_sent);
+}
+
+inline StructuredDebugDumpDataT *StructuredDebugDumpData::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  std::unique_ptr<chre::fbs::StructuredDebugDumpDataT> _o = std::unique_ptr<chre::fbs::StructuredDebugDumpDataT>(new StructuredDebugDumpDataT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void StructuredDebugDumpData::UnPackTo(StructuredDebugDumpDataT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = max_event_pool_usage(); _o->max_event_pool_usage = _e; }
+  { auto _e = event_pool_size(); _o->event_pool_size = _e; }
+  { auto _e = num_dropped_low_priority_events(); _o->num_dropped_low_priority_events = _e; }
+  { auto _e = wakeup_bucket_cycled_mins_ago(); _o->wakeup_bucket_cycled_mins_ago = _e; }
+  { auto _e = wakeup_bucket_duration_mins(); _o->wakeup_bucket_duration_mins = _e; }
+  { auto _e = nanoapp_heap_allocated_bytes(); _o->nanoapp_heap_allocated_bytes = _e; }
+  { auto _e = nanoapp_heap_peak_allocated_bytes(); _o->nanoapp_heap_peak_allocated_bytes = _e; }
+  { auto _e = nanoapp_heap_allocation_count(); _o->nanoapp_heap_allocation_count = _e; }
+  { auto _e = nanoapps(); if (_e) { _o->nanoapps.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->nanoapps[_i] = std::unique_ptr<chre::fbs::DebugDumpNanoappT>(_e->Get(_i)->UnPack(_resolver)); } } }
+}
+
+inline flatbuffers::Offset<StructuredDebugDumpData> StructuredDebugDumpData::Pack(flatbuffers::FlatBufferBuilder &_fbb, const StructuredDebugDumpDataT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateStructuredDebugDumpData(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<StructuredDebugDumpData> CreateStructuredDebugDumpData(flatbuffers::FlatBufferBuilder &_fbb, const StructuredDebugDumpDataT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const StructuredDebugDumpDataT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _max_event_pool_usage = _o->max_event_pool_usage;
+  auto _event_pool_size = _o->event_pool_size;
+  auto _num_dropped_low_priority_events = _o->num_dropped_low_priority_events;
+  auto _wakeup_bucket_cycled_mins_ago = _o->wakeup_bucket_cycled_mins_ago;
+  auto _wakeup_bucket_duration_mins = _o->wakeup_bucket_duration_mins;
+  auto _nanoapp_heap_allocated_bytes = _o->nanoapp_heap_allocated_bytes;
+  auto _nanoapp_heap_peak_allocated_bytes = _o->nanoapp_heap_peak_allocated_bytes;
+  auto _nanoapp_heap_allocation_count = _o->nanoapp_heap_allocation_count;
+  auto _nanoapps = _o->nanoapps.size() ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> (_o->nanoapps.size(), [](size_t i, _VectorArgs *__va) { return CreateDebugDumpNanoapp(*__va->__fbb, __va->__o->nanoapps[i].get(), __va->__rehasher); }, &_va ) : 0;
+  return chre::fbs::CreateStructuredDebugDumpData(
+      _fbb,
+      _max_event_pool_usage,
+      _event_pool_size,
+      _num_dropped_low_priority_events,
+      _wakeup_bucket_cycled_mins_ago,
+      _wakeup_bucket_duration_mins,
+      _nanoapp_heap_allocated_bytes,
+      _nanoapp_heap_peak_allocated_bytes,
+      _nanoapp_heap_allocation_count,
+      _nanoapps);
+}
+
 inline TimeSyncRequestT *TimeSyncRequest::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   std::unique_ptr<chre::fbs::TimeSyncRequestT> _o = std::unique_ptr<chre::fbs::TimeSyncRequestT>(new TimeSyncRequestT());
   UnPackTo(_o.get(), _resolver);
@@ -4928,6 +5912,41 @@ inline flatbuffers::Offset<LogMessageV2> CreateLogMessageV2(flatbuffers::FlatBuf
       _num_logs_dropped);
 }
 
+inline LogMessageV3T *LogMessageV3::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  std::unique_ptr<chre::fbs::LogMessageV3T> _o = std::unique_ptr<chre::fbs::LogMessageV3T>(new LogMessageV3T());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void LogMessageV3::UnPackTo(LogMessageV3T *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = buffer(); if (_e) { _o->buffer.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->buffer[_i] = _e->Get(_i); } } }
+  { auto _e = compression(); _o->compression = _e; }
+  { auto _e = uncompressed_size(); _o->uncompressed_size = _e; }
+  { auto _e = num_logs_dropped(); _o->num_logs_dropped = _e; }
+}
+
+inline flatbuffers::Offset<LogMessageV3> LogMessageV3::Pack(flatbuffers::FlatBufferBuilder &_fbb, const LogMessageV3T* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateLogMessageV3(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<LogMessageV3> CreateLogMessageV3(flatbuffers::FlatBufferBuilder &_fbb, const LogMessageV3T *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const LogMessageV3T* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _buffer = _o->buffer.size() ? _fbb.CreateVector(_o->buffer) : 0;
+  auto _compression = _o->compression;
+  auto _uncompressed_size = _o->uncompressed_size;
+  auto _num_logs_dropped = _o->num_logs_dropped;
+  return chre::fbs::CreateLogMessageV3(
+      _fbb,
+      _buffer,
+      _compression,
+      _uncompressed_size,
+      _num_logs_dropped);
+}
+
 inline SelfTestRequestT *SelfTestRequest::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   std::unique_ptr<chre::fbs::SelfTestRequestT> _o = std::unique_ptr<chre::fbs::SelfTestRequestT>(new SelfTestRequestT());
   UnPackTo(_o.get(), _resolver);
@@ -5382,6 +6401,18 @@ inline bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const chre::fbs::MessageDeliveryStatus *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case ChreMessage::LogMessageV3: {
+      auto ptr = reinterpret_cast<const chre::fbs::LogMessageV3 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ChreMessage::NanoappMessageBatch: {
+      auto ptr = reinterpret_cast<const chre::fbs::NanoappMessageBatch *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ChreMessage::StructuredDebugDumpData: {
+      auto ptr = reinterpret_cast<const chre::fbs::StructuredDebugDumpData *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return true;
   }
 }
@@ -5528,6 +6559,18 @@ inline void *ChreMessageUnion::UnPack(const void *obj, ChreMessage type, const f
       auto ptr = reinterpret_cast<const chre::fbs::MessageDeliveryStatus *>(obj);
       return ptr->UnPack(resolver);
     }
+    case ChreMessage::LogMessageV3: {
+      auto ptr = reinterpret_cast<const chre::fbs::LogMessageV3 *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case ChreMessage::NanoappMessageBatch: {
+      auto ptr = reinterpret_cast<const chre::fbs::NanoappMessageBatch *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case ChreMessage::StructuredDebugDumpData: {
+      auto ptr = reinterpret_cast<const chre::fbs::StructuredDebugDumpData *>(obj);
+      return ptr->UnPack(resolver);
+    }
     default: return nullptr;
   }
 }
@@ -5662,6 +6705,18 @@ inline flatbuffers::Offset<void> ChreMessageUnion::Pack(flatbuffers::FlatBufferB
       auto ptr = reinterpret_cast<const chre::fbs::MessageDeliveryStatusT *>(value);
       return CreateMessageDeliveryStatus(_fbb, ptr, _rehasher).Union();
     }
+    case ChreMessage::LogMessageV3: {
+      auto ptr = reinterpret_cast<const chre::fbs::LogMessageV3T *>(value);
+      return CreateLogMessageV3(_fbb, ptr, _rehasher).Union();
+    }
+    case ChreMessage::NanoappMessageBatch: {
+      auto ptr = reinterpret_cast<const chre::fbs::NanoappMessageBatchT *>(value);
+      return CreateNanoappMessageBatch(_fbb, ptr, _rehasher).Union();
+    }
+    case ChreMessage::StructuredDebugDumpData: {
+      auto ptr = reinterpret_cast<const chre::fbs::StructuredDebugDumpDataT *>(value);
+      return CreateStructuredDebugDumpData(_fbb, ptr, _rehasher).Union();
+    }
     default: return 0;
   }
 }
@@ -5796,6 +6851,18 @@ inline ChreMessageUnion::ChreMessageUnion(const ChreMessageUnion &u) : type(u.ty
       value = new chre::fbs::MessageDeliveryStatusT(*reinterpret_cast<chre::fbs::MessageDeliveryStatusT *>(u.value));
       break;
     }
+    case ChreMessage::LogMessageV3: {
+      value = new chre::fbs::LogMessageV3T(*reinterpret_cast<chre::fbs::LogMessageV3T *>(u.value));
+      break;
+    }
+    case ChreMessage::NanoappMessageBatch: {
+      FLATBUFFERS_ASSERT(false);  // chre::fbs::NanoappMessageBatchT not copyable.
+      break;
+    }
+    case ChreMessage::StructuredDebugDumpData: {
+      FLATBUFFERS_ASSERT(false);  // chre::fbs::StructuredDebugDumpDataT not copyable.
+      break;
+    }
     default:
       break;
   }
@@ -5963,6 +7030,21 @@ inline void ChreMessageUnion::Reset() {
       delete ptr;
       break;
     }
+    case ChreMessage::LogMessageV3: {
+      auto ptr = reinterpret_cast<chre::fbs::LogMessageV3T *>(value);
+      delete ptr;
+      break;
+    }
+    case ChreMessage::NanoappMessageBatch: {
+      auto ptr = reinterpret_cast<chre::fbs::NanoappMessageBatchT *>(value);
+      delete ptr;
+      break;
+    }
+    case ChreMessage::StructuredDebugDumpData: {
+      auto ptr = reinterpret_cast<chre::fbs::StructuredDebugDumpDataT *>(value);
+      delete ptr;
+      break;
+    }
     default: break;
   }
   value = nullptr;
@@ -25,6 +25,7 @@
 #include "chre_host/generated/host_messages_generated.h"
 #include "flatbuffers/flatbuffers.h"
 
+#include <string>
 #include <vector>
 
 namespace android {
@@ -72,6 +73,9 @@ class IChreMessageHandlers {
   virtual void handleDebugDumpResponse(
       const ::chre::fbs::DebugDumpResponseT & /*response*/){};
 
+  virtual void handleStructuredDebugDumpData(
+      const ::chre::fbs::StructuredDebugDumpDataT & /*data*/){};
+
   virtual void handleSelfTestResponse(
       const ::chre::fbs::SelfTestResponseT & /*response*/){};
 };
@@ -180,6 +184,18 @@ class HostProtocolHost : public ::chre::HostProtocolCommon {
    */
   static void encodeDebugDumpRequest(flatbuffers::FlatBufferBuilder &builder);
 
+  /**
+   * Formats a StructuredDebugDumpData message into the text that CHRE prints
+   * for the same sections when it doesn't send structured debug dumps, so it
+   * can be appended to the rest of the debug dump.
+   *
+   * @param data The decoded message
+   *
+   * @return The text of the debug dump sections
+   */
+  static std::string formatStructuredDebugDump(
+      const ::chre::fbs::StructuredDebugDumpDataT &data);
+
   /**
    * Decodes the host client ID included in the message container
    *
@@ -22,6 +22,8 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
+#include <vector>
 #include "chre/util/time.h"
 #include "chre_host/bt_snoop_log_parser.h"
 #include "chre_host/generated/host_messages_generated.h"
@@ -65,6 +67,41 @@ class LogMessageParser : public INanoappLoadListener {
   void logV2(const uint8_t *logBuffer, size_t logBufferSize,
              uint32_t numLogsDropped);
 
+  /**
+   * Logs from a possibly compressed log buffer containing one or more log
+   * messages (version 3). Once decompressed, the buffer is handled as a
+   * version 2 log buffer.
+   */
+  void logV3(const uint8_t *logBuffer, size_t logBufferSize,
+             ::chre::fbs::LogCompression compression, uint32_t uncompressedSize,
+             uint32_t numLogsDropped);
+
+  //! A log message decoded from a log buffer (version 2).
+  struct DecodedLog {
+    uint8_t level;
+    uint32_t timestampMillis;
+    std::string message;
+  };
+
+  /**
+   * Decodes all the log messages of a log buffer (version 2) without emitting
+   * them. BT snoop logs are captured as they are encountered and are not part
+   * of the output.
+   *
+   * The nanoapp detokenizers are looked up under a single lock acquisition for
+   * the whole buffer, which makes this cheaper than decoding the logs one at a
+   * time.
+   *
+   * @param logBuffer Buffer containing one or more log messages.
+   * @param logBufferSize Size of logBuffer in bytes.
+   * @param decodedLogs Vector the decoded logs are appended to, in the order
+   * they appear in logBuffer.
+   * @return false if decoding stopped early due to a corrupted log message.
+   */
+  bool decodeLogsV2(const uint8_t *logBuffer, size_t logBufferSize,
+                    std::vector<DecodedLog> &decodedLogs)
+      EXCLUDES(mNanoappMutex);
+
   /**
    * With verbose logging enabled (either during instantiation via a
    * constructor argument, or during compilation via N_DEBUG being defined
@@ -78,6 +115,11 @@ class LogMessageParser : public INanoappLoadListener {
   /**
    * Stores a pigweed detokenizer for decoding logs from a given nanoapp.
    *
+   * The detokenizer is built from a compact token database, sorted by token,
+   * which is read from the token database cache if the nanoapp was seen
+   * before, or extracted from the nanoapp binary and added to the cache
+   * otherwise. The nanoapp binary is released afterwards.
+   *
    * @param appId The app ID associated with the nanoapp.
    * @param instanceId The instance ID assigned to this nanoapp by the CHRE
    * event loop.
@@ -104,9 +146,76 @@ class LogMessageParser : public INanoappLoadListener {
    */
   void resetNanoappDetokenizerState();
 
+  /**
+   * Sets the directory nanoapp token databases are cached in. Defaults to
+   * kDefaultTokenDatabaseCacheDir.
+   */
+  void setTokenDatabaseCacheDir(const std::string &cacheDir)
+      EXCLUDES(mNanoappMutex);
+
+  /**
+   * @return The total size in bytes of the nanoapp binaries held waiting for
+   * their token database.
+   */
+  size_t getPendingNanoappBinariesSize() EXCLUDES(mNanoappMutex);
+
+  /**
+   * Builds a compact token database from the token entries section of a
+   * nanoapp ELF binary.
+   *
+   * The output uses the pigweed binary token database format, with the entries
+   * sorted by token and duplicates removed, so it can be passed to
+   * pw::tokenizer::TokenDatabase::Create().
+   *
+   * @param section Pointer to the token entries section.
+   * @param sectionSize Size of the section in bytes.
+   * @return The token database, or std::nullopt if the section is malformed.
+   */
+  static std::optional<std::vector<uint8_t>> buildTokenDatabase(
+      const uint8_t *section, size_t sectionSize);
+
+  /**
+   * Decompresses the log buffer of a version 3 log message.
+   *
+   * @param logBuffer The log buffer, compressed as indicated by compression.
+   * @param logBufferSize Size of logBuffer in bytes.
+   * @param compression The compression applied to logBuffer.
+   * @param uncompressedSize The size of the log buffer once decompressed.
+   * @return The decompressed log buffer, which is a version 2 log buffer, or
+   * std::nullopt if the compression is unknown or the buffer is corrupted.
+   */
+  static std::optional<std::vector<uint8_t>> decompressLogBuffer(
+      const uint8_t *logBuffer, size_t logBufferSize,
+      ::chre::fbs::LogCompression compression, uint32_t uncompressedSize);
+
+  /**
+   * Uses the given CHRE binary to format deferred string logs, and indexes its
+   * read-only sections. Replaces the binary loaded by init().
+   *
+   * @param image The CHRE ELF binary, or any ELF holding at least its
+   * read-only data sections and symbol table.
+   * @return true if the binary is well formed and the chreLogFormatAnchor
+   * symbol was found. Deferred string logs are not decoded otherwise.
+   */
+  bool loadDeferredLogFormats(std::vector<uint8_t> image);
+
+  /**
+   * Formats the binary arguments of a deferred string log. Every read is
+   * bounded by argsSize.
+   *
+   * @param format The NULL terminated printf-style format string of the log.
+   * @param args The encoded arguments, see host_messages.fbs.
+   * @param argsSize The size of args in bytes.
+   * @return The formatted log, or std::nullopt if the arguments do not match
+   * the format string.
+   */
+  static std::optional<std::string> formatDeferredLog(const char *format,
+                                                      const uint8_t *args,
+                                                      size_t argsSize);
+
   // Functions from INanoappLoadListener.
   void onNanoappLoadStarted(
-      uint64_t appId,
+      uint64_t appId, uint32_t appVersion,
       std::shared_ptr<const std::vector<uint8_t>> nanoappBinary) override;
 
   void onNanoappLoadFailed(uint64_t appId) override;
@@ -116,6 +225,9 @@ class LogMessageParser : public INanoappLoadListener {
  private:
   static constexpr char kHubLogFormatStr[] = "@ %3" PRIu32 ".%03" PRIu32 ": %s";
 
+  static constexpr char kDefaultTokenDatabaseCacheDir[] =
+      "/data/vendor/chre/token_database_cache";
+
   // Constants used to extract the log type from log metadata.
   static constexpr uint8_t kLogTypeMask = 0xF0;
   static constexpr uint8_t kLogTypeBitOffset = 4;
@@ -170,6 +282,26 @@ class LogMessageParser : public INanoappLoadListener {
   //! Log detokenizer used for CHRE system logs.
   std::unique_ptr<Detokenizer> mSystemDetokenizer;
 
+  /**
+   * A read-only section of the CHRE binary which deferred string log format
+   * strings are looked up in.
+   */
+  struct ImageSection {
+    uint64_t address;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  //! The CHRE binary the format strings of deferred string logs are read
+  //! from. Empty if the binary could not be loaded.
+  std::vector<uint8_t> mSystemImage;
+
+  //! The read-only sections of mSystemImage.
+  std::vector<ImageSection> mSystemImageSections;
+
+  //! The address of the chreLogFormatAnchor symbol in mSystemImage.
+  uint64_t mLogFormatAnchorAddress = 0;
+
   /**
    * Helper struct for keep track of nanoapp's log detokenizer with appIDs.
    */
@@ -183,12 +315,23 @@ class LogMessageParser : public INanoappLoadListener {
   std::unordered_map<uint16_t /*instanceId*/, NanoappDetokenizer>
       mNanoappDetokenizers GUARDED_BY(mNanoappMutex);
 
+  /**
+   * A nanoapp binary held until the token database of the nanoapp is received.
+   */
+  struct PendingNanoappBinary {
+    uint32_t appVersion;
+    std::shared_ptr<const std::vector<uint8_t>> binary;
+  };
+
   //! This is used to find the binary associated with a nanoapp with its app ID.
   //! Guarded by mNanoappMutex.
-  std::unordered_map<uint64_t /*appId*/,
-                     std::shared_ptr<const std::vector<uint8_t>>>
+  std::unordered_map<uint64_t /*appId*/, PendingNanoappBinary>
       mNanoappAppIdToBinary GUARDED_BY(mNanoappMutex);
 
+  //! The directory nanoapp token databases are cached in.
+  std::string mTokenDatabaseCacheDir GUARDED_BY(mNanoappMutex) =
+      kDefaultTokenDatabaseCacheDir;
+
   //! The mutex used to guard operations of mNanoappAppIdtoBinary and
   //! mNanoappDetokenizers.
   std::mutex mNanoappMutex;
@@ -204,39 +347,88 @@ class LogMessageParser : public INanoappLoadListener {
   void updateAndPrintDroppedLogs(uint32_t numLogsDropped);
 
   //! Method for parsing unencoded (string) log messages.
-  std::optional<size_t> parseAndEmitStringLogMessageAndGetSize(
-      const LogMessageV2 *message, size_t maxLogMessageLen);
+  std::optional<size_t> parseAndDecodeStringLogMessageAndGetSize(
+      const LogMessageV2 *message, size_t maxLogMessageLen,
+      std::vector<DecodedLog> &decodedLogs);
 
   /**
-   * Parses and emits an encoded log message while also returning the size of
+   * Parses and decodes an encoded log message while also returning the size of
    * the parsed message for buffer index bookkeeping.
    *
    * @param message Buffer containing the log metadata and log payload.
    * @param maxLogMessageLen The max size allowed for the log payload.
+   * @param decodedLogs Vector the decoded log is appended to.
    * @return Size of the encoded log message payload, std::nullopt if the
    * message format is invalid. Note that the size includes the 1 byte header
    * that we use for encoded log messages to track message size.
    */
-  std::optional<size_t> parseAndEmitTokenizedLogMessageAndGetSize(
-      const LogMessageV2 *message, size_t maxLogMessageLen);
+  std::optional<size_t> parseAndDecodeTokenizedLogMessageAndGetSize(
+      const LogMessageV2 *message, size_t maxLogMessageLen,
+      std::vector<DecodedLog> &decodedLogs);
 
   /**
-   * Similar to parseAndEmitTokenizedLogMessageAndGetSize, but used for encoded
-   * log message from nanoapps.
+   * Similar to parseAndDecodeTokenizedLogMessageAndGetSize, but used for
+   * encoded log message from nanoapps.
    *
    * @param message Buffer containing the log metadata and log payload.
    * @param maxLogMessageLen The max size allowed for the log payload.
+   * @param decodedLogs Vector the decoded log is appended to.
    * @return Size of the encoded log message payload, std::nullopt if the
    * message format is invalid. Note that the size includes the 1 byte header
    * that we use for encoded log messages to track message size, and the 2 byte
    * instance ID that the host uses to find the correct detokenizer.
    */
-  std::optional<size_t> parseAndEmitNanoappTokenizedLogMessageAndGetSize(
-      const LogMessageV2 *message, size_t maxLogMessageLen);
+  std::optional<size_t> parseAndDecodeNanoappTokenizedLogMessageAndGetSize(
+      const LogMessageV2 *message, size_t maxLogMessageLen,
+      std::vector<DecodedLog> &decodedLogs) REQUIRES(mNanoappMutex);
+
+  /**
+   * Similar to parseAndDecodeTokenizedLogMessageAndGetSize, but used for
+   * deferred string logs, which are formatted with the format strings of the
+   * CHRE binary.
+   *
+   * @param message Buffer containing the log metadata and log payload.
+   * @param maxLogMessageLen The max size allowed for the log payload.
+   * @param decodedLogs Vector the decoded log is appended to.
+   * @return Size of the deferred log message payload, std::nullopt if the
+   * message format is invalid. Note that the size includes the 1 byte header
+   * that tracks the message size.
+   */
+  std::optional<size_t> parseAndDecodeDeferredStringLogMessageAndGetSize(
+      const LogMessageV2 *message, size_t maxLogMessageLen,
+      std::vector<DecodedLog> &decodedLogs);
+
+  /**
+   * Loads the CHRE binary holding the format strings of deferred string logs
+   * from kLogFormatsFilePath.
+   *
+   * @return true if the binary was loaded, see loadDeferredLogFormats().
+   */
+  bool deferredLogFormatsInit();
+
+  /**
+   * @param formatOffset The offset of the format string from the
+   * chreLogFormatAnchor symbol.
+   * @return The NULL terminated format string, or nullptr if it is not part of
+   * the read-only data of the CHRE binary.
+   */
+  const char *findDeferredLogFormat(int32_t formatOffset);
 
   void emitLogMessage(uint8_t level, uint32_t timestampMillis,
                       const char *logMessage);
 
+  //! Emits the decoded logs and clears decodedLogs.
+  void emitDecodedLogs(std::vector<DecodedLog> &decodedLogs);
+
+  /**
+   * Implements decodeLogsV2(). With emitLogs set, the decoded logs are also
+   * emitted, each batch before the BT snoop log following it is captured so
+   * that the logs are output in order, and decodedLogs is left empty.
+   */
+  bool decodeLogsV2(const uint8_t *logBuffer, size_t logBufferSize,
+                    std::vector<DecodedLog> &decodedLogs, bool emitLogs)
+      EXCLUDES(mNanoappMutex);
+
   /**
    * Initialize the Log Detokenizer
    *
@@ -314,18 +506,50 @@ class LogMessageParser : public INanoappLoadListener {
   }
 
   /**
-   * Helper function that returns the nanoapp binary from its appId.
+   * Helper function that returns the nanoapp binary and version from its
+   * appId.
    */
-  std::shared_ptr<const std::vector<uint8_t>> fetchNanoappBinary(uint64_t appId)
+  std::optional<PendingNanoappBinary> fetchNanoappBinary(uint64_t appId)
       EXCLUDES(mNanoappMutex);
 
+  /**
+   * Helper function that returns the token database of a nanoapp, either from
+   * the token database cache or extracted from its binary.
+   *
+   * @return The token database, or an empty vector if it is not available.
+   */
+  std::vector<uint8_t> getNanoappTokenDatabase(uint64_t appId,
+                                               uint64_t databaseOffset,
+                                               size_t databaseSize)
+      EXCLUDES(mNanoappMutex);
+
+  /**
+   * Helper function that returns the path of the cached token database of a
+   * nanoapp.
+   */
+  std::string getTokenDatabaseCachePath(uint64_t appId, uint32_t appVersion,
+                                        uint32_t sectionHash)
+      EXCLUDES(mNanoappMutex);
+
+  /**
+   * Helper function that removes the token databases cached for other
+   * versions or builds of the nanoapp of cachePath, so that the cache holds
+   * at most one database per nanoapp.
+   */
+  static void removeStaleTokenDatabases(const std::string &cachePath);
+
   /**
    * Helper function that registers a nanoapp detokenizer with its appID and
    * instanceID.
    */
   void registerDetokenizer(uint64_t appId, uint16_t instanceId,
-                           pw::Result<Detokenizer> nanoappDetokenizer)
+                           std::unique_ptr<Detokenizer> nanoappDetokenizer)
       EXCLUDES(mNanoappMutex);
+
+  /**
+   * Helper function that removes the detokenizers of a nanoapp.
+   */
+  void removeNanoappDetokenizerLocked(uint64_t appId) REQUIRES(mNanoappMutex);
 };
 
 }  // namespace chre
@@ -28,9 +28,11 @@ class INanoappLoadListener {
    * Called before we send any nanoapp data to CHRE.
    *
    * @param appId The app ID associated with the nanoapp binary.
+   * @param appVersion The version of the nanoapp binary.
+   * @param nanoappBinary The nanoapp binary.
    */
   virtual void onNanoappLoadStarted(
-      uint64_t appId,
+      uint64_t appId, uint32_t appVersion,
       std::shared_ptr<const std::vector<uint8_t>> nanoappBinary) = 0;
 
   /**
@@ -16,10 +16,20 @@
 
 #include "chre_host/log_message_parser.h"
 
+#include <dirent.h>
+#include <elf.h>
 #include <endian.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <optional>
+#include <string_view>
 
+#include "chre/util/hash.h"
+#include "chre/util/lz_compression.h"
 #include "chre/util/macros.h"
 #include "chre/util/time.h"
 #include "chre_host/daemon_base.h"
@@ -57,9 +67,130 @@ constexpr size_t kSystemTokenizedLogOffset = 1;
 //! payload. The value accounts for the size of the uint8_t logSize field and
 //! the uint16_t instanceId field.
 constexpr size_t kNanoappTokenizedLogOffset = 3;
+//! The number of bytes in a deferred string log entry in addition to the log
+//! payload. The value indicate the size of the uint8_t logSize field.
+constexpr size_t kDeferredStringLogOffset = 1;
+//! The number of bytes of the format string offset of a deferred string log.
+constexpr size_t kDeferredStringFormatOffsetSize = sizeof(int32_t);
 //! This value is used to indicate that a nanoapp does not have a token database
 //! section.
 constexpr uint32_t kInvalidTokenDatabaseSize = 0;
+//! The symbol deferred string log format offsets are relative to.
+constexpr char kLogFormatAnchorSymbol[] = "chreLogFormatAnchor";
+
+//! Header of an entry of the token entries section of a nanoapp binary, see
+//! pw_tokenizer/internal/tokenize_string.h.
+struct TokenEntryHeader {
+  uint32_t magic;
+  uint32_t token;
+  uint32_t domainLength;
+  uint32_t stringLength;
+};
+constexpr uint32_t kTokenEntryMagic = 0xbaa98dee;
+
+//! Header and entry of a binary token database, see
+//! pw_tokenizer/token_database.h.
+struct TokenDatabaseHeader {
+  char magic[6];
+  uint16_t version;
+  uint32_t entryCount;
+  uint32_t reserved;
+};
+struct TokenDatabaseEntry {
+  uint32_t token;
+  uint32_t dateRemoved;
+};
+static_assert(sizeof(TokenDatabaseHeader) == 16);
+constexpr char kTokenDatabaseMagic[] = "TOKENS";
+constexpr uint32_t kTokenDateRemovedNever = 0xffffffff;
+
+/**
+ * Reads the read-only sections and the address of the log format anchor symbol
+ * from an ELF binary of the given class.
+ */
+template <typename ElfEhdr, typename ElfShdr, typename ElfSym,
+          typename ImageSection>
+bool parseElfLogFormatSections(const std::vector<uint8_t> &image,
+                               std::vector<ImageSection> *imageSections,
+                               uint64_t *anchorAddress) {
+  if (image.size() < sizeof(ElfEhdr)) {
+    return false;
+  }
+  ElfEhdr ehdr;
+  memcpy(&ehdr, image.data(), sizeof(ehdr));
+  if (ehdr.e_shoff > image.size() || ehdr.e_shentsize != sizeof(ElfShdr) ||
+      ehdr.e_shnum > (image.size() - ehdr.e_shoff) / sizeof(ElfShdr)) {
+    return false;
+  }
+
+  std::vector<ElfShdr> sections(ehdr.e_shnum);
+  memcpy(sections.data(), image.data() + ehdr.e_shoff,
+         ehdr.e_shnum * sizeof(ElfShdr));
+
+  bool anchorFound = false;
+  for (const ElfShdr &section : sections) {
+    bool inImage = section.sh_offset <= image.size() &&
+                   section.sh_size <= image.size() - section.sh_offset;
+    if (!inImage) {
+      continue;
+    }
+
+    if (section.sh_type == SHT_PROGBITS && (section.sh_flags & SHF_ALLOC) &&
+        !(section.sh_flags & SHF_WRITE) && !(section.sh_flags & SHF_EXECINSTR)) {
+      imageSections->push_back(
+          {section.sh_addr, section.sh_offset, section.sh_size});
+    } else if (section.sh_type == SHT_SYMTAB && !anchorFound &&
+               section.sh_link < sections.size()) {
+      const ElfShdr &strtab = sections[section.sh_link];
+      if (strtab.sh_offset > image.size() ||
+          strtab.sh_size > image.size() - strtab.sh_offset) {
+        continue;
+      }
+      const char *names =
+          reinterpret_cast<const char *>(image.data() + strtab.sh_offset);
+      for (size_t i = 0; i < section.sh_size / sizeof(ElfSym); i++) {
+        ElfSym sym;
+        memcpy(&sym, image.data() + section.sh_offset + i * sizeof(ElfSym),
+               sizeof(sym));
+        if (sym.st_name < strtab.sh_size &&
+            strtab.sh_size - sym.st_name >= sizeof(kLogFormatAnchorSymbol) &&
+            memcmp(&names[sym.st_name], kLogFormatAnchorSymbol,
+                   sizeof(kLogFormatAnchorSymbol)) == 0) {
+          *anchorAddress = sym.st_value;
+          anchorFound = true;
+          break;
+        }
+      }
+    }
+  }
+  return anchorFound;
+}
+
+/**
+ * Reads a varint from a deferred string log argument buffer.
+ */
+bool readVarint(const uint8_t *args, size_t argsSize, size_t *offset,
+                uint64_t *value) {
+  *value = 0;
+  for (uint32_t shift = 0; shift < 64 && *offset < argsSize; shift += 7) {
+    uint8_t byte = args[(*offset)++];
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool readZigzag(const uint8_t *args, size_t argsSize, size_t *offset,
+                int64_t *value) {
+  uint64_t encoded;
+  if (!readVarint(args, argsSize, offset, &encoded)) {
+    return false;
+  }
+  *value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+  return true;
+}
 }  // anonymous namespace
 
 LogMessageParser::LogMessageParser()
@@ -88,9 +219,217 @@ std::unique_ptr<Detokenizer> LogMessageParser::logDetokenizerInit() {
 
 void LogMessageParser::init(size_t nanoappImageHeaderSize) {
   mSystemDetokenizer = logDetokenizerInit();
+  deferredLogFormatsInit();
   mNanoappImageHeaderSize = nanoappImageHeaderSize;
 }
 
+bool LogMessageParser::deferredLogFormatsInit() {
+  // The unstripped CHRE binary, see the log_formats target of
+  // build/build_template.mk.
+  constexpr const char kLogFormatsFilePath[] =
+      "/vendor/etc/chre/libchre_log_formats.elf";
+  std::vector<uint8_t> image;
+  if (!readFileContents(kLogFormatsFilePath, image)) {
+    LOGD("No CHRE log format binary, deferred string logs are not decoded");
+    mSystemImage.clear();
+    mSystemImageSections.clear();
+    return false;
+  }
+  return loadDeferredLogFormats(std::move(image));
+}
+
+bool LogMessageParser::loadDeferredLogFormats(std::vector<uint8_t> image) {
+  mSystemImage = std::move(image);
+  mSystemImageSections.clear();
+
+  bool success = false;
+  if (mSystemImage.size() > EI_CLASS &&
+      memcmp(mSystemImage.data(), ELFMAG, SELFMAG) == 0) {
+    if (mSystemImage[EI_CLASS] == ELFCLASS32) {
+      success = parseElfLogFormatSections<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(
+          mSystemImage, &mSystemImageSections, &mLogFormatAnchorAddress);
+    } else if (mSystemImage[EI_CLASS] == ELFCLASS64) {
+      success = parseElfLogFormatSections<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(
+          mSystemImage, &mSystemImageSections, &mLogFormatAnchorAddress);
+    }
+  }
+
+  if (!success) {
+    LOGE("Failed to parse CHRE log format binary");
+    mSystemImage.clear();
+    mSystemImageSections.clear();
+  }
+  return success;
+}
+
+const char *LogMessageParser::findDeferredLogFormat(int32_t formatOffset) {
+  uint64_t address = mLogFormatAnchorAddress + formatOffset;
+  for (const ImageSection &section : mSystemImageSections) {
+    if (address >= section.address &&
+        address - section.address < section.size) {
+      uint64_t start = section.offset + (address - section.address);
+      uint64_t maxLen = section.size - (address - section.address);
+      const char *format =
+          reinterpret_cast<const char *>(mSystemImage.data() + start);
+      if (strnlen(format, maxLen) < maxLen) {
+        return format;
+      }
+      break;
+    }
+  }
+  return nullptr;
+}
+
+std::optional<std::string> LogMessageParser::formatDeferredLog(
+    const char *format, const uint8_t *args, size_t argsSize) {
+  std::string result;
+  size_t argsOffset = 0;
+  char converted[512];
+  // Any output past the end of converted is truncated, so larger widths and
+  // precisions would not change the result. Bounding them keeps snprintf
+  // from padding to an arbitrary size taken from the log.
+  constexpr int64_t kMaxFieldWidth = sizeof(converted) - 1;
+
+  const char *c = format;
+  while (*c != '\0') {
+    if (*c != '%') {
+      result.push_back(*c++);
+      continue;
+    }
+    if (*(c + 1) == '%') {
+      result.push_back('%');
+      c += 2;
+      continue;
+    }
+
+    // Rebuild the conversion specification, replacing '*' with the encoded
+    // width and precision and the length modifier with one matching the
+    // 64-bit values decoded from the buffer.
+    std::string spec = "%";
+    c++;
+    while (*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0') {
+      spec.push_back(*c++);
+    }
+    for (bool precision = false;; precision = true) {
+      if (*c == '*') {
+        int64_t value;
+        if (!readZigzag(args, argsSize, &argsOffset, &value) ||
+            value < INT32_MIN || value > INT32_MAX) {
+          return std::nullopt;
+        }
+        if (precision && value < 0) {
+          // A negative precision is taken as if it were omitted.
+          spec.pop_back();
+        } else {
+          spec += std::to_string(
+              std::clamp(value, -kMaxFieldWidth, kMaxFieldWidth));
+        }
+        c++;
+      }
+      while (*c >= '0' && *c <= '9') {
+        spec.push_back(*c++);
+      }
+      if (precision || *c != '.') {
+        break;
+      }
+      spec.push_back(*c++);
+    }
+    while (*c == 'h' || *c == 'l' || *c == 'j' || *c == 'z' || *c == 't' ||
+           *c == 'L') {
+      c++;
+    }
+
+    char conversion = *c;
+    if (conversion == '\0') {
+      return std::nullopt;
+    }
+    c++;
+    int convertedLen = -1;
+    switch (conversion) {
+      case 'd':
+      case 'i': {
+        int64_t value;
+        if (!readZigzag(args, argsSize, &argsOffset, &value)) {
+          return std::nullopt;
+        }
+        spec += "lld";
+        convertedLen = snprintf(converted, sizeof(converted), spec.c_str(),
+                                static_cast<long long>(value));
+        break;
+      }
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+      case 'p': {
+        uint64_t value;
+        if (!readVarint(args, argsSize, &argsOffset, &value)) {
+          return std::nullopt;
+        }
+        if (conversion == 'c') {
+          spec.push_back('c');
+          convertedLen = snprintf(converted, sizeof(converted), spec.c_str(),
+                                  static_cast<int>(value));
+        } else if (conversion == 'p') {
+          spec += "llx";
+          result += "0x";
+          convertedLen = snprintf(converted, sizeof(converted), spec.c_str(),
+                                  static_cast<unsigned long long>(value));
+        } else {
+          spec += "ll";
+          spec.push_back(conversion);
+          convertedLen = snprintf(converted, sizeof(converted), spec.c_str(),
+                                  static_cast<unsigned long long>(value));
+        }
+        break;
+      }
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        double value;
+        if (argsSize - argsOffset < sizeof(value)) {
+          return std::nullopt;
+        }
+        memcpy(&value, &args[argsOffset], sizeof(value));
+        argsOffset += sizeof(value);
+        spec.push_back(conversion);
+        convertedLen =
+            snprintf(converted, sizeof(converted), spec.c_str(), value);
+        break;
+      }
+      case 's': {
+        const char *value = reinterpret_cast<const char *>(&args[argsOffset]);
+        size_t valueLen = strnlen(value, argsSize - argsOffset);
+        if (valueLen == argsSize - argsOffset) {
+          return std::nullopt;
+        }
+        argsOffset += valueLen + 1;
+        spec.push_back('s');
+        convertedLen =
+            snprintf(converted, sizeof(converted), spec.c_str(), value);
+        break;
+      }
+      default:
+        return std::nullopt;
+    }
+    if (convertedLen < 0) {
+      return std::nullopt;
+    }
+    result += converted;
+  }
+
+  if (argsOffset != argsSize) {
+    return std::nullopt;
+  }
+  return result;
+}
+
 void LogMessageParser::dump(const uint8_t *buffer, size_t size) {
   if (mVerboseLoggingEnabled) {
     char line[32];
@@ -170,8 +509,9 @@ void LogMessageParser::log(const uint8_t *logBuffer, size_t logBufferSize) {
 }
 
 std::optional<size_t>
-LogMessageParser::parseAndEmitTokenizedLogMessageAndGetSize(
-    const LogMessageV2 *message, size_t maxLogMessageLen) {
+LogMessageParser::parseAndDecodeTokenizedLogMessageAndGetSize(
+    const LogMessageV2 *message, size_t maxLogMessageLen,
+    std::vector<DecodedLog> &decodedLogs) {
   auto detokenizer = mSystemDetokenizer.get();
   auto *encodedLog = reinterpret_cast<const EncodedLog *>(message->logMessage);
   size_t logMessageSize = encodedLog->size + kSystemTokenizedLogOffset;
@@ -181,9 +521,9 @@ LogMessageParser::parseAndEmitTokenizedLogMessageAndGetSize(
   } else if (detokenizer != nullptr) {
     DetokenizedString detokenizedString =
         detokenizer->Detokenize(encodedLog->data, encodedLog->size);
-    std::string decodedString = detokenizedString.BestStringWithErrors();
-    emitLogMessage(getLogLevelFromMetadata(message->metadata),
-                   le32toh(message->timestampMillis), decodedString.c_str());
+    decodedLogs.push_back({getLogLevelFromMetadata(message->metadata),
+                           le32toh(message->timestampMillis),
+                           detokenizedString.BestStringWithErrors()});
   } else {
     // TODO(b/327515992): Stop decoding and emitting system log messages if
     // detokenizer is null .
@@ -193,9 +533,9 @@ LogMessageParser::parseAndEmitTokenizedLogMessageAndGetSize(
 }
 
 std::optional<size_t>
-LogMessageParser::parseAndEmitNanoappTokenizedLogMessageAndGetSize(
-    const LogMessageV2 *message, size_t maxLogMessageLen) {
-  std::lock_guard<std::mutex> lock(mNanoappMutex);
+LogMessageParser::parseAndDecodeNanoappTokenizedLogMessageAndGetSize(
+    const LogMessageV2 *message, size_t maxLogMessageLen,
+    std::vector<DecodedLog> &decodedLogs) {
   auto *tokenizedLog =
       reinterpret_cast<const NanoappTokenizedLog *>(message->logMessage);
   auto detokenizerIter = mNanoappDetokenizers.find(tokenizedLog->instanceId);
@@ -213,23 +553,66 @@ LogMessageParser::parseAndEmitNanoappTokenizedLogMessageAndGetSize(
     auto detokenizer = detokenizerIter->second.detokenizer.get();
     DetokenizedString detokenizedString =
         detokenizer->Detokenize(tokenizedLog->data, tokenizedLog->size);
-    std::string decodedString = detokenizedString.BestStringWithErrors();
-    emitLogMessage(getLogLevelFromMetadata(message->metadata),
-                   le32toh(message->timestampMillis), decodedString.c_str());
+    decodedLogs.push_back({getLogLevelFromMetadata(message->metadata),
+                           le32toh(message->timestampMillis),
+                           detokenizedString.BestStringWithErrors()});
+  }
+  return logMessageSize;
+}
+
+std::optional<size_t>
+LogMessageParser::parseAndDecodeDeferredStringLogMessageAndGetSize(
+    const LogMessageV2 *message, size_t maxLogMessageLen,
+    std::vector<DecodedLog> &decodedLogs) {
+  if (maxLogMessageLen < kDeferredStringLogOffset) {
+    LOGE("Dropping log due to log message size exceeds the end of log buffer");
+    return std::nullopt;
+  }
+  auto *encodedLog = reinterpret_cast<const EncodedLog *>(message->logMessage);
+  size_t logMessageSize = encodedLog->size + kDeferredStringLogOffset;
+  if (logMessageSize > maxLogMessageLen ||
+      encodedLog->size < kDeferredStringFormatOffsetSize) {
+    LOGE("Dropping log due to log message size exceeds the end of log buffer");
+    return std::nullopt;
+  }
+
+  int32_t formatOffset;
+  memcpy(&formatOffset, encodedLog->data, sizeof(formatOffset));
+  formatOffset = static_cast<int32_t>(le32toh(formatOffset));
+  const char *format = findDeferredLogFormat(formatOffset);
+  std::optional<std::string> formattedLog;
+  if (format != nullptr) {
+    formattedLog = formatDeferredLog(
+        format,
+        reinterpret_cast<const uint8_t *>(encodedLog->data) +
+            kDeferredStringFormatOffsetSize,
+        encodedLog->size - kDeferredStringFormatOffsetSize);
+  }
+
+  if (formattedLog.has_value()) {
+    decodedLogs.push_back({getLogLevelFromMetadata(message->metadata),
+                           le32toh(message->timestampMillis),
+                           std::move(*formattedLog)});
+  } else {
+    LOGE("Unable to format deferred log with format offset %" PRId32,
+         formatOffset);
   }
   return logMessageSize;
 }
 
-std::optional<size_t> LogMessageParser::parseAndEmitStringLogMessageAndGetSize(
-    const LogMessageV2 *message, size_t maxLogMessageLen) {
+std::optional<size_t>
+LogMessageParser::parseAndDecodeStringLogMessageAndGetSize(
+    const LogMessageV2 *message, size_t maxLogMessageLen,
+    std::vector<DecodedLog> &decodedLogs) {
   maxLogMessageLen = maxLogMessageLen - kStringLogOverhead;
   size_t logMessageSize = strnlen(message->logMessage, maxLogMessageLen);
   if (message->logMessage[logMessageSize] != '\0') {
     LOGE("Dropping string log due to invalid buffer structure");
     return std::nullopt;
   }
-  emitLogMessage(getLogLevelFromMetadata(message->metadata),
-                 le32toh(message->timestampMillis), message->logMessage);
+  decodedLogs.push_back({getLogLevelFromMetadata(message->metadata),
+                         le32toh(message->timestampMillis),
+                         std::string(message->logMessage, logMessageSize)});
   return logMessageSize + kStringLogOverhead;
 }
 
@@ -260,14 +643,84 @@ void LogMessageParser::emitLogMessage(uint8_t level, uint32_t timestampMillis,
 
 void LogMessageParser::logV2(const uint8_t *logBuffer, size_t logBufferSize,
                              uint32_t numLogsDropped) {
-  constexpr size_t kLogHeaderSize = sizeof(LogMessageV2);
-
   updateAndPrintDroppedLogs(numLogsDropped);
 
+  // Logs decoded before a corrupted log message are still emitted.
+  std::vector<DecodedLog> decodedLogs;
+  decodeLogsV2(logBuffer, logBufferSize, decodedLogs, /* emitLogs= */ true);
+}
+
+void LogMessageParser::emitDecodedLogs(std::vector<DecodedLog> &decodedLogs) {
+  for (const DecodedLog &log : decodedLogs) {
+    emitLogMessage(log.level, log.timestampMillis, log.message.c_str());
+  }
+  decodedLogs.clear();
+}
+
+void LogMessageParser::logV3(const uint8_t *logBuffer, size_t logBufferSize,
+                             ::chre::fbs::LogCompression compression,
+                             uint32_t uncompressedSize,
+                             uint32_t numLogsDropped) {
+  std::optional<std::vector<uint8_t>> decompressedBuffer = decompressLogBuffer(
+      logBuffer, logBufferSize, compression, uncompressedSize);
+  if (!decompressedBuffer.has_value()) {
+    LOGE("Dropping %zu bytes of %s compressed logs", logBufferSize,
+         ::chre::fbs::EnumNameLogCompression(compression));
+    updateAndPrintDroppedLogs(numLogsDropped);
+    return;
+  }
+  logV2(decompressedBuffer->data(), decompressedBuffer->size(),
+        numLogsDropped);
+}
+
+std::optional<std::vector<uint8_t>> LogMessageParser::decompressLogBuffer(
+    const uint8_t *logBuffer, size_t logBufferSize,
+    ::chre::fbs::LogCompression compression, uint32_t uncompressedSize) {
+  switch (compression) {
+    case ::chre::fbs::LogCompression::NONE:
+      return std::vector<uint8_t>(logBuffer, logBuffer + logBufferSize);
+
+    case ::chre::fbs::LogCompression::LZ4_BLOCK: {
+      // The hub never compresses more than a log buffer, so a larger size can
+      // only come from a corrupted message.
+      if (uncompressedSize > ::chre::LzCompressor::kMaxInputSize) {
+        return std::nullopt;
+      }
+      std::vector<uint8_t> decompressedBuffer(uncompressedSize);
+      size_t decompressedSize = 0;
+      if (!::chre::lzDecompress(logBuffer, logBufferSize,
+                                decompressedBuffer.data(),
+                                decompressedBuffer.size(), &decompressedSize) ||
+          decompressedSize != uncompressedSize) {
+        return std::nullopt;
+      }
+      return decompressedBuffer;
+    }
+
+    default:
+      return std::nullopt;
+  }
+}
+
+bool LogMessageParser::decodeLogsV2(const uint8_t *logBuffer,
+                                    size_t logBufferSize,
+                                    std::vector<DecodedLog> &decodedLogs) {
+  return decodeLogsV2(logBuffer, logBufferSize, decodedLogs,
+                      /* emitLogs= */ false);
+}
+
+bool LogMessageParser::decodeLogsV2(const uint8_t *logBuffer,
+                                    size_t logBufferSize,
+                                    std::vector<DecodedLog> &decodedLogs,
+                                    bool emitLogs) {
+  constexpr size_t kLogHeaderSize = sizeof(LogMessageV2);
+
+  std::lock_guard<std::mutex> lock(mNanoappMutex);
   std::optional<size_t> logMessageSize = std::nullopt;
   size_t bufferIndex = 0;
   const LogMessageV2 *message = nullptr;
   size_t maxLogMessageLen = 0;
+  bool success = true;
   while (bufferIndex + kLogHeaderSize <= logBufferSize) {
     message = reinterpret_cast<const LogMessageV2 *>(&logBuffer[bufferIndex]);
     maxLogMessageLen = (logBufferSize - bufferIndex) - kLogHeaderSize;
@@ -276,20 +729,29 @@ void LogMessageParser::logV2(const uint8_t *logBuffer, size_t logBufferSize,
     switch (extractLogType(message)) {
       // TODO(b/336467722): Rename the log types in fbs.
       case LogType::STRING:
-        logMessageSize =
-            parseAndEmitStringLogMessageAndGetSize(message, maxLogMessageLen);
+        logMessageSize = parseAndDecodeStringLogMessageAndGetSize(
+            message, maxLogMessageLen, decodedLogs);
         break;
       case LogType::TOKENIZED:
-        logMessageSize = parseAndEmitTokenizedLogMessageAndGetSize(
-            message, maxLogMessageLen);
+        logMessageSize = parseAndDecodeTokenizedLogMessageAndGetSize(
+            message, maxLogMessageLen, decodedLogs);
         break;
       case LogType::BLUETOOTH:
+        // Emit the logs preceding the BT snoop log first so that both are
+        // output in the order they were logged.
+        if (emitLogs) {
+          emitDecodedLogs(decodedLogs);
+        }
         logMessageSize =
             mBtLogParser.log(message->logMessage, maxLogMessageLen);
         break;
       case LogType::NANOAPP_TOKENIZED:
-        logMessageSize = parseAndEmitNanoappTokenizedLogMessageAndGetSize(
-            message, maxLogMessageLen);
+        logMessageSize = parseAndDecodeNanoappTokenizedLogMessageAndGetSize(
+            message, maxLogMessageLen, decodedLogs);
+        break;
+      case LogType::DEFERRED_STRING:
+        logMessageSize = parseAndDecodeDeferredStringLogMessageAndGetSize(
+            message, maxLogMessageLen, decodedLogs);
         break;
       default:
         LOGE("Unexpected log type 0x%" PRIx8,
@@ -298,82 +760,251 @@ void LogMessageParser::logV2(const uint8_t *logBuffer, size_t logBufferSize,
     }
     if (!logMessageSize.has_value()) {
       LOGE("Log message at offset %zu is corrupted, aborting...", bufferIndex);
-      return;
+      success = false;
+      break;
     }
     bufferIndex += kLogHeaderSize + logMessageSize.value();
   }
+
+  if (emitLogs) {
+    emitDecodedLogs(decodedLogs);
+  }
+  return success;
 }
 
 void LogMessageParser::addNanoappDetokenizer(uint64_t appId,
                                              uint16_t instanceId,
                                              uint64_t databaseOffset,
                                              size_t databaseSize) {
-  std::shared_ptr<const std::vector<uint8_t>> appBinary =
-      fetchNanoappBinary(appId);
-  if (!appBinary) {
+  std::vector<uint8_t> tokenDatabase;
+  if (databaseSize != kInvalidTokenDatabaseSize) {
+    tokenDatabase = getNanoappTokenDatabase(appId, databaseOffset, databaseSize);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mNanoappMutex);
+    removeNanoappDetokenizerLocked(appId);
+    // The binary is only needed to extract the token database.
+    mNanoappAppIdToBinary.erase(appId);
+  }
+
+  if (!tokenDatabase.empty()) {
+    pw::tokenizer::TokenDatabase database =
+        pw::tokenizer::TokenDatabase::Create(tokenDatabase);
+    if (database.ok()) {
+      registerDetokenizer(appId, instanceId,
+                          std::make_unique<Detokenizer>(database));
+    } else {
+      LOGE("Invalid log token database for app with ID: 0x%016" PRIx64,
+           appId);
+    }
+  }
+}
+
+std::vector<uint8_t> LogMessageParser::getNanoappTokenDatabase(
+    uint64_t appId, uint64_t databaseOffset, size_t databaseSize) {
+  std::vector<uint8_t> tokenDatabase;
+  std::optional<PendingNanoappBinary> appBinary = fetchNanoappBinary(appId);
+  if (!appBinary.has_value()) {
     LOGE(
         "Binary not in cache, can't extract log token database for app ID "
         "0x%016" PRIx64,
         appId);
-  } else {
-    removeNanoappDetokenizerAndBinary(appId);
-    if (databaseSize != kInvalidTokenDatabaseSize) {
-      if (checkTokenDatabaseOverflow(databaseOffset, databaseSize,
-                                     appBinary->size())) {
-        LOGE(
-            "Token database fails memory bounds check for nanoapp with app ID "
-            "0x%016" PRIx64 ". Token database offset received: %" PRIu32
-            "; size received: %zu; Size of the appBinary: %zu.",
-            appId, databaseOffset, databaseSize, appBinary->size());
-      } else {
-        const uint8_t *tokenDatabaseBinaryStart =
-            appBinary->data() + kImageHeaderSize + databaseOffset;
-
-        pw::span<const uint8_t> tokenEntries(tokenDatabaseBinaryStart,
-                                             databaseSize);
-        pw::Result<Detokenizer> nanoappDetokenizer =
-            pw::tokenizer::Detokenizer::FromElfSection(tokenEntries);
-
-        registerDetokenizer(appId, instanceId, std::move(nanoappDetokenizer));
+    return tokenDatabase;
+  }
+
+  const std::vector<uint8_t> &binary = *appBinary->binary;
+  if (binary.size() < kImageHeaderSize ||
+      checkTokenDatabaseOverflow(databaseOffset, databaseSize,
+                                 binary.size() - kImageHeaderSize)) {
+    LOGE(
+        "Token database fails memory bounds check for nanoapp with app ID "
+        "0x%016" PRIx64 ". Token database offset received: %" PRIu64
+        "; size received: %zu; Size of the appBinary: %zu.",
+        appId, databaseOffset, databaseSize, binary.size());
+    return tokenDatabase;
+  }
+  const uint8_t *section = binary.data() + kImageHeaderSize + databaseOffset;
+
+  // Nanoapps under development are often rebuilt without changing their
+  // version, so the cached database is looked up by the content of the token
+  // section as well. Hashing the section is much cheaper than parsing it.
+  std::string cachePath =
+      getTokenDatabaseCachePath(appId, appBinary->appVersion,
+                                ::chre::fnv1a32Hash(section, databaseSize));
+  if (readFileContents(cachePath.c_str(), tokenDatabase)) {
+    return tokenDatabase;
+  }
+  tokenDatabase.clear();
+
+  std::optional<std::vector<uint8_t>> builtDatabase =
+      buildTokenDatabase(section, databaseSize);
+  if (!builtDatabase.has_value()) {
+    LOGE("Unable to parse log token database for app with ID: 0x%016" PRIx64,
+         appId);
+    return tokenDatabase;
+  }
+  tokenDatabase = std::move(*builtDatabase);
+
+  // Write to a temporary file first so a partially written database is never
+  // picked up.
+  mkdir(cachePath.substr(0, cachePath.rfind('/')).c_str(), 0770);
+  removeStaleTokenDatabases(cachePath);
+  std::string tempPath = cachePath + ".tmp";
+  std::ofstream cacheFile(tempPath, std::ios::binary | std::ios::trunc);
+  cacheFile.write(reinterpret_cast<const char *>(tokenDatabase.data()),
+                  tokenDatabase.size());
+  cacheFile.close();
+  if (!cacheFile || rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+    LOGW("Unable to cache log token database at %s", cachePath.c_str());
+    unlink(tempPath.c_str());
+  }
+  return tokenDatabase;
+}
+
+std::optional<std::vector<uint8_t>> LogMessageParser::buildTokenDatabase(
+    const uint8_t *section, size_t sectionSize) {
+  struct TokenEntry {
+    uint32_t token;
+    std::string_view string;
+  };
+  std::vector<TokenEntry> entries;
+
+  size_t offset = 0;
+  while (offset + sizeof(TokenEntryHeader) <= sectionSize) {
+    TokenEntryHeader header;
+    memcpy(&header, section + offset, sizeof(header));
+    offset += sizeof(header);
+    if (le32toh(header.magic) != kTokenEntryMagic) {
+      return std::nullopt;
+    }
+    uint32_t domainLength = le32toh(header.domainLength);
+    uint32_t stringLength = le32toh(header.stringLength);
+    if (domainLength > sectionSize - offset ||
+        stringLength > sectionSize - offset - domainLength) {
+      return std::nullopt;
+    }
+    offset += domainLength;
+    const char *string = reinterpret_cast<const char *>(section + offset);
+    entries.push_back({le32toh(header.token),
+                       std::string_view(string, strnlen(string, stringLength))});
+    offset += stringLength;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const TokenEntry &lhs, const TokenEntry &rhs) {
+              return lhs.token < rhs.token ||
+                     (lhs.token == rhs.token && lhs.string < rhs.string);
+            });
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const TokenEntry &lhs, const TokenEntry &rhs) {
+                              return lhs.token == rhs.token &&
+                                     lhs.string == rhs.string;
+                            }),
+                entries.end());
+
+  // See pw_tokenizer/token_database.h for the binary token database format.
+  size_t stringsSize = 0;
+  for (const TokenEntry &entry : entries) {
+    stringsSize += entry.string.size() + 1;
+  }
+  std::vector<uint8_t> database;
+  database.reserve(sizeof(TokenDatabaseHeader) +
+                   entries.size() * sizeof(TokenDatabaseEntry) + stringsSize);
+
+  TokenDatabaseHeader header = {};
+  memcpy(header.magic, kTokenDatabaseMagic, sizeof(header.magic));
+  header.entryCount = htole32(static_cast<uint32_t>(entries.size()));
+  auto *headerBytes = reinterpret_cast<const uint8_t *>(&header);
+  database.insert(database.end(), headerBytes, headerBytes + sizeof(header));
+
+  for (const TokenEntry &entry : entries) {
+    TokenDatabaseEntry databaseEntry = {
+        .token = htole32(entry.token),
+        .dateRemoved = htole32(kTokenDateRemovedNever),
+    };
+    auto *entryBytes = reinterpret_cast<const uint8_t *>(&databaseEntry);
+    database.insert(database.end(), entryBytes,
+                    entryBytes + sizeof(databaseEntry));
+  }
+  for (const TokenEntry &entry : entries) {
+    database.insert(database.end(), entry.string.begin(), entry.string.end());
+    database.push_back('\0');
+  }
+  return database;
+}
+
+std::string LogMessageParser::getTokenDatabaseCachePath(uint64_t appId,
+                                                        uint32_t appVersion,
+                                                        uint32_t sectionHash) {
+  char fileName[48];
+  snprintf(fileName, sizeof(fileName),
+           "/%016" PRIx64 "_%08" PRIx32 "_%08" PRIx32 ".bin", appId, appVersion,
+           sectionHash);
+  std::lock_guard<std::mutex> lock(mNanoappMutex);
+  return mTokenDatabaseCacheDir + fileName;
+}
+
+void LogMessageParser::removeStaleTokenDatabases(
+    const std::string &cachePath) {
+  // Cache file names start with the app ID, see getTokenDatabaseCachePath().
+  size_t nameStart = cachePath.rfind('/') + 1;
+  std::string cacheDir = cachePath.substr(0, nameStart);
+  std::string fileName = cachePath.substr(nameStart);
+  std::string appIdPrefix = fileName.substr(0, fileName.find('_') + 1);
+
+  DIR *dir = opendir(cacheDir.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+  for (struct dirent *entry; (entry = readdir(dir)) != nullptr;) {
+    std::string_view entryName(entry->d_name);
+    if (entryName.substr(0, appIdPrefix.size()) == appIdPrefix &&
+        entryName != fileName) {
+      std::string stalePath = cacheDir + entry->d_name;
+      if (unlink(stalePath.c_str()) != 0) {
+        LOGW("Unable to remove stale log token database %s",
+             stalePath.c_str());
       }
     }
   }
+  closedir(dir);
 }
 
 void LogMessageParser::registerDetokenizer(
     uint64_t appId, uint16_t instanceId,
-    pw::Result<Detokenizer> nanoappDetokenizer) {
+    std::unique_ptr<Detokenizer> nanoappDetokenizer) {
   std::lock_guard<std::mutex> lock(mNanoappMutex);
-
-  if (nanoappDetokenizer.ok()) {
-    NanoappDetokenizer detokenizer;
-    detokenizer.appId = appId;
-    detokenizer.detokenizer =
-        std::make_unique<Detokenizer>(std::move(*nanoappDetokenizer));
-    mNanoappDetokenizers[instanceId] = std::move(detokenizer);
-  } else {
-    LOGE("Unable to parse log detokenizer for app with ID: 0x%016" PRIx64,
-         appId);
-  }
+  NanoappDetokenizer detokenizer;
+  detokenizer.appId = appId;
+  detokenizer.detokenizer = std::move(nanoappDetokenizer);
+  mNanoappDetokenizers[instanceId] = std::move(detokenizer);
 }
 
-std::shared_ptr<const std::vector<uint8_t>>
+std::optional<LogMessageParser::PendingNanoappBinary>
 LogMessageParser::fetchNanoappBinary(uint64_t appId) {
   std::lock_guard<std::mutex> lock(mNanoappMutex);
   auto appBinaryIter = mNanoappAppIdToBinary.find(appId);
   if (appBinaryIter != mNanoappAppIdToBinary.end()) {
     return appBinaryIter->second;
   }
-  return nullptr;
+  return std::nullopt;
 }
 
-void LogMessageParser::removeNanoappDetokenizerAndBinary(uint64_t appId) {
-  std::lock_guard<std::mutex> lock(mNanoappMutex);
-  for (const auto &item : mNanoappDetokenizers) {
-    if (item.second.appId == appId) {
-      mNanoappDetokenizers.erase(item.first);
+void LogMessageParser::removeNanoappDetokenizerLocked(uint64_t appId) {
+  for (auto iter = mNanoappDetokenizers.begin();
+       iter != mNanoappDetokenizers.end();) {
+    if (iter->second.appId == appId) {
+      iter = mNanoappDetokenizers.erase(iter);
+    } else {
+      ++iter;
     }
   }
+}
+
+void LogMessageParser::removeNanoappDetokenizerAndBinary(uint64_t appId) {
+  std::lock_guard<std::mutex> lock(mNanoappMutex);
+  removeNanoappDetokenizerLocked(appId);
   mNanoappAppIdToBinary.erase(appId);
 }
 
@@ -383,10 +1014,25 @@ void LogMessageParser::resetNanoappDetokenizerState() {
   mNanoappAppIdToBinary.clear();
 }
 
+void LogMessageParser::setTokenDatabaseCacheDir(const std::string &cacheDir) {
+  std::lock_guard<std::mutex> lock(mNanoappMutex);
+  mTokenDatabaseCacheDir = cacheDir;
+}
+
+size_t LogMessageParser::getPendingNanoappBinariesSize() {
+  std::lock_guard<std::mutex> lock(mNanoappMutex);
+  size_t size = 0;
+  for (const auto &item : mNanoappAppIdToBinary) {
+    size += item.second.binary->size();
+  }
+  return size;
+}
+
 void LogMessageParser::onNanoappLoadStarted(
-    uint64_t appId, std::shared_ptr<const std::vector<uint8_t>> nanoappBinary) {
+    uint64_t appId, uint32_t appVersion,
+    std::shared_ptr<const std::vector<uint8_t>> nanoappBinary) {
   std::lock_guard<std::mutex> lock(mNanoappMutex);
-  mNanoappAppIdToBinary[appId] = nanoappBinary;
+  mNanoappAppIdToBinary[appId] = {appVersion, std::move(nanoappBinary)};
 }
 
 void LogMessageParser::onNanoappLoadFailed(uint64_t appId) {
@@ -134,7 +134,8 @@ bool PreloadedNanoappLoader::loadNanoapp(const NanoAppBinaryHeader *appHeader,
     return false;
   }
   if (mNanoappLoadListener != nullptr) {
-    mNanoappLoadListener->onNanoappLoadStarted(appHeader->appId, nanoappBuffer);
+    mNanoappLoadListener->onNanoappLoadStarted(
+        appHeader->appId, appHeader->appVersion, nanoappBuffer);
   }
   // Build the target API version from major and minor.
   uint32_t targetApiVersion = (appHeader->targetChreApiMajorVersion << 24) |
@@ -305,6 +305,14 @@ void HalChreSocketConnection::SocketCallbacks::handleDebugDumpData(
   mCallback->onDebugDumpData(data);
 }
 
+void HalChreSocketConnection::SocketCallbacks::handleStructuredDebugDumpData(
+    const ::chre::fbs::StructuredDebugDumpDataT &data) {
+  std::string str = HostProtocolHost::formatStructuredDebugDump(data);
+  ::chre::fbs::DebugDumpDataT textData;
+  textData.debug_str.assign(str.begin(), str.end());
+  mCallback->onDebugDumpData(textData);
+}
+
 void HalChreSocketConnection::SocketCallbacks::handleDebugDumpResponse(
     const ::chre::fbs::DebugDumpResponseT &response) {
   ALOGV("Got debug dump response, success %d, data count %" PRIu32,
@@ -155,6 +155,8 @@ class HalChreSocketConnection {
     void handleDebugDumpData(const ::chre::fbs::DebugDumpDataT &data) override;
     void handleDebugDumpResponse(
         const ::chre::fbs::DebugDumpResponseT &response) override;
+    void handleStructuredDebugDumpData(
+        const ::chre::fbs::StructuredDebugDumpDataT &data) override;
 
    private:
     HalChreSocketConnection &mParent;
@@ -208,7 +208,8 @@ ScopedAStatus MultiClientContextHubBase::loadNanoapp(
                               (appBinary.targetChreApiMinorVersion << 16);
   auto nanoappBuffer =
       std::make_shared<std::vector<uint8_t>>(appBinary.customBinary);
-  mLogger.onNanoappLoadStarted(appBinary.nanoappId, nanoappBuffer);
+  mLogger.onNanoappLoadStarted(appBinary.nanoappId, appBinary.nanoappVersion,
+                               nanoappBuffer);
   auto transaction = std::make_unique<FragmentedLoadTransaction>(
       transactionId, appBinary.nanoappId, appBinary.nanoappVersion,
       appBinary.flags, targetApiVersion, appBinary.customBinary,
@@ -660,6 +661,13 @@ void MultiClientContextHubBase::handleMessageFromChre(
       onNanoappMessage(*message.AsNanoappMessage());
       break;
     }
+    case fbs::ChreMessage::NanoappMessageBatch: {
+      for (const auto &nanoappMessage :
+           message.AsNanoappMessageBatch()->messages) {
+        onNanoappMessage(*nanoappMessage);
+      }
+      break;
+    }
     case fbs::ChreMessage::MessageDeliveryStatus: {
       onMessageDeliveryStatus(*message.AsMessageDeliveryStatus());
       break;
@@ -672,10 +680,18 @@ void MultiClientContextHubBase::handleMessageFromChre(
       onDebugDumpComplete(*message.AsDebugDumpResponse());
       break;
     }
+    case fbs::ChreMessage::StructuredDebugDumpData: {
+      onStructuredDebugDumpData(*message.AsStructuredDebugDumpData());
+      break;
+    }
     case fbs::ChreMessage::LogMessageV2: {
       handleLogMessageV2(*message.AsLogMessageV2());
       break;
     }
+    case fbs::ChreMessage::LogMessageV3: {
+      handleLogMessageV3(*message.AsLogMessageV3());
+      break;
+    }
     case fbs::ChreMessage::MetricLog: {
       onMetricLog(*message.AsMetricLog());
       break;
@@ -723,6 +739,12 @@ void MultiClientContextHubBase::onDebugDumpData(
   debugDumpAppend(str);
 }
 
+void MultiClientContextHubBase::onStructuredDebugDumpData(
+    const ::chre::fbs::StructuredDebugDumpDataT &data) {
+  std::string str = HostProtocolHost::formatStructuredDebugDump(data);
+  debugDumpAppend(str);
+}
+
 void MultiClientContextHubBase::onDebugDumpComplete(
     const ::chre::fbs::DebugDumpResponseT &response) {
   if (!response.success) {
@@ -1074,6 +1096,14 @@ void MultiClientContextHubBase::handleLogMessageV2(
   mLogger.logV2(logData, logBuffer.size(), numLogsDropped);
 }
 
+void MultiClientContextHubBase::handleLogMessageV3(
+    const ::chre::fbs::LogMessageV3T &logMessage) {
+  const std::vector<int8_t> &logBuffer = logMessage.buffer;
+  auto logData = reinterpret_cast<const uint8_t *>(logBuffer.data());
+  mLogger.logV3(logData, logBuffer.size(), logMessage.compression,
+                logMessage.uncompressed_size, logMessage.num_logs_dropped);
+}
+
 void MultiClientContextHubBase::onMetricLog(
     const ::chre::fbs::MetricLogT &metricMessage) {
   if (mMetricsReporter == nullptr) {
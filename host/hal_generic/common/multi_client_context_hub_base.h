@@ -154,11 +154,14 @@ class MultiClientContextHubBase
   void onMessageDeliveryStatus(
       const ::chre::fbs::MessageDeliveryStatusT &status);
   void onDebugDumpData(const ::chre::fbs::DebugDumpDataT &data);
+  void onStructuredDebugDumpData(
+      const ::chre::fbs::StructuredDebugDumpDataT &data);
   void onDebugDumpComplete(
       const ::chre::fbs::DebugDumpResponseT & /* response */);
   void onMetricLog(const ::chre::fbs::MetricLogT &metricMessage);
   void handleClientDeath(pid_t pid);
   void handleLogMessageV2(const ::chre::fbs::LogMessageV2T &logMessage);
+  void handleLogMessageV3(const ::chre::fbs::LogMessageV3T &logMessage);
 
   /**
    * Enables test mode by unloading all the nanoapps except the system nanoapps.
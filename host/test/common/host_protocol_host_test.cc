@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chre_host/generated/host_messages_generated.h"
+#include "chre_host/host_protocol_host.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace android::chre {
+
+namespace {
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+namespace fbs = ::chre::fbs;
+
+constexpr uint64_t kAppId = 0x0123456789abcdef;
+constexpr uint16_t kInstanceId = 5;
+// v1.2.3, targeting the CHRE API v1.9.
+constexpr uint32_t kAppVersion = 0x01020003;
+constexpr uint32_t kTargetApiVersion = 0x01090000;
+
+class StructuredDebugDumpHandler : public IChreMessageHandlers {
+ public:
+  void handleStructuredDebugDumpData(
+      const fbs::StructuredDebugDumpDataT &data) override {
+    dump = std::make_unique<fbs::StructuredDebugDumpDataT>();
+    dump->max_event_pool_usage = data.max_event_pool_usage;
+    dump->event_pool_size = data.event_pool_size;
+    dump->num_dropped_low_priority_events =
+        data.num_dropped_low_priority_events;
+    dump->wakeup_bucket_cycled_mins_ago = data.wakeup_bucket_cycled_mins_ago;
+    dump->wakeup_bucket_duration_mins = data.wakeup_bucket_duration_mins;
+    dump->nanoapp_heap_allocated_bytes = data.nanoapp_heap_allocated_bytes;
+    dump->nanoapp_heap_peak_allocated_bytes =
+        data.nanoapp_heap_peak_allocated_bytes;
+    dump->nanoapp_heap_allocation_count = data.nanoapp_heap_allocation_count;
+    for (const auto &nanoapp : data.nanoapps) {
+      dump->nanoapps.push_back(
+          std::make_unique<fbs::DebugDumpNanoappT>(*nanoapp));
+    }
+  }
+
+  std::unique_ptr<fbs::StructuredDebugDumpDataT> dump;
+};
+
+//! Encodes a StructuredDebugDumpData message as CHRE does.
+void encodeStructuredDebugDump(flatbuffers::FlatBufferBuilder &builder) {
+  std::vector<int8_t> name = {'s', 'e', 'n', 's', 'o', 'r', '\0'};
+  std::vector<int8_t> vendor = {'G', 'o', 'o', 'g', 'l', 'e', '\0'};
+  std::vector<int8_t> build = {'a', 'b', 'c', '1', '2', '3', '\0'};
+  std::vector<flatbuffers::Offset<fbs::DebugDumpNanoapp>> nanoapps;
+  nanoapps.push_back(fbs::CreateDebugDumpNanoappDirect(
+      builder, kAppId, kInstanceId, kAppVersion, kTargetApiVersion, &name,
+      &vendor, &build, true /*is_system*/, 100 /*allocated_bytes*/,
+      2000 /*peak_allocated_bytes*/, 7 /*max_event_time_ms*/,
+      300 /*total_event_time_ms*/, 4 /*num_wakeups*/,
+      12 /*num_messages_sent*/));
+  auto message = fbs::CreateStructuredDebugDumpDataDirect(
+      builder, 10 /*max_event_pool_usage*/, 96 /*event_pool_size*/,
+      1 /*num_dropped_low_priority_events*/,
+      5 /*wakeup_bucket_cycled_mins_ago*/, 180 /*wakeup_bucket_duration_mins*/,
+      100 /*nanoapp_heap_allocated_bytes*/,
+      2000 /*nanoapp_heap_peak_allocated_bytes*/,
+      3 /*nanoapp_heap_allocation_count*/, &nanoapps);
+  fbs::HostAddress hostAddress(0);
+  builder.Finish(fbs::CreateMessageContainer(
+      builder, fbs::ChreMessage::StructuredDebugDumpData, message.Union(),
+      &hostAddress));
+}
+
+}  // namespace
+
+TEST(HostProtocolHostTest, DecodesStructuredDebugDump) {
+  flatbuffers::FlatBufferBuilder builder;
+  encodeStructuredDebugDump(builder);
+
+  StructuredDebugDumpHandler handler;
+  ASSERT_TRUE(HostProtocolHost::decodeMessageFromChre(
+      builder.GetBufferPointer(), builder.GetSize(), handler));
+  ASSERT_NE(handler.dump, nullptr);
+  EXPECT_EQ(handler.dump->max_event_pool_usage, 10);
+  EXPECT_EQ(handler.dump->event_pool_size, 96);
+  EXPECT_EQ(handler.dump->num_dropped_low_priority_events, 1);
+  EXPECT_EQ(handler.dump->wakeup_bucket_cycled_mins_ago, 5);
+  EXPECT_EQ(handler.dump->wakeup_bucket_duration_mins, 180);
+  EXPECT_EQ(handler.dump->nanoapp_heap_allocation_count, 3);
+  ASSERT_EQ(handler.dump->nanoapps.size(), 1);
+
+  const fbs::DebugDumpNanoappT &nanoapp = *handler.dump->nanoapps[0];
+  EXPECT_EQ(nanoapp.app_id, kAppId);
+  EXPECT_EQ(nanoapp.instance_id, kInstanceId);
+  EXPECT_EQ(nanoapp.version, kAppVersion);
+  EXPECT_TRUE(nanoapp.is_system);
+  EXPECT_STREQ(getStringFromByteVector(nanoapp.name), "sensor");
+  EXPECT_STREQ(getStringFromByteVector(nanoapp.vendor), "Google");
+  EXPECT_STREQ(getStringFromByteVector(nanoapp.build), "abc123");
+  EXPECT_EQ(nanoapp.peak_allocated_bytes, 2000);
+  EXPECT_EQ(nanoapp.total_event_time_ms, 300);
+  EXPECT_EQ(nanoapp.num_messages_sent, 12);
+}
+
+TEST(HostProtocolHostTest, FormatsStructuredDebugDumpAsText) {
+  flatbuffers::FlatBufferBuilder builder;
+  encodeStructuredDebugDump(builder);
+  StructuredDebugDumpHandler handler;
+  ASSERT_TRUE(HostProtocolHost::decodeMessageFromChre(
+      builder.GetBufferPointer(), builder.GetSize(), handler));
+
+  std::string text = HostProtocolHost::formatStructuredDebugDump(*handler.dump);
+  EXPECT_THAT(text, HasSubstr("Nanoapp heap usage: 100 bytes allocated, 2000 "
+                              "peak bytes allocated, count 3\n"));
+  EXPECT_THAT(text, HasSubstr("  Max event pool usage: 10/96\n"));
+  EXPECT_THAT(text, HasSubstr("  Number of low priority events dropped: 1\n"));
+  EXPECT_THAT(text, HasSubstr("  Nanoapp host wakeup tracking: cycled 5 mins "
+                              "ago, bucketDuration=180mins\n"));
+  EXPECT_THAT(text, HasSubstr(" Id=5 0x0123456789abcdef sensor (Google) @ "
+                              "build: abc123 v1.2.3 tgtAPI=1.9\n"));
+  EXPECT_THAT(text, HasSubstr("                   sensor |     100 |    2000 "
+                              "|       7 |     300\n"));
+  EXPECT_THAT(text, HasSubstr("                   sensor |         4 |         "
+                              "12\n"));
+}
+
+TEST(HostProtocolHostTest, FormatsStructuredDebugDumpWithoutNanoapps) {
+  fbs::StructuredDebugDumpDataT data;
+  data.event_pool_size = 96;
+
+  std::string text = HostProtocolHost::formatStructuredDebugDump(data);
+  EXPECT_THAT(text, HasSubstr("  Max event pool usage: 0/96\n"));
+  EXPECT_THAT(text, HasSubstr("\nNanoapps:\n"));
+  EXPECT_THAT(text, Not(HasSubstr("Mem Alloc")));
+}
+
+}  // namespace android::chre
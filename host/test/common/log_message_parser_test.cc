@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <elf.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chre/util/lz_compression.h"
+#include "chre_host/file_stream.h"
+#include "chre_host/log_message_parser.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace android::chre {
+
+namespace {
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::chre::fbs::LogCompression;
+using DecodedLog = LogMessageParser::DecodedLog;
+
+constexpr uint64_t kAppId = 0x0123456789abcdef;
+constexpr uint32_t kAppVersion = 2;
+constexpr uint16_t kInstanceId = 5;
+constexpr size_t kImageHeaderSize = 0x1000;
+constexpr uint8_t kInfoLogLevel = 3;
+
+void appendUint32(std::vector<uint8_t> &buffer, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+//! Appends an entry of a nanoapp token entries section.
+void appendTokenEntry(std::vector<uint8_t> &section, uint32_t token,
+                      const std::string &string) {
+  appendUint32(section, 0xbaa98dee);
+  appendUint32(section, token);
+  appendUint32(section, 1);  // The empty domain with its NULL terminator.
+  appendUint32(section, string.size() + 1);
+  section.push_back('\0');
+  section.insert(section.end(), string.begin(), string.end());
+  section.push_back('\0');
+}
+
+//! Appends a nanoapp tokenized log without arguments to a log buffer.
+void appendNanoappTokenizedLog(std::vector<uint8_t> &buffer,
+                               uint32_t timestampMs, uint32_t token) {
+  buffer.push_back(
+      static_cast<uint8_t>(LogType::NANOAPP_TOKENIZED) << 4 |
+      kInfoLogLevel);
+  appendUint32(buffer, timestampMs);
+  buffer.push_back(static_cast<uint8_t>(kInstanceId));
+  buffer.push_back(static_cast<uint8_t>(kInstanceId >> 8));
+  buffer.push_back(sizeof(token));
+  appendUint32(buffer, token);
+}
+
+std::shared_ptr<std::vector<uint8_t>> makeNanoappBinary(
+    const std::vector<uint8_t> &tokenSection) {
+  auto binary = std::make_shared<std::vector<uint8_t>>(kImageHeaderSize, 0);
+  binary->insert(binary->end(), tokenSection.begin(), tokenSection.end());
+  return binary;
+}
+
+//! Appends a value of any trivially copyable type in host byte order.
+template <typename T>
+void appendRaw(std::vector<uint8_t> &buffer, const T &value) {
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+
+//! Appends a varint deferred string log argument.
+void appendVarint(std::vector<uint8_t> &args, uint64_t value) {
+  while (value >= 0x80) {
+    args.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  args.push_back(static_cast<uint8_t>(value));
+}
+
+//! Appends a zigzag varint deferred string log argument.
+void appendZigzag(std::vector<uint8_t> &args, int64_t value) {
+  appendVarint(args, (static_cast<uint64_t>(value) << 1) ^
+                         static_cast<uint64_t>(value >> 63));
+}
+
+//! Appends a NULL terminated deferred string log argument.
+void appendString(std::vector<uint8_t> &args, const char *value) {
+  args.insert(args.end(), value, value + strlen(value) + 1);
+}
+
+//! Appends a deferred string log whose format is at formatOffset from the
+//! anchor symbol.
+void appendDeferredStringLog(std::vector<uint8_t> &buffer,
+                             uint32_t timestampMs, int32_t formatOffset,
+                             const std::vector<uint8_t> &args) {
+  buffer.push_back(
+      static_cast<uint8_t>(LogType::DEFERRED_STRING) << 4 | kInfoLogLevel);
+  appendUint32(buffer, timestampMs);
+  buffer.push_back(static_cast<uint8_t>(sizeof(formatOffset) + args.size()));
+  appendUint32(buffer, static_cast<uint32_t>(formatOffset));
+  buffer.insert(buffer.end(), args.begin(), args.end());
+}
+
+constexpr Elf64_Addr kRodataAddress = 0x1000;
+constexpr char kAnchorSymbolName[] = "chreLogFormatAnchor";
+
+/**
+ * Builds the smallest ELF64 image the log format parser accepts: a read-only
+ * data section holding the formats, with the anchor symbol at its start, and
+ * the symbol and string tables naming it.
+ */
+std::vector<uint8_t> makeLogFormatImage(const std::vector<uint8_t> &rodata) {
+  std::vector<uint8_t> strtab = {'\0'};
+  strtab.insert(strtab.end(), kAnchorSymbolName,
+                kAnchorSymbolName + sizeof(kAnchorSymbolName));
+
+  std::vector<uint8_t> image(sizeof(Elf64_Ehdr), 0);
+  size_t rodataOffset = image.size();
+  image.insert(image.end(), rodata.begin(), rodata.end());
+  size_t strtabOffset = image.size();
+  image.insert(image.end(), strtab.begin(), strtab.end());
+  size_t symtabOffset = image.size();
+  Elf64_Sym symbols[2] = {};
+  symbols[1].st_name = 1;
+  symbols[1].st_shndx = 1;
+  symbols[1].st_value = kRodataAddress;
+  appendRaw(image, symbols);
+
+  Elf64_Shdr sections[4] = {};
+  sections[1].sh_type = SHT_PROGBITS;
+  sections[1].sh_flags = SHF_ALLOC;
+  sections[1].sh_addr = kRodataAddress;
+  sections[1].sh_offset = rodataOffset;
+  sections[1].sh_size = rodata.size();
+  sections[2].sh_type = SHT_STRTAB;
+  sections[2].sh_offset = strtabOffset;
+  sections[2].sh_size = strtab.size();
+  sections[3].sh_type = SHT_SYMTAB;
+  sections[3].sh_offset = symtabOffset;
+  sections[3].sh_size = sizeof(symbols);
+  sections[3].sh_link = 2;
+  sections[3].sh_entsize = sizeof(Elf64_Sym);
+  size_t sectionHeadersOffset = image.size();
+  appendRaw(image, sections);
+
+  Elf64_Ehdr ehdr = {};
+  memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+  ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+  ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+  ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+  ehdr.e_type = ET_DYN;
+  ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+  ehdr.e_shoff = sectionHeadersOffset;
+  ehdr.e_shentsize = sizeof(Elf64_Shdr);
+  ehdr.e_shnum = 4;
+  memcpy(image.data(), &ehdr, sizeof(ehdr));
+  return image;
+}
+
+//! Formats a deferred string log from its encoded arguments.
+std::optional<std::string> formatDeferredLog(const char *format,
+                                             const std::vector<uint8_t> &args) {
+  return LogMessageParser::formatDeferredLog(format, args.data(), args.size());
+}
+
+class LogMessageParserTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mCacheDir = std::filesystem::path(::testing::TempDir()) /
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(mCacheDir);
+    std::filesystem::create_directories(mCacheDir);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(mCacheDir);
+  }
+
+  std::unique_ptr<LogMessageParser> makeParser() {
+    auto parser = std::make_unique<LogMessageParser>();
+    parser->setTokenDatabaseCacheDir(mCacheDir.string());
+    return parser;
+  }
+
+  std::filesystem::path mCacheDir;
+};
+
+MATCHER_P2(IsDecodedLog, timestampMs, message, "") {
+  return arg.level == kInfoLogLevel && arg.timestampMillis == timestampMs &&
+         arg.message == message;
+}
+}  // namespace
+
+TEST(LogMessageParserStaticTest, BuildTokenDatabaseSortsAndRemovesDuplicates) {
+  std::vector<uint8_t> section;
+  appendTokenEntry(section, 0x30, "third");
+  appendTokenEntry(section, 0x10, "first");
+  appendTokenEntry(section, 0x20, "second");
+  appendTokenEntry(section, 0x10, "first");
+
+  std::optional<std::vector<uint8_t>> database =
+      LogMessageParser::buildTokenDatabase(section.data(), section.size());
+  ASSERT_TRUE(database.has_value());
+
+  std::vector<uint8_t> expected = {'T', 'O', 'K', 'E', 'N', 'S', 0, 0};
+  appendUint32(expected, 3);  // Entry count
+  appendUint32(expected, 0);  // Reserved
+  for (uint32_t token : {0x10, 0x20, 0x30}) {
+    appendUint32(expected, token);
+    appendUint32(expected, 0xffffffff);  // Never removed
+  }
+  for (const char *string : {"first", "second", "third"}) {
+    expected.insert(expected.end(), string, string + strlen(string) + 1);
+  }
+  EXPECT_EQ(*database, expected);
+}
+
+TEST(LogMessageParserStaticTest, BuildTokenDatabaseRejectsCorruptedSection) {
+  std::vector<uint8_t> section;
+  appendTokenEntry(section, 0x10, "first");
+  section[0] ^= 0xff;
+  EXPECT_FALSE(
+      LogMessageParser::buildTokenDatabase(section.data(), section.size())
+          .has_value());
+
+  section.clear();
+  appendTokenEntry(section, 0x10, "first");
+  section.resize(section.size() - 2);
+  EXPECT_FALSE(
+      LogMessageParser::buildTokenDatabase(section.data(), section.size())
+          .has_value());
+}
+
+TEST(LogMessageParserStaticTest, DecompressLogBuffer) {
+  std::vector<uint8_t> logBuffer;
+  for (uint32_t i = 0; i < 100; i++) {
+    appendNanoappTokenizedLog(logBuffer, 1000 + i, 0x1234);
+  }
+  std::vector<uint8_t> compressed(logBuffer.size());
+  ::chre::LzCompressor compressor;
+  size_t compressedSize =
+      compressor.compress(logBuffer.data(), logBuffer.size(),
+                          compressed.data(), compressed.size());
+  ASSERT_GT(compressedSize, 0);
+  ASSERT_LT(compressedSize, logBuffer.size());
+
+  EXPECT_THAT(LogMessageParser::decompressLogBuffer(
+                  compressed.data(), compressedSize, LogCompression::LZ4_BLOCK,
+                  logBuffer.size()),
+              Optional(logBuffer));
+  EXPECT_THAT(LogMessageParser::decompressLogBuffer(
+                  logBuffer.data(), logBuffer.size(), LogCompression::NONE,
+                  logBuffer.size()),
+              Optional(logBuffer));
+
+  // The uncompressed size must match the decompressed buffer.
+  EXPECT_FALSE(LogMessageParser::decompressLogBuffer(
+                   compressed.data(), compressedSize,
+                   LogCompression::LZ4_BLOCK, logBuffer.size() - 1)
+                   .has_value());
+  EXPECT_FALSE(LogMessageParser::decompressLogBuffer(
+                   compressed.data(), compressedSize,
+                   LogCompression::LZ4_BLOCK, logBuffer.size() + 1)
+                   .has_value());
+  EXPECT_FALSE(LogMessageParser::decompressLogBuffer(
+                   compressed.data(), compressedSize,
+                   static_cast<LogCompression>(2), logBuffer.size())
+                   .has_value());
+}
+
+TEST(LogMessageParserStaticTest, FormatDeferredLog) {
+  std::vector<uint8_t> args;
+  appendZigzag(args, -42);
+  appendVarint(args, 0xbeef);
+  appendString(args, "abc");
+  appendRaw(args, 1.5);
+  EXPECT_THAT(formatDeferredLog("%d 0x%04x %s %.2f 100%%", args),
+              Optional(std::string("-42 0xbeef abc 1.50 100%")));
+
+  // '*' width and precision are encoded before the value they apply to. The
+  // string argument is only as long as the precision, as the encoder copies no
+  // more of it.
+  args.clear();
+  appendZigzag(args, 6);
+  appendZigzag(args, 7);
+  appendZigzag(args, 2);
+  appendString(args, "xy");
+  EXPECT_THAT(formatDeferredLog("[%*d] [%.*s]", args),
+              Optional(std::string("[     7] [xy]")));
+
+  // A negative precision is taken as if it were omitted.
+  args.clear();
+  appendZigzag(args, -1);
+  appendString(args, "whole");
+  EXPECT_THAT(formatDeferredLog("%.*s", args), Optional(std::string("whole")));
+
+  // Widths are bounded rather than padding to any size taken from the log.
+  args.clear();
+  appendZigzag(args, INT32_MAX);
+  appendZigzag(args, 1);
+  std::optional<std::string> padded = formatDeferredLog("%*d", args);
+  ASSERT_TRUE(padded.has_value());
+  EXPECT_LT(padded->size(), 1024);
+  EXPECT_EQ(padded->back(), '1');
+}
+
+TEST(LogMessageParserStaticTest, FormatDeferredLogRejectsMalformedArguments) {
+  // A varint whose last byte has the continuation bit set.
+  EXPECT_FALSE(formatDeferredLog("%d", {0x80}).has_value());
+  EXPECT_FALSE(formatDeferredLog("%u", {0xff, 0xff}).has_value());
+  // A string without a NULL terminator.
+  EXPECT_FALSE(formatDeferredLog("%s", {'a', 'b', 'c'}).has_value());
+  // A double shorter than 8 bytes.
+  EXPECT_FALSE(formatDeferredLog("%f", {0, 0, 0, 0}).has_value());
+  // Missing arguments.
+  EXPECT_FALSE(formatDeferredLog("%d %d", {0x02}).has_value());
+  EXPECT_FALSE(formatDeferredLog("%*d", {}).has_value());
+  // A width that does not fit an int.
+  std::vector<uint8_t> args;
+  appendZigzag(args, static_cast<int64_t>(INT32_MAX) + 1);
+  appendZigzag(args, 1);
+  EXPECT_FALSE(formatDeferredLog("%*d", args).has_value());
+  // Incomplete or unsupported conversions.
+  EXPECT_FALSE(formatDeferredLog("%", {}).has_value());
+  EXPECT_FALSE(formatDeferredLog("%n", {0x00}).has_value());
+}
+
+TEST(LogMessageParserStaticTest, DeferredStringLogsAreDecoded) {
+  constexpr char kFirstFormat[] = "value %d of %s";
+  constexpr char kSecondFormat[] = "%.*s!";
+  std::vector<uint8_t> rodata(kFirstFormat,
+                              kFirstFormat + sizeof(kFirstFormat));
+  int32_t secondFormatOffset = static_cast<int32_t>(rodata.size());
+  rodata.insert(rodata.end(), kSecondFormat,
+                kSecondFormat + sizeof(kSecondFormat));
+
+  LogMessageParser parser;
+  ASSERT_TRUE(parser.loadDeferredLogFormats(makeLogFormatImage(rodata)));
+
+  std::vector<uint8_t> logBuffer;
+  std::vector<uint8_t> args;
+  appendZigzag(args, -7);
+  appendString(args, "nine");
+  appendDeferredStringLog(logBuffer, 1000, 0, args);
+  args.clear();
+  appendZigzag(args, 3);
+  appendString(args, "abc");
+  appendDeferredStringLog(logBuffer, 2000, secondFormatOffset, args);
+
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser.decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(1000u, "value -7 of nine"),
+                                       IsDecodedLog(2000u, "abc!")));
+}
+
+TEST(LogMessageParserStaticTest, MalformedDeferredStringLogsAreDropped) {
+  constexpr char kFormat[] = "%d";
+  constexpr char kUnterminatedFormat[] = {'%', 's'};
+  std::vector<uint8_t> rodata(kFormat, kFormat + sizeof(kFormat));
+  int32_t unterminatedFormatOffset = static_cast<int32_t>(rodata.size());
+  rodata.insert(rodata.end(), kUnterminatedFormat,
+                kUnterminatedFormat + sizeof(kUnterminatedFormat));
+
+  LogMessageParser parser;
+  ASSERT_TRUE(parser.loadDeferredLogFormats(makeLogFormatImage(rodata)));
+
+  // Logs with a format or arguments that cannot be read are dropped, and the
+  // logs following them are still decoded.
+  std::vector<uint8_t> logBuffer;
+  appendDeferredStringLog(logBuffer, 1, 0, {0x80});
+  appendDeferredStringLog(logBuffer, 2, static_cast<int32_t>(rodata.size()),
+                          {0x02});
+  appendDeferredStringLog(logBuffer, 3, -1, {0x02});
+  appendDeferredStringLog(logBuffer, 4, unterminatedFormatOffset, {'a', 0});
+  appendDeferredStringLog(logBuffer, 5, INT32_MIN, {0x02});
+  appendDeferredStringLog(logBuffer, 6, 0, {0x02});
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser.decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(6u, "1")));
+
+  // A log whose size goes past the end of the buffer stops decoding.
+  std::vector<uint8_t> truncated;
+  appendDeferredStringLog(truncated, 1, 0, {0x02});
+  truncated.pop_back();
+  decodedLogs.clear();
+  EXPECT_FALSE(
+      parser.decodeLogsV2(truncated.data(), truncated.size(), decodedLogs));
+  EXPECT_TRUE(decodedLogs.empty());
+
+  // As does a log with only its header, or too short to hold a format offset.
+  truncated.resize(sizeof(uint8_t) + sizeof(uint32_t));
+  EXPECT_FALSE(
+      parser.decodeLogsV2(truncated.data(), truncated.size(), decodedLogs));
+  truncated.push_back(2);
+  truncated.insert(truncated.end(), {0, 0});
+  EXPECT_FALSE(
+      parser.decodeLogsV2(truncated.data(), truncated.size(), decodedLogs));
+  EXPECT_TRUE(decodedLogs.empty());
+}
+
+TEST(LogMessageParserStaticTest, MalformedLogFormatImagesAreRejected) {
+  const std::vector<uint8_t> rodata = {'%', 'd', 0};
+  LogMessageParser parser;
+  EXPECT_FALSE(parser.loadDeferredLogFormats({}));
+  EXPECT_FALSE(parser.loadDeferredLogFormats({0x7f, 'E', 'L', 'F'}));
+
+  std::vector<uint8_t> image = makeLogFormatImage(rodata);
+  image[0] = 0;
+  EXPECT_FALSE(parser.loadDeferredLogFormats(image));
+
+  // Section headers past the end of the image.
+  image = makeLogFormatImage(rodata);
+  image.resize(image.size() - sizeof(Elf64_Shdr));
+  EXPECT_FALSE(parser.loadDeferredLogFormats(image));
+
+  // No anchor symbol, because its name is cut short.
+  image = makeLogFormatImage(rodata);
+  auto name = std::search(image.begin(), image.end(), kAnchorSymbolName,
+                          kAnchorSymbolName + sizeof(kAnchorSymbolName));
+  ASSERT_NE(name, image.end());
+  *(name + sizeof(kAnchorSymbolName) - 2) = '\0';
+  EXPECT_FALSE(parser.loadDeferredLogFormats(image));
+
+  // Deferred string logs are not decoded without a log format image.
+  std::vector<uint8_t> logBuffer;
+  appendDeferredStringLog(logBuffer, 1, 0, {0x02});
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser.decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_TRUE(decodedLogs.empty());
+
+  EXPECT_TRUE(parser.loadDeferredLogFormats(makeLogFormatImage(rodata)));
+  EXPECT_TRUE(
+      parser.decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(1u, "1")));
+}
+
+TEST_F(LogMessageParserTest, NanoappBinaryReleasedAfterDetokenizerIsAdded) {
+  std::vector<uint8_t> section;
+  appendTokenEntry(section, 0x1234, "hello");
+  appendTokenEntry(section, 0x5678, "world");
+  auto parser = makeParser();
+
+  parser->onNanoappLoadStarted(kAppId, kAppVersion, makeNanoappBinary(section));
+  EXPECT_GT(parser->getPendingNanoappBinariesSize(), section.size());
+  parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                section.size());
+  EXPECT_EQ(parser->getPendingNanoappBinariesSize(), 0);
+
+  std::vector<uint8_t> logBuffer;
+  appendNanoappTokenizedLog(logBuffer, 1000, 0x5678);
+  appendNanoappTokenizedLog(logBuffer, 2000, 0x1234);
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser->decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(1000u, "world"),
+                                       IsDecodedLog(2000u, "hello")));
+}
+
+TEST_F(LogMessageParserTest, TokenDatabaseCacheSkipsBinaryParsing) {
+  std::vector<uint8_t> section;
+  appendTokenEntry(section, 0x1234, "hello");
+  auto parser = makeParser();
+  parser->onNanoappLoadStarted(kAppId, kAppVersion, makeNanoappBinary(section));
+  parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                section.size());
+
+  std::vector<std::filesystem::path> cacheFiles(
+      std::filesystem::directory_iterator(mCacheDir), {});
+  ASSERT_EQ(cacheFiles.size(), 1);
+  std::vector<uint8_t> cachedDatabase;
+  ASSERT_TRUE(readFileContents(cacheFiles[0].c_str(), cachedDatabase));
+  EXPECT_THAT(
+      LogMessageParser::buildTokenDatabase(section.data(), section.size()),
+      Optional(cachedDatabase));
+
+  // A restarted parser must use the cached database rather than parsing the
+  // token section, which is checked by replacing the cached database with one
+  // decoding the token differently.
+  std::vector<uint8_t> otherSection;
+  appendTokenEntry(otherSection, 0x1234, "cached");
+  std::optional<std::vector<uint8_t>> otherDatabase =
+      LogMessageParser::buildTokenDatabase(otherSection.data(),
+                                           otherSection.size());
+  ASSERT_TRUE(otherDatabase.has_value());
+  {
+    std::ofstream cacheFile(cacheFiles[0], std::ios::binary | std::ios::trunc);
+    cacheFile.write(reinterpret_cast<const char *>(otherDatabase->data()),
+                    otherDatabase->size());
+  }
+  auto restartedParser = makeParser();
+  restartedParser->onNanoappLoadStarted(kAppId, kAppVersion,
+                                        makeNanoappBinary(section));
+  restartedParser->addNanoappDetokenizer(kAppId, kInstanceId,
+                                         /* databaseOffset= */ 0,
+                                         section.size());
+
+  std::vector<uint8_t> logBuffer;
+  appendNanoappTokenizedLog(logBuffer, 1000, 0x1234);
+  std::vector<DecodedLog> decodedLogs;
+  restartedParser->decodeLogsV2(logBuffer.data(), logBuffer.size(),
+                                decodedLogs);
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(1000u, "cached")));
+}
+
+TEST_F(LogMessageParserTest, TokenDatabaseCacheIsKeyedOnTheTokenSection) {
+  std::vector<uint8_t> section;
+  appendTokenEntry(section, 0x1234, "hello");
+  auto parser = makeParser();
+  parser->onNanoappLoadStarted(kAppId, kAppVersion, makeNanoappBinary(section));
+  parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                section.size());
+
+  // A nanoapp rebuilt without changing its version must not use the database
+  // cached for the previous build.
+  std::vector<uint8_t> rebuiltSection;
+  appendTokenEntry(rebuiltSection, 0x1234, "rebuilt");
+  parser->onNanoappLoadStarted(kAppId, kAppVersion,
+                               makeNanoappBinary(rebuiltSection));
+  parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                rebuiltSection.size());
+
+  std::vector<uint8_t> logBuffer;
+  appendNanoappTokenizedLog(logBuffer, 1000, 0x1234);
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser->decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(1000u, "rebuilt")));
+
+  // Nor must a new version of the nanoapp, whose token section is corrupted
+  // here.
+  std::vector<uint8_t> corruptedSection(section.size(), 0);
+  parser->onNanoappLoadStarted(kAppId, kAppVersion + 1,
+                               makeNanoappBinary(corruptedSection));
+  parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                corruptedSection.size());
+  decodedLogs.clear();
+  EXPECT_FALSE(
+      parser->decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_TRUE(decodedLogs.empty());
+}
+
+TEST_F(LogMessageParserTest, TokenDatabaseCacheKeepsOneDatabasePerNanoapp) {
+  constexpr uint64_t kOtherAppId = kAppId + 1;
+  std::vector<uint8_t> section;
+  appendTokenEntry(section, 0x1234, "hello");
+  auto parser = makeParser();
+  parser->onNanoappLoadStarted(kOtherAppId, kAppVersion,
+                               makeNanoappBinary(section));
+  parser->addNanoappDetokenizer(kOtherAppId, kInstanceId + 1,
+                                /* databaseOffset= */ 0, section.size());
+
+  // Each update or rebuild of a nanoapp replaces its cached database.
+  for (uint32_t version = kAppVersion; version < kAppVersion + 3; version++) {
+    std::vector<uint8_t> versionSection;
+    appendTokenEntry(versionSection, version, "hello");
+    parser->onNanoappLoadStarted(kAppId, version,
+                                 makeNanoappBinary(versionSection));
+    parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                  versionSection.size());
+  }
+
+  std::vector<std::filesystem::path> cacheFiles(
+      std::filesystem::directory_iterator(mCacheDir), {});
+  EXPECT_EQ(cacheFiles.size(), 2);
+
+  std::vector<uint8_t> logBuffer;
+  appendNanoappTokenizedLog(logBuffer, 1000, kAppVersion + 2);
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser->decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  EXPECT_THAT(decodedLogs, ElementsAre(IsDecodedLog(1000u, "hello")));
+}
+
+TEST_F(LogMessageParserTest, BatchDecodeOfManyNanoappLogs) {
+  constexpr uint32_t kNumTokens = 200;
+  constexpr size_t kNumLogs = 2000;
+  std::vector<uint8_t> section;
+  for (uint32_t token = 0; token < kNumTokens; token++) {
+    appendTokenEntry(section, token * 7919,
+                     "nanoapp log message number " + std::to_string(token));
+  }
+  auto binary = makeNanoappBinary(section);
+  // Nanoapp binaries hold much more than their token database.
+  binary->resize(binary->size() + 64 * 1024);
+
+  auto parser = makeParser();
+  parser->onNanoappLoadStarted(kAppId, kAppVersion, std::move(binary));
+  parser->addNanoappDetokenizer(kAppId, kInstanceId, /* databaseOffset= */ 0,
+                                section.size());
+  EXPECT_EQ(parser->getPendingNanoappBinariesSize(), 0);
+
+  std::vector<uint8_t> logBuffer;
+  for (size_t i = 0; i < kNumLogs; i++) {
+    appendNanoappTokenizedLog(logBuffer, i, (i % kNumTokens) * 7919);
+  }
+  std::vector<DecodedLog> decodedLogs;
+  EXPECT_TRUE(
+      parser->decodeLogsV2(logBuffer.data(), logBuffer.size(), decodedLogs));
+  ASSERT_EQ(decodedLogs.size(), kNumLogs);
+  for (size_t i = 0; i < kNumLogs; i++) {
+    EXPECT_THAT(decodedLogs[i],
+                IsDecodedLog(static_cast<uint32_t>(i),
+                             "nanoapp log message number " +
+                                 std::to_string(i % kNumTokens)));
+  }
+}
+
+}  // namespace android::chre
@@ -118,6 +118,38 @@ inline uint32_t subFromWord(volatile uint32_t *word, uint32_t arg) {
   return prevValue;
 }
 
+/**
+ * Atomically replace the value of a 32-bit word if it holds an expected value.
+ *
+ * @param word Pointer to a 32-bit word which is to be compared and swapped.
+ * @param expected The value the word is expected to hold.
+ * @param desired The value to store if the word holds the expected value.
+ * @return Value of the 32-bit word before the operation was performed.
+ */
+inline uint32_t compareAndSwapWord(volatile uint32_t *word, uint32_t expected,
+                                   uint32_t desired) {
+  uint32_t prevValue;
+  uint32_t storeFailed;
+
+  do {
+    storeFailed = 0;
+    asm volatile(
+        "ldrex  %0,     [%2] \n"
+        "cmp    %0, %3       \n"
+        "it     eq           \n"
+        "strexeq %1, %4, [%2] \n"
+        : "=&r"(prevValue), "+&r"(storeFailed)
+        : "r"(word), "r"(expected), "r"(desired)
+        : "cc", "memory");
+  } while (storeFailed);
+
+  if (prevValue != expected) {
+    asm volatile("clrex" ::: "memory");
+  }
+
+  return prevValue;
+}
+
 }  // namespace atomic
 
 /**
@@ -211,6 +243,21 @@ class AtomicUint32Base : public AtomicBase<uint32_t> {
   uint32_t sub(uint32_t arg) {
     return atomic::subFromWord(&mValue, arg);
   }
+
+  /**
+   * Atomically replace the stored 32-bit word if it holds the expected value.
+   *
+   * @param expected The value the word is expected to hold. Updated with the
+   *        current value if the swap fails.
+   * @param desired Value to be assigned if the comparison succeeds.
+   * @return true if the stored word was replaced.
+   */
+  bool compareAndSwap(uint32_t &expected, uint32_t desired) {
+    uint32_t prevValue = atomic::compareAndSwapWord(&mValue, expected, desired);
+    bool swapped = (prevValue == expected);
+    expected = prevValue;
+    return swapped;
+  }
 };
 
 }  // namespace chre
@@ -79,6 +79,11 @@ inline uint32_t AtomicUint32::fetch_decrement() {
   return sub(1);
 }
 
+inline bool AtomicUint32::compare_exchange(uint32_t &expected,
+                                           uint32_t desired) {
+  return compareAndSwap(expected, desired);
+}
+
 }  // namespace chre
 
 #endif  // CHRE_PLATFORM_EMBOS_ATOMIC_BASE_IMPL_H_
@@ -32,7 +32,11 @@ bool NanoappLoader::relocateTable(DynamicHeader *dyn, int tag) {
       }
 
       ElfRel *reloc =
-          reinterpret_cast<ElfRel *>(mBinary + getDynEntry(dyn, DT_REL));
+          reinterpret_cast<ElfRel *>(getFileData(getDynEntry(dyn, DT_REL)));
+      if (reloc == nullptr) {
+        LOGE("DT_REL table is not in a load segment");
+        break;
+      }
       size_t relocSize = getDynEntry(dyn, DT_RELSZ);
       size_t nRelocs = relocSize / sizeof(ElfRel);
       LOGV("Relocation %zu entries in DT_REL table", nRelocs);
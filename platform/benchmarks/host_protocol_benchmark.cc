@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "chre/platform/shared/host_protocol_chre.h"
+#include "chre/platform/shared/host_protocol_common.h"
+#include "chre/util/flatbuffers/helpers.h"
+
+namespace chre {
+
+// The handlers of decodeMessageFromHost() are implemented by the platform's
+// host link. They are sinks here so that only the decoding is measured.
+
+void HostMessageHandlers::handleNanoappMessage(
+    uint64_t /* appId */, uint32_t /* messageType */,
+    uint16_t /* hostEndpoint */, const void *messageData,
+    size_t /* messageDataLen */, bool /* isReliable */,
+    uint32_t /* messageSequenceNumber */) {
+  benchmark::DoNotOptimize(messageData);
+}
+
+void HostMessageHandlers::handleMessageDeliveryStatus(
+    uint32_t /* messageSequenceNumber */, uint8_t /* errorCode */) {}
+
+void HostMessageHandlers::handleHubInfoRequest(uint16_t /* hostClientId */) {}
+
+void HostMessageHandlers::handleNanoappListRequest(
+    uint16_t /* hostClientId */) {}
+
+void HostMessageHandlers::handlePulseRequest() {}
+
+void HostMessageHandlers::handleDebugConfiguration(
+    const fbs::DebugConfiguration * /* debugConfiguration */) {}
+
+void HostMessageHandlers::handleLoadNanoappRequest(
+    uint16_t /* hostClientId */, uint32_t /* transactionId */,
+    uint64_t /* appId */, uint32_t /* appVersion */, uint32_t /* appFlags */,
+    uint32_t /* targetApiVersion */, const void * /* buffer */,
+    size_t /* bufferLen */, const char * /* appFileName */,
+    uint32_t /* fragmentId */, size_t /* appBinaryLen */,
+    bool /* respondBeforeStart */) {}
+
+void HostMessageHandlers::handleUnloadNanoappRequest(
+    uint16_t /* hostClientId */, uint32_t /* transactionId */,
+    uint64_t /* appId */, bool /* allowSystemNanoappUnload */) {}
+
+void HostMessageHandlers::handleTimeSyncMessage(int64_t /* offset */) {}
+
+void HostMessageHandlers::handleDebugDumpRequest(uint16_t /* hostClientId */) {
+}
+
+void HostMessageHandlers::handleSettingChangeMessage(
+    fbs::Setting /* setting */, fbs::SettingState /* state */) {}
+
+void HostMessageHandlers::handleSelfTestRequest(uint16_t /* hostClientId */) {}
+
+void HostMessageHandlers::handleNanConfigurationUpdate(bool /* enabled */) {}
+
+namespace {
+
+constexpr uint64_t kAppId = 0x0123456789abcdef;
+constexpr uint32_t kMessageType = 1;
+constexpr uint16_t kHostEndpoint = 0x8001;
+
+//! Space for the fields of a message container around the payload.
+constexpr size_t kMessageOverhead = 128;
+
+void BM_HostProtocolEncodeNanoappMessage(benchmark::State &state) {
+  const size_t payloadSize = static_cast<size_t>(state.range(0));
+  DynamicVector<uint8_t> payload;
+  payload.resize(payloadSize);
+  memset(payload.data(), 0xa5, payloadSize);
+
+  for (auto _ : state) {
+    ChreFlatBufferBuilder builder(payloadSize + kMessageOverhead);
+    HostProtocolCommon::encodeNanoappMessage(builder, kAppId, kMessageType,
+                                             kHostEndpoint, payload.data(),
+                                             payloadSize);
+    benchmark::DoNotOptimize(builder.GetBufferPointer());
+  }
+  state.SetBytesProcessed(state.iterations() * payloadSize);
+}
+BENCHMARK(BM_HostProtocolEncodeNanoappMessage)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(CHRE_MESSAGE_TO_HOST_MAX_SIZE);
+
+void BM_HostProtocolDecodeNanoappMessage(benchmark::State &state) {
+  const size_t payloadSize = static_cast<size_t>(state.range(0));
+  DynamicVector<uint8_t> payload;
+  payload.resize(payloadSize);
+  memset(payload.data(), 0xa5, payloadSize);
+
+  ChreFlatBufferBuilder builder(payloadSize + kMessageOverhead);
+  HostProtocolCommon::encodeNanoappMessage(builder, kAppId, kMessageType,
+                                           kHostEndpoint, payload.data(),
+                                           payloadSize);
+
+  for (auto _ : state) {
+    bool decoded = HostProtocolChre::decodeMessageFromHost(
+        builder.GetBufferPointer(), builder.GetSize());
+    benchmark::DoNotOptimize(decoded);
+  }
+  state.SetBytesProcessed(state.iterations() * payloadSize);
+}
+BENCHMARK(BM_HostProtocolDecodeNanoappMessage)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(CHRE_MESSAGE_TO_HOST_MAX_SIZE);
+
+void BM_HostProtocolEncodeLogMessages(benchmark::State &state) {
+  const size_t logBufferSize = static_cast<size_t>(state.range(0));
+  DynamicVector<uint8_t> logBuffer;
+  logBuffer.resize(logBufferSize);
+  memset(logBuffer.data(), 'a', logBufferSize);
+
+  for (auto _ : state) {
+    ChreFlatBufferBuilder builder(logBufferSize + kMessageOverhead);
+    HostProtocolChre::encodeLogMessagesV2(builder, logBuffer.data(),
+                                          logBufferSize,
+                                          /* numLogsDropped= */ 0);
+    benchmark::DoNotOptimize(builder.GetBufferPointer());
+  }
+  state.SetBytesProcessed(state.iterations() * logBufferSize);
+}
+BENCHMARK(BM_HostProtocolEncodeLogMessages)->Arg(256)->Arg(1024)->Arg(4096);
+
+}  // namespace
+}  // namespace chre
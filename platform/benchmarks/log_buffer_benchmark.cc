@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/platform/shared/log_buffer.h"
+#include "chre/util/lz_compression.h"
+
+namespace chre {
+namespace {
+
+constexpr size_t kBufferSize = 4096;
+
+//! The log of a typical sensor request, with a few formatted arguments.
+constexpr char kLogFormat[] = "Sensor request: type %" PRIu8
+                              " interval %" PRIu64 " latency %" PRIu64
+                              " from instance %" PRIu16;
+
+//! Discards the notifications, the benchmarks drain the buffer themselves.
+class NullLogBufferCallback : public LogBufferCallbackInterface {
+ public:
+  void onLogsReady() override {}
+};
+
+//! A log buffer that only notifies when copyLogs() is called.
+struct LogBufferFixture {
+  LogBufferFixture() {
+    logBuffer.updateNotificationSetting(LogBufferNotificationSetting::NEVER);
+  }
+
+  NullLogBufferCallback callback;
+  uint8_t buffer[kBufferSize];
+  LogBuffer logBuffer{&callback, buffer, kBufferSize};
+};
+
+size_t encodeDeferredLog(uint8_t *buffer, size_t bufferSize,
+                         const char *logFormat, ...) {
+  va_list args;
+  va_start(args, logFormat);
+  size_t size =
+      LogBuffer::encodeDeferredLogVa(logFormat, args, buffer, bufferSize);
+  va_end(args);
+  return size;
+}
+
+void BM_LogBufferHandleLog(benchmark::State &state) {
+  // Shared by the threads, which log concurrently as the CHRE and PAL threads
+  // do.
+  static LogBufferFixture fixture;
+  uint32_t timestampMs = 0;
+
+  // Old logs are dropped once the buffer is full, which is the steady state
+  // of a busy system.
+  for (auto _ : state) {
+    fixture.logBuffer.handleLog(LogBufferLogLevel::INFO, timestampMs++,
+                                kLogFormat, static_cast<uint8_t>(1),
+                                static_cast<uint64_t>(20000000),
+                                static_cast<uint64_t>(0),
+                                static_cast<uint16_t>(3));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogBufferHandleLog)->ThreadRange(1, 4);
+
+void BM_LogBufferHandleDeferredLog(benchmark::State &state) {
+  LogBufferFixture fixture;
+  uint8_t encodedLog[LogBuffer::kDeferredStringLogMaxSize];
+  uint32_t timestampMs = 0;
+
+  for (auto _ : state) {
+    size_t size = encodeDeferredLog(
+        encodedLog, sizeof(encodedLog), kLogFormat, static_cast<uint8_t>(1),
+        static_cast<uint64_t>(20000000), static_cast<uint64_t>(0),
+        static_cast<uint16_t>(3));
+    fixture.logBuffer.handleDeferredLog(LogBufferLogLevel::INFO,
+                                        timestampMs++, encodedLog, size);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogBufferHandleDeferredLog);
+
+void BM_LogBufferCopyLogs(benchmark::State &state) {
+  LogBufferFixture fixture;
+  uint8_t outBuffer[kBufferSize];
+  const size_t logsPerCopy = static_cast<size_t>(state.range(0));
+  uint32_t timestampMs = 0;
+  size_t numLogsDropped;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < logsPerCopy; i++) {
+      fixture.logBuffer.handleLog(LogBufferLogLevel::INFO, timestampMs++,
+                                  kLogFormat, static_cast<uint8_t>(1),
+                                  static_cast<uint64_t>(20000000),
+                                  static_cast<uint64_t>(0),
+                                  static_cast<uint16_t>(3));
+    }
+    state.ResumeTiming();
+
+    size_t bytesCopied = fixture.logBuffer.copyLogs(
+        outBuffer, sizeof(outBuffer), &numLogsDropped);
+    benchmark::DoNotOptimize(bytesCopied);
+  }
+  state.SetItemsProcessed(state.iterations() * logsPerCopy);
+}
+BENCHMARK(BM_LogBufferCopyLogs)->Arg(1)->Arg(8)->Arg(32);
+
+void BM_LogBufferCompressLogs(benchmark::State &state) {
+  // Log lines modeled after a recorded CHRE session, interleaving system and
+  // nanoapp logs.
+  static constexpr const char *kLogCorpus[] = {
+      "Nanoapp 0x476f6f676c00100b sent event 0x%" PRIx16 " to host",
+      "[WIFI] Scan request from nanoapp %" PRIu16 " accepted",
+      "[WIFI] Scan results: %" PRIu8 " APs, %" PRIu32 " ms",
+      "[BLE] Scan started with %" PRIu8 " filters, mode %" PRIu8,
+      "[GNSS] Location update: accuracy %" PRIu32 " m",
+      "Sensor 0x%" PRIx8 " sample rate %" PRIu32 " latency %" PRIu32 " us",
+      "Host awake %" PRIu8 ", pending logs %" PRIu32,
+      "Nanoapp %" PRIu16 " allocated %" PRIu32 " bytes",
+  };
+  constexpr size_t kCorpusSize = sizeof(kLogCorpus) / sizeof(kLogCorpus[0]);
+  LogBufferFixture fixture;
+  uint32_t timestampMs = 123456;
+  for (size_t i = 0; !fixture.logBuffer.logWouldCauseOverflow(64); i++) {
+    timestampMs += i % 3;
+    fixture.logBuffer.handleLog(LogBufferLogLevel::INFO, timestampMs,
+                                kLogCorpus[i % kCorpusSize],
+                                static_cast<uint32_t>(i % 7),
+                                static_cast<uint32_t>(i * 13 % 1000),
+                                static_cast<uint32_t>(i % 5));
+  }
+  uint8_t logData[kBufferSize];
+  size_t numLogsDropped;
+  size_t logDataSize =
+      fixture.logBuffer.copyLogs(logData, sizeof(logData), &numLogsDropped);
+
+  LzCompressor compressor;
+  uint8_t compressed[kBufferSize];
+  size_t compressedSize = 0;
+  for (auto _ : state) {
+    compressedSize = compressor.compress(logData, logDataSize, compressed,
+                                         sizeof(compressed));
+    benchmark::DoNotOptimize(compressedSize);
+  }
+  state.SetBytesProcessed(state.iterations() * logDataSize);
+  state.counters["CompressionRatio"] =
+      static_cast<double>(compressedSize) / logDataSize;
+}
+BENCHMARK(BM_LogBufferCompressLogs);
+
+}  // namespace
+}  // namespace chre
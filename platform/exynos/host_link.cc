@@ -63,11 +63,12 @@ void setTimeSyncRequestTimer(Nanoseconds delay) {
 
 }  // anonymous namespace
 
-void sendDebugDumpResultToHost(uint16_t /*hostClientId*/,
+bool sendDebugDumpResultToHost(uint16_t /*hostClientId*/,
                                const char * /*debugStr*/,
                                size_t /*debugStrSize*/, bool /*complete*/,
                                uint32_t /*dataCount*/) {
   // TODO(b/230134803): Implement this.
+  return false;
 }
 
 HostLinkBase::HostLinkBase() {
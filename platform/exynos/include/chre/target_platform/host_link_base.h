@@ -28,8 +28,10 @@ namespace chre {
 
 /**
  * Helper function to send debug dump result to host.
+ *
+ * @return true if the messages were enqueued to be sent to the host.
  */
-void sendDebugDumpResultToHost(uint16_t hostClientId, const char *debugStr,
+bool sendDebugDumpResultToHost(uint16_t hostClientId, const char *debugStr,
                                size_t debugStrSize, bool complete,
                                uint32_t dataCount);
 
@@ -92,6 +94,25 @@ class HostLinkBase {
     // Implement this.
   }
 
+  /**
+   * Enqueues a V3 log message to be sent to the host.
+   *
+   * @param logMessage Pointer to a buffer that has V2 log messages compressed
+   * in the LZ4 block format
+   *
+   * @param logMessageSize length of the compressed log message buffer
+   *
+   * @param uncompressedSize length of the log message buffer once decompressed
+   *
+   * @param numLogsDropped the number of logs dropped since CHRE started
+   */
+  void sendLogMessageV3(const uint8_t * /*logMessage*/,
+                        size_t /*logMessageSize*/,
+                        size_t /*uncompressedSize*/,
+                        uint32_t /*num_logs_dropped*/) {
+    // Implement this.
+  }
+
  private:
   static constexpr uint32_t kMsgBufferSize = CHRE_MESSAGE_TO_HOST_MAX_SIZE;
   uint8_t mMsgBuffer[kMsgBufferSize] = {0};
@@ -109,6 +109,17 @@ const char *PlatformNanoapp::getAppName() const {
   return (mAppInfo != nullptr) ? mAppInfo->name : "Unknown";
 }
 
+const char *PlatformNanoapp::getAppVendor() const {
+  return (mAppInfo != nullptr) ? mAppInfo->vendor : "Unknown";
+}
+
+const char *PlatformNanoapp::getAppBuildId() const {
+  return (mAppInfo != nullptr && mAppInfo->structMinorVersion >= 2 &&
+          mAppInfo->appVersionString != nullptr)
+             ? mAppInfo->appVersionString
+             : "<undefined>";
+}
+
 bool PlatformNanoappBase::isLoaded() const {
   return (mIsStatic ||
           (mAppBinary != nullptr && mBytesLoaded == mAppBinaryLen) ||
@@ -20,6 +20,10 @@
 #include "chre/platform/shared/memory.h"
 #include "chre/platform/shared/nanoapp_support_lib_dso.h"
 
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+#include "chre/platform/shared/streaming_elf_mapper.h"
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+
 namespace chre {
 
 /**
@@ -111,6 +115,12 @@ class PlatformNanoappBase {
   void *mAppBinary = nullptr;
   size_t mAppBinaryLen = 0;
 
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  //! Maps the binary into its final memory as fragments are received through
+  //! copyNanoappFragment(), used instead of mAppBinary.
+  StreamingElfMapper *mStreamingMapper = nullptr;
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+
   //! Null-terminated ASCII string containing the file name that contains the
   //! app binary to be loaded. This is used over mAppBinary to load the nanoapp
   //! if set.
@@ -37,6 +37,22 @@ namespace {
 #define CHRE_NANOAPP_LOAD_ALIGNMENT 0
 #endif
 
+#if defined(CHRE_NANOAPP_STREAMING_LOAD_ENABLED) && \
+    defined(CHRE_NAPP_AUTHENTICATION_ENABLED)
+// Authentication needs the whole binary, which is never held in memory when
+// it is streamed into its mapping.
+#error "Streaming nanoapp loads is not compatible with authentication"
+#endif
+
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+void destroyStreamingMapper(StreamingElfMapper *mapper) {
+  if (mapper != nullptr) {
+    mapper->~StreamingElfMapper();
+    memoryFreeDram(mapper);
+  }
+}
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+
 const char kDefaultAppVersionString[] = "<undefined>";
 size_t kDefaultAppVersionStringSize = ARRAY_SIZE(kDefaultAppVersionString);
 
@@ -49,6 +65,13 @@ PlatformNanoapp::~PlatformNanoapp() {
     forceDramAccess();
     nanoappBinaryDramFree(mAppBinary);
   }
+
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  if (mStreamingMapper != nullptr) {
+    forceDramAccess();
+    destroyStreamingMapper(mStreamingMapper);
+  }
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
 }
 
 bool PlatformNanoapp::start() {
@@ -114,6 +137,17 @@ uint32_t PlatformNanoapp::getTargetApiVersion() const {
                                : mExpectedTargetApiVersion;
 }
 
+const char *PlatformNanoapp::getAppVendor() const {
+  enableDramAccessIfRequired();
+  return (mAppInfo != nullptr) ? mAppInfo->vendor : "Unknown";
+}
+
+const char *PlatformNanoapp::getAppBuildId() const {
+  // The build ID always extends to the end of its null-terminated string.
+  size_t length;
+  return getAppVersionString(&length);
+}
+
 bool PlatformNanoapp::isSystemNanoapp() const {
   enableDramAccessIfRequired();
   return (mAppInfo != nullptr && mAppInfo->isSystemNanoapp);
@@ -161,6 +195,9 @@ const char *PlatformNanoappBase::getAppVersionString(size_t *length) const {
 bool PlatformNanoappBase::isLoaded() const {
   return (mIsStatic ||
           (mAppBinary != nullptr && mBytesLoaded == mAppBinaryLen) ||
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+          (mStreamingMapper != nullptr && mStreamingMapper->isComplete()) ||
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
           mDsoHandle != nullptr || mAppFilename != nullptr);
 }
 
@@ -182,16 +219,25 @@ bool PlatformNanoappBase::reserveBuffer(uint64_t appId, uint32_t appVersion,
   forceDramAccess();
 
   bool success = false;
+  bool tcmCapable = IS_BIT_SET(appFlags, CHRE_NAPP_HEADER_TCM_CAPABLE);
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  // Only the mapping of the binary is allocated, as fragments are mapped when
+  // they are received.
+  mStreamingMapper =
+      memoryAllocDram<StreamingElfMapper>(appBinaryLen, tcmCapable);
+  void *buffer = mStreamingMapper;
+#else
   mAppBinary =
       nanoappBinaryDramAlloc(appBinaryLen, CHRE_NANOAPP_LOAD_ALIGNMENT);
+  void *buffer = mAppBinary;
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
 
   bool isSigned = IS_BIT_SET(appFlags, CHRE_NAPP_HEADER_SIGNED);
   if (!isSigned) {
     LOGE("Unable to load unsigned nanoapps");
-  } else if (mAppBinary == nullptr) {
+  } else if (buffer == nullptr) {
     LOG_OOM();
   } else {
-    bool tcmCapable = IS_BIT_SET(appFlags, CHRE_NAPP_HEADER_TCM_CAPABLE);
     mExpectedAppId = appId;
     mExpectedAppVersion = appVersion;
     mExpectedTargetApiVersion = targetApiVersion;
@@ -216,9 +262,15 @@ bool PlatformNanoappBase::copyNanoappFragment(const void *buffer,
          bufferLen, mBytesLoaded, mAppBinaryLen);
     success = false;
   } else {
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+    success = mStreamingMapper != nullptr &&
+              mStreamingMapper->append(buffer, bufferLen);
+    mBytesLoaded += bufferLen;
+#else
     uint8_t *binaryBuffer = static_cast<uint8_t *>(mAppBinary) + mBytesLoaded;
     memcpy(binaryBuffer, buffer, bufferLen);
     mBytesLoaded += bufferLen;
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
   }
 
   return success;
@@ -280,6 +332,18 @@ bool PlatformNanoappBase::openNanoapp() {
   bool success = false;
   if (mIsStatic) {
     success = true;
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  } else if (mStreamingMapper != nullptr) {
+    if (mDsoHandle != nullptr) {
+      LOGE("Trying to reopen an existing buffer");
+    } else {
+      mDsoHandle = NanoappLoader::create(*mStreamingMapper);
+      success = verifyNanoappInfo();
+      if (success) {
+        sendTokenDatabaseInfo();
+      }
+    }
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
   } else if (mAppBinary != nullptr) {
     //! The true start of the binary will be after the authentication header.
     //! Use the returned value from authenticateBinary to ensure dlopenbuf has
@@ -306,6 +370,10 @@ bool PlatformNanoappBase::openNanoapp() {
     nanoappBinaryDramFree(mAppBinary);
     mAppBinary = nullptr;
   }
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  destroyStreamingMapper(mStreamingMapper);
+  mStreamingMapper = nullptr;
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
 
   // Save this flag locally since it may be referenced while the system is in
   // TCM-only mode.
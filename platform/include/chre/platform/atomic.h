@@ -166,6 +166,19 @@ class AtomicUint32 : public AtomicUint32Base, public NonCopyable {
    * @return The previous value of the object.
    */
   uint32_t fetch_decrement();
+
+  /**
+   * Atomically compares the current value of the object with expected and, if
+   * they are equal, replaces it with desired. Otherwise, expected is updated
+   * with the current value of the object.
+   *
+   * @param expected The value the object is expected to hold. Updated with the
+   *        current value if the exchange fails.
+   * @param desired The value to store if the comparison succeeds.
+   *
+   * @return true if the value was replaced.
+   */
+  bool compare_exchange(uint32_t &expected, uint32_t desired);
 };
 
 }  // namespace chre
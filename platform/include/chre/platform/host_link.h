@@ -67,6 +67,25 @@ class HostLink : public HostLinkBase, public NonCopyable {
    */
   bool sendMessage(const MessageToHost *message);
 
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+  /**
+   * Enqueues a batch of messages for sending to the host in a single
+   * transaction, e.g. as a NanoappMessageBatch. Each message of the batch must
+   * be handled as if given to sendMessage(), in order, including invoking
+   * HostCommsManager::onMessageToHostComplete once sending it is complete.
+   * Only the first message of the batch may have wokeHost set.
+   *
+   * @param messages A non-null array of non-null pointers to the messages,
+   *        only valid during this call
+   * @param numMessages The number of messages in the batch, at least 1
+   *
+   * @return true if the batch was successfully queued. If false, the caller
+   *         completes the messages itself.
+   */
+  bool sendMessageBatch(const MessageToHost *const *messages,
+                        size_t numMessages);
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
   /**
    * Sends a transaction status to the host.
    *
@@ -42,8 +42,21 @@ class PlatformDebugDumpManager : public PlatformDebugDumpManagerBase,
    * @param debugStr A null-terminated string containing debug data. Must be a
    *        valid pointer, but can be an empty string.
    * @param complete true if no more debug data is expected.
+   *
+   * @return true if the string was enqueued to be sent to the host.
+   */
+  bool sendDebugDump(const char *debugStr, bool complete);
+
+  /**
+   * Sends the state of the event loop, of the nanoapp heap and of the nanoapps
+   * to the host as a StructuredDebugDumpData message, which the host renders
+   * in place of the text these sections otherwise print. Must only be called
+   * from the context of the main CHRE thread.
+   *
+   * @return true if the message was sent, false if structured debug dumps are
+   *         not supported, in which case these sections must be sent as text.
    */
-  void sendDebugDump(const char *debugStr, bool complete);
+  bool sendStructuredDebugDump();
 
   /**
    * A function to log platform-specific debug dumps. Must only be called from
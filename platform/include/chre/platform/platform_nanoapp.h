@@ -104,6 +104,18 @@ class PlatformNanoapp : public PlatformNanoappBase, public NonCopyable {
    */
   const char *getAppName() const;
 
+  /**
+   * Retrieves the human-friendly name of the nanoapp vendor (null-terminated
+   * string).
+   */
+  const char *getAppVendor() const;
+
+  /**
+   * Retrieves the build of the nanoapp as identified by the platform, e.g. from
+   * its version string (null-terminated string).
+   */
+  const char *getAppBuildId() const;
+
   /**
    * Returns true if the nanoapp should not appear in the context hub HAL list
    * of nanoapps, e.g. because it implements some device functionality purely
@@ -24,12 +24,44 @@ void HostLink::flushMessagesSentByNanoapp(uint64_t /* appId */) {
 }
 
 bool HostLink::sendMessage(const MessageToHost *message) {
-  // Just drop the message since we do not have a real host to send the message
-  EventLoopManagerSingleton::get()
-      ->getHostCommsManager()
-      .onMessageToHostComplete(message);
+  HostCommsManager &manager =
+      EventLoopManagerSingleton::get()->getHostCommsManager();
+  if (mMessageLoopbackEnabled && !message->isReliable) {
+    // The message data is retained until the message from the host is
+    // delivered, when the message to the host is completed.
+    auto releaseCallback = [](void *releaseData) {
+      EventLoopManagerSingleton::get()
+          ->getHostCommsManager()
+          .onMessageToHostComplete(static_cast<MessageToHost *>(releaseData));
+    };
+
+    uint16_t hostEndpoint = message->toHostData.hostEndpoint;
+    if (hostEndpoint == kHostEndpointBroadcast) {
+      hostEndpoint = kHostEndpointUnspecified;
+    }
+    manager.sendMessageToNanoappFromHost(
+        message->appId, message->toHostData.messageType, hostEndpoint,
+        message->message.data(), message->message.size(),
+        /* isReliable= */ false, /* messageSequenceNumber= */ 0,
+        releaseCallback, const_cast<MessageToHost *>(message));
+  } else {
+    // Just drop the message since we do not have a real host to send the
+    // message
+    manager.onMessageToHostComplete(message);
+  }
+  return true;
+}
+
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+bool HostLink::sendMessageBatch(const MessageToHost *const *messages,
+                                size_t numMessages) {
+  mNumMessageBatchesSent.fetch_increment();
+  for (size_t i = 0; i < numMessages; i++) {
+    sendMessage(messages[i]);
+  }
   return true;
 }
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
 
 bool HostLink::sendMessageDeliveryStatus(uint32_t /* messageSequenceNumber */,
                                          uint8_t /* errorCode */) {
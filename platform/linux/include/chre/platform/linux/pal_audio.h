@@ -17,9 +17,24 @@
 #ifndef CHRE_PLATFORM_LINUX_PAL_AUDIO_H_
 #define CHRE_PLATFORM_LINUX_PAL_AUDIO_H_
 
+#include <cstdint>
+
+#include "chre_api/chre/audio.h"
+
 /**
  * @return whether handle 0 is active.
  */
 bool chrePalAudioIsHandle0Enabled();
 
+/**
+ * @return the number of audio data events sent for handle 0. Each event holds
+ *         the low byte of the index of each sample, counted from time 0.
+ */
+uint32_t chrePalAudioGetHandle0EventCount();
+
+/**
+ * @return the last audio data event sent for handle 0.
+ */
+const struct chreAudioDataEvent *chrePalAudioGetHandle0LastEvent();
+
 #endif  // CHRE_PLATFORM_LINUX_PAL_AUDIO_H_
\ No newline at end of file
@@ -22,8 +22,10 @@
 #include <mutex>
 #include <optional>
 #include <thread>
+#include <unordered_map>
 
 #include "chre/platform/linux/task_util/task.h"
+#include "chre/platform/linux/virtual_clock.h"
 #include "chre/util/non_copyable.h"
 #include "chre/util/priority_queue.h"
 #include "chre/util/singleton.h"
@@ -36,6 +38,10 @@ using task_manager_internal::Task;
  * A class to manage a thread that executes arbitrary tasks. These tasks can
  * repeat or be a singular execution. The manager will always execute the next
  * task in chronological order.
+ *
+ * If the VirtualClockSingleton is initialized when the manager is created, the
+ * tasks are instead alarms of the virtual clock, executed by the thread that
+ * advances it.
  */
 class TaskManager : public NonCopyable {
  public:
@@ -94,6 +100,26 @@ class TaskManager : public NonCopyable {
    */
   void run();
 
+  /**
+   * Schedules a task as an alarm of the VirtualClock. Must be called with
+   * mMutex held.
+   *
+   * @param taskId                   the ID of the task.
+   * @param func                     the function to call.
+   * @param delay                    the delay before the first execution.
+   * @param repeatInterval           the interval to repeat, or 0 to execute
+   * only once.
+   */
+  void addVirtualTask(uint32_t taskId, const Task::TaskFunction &func,
+                      std::chrono::nanoseconds delay,
+                      std::chrono::nanoseconds repeatInterval);
+
+  /**
+   * Cancels all the tasks scheduled with addVirtualTask(). Must be called with
+   * mMutex held.
+   */
+  void cancelVirtualTasks();
+
   /**
    * The queue of tasks.
    *
@@ -124,6 +150,17 @@ class TaskManager : public NonCopyable {
    */
   uint32_t mCurrentId;
 
+  /**
+   * If true, the tasks are alarms of the VirtualClock instead of being
+   * executed by mThread.
+   */
+  const bool mIsVirtual;
+
+  /**
+   * The ID of the pending VirtualClock alarm of each virtual task.
+   */
+  std::unordered_map<uint32_t, uint32_t> mVirtualAlarmIds;
+
   /**
    * The mutex to protect access to the queue.
    */
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_LINUX_VIRTUAL_CLOCK_H_
+#define CHRE_PLATFORM_LINUX_VIRTUAL_CLOCK_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "chre/util/non_copyable.h"
+#include "chre/util/singleton.h"
+#include "chre/util/time.h"
+
+namespace chre::platform_linux {
+
+/**
+ * A simulated monotonic clock for deterministic simulation tests.
+ *
+ * While the VirtualClockSingleton is initialized, SystemTime, SystemTimer and
+ * the TaskManager use this clock instead of real time: timers and tasks become
+ * alarms at a virtual deadline. Time never passes on its own. When the event
+ * loop is idle, it calls advance() to jump to the earliest deadline and run
+ * its alarm, so hours of simulated timer and PAL traffic run as fast as they
+ * can be processed, in the same order on every run.
+ *
+ * Threads other than the event loop that can produce work (e.g. the thread of
+ * a simulation test) take a hold on the clock while they run, so that time
+ * does not advance in the middle of their work.
+ */
+class VirtualClock : public NonCopyable {
+ public:
+  using AlarmCallback = std::function<void()>;
+
+  //! An alarm ID that is never returned by addAlarm().
+  static constexpr uint32_t kInvalidAlarmId = 0;
+
+  /**
+   * @param startTime The initial time. It is not zero by default, as some
+   *        components treat a timestamp of zero as unset.
+   */
+  explicit VirtualClock(Nanoseconds startTime = Seconds(1))
+      : mNow(startTime) {}
+
+  //! @return The current virtual time.
+  Nanoseconds getTime();
+
+  /**
+   * Schedules a callback to run once the virtual time reaches a deadline.
+   * Alarms with the same deadline run in the order they were added.
+   *
+   * @param deadline The virtual time to run the callback at. A deadline in the
+   *        past runs the callback the next time the clock advances.
+   * @param callback The callback, invoked from the thread calling advance().
+   * @return The ID of the alarm.
+   */
+  uint32_t addAlarm(Nanoseconds deadline, AlarmCallback &&callback);
+
+  /**
+   * @param alarmId The ID of the alarm to cancel.
+   * @return true if the alarm was pending and will not run.
+   */
+  bool cancelAlarm(uint32_t alarmId);
+
+  //! @return true if the alarm has neither run nor been cancelled.
+  bool isAlarmPending(uint32_t alarmId);
+
+  /**
+   * Prevents the time from advancing until a matching call to release().
+   * Holds can be nested and taken on behalf of another thread.
+   */
+  void hold();
+
+  /**
+   * Removes a hold taken with hold(). Invokes the wake callback when the last
+   * hold is removed.
+   */
+  void release();
+
+  /**
+   * Sets the callback invoked when the last hold is released, so that an idle
+   * event loop can wake up and advance the time.
+   *
+   * @param callback The callback, or nullptr to remove it.
+   */
+  void setWakeCallback(AlarmCallback &&callback);
+
+  /**
+   * Advances the time to the earliest deadline and runs its alarm, unless the
+   * clock is held. The alarm callback is invoked from the calling thread,
+   * without any lock held.
+   *
+   * @return true if an alarm ran.
+   */
+  bool advance();
+
+ private:
+  //! The current time.
+  Nanoseconds mNow;
+
+  //! The pending alarms, ordered by deadline and then ID.
+  std::map<std::pair<uint64_t, uint32_t>, AlarmCallback> mAlarms;
+
+  //! The deadline of each pending alarm, by ID.
+  std::unordered_map<uint32_t, uint64_t> mAlarmDeadlines;
+
+  //! The ID of the next alarm.
+  uint32_t mNextAlarmId = kInvalidAlarmId + 1;
+
+  //! The number of holds preventing the time from advancing.
+  uint32_t mNumHolds = 0;
+
+  //! @see setWakeCallback
+  AlarmCallback mWakeCallback;
+
+  //! Protects all the members above.
+  std::mutex mMutex;
+};
+
+//! Initializing the singleton enables the virtual time.
+typedef Singleton<VirtualClock> VirtualClockSingleton;
+
+}  // namespace chre::platform_linux
+
+#endif  // CHRE_PLATFORM_LINUX_VIRTUAL_CLOCK_H_
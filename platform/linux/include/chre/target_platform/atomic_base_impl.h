@@ -75,6 +75,11 @@ inline uint32_t AtomicUint32::fetch_decrement() {
   return mAtomic.fetch_sub(1);
 }
 
+inline bool AtomicUint32::compare_exchange(uint32_t &expected,
+                                           uint32_t desired) {
+  return mAtomic.compare_exchange_strong(expected, desired);
+}
+
 }  // namespace chre
 
 #endif  // CHRE_PLATFORM_LINUX_ATOMIC_BASE_IMPL_H_
@@ -17,6 +17,10 @@
 #ifndef CHRE_PLATFORM_LINUX_HOST_LINK_BASE_H_
 #define CHRE_PLATFORM_LINUX_HOST_LINK_BASE_H_
 
+#include <cstdint>
+
+#include "chre/platform/atomic.h"
+
 namespace chre {
 
 class HostLinkBase {
@@ -30,6 +34,38 @@ class HostLinkBase {
    *        boolean's value.
    */
   void sendNanConfiguration(bool enable);
+
+  /**
+   * Enables or disables the loopback of messages sent to the host by
+   * nanoapps. When enabled, each non-reliable message sent to the host is
+   * delivered back to the nanoapp that sent it as a message from the host,
+   * with the same type and data, and host endpoint
+   * CHRE_HOST_ENDPOINT_UNSPECIFIED if it was broadcast. Its data is not copied:
+   * the message to the host is only completed, and its free callback invoked,
+   * once the nanoapp has handled the message from the host.
+   *
+   * When disabled (the default), messages sent to the host are dropped.
+   *
+   * @param enabled Whether to loop messages back.
+   */
+  void setMessageLoopbackEnabled(bool enabled) {
+    mMessageLoopbackEnabled = enabled;
+  }
+
+  /**
+   * @return The number of batches of messages sent to the host with
+   *         HostLink::sendMessageBatch().
+   */
+  uint32_t getNumMessageBatchesSent() const {
+    return mNumMessageBatchesSent;
+  }
+
+ protected:
+  //! Whether messages sent to the host are looped back to the nanoapps.
+  AtomicBool mMessageLoopbackEnabled{false};
+
+  //! The number of batches of messages sent to the host.
+  AtomicUint32 mNumMessageBatchesSent{0};
 };
 
 }  // namespace chre
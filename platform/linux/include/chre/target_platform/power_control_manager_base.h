@@ -17,9 +17,58 @@
 #ifndef CHRE_PLATFORM_POWER_CONTROL_MANAGER_BASE_H
 #define CHRE_PLATFORM_POWER_CONTROL_MANAGER_BASE_H
 
+#include "chre/core/power_policy.h"
+#include "chre/platform/atomic.h"
+
 namespace chre {
 
-class PowerControlManagerBase {};
+class PowerControlManagerBase {
+ public:
+  /**
+   * Lets the VirtualClock wake up the event loop if it is initialized, so
+   * that the time advances once nothing holds the clock anymore.
+   */
+  PowerControlManagerBase();
+
+  ~PowerControlManagerBase();
+
+  /**
+   * Updates internal wake/suspend flag and pushes awake/sleep notification
+   * to nanoapps that are listening for it. There is no real host on Linux, so
+   * this is how the simulator suspends and wakes it up.
+   *
+   * @param awake true if host is awake, otherwise suspended.
+   */
+  void onHostWakeSuspendEvent(bool awake);
+
+  /**
+   * There is no power state to control on Linux, the simulated one only counts
+   * the changes of state, so power policies can be compared without hardware.
+   *
+   * @return The number of changes between the active and the low-power state
+   *         of the event loop.
+   */
+  uint32_t getNumPowerStateTransitions() {
+    return mNumPowerStateTransitions.load();
+  }
+
+ protected:
+  /** True if the host is awake, false otherwise. */
+  AtomicBool mHostIsAwake{true};
+
+  /** Decides the simulated power state around the processing of events. */
+  PowerPolicy mPowerPolicy;
+
+  /** The number of transitions of mPowerPolicy, readable from any thread. */
+  AtomicUint32 mNumPowerStateTransitions{0};
+
+  /**
+   * Advances the VirtualClock, if it is initialized, until an alarm posts an
+   * event or there is no alarm to run. Must be called from the context of the
+   * main CHRE thread, while the event queue is empty.
+   */
+  void advanceVirtualTime();
+};
 
 }  // namespace chre
 
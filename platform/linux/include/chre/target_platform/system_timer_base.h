@@ -26,7 +26,8 @@ namespace chre {
 
 /**
  * The Linux base class for the SystemTimer. The Linux implementation uses a
- * POSIX timer.
+ * POSIX timer, or an alarm of the VirtualClock if it is initialized when the
+ * timer is.
  */
 class SystemTimerBase {
  protected:
@@ -39,10 +40,17 @@ class SystemTimerBase {
   //! Tracks whether the timer has been initialized correctly.
   bool mInitialized = false;
 
+  //! True if the timer uses the VirtualClock instead of a POSIX timer.
+  bool mIsVirtual = false;
+
+  //! The pending alarm of the VirtualClock, if the timer is virtual.
+  uint32_t mAlarmId = 0;
+
   //! A static method that is invoked by the underlying POSIX timer.
   static void systemTimerNotifyCallback(union sigval cookie);
 
-  //! A utility function to set a POSIX timer.
+  //! A utility function to set a POSIX timer, or the alarm of a virtual timer.
+  //! A delay of 0 disarms the timer.
   bool setInternal(uint64_t delayNs);
 };
 
@@ -22,6 +22,7 @@
 #include "chre/util/memory.h"
 #include "chre/util/unique_ptr.h"
 
+#include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <cstdint>
@@ -42,6 +43,12 @@ constexpr uint32_t kHandle0SampleRate = 16000;
 std::optional<uint32_t> gHandle0TaskId;
 bool gIsHandle0Enabled = false;
 
+//! The number of audio data events sent for handle 0.
+std::atomic<uint32_t> gHandle0EventCount(0);
+
+//! The last audio data event sent for handle 0.
+std::atomic<const struct chreAudioDataEvent *> gHandle0LastEvent(nullptr);
+
 void stopHandle0Task() {
   if (gHandle0TaskId.has_value()) {
     TaskManagerSingleton::get()->cancelTask(gHandle0TaskId.value());
@@ -71,15 +78,28 @@ bool chrePalAudioApiOpen(const struct chrePalSystemApi *systemApi,
 void sendHandle0Events(uint32_t numSamples) {
   auto data = chre::MakeUniqueZeroFill<struct chreAudioDataEvent>();
 
+  // The most recent samples, each holding the low byte of its index counted
+  // from time 0, so that the continuity of the samples can be checked.
+  uint64_t endIndex =
+      gSystemApi->getCurrentTime() * kHandle0SampleRate / 1000000000;
+  uint64_t startIndex = (endIndex > numSamples) ? endIndex - numSamples : 0;
+  auto *samples = static_cast<uint8_t *>(chre::memoryAlloc(numSamples));
+  if (samples != nullptr) {
+    for (uint32_t i = 0; i < numSamples; i++) {
+      samples[i] = static_cast<uint8_t>(startIndex + i);
+    }
+  }
+
   data->version = CHRE_AUDIO_DATA_EVENT_VERSION;
   data->handle = 0;
-  data->timestamp = gSystemApi->getCurrentTime();
+  data->timestamp = startIndex * 1000000000 / kHandle0SampleRate;
   data->sampleRate = kHandle0SampleRate;
   data->sampleCount = numSamples;
   data->format = CHRE_AUDIO_DATA_FORMAT_8_BIT_U_LAW;
-  data->samplesULaw8 =
-      static_cast<const uint8_t *>(chre::memoryAlloc(numSamples));
+  data->samplesULaw8 = samples;
 
+  gHandle0EventCount++;
+  gHandle0LastEvent = data.get();
   gCallbacks->audioDataEventCallback(data.release());
 }
 
@@ -146,6 +166,14 @@ bool chrePalAudioIsHandle0Enabled() {
   return gIsHandle0Enabled;
 }
 
+uint32_t chrePalAudioGetHandle0EventCount() {
+  return gHandle0EventCount;
+}
+
+const struct chreAudioDataEvent *chrePalAudioGetHandle0LastEvent() {
+  return gHandle0LastEvent;
+}
+
 const chrePalAudioApi *chrePalAudioGetApi(uint32_t requestedApiVersion) {
   static const struct chrePalAudioApi kApi = {
       .moduleVersion = CHRE_PAL_AUDIO_API_CURRENT_VERSION,
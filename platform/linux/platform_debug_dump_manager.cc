@@ -22,8 +22,14 @@ PlatformDebugDumpManagerBase::PlatformDebugDumpManagerBase() {}
 
 PlatformDebugDumpManagerBase::~PlatformDebugDumpManagerBase() {}
 
-void PlatformDebugDumpManager::sendDebugDump(const char * /*debugStr*/,
-                                             bool /*complete*/) {}
+bool PlatformDebugDumpManager::sendDebugDump(const char * /*debugStr*/,
+                                             bool /*complete*/) {
+  return true;
+}
+
+bool PlatformDebugDumpManager::sendStructuredDebugDump() {
+  return false;
+}
 
 void PlatformDebugDumpManager::logStateToBuffer(
     DebugDumpWrapper & /* debugDump */) {}
@@ -18,6 +18,7 @@
 
 #include <dlfcn.h>
 #include <cinttypes>
+#include <cstring>
 
 #include "chre/platform/assert.h"
 #include "chre/platform/log.h"
@@ -61,6 +62,23 @@ const char *PlatformNanoapp::getAppName() const {
   return (mAppInfo != nullptr) ? mAppInfo->name : "Unknown";
 }
 
+const char *PlatformNanoapp::getAppVendor() const {
+  return (mAppInfo != nullptr) ? mAppInfo->vendor : "Unknown";
+}
+
+const char *PlatformNanoapp::getAppBuildId() const {
+  if (mAppInfo == nullptr || mAppInfo->structMinorVersion < 2 ||
+      mAppInfo->appVersionString == nullptr) {
+    return "<undefined>";
+  }
+
+  // Version strings are expected to end with @<build_id>.
+  const char *buildId = strchr(mAppInfo->appVersionString, '@');
+  return (buildId != nullptr && buildId[1] != '\0')
+             ? buildId + 1
+             : mAppInfo->appVersionString;
+}
+
 bool PlatformNanoapp::supportsAppPermissions() const {
   return (mAppInfo != nullptr) ? (mAppInfo->structMinorVersion >=
                                   CHRE_NSL_NANOAPP_INFO_STRUCT_MINOR_VERSION_3)
@@ -77,8 +95,12 @@ bool PlatformNanoapp::isSystemNanoapp() const {
   return (mAppInfo != nullptr && mAppInfo->isSystemNanoapp);
 }
 
-void PlatformNanoapp::logStateToBuffer(
-    DebugDumpWrapper & /* debugDump */) const {}
+void PlatformNanoapp::logStateToBuffer(DebugDumpWrapper &debugDump) const {
+  if (mAppInfo != nullptr) {
+    debugDump.print("%s (%s) @ build: %s", mAppInfo->name, mAppInfo->vendor,
+                    getAppBuildId());
+  }
+}
 
 void PlatformNanoappBase::loadFromFile(const std::string &filename) {
   CHRE_ASSERT(!isLoaded());
@@ -16,14 +16,76 @@
 
 #include "chre/platform/power_control_manager.h"
 
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/linux/virtual_clock.h"
+
 namespace chre {
 
-void PowerControlManager::preEventLoopProcess(size_t /* numPendingEvents */) {}
+using platform_linux::VirtualClockSingleton;
+
+PowerControlManagerBase::PowerControlManagerBase() {
+  if (VirtualClockSingleton::isInitialized()) {
+    // The event loop advances the time when it is done processing an event,
+    // so wake it up with an empty one.
+    VirtualClockSingleton::get()->setWakeCallback([]() {
+      EventLoopManagerSingleton::get()->deferCallback(
+          SystemCallbackType::FirstCallbackType, /* data= */ nullptr,
+          [](uint16_t /* type */, void * /* data */, void * /* extraData */) {
+          });
+    });
+  }
+}
+
+PowerControlManagerBase::~PowerControlManagerBase() {
+  if (VirtualClockSingleton::isInitialized()) {
+    VirtualClockSingleton::get()->setWakeCallback(nullptr);
+  }
+}
+
+void PowerControlManagerBase::onHostWakeSuspendEvent(bool awake) {
+  if (mHostIsAwake != awake) {
+    mHostIsAwake = awake;
+    if (!awake) {
+      EventLoopManagerSingleton::get()
+          ->getHostCommsManager()
+          .resetBlameForNanoappHostWakeup();
+    } else {
+      EventLoopManagerSingleton::get()->getHostCommsManager().onHostAwake();
+    }
+    EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+        awake ? CHRE_EVENT_HOST_AWAKE : CHRE_EVENT_HOST_ASLEEP,
+        /* eventData= */ nullptr, /* freeCallback= */ nullptr);
+  }
+}
 
-void PowerControlManager::postEventLoopProcess(size_t /* numPendingEvents */) {}
+void PowerControlManager::preEventLoopProcess(size_t /* numPendingEvents */) {
+  mPowerPolicy.onEventLoopProcessStart();
+  mNumPowerStateTransitions = mPowerPolicy.getNumTransitions();
+}
+
+void PowerControlManager::postEventLoopProcess(size_t numPendingEvents) {
+  Nanoseconds timeToNextEvent = (numPendingEvents == 0)
+                                    ? PowerPolicy::predictTimeToNextEvent()
+                                    : Nanoseconds(0);
+  mPowerPolicy.onEventLoopProcessEnd(numPendingEvents, timeToNextEvent);
+  mNumPowerStateTransitions = mPowerPolicy.getNumTransitions();
+
+  if (numPendingEvents == 0) {
+    advanceVirtualTime();
+  }
+}
+
+void PowerControlManagerBase::advanceVirtualTime() {
+  if (VirtualClockSingleton::isInitialized()) {
+    EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+    while (eventLoop.getNumPendingEvents() == 0 &&
+           VirtualClockSingleton::get()->advance()) {
+    }
+  }
+}
 
 bool PowerControlManager::hostIsAwake() {
-  return true;
+  return mHostIsAwake;
 }
 
 }  // namespace chre
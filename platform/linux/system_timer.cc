@@ -24,11 +24,15 @@
 #include <mutex>
 #include <unordered_set>
 
+#include "chre/platform/linux/virtual_clock.h"
 #include "chre/platform/log.h"
 #include "chre/util/time.h"
 
 namespace chre {
 
+using platform_linux::VirtualClock;
+using platform_linux::VirtualClockSingleton;
+
 namespace {
 
 constexpr uint64_t kOneSecondInNanoseconds = 1000000000;
@@ -59,7 +63,12 @@ SystemTimer::SystemTimer() {
 SystemTimer::~SystemTimer() {
   std::lock_guard<std::mutex> globalLock(gGlobalTimerMutex);
   gActiveTimerInstances.erase(this);
-  if (mInitialized) {
+  if (mInitialized && mIsVirtual) {
+    if (VirtualClockSingleton::isInitialized()) {
+      VirtualClockSingleton::get()->cancelAlarm(mAlarmId);
+    }
+    mInitialized = false;
+  } else if (mInitialized) {
     int ret = timer_delete(mTimerId);
     if (ret != 0) {
       LOGE("Couldn't delete timer: %s", strerror(errno));
@@ -71,6 +80,10 @@ SystemTimer::~SystemTimer() {
 bool SystemTimer::init() {
   if (mInitialized) {
     LOGW("Tried re-initializing timer");
+  } else if (VirtualClockSingleton::isInitialized()) {
+    mIsVirtual = true;
+    mAlarmId = VirtualClock::kInvalidAlarmId;
+    mInitialized = true;
   } else {
     struct sigevent sigevt = {};
     sigevt.sigev_notify = SIGEV_THREAD;
@@ -119,7 +132,9 @@ bool SystemTimer::cancel() {
 
 bool SystemTimer::isActive() {
   bool isActive = false;
-  if (mInitialized) {
+  if (mInitialized && mIsVirtual) {
+    isActive = VirtualClockSingleton::get()->isAlarmPending(mAlarmId);
+  } else if (mInitialized) {
     struct itimerspec spec = {};
     int ret = timer_gettime(mTimerId, &spec);
     if (ret != 0) {
@@ -133,6 +148,22 @@ bool SystemTimer::isActive() {
 }
 
 bool SystemTimerBase::setInternal(uint64_t delayNs) {
+  if (mIsVirtual) {
+    VirtualClock *clock = VirtualClockSingleton::get();
+    clock->cancelAlarm(mAlarmId);
+    mAlarmId = VirtualClock::kInvalidAlarmId;
+    if (delayNs > 0) {
+      // Goes through the same checks as a POSIX timer notification, as the
+      // timer may be destroyed while the clock runs the alarm.
+      union sigval cookie = {};
+      cookie.sival_ptr = static_cast<SystemTimer *>(this);
+      mAlarmId =
+          clock->addAlarm(clock->getTime() + Nanoseconds(delayNs),
+                          [cookie]() { systemTimerNotifyCallback(cookie); });
+    }
+    return true;
+  }
+
   constexpr int kFlags = 0;
   struct itimerspec spec = {};
 
@@ -23,12 +23,18 @@
 
 namespace chre {
 
+using platform_linux::VirtualClockSingleton;
+
 TaskManager::TaskManager()
     : mQueue(std::greater<Task>()),
       mCurrentTask(nullptr),
       mContinueRunningThread(true),
-      mCurrentId(0) {
-  mThread = std::thread(&TaskManager::run, this);
+      mCurrentId(0),
+      mIsVirtual(VirtualClockSingleton::isInitialized()) {
+  // Virtual tasks are run by the VirtualClock.
+  if (!mIsVirtual) {
+    mThread = std::thread(&TaskManager::run, this);
+  }
 }
 
 TaskManager::~TaskManager() {
@@ -49,8 +55,15 @@ std::optional<uint32_t> TaskManager::addTask(
       // select the next ID
       assert(mCurrentId < std::numeric_limits<uint32_t>::max());
       returnId = mCurrentId++;
-      Task task(func, intervalOrDelay, returnId, isOneShot);
-      success = mQueue.push(task);
+      if (mIsVirtual) {
+        addVirtualTask(returnId, func, intervalOrDelay,
+                       isOneShot ? std::chrono::nanoseconds(0)
+                                 : intervalOrDelay);
+        success = true;
+      } else {
+        Task task(func, intervalOrDelay, returnId, isOneShot);
+        success = mQueue.push(task);
+      }
     }
   }
 
@@ -67,6 +80,14 @@ bool TaskManager::cancelTask(uint32_t taskId) {
   bool success = false;
   if (!mContinueRunningThread) {
     LOGW("Execution thread is shutting down. Cannot cancel a task.");
+  } else if (mIsVirtual) {
+    auto iter = mVirtualAlarmIds.find(taskId);
+    if (iter != mVirtualAlarmIds.end()) {
+      // The alarm is not pending if the task is cancelling itself.
+      VirtualClockSingleton::get()->cancelAlarm(iter->second);
+      mVirtualAlarmIds.erase(iter);
+      success = true;
+    }
   } else if (mCurrentTask != nullptr && mCurrentTask->getId() == taskId) {
     // The currently executing task may want to cancel itself.
     mCurrentTask->cancel();
@@ -89,6 +110,7 @@ void TaskManager::flushTasks() {
   while (!mQueue.empty()) {
     mQueue.pop();
   }
+  cancelVirtualTasks();
 }
 
 void TaskManager::flushAndStop() {
@@ -102,6 +124,7 @@ void TaskManager::flushAndStop() {
     while (!mQueue.empty()) {
       mQueue.pop();
     }
+    cancelVirtualTasks();
     mContinueRunningThread = false;
   }
 
@@ -155,4 +178,36 @@ void TaskManager::run() {
   }
 }
 
+void TaskManager::addVirtualTask(uint32_t taskId,
+                                 const Task::TaskFunction &func,
+                                 std::chrono::nanoseconds delay,
+                                 std::chrono::nanoseconds repeatInterval) {
+  auto *clock = VirtualClockSingleton::get();
+  Nanoseconds deadline =
+      clock->getTime() + Nanoseconds(static_cast<uint64_t>(delay.count()));
+  mVirtualAlarmIds[taskId] =
+      clock->addAlarm(deadline, [this, taskId, func, repeatInterval]() {
+        func();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto iter = mVirtualAlarmIds.find(taskId);
+        if (iter == mVirtualAlarmIds.end()) {
+          // The task cancelled itself.
+        } else if (repeatInterval.count() > 0 && mContinueRunningThread) {
+          addVirtualTask(taskId, func, repeatInterval, repeatInterval);
+        } else {
+          mVirtualAlarmIds.erase(iter);
+        }
+      });
+}
+
+void TaskManager::cancelVirtualTasks() {
+  if (VirtualClockSingleton::isInitialized()) {
+    for (const auto &[taskId, alarmId] : mVirtualAlarmIds) {
+      VirtualClockSingleton::get()->cancelAlarm(alarmId);
+    }
+  }
+  mVirtualAlarmIds.clear();
+}
+
 }  // namespace chre
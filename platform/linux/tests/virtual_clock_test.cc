@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "chre/platform/linux/task_util/task_manager.h"
+#include "chre/platform/linux/virtual_clock.h"
+#include "chre/platform/system_time.h"
+
+using chre::Milliseconds;
+using chre::Nanoseconds;
+using chre::Seconds;
+using chre::SystemTime;
+using chre::TaskManager;
+using chre::platform_linux::VirtualClock;
+using chre::platform_linux::VirtualClockSingleton;
+
+namespace {
+
+TEST(VirtualClock, AlarmsRunInDeadlineOrder) {
+  VirtualClock clock(Seconds(1));
+  std::vector<int> order;
+
+  clock.addAlarm(Seconds(3), [&order]() { order.push_back(3); });
+  clock.addAlarm(Seconds(2), [&order]() { order.push_back(2); });
+  clock.addAlarm(Seconds(2), [&order]() { order.push_back(20); });
+  uint32_t cancelledId =
+      clock.addAlarm(Seconds(1), [&order]() { order.push_back(1); });
+  EXPECT_TRUE(clock.isAlarmPending(cancelledId));
+  EXPECT_TRUE(clock.cancelAlarm(cancelledId));
+  EXPECT_FALSE(clock.isAlarmPending(cancelledId));
+  EXPECT_FALSE(clock.cancelAlarm(cancelledId));
+
+  EXPECT_EQ(clock.getTime(), Seconds(1));
+  EXPECT_TRUE(clock.advance());
+  EXPECT_EQ(clock.getTime(), Seconds(2));
+  EXPECT_TRUE(clock.advance());
+  EXPECT_EQ(clock.getTime(), Seconds(2));
+  EXPECT_TRUE(clock.advance());
+  EXPECT_EQ(clock.getTime(), Seconds(3));
+  EXPECT_FALSE(clock.advance());
+
+  EXPECT_EQ(order, (std::vector<int>{2, 20, 3}));
+}
+
+TEST(VirtualClock, HoldsPreventAdvancingAndWake) {
+  VirtualClock clock;
+  uint32_t numWakes = 0;
+  clock.setWakeCallback([&numWakes]() { numWakes++; });
+
+  bool ran = false;
+  clock.addAlarm(clock.getTime() + Milliseconds(10), [&ran]() { ran = true; });
+  clock.hold();
+  clock.hold();
+  EXPECT_FALSE(clock.advance());
+  clock.release();
+  EXPECT_EQ(numWakes, 0);
+  clock.release();
+  EXPECT_EQ(numWakes, 1);
+
+  EXPECT_TRUE(clock.advance());
+  EXPECT_TRUE(ran);
+
+  // There is nothing to wake up for without alarms.
+  clock.hold();
+  clock.release();
+  EXPECT_EQ(numWakes, 1);
+}
+
+//! Deinitializes the VirtualClock singleton even if the test fails, so that
+//! the following tests use the real time.
+class VirtualClockSingletonTest : public testing::Test {
+ protected:
+  void TearDown() override {
+    if (VirtualClockSingleton::isInitialized()) {
+      VirtualClockSingleton::deinit();
+    }
+  }
+};
+
+TEST_F(VirtualClockSingletonTest, TimeSourcesFollowTheVirtualClock) {
+  VirtualClockSingleton::init(Seconds(10));
+  VirtualClock *clock = VirtualClockSingleton::get();
+  EXPECT_EQ(SystemTime::getMonotonicTime(), Seconds(10));
+
+  std::vector<uint64_t> runTimesMs;
+  {
+    TaskManager taskManager;
+    auto recordTime = [&runTimesMs]() {
+      runTimesMs.push_back(
+          SystemTime::getMonotonicTime().toRawNanoseconds() / 1000000);
+    };
+    taskManager.addTask(recordTime, std::chrono::milliseconds(100));
+    taskManager.addTask(recordTime, std::chrono::milliseconds(250),
+                        /* isOneShot= */ true);
+
+    // An hour of a repeating task takes no real time.
+    while (clock->getTime() < Seconds(10 + 3600)) {
+      ASSERT_TRUE(clock->advance());
+    }
+  }
+  EXPECT_FALSE(clock->advance());
+
+  ASSERT_EQ(runTimesMs.size(), 36001);
+  EXPECT_EQ(runTimesMs[0], 10100);
+  EXPECT_EQ(runTimesMs[1], 10200);
+  EXPECT_EQ(runTimesMs[2], 10250);
+  EXPECT_EQ(runTimesMs[3], 10300);
+  EXPECT_EQ(runTimesMs.back(), 3610000);
+}
+
+}  // namespace
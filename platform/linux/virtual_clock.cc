@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/linux/virtual_clock.h"
+
+#include <cassert>
+
+namespace chre::platform_linux {
+
+Nanoseconds VirtualClock::getTime() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mNow;
+}
+
+uint32_t VirtualClock::addAlarm(Nanoseconds deadline,
+                                AlarmCallback &&callback) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  uint32_t alarmId = mNextAlarmId++;
+  if (mNextAlarmId == kInvalidAlarmId) {
+    mNextAlarmId++;
+  }
+
+  uint64_t deadlineNs = deadline.toRawNanoseconds();
+  mAlarms.emplace(std::make_pair(deadlineNs, alarmId), std::move(callback));
+  mAlarmDeadlines.emplace(alarmId, deadlineNs);
+  return alarmId;
+}
+
+bool VirtualClock::cancelAlarm(uint32_t alarmId) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mAlarmDeadlines.find(alarmId);
+  if (it == mAlarmDeadlines.end()) {
+    return false;
+  }
+
+  mAlarms.erase(std::make_pair(it->second, alarmId));
+  mAlarmDeadlines.erase(it);
+  return true;
+}
+
+bool VirtualClock::isAlarmPending(uint32_t alarmId) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mAlarmDeadlines.find(alarmId) != mAlarmDeadlines.end();
+}
+
+void VirtualClock::hold() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mNumHolds++;
+}
+
+void VirtualClock::release() {
+  AlarmCallback wakeCallback;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    assert(mNumHolds > 0);
+    if (--mNumHolds > 0 || mAlarms.empty()) {
+      return;
+    }
+    wakeCallback = mWakeCallback;
+  }
+
+  if (wakeCallback) {
+    wakeCallback();
+  }
+}
+
+void VirtualClock::setWakeCallback(AlarmCallback &&callback) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mWakeCallback = std::move(callback);
+}
+
+bool VirtualClock::advance() {
+  AlarmCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mNumHolds > 0 || mAlarms.empty()) {
+      return false;
+    }
+
+    auto it = mAlarms.begin();
+    uint64_t deadlineNs = it->first.first;
+    if (deadlineNs > mNow.toRawNanoseconds()) {
+      mNow = Nanoseconds(deadlineNs);
+    }
+    callback = std::move(it->second);
+    mAlarmDeadlines.erase(it->first.second);
+    mAlarms.erase(it);
+  }
+
+  callback();
+  return true;
+}
+
+}  // namespace chre::platform_linux
@@ -8,6 +8,7 @@ include $(CHRE_PREFIX)/external/flatbuffers/flatbuffers.mk
 
 # Include paths.
 COMMON_CFLAGS += -Iplatform/include
+COMMON_CFLAGS += -Iplatform/shared/extensions/include
 
 # SLPI-specific Compiler Flags #################################################
 
@@ -212,6 +213,7 @@ SIM_SRCS += platform/linux/system_timer.cc
 SIM_SRCS += platform/linux/platform_nanoapp.cc
 SIM_SRCS += platform/linux/task_util/task.cc
 SIM_SRCS += platform/linux/task_util/task_manager.cc
+SIM_SRCS += platform/linux/virtual_clock.cc
 SIM_SRCS += platform/shared/chre_api_audio.cc
 SIM_SRCS += platform/shared/chre_api_ble.cc
 SIM_SRCS += platform/shared/chre_api_core.cc
@@ -353,14 +355,34 @@ GOOGLETEST_COMMON_SRCS += platform/linux/sim/audio_source.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/sim/platform_audio.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/tests/task_test.cc
 GOOGLETEST_COMMON_SRCS += platform/linux/tests/task_manager_test.cc
+GOOGLETEST_COMMON_SRCS += platform/linux/tests/virtual_clock_test.cc
+GOOGLETEST_COMMON_SRCS += platform/tests/elf_symbol_hash_test.cc
 GOOGLETEST_COMMON_SRCS += platform/tests/log_buffer_test.cc
+GOOGLETEST_COMMON_SRCS += platform/tests/streaming_elf_mapper_test.cc
 GOOGLETEST_COMMON_SRCS += platform/tests/trace_test.cc
 GOOGLETEST_COMMON_SRCS += platform/shared/log_buffer.cc
+GOOGLETEST_COMMON_SRCS += platform/shared/streaming_elf_mapper.cc
 GOOGLETEST_COMMON_SRCS += platform/shared/nanoapp_abort.cc
 ifeq ($(CHRE_WIFI_NAN_SUPPORT_ENABLED), true)
 GOOGLETEST_COMMON_SRCS += platform/linux/pal_nan.cc
 endif
 
+# Benchmark Compiler Flags #####################################################
+
+BENCHMARK_CFLAGS += $(FLATBUFFERS_CFLAGS)
+BENCHMARK_CFLAGS += -Iplatform/shared/include
+BENCHMARK_CFLAGS += -Iplatform/linux/include
+
+# Benchmark Source Files #######################################################
+
+BENCHMARK_COMMON_SRCS += platform/linux/assert.cc
+BENCHMARK_COMMON_SRCS += platform/shared/host_protocol_chre.cc
+BENCHMARK_COMMON_SRCS += platform/shared/host_protocol_common.cc
+BENCHMARK_COMMON_SRCS += platform/shared/log_buffer.cc
+
+BENCHMARK_SRCS += platform/benchmarks/host_protocol_benchmark.cc
+BENCHMARK_SRCS += platform/benchmarks/log_buffer_benchmark.cc
+
 # EmbOS specific compiler flags
 EMBOS_CFLAGS += -I$(CHRE_PREFIX)/platform/embos/include
 EMBOS_CFLAGS += -I$(CHRE_PREFIX)/platform/shared/aligned_alloc_unsupported/include
@@ -401,6 +423,7 @@ EMBOS_SRCS += $(CHRE_PREFIX)/platform/shared/version.cc
 EMBOS_SRCS += $(CHRE_PREFIX)/platform/shared/nanoapp_abort.cc
 EMBOS_SRCS += $(CHRE_PREFIX)/platform/shared/nanoapp/nanoapp_dso_util.cc
 EMBOS_SRCS += $(CHRE_PREFIX)/platform/shared/nanoapp_loader.cc
+EMBOS_SRCS += $(CHRE_PREFIX)/platform/shared/streaming_elf_mapper.cc
 
 # Exynos specific compiler flags
 EXYNOS_CFLAGS += -I$(CHRE_PREFIX)/platform/exynos/include
@@ -488,6 +511,7 @@ TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/nanoapp_load_manager.cc
 TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/nanoapp_loader.cc
 TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/pal_system_api.cc
 TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/platform_debug_dump_manager.cc
+TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/streaming_elf_mapper.cc
 TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/system_time.cc
 TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/version.cc
 TINYSYS_SRCS += $(CHRE_PREFIX)/platform/shared/nanoapp/nanoapp_dso_util.cc
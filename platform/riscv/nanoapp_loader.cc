@@ -36,8 +36,12 @@ bool NanoappLoader::relocateTable(DynamicHeader *dyn, int tag) {
       // which is usually the same, but on occasions can be different.
       SectionHeader *dynamicRelaTablePtr = getSectionHeader(".rela.dyn");
       CHRE_ASSERT(dynamicRelaTablePtr != nullptr);
-      ElfRela *reloc =
-          reinterpret_cast<ElfRela *>(mBinary + dynamicRelaTablePtr->sh_offset);
+      ElfRela *reloc = reinterpret_cast<ElfRela *>(
+          getFileData(dynamicRelaTablePtr->sh_offset));
+      if (reloc == nullptr) {
+        LOGE("DT_RELA table is not in a load segment");
+        break;
+      }
       size_t relocSize = dynamicRelaTablePtr->sh_size;
       size_t nRelocs = relocSize / sizeof(ElfRela);
       LOGV("Relocation %zu entries in DT_RELA table", nRelocs);
@@ -15,6 +15,7 @@
  */
 
 #include "chre_api/chre/audio.h"
+#include "chre_ext/audio_features.h"
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/util/macros.h"
@@ -65,3 +66,26 @@ DLL_EXPORT bool chreAudioConfigureSource(uint32_t handle, bool enable,
   return false;
 #endif  // CHRE_AUDIO_SUPPORT_ENABLED
 }
+
+DLL_EXPORT bool chreextAudioConfigureFeatures(uint32_t handle, bool enable,
+                                              uint64_t deliveryInterval,
+                                              uint32_t frameSize,
+                                              uint32_t hopSize,
+                                              uint16_t numBins) {
+#ifdef CHRE_AUDIO_SUPPORT_ENABLED
+  Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
+  return nanoapp->permitPermissionUse(NanoappPermissions::CHRE_PERMS_AUDIO) &&
+         EventLoopManagerSingleton::get()
+             ->getAudioRequestManager()
+             .configureFeatures(nanoapp, handle, enable, deliveryInterval,
+                                frameSize, hopSize, numBins);
+#else
+  UNUSED_VAR(handle);
+  UNUSED_VAR(enable);
+  UNUSED_VAR(deliveryInterval);
+  UNUSED_VAR(frameSize);
+  UNUSED_VAR(hopSize);
+  UNUSED_VAR(numBins);
+  return false;
+#endif  // CHRE_AUDIO_SUPPORT_ENABLED
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CHRE_EXT_AUDIO_FEATURES_H_
+#define _CHRE_EXT_AUDIO_FEATURES_H_
+
+/**
+ * @file
+ * An extension of this CHRE implementation providing log-mel energies of audio
+ * sources to nanoapps. It is not part of the CHRE API: nanoapps using it must
+ * tolerate runtimes without it, on which chreextAudioConfigureFeatures()
+ * returns false.
+ */
+
+#include <chre/event.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * nanoappHandleEvent argument: struct chreextAudioFeatureEvent
+ *
+ * Provides log-mel energies of audio data to a nanoapp, as configured with
+ * chreextAudioConfigureFeatures(). Allocated from the range reserved for
+ * implementation-specific events.
+ */
+#define CHREEXT_EVENT_AUDIO_FEATURES  CHRE_EVENT_INTERNAL_EXTENDED_FIRST_EVENT
+
+/**
+ * The current compatibility version of the chreextAudioFeatureEvent structure.
+ */
+#define CHREEXT_AUDIO_FEATURE_EVENT_VERSION  UINT8_C(1)
+
+/**
+ * The nanoappHandleEvent argument for CHREEXT_EVENT_AUDIO_FEATURES.
+ *
+ * The frames of an event follow the frames of the previous event of the same
+ * configuration, unless audio samples were missed: nanoapps must tolerate a
+ * gap in the timestamps, as for CHRE_EVENT_AUDIO_DATA. The event is shared by
+ * all the nanoapps with the same configuration and must not be modified.
+ */
+struct chreextAudioFeatureEvent {
+  /**
+   * Indicates the version of the structure, for compatibility purposes.
+   */
+  uint8_t version;
+
+  /**
+   * Additional bytes reserved for future use; must be set to 0.
+   */
+  uint8_t reserved[3];
+
+  /**
+   * The handle for which this audio data originated from.
+   */
+  uint32_t handle;
+
+  /**
+   * The timestamp of the first sample of the first frame, from the same time
+   * base as chreGetTime() (in nanoseconds).
+   */
+  uint64_t timestamp;
+
+  /**
+   * The sample rate of the audio data in hertz.
+   */
+  uint32_t sampleRate;
+
+  /**
+   * The number of samples of each frame, as configured.
+   */
+  uint32_t frameSize;
+
+  /**
+   * The number of samples between the starts of consecutive frames, as
+   * configured.
+   */
+  uint32_t hopSize;
+
+  /**
+   * The number of mel bands of each frame, as configured.
+   */
+  uint16_t numBins;
+
+  /**
+   * The number of frames provided with this event.
+   */
+  uint16_t numFrames;
+
+  /**
+   * numFrames frames of numBins values each. Each value is the base 2
+   * logarithm of the energy of a mel band, in Q8 (units of 1/256). The mel
+   * bands are triangular and evenly spaced on the mel scale from 0 Hz to half
+   * the sample rate, and the energy is that of the frame less its mean,
+   * weighted by a Hann window.
+   */
+  const int16_t *logMelEnergies;
+};
+
+/**
+ * Configures delivery of log-mel energies of an audio source to the current
+ * nanoapp, as CHREEXT_EVENT_AUDIO_FEATURES events. The energies are computed
+ * once for all the nanoapps requesting the same configuration, which is
+ * cheaper than each nanoapp computing them from its own CHRE_EVENT_AUDIO_DATA
+ * events. A nanoapp may have one such configuration per audio source in
+ * addition to its chreAudioConfigureSource() request. The audio source status
+ * is reported as for chreAudioConfigureSource().
+ *
+ * @param handle The handle for this audio source.
+ * @param enable true if enabling the features, false otherwise. When passed as
+ *     false, the other parameters are ignored.
+ * @param deliveryInterval Desired time between each
+ *     CHREEXT_EVENT_AUDIO_FEATURES event, in nanoseconds. Each event holds the
+ *     frames of the samples captured since the previous event.
+ * @param frameSize The number of samples of each frame, a power of 2. The
+ *     frame must fit in the maxBufferDuration of the source.
+ * @param hopSize The number of samples between the starts of consecutive
+ *     frames, in the range [1, frameSize].
+ * @param numBins The number of mel bands, in the range [1, frameSize / 2].
+ * @return true if the configuration was successful, false if invalid
+ *     parameters were provided or the extension is not supported.
+ *
+ * @note Requires audio permission
+ */
+bool chreextAudioConfigureFeatures(uint32_t handle, bool enable,
+                                   uint64_t deliveryInterval,
+                                   uint32_t frameSize, uint32_t hopSize,
+                                   uint16_t numBins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _CHRE_EXT_AUDIO_FEATURES_H_ */
@@ -21,8 +21,11 @@
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/core/host_endpoint_manager.h"
+#include "chre/platform/assert.h"
 #include "chre/platform/log.h"
 #include "chre/platform/shared/generated/host_messages_generated.h"
+#include "chre/platform/system_time.h"
+#include "chre/util/fixed_size_vector.h"
 #include "chre/util/macros.h"
 
 using flatbuffers::Offset;
@@ -282,6 +285,32 @@ void HostProtocolChre::encodeLoadNanoappResponse(ChreFlatBufferBuilder &builder,
            hostClientId);
 }
 
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+void HostProtocolChre::encodeNanoappMessageBatch(
+    ChreFlatBufferBuilder &builder, const MessageToHost *const *messages,
+    size_t numMessages) {
+  CHRE_ASSERT(numMessages <= CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES);
+  FixedSizeVector<Offset<fbs::NanoappMessage>,
+                  CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES>
+      messageOffsets;
+  for (size_t i = 0; i < numMessages; i++) {
+    const MessageToHost *message = messages[i];
+    auto messageDataOffset =
+        builder.CreateVector(message->message.data(), message->message.size());
+    messageOffsets.push_back(fbs::CreateNanoappMessage(
+        builder, message->appId, message->toHostData.messageType,
+        message->toHostData.hostEndpoint, messageDataOffset,
+        message->toHostData.messagePermissions,
+        message->toHostData.appPermissions, message->toHostData.wokeHost));
+  }
+
+  auto vectorOffset =
+      builder.CreateVector(messageOffsets.data(), messageOffsets.size());
+  auto batch = fbs::CreateNanoappMessageBatch(builder, vectorOffset);
+  finalize(builder, fbs::ChreMessage::NanoappMessageBatch, batch.Union());
+}
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
 void HostProtocolChre::encodeNanoappTokenDatabaseInfo(
     ChreFlatBufferBuilder &builder, uint16_t instanceId, uint64_t appId,
     uint32_t tokenDatabaseOffset, size_t tokenDatabaseSize) {
@@ -320,6 +349,19 @@ void HostProtocolChre::encodeLogMessagesV2(ChreFlatBufferBuilder &builder,
   finalize(builder, fbs::ChreMessage::LogMessageV2, message.Union());
 }
 
+void HostProtocolChre::encodeLogMessagesV3(ChreFlatBufferBuilder &builder,
+                                           const uint8_t *logBuffer,
+                                           size_t bufferSize,
+                                           size_t uncompressedSize,
+                                           uint32_t numLogsDropped) {
+  auto logBufferOffset = builder.CreateVector(
+      reinterpret_cast<const int8_t *>(logBuffer), bufferSize);
+  auto message = fbs::CreateLogMessageV3(
+      builder, logBufferOffset, fbs::LogCompression::LZ4_BLOCK,
+      static_cast<uint32_t>(uncompressedSize), numLogsDropped);
+  finalize(builder, fbs::ChreMessage::LogMessageV3, message.Union());
+}
+
 void HostProtocolChre::encodeDebugDumpData(ChreFlatBufferBuilder &builder,
                                            uint16_t hostClientId,
                                            const char *debugStr,
@@ -340,6 +382,62 @@ void HostProtocolChre::encodeDebugDumpResponse(ChreFlatBufferBuilder &builder,
            hostClientId);
 }
 
+void HostProtocolChre::encodeStructuredDebugDump(ChreFlatBufferBuilder &builder,
+                                                 uint16_t hostClientId) {
+  struct NanoappEntries {
+    ChreFlatBufferBuilder &builder;
+    DynamicVector<Offset<fbs::DebugDumpNanoapp>> offsets;
+  };
+
+  auto nanoappAdderCallback = [](const Nanoapp *nanoapp, void *data) {
+    auto *entries = static_cast<NanoappEntries *>(data);
+    auto nameOffset =
+        addStringAsByteVector(entries->builder, nanoapp->getAppName());
+    auto vendorOffset =
+        addStringAsByteVector(entries->builder, nanoapp->getAppVendor());
+    auto buildOffset =
+        addStringAsByteVector(entries->builder, nanoapp->getAppBuildId());
+    auto offset = fbs::CreateDebugDumpNanoapp(
+        entries->builder, nanoapp->getAppId(), nanoapp->getInstanceId(),
+        nanoapp->getAppVersion(), nanoapp->getTargetApiVersion(), nameOffset,
+        vendorOffset, buildOffset, nanoapp->isSystemNanoapp(),
+        static_cast<uint32_t>(nanoapp->getTotalAllocatedBytes()),
+        static_cast<uint32_t>(nanoapp->getPeakAllocatedBytes()),
+        nanoapp->getMaxEventProcessTime(),
+        nanoapp->getEventProcessTimeSinceBoot(),
+        nanoapp->getNumWakeupsSinceBoot(),
+        nanoapp->getNumMessagesSentSinceBoot());
+    if (!entries->offsets.push_back(offset)) {
+      LOG_OOM();
+    }
+  };
+
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  NanoappEntries entries{builder, {}};
+  eventLoop.forEachNanoapp(nanoappAdderCallback, &entries);
+  auto nanoappsOffset =
+      builder.CreateVector<Offset<fbs::DebugDumpNanoapp>>(entries.offsets);
+
+  Nanoseconds timeSinceWakeupBucketCycled =
+      SystemTime::getMonotonicTime() -
+      eventLoop.getTimeLastWakeupBucketCycled();
+  const MemoryManager &memoryManager =
+      EventLoopManagerSingleton::get()->getMemoryManager();
+  auto message = fbs::CreateStructuredDebugDumpData(
+      builder, eventLoop.getMaxEventQueueSize(),
+      static_cast<uint32_t>(EventLoop::getEventPoolSize()),
+      eventLoop.getNumEventsDropped(),
+      timeSinceWakeupBucketCycled.toRawNanoseconds() / kOneMinuteInNanoseconds,
+      EventLoop::getWakeupBucketInterval().toRawNanoseconds() /
+          kOneMinuteInNanoseconds,
+      static_cast<uint32_t>(memoryManager.getTotalAllocatedBytes()),
+      static_cast<uint32_t>(memoryManager.getPeakAllocatedBytes()),
+      static_cast<uint32_t>(memoryManager.getAllocationCount()),
+      nanoappsOffset);
+  finalize(builder, fbs::ChreMessage::StructuredDebugDumpData, message.Union(),
+           hostClientId);
+}
+
 void HostProtocolChre::encodeTimeSyncRequest(ChreFlatBufferBuilder &builder) {
   auto request = fbs::CreateTimeSyncRequest(builder);
   finalize(builder, fbs::ChreMessage::TimeSyncRequest, request.Union());
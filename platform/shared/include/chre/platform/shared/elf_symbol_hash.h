@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_SHARED_ELF_SYMBOL_HASH_H_
+#define CHRE_PLATFORM_SHARED_ELF_SYMBOL_HASH_H_
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace chre {
+
+/**
+ * Hash function of the DT_GNU_HASH table.
+ */
+inline uint32_t elfGnuHash(const char *name) {
+  uint32_t hash = 5381;
+  for (; *name != '\0'; name++) {
+    hash = hash * 33 + static_cast<uint8_t>(*name);
+  }
+  return hash;
+}
+
+/**
+ * Hash function of the DT_HASH table.
+ */
+inline uint32_t elfSysvHash(const char *name) {
+  uint32_t hash = 0;
+  for (; *name != '\0'; name++) {
+    hash = (hash << 4) + static_cast<uint8_t>(*name);
+    uint32_t high = hash & 0xf0000000;
+    hash ^= high >> 24;
+    hash &= ~high;
+  }
+  return hash;
+}
+
+/**
+ * Finds a dynamic symbol by name in a DT_GNU_HASH table. The table is made of
+ * a header, a bloom filter, the buckets and the hash chains of the symbols
+ * starting at the symbol offset of the header.
+ *
+ * @tparam ElfWord The Elf32_Word or Elf64_Word type of the binary.
+ * @tparam ElfAddr The Elf32_Addr or Elf64_Addr type of the binary, which is
+ *     the size of the words of the bloom filter.
+ * @param table The DT_GNU_HASH table.
+ * @param numSymbols The number of entries of the dynamic symbol table.
+ * @param name The exact name of the symbol.
+ * @param getName Returns the name of the dynamic symbol at an index.
+ * @return The index of the symbol in the dynamic symbol table, or 0 (the
+ *     undefined symbol) if it is not found.
+ */
+template <typename ElfWord, typename ElfAddr, typename GetNameFunction>
+ElfWord elfGnuHashLookup(const ElfWord *table, size_t numSymbols,
+                         const char *name, GetNameFunction getName) {
+  constexpr uint32_t kBloomWordBits = sizeof(ElfAddr) * CHAR_BIT;
+  ElfWord numBuckets = table[0];
+  ElfWord symbolOffset = table[1];
+  ElfWord bloomSize = table[2];
+  ElfWord bloomShift = table[3];
+  const auto *bloom = reinterpret_cast<const ElfAddr *>(&table[4]);
+  const auto *buckets = reinterpret_cast<const ElfWord *>(&bloom[bloomSize]);
+  const ElfWord *chains = &buckets[numBuckets];
+  if (numBuckets == 0 || bloomSize == 0) {
+    return 0;
+  }
+
+  uint32_t hash = elfGnuHash(name);
+  ElfAddr bloomWord = bloom[(hash / kBloomWordBits) % bloomSize];
+  ElfAddr bloomMask =
+      (static_cast<ElfAddr>(1) << (hash % kBloomWordBits)) |
+      (static_cast<ElfAddr>(1) << ((hash >> bloomShift) % kBloomWordBits));
+  if ((bloomWord & bloomMask) != bloomMask) {
+    return 0;
+  }
+
+  ElfWord index = buckets[hash % numBuckets];
+  if (index < symbolOffset) {
+    return 0;
+  }
+  for (; index < numSymbols; index++) {
+    // The last bit of a chain entry marks the end of the chain.
+    ElfWord chainHash = chains[index - symbolOffset];
+    if ((chainHash | 1) == (hash | 1) && strcmp(getName(index), name) == 0) {
+      return index;
+    }
+    if ((chainHash & 1) != 0) {
+      break;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Finds a dynamic symbol by name in a DT_HASH table, made of a header, the
+ * buckets and one chain entry per dynamic symbol.
+ *
+ * @see elfGnuHashLookup for the parameters and return value.
+ */
+template <typename ElfWord, typename GetNameFunction>
+ElfWord elfSysvHashLookup(const ElfWord *table, size_t numSymbols,
+                          const char *name, GetNameFunction getName) {
+  ElfWord numBuckets = table[0];
+  ElfWord numChains = table[1];
+  const ElfWord *buckets = &table[2];
+  const ElfWord *chains = &buckets[numBuckets];
+  if (numBuckets == 0) {
+    return 0;
+  }
+
+  for (ElfWord index = buckets[elfSysvHash(name) % numBuckets];
+       index != 0 && index < numChains && index < numSymbols;
+       index = chains[index]) {
+    if (strcmp(getName(index), name) == 0) {
+      return index;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Finds a dynamic symbol by name in the DT_GNU_HASH table of a binary, or in
+ * its DT_HASH table if it has no DT_GNU_HASH table.
+ *
+ * @param gnuHashTable The DT_GNU_HASH table, nullptr if the binary has none.
+ * @param sysvHashTable The DT_HASH table, nullptr if the binary has none.
+ * @see elfGnuHashLookup for the other parameters and the return value.
+ */
+template <typename ElfWord, typename ElfAddr, typename GetNameFunction>
+ElfWord elfHashTableLookup(const ElfWord *gnuHashTable,
+                           const ElfWord *sysvHashTable, size_t numSymbols,
+                           const char *name, GetNameFunction getName) {
+  if (gnuHashTable != nullptr) {
+    return elfGnuHashLookup<ElfWord, ElfAddr>(gnuHashTable, numSymbols, name,
+                                              getName);
+  }
+  if (sysvHashTable != nullptr) {
+    return elfSysvHashLookup<ElfWord>(sysvHashTable, numSymbols, name,
+                                      getName);
+  }
+  return 0;
+}
+
+}  // namespace chre
+
+#endif  // CHRE_PLATFORM_SHARED_ELF_SYMBOL_HASH_H_
@@ -15,6 +15,9 @@ struct NanoappMessageBuilder;
 struct MessageDeliveryStatus;
 struct MessageDeliveryStatusBuilder;
 
+struct NanoappMessageBatch;
+struct NanoappMessageBatchBuilder;
+
 struct HubInfoRequest;
 struct HubInfoRequestBuilder;
 
@@ -63,6 +66,12 @@ struct DebugDumpDataBuilder;
 struct DebugDumpResponse;
 struct DebugDumpResponseBuilder;
 
+struct DebugDumpNanoapp;
+struct DebugDumpNanoappBuilder;
+
+struct StructuredDebugDumpData;
+struct StructuredDebugDumpDataBuilder;
+
 struct TimeSyncRequest;
 struct TimeSyncRequestBuilder;
 
@@ -78,6 +87,9 @@ struct SettingChangeMessageBuilder;
 struct LogMessageV2;
 struct LogMessageV2Builder;
 
+struct LogMessageV3;
+struct LogMessageV3Builder;
+
 struct SelfTestRequest;
 struct SelfTestRequestBuilder;
 
@@ -231,33 +243,36 @@ enum class LogType : int8_t {
   TOKENIZED = 1,
   BLUETOOTH = 2,
   NANOAPP_TOKENIZED = 3,
+  DEFERRED_STRING = 4,
   MIN = STRING,
-  MAX = NANOAPP_TOKENIZED
+  MAX = DEFERRED_STRING
 };
 
-inline const LogType (&EnumValuesLogType())[4] {
+inline const LogType (&EnumValuesLogType())[5] {
   static const LogType values[] = {
     LogType::STRING,
     LogType::TOKENIZED,
     LogType::BLUETOOTH,
-    LogType::NANOAPP_TOKENIZED
+    LogType::NANOAPP_TOKENIZED,
+    LogType::DEFERRED_STRING
   };
   return values;
 }
 
 inline const char * const *EnumNamesLogType() {
-  static const char * const names[5] = {
+  static const char * const names[6] = {
     "STRING",
     "TOKENIZED",
     "BLUETOOTH",
     "NANOAPP_TOKENIZED",
+    "DEFERRED_STRING",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameLogType(LogType e) {
-  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::NANOAPP_TOKENIZED)) return "";
+  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::DEFERRED_STRING)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesLogType()[index];
 }
@@ -292,6 +307,38 @@ inline const char *EnumNameBtSnoopDirection(BtSnoopDirection e) {
   return EnumNamesBtSnoopDirection()[index];
 }
 
+/// The compression applied to the buffer of a LogMessageV3.
+enum class LogCompression : int8_t {
+  NONE = 0,
+  /// LZ4 block format, without the LZ4 frame header.
+  LZ4_BLOCK = 1,
+  MIN = NONE,
+  MAX = LZ4_BLOCK
+};
+
+inline const LogCompression (&EnumValuesLogCompression())[2] {
+  static const LogCompression values[] = {
+    LogCompression::NONE,
+    LogCompression::LZ4_BLOCK
+  };
+  return values;
+}
+
+inline const char * const *EnumNamesLogCompression() {
+  static const char * const names[3] = {
+    "NONE",
+    "LZ4_BLOCK",
+    nullptr
+  };
+  return names;
+}
+
+inline const char *EnumNameLogCompression(LogCompression e) {
+  if (flatbuffers::IsOutRange(e, LogCompression::NONE, LogCompression::LZ4_BLOCK)) return "";
+  const size_t index = static_cast<size_t>(e);
+  return EnumNamesLogCompression()[index];
+}
+
 /// A union that joins together all possible messages. Note that in FlatBuffers,
 /// unions have an implicit type
 enum class ChreMessage : uint8_t {
@@ -328,11 +375,14 @@ enum class ChreMessage : uint8_t {
   PulseResponse = 30,
   NanoappTokenDatabaseInfo = 31,
   MessageDeliveryStatus = 32,
+  LogMessageV3 = 33,
+  NanoappMessageBatch = 34,
+  StructuredDebugDumpData = 35,
   MIN = NONE,
-  MAX = MessageDeliveryStatus
+  MAX = StructuredDebugDumpData
 };
 
-inline const ChreMessage (&EnumValuesChreMessage())[33] {
+inline const ChreMessage (&EnumValuesChreMessage())[36] {
   static const ChreMessage values[] = {
     ChreMessage::NONE,
     ChreMessage::NanoappMessage,
@@ -366,13 +416,16 @@ inline const ChreMessage (&EnumValuesChreMessage())[33] {
     ChreMessage::PulseRequest,
     ChreMessage::PulseResponse,
     ChreMessage::NanoappTokenDatabaseInfo,
-    ChreMessage::MessageDeliveryStatus
+    ChreMessage::MessageDeliveryStatus,
+    ChreMessage::LogMessageV3,
+    ChreMessage::NanoappMessageBatch,
+    ChreMessage::StructuredDebugDumpData
   };
   return values;
 }
 
 inline const char * const *EnumNamesChreMessage() {
-  static const char * const names[34] = {
+  static const char * const names[37] = {
     "NONE",
     "NanoappMessage",
     "HubInfoRequest",
@@ -406,13 +459,16 @@ inline const char * const *EnumNamesChreMessage() {
     "PulseResponse",
     "NanoappTokenDatabaseInfo",
     "MessageDeliveryStatus",
+    "LogMessageV3",
+    "NanoappMessageBatch",
+    "StructuredDebugDumpData",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameChreMessage(ChreMessage e) {
-  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::MessageDeliveryStatus)) return "";
+  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::StructuredDebugDumpData)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesChreMessage()[index];
 }
@@ -549,6 +605,18 @@ template<> struct ChreMessageTraits<chre::fbs::MessageDeliveryStatus> {
   static const ChreMessage enum_value = ChreMessage::MessageDeliveryStatus;
 };
 
+template<> struct ChreMessageTraits<chre::fbs::LogMessageV3> {
+  static const ChreMessage enum_value = ChreMessage::LogMessageV3;
+};
+
+template<> struct ChreMessageTraits<chre::fbs::NanoappMessageBatch> {
+  static const ChreMessage enum_value = ChreMessage::NanoappMessageBatch;
+};
+
+template<> struct ChreMessageTraits<chre::fbs::StructuredDebugDumpData> {
+  static const ChreMessage enum_value = ChreMessage::StructuredDebugDumpData;
+};
+
 bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj, ChreMessage type);
 bool VerifyChreMessageVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types);
 
@@ -782,6 +850,63 @@ inline flatbuffers::Offset<MessageDeliveryStatus> CreateMessageDeliveryStatus(
   return builder_.Finish();
 }
 
+/// A batch of messages from nanoapps to the host, sent in a single transport
+/// transaction to reduce the per-message overhead. The host demultiplexes it
+/// into the individual messages, in order.
+struct NanoappMessageBatch FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef NanoappMessageBatchBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_MESSAGES = 4
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *messages() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *>(VT_MESSAGES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffsetRequired(verifier, VT_MESSAGES) &&
+           verifier.VerifyVector(messages()) &&
+           verifier.VerifyVectorOfTables(messages()) &&
+           verifier.EndTable();
+  }
+};
+
+struct NanoappMessageBatchBuilder {
+  typedef NanoappMessageBatch Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_messages(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> messages) {
+    fbb_.AddOffset(NanoappMessageBatch::VT_MESSAGES, messages);
+  }
+  explicit NanoappMessageBatchBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  NanoappMessageBatchBuilder &operator=(const NanoappMessageBatchBuilder &);
+  flatbuffers::Offset<NanoappMessageBatch> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<NanoappMessageBatch>(end);
+    fbb_.Required(o, NanoappMessageBatch::VT_MESSAGES);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<NanoappMessageBatch> CreateNanoappMessageBatch(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> messages = 0) {
+  NanoappMessageBatchBuilder builder_(_fbb);
+  builder_.add_messages(messages);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<NanoappMessageBatch> CreateNanoappMessageBatchDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *messages = nullptr) {
+  auto messages__ = messages ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::NanoappMessage>>(*messages) : 0;
+  return chre::fbs::CreateNanoappMessageBatch(
+      _fbb,
+      messages__);
+}
+
 struct HubInfoRequest FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef HubInfoRequestBuilder Builder;
   bool Verify(flatbuffers::Verifier &verifier) const {
@@ -2007,6 +2132,383 @@ inline flatbuffers::Offset<DebugDumpResponse> CreateDebugDumpResponse(
   return builder_.Finish();
 }
 
+/// The state of a nanoapp, part of a StructuredDebugDumpData.
+struct DebugDumpNanoapp FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef DebugDumpNanoappBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_APP_ID = 4,
+    VT_INSTANCE_ID = 6,
+    VT_VERSION = 8,
+    VT_TARGET_API_VERSION = 10,
+    VT_NAME = 12,
+    VT_VENDOR = 14,
+    VT_BUILD = 16,
+    VT_IS_SYSTEM = 18,
+    VT_ALLOCATED_BYTES = 20,
+    VT_PEAK_ALLOCATED_BYTES = 22,
+    VT_MAX_EVENT_TIME_MS = 24,
+    VT_TOTAL_EVENT_TIME_MS = 26,
+    VT_NUM_WAKEUPS = 28,
+    VT_NUM_MESSAGES_SENT = 30
+  };
+  uint64_t app_id() const {
+    return GetField<uint64_t>(VT_APP_ID, 0);
+  }
+  uint16_t instance_id() const {
+    return GetField<uint16_t>(VT_INSTANCE_ID, 0);
+  }
+  uint32_t version() const {
+    return GetField<uint32_t>(VT_VERSION, 0);
+  }
+  uint32_t target_api_version() const {
+    return GetField<uint32_t>(VT_TARGET_API_VERSION, 0);
+  }
+  /// Null-terminated ASCII name of the nanoapp
+  const flatbuffers::Vector<int8_t> *name() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_NAME);
+  }
+  /// Null-terminated ASCII name of the nanoapp vendor
+  const flatbuffers::Vector<int8_t> *vendor() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_VENDOR);
+  }
+  /// Null-terminated ASCII build of the nanoapp, as identified by the platform
+  const flatbuffers::Vector<int8_t> *build() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_BUILD);
+  }
+  bool is_system() const {
+    return GetField<uint8_t>(VT_IS_SYSTEM, 0) != 0;
+  }
+  /// Current and peak heap usage, in bytes
+  uint32_t allocated_bytes() const {
+    return GetField<uint32_t>(VT_ALLOCATED_BYTES, 0);
+  }
+  uint32_t peak_allocated_bytes() const {
+    return GetField<uint32_t>(VT_PEAK_ALLOCATED_BYTES, 0);
+  }
+  /// Longest and total time spent handling events since boot, in
+  /// milliseconds
+  uint64_t max_event_time_ms() const {
+    return GetField<uint64_t>(VT_MAX_EVENT_TIME_MS, 0);
+  }
+  uint64_t total_event_time_ms() const {
+    return GetField<uint64_t>(VT_TOTAL_EVENT_TIME_MS, 0);
+  }
+  /// Number of host wakeups and of messages sent to the host since boot
+  uint32_t num_wakeups() const {
+    return GetField<uint32_t>(VT_NUM_WAKEUPS, 0);
+  }
+  uint32_t num_messages_sent() const {
+    return GetField<uint32_t>(VT_NUM_MESSAGES_SENT, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint64_t>(verifier, VT_APP_ID) &&
+           VerifyField<uint16_t>(verifier, VT_INSTANCE_ID) &&
+           VerifyField<uint32_t>(verifier, VT_VERSION) &&
+           VerifyField<uint32_t>(verifier, VT_TARGET_API_VERSION) &&
+           VerifyOffset(verifier, VT_NAME) &&
+           verifier.VerifyVector(name()) &&
+           VerifyOffset(verifier, VT_VENDOR) &&
+           verifier.VerifyVector(vendor()) &&
+           VerifyOffset(verifier, VT_BUILD) &&
+           verifier.VerifyVector(build()) &&
+           VerifyField<uint8_t>(verifier, VT_IS_SYSTEM) &&
+           VerifyField<uint32_t>(verifier, VT_ALLOCATED_BYTES) &&
+           VerifyField<uint32_t>(verifier, VT_PEAK_ALLOCATED_BYTES) &&
+           VerifyField<uint64_t>(verifier, VT_MAX_EVENT_TIME_MS) &&
+           VerifyField<uint64_t>(verifier, VT_TOTAL_EVENT_TIME_MS) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_WAKEUPS) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_MESSAGES_SENT) &&
+           verifier.EndTable();
+  }
+};
+
+struct DebugDumpNanoappBuilder {
+  typedef DebugDumpNanoapp Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_app_id(uint64_t app_id) {
+    fbb_.AddElement<uint64_t>(DebugDumpNanoapp::VT_APP_ID, app_id, 0);
+  }
+  void add_instance_id(uint16_t instance_id) {
+    fbb_.AddElement<uint16_t>(DebugDumpNanoapp::VT_INSTANCE_ID, instance_id, 0);
+  }
+  void add_version(uint32_t version) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_VERSION, version, 0);
+  }
+  void add_target_api_version(uint32_t target_api_version) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_TARGET_API_VERSION, target_api_version, 0);
+  }
+  void add_name(flatbuffers::Offset<flatbuffers::Vector<int8_t>> name) {
+    fbb_.AddOffset(DebugDumpNanoapp::VT_NAME, name);
+  }
+  void add_vendor(flatbuffers::Offset<flatbuffers::Vector<int8_t>> vendor) {
+    fbb_.AddOffset(DebugDumpNanoapp::VT_VENDOR, vendor);
+  }
+  void add_build(flatbuffers::Offset<flatbuffers::Vector<int8_t>> build) {
+    fbb_.AddOffset(DebugDumpNanoapp::VT_BUILD, build);
+  }
+  void add_is_system(bool is_system) {
+    fbb_.AddElement<uint8_t>(DebugDumpNanoapp::VT_IS_SYSTEM, static_cast<uint8_t>(is_system), 0);
+  }
+  void add_allocated_bytes(uint32_t allocated_bytes) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_ALLOCATED_BYTES, allocated_bytes, 0);
+  }
+  void add_peak_allocated_bytes(uint32_t peak_allocated_bytes) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_PEAK_ALLOCATED_BYTES, peak_allocated_bytes, 0);
+  }
+  void add_max_event_time_ms(uint64_t max_event_time_ms) {
+    fbb_.AddElement<uint64_t>(DebugDumpNanoapp::VT_MAX_EVENT_TIME_MS, max_event_time_ms, 0);
+  }
+  void add_total_event_time_ms(uint64_t total_event_time_ms) {
+    fbb_.AddElement<uint64_t>(DebugDumpNanoapp::VT_TOTAL_EVENT_TIME_MS, total_event_time_ms, 0);
+  }
+  void add_num_wakeups(uint32_t num_wakeups) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_NUM_WAKEUPS, num_wakeups, 0);
+  }
+  void add_num_messages_sent(uint32_t num_messages_sent) {
+    fbb_.AddElement<uint32_t>(DebugDumpNanoapp::VT_NUM_MESSAGES_SENT, num_messages_sent, 0);
+  }
+  explicit DebugDumpNanoappBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  DebugDumpNanoappBuilder &operator=(const DebugDumpNanoappBuilder &);
+  flatbuffers::Offset<DebugDumpNanoapp> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<DebugDumpNanoapp>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<DebugDumpNanoapp> CreateDebugDumpNanoapp(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint64_t app_id = 0,
+    uint16_t instance_id = 0,
+    uint32_t version = 0,
+    uint32_t target_api_version = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> name = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> vendor = 0,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> build = 0,
+    bool is_system = false,
+    uint32_t allocated_bytes = 0,
+    uint32_t peak_allocated_bytes = 0,
+    uint64_t max_event_time_ms = 0,
+    uint64_t total_event_time_ms = 0,
+    uint32_t num_wakeups = 0,
+    uint32_t num_messages_sent = 0) {
+  DebugDumpNanoappBuilder builder_(_fbb);
+  builder_.add_total_event_time_ms(total_event_time_ms);
+  builder_.add_max_event_time_ms(max_event_time_ms);
+  builder_.add_app_id(app_id);
+  builder_.add_num_messages_sent(num_messages_sent);
+  builder_.add_num_wakeups(num_wakeups);
+  builder_.add_peak_allocated_bytes(peak_allocated_bytes);
+  builder_.add_allocated_bytes(allocated_bytes);
+  builder_.add_build(build);
+  builder_.add_vendor(vendor);
+  builder_.add_name(name);
+  builder_.add_target_api_version(target_api_version);
+  builder_.add_version(version);
+  builder_.add_instance_id(instance_id);
+  builder_.add_is_system(is_system);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<DebugDumpNanoapp> CreateDebugDumpNanoappDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint64_t app_id = 0,
+    uint16_t instance_id = 0,
+    uint32_t version = 0,
+    uint32_t target_api_version = 0,
+    const std::vector<int8_t> *name = nullptr,
+    const std::vector<int8_t> *vendor = nullptr,
+    const std::vector<int8_t> *build = nullptr,
+    bool is_system = false,
+    uint32_t allocated_bytes = 0,
+    uint32_t peak_allocated_bytes = 0,
+    uint64_t max_event_time_ms = 0,
+    uint64_t total_event_time_ms = 0,
+    uint32_t num_wakeups = 0,
+    uint32_t num_messages_sent = 0) {
+  auto name__ = name ? _fbb.CreateVector<int8_t>(*name) : 0;
+  auto vendor__ = vendor ? _fbb.CreateVector<int8_t>(*vendor) : 0;
+  auto build__ = build ? _fbb.CreateVector<int8_t>(*build) : 0;
+  return chre::fbs::CreateDebugDumpNanoapp(
+      _fbb,
+      app_id,
+      instance_id,
+      version,
+      target_api_version,
+      name__,
+      vendor__,
+      build__,
+      is_system,
+      allocated_bytes,
+      peak_allocated_bytes,
+      max_event_time_ms,
+      total_event_time_ms,
+      num_wakeups,
+      num_messages_sent);
+}
+
+/// The state of the CHRE framework that debug dumps otherwise format as text
+/// on the hub: the event loop, nanoapp heap usage and the nanoapps. Sent
+/// between the DebugDumpData messages of a debug dump session and rendered
+/// to text by the host, which can also use the fields directly.
+struct StructuredDebugDumpData FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef StructuredDebugDumpDataBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_MAX_EVENT_POOL_USAGE = 4,
+    VT_EVENT_POOL_SIZE = 6,
+    VT_NUM_DROPPED_LOW_PRIORITY_EVENTS = 8,
+    VT_WAKEUP_BUCKET_CYCLED_MINS_AGO = 10,
+    VT_WAKEUP_BUCKET_DURATION_MINS = 12,
+    VT_NANOAPP_HEAP_ALLOCATED_BYTES = 14,
+    VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES = 16,
+    VT_NANOAPP_HEAP_ALLOCATION_COUNT = 18,
+    VT_NANOAPPS = 20
+  };
+  /// Peak and total number of events of the event pool
+  uint32_t max_event_pool_usage() const {
+    return GetField<uint32_t>(VT_MAX_EVENT_POOL_USAGE, 0);
+  }
+  uint32_t event_pool_size() const {
+    return GetField<uint32_t>(VT_EVENT_POOL_SIZE, 0);
+  }
+  uint32_t num_dropped_low_priority_events() const {
+    return GetField<uint32_t>(VT_NUM_DROPPED_LOW_PRIORITY_EVENTS, 0);
+  }
+  /// Minutes since the nanoapp host wakeup buckets were last cycled, and
+  /// duration of a bucket in minutes
+  uint64_t wakeup_bucket_cycled_mins_ago() const {
+    return GetField<uint64_t>(VT_WAKEUP_BUCKET_CYCLED_MINS_AGO, 0);
+  }
+  uint64_t wakeup_bucket_duration_mins() const {
+    return GetField<uint64_t>(VT_WAKEUP_BUCKET_DURATION_MINS, 0);
+  }
+  /// Heap usage of all nanoapps
+  uint32_t nanoapp_heap_allocated_bytes() const {
+    return GetField<uint32_t>(VT_NANOAPP_HEAP_ALLOCATED_BYTES, 0);
+  }
+  uint32_t nanoapp_heap_peak_allocated_bytes() const {
+    return GetField<uint32_t>(VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES, 0);
+  }
+  uint32_t nanoapp_heap_allocation_count() const {
+    return GetField<uint32_t>(VT_NANOAPP_HEAP_ALLOCATION_COUNT, 0);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *nanoapps() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *>(VT_NANOAPPS);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<uint32_t>(verifier, VT_MAX_EVENT_POOL_USAGE) &&
+           VerifyField<uint32_t>(verifier, VT_EVENT_POOL_SIZE) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_DROPPED_LOW_PRIORITY_EVENTS) &&
+           VerifyField<uint64_t>(verifier, VT_WAKEUP_BUCKET_CYCLED_MINS_AGO) &&
+           VerifyField<uint64_t>(verifier, VT_WAKEUP_BUCKET_DURATION_MINS) &&
+           VerifyField<uint32_t>(verifier, VT_NANOAPP_HEAP_ALLOCATED_BYTES) &&
+           VerifyField<uint32_t>(verifier, VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES) &&
+           VerifyField<uint32_t>(verifier, VT_NANOAPP_HEAP_ALLOCATION_COUNT) &&
+           VerifyOffset(verifier, VT_NANOAPPS) &&
+           verifier.VerifyVector(nanoapps()) &&
+           verifier.VerifyVectorOfTables(nanoapps()) &&
+           verifier.EndTable();
+  }
+};
+
+struct StructuredDebugDumpDataBuilder {
+  typedef StructuredDebugDumpData Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_max_event_pool_usage(uint32_t max_event_pool_usage) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_MAX_EVENT_POOL_USAGE, max_event_pool_usage, 0);
+  }
+  void add_event_pool_size(uint32_t event_pool_size) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_EVENT_POOL_SIZE, event_pool_size, 0);
+  }
+  void add_num_dropped_low_priority_events(uint32_t num_dropped_low_priority_events) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NUM_DROPPED_LOW_PRIORITY_EVENTS, num_dropped_low_priority_events, 0);
+  }
+  void add_wakeup_bucket_cycled_mins_ago(uint64_t wakeup_bucket_cycled_mins_ago) {
+    fbb_.AddElement<uint64_t>(StructuredDebugDumpData::VT_WAKEUP_BUCKET_CYCLED_MINS_AGO, wakeup_bucket_cycled_mins_ago, 0);
+  }
+  void add_wakeup_bucket_duration_mins(uint64_t wakeup_bucket_duration_mins) {
+    fbb_.AddElement<uint64_t>(StructuredDebugDumpData::VT_WAKEUP_BUCKET_DURATION_MINS, wakeup_bucket_duration_mins, 0);
+  }
+  void add_nanoapp_heap_allocated_bytes(uint32_t nanoapp_heap_allocated_bytes) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NANOAPP_HEAP_ALLOCATED_BYTES, nanoapp_heap_allocated_bytes, 0);
+  }
+  void add_nanoapp_heap_peak_allocated_bytes(uint32_t nanoapp_heap_peak_allocated_bytes) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NANOAPP_HEAP_PEAK_ALLOCATED_BYTES, nanoapp_heap_peak_allocated_bytes, 0);
+  }
+  void add_nanoapp_heap_allocation_count(uint32_t nanoapp_heap_allocation_count) {
+    fbb_.AddElement<uint32_t>(StructuredDebugDumpData::VT_NANOAPP_HEAP_ALLOCATION_COUNT, nanoapp_heap_allocation_count, 0);
+  }
+  void add_nanoapps(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>>> nanoapps) {
+    fbb_.AddOffset(StructuredDebugDumpData::VT_NANOAPPS, nanoapps);
+  }
+  explicit StructuredDebugDumpDataBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  StructuredDebugDumpDataBuilder &operator=(const StructuredDebugDumpDataBuilder &);
+  flatbuffers::Offset<StructuredDebugDumpData> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<StructuredDebugDumpData>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<StructuredDebugDumpData> CreateStructuredDebugDumpData(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t max_event_pool_usage = 0,
+    uint32_t event_pool_size = 0,
+    uint32_t num_dropped_low_priority_events = 0,
+    uint64_t wakeup_bucket_cycled_mins_ago = 0,
+    uint64_t wakeup_bucket_duration_mins = 0,
+    uint32_t nanoapp_heap_allocated_bytes = 0,
+    uint32_t nanoapp_heap_peak_allocated_bytes = 0,
+    uint32_t nanoapp_heap_allocation_count = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>>> nanoapps = 0) {
+  StructuredDebugDumpDataBuilder builder_(_fbb);
+  builder_.add_wakeup_bucket_duration_mins(wakeup_bucket_duration_mins);
+  builder_.add_wakeup_bucket_cycled_mins_ago(wakeup_bucket_cycled_mins_ago);
+  builder_.add_nanoapps(nanoapps);
+  builder_.add_nanoapp_heap_allocation_count(nanoapp_heap_allocation_count);
+  builder_.add_nanoapp_heap_peak_allocated_bytes(nanoapp_heap_peak_allocated_bytes);
+  builder_.add_nanoapp_heap_allocated_bytes(nanoapp_heap_allocated_bytes);
+  builder_.add_num_dropped_low_priority_events(num_dropped_low_priority_events);
+  builder_.add_event_pool_size(event_pool_size);
+  builder_.add_max_event_pool_usage(max_event_pool_usage);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<StructuredDebugDumpData> CreateStructuredDebugDumpDataDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    uint32_t max_event_pool_usage = 0,
+    uint32_t event_pool_size = 0,
+    uint32_t num_dropped_low_priority_events = 0,
+    uint64_t wakeup_bucket_cycled_mins_ago = 0,
+    uint64_t wakeup_bucket_duration_mins = 0,
+    uint32_t nanoapp_heap_allocated_bytes = 0,
+    uint32_t nanoapp_heap_peak_allocated_bytes = 0,
+    uint32_t nanoapp_heap_allocation_count = 0,
+    const std::vector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>> *nanoapps = nullptr) {
+  auto nanoapps__ = nanoapps ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::DebugDumpNanoapp>>(*nanoapps) : 0;
+  return chre::fbs::CreateStructuredDebugDumpData(
+      _fbb,
+      max_event_pool_usage,
+      event_pool_size,
+      num_dropped_low_priority_events,
+      wakeup_bucket_cycled_mins_ago,
+      wakeup_bucket_duration_mins,
+      nanoapp_heap_allocated_bytes,
+      nanoapp_heap_peak_allocated_bytes,
+      nanoapp_heap_allocation_count,
+      nanoapps__);
+}
+
 /// A request from CHRE for host to initiate a time sync message
 /// (system feature, platform-specific - not all platforms necessarily use this)
 struct TimeSyncRequest FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
@@ -2174,7 +2676,8 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   ///                           [EI(Upper nibble) | Level(Lower nibble)]
   ///                            * Log Type
   ///                              (0 = No encoding, 1 = Tokenized log,
-  ///                               2 = BT snoop log, 3 = Nanoapp Tokenized log)
+  ///                               2 = BT snoop log, 3 = Nanoapp Tokenized log,
+  ///                               4 = Deferred string log)
   ///                            * LogBuffer log level (1 = error, 2 = warn,
   ///                                                   3 = info,  4 = debug,
   ///                                                   5 = verbose)
@@ -2209,6 +2712,21 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   ///   were to be sent, a buffer of size 27 bytes would be to encoded as:
   ///   [InstanceId (2B) | Size(1B) | Data(24B)].
   ///
+  /// * Deferred string logs: CHRE system logs whose printf-style formatting is
+  ///   deferred to the host. The first byte indicates the size of the data to
+  ///   follow. The data starts with the little-endian int32_t offset of the
+  ///   format string from the chreLogFormatAnchor symbol in the CHRE binary,
+  ///   followed by the arguments in the order they are consumed by the format
+  ///   string: [Size(1B) | FormatOffset(4B) | Args(Size - 4B)]. Arguments are
+  ///   encoded as follows:
+  ///   - Signed integers (%d, %i and '*' width/precision): zigzag varint
+  ///   - Unsigned integers, characters and pointers: varint
+  ///   - Floating point values: little-endian IEEE-754 double (8B)
+  ///   - Strings: NULL terminated, at most as long as the precision of the
+  ///     conversion if it has one
+  ///   A log whose arguments do not fit in the entry is sent as a string log
+  ///   instead.
+  ///
   /// This pattern repeats until the end of the buffer for multiple log
   /// messages. The last byte will always be a null-terminator. There are no
   /// padding bytes between these fields. Treat this like a packed struct and be
@@ -2274,6 +2792,100 @@ inline flatbuffers::Offset<LogMessageV2> CreateLogMessageV2Direct(
       num_logs_dropped);
 }
 
+/// Represents V3 log messages from CHRE, whose log buffer may be compressed.
+struct LogMessageV3 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef LogMessageV3Builder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_BUFFER = 4,
+    VT_COMPRESSION = 6,
+    VT_UNCOMPRESSED_SIZE = 8,
+    VT_NUM_LOGS_DROPPED = 10
+  };
+  /// A buffer containing log data in the format described in LogMessageV2,
+  /// compressed as indicated by the compression field.
+  const flatbuffers::Vector<int8_t> *buffer() const {
+    return GetPointer<const flatbuffers::Vector<int8_t> *>(VT_BUFFER);
+  }
+  /// The compression applied to the buffer.
+  chre::fbs::LogCompression compression() const {
+    return static_cast<chre::fbs::LogCompression>(GetField<int8_t>(VT_COMPRESSION, 0));
+  }
+  /// The size of the buffer once decompressed.
+  uint32_t uncompressed_size() const {
+    return GetField<uint32_t>(VT_UNCOMPRESSED_SIZE, 0);
+  }
+  /// The number of logs dropped since CHRE started
+  uint32_t num_logs_dropped() const {
+    return GetField<uint32_t>(VT_NUM_LOGS_DROPPED, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_BUFFER) &&
+           verifier.VerifyVector(buffer()) &&
+           VerifyField<int8_t>(verifier, VT_COMPRESSION) &&
+           VerifyField<uint32_t>(verifier, VT_UNCOMPRESSED_SIZE) &&
+           VerifyField<uint32_t>(verifier, VT_NUM_LOGS_DROPPED) &&
+           verifier.EndTable();
+  }
+};
+
+struct LogMessageV3Builder {
+  typedef LogMessageV3 Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_buffer(flatbuffers::Offset<flatbuffers::Vector<int8_t>> buffer) {
+    fbb_.AddOffset(LogMessageV3::VT_BUFFER, buffer);
+  }
+  void add_compression(chre::fbs::LogCompression compression) {
+    fbb_.AddElement<int8_t>(LogMessageV3::VT_COMPRESSION, static_cast<int8_t>(compression), 0);
+  }
+  void add_uncompressed_size(uint32_t uncompressed_size) {
+    fbb_.AddElement<uint32_t>(LogMessageV3::VT_UNCOMPRESSED_SIZE, uncompressed_size, 0);
+  }
+  void add_num_logs_dropped(uint32_t num_logs_dropped) {
+    fbb_.AddElement<uint32_t>(LogMessageV3::VT_NUM_LOGS_DROPPED, num_logs_dropped, 0);
+  }
+  explicit LogMessageV3Builder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  LogMessageV3Builder &operator=(const LogMessageV3Builder &);
+  flatbuffers::Offset<LogMessageV3> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<LogMessageV3>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LogMessageV3> CreateLogMessageV3(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<int8_t>> buffer = 0,
+    chre::fbs::LogCompression compression = chre::fbs::LogCompression::NONE,
+    uint32_t uncompressed_size = 0,
+    uint32_t num_logs_dropped = 0) {
+  LogMessageV3Builder builder_(_fbb);
+  builder_.add_num_logs_dropped(num_logs_dropped);
+  builder_.add_uncompressed_size(uncompressed_size);
+  builder_.add_buffer(buffer);
+  builder_.add_compression(compression);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<LogMessageV3> CreateLogMessageV3Direct(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<int8_t> *buffer = nullptr,
+    chre::fbs::LogCompression compression = chre::fbs::LogCompression::NONE,
+    uint32_t uncompressed_size = 0,
+    uint32_t num_logs_dropped = 0) {
+  auto buffer__ = buffer ? _fbb.CreateVector<int8_t>(*buffer) : 0;
+  return chre::fbs::CreateLogMessageV3(
+      _fbb,
+      buffer__,
+      compression,
+      uncompressed_size,
+      num_logs_dropped);
+}
+
 struct SelfTestRequest FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef SelfTestRequestBuilder Builder;
   bool Verify(flatbuffers::Verifier &verifier) const {
@@ -2900,6 +3512,15 @@ struct MessageContainer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const chre::fbs::MessageDeliveryStatus *message_as_MessageDeliveryStatus() const {
     return message_type() == chre::fbs::ChreMessage::MessageDeliveryStatus ? static_cast<const chre::fbs::MessageDeliveryStatus *>(message()) : nullptr;
   }
+  const chre::fbs::LogMessageV3 *message_as_LogMessageV3() const {
+    return message_type() == chre::fbs::ChreMessage::LogMessageV3 ? static_cast<const chre::fbs::LogMessageV3 *>(message()) : nullptr;
+  }
+  const chre::fbs::NanoappMessageBatch *message_as_NanoappMessageBatch() const {
+    return message_type() == chre::fbs::ChreMessage::NanoappMessageBatch ? static_cast<const chre::fbs::NanoappMessageBatch *>(message()) : nullptr;
+  }
+  const chre::fbs::StructuredDebugDumpData *message_as_StructuredDebugDumpData() const {
+    return message_type() == chre::fbs::ChreMessage::StructuredDebugDumpData ? static_cast<const chre::fbs::StructuredDebugDumpData *>(message()) : nullptr;
+  }
   /// The originating or destination client ID on the host side, used to direct
   /// responses only to the client that sent the request. Although initially
   /// populated by the requesting client, this is enforced to be the correct
@@ -3047,6 +3668,18 @@ template<> inline const chre::fbs::MessageDeliveryStatus *MessageContainer::mess
   return message_as_MessageDeliveryStatus();
 }
 
+template<> inline const chre::fbs::LogMessageV3 *MessageContainer::message_as<chre::fbs::LogMessageV3>() const {
+  return message_as_LogMessageV3();
+}
+
+template<> inline const chre::fbs::NanoappMessageBatch *MessageContainer::message_as<chre::fbs::NanoappMessageBatch>() const {
+  return message_as_NanoappMessageBatch();
+}
+
+template<> inline const chre::fbs::StructuredDebugDumpData *MessageContainer::message_as<chre::fbs::StructuredDebugDumpData>() const {
+  return message_as_StructuredDebugDumpData();
+}
+
 struct MessageContainerBuilder {
   typedef MessageContainer Table;
   flatbuffers::FlatBufferBuilder &fbb_;
@@ -3219,6 +3852,18 @@ inline bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const chre::fbs::MessageDeliveryStatus *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case ChreMessage::LogMessageV3: {
+      auto ptr = reinterpret_cast<const chre::fbs::LogMessageV3 *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ChreMessage::NanoappMessageBatch: {
+      auto ptr = reinterpret_cast<const chre::fbs::NanoappMessageBatch *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case ChreMessage::StructuredDebugDumpData: {
+      auto ptr = reinterpret_cast<const chre::fbs::StructuredDebugDumpData *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return true;
   }
 }
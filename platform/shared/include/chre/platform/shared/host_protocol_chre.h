@@ -31,6 +31,9 @@
 
 namespace chre {
 
+struct HostMessage;
+typedef HostMessage MessageToHost;
+
 typedef flatbuffers::Offset<fbs::NanoappListEntry> NanoappListEntryOffset;
 
 /**
@@ -228,6 +231,20 @@ class HostProtocolChre : public HostProtocolCommon {
                                           uint16_t hostClientId,
                                           uint32_t transactionId, bool success);
 
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+  /**
+   * Encodes a batch of messages from nanoapps to the host, which the host
+   * splits into individual NanoappMessages, in order.
+   *
+   * @param messages The messages of the batch
+   * @param numMessages The number of messages, at most
+   *        CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES
+   */
+  static void encodeNanoappMessageBatch(ChreFlatBufferBuilder &builder,
+                                        const MessageToHost *const *messages,
+                                        size_t numMessages);
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
   /**
    * Encodes a nanoapp's instance ID and app ID to the host.
    */
@@ -250,6 +267,17 @@ class HostProtocolChre : public HostProtocolCommon {
                                   const uint8_t *logBuffer, size_t bufferSize,
                                   uint32_t numLogsDropped);
 
+  /**
+   * Encodes a buffer of V2 log messages compressed in the LZ4 block format into
+   * a V3 log message.
+   *
+   * @param uncompressedSize The size of the log buffer before compression.
+   */
+  static void encodeLogMessagesV3(ChreFlatBufferBuilder &builder,
+                                  const uint8_t *logBuffer, size_t bufferSize,
+                                  size_t uncompressedSize,
+                                  uint32_t numLogsDropped);
+
   /**
    * Encodes a string into a DebugDumpData message.
    *
@@ -267,6 +295,14 @@ class HostProtocolChre : public HostProtocolCommon {
                                       uint16_t hostClientId, bool success,
                                       uint32_t dataCount);
 
+  /**
+   * Encodes the state of the event loop, of the nanoapp heap and of the
+   * nanoapps into a StructuredDebugDumpData message. Must only be called from
+   * the context of the main CHRE thread.
+   */
+  static void encodeStructuredDebugDump(ChreFlatBufferBuilder &builder,
+                                        uint16_t hostClientId);
+
   /**
    * Encodes a message requesting time sync from host.
    */
@@ -136,6 +136,7 @@ struct ExportedData {
 #define DT_TEXTREL 22
 #define DT_JMPREL 23
 #define DT_ENCODING 32
+#define DT_GNU_HASH 0x6ffffef5
 
 typedef __signed__ char __s8;
 typedef unsigned char __u8;
@@ -143,8 +144,8 @@ typedef __signed__ short __s16;
 typedef unsigned short __u16;
 typedef __signed__ int __s32;
 typedef unsigned int __u32;
-typedef __signed__ long __s64;
-typedef unsigned long __u64;
+typedef __signed__ long long __s64;
+typedef unsigned long long __u64;
 
 typedef __u32 Elf32_Addr;
 typedef __u16 Elf32_Half;
@@ -237,6 +238,8 @@ typedef struct elf32_sym {
 #define R_RISCV_JUMP_SLOT 5
 // Undefined symbol.
 #define SHN_UNDEF 0
+// End of a chain of the DT_HASH table.
+#define STN_UNDEF 0
 
 // The following (legal values for segment flags) are copied from
 // bionic's elf.h
@@ -22,10 +22,15 @@
 #include <cstring>
 
 #include "chre/core/event.h"
+#include "chre/platform/atomic.h"
 #include "chre/platform/mutex.h"
 #include "chre/platform/shared/bt_snoop_log.h"
 #include "chre/platform/shared/generated/host_messages_generated.h"
 
+//! The symbol the format string offsets of deferred string logs are relative
+//! to. The host resolves it from the symbol table of the CHRE binary.
+extern "C" const char chreLogFormatAnchor[];
+
 namespace chre {
 
 using LogType = fbs::LogType;
@@ -79,6 +84,21 @@ class LogBufferCallbackInterface {
 /**
  * The class responsible for batching logs in memory until the notification
  * callback is triggered and the platform copies log data out of the buffer.
+ *
+ * Producers (the handle* methods) do not take a lock in the common case.
+ * Each log reserves its space in the ring by advancing the tail index with a
+ * compare-and-swap and formats its entry into the reserved region. Producers
+ * count themselves in mNumLogsInProgress from before reserving until the
+ * entry is written, so every entry reserved before the tail was read is
+ * complete once that count drops to zero; consumers leave the logs in the
+ * buffer until then. The lock is only taken by consumers (copyLogs,
+ * transferTo, reset) and by producers that need to discard old logs to make
+ * room.
+ *
+ * Producers write directly into the shared ring rather than into per-thread
+ * staging buffers: not all platforms provide thread-local storage, and
+ * staging would need a flush point per thread to keep logs from different
+ * threads in the order they were produced.
  */
 class LogBuffer {
  public:
@@ -111,11 +131,25 @@ class LogBuffer {
   //! instanceId field.
   static constexpr size_t kNanoappTokenizedLogOffset = 3;
 
+  //! The number of bytes in a deferred string log entry of the buffer after
+  //! the 'header' and before the encoded format reference and arguments. The
+  //! value indicates the size of the uint8_t logSize field.
+  static constexpr size_t kDeferredStringLogOffset = 1;
+
+  //! The max number of bytes of an encoded deferred string log, see
+  //! encodeDeferredLogVa().
+  static constexpr size_t kDeferredStringLogMaxSize =
+      kLogMaxSize - kDeferredStringLogOffset - 1;
+
+  //! The minimum time between two notifications while the consumer has not
+  //! drained the buffer since the previous notification.
+  static constexpr uint32_t kNotificationCoalescingWindowMs = 100;
+
   /**
    * @param callback The callback object that will receive notifications about
    *                 the state of the log buffer or nullptr if it is not needed.
-   * @param buffer The buffer location that will store log data.
-   *                    message.
+   * @param buffer The buffer location that will store log data. The memory
+   *               must not be shared with another LogBuffer.
    * @param bufferSize The number of bytes in the buffer. This value must be >
    *                   kBufferMinSize
    */
@@ -171,6 +205,35 @@ class LogBuffer {
                                  uint32_t timestampMs, uint16_t instanceId,
                                  const uint8_t *log, size_t logSize);
 
+  /**
+   * Adds a deferred string log, as encoded by encodeDeferredLogVa(), to the
+   * buffer and determines whether to send log buffer to host.
+   *
+   * @param log Pointer to the buffer containing the encoded log message.
+   * @param logSize Size of the encoded log.
+   */
+  void handleDeferredLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
+                         const uint8_t *log, size_t logSize);
+
+  /**
+   * Encodes a printf-style log without formatting it. The output holds the
+   * offset of logFormat from the chreLogFormatAnchor symbol followed by the
+   * arguments in binary form, so the host can format the log using the format
+   * strings of the CHRE binary. See host_messages.fbs for the encoding.
+   *
+   * Only format strings that are part of the CHRE binary may be used.
+   *
+   * @param logFormat The printf-style format string.
+   * @param args The arguments to encode.
+   * @param buffer The buffer to encode the log into.
+   * @param bufferSize The size of buffer, at most kDeferredStringLogMaxSize.
+   * @return The number of bytes written to buffer or 0 if the log uses a
+   *         conversion that is not supported or does not fit in the buffer, in
+   *         which case it must be formatted with handleLogVa() instead.
+   */
+  static size_t encodeDeferredLogVa(const char *logFormat, va_list args,
+                                    uint8_t *buffer, size_t bufferSize);
+
 #ifdef CHRE_BLE_SUPPORT_ENABLED
   /**
    * Similar to handleLog but buffer a BT snoop log.
@@ -192,7 +255,8 @@ class LogBuffer {
    * Copy out as many logs as will fit into destination buffer as they are
    * formatted internally. The memory where the logs were stored will be freed.
    * This method is thread-safe and will ensure that copyLogs will only copy
-   * out the logs in a FIFO ordering.
+   * out the logs in a FIFO ordering. Logs that are still being written by a
+   * producer are not copied, nor are any logs that follow them.
    *
    * @param destination Pointer to the destination memory address.
    * @param size The max number of bytes to copy.
@@ -219,9 +283,10 @@ class LogBuffer {
    * Transfer all data from one log buffer to another. The destination log
    * buffer must have equal or greater capacity than this buffer. The
    * otherBuffer will be reset prior to this buffer's data being transferred to
-   * it and after the transfer this buffer will be reset. This method is
+   * it and the transferred logs are freed from this buffer. This method is
    * thread-safe and will ensure that logs are kept in FIFO ordering during a
-   * transfer operation.
+   * transfer operation. The destination buffer must not be concurrently
+   * written to by producers.
    *
    * @param otherBuffer The log buffer that is transferred to.
    */
@@ -231,6 +296,10 @@ class LogBuffer {
    * Update the current log buffer notification setting which will determine
    * when the platform is notified to copy logs out of the buffer. Thread-safe.
    *
+   * Notifications are coalesced: once the callback has been invoked, it is
+   * not invoked again until copyLogs() is called or
+   * kNotificationCoalescingWindowMs has elapsed.
+   *
    * @param setting The new notification setting value.
    * @param thresholdBytes If the nofification setting is THRESHOLD, then if
    *                       the buffer allocates this many bytes the notification
@@ -241,10 +310,9 @@ class LogBuffer {
                                  size_t thresholdBytes = 0);
 
   /**
-   * Thread safe.
-   *
    * Empty out the log entries currently in the buffer and reset the number of
-   * logs dropped.
+   * logs dropped. Must not be called while producers may be adding logs to
+   * this buffer.
    */
   void reset();
 
@@ -260,7 +328,8 @@ class LogBuffer {
   /**
    * Thread safe.
    *
-   * @return The current buffer size.
+   * @return The current buffer size, including space reserved by logs that
+   * are still being written.
    */
   size_t getBufferSize();
 
@@ -283,6 +352,10 @@ class LogBuffer {
   size_t getLogDataLength(size_t startingIndex, LogType type);
 
  private:
+  //! The max number of bytes in an entry between the 'header' and the log
+  //! data.
+  static constexpr size_t kMaxLogDataHeaderSize = kNanoappTokenizedLogOffset;
+
   /**
    * Increment the value and take the modulus of the max size of the buffer.
    *
@@ -293,28 +366,53 @@ class LogBuffer {
   size_t incrementAndModByBufferMaxSize(size_t originalVal,
                                         size_t incrementBy) const;
 
+  /**
+   * The head and tail positions run over [0, 2 * mBufferMaxSize) so that a
+   * full buffer can be told apart from an empty one without a separate size
+   * counter that would need to be updated together with the tail.
+   *
+   * @return The position after advancing the given one by size bytes.
+   */
+  uint32_t advancePosition(uint32_t position, size_t size) const;
+
+  /**
+   * @return The buffer index of a head or tail position.
+   */
+  size_t positionToIndex(uint32_t position) const;
+
+  /**
+   * @return The number of bytes between the head and tail positions.
+   */
+  size_t usedBytes(uint32_t headPosition, uint32_t tailPosition) const;
+
   /**
    * Copy from the source memory location to the buffer data ensuring that
    * the copy wraps around the buffer data if needed.
    *
+   * @param index The buffer index to start copying to.
    * @param size The number of bytes to copy into the buffer.
    * @param source The memory location to copy from.
+   * @return The buffer index following the copied bytes.
    */
-  void copyToBuffer(size_t size, const void *source);
-
-  template <typename Type>
-  void copyVarToBuffer(const Type *var) {
-    copyToBuffer(sizeof(Type), var);
-  }
+  size_t copyToBuffer(size_t index, size_t size, const void *source);
 
   /**
    * Copy from the buffer data to a destination memory location ensuring that
    * the copy wraps around the buffer data if needed.
    *
+   * @param index The buffer index to start copying from.
    * @param size The number of bytes to copy into the buffer.
    * @param destination The memory location to copy to.
    */
-  void copyFromBuffer(size_t size, void *destination);
+  void copyFromBuffer(size_t index, size_t size, void *destination);
+
+  /**
+   * Must be called after loading the head and tail positions.
+   *
+   * @param numOwnLogs The number of logs the caller is writing itself.
+   * @return true if every entry between the loaded positions is complete.
+   */
+  bool logsWrittenUpTo(uint32_t numOwnLogs) const;
 
   /**
    * Same as copyLogs method but requires that a lock already be held.
@@ -350,33 +448,52 @@ class LogBuffer {
                   uint16_t instanceId = kSystemInstanceId);
 
   /**
-   * First ensure that there's enough space for the log by discarding older
-   * logs, then encode and copy this log into the internal log buffer.
+   * Reserve space for the log, discarding older logs if needed, then copy the
+   * entry into the reserved space and publish it.
+   *
+   * @param dataHeader The bytes that precede the log data for the given type,
+   *        e.g. the log size for tokenized logs.
+   * @param dataHeaderLen The number of bytes in dataHeader.
    */
   void copyLogToBuffer(LogBufferLogLevel level, uint32_t timestampMs,
-                       const void *logBuffer, uint8_t logLen, LogType type,
-                       uint16_t instanceId = kSystemInstanceId);
+                       const uint8_t *dataHeader, uint8_t dataHeaderLen,
+                       const void *logBuffer, uint8_t logLen, LogType type);
+
+  /**
+   * Reserve entrySize bytes at the tail of the buffer without taking the
+   * lock.
+   *
+   * @param entrySize The number of bytes to reserve.
+   * @param position Non-null pointer set to the reserved position on success.
+   * @return true if the space was reserved, false if there is not enough free
+   *         space in the buffer.
+   */
+  bool tryReserve(size_t entrySize, uint32_t *position);
 
   /**
-   * Invalidate memory allocated for log at head while the buffer is greater
-   * than max size. This function must only be called with the log buffer mutex
-   * locked.
+   * Reserve entrySize bytes at the tail of the buffer, discarding the oldest
+   * logs if there is not enough free space.
+   *
+   * @return true if the space was reserved, false if the log must be dropped.
    */
-  void discardExcessOldLogsLocked(uint8_t currentLogLen);
+  bool reserve(size_t entrySize, uint32_t *position);
 
   /**
-   * Add an encoding header to the log message if the encoding param is true.
-   * This function must only be called with the log buffer mutex locked.
+   * Invalidate memory allocated for the log at head. This function must only
+   * be called with the log buffer mutex locked.
+   *
+   * @return false if the buffer is empty or another producer is still writing
+   *         a log, which may be the one at head.
    */
-  void encodeAndCopyLogLocked(LogBufferLogLevel level, uint32_t timestampMs,
-                              const void *logBuffer, uint8_t logLen,
-                              LogType type, uint16_t instanceId);
+  bool discardOldestLogLocked();
 
   /**
    * Send ready to dispatch logs over, based on the current log notification
    * setting
+   *
+   * @param timestampMs The timestamp of the log that was just buffered.
    */
-  void dispatch();
+  void dispatch(uint32_t timestampMs);
 
   /**
    * @param metadata The metadata of the log message.
@@ -427,16 +544,18 @@ class LogBuffer {
 
   // TODO(b/170870354): Create a cirular buffer class to reuse this concept in
   // other parts of CHRE
-  //! The buffer data head index
-  size_t mBufferDataHeadIndex = 0;
-  //! The buffer data tail index
-  size_t mBufferDataTailIndex = 0;
-  //! The current size of the data buffer
-  size_t mBufferDataSize = 0;
+  //! The buffer data head position, see advancePosition(). Only advanced with
+  //! mLock held.
+  AtomicUint32 mBufferDataHeadPosition;
+  //! The buffer data tail position, see advancePosition(). Advanced by
+  //! producers with a compare-and-swap.
+  AtomicUint32 mBufferDataTailPosition;
   //! The buffer max size
   size_t mBufferMaxSize;
   //! The number of logs that have been dropped
-  size_t mNumLogsDropped = 0;
+  AtomicUint32 mNumLogsDropped;
+  //! The number of producers between reserving and writing an entry.
+  AtomicUint32 mNumLogsInProgress;
   //! The buffer min size
   // TODO(b/170870354): Setup a more appropriate min size
   static constexpr size_t kBufferMinSize = 1024;  // 1KB
@@ -448,9 +567,13 @@ class LogBuffer {
       LogBufferNotificationSetting::ALWAYS;
   //! The number of bytes that will trigger the threshold notification
   size_t mNotificationThresholdBytes = 0;
+  //! Whether the callback was notified and logs have not been copied out
+  //! since.
+  AtomicBool mNotificationPending;
+  //! The timestamp of the log that triggered the last notification.
+  AtomicUint32 mLastNotificationTimestampMs;
 
-  // TODO(srok): Optimize the locking scheme
-  //! The mutex guarding all thread safe operations.
+  //! The mutex guarding consumers and producers that discard old logs.
   Mutex mLock;
 };
 
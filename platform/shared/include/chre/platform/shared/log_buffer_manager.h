@@ -23,6 +23,7 @@
 #include "chre/platform/shared/bt_snoop_log.h"
 #include "chre/platform/shared/generated/host_messages_generated.h"
 #include "chre/platform/shared/log_buffer.h"
+#include "chre/util/lz_compression.h"
 #include "chre/util/singleton.h"
 #include "chre_api/chre/re.h"
 
@@ -97,6 +98,14 @@ class LogBufferManager : public LogBufferCallbackInterface {
    */
   void logVa(chreLogLevel logLevel, const char *formatStr, va_list args);
 
+  /**
+   * Similar to logVa() but defers the formatting of the log to the host by
+   * buffering the arguments in binary form. Falls back to logVa() if the log
+   * cannot be encoded. The format string must be part of the CHRE binary.
+   */
+  void logDeferredVa(chreLogLevel logLevel, const char *formatStr,
+                     va_list args);
+
   /**
    * Logs BT commands and events. These logs will not be displayed on logcat.
    * The BT events will be handled with a bt snoop log parser.
@@ -157,6 +166,20 @@ class LogBufferManager : public LogBufferCallbackInterface {
 
   void bufferOverflowGuard(size_t logSize, LogType type);
 
+  /**
+   * Sends the content of the secondary buffer to the host. When log compression
+   * is enabled, the logs are sent compressed in a V3 log message if that makes
+   * the message smaller.
+   */
+  void sendSecondaryBufferToHost();
+
+#ifdef CHRE_LOG_COMPRESSION_ENABLED
+  LzCompressor mLogCompressor;
+
+  //! Holds the compressed content of the secondary buffer while it is sent.
+  uint8_t mCompressedLogBufferData[CHRE_LOG_BUFFER_DATA_SIZE];
+#endif  // CHRE_LOG_COMPRESSION_ENABLED
+
   LogBuffer mPrimaryLogBuffer;
   LogBuffer mSecondaryLogBuffer;
 
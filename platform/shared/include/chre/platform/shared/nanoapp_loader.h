@@ -21,6 +21,7 @@
 #include <cstdlib>
 
 #include "chre/platform/shared/loader_util.h"
+#include "chre/platform/shared/streaming_elf_mapper.h"
 
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/optional.h"
@@ -83,6 +84,17 @@ class NanoappLoader {
    */
   static NanoappLoader *create(void *elfInput, bool mapIntoTcm);
 
+  /**
+   * Factory method to create a NanoappLoader Instance from a binary that was
+   * mapped while it was received.
+   *
+   * @param mapper A mapper the whole binary was appended to. The loader takes
+   *     over the mapping, section headers and section names on success.
+   * @return Class instance on successful load and verification,
+   *     nullptr otherwise.
+   */
+  static NanoappLoader *create(StreamingElfMapper &mapper);
+
   /**
    * Closes and destroys the NanoappLoader instance.
    *
@@ -104,6 +116,10 @@ class NanoappLoader {
    * Method for pointer lookup by symbol name. Only function pointers
    * are currently supported.
    *
+   * The lookup uses the DT_GNU_HASH or DT_HASH table of the binary if it has
+   * one, and a sorted index of the dynamic symbols built on the first lookup
+   * otherwise.
+   *
    * @return function pointer on successful lookup, nullptr otherwise
    */
   void *findSymbolByName(const char *name);
@@ -152,6 +168,8 @@ class NanoappLoader {
     mIsTcmBinary = mapIntoTcm;
   }
 
+  explicit NanoappLoader(StreamingElfMapper &mapper);
+
   /**
    * Opens the ELF binary. This maps the binary into memory, resolves symbols,
    * and invokes any static initializers.
@@ -199,6 +217,14 @@ class NanoappLoader {
   size_t mNumSectionHeaders = 0;
   //! Size of the data pointed to by mDynamicSymbolTablePtr.
   size_t mDynamicSymbolTableSize = 0;
+  //! Pointer to the mapped DT_GNU_HASH table, nullptr if the binary has none.
+  const ElfWord *mGnuHashTable = nullptr;
+  //! Pointer to the mapped DT_HASH table, only used if the binary has no
+  //! DT_GNU_HASH table. nullptr if the binary has none.
+  const ElfWord *mSysvHashTable = nullptr;
+  //! The positions of the dynamic symbols sorted by name, used for lookups when
+  //! the binary has no hash table. Allocated on the first lookup.
+  ElfWord *mSymbolsSortedByName = nullptr;
 
   //! The ELF that is being mapped into the system. This pointer will be invalid
   //! after open returns.
@@ -216,6 +242,10 @@ class NanoappLoader {
   DynamicVector<struct AtExitCallback> mAtexitFunctions;
   //! Whether this loader instance is managing a TCM nanoapp binary.
   bool mIsTcmBinary = false;
+  //! Whether the binary was mapped by a StreamingElfMapper, in which case
+  //! mBinary only holds the ELF and program headers, and the rest of the
+  //! binary is only available through the mapping.
+  bool mIsStreamed = false;
 
   /**
    * Invokes all functions registered via atexit during static initialization.
@@ -296,6 +326,30 @@ class NanoappLoader {
    */
   ElfSym *getDynamicSymbol(size_t posInSymbolTable);
 
+  /**
+   * Finds the dynamic symbol with the given name, using the hash table of the
+   * binary if it has one, or the sorted index of the dynamic symbols otherwise.
+   *
+   * @param name The exact name of the symbol.
+   * @return The symbol or nullptr if not found.
+   */
+  const ElfSym *lookupDynamicSymbol(const char *name);
+
+  /**
+   * Finds the dynamic symbol with the given name with a binary search of the
+   * dynamic symbols sorted by name, sorting them on the first call.
+   */
+  const ElfSym *lookupSortedIndex(const char *name);
+
+  /**
+   * Locates the symbol hash tables and the dynamic tables of the binary in the
+   * mapped segments, so that symbols can still be looked up once the input
+   * binary is released. Must be called after the mappings have been created.
+   *
+   * @return false if the dynamic tables are not part of a load segment.
+   */
+  bool initSymbolHashTables();
+
   /**
    * Retrieves the symbol name.
    *
@@ -373,6 +427,21 @@ class NanoappLoader {
     return reinterpret_cast<ElfHeader *>(mBinary);
   }
 
+  /**
+   * @param offset An offset in the binary being loaded.
+   * @return The address of the byte at this offset, nullptr if the binary was
+   *    streamed and this byte was not kept.
+   */
+  uint8_t *getFileData(size_t offset);
+
+  /**
+   * @param offset An offset in the binary being loaded.
+   * @return The address of the copy of the byte at this offset in the mapping,
+   *    nullptr if it is not part of a load segment. Must be called after the
+   *    mappings have been created.
+   */
+  uint8_t *getMappedData(size_t offset);
+
   /**
    * @return The array of program headers for the binary being loaded. nullptr
    *    if it doesn't exist or no binary is being loaded.
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_SHARED_STREAMING_ELF_MAPPER_H_
+#define CHRE_PLATFORM_SHARED_STREAMING_ELF_MAPPER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/platform/shared/loader_util.h"
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+/**
+ * Maps a nanoapp ELF binary received in fragments directly into its final
+ * memory, without ever holding the whole binary in memory.
+ *
+ * The ELF and program headers are parsed from the start of the binary, which
+ * allows allocating the mapping of the load segments before the rest of the
+ * binary is received. Each following fragment is then copied straight to the
+ * destination of the bytes it holds: the load segments go to the mapping, the
+ * section header table and the section names are kept for the loader, and
+ * everything else (symbol tables, debug info, token database, ...) is dropped.
+ *
+ * Once the last fragment has been appended, the mapping is handed over to
+ * NanoappLoader::create(StreamingElfMapper &), which relocates and initializes
+ * the nanoapp. This cuts the peak memory of a load roughly in half compared to
+ * assembling the binary before mapping it.
+ *
+ * Only 32-bit ELF binaries are supported, as for the rest of the loader.
+ */
+class StreamingElfMapper : public NonCopyable {
+ public:
+  using ElfHeader = Elf32_Ehdr;
+  using ProgramHeader = Elf32_Phdr;
+  using SectionHeader = Elf32_Shdr;
+
+  //! The maximum size of the ELF header and program headers, which must be at
+  //! the start of the binary.
+  static constexpr size_t kMaxHeadersSize = 512;
+
+  //! The maximum number of load segments.
+  static constexpr size_t kMaxLoadSegments = 4;
+
+  //! The section names are usually stored right before the section header
+  //! table, after the data that is dropped. This many bytes preceding the
+  //! section header table are kept until the section headers tell where the
+  //! names are.
+  static constexpr size_t kSectionNamesWindowSize = 1024;
+
+  /**
+   * @param binaryLen The size of the binary, in bytes.
+   * @param mapIntoTcm Whether the binary must be mapped into tightly coupled
+   *     memory.
+   */
+  StreamingElfMapper(size_t binaryLen, bool mapIntoTcm)
+      : mBinaryLen(binaryLen), mIsTcmMapping(mapIntoTcm) {}
+
+  ~StreamingElfMapper();
+
+  /**
+   * Appends the next fragment of the binary.
+   *
+   * @param data The fragment.
+   * @param size The size of the fragment.
+   * @return false if the binary is malformed, longer than expected, or if an
+   *     allocation failed, in which case the mapper must be discarded.
+   */
+  bool append(const void *data, size_t size);
+
+  /**
+   * @return true if the whole binary has been appended and mapped.
+   */
+  bool isComplete() const {
+    return mIsComplete;
+  }
+
+  /**
+   * @return The number of bytes of the binary appended so far.
+   */
+  size_t getNumBytesReceived() const {
+    return mNumBytesReceived;
+  }
+
+  /**
+   * @return The start of the binary, holding the ELF header and the program
+   *     headers at their offsets in the binary.
+   */
+  uint8_t *getHeaders() {
+    return mHeaders;
+  }
+
+  /**
+   * @return Whether the mapping is in tightly coupled memory.
+   */
+  bool isTcmMapping() const {
+    return mIsTcmMapping;
+  }
+
+  /**
+   * @return The size of the mapping.
+   */
+  size_t getMappingSize() const {
+    return mMappingSize;
+  }
+
+  /**
+   * @return The difference between the address the first load segment was
+   *     mapped at and its virtual address.
+   */
+  uintptr_t getLoadBias() const {
+    return mLoadBias;
+  }
+
+  /**
+   * @return The number of section headers.
+   */
+  size_t getNumSectionHeaders() const {
+    return mNumSectionHeaders;
+  }
+
+  /**
+   * Transfers the ownership of the mapping to the caller. It must be freed
+   * with nanoappBinaryFree() if isTcmMapping() is true, and with
+   * nanoappBinaryDramFree() otherwise.
+   */
+  uint8_t *releaseMapping() {
+    uint8_t *mapping = mMapping;
+    mMapping = nullptr;
+    return mapping;
+  }
+
+  /**
+   * Transfers the ownership of the section header table to the caller. It must
+   * be freed with memoryFreeDram().
+   */
+  SectionHeader *releaseSectionHeaders() {
+    SectionHeader *sectionHeaders = mSectionHeaders;
+    mSectionHeaders = nullptr;
+    return sectionHeaders;
+  }
+
+  /**
+   * Transfers the ownership of the section names to the caller. They must be
+   * freed with memoryFreeDram().
+   */
+  char *releaseSectionNames() {
+    char *sectionNames = mSectionNames;
+    mSectionNames = nullptr;
+    return sectionNames;
+  }
+
+ private:
+  //! A range of the binary and where its bytes must be copied to.
+  struct Route {
+    size_t offset;
+    size_t size;
+    uint8_t *destination;
+  };
+
+  //! The load segments, the section header table, the section names window,
+  //! and the section names if they follow the section header table.
+  static constexpr size_t kMaxRoutes = kMaxLoadSegments + 3;
+
+  size_t mBinaryLen;
+  size_t mNumBytesReceived = 0;
+  bool mIsTcmMapping;
+  bool mIsComplete = false;
+
+  //! The start of the binary, until the end of the program headers.
+  alignas(ElfHeader) uint8_t mHeaders[kMaxHeadersSize];
+  //! The size of the headers, set once the ELF header has been received.
+  size_t mHeadersSize = 0;
+
+  uint8_t *mMapping = nullptr;
+  size_t mMappingSize = 0;
+  uintptr_t mLoadBias = 0;
+
+  SectionHeader *mSectionHeaders = nullptr;
+  size_t mNumSectionHeaders = 0;
+  char *mSectionNames = nullptr;
+  //! The bytes preceding the section header table, only held until the
+  //! section names have been found.
+  uint8_t *mSectionNamesWindow = nullptr;
+  size_t mSectionNamesWindowOffset = 0;
+  size_t mSectionNamesWindowSize = 0;
+
+  Route mRoutes[kMaxRoutes];
+  size_t mNumRoutes = 0;
+
+  const ElfHeader *getElfHeader() const {
+    return reinterpret_cast<const ElfHeader *>(mHeaders);
+  }
+
+  const ProgramHeader *getProgramHeaders() const {
+    return reinterpret_cast<const ProgramHeader *>(mHeaders +
+                                                   getElfHeader()->e_phoff);
+  }
+
+  /**
+   * Verifies the ELF header and sets mHeadersSize.
+   */
+  bool parseElfHeader();
+
+  /**
+   * Allocates the mapping and the buffers the rest of the binary is copied to,
+   * and sets up the routes to them. Called once the headers are received.
+   */
+  bool setUpRoutes();
+
+  /**
+   * Adds a route, unless the range is empty.
+   */
+  bool addRoute(size_t offset, size_t size, uint8_t *destination);
+
+  /**
+   * Copies the bytes of the binary at the given offset to their routes.
+   */
+  void route(size_t offset, const uint8_t *data, size_t size);
+
+  /**
+   * Locates the section names once the section header table is received:
+   * copies them from the window if they have already been received, or adds
+   * a route for them otherwise.
+   */
+  bool locateSectionNames();
+
+  /**
+   * Verifies everything was received after the last fragment.
+   */
+  bool finish();
+
+  /**
+   * Frees all the memory owned by the mapper.
+   */
+  void freeAll();
+};
+
+}  // namespace chre
+
+#endif  // CHRE_PLATFORM_SHARED_STREAMING_ELF_MAPPER_H_
@@ -56,7 +56,7 @@ class PlatformDebugDumpManagerBase {
   /**
    * @see PlatformDebugDumpManager::sendDebugDump
    */
-  void sendDebugDumpResult(const char *debugStr, size_t debugStrSize,
+  bool sendDebugDumpResult(const char *debugStr, size_t debugStrSize,
                            bool complete);
 
 #ifdef CHRE_ENABLE_ASH_DEBUG_DUMP
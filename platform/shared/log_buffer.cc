@@ -20,17 +20,187 @@
 #include "chre/util/lock_guard.h"
 
 #include <cstdarg>
+#include <cstddef>
 #include <cstdio>
 
+extern "C" const char chreLogFormatAnchor[] = "";
+
 namespace chre {
 
 using LogType = fbs::LogType;
 
+namespace {
+
+/**
+ * Helper for writing the arguments of a deferred string log, failing once the
+ * output buffer is exhausted.
+ */
+class DeferredLogWriter {
+ public:
+  DeferredLogWriter(uint8_t *buffer, size_t bufferSize)
+      : mBuffer(buffer), mBufferSize(bufferSize) {}
+
+  bool writeBytes(const void *data, size_t size) {
+    if (mBufferSize - mOffset < size) {
+      return false;
+    }
+    memcpy(&mBuffer[mOffset], data, size);
+    mOffset += size;
+    return true;
+  }
+
+  bool writeVarint(uint64_t value) {
+    do {
+      uint8_t byte = value & 0x7f;
+      value >>= 7;
+      if (value != 0) {
+        byte |= 0x80;
+      }
+      if (!writeBytes(&byte, sizeof(byte))) {
+        return false;
+      }
+    } while (value != 0);
+    return true;
+  }
+
+  bool writeSigned(int64_t value) {
+    // Zigzag encoding keeps small negative values short.
+    return writeVarint((static_cast<uint64_t>(value) << 1) ^
+                       static_cast<uint64_t>(value >> 63));
+  }
+
+  /**
+   * Writes at most maxLen characters of str followed by a null terminator. As
+   * with printf, str does not need to be null terminated if it is at least
+   * maxLen characters long.
+   */
+  bool writeString(const char *str, size_t maxLen) {
+    if (str == nullptr) {
+      str = "(null)";
+    }
+    size_t len = strnlen(str, maxLen);
+    return writeBytes(str, len) && writeBytes("", 1);
+  }
+
+  size_t size() const {
+    return mOffset;
+  }
+
+ private:
+  uint8_t *mBuffer;
+  size_t mBufferSize;
+  size_t mOffset = 0;
+};
+
+//! The printf length modifiers that affect how an argument is read.
+enum class LengthModifier {
+  NONE,
+  CHAR,
+  SHORT,
+  LONG,
+  LONG_LONG,
+  INTMAX,
+  SIZE,
+  PTRDIFF,
+  LONG_DOUBLE,
+};
+
+int64_t readSignedArg(LengthModifier length, va_list &args) {
+  switch (length) {
+    case LengthModifier::CHAR:
+      return static_cast<signed char>(va_arg(args, int));
+    case LengthModifier::SHORT:
+      return static_cast<short>(va_arg(args, int));
+    case LengthModifier::LONG:
+      return va_arg(args, long);
+    case LengthModifier::LONG_LONG:
+      return va_arg(args, long long);
+    case LengthModifier::INTMAX:
+      return va_arg(args, intmax_t);
+    case LengthModifier::SIZE:
+    case LengthModifier::PTRDIFF:
+      return va_arg(args, ptrdiff_t);
+    default:
+      return va_arg(args, int);
+  }
+}
+
+uint64_t readUnsignedArg(LengthModifier length, va_list &args) {
+  switch (length) {
+    case LengthModifier::CHAR:
+      return static_cast<unsigned char>(va_arg(args, unsigned int));
+    case LengthModifier::SHORT:
+      return static_cast<unsigned short>(va_arg(args, unsigned int));
+    case LengthModifier::LONG:
+      return va_arg(args, unsigned long);
+    case LengthModifier::LONG_LONG:
+      return va_arg(args, unsigned long long);
+    case LengthModifier::INTMAX:
+      return va_arg(args, uintmax_t);
+    case LengthModifier::SIZE:
+    case LengthModifier::PTRDIFF:
+      return va_arg(args, size_t);
+    default:
+      return va_arg(args, unsigned int);
+  }
+}
+
+const char *parseLengthModifier(const char *c, LengthModifier *length) {
+  *length = LengthModifier::NONE;
+  switch (*c) {
+    case 'h':
+      *length = LengthModifier::SHORT;
+      if (*(c + 1) == 'h') {
+        *length = LengthModifier::CHAR;
+        c++;
+      }
+      c++;
+      break;
+    case 'l':
+      *length = LengthModifier::LONG;
+      if (*(c + 1) == 'l') {
+        *length = LengthModifier::LONG_LONG;
+        c++;
+      }
+      c++;
+      break;
+    case 'j':
+      *length = LengthModifier::INTMAX;
+      c++;
+      break;
+    case 'z':
+      *length = LengthModifier::SIZE;
+      c++;
+      break;
+    case 't':
+      *length = LengthModifier::PTRDIFF;
+      c++;
+      break;
+    case 'L':
+      *length = LengthModifier::LONG_DOUBLE;
+      c++;
+      break;
+  }
+  return c;
+}
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+}  // anonymous namespace
+
 LogBuffer::LogBuffer(LogBufferCallbackInterface *callback, void *buffer,
                      size_t bufferSize)
     : mBufferData(static_cast<uint8_t *>(buffer)),
+      mBufferDataHeadPosition(0),
+      mBufferDataTailPosition(0),
       mBufferMaxSize(bufferSize),
-      mCallback(callback) {
+      mNumLogsDropped(0),
+      mNumLogsInProgress(0),
+      mCallback(callback),
+      mNotificationPending(false),
+      mLastNotificationTimestampMs(0) {
   CHRE_ASSERT(bufferSize >= kBufferMinSize);
 }
 
@@ -58,26 +228,16 @@ void LogBuffer::handleBtLog(BtSnoopDirection direction, uint32_t timestampMs,
   auto logLen = static_cast<uint8_t>(size);
 
   if (size < kLogMaxSize) {
-    LockGuard<Mutex> lockGuard(mLock);
-
     static_assert(sizeof(LogType) == sizeof(uint8_t),
                   "LogType size is not equal to size of uint8_t");
     static_assert(sizeof(direction) == sizeof(uint8_t),
                   "BtSnoopDirection size is not equal to the size of uint8_t");
-    uint8_t snoopLogDirection = static_cast<uint8_t>(direction);
-
-    discardExcessOldLogsLocked(logLen + kBtSnoopLogOffset);
+    uint8_t dataHeader[kBtSnoopLogOffset] = {static_cast<uint8_t>(direction),
+                                             logLen};
 
     // Set all BT logs to the CHRE_LOG_LEVEL_INFO.
-    uint8_t metadata =
-        setLogMetadata(LogType::BLUETOOTH, LogBufferLogLevel::INFO);
-
-    copyVarToBuffer(&metadata);
-    copyVarToBuffer(&timestampMs);
-    copyVarToBuffer(&snoopLogDirection);
-    copyVarToBuffer(&logLen);
-
-    copyToBuffer(logLen, buffer);
+    copyLogToBuffer(LogBufferLogLevel::INFO, timestampMs, dataHeader,
+                    kBtSnoopLogOffset, buffer, logLen, LogType::BLUETOOTH);
   } else {
     // Cannot truncate a BT event. Log a failure message instead.
     constexpr char kBtSnoopLogGenericErrorMsg[] =
@@ -86,10 +246,13 @@ void LogBuffer::handleBtLog(BtSnoopDirection direction, uint32_t timestampMs,
         sizeof(kBtSnoopLogGenericErrorMsg) <= kLogMaxSize,
         "Error meessage size needs to be smaller than max log length");
     logLen = static_cast<uint8_t>(sizeof(kBtSnoopLogGenericErrorMsg));
-    copyLogToBuffer(LogBufferLogLevel::INFO, timestampMs,
-                    kBtSnoopLogGenericErrorMsg, logLen, LogType::BLUETOOTH);
+    uint8_t dataHeader[kBtSnoopLogOffset] = {static_cast<uint8_t>(direction),
+                                             logLen};
+    copyLogToBuffer(LogBufferLogLevel::INFO, timestampMs, dataHeader,
+                    kBtSnoopLogOffset, kBtSnoopLogGenericErrorMsg, logLen,
+                    LogType::BLUETOOTH);
   }
-  dispatch();
+  dispatch(timestampMs);
 }
 #endif  // CHRE_BLE_SUPPORT_ENABLED
 
@@ -99,6 +262,126 @@ void LogBuffer::handleEncodedLog(LogBufferLogLevel logLevel,
   processLog(logLevel, timestampMs, log, logSize, LogType::TOKENIZED);
 }
 
+void LogBuffer::handleDeferredLog(LogBufferLogLevel logLevel,
+                                  uint32_t timestampMs, const uint8_t *log,
+                                  size_t logSize) {
+  processLog(logLevel, timestampMs, log, logSize, LogType::DEFERRED_STRING);
+}
+
+size_t LogBuffer::encodeDeferredLogVa(const char *logFormat, va_list args,
+                                      uint8_t *buffer, size_t bufferSize) {
+  DeferredLogWriter writer(buffer, bufferSize);
+
+  auto formatOffset = static_cast<int32_t>(
+      reinterpret_cast<uintptr_t>(logFormat) -
+      reinterpret_cast<uintptr_t>(chreLogFormatAnchor));
+  uint8_t formatOffsetBytes[sizeof(formatOffset)];
+  for (size_t i = 0; i < sizeof(formatOffset); i++) {
+    formatOffsetBytes[i] =
+        static_cast<uint8_t>(static_cast<uint32_t>(formatOffset) >> (8 * i));
+  }
+  if (!writer.writeBytes(formatOffsetBytes, sizeof(formatOffsetBytes))) {
+    return 0;
+  }
+
+  // va_list may be an array type, so work on a copy that can be passed by
+  // reference to the argument readers.
+  va_list argsCopy;
+  va_copy(argsCopy, args);
+  bool success = true;
+  for (const char *c = logFormat; success && *c != '\0'; c++) {
+    if (*c != '%') {
+      continue;
+    }
+    c++;
+    if (*c == '%') {
+      continue;
+    }
+
+    while (*c == '-' || *c == '+' || *c == ' ' || *c == '#' || *c == '0') {
+      c++;
+    }
+    if (*c == '*') {
+      success = writer.writeSigned(va_arg(argsCopy, int));
+      c++;
+    }
+    while (isDigit(*c)) {
+      c++;
+    }
+    // A negative precision is taken as if it were omitted.
+    int precision = -1;
+    if (*c == '.') {
+      c++;
+      precision = 0;
+      if (*c == '*') {
+        precision = va_arg(argsCopy, int);
+        success = success && writer.writeSigned(precision);
+        c++;
+      }
+      while (isDigit(*c)) {
+        precision = precision * 10 + (*c - '0');
+        c++;
+      }
+    }
+
+    LengthModifier length;
+    c = parseLengthModifier(c, &length);
+    if (!success) {
+      break;
+    }
+
+    switch (*c) {
+      case 'd':
+      case 'i':
+        success = writer.writeSigned(readSignedArg(length, argsCopy));
+        break;
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        success = writer.writeVarint(readUnsignedArg(length, argsCopy));
+        break;
+      case 'c':
+        success = writer.writeVarint(
+            static_cast<unsigned char>(va_arg(argsCopy, int)));
+        break;
+      case 'p':
+        success = writer.writeVarint(
+            reinterpret_cast<uintptr_t>(va_arg(argsCopy, void *)));
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        if (length == LengthModifier::LONG_DOUBLE) {
+          success = false;
+        } else {
+          double value = va_arg(argsCopy, double);
+          success = writer.writeBytes(&value, sizeof(value));
+        }
+        break;
+      }
+      case 's':
+        // As with printf, no more characters than the precision are read.
+        success = writer.writeString(
+            va_arg(argsCopy, const char *),
+            (precision < 0) ? SIZE_MAX : static_cast<size_t>(precision));
+        break;
+      default:
+        // %n, wide characters and malformed conversions are not supported.
+        success = false;
+        break;
+    }
+  }
+  va_end(argsCopy);
+
+  return success ? writer.size() : 0;
+}
+
 void LogBuffer::handleNanoappTokenizedLog(LogBufferLogLevel logLevel,
                                           uint32_t timestampMs,
                                           uint16_t instanceId,
@@ -114,8 +397,7 @@ size_t LogBuffer::copyLogs(void *destination, size_t size,
 }
 
 bool LogBuffer::logWouldCauseOverflow(size_t logSize) {
-  LockGuard<Mutex> lock(mLock);
-  return (mBufferDataSize + logSize + kLogDataOffset > mBufferMaxSize);
+  return (getBufferSize() + logSize + kLogDataOffset > mBufferMaxSize);
 }
 
 void LogBuffer::transferTo(LogBuffer &buffer) {
@@ -131,12 +413,10 @@ void LogBuffer::transferTo(LogBuffer &buffer) {
 
     bytesCopied = copyLogsLocked(buffer.mBufferData, buffer.mBufferMaxSize,
                                  &numLogsDropped);
-
-    resetLocked();
+    mNumLogsDropped.store(0);
   }
-  buffer.mBufferDataTailIndex = bytesCopied % buffer.mBufferMaxSize;
-  buffer.mBufferDataSize = bytesCopied;
-  buffer.mNumLogsDropped = numLogsDropped;
+  buffer.mBufferDataTailPosition.store(static_cast<uint32_t>(bytesCopied));
+  buffer.mNumLogsDropped.store(static_cast<uint32_t>(numLogsDropped));
 }
 
 void LogBuffer::updateNotificationSetting(LogBufferNotificationSetting setting,
@@ -157,13 +437,12 @@ const uint8_t *LogBuffer::getBufferData() {
 }
 
 size_t LogBuffer::getBufferSize() {
-  LockGuard<Mutex> lockGuard(mLock);
-  return mBufferDataSize;
+  return usedBytes(mBufferDataHeadPosition.load(),
+                   mBufferDataTailPosition.load());
 }
 
 size_t LogBuffer::getNumLogsDropped() {
-  LockGuard<Mutex> lockGuard(mLock);
-  return mNumLogsDropped;
+  return mNumLogsDropped.load();
 }
 
 size_t LogBuffer::incrementAndModByBufferMaxSize(size_t originalVal,
@@ -171,65 +450,97 @@ size_t LogBuffer::incrementAndModByBufferMaxSize(size_t originalVal,
   return (originalVal + incrementBy) % mBufferMaxSize;
 }
 
-void LogBuffer::copyToBuffer(size_t size, const void *source) {
+uint32_t LogBuffer::advancePosition(uint32_t position, size_t size) const {
+  return static_cast<uint32_t>((position + size) % (2 * mBufferMaxSize));
+}
+
+size_t LogBuffer::positionToIndex(uint32_t position) const {
+  return (position >= mBufferMaxSize) ? position - mBufferMaxSize : position;
+}
+
+size_t LogBuffer::usedBytes(uint32_t headPosition,
+                            uint32_t tailPosition) const {
+  return (tailPosition + 2 * mBufferMaxSize - headPosition) %
+         (2 * mBufferMaxSize);
+}
+
+size_t LogBuffer::copyToBuffer(size_t index, size_t size, const void *source) {
   const uint8_t *sourceBytes = static_cast<const uint8_t *>(source);
-  if (mBufferDataTailIndex + size > mBufferMaxSize) {
-    size_t firstSize = mBufferMaxSize - mBufferDataTailIndex;
+  if (index + size > mBufferMaxSize) {
+    size_t firstSize = mBufferMaxSize - index;
     size_t secondSize = size - firstSize;
-    memcpy(&mBufferData[mBufferDataTailIndex], sourceBytes, firstSize);
+    memcpy(&mBufferData[index], sourceBytes, firstSize);
     memcpy(mBufferData, &sourceBytes[firstSize], secondSize);
   } else {
-    memcpy(&mBufferData[mBufferDataTailIndex], sourceBytes, size);
+    memcpy(&mBufferData[index], sourceBytes, size);
   }
-  mBufferDataSize += size;
-  mBufferDataTailIndex =
-      incrementAndModByBufferMaxSize(mBufferDataTailIndex, size);
+  return incrementAndModByBufferMaxSize(index, size);
 }
 
-void LogBuffer::copyFromBuffer(size_t size, void *destination) {
+void LogBuffer::copyFromBuffer(size_t index, size_t size, void *destination) {
   uint8_t *destinationBytes = static_cast<uint8_t *>(destination);
-  if (mBufferDataHeadIndex + size > mBufferMaxSize) {
-    size_t firstSize = mBufferMaxSize - mBufferDataHeadIndex;
+  if (index + size > mBufferMaxSize) {
+    size_t firstSize = mBufferMaxSize - index;
     size_t secondSize = size - firstSize;
-    memcpy(destinationBytes, &mBufferData[mBufferDataHeadIndex], firstSize);
+    memcpy(destinationBytes, &mBufferData[index], firstSize);
     memcpy(&destinationBytes[firstSize], mBufferData, secondSize);
   } else {
-    memcpy(destinationBytes, &mBufferData[mBufferDataHeadIndex], size);
+    memcpy(destinationBytes, &mBufferData[index], size);
   }
-  mBufferDataSize -= size;
-  mBufferDataHeadIndex =
-      incrementAndModByBufferMaxSize(mBufferDataHeadIndex, size);
+}
+
+bool LogBuffer::logsWrittenUpTo(uint32_t numOwnLogs) const {
+  // A producer counts itself before reserving, so the producer of any entry
+  // below the loaded tail is either counted here or done writing it.
+  return mNumLogsInProgress.load() == numOwnLogs;
 }
 
 size_t LogBuffer::copyLogsLocked(void *destination, size_t size,
                                  size_t *numLogsDropped) {
   size_t copySize = 0;
 
-  if (size != 0 && destination != nullptr && mBufferDataSize != 0) {
-    if (size >= mBufferDataSize) {
-      copySize = mBufferDataSize;
-    } else {
+  // Re-arm the notification on every copy attempt, including ones that copy
+  // nothing because a log is still being written. Clearing it before
+  // scanning the buffer guarantees that a log published after the scan raises
+  // a new notification.
+  mNotificationPending.store(false);
+
+  if (size != 0 && destination != nullptr) {
+    uint32_t headPosition = mBufferDataHeadPosition.load();
+    size_t usedSize =
+        usedBytes(headPosition, mBufferDataTailPosition.load());
+    if (!logsWrittenUpTo(0 /* numOwnLogs */)) {
+      // Copied on the notification of the log being written.
+      usedSize = 0;
+    }
+    size_t headIndex = positionToIndex(headPosition);
+    size_t logStartIndex = headIndex;
+    while (copySize < usedSize) {
       size_t logSize;
-      size_t logStartIndex = getNextLogIndex(mBufferDataHeadIndex, &logSize);
-      while (copySize + logSize <= size &&
-             copySize + logSize <= mBufferDataSize) {
-        copySize += logSize;
-        logStartIndex = getNextLogIndex(logStartIndex, &logSize);
+      size_t nextLogStartIndex = getNextLogIndex(logStartIndex, &logSize);
+      if (copySize + logSize > size) {
+        break;
       }
+      copySize += logSize;
+      logStartIndex = nextLogStartIndex;
+    }
+
+    if (copySize != 0) {
+      copyFromBuffer(headIndex, copySize, destination);
+      mBufferDataHeadPosition.store(advancePosition(headPosition, copySize));
     }
-    copyFromBuffer(copySize, destination);
   }
 
-  *numLogsDropped = mNumLogsDropped;
+  *numLogsDropped = mNumLogsDropped.load();
 
   return copySize;
 }
 
 void LogBuffer::resetLocked() {
-  mBufferDataHeadIndex = 0;
-  mBufferDataTailIndex = 0;
-  mBufferDataSize = 0;
-  mNumLogsDropped = 0;
+  mBufferDataHeadPosition.store(0);
+  mBufferDataTailPosition.store(0);
+  mNumLogsDropped.store(0);
+  mNotificationPending.store(false);
 }
 
 size_t LogBuffer::getNextLogIndex(size_t startingIndex, size_t *logSize) {
@@ -261,6 +572,10 @@ size_t LogBuffer::getLogDataLength(size_t startingIndex, LogType type) {
       numBytes = mBufferData[startingIndex] + kTokenizedLogOffset;
       break;
 
+    case LogType::DEFERRED_STRING:
+      numBytes = mBufferData[startingIndex] + kDeferredStringLogOffset;
+      break;
+
     case LogType::BLUETOOTH:
       // +1 to account for the bt snoop direction.
       currentIndex = incrementAndModByBufferMaxSize(startingIndex, 1);
@@ -311,88 +626,131 @@ void LogBuffer::processLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
     type = LogType::STRING;
   }
 
-  copyLogToBuffer(logLevel, timestampMs, logBuffer, logLen, type, instanceId);
-  dispatch();
-}
-
-void LogBuffer::copyLogToBuffer(LogBufferLogLevel level, uint32_t timestampMs,
-                                const void *logBuffer, uint8_t logLen,
-                                LogType type, uint16_t instanceId) {
-  LockGuard<Mutex> lockGuard(mLock);
+  uint8_t dataHeader[kMaxLogDataHeaderSize];
+  uint8_t dataHeaderLen = 0;
   if (type == LogType::NANOAPP_TOKENIZED) {
-    discardExcessOldLogsLocked(logLen + kNanoappTokenizedLogOffset);
-  } else {
-    // For STRING logs, add 1 byte for null terminator. For TOKENIZED logs, add
-    // 1 byte for the size metadata added to the message.
-    discardExcessOldLogsLocked(logLen + 1);
+    memcpy(dataHeader, &instanceId, sizeof(instanceId));
+    dataHeader[sizeof(instanceId)] = logLen;
+    dataHeaderLen = kNanoappTokenizedLogOffset;
+  } else if (type == LogType::TOKENIZED) {
+    dataHeader[0] = logLen;
+    dataHeaderLen = kTokenizedLogOffset;
+  } else if (type == LogType::DEFERRED_STRING) {
+    dataHeader[0] = logLen;
+    dataHeaderLen = kDeferredStringLogOffset;
   }
-  encodeAndCopyLogLocked(level, timestampMs, logBuffer, logLen, type,
-                         instanceId);
+
+  copyLogToBuffer(logLevel, timestampMs, dataHeader, dataHeaderLen, logBuffer,
+                  logLen, type);
+  dispatch(timestampMs);
 }
 
-void LogBuffer::discardExcessOldLogsLocked(uint8_t currentLogLen) {
-  size_t totalLogSize = kLogDataOffset + currentLogLen;
-  while (mBufferDataSize + totalLogSize > mBufferMaxSize) {
-    mNumLogsDropped++;
-    size_t logSize;
-    mBufferDataHeadIndex = getNextLogIndex(mBufferDataHeadIndex, &logSize);
-    mBufferDataSize -= logSize;
+void LogBuffer::copyLogToBuffer(LogBufferLogLevel level, uint32_t timestampMs,
+                                const uint8_t *dataHeader,
+                                uint8_t dataHeaderLen, const void *logBuffer,
+                                uint8_t logLen, LogType type) {
+  // STRING logs are followed by a null terminator.
+  size_t trailerLen = (type == LogType::STRING) ? kStringLogOverhead : 0;
+  size_t entrySize = kLogDataOffset + dataHeaderLen + logLen + trailerLen;
+
+  // Consumers leave the logs in the buffer until this one is written.
+  mNumLogsInProgress.fetch_increment();
+  uint32_t position;
+  if (reserve(entrySize, &position)) {
+    uint8_t metadata = setLogMetadata(type, level);
+    size_t index = copyToBuffer(positionToIndex(position), 1, &metadata);
+    index = copyToBuffer(index, sizeof(timestampMs), &timestampMs);
+    index = copyToBuffer(index, dataHeaderLen, dataHeader);
+    index = copyToBuffer(index, logLen, logBuffer);
+    if (trailerLen != 0) {
+      copyToBuffer(index, trailerLen, "\0");
+    }
   }
+  mNumLogsInProgress.fetch_decrement();
 }
 
-void LogBuffer::encodeAndCopyLogLocked(LogBufferLogLevel level,
-                                       uint32_t timestampMs,
-                                       const void *logBuffer, uint8_t logLen,
-                                       LogType type, uint16_t instanceId) {
-  uint8_t metadata = setLogMetadata(type, level);
+bool LogBuffer::tryReserve(size_t entrySize, uint32_t *position) {
+  uint32_t tailPosition = mBufferDataTailPosition.load();
+  uint32_t newTailPosition;
+  do {
+    uint32_t headPosition = mBufferDataHeadPosition.load();
+    if (usedBytes(headPosition, tailPosition) + entrySize > mBufferMaxSize) {
+      return false;
+    }
+    newTailPosition = advancePosition(tailPosition, entrySize);
+  } while (
+      !mBufferDataTailPosition.compare_exchange(tailPosition, newTailPosition));
 
-  copyVarToBuffer(&metadata);
-  copyVarToBuffer(&timestampMs);
+  *position = tailPosition;
+  return true;
+}
 
-  if (type == LogType::NANOAPP_TOKENIZED) {
-    copyVarToBuffer(&instanceId);
-    copyVarToBuffer(&logLen);
-  } else if (type == LogType::TOKENIZED) {
-    copyVarToBuffer(&logLen);
+bool LogBuffer::reserve(size_t entrySize, uint32_t *position) {
+  if (tryReserve(entrySize, position)) {
+    return true;
   }
-  copyToBuffer(logLen, logBuffer);
-  if (type == LogType::STRING) {
-    copyToBuffer(1, reinterpret_cast<const void *>("\0"));
+
+  LockGuard<Mutex> lockGuard(mLock);
+  while (!tryReserve(entrySize, position)) {
+    if (!discardOldestLogLocked()) {
+      // Another producer is still writing a log, possibly the oldest one, so
+      // there is no way of making room without blocking on it. Drop this log
+      // instead.
+      mNumLogsDropped.fetch_increment();
+      return false;
+    }
   }
+  return true;
 }
 
-void LogBuffer::dispatch() {
-  if (mCallback != nullptr) {
-    switch (mNotificationSetting) {
-      case LogBufferNotificationSetting::ALWAYS: {
-        mCallback->onLogsReady();
-        break;
-      }
-      case LogBufferNotificationSetting::NEVER: {
-        break;
-      }
-      case LogBufferNotificationSetting::THRESHOLD: {
-        if (mBufferDataSize > mNotificationThresholdBytes) {
-          mCallback->onLogsReady();
-        }
-        break;
-      }
+bool LogBuffer::discardOldestLogLocked() {
+  uint32_t headPosition = mBufferDataHeadPosition.load();
+  if (usedBytes(headPosition, mBufferDataTailPosition.load()) == 0 ||
+      !logsWrittenUpTo(1 /* numOwnLogs */)) {
+    return false;
+  }
+
+  size_t logSize;
+  getNextLogIndex(positionToIndex(headPosition), &logSize);
+  mBufferDataHeadPosition.store(advancePosition(headPosition, logSize));
+  mNumLogsDropped.fetch_increment();
+  return true;
+}
+
+void LogBuffer::dispatch(uint32_t timestampMs) {
+  if (mCallback == nullptr) {
+    return;
+  }
+
+  bool logsReady = false;
+  switch (mNotificationSetting) {
+    case LogBufferNotificationSetting::ALWAYS: {
+      logsReady = true;
+      break;
+    }
+    case LogBufferNotificationSetting::NEVER: {
+      break;
+    }
+    case LogBufferNotificationSetting::THRESHOLD: {
+      logsReady = getBufferSize() > mNotificationThresholdBytes;
+      break;
     }
   }
+
+  // Only one notification is raised until the logs are copied out, unless the
+  // consumer did not act on it within the coalescing window.
+  if (logsReady &&
+      (!mNotificationPending.exchange(true) ||
+       timestampMs - mLastNotificationTimestampMs.load() >=
+           kNotificationCoalescingWindowMs)) {
+    mLastNotificationTimestampMs.store(timestampMs);
+    mCallback->onLogsReady();
+  }
 }
 
 LogType LogBuffer::getLogTypeFromMetadata(uint8_t metadata) {
-  LogType type;
-  if (((metadata & 0x20) != 0) && ((metadata & 0x10) != 0)) {
-    type = LogType::NANOAPP_TOKENIZED;
-  } else if ((metadata & 0x20) != 0) {
-    type = LogType::BLUETOOTH;
-  } else if ((metadata & 0x10) != 0) {
-    type = LogType::TOKENIZED;
-  } else {
-    type = LogType::STRING;
-  }
-  return type;
+  // The upper nibble of the metadata holds the log type, see setLogMetadata().
+  return static_cast<LogType>(metadata >> 4);
 }
 
 uint8_t LogBuffer::setLogMetadata(LogType type, LogBufferLogLevel logLevel) {
@@ -402,6 +760,8 @@ uint8_t LogBuffer::setLogMetadata(LogType type, LogBufferLogLevel logLevel) {
 bool LogBuffer::tokenizedLogExceedsMaxSize(LogType type, size_t size) {
   return (type == LogType::TOKENIZED &&
           size >= kLogMaxSize - kTokenizedLogOffset) ||
+         (type == LogType::DEFERRED_STRING &&
+          size >= kLogMaxSize - kDeferredStringLogOffset) ||
          (type == LogType::NANOAPP_TOKENIZED &&
           size >= kLogMaxSize - kNanoappTokenizedLogOffset);
 }
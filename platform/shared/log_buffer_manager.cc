@@ -27,7 +27,12 @@ void chrePlatformLogToBuffer(chreLogLevel chreLogLevel, const char *format,
   va_list args;
   va_start(args, format);
   if (chre::LogBufferManagerSingleton::isInitialized()) {
+#ifdef CHRE_DEFERRED_STRING_LOGGING_ENABLED
+    chre::LogBufferManagerSingleton::get()->logDeferredVa(chreLogLevel, format,
+                                                          args);
+#else
     chre::LogBufferManagerSingleton::get()->logVa(chreLogLevel, format, args);
+#endif  // CHRE_DEFERRED_STRING_LOGGING_ENABLED
   }
   va_end(args);
 }
@@ -85,8 +90,6 @@ void LogBufferManager::startSendLogsToHostLoop() {
             ->getEventLoop()
             .getPowerControlManager()
             .hostIsAwake()) {
-      auto &hostCommsMgr =
-          EventLoopManagerSingleton::get()->getHostCommsManager();
       preSecondaryBufferUse();
       if (mSecondaryLogBuffer.getBufferSize() == 0) {
         // TODO (b/184178045): Transfer logs into the secondary buffer from
@@ -103,9 +106,7 @@ void LogBufferManager::startSendLogsToHostLoop() {
       if (mSecondaryLogBuffer.getBufferSize() > 0) {
         mNumLogsDroppedTotal += mSecondaryLogBuffer.getNumLogsDropped();
         mFlushLogsMutex.unlock();
-        hostCommsMgr.sendLogMessageV2(mSecondaryLogBuffer.getBufferData(),
-                                      mSecondaryLogBuffer.getBufferSize(),
-                                      mNumLogsDroppedTotal);
+        sendSecondaryBufferToHost();
         logWasSent = true;
         mFlushLogsMutex.lock();
       }
@@ -116,6 +117,27 @@ void LogBufferManager::startSendLogsToHostLoop() {
   }
 }
 
+void LogBufferManager::sendSecondaryBufferToHost() {
+  auto &hostCommsMgr = EventLoopManagerSingleton::get()->getHostCommsManager();
+  const uint8_t *logData = mSecondaryLogBuffer.getBufferData();
+  size_t logDataSize = mSecondaryLogBuffer.getBufferSize();
+
+#ifdef CHRE_LOG_COMPRESSION_ENABLED
+  // Compression fails if the output would not fit in the compressed buffer, in
+  // which case the logs are sent uncompressed.
+  size_t compressedSize =
+      mLogCompressor.compress(logData, logDataSize, mCompressedLogBufferData,
+                              sizeof(mCompressedLogBufferData));
+  if (compressedSize > 0 && compressedSize < logDataSize) {
+    hostCommsMgr.sendLogMessageV3(mCompressedLogBufferData, compressedSize,
+                                  logDataSize, mNumLogsDroppedTotal);
+    return;
+  }
+#endif  // CHRE_LOG_COMPRESSION_ENABLED
+
+  hostCommsMgr.sendLogMessageV2(logData, logDataSize, mNumLogsDroppedTotal);
+}
+
 void LogBufferManager::log(chreLogLevel logLevel, const char *formatStr, ...) {
   va_list args;
   va_start(args, formatStr);
@@ -142,6 +164,9 @@ void LogBufferManager::bufferOverflowGuard(size_t logSize, LogType type) {
     case LogType::NANOAPP_TOKENIZED:
       logSize += LogBuffer::kNanoappTokenizedLogOffset;
       break;
+    case LogType::DEFERRED_STRING:
+      logSize += LogBuffer::kDeferredStringLogOffset;
+      break;
     default:
       CHRE_ASSERT_LOG(false, "Received unexpected log message type");
       break;
@@ -168,6 +193,21 @@ void LogBufferManager::logVa(chreLogLevel logLevel, const char *formatStr,
                                 getTimestampMs(), formatStr, args);
 }
 
+void LogBufferManager::logDeferredVa(chreLogLevel logLevel,
+                                     const char *formatStr, va_list args) {
+  uint8_t encodedLog[LogBuffer::kDeferredStringLogMaxSize];
+  size_t encodedLogSize = LogBuffer::encodeDeferredLogVa(
+      formatStr, args, encodedLog, sizeof(encodedLog));
+  if (encodedLogSize == 0) {
+    logVa(logLevel, formatStr, args);
+  } else {
+    bufferOverflowGuard(encodedLogSize, LogType::DEFERRED_STRING);
+    mPrimaryLogBuffer.handleDeferredLog(chreToLogBufferLogLevel(logLevel),
+                                        getTimestampMs(), encodedLog,
+                                        encodedLogSize);
+  }
+}
+
 void LogBufferManager::logBtSnoop(BtSnoopDirection direction,
                                   const uint8_t *buffer, size_t size) {
 #ifdef CHRE_BLE_SUPPORT_ENABLED
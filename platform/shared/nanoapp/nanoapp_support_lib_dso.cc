@@ -24,6 +24,7 @@
 #include <algorithm>
 
 #include "chre_api/chre.h"
+#include "chre_ext/audio_features.h"
 #include "chre_nsl_internal/platform/shared/debug_dump.h"
 #include "chre_nsl_internal/util/macros.h"
 #include "chre_nsl_internal/util/system/napp_permissions.h"
@@ -273,6 +274,17 @@ bool chreAudioGetStatus(uint32_t handle, struct chreAudioSourceStatus *status) {
 }
 #endif /* CHRE_FIRST_SUPPORTED_API_VERSION < CHRE_API_VERSION_1_2 */
 
+WEAK_SYMBOL
+bool chreextAudioConfigureFeatures(uint32_t handle, bool enable,
+                                   uint64_t deliveryInterval,
+                                   uint32_t frameSize, uint32_t hopSize,
+                                   uint16_t numBins) {
+  auto *fptr = CHRE_NSL_LAZY_LOOKUP(chreextAudioConfigureFeatures);
+  return (fptr != nullptr) ? fptr(handle, enable, deliveryInterval, frameSize,
+                                  hopSize, numBins)
+                           : false;
+}
+
 #endif /* CHRE_NANOAPP_USES_AUDIO */
 
 #ifdef CHRE_NANOAPP_USES_BLE
@@ -15,6 +15,7 @@
  */
 
 #include <dlfcn.h>
+#include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstring>
@@ -25,11 +26,14 @@
 #include "chre/platform/assert.h"
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/shared/debug_dump.h"
+#include "chre/platform/shared/elf_symbol_hash.h"
 #include "chre/platform/shared/memory.h"
 #include "chre/platform/shared/nanoapp/tokenized_log.h"
 #include "chre/target_platform/platform_cache_management.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/macros.h"
+#include "chre/util/symbol_index.h"
+#include "chre_ext/audio_features.h"
 
 #ifdef CHREX_SYMBOL_EXTENSIONS
 #include "chre/extensions/platform/symbol_list.h"
@@ -281,10 +285,38 @@ const ExportedData kExportedData[] = {
     ADD_EXPORTED_C_SYMBOL(chreConfigureHostEndpointNotifications),
     ADD_EXPORTED_C_SYMBOL(chrePublishRpcServices),
     ADD_EXPORTED_C_SYMBOL(chreGetHostEndpointInfo),
+    /* CHRE implementation extensions */
+    ADD_EXPORTED_C_SYMBOL(chreextAudioConfigureFeatures),
 };
 CHRE_DEPRECATED_EPILOGUE
 // clang-format on
 
+#ifdef CHREX_SYMBOL_EXTENSIONS
+constexpr size_t kNumExportedSymbols =
+    ARRAY_SIZE(kExportedData) + ARRAY_SIZE(kVendorExportedData);
+#else
+constexpr size_t kNumExportedSymbols = ARRAY_SIZE(kExportedData);
+#endif
+
+//! Index of the exported symbols, used to resolve each relocation without
+//! scanning the tables.
+class ExportedSymbolIndex
+    : public SymbolIndex<ExportedData, kNumExportedSymbols> {
+ public:
+  ExportedSymbolIndex() {
+    bool success = add(kExportedData, ARRAY_SIZE(kExportedData));
+#ifdef CHREX_SYMBOL_EXTENSIONS
+    success &= add(kVendorExportedData, ARRAY_SIZE(kVendorExportedData));
+#endif
+    CHRE_ASSERT(success);
+  }
+};
+
+//! Built during static initialization, after the tables defined above it, and
+//! only read afterwards, so the threads loading nanoapps can share it without
+//! synchronization.
+const ExportedSymbolIndex gExportedSymbolIndex;
+
 }  // namespace
 
 NanoappLoader *NanoappLoader::create(void *elfInput, bool mapIntoTcm) {
@@ -311,6 +343,47 @@ NanoappLoader *NanoappLoader::create(void *elfInput, bool mapIntoTcm) {
   return nullptr;
 }
 
+NanoappLoader *NanoappLoader::create(StreamingElfMapper &mapper) {
+  if (!mapper.isComplete()) {
+    LOGE("Nanoapp binary was not completely mapped");
+    return nullptr;
+  }
+
+  auto *loader =
+      static_cast<NanoappLoader *>(memoryAllocDram(sizeof(NanoappLoader)));
+  if (loader == nullptr) {
+    LOG_OOM();
+    return nullptr;
+  }
+  new (loader) NanoappLoader(mapper);
+
+  if (loader->open()) {
+    return loader;
+  }
+
+  // Call the destructor explicitly as memoryFreeDram() never calls it.
+  loader->~NanoappLoader();
+  memoryFreeDram(loader);
+  return nullptr;
+}
+
+NanoappLoader::NanoappLoader(StreamingElfMapper &mapper) {
+  // The loader only supports 32-bit binaries, like the mapper.
+  static_assert(sizeof(SectionHeader) ==
+                    sizeof(StreamingElfMapper::SectionHeader),
+                "Section headers of the mapper and loader must match");
+  mBinary = mapper.getHeaders();
+  mIsTcmBinary = mapper.isTcmMapping();
+  mIsStreamed = true;
+  mMemorySpan = mapper.getMappingSize();
+  mLoadBias = mapper.getLoadBias();
+  mMapping = mapper.releaseMapping();
+  mNumSectionHeaders = mapper.getNumSectionHeaders();
+  mSectionHeadersPtr =
+      reinterpret_cast<SectionHeader *>(mapper.releaseSectionHeaders());
+  mSectionNamesPtr = mapper.releaseSectionNames();
+}
+
 void NanoappLoader::destroy(NanoappLoader *loader) {
   loader->close();
   // TODO(b/151847750): Modify utilities to support free'ing from regions other
@@ -320,24 +393,8 @@ void NanoappLoader::destroy(NanoappLoader *loader) {
 }
 
 void *NanoappLoader::findExportedSymbol(const char *name) {
-  size_t nameLen = strlen(name);
-  for (size_t i = 0; i < ARRAY_SIZE(kExportedData); i++) {
-    if (nameLen == strlen(kExportedData[i].dataName) &&
-        strncmp(name, kExportedData[i].dataName, nameLen) == 0) {
-      return kExportedData[i].data;
-    }
-  }
-
-#ifdef CHREX_SYMBOL_EXTENSIONS
-  for (size_t i = 0; i < ARRAY_SIZE(kVendorExportedData); i++) {
-    if (nameLen == strlen(kVendorExportedData[i].dataName) &&
-        strncmp(name, kVendorExportedData[i].dataName, nameLen) == 0) {
-      return kVendorExportedData[i].data;
-    }
-  }
-#endif
-
-  return nullptr;
+  const ExportedData *entry = gExportedSymbolIndex.find(name);
+  return (entry != nullptr) ? entry->data : nullptr;
 }
 
 bool NanoappLoader::open() {
@@ -370,17 +427,7 @@ void NanoappLoader::close() {
 }
 
 void *NanoappLoader::findSymbolByName(const char *name) {
-  for (size_t offset = 0; offset < mDynamicSymbolTableSize;
-       offset += sizeof(ElfSym)) {
-    ElfSym *currSym =
-        reinterpret_cast<ElfSym *>(mDynamicSymbolTablePtr + offset);
-    const char *symbolName = getDataName(currSym);
-
-    if (strncmp(symbolName, name, strlen(name)) == 0) {
-      return getSymbolTarget(currSym);
-    }
-  }
-  return nullptr;
+  return getSymbolTarget(lookupDynamicSymbol(name));
 }
 
 void NanoappLoader::registerAtexitFunction(struct AtExitCallback &cb) {
@@ -454,6 +501,10 @@ void NanoappLoader::freeAllocatedData() {
   }
   memoryFreeDram(mSectionHeadersPtr);
   memoryFreeDram(mSectionNamesPtr);
+  memoryFreeDram(mSymbolsSortedByName);
+  mSymbolsSortedByName = nullptr;
+  mGnuHashTable = nullptr;
+  mSysvHashTable = nullptr;
   mDynamicSymbolTablePtr = nullptr;
   mDynamicSymbolTableSize = 0;
 }
@@ -524,19 +575,50 @@ bool NanoappLoader::verifyDynamicTables() {
     return false;
   }
   mDynamicStringTablePtr =
-      reinterpret_cast<char *>(mBinary + dynamicStringTablePtr->sh_offset);
+      reinterpret_cast<char *>(getFileData(dynamicStringTablePtr->sh_offset));
 
   SectionHeader *dynamicSymbolTablePtr = getSectionHeader(kDynsymTableName);
   if (dynamicSymbolTablePtr == nullptr) {
     LOGE("Failed to find table %s", kDynsymTableName);
     return false;
   }
-  mDynamicSymbolTablePtr = (mBinary + dynamicSymbolTablePtr->sh_offset);
+  mDynamicSymbolTablePtr = getFileData(dynamicSymbolTablePtr->sh_offset);
   mDynamicSymbolTableSize = dynamicSymbolTablePtr->sh_size;
 
+  if (mDynamicStringTablePtr == nullptr || mDynamicSymbolTablePtr == nullptr) {
+    LOGE("Dynamic tables are not in a load segment");
+    return false;
+  }
   return true;
 }
 
+uint8_t *NanoappLoader::getFileData(size_t offset) {
+  if (!mIsStreamed) {
+    return mBinary + offset;
+  }
+
+  // Only the headers and the load segments are kept when streaming.
+  ElfHeader *elfHeader = getElfHeader();
+  if (offset <
+      elfHeader->e_phoff + getProgramHeaderArraySize() * sizeof(ProgramHeader)) {
+    return mBinary + offset;
+  }
+  return getMappedData(offset);
+}
+
+uint8_t *NanoappLoader::getMappedData(size_t offset) {
+  ProgramHeader *programHeaders = getProgramHeaderArray();
+  for (size_t i = 0; i < getProgramHeaderArraySize(); ++i) {
+    const ProgramHeader &ph = programHeaders[i];
+    if (ph.p_type == PT_LOAD && offset >= ph.p_offset &&
+        offset - ph.p_offset < ph.p_filesz) {
+      return reinterpret_cast<uint8_t *>(mLoadBias + ph.p_vaddr +
+                                         (offset - ph.p_offset));
+    }
+  }
+  return nullptr;
+}
+
 bool NanoappLoader::copyAndVerifyHeaders() {
   // Verify the ELF Header
   if (!verifyElfHeader()) {
@@ -550,6 +632,15 @@ bool NanoappLoader::copyAndVerifyHeaders() {
     return false;
   }
 
+  // The section headers and names were kept while streaming the binary.
+  if (mIsStreamed) {
+    if (!verifyDynamicTables()) {
+      LOGE("Failed to verify dynamic tables");
+      return false;
+    }
+    return true;
+  }
+
   // Load Section Headers
   ElfHeader *elfHeader = getElfHeader();
   size_t sectionHeaderSizeBytes = sizeof(SectionHeader) * elfHeader->e_shnum;
@@ -583,6 +674,11 @@ bool NanoappLoader::copyAndVerifyHeaders() {
 }
 
 bool NanoappLoader::createMappings() {
+  // The segments were copied into the mapping while streaming the binary.
+  if (mIsStreamed) {
+    return initSymbolHashTables();
+  }
+
   // ELF needs pt_load segments to be in contiguous ascending order of
   // virtual addresses. So the first and last segs can be used to
   // calculate the entire address span of the image.
@@ -664,7 +760,7 @@ bool NanoappLoader::createMappings() {
     }
   }
 
-  return success;
+  return success && initSymbolHashTables();
 }
 
 NanoappLoader::ElfSym *NanoappLoader::getDynamicSymbol(
@@ -679,6 +775,84 @@ NanoappLoader::ElfSym *NanoappLoader::getDynamicSymbol(
   return nullptr;
 }
 
+const NanoappLoader::ElfSym *NanoappLoader::lookupDynamicSymbol(
+    const char *name) {
+  if (mGnuHashTable == nullptr && mSysvHashTable == nullptr) {
+    return lookupSortedIndex(name);
+  }
+  ElfWord index = elfHashTableLookup<ElfWord, ElfAddr>(
+      mGnuHashTable, mSysvHashTable, mDynamicSymbolTableSize / sizeof(ElfSym),
+      name, [this](ElfWord i) { return getDataName(getDynamicSymbol(i)); });
+  return (index == STN_UNDEF) ? nullptr : getDynamicSymbol(index);
+}
+
+const NanoappLoader::ElfSym *NanoappLoader::lookupSortedIndex(
+    const char *name) {
+  size_t numSymbols = mDynamicSymbolTableSize / sizeof(ElfSym);
+  if (mSymbolsSortedByName == nullptr && numSymbols > 0) {
+    mSymbolsSortedByName =
+        static_cast<ElfWord *>(memoryAllocDram(numSymbols * sizeof(ElfWord)));
+    if (mSymbolsSortedByName == nullptr) {
+      LOG_OOM();
+      return nullptr;
+    }
+    for (size_t i = 0; i < numSymbols; i++) {
+      mSymbolsSortedByName[i] = static_cast<ElfWord>(i);
+    }
+    std::sort(mSymbolsSortedByName, mSymbolsSortedByName + numSymbols,
+              [this](ElfWord lhs, ElfWord rhs) {
+                return strcmp(getDataName(getDynamicSymbol(lhs)),
+                              getDataName(getDynamicSymbol(rhs))) < 0;
+              });
+  }
+
+  const ElfWord *begin = mSymbolsSortedByName;
+  const ElfWord *end = begin + numSymbols;
+  const ElfWord *it = std::lower_bound(
+      begin, end, name, [this](ElfWord index, const char *key) {
+        return strcmp(getDataName(getDynamicSymbol(index)), key) < 0;
+      });
+  if (it != end) {
+    const ElfSym *symbol = getDynamicSymbol(*it);
+    if (strcmp(getDataName(symbol), name) == 0) {
+      return symbol;
+    }
+  }
+  return nullptr;
+}
+
+bool NanoappLoader::initSymbolHashTables() {
+  // The input binary of a buffered load is freed once it is opened, so the
+  // symbols looked up afterwards are read from the copy of the dynamic tables
+  // in the mapping. The tables of a streamed load are already read from it.
+  if (!mIsStreamed) {
+    mDynamicStringTablePtr = reinterpret_cast<char *>(
+        getMappedData(getSectionHeader(kDynstrTableName)->sh_offset));
+    mDynamicSymbolTablePtr =
+        getMappedData(getSectionHeader(kDynsymTableName)->sh_offset);
+    if (mDynamicStringTablePtr == nullptr ||
+        mDynamicSymbolTablePtr == nullptr) {
+      LOGE("Dynamic tables are not in a load segment");
+      return false;
+    }
+  }
+
+  DynamicHeader *dyn = getDynamicHeader();
+  if (dyn != nullptr) {
+    // The tables are in a load segment, so they remain available through the
+    // mapping once the binary is released.
+    ElfWord gnuHashTable = getDynEntry(dyn, DT_GNU_HASH);
+    ElfWord sysvHashTable = getDynEntry(dyn, DT_HASH);
+    if (gnuHashTable != 0) {
+      mGnuHashTable = reinterpret_cast<const ElfWord *>(mMapping + gnuHashTable);
+    } else if (sysvHashTable != 0) {
+      mSysvHashTable =
+          reinterpret_cast<const ElfWord *>(mMapping + sysvHashTable);
+    }
+  }
+  return true;
+}
+
 const char *NanoappLoader::getDataName(const ElfSym *symbol) {
   return symbol == nullptr ? nullptr : &mDynamicStringTablePtr[symbol->st_name];
 }
@@ -714,8 +888,8 @@ NanoappLoader::DynamicHeader *NanoappLoader::getDynamicHeader() {
   ProgramHeader *programHeaders = getProgramHeaderArray();
   for (size_t i = 0; i < getProgramHeaderArraySize(); ++i) {
     if (programHeaders[i].p_type == PT_DYNAMIC) {
-      dyn = reinterpret_cast<DynamicHeader *>(programHeaders[i].p_offset +
-                                              mBinary);
+      dyn = reinterpret_cast<DynamicHeader *>(
+          getFileData(programHeaders[i].p_offset));
       break;
     }
   }
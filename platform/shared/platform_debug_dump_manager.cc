@@ -53,7 +53,7 @@ void debugDumpReadyCb(void * /*cookie*/, const char *debugStr,
 
 }  // namespace
 
-void PlatformDebugDumpManager::sendDebugDump(const char *debugStr,
+bool PlatformDebugDumpManager::sendDebugDump(const char *debugStr,
                                              bool complete) {
   // DDM is guaranteed to call complete=true at the end of a debug dump session.
   // However, sendDebugDumpResult may not get called with complete=true, for
@@ -66,12 +66,21 @@ void PlatformDebugDumpManager::sendDebugDump(const char *debugStr,
   mComplete = complete;
 
 #ifdef CHRE_ENABLE_ASH_DEBUG_DUMP
-  ashCommitDebugDump(mHandle, debugStr, complete);
+  return ashCommitDebugDump(mHandle, debugStr, complete);
 #else   // CHRE_ENABLE_ASH_DEBUG_DUMP
-  sendDebugDumpResult(debugStr, strlen(debugStr), complete);
+  return sendDebugDumpResult(debugStr, strlen(debugStr), complete);
 #endif  // CHRE_ENABLE_ASH_DEBUG_DUMP
 }
 
+bool PlatformDebugDumpManager::sendStructuredDebugDump() {
+#if defined(CHRE_STRUCTURED_DEBUG_DUMP_ENABLED) && \
+    !defined(CHRE_ENABLE_ASH_DEBUG_DUMP)
+  return sendStructuredDebugDumpToHost(mHostClientId);
+#else
+  return false;
+#endif  // CHRE_STRUCTURED_DEBUG_DUMP_ENABLED && !CHRE_ENABLE_ASH_DEBUG_DUMP
+}
+
 void PlatformDebugDumpManager::logStateToBuffer(DebugDumpWrapper &debugDump) {
 #ifdef CHPP_DEBUG_DUMP_ENABLED
   chpp::logStateToBuffer(debugDump);
@@ -106,14 +115,17 @@ bool PlatformDebugDumpManagerBase::onDebugDumpRequested(uint16_t hostClientId) {
 #endif  // CHRE_ENABLE_ASH_DEBUG_DUMP
 }
 
-void PlatformDebugDumpManagerBase::sendDebugDumpResult(const char *debugStr,
+bool PlatformDebugDumpManagerBase::sendDebugDumpResult(const char *debugStr,
                                                        size_t debugStrSize,
                                                        bool complete) {
-  if (debugStrSize > 0) {
-    mDataCount++;
+  // Only count the data the host will receive.
+  uint32_t dataCount = (debugStrSize > 0) ? mDataCount + 1 : mDataCount;
+  bool success = sendDebugDumpResultToHost(mHostClientId, debugStr,
+                                           debugStrSize, complete, dataCount);
+  if (success) {
+    mDataCount = dataCount;
   }
-  sendDebugDumpResultToHost(mHostClientId, debugStr, debugStrSize, complete,
-                            mDataCount);
+  return success;
 }
 
 }  // namespace chre
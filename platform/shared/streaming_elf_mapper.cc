@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/shared/streaming_elf_mapper.h"
+
+#include <cinttypes>
+#include <cstring>
+
+#include "chre/platform/log.h"
+#include "chre/platform/shared/memory.h"
+#include "chre/util/macros.h"
+
+namespace chre {
+
+StreamingElfMapper::~StreamingElfMapper() {
+  freeAll();
+}
+
+bool StreamingElfMapper::append(const void *data, size_t size) {
+  if (mIsComplete || size > mBinaryLen - mNumBytesReceived) {
+    LOGE("Overflow: cannot map %zu bytes at %zu/%zu of the nanoapp binary",
+         size, mNumBytesReceived, mBinaryLen);
+    return false;
+  }
+
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  while (size > 0 && mMapping == nullptr) {
+    // The headers are needed to know where the rest of the binary goes.
+    size_t headersSize = (mHeadersSize == 0) ? sizeof(ElfHeader) : mHeadersSize;
+    size_t copySize = MIN(headersSize - mNumBytesReceived, size);
+    memcpy(&mHeaders[mNumBytesReceived], bytes, copySize);
+    mNumBytesReceived += copySize;
+    bytes += copySize;
+    size -= copySize;
+
+    if (mNumBytesReceived == headersSize) {
+      if (mHeadersSize == 0 && !parseElfHeader()) {
+        return false;
+      }
+      if (mNumBytesReceived == mHeadersSize) {
+        if (!setUpRoutes()) {
+          return false;
+        }
+        route(0 /* offset */, mHeaders, mHeadersSize);
+      }
+    }
+  }
+
+  const ElfHeader *elfHeader = getElfHeader();
+  size_t sectionHeadersEnd =
+      elfHeader->e_shoff + mNumSectionHeaders * sizeof(SectionHeader);
+  while (size > 0) {
+    // Stop at the end of the section header table to locate the section names
+    // before routing the bytes that follow it.
+    size_t routeSize = size;
+    if (mSectionNames == nullptr && mNumBytesReceived < sectionHeadersEnd) {
+      routeSize = MIN(routeSize, sectionHeadersEnd - mNumBytesReceived);
+    }
+    route(mNumBytesReceived, bytes, routeSize);
+    mNumBytesReceived += routeSize;
+    bytes += routeSize;
+    size -= routeSize;
+
+    if (mSectionNames == nullptr && mNumBytesReceived == sectionHeadersEnd &&
+        !locateSectionNames()) {
+      return false;
+    }
+  }
+
+  return (mNumBytesReceived < mBinaryLen) || finish();
+}
+
+bool StreamingElfMapper::parseElfHeader() {
+  const ElfHeader *elfHeader = getElfHeader();
+  bool valid = (memcmp(elfHeader->e_ident, ELFMAG, SELFMAG) == 0) &&
+               (elfHeader->e_ident[EI_CLASS] == ELFCLASS32) &&
+               (elfHeader->e_phentsize == sizeof(ProgramHeader)) &&
+               (elfHeader->e_shentsize == sizeof(SectionHeader)) &&
+               (elfHeader->e_phnum > 0) &&
+               (elfHeader->e_shstrndx < elfHeader->e_shnum) &&
+               (elfHeader->e_phoff >= sizeof(ElfHeader)) &&
+               (elfHeader->e_phoff <= kMaxHeadersSize);
+  if (!valid) {
+    LOGE("Invalid ELF header");
+    return false;
+  }
+
+  size_t headersSize =
+      elfHeader->e_phoff + elfHeader->e_phnum * sizeof(ProgramHeader);
+  size_t sectionHeadersSize = elfHeader->e_shnum * sizeof(SectionHeader);
+  if (headersSize > kMaxHeadersSize || headersSize > mBinaryLen) {
+    LOGE("Program headers end at %zu, past %zu", headersSize,
+         MIN(mBinaryLen, kMaxHeadersSize));
+    return false;
+  }
+  if (elfHeader->e_shoff < headersSize || elfHeader->e_shoff > mBinaryLen ||
+      sectionHeadersSize > mBinaryLen - elfHeader->e_shoff) {
+    LOGE("Invalid section header table offset %" PRIu32, elfHeader->e_shoff);
+    return false;
+  }
+
+  mHeadersSize = headersSize;
+  return true;
+}
+
+bool StreamingElfMapper::setUpRoutes() {
+  const ElfHeader *elfHeader = getElfHeader();
+  const ProgramHeader *programHeaders = getProgramHeaders();
+  size_t numProgramHeaders = elfHeader->e_phnum;
+
+  // As in NanoappLoader::createMappings(), the load segments must be
+  // contiguous and in ascending order of virtual addresses.
+  size_t first = 0;
+  while (first < numProgramHeaders && programHeaders[first].p_type != PT_LOAD) {
+    first++;
+  }
+  if (first == numProgramHeaders) {
+    LOGE("Unable to find any load segments in the binary");
+    return false;
+  }
+  size_t last = numProgramHeaders - 1;
+  while (programHeaders[last].p_type != PT_LOAD) {
+    last--;
+  }
+  if (last - first + 1 > kMaxLoadSegments) {
+    LOGE("Too many load segments: %zu", last - first + 1);
+    return false;
+  }
+
+  const ProgramHeader &firstSegment = programHeaders[first];
+  const ProgramHeader &lastSegment = programHeaders[last];
+  if (firstSegment.p_offset >= elfHeader->e_phoff ||
+      firstSegment.p_filesz < mHeadersSize) {
+    LOGE("Load segment program header validation failed");
+    return false;
+  }
+
+  size_t alignment = firstSegment.p_align;
+  size_t mappingSize =
+      lastSegment.p_vaddr + lastSegment.p_memsz - firstSegment.p_vaddr;
+  mMapping = static_cast<uint8_t *>(
+      mIsTcmMapping ? nanoappBinaryAlloc(mappingSize, alignment)
+                    : nanoappBinaryDramAlloc(mappingSize, alignment));
+  if (mMapping == nullptr) {
+    LOG_OOM();
+    return false;
+  }
+  mMappingSize = mappingSize;
+  uintptr_t alignedFirstAddress = (alignment == 0)
+                                      ? firstSegment.p_vaddr
+                                      : firstSegment.p_vaddr & -alignment;
+  mLoadBias = reinterpret_cast<uintptr_t>(mMapping) - alignedFirstAddress;
+
+  size_t loadSegmentsEnd = 0;
+  for (size_t i = first; i <= last; i++) {
+    const ProgramHeader &segment = programHeaders[i];
+    if (segment.p_type != PT_LOAD) {
+      LOGE("Non-load segment found between load segments");
+      return false;
+    }
+
+    uint8_t *destination =
+        reinterpret_cast<uint8_t *>(mLoadBias + segment.p_vaddr);
+    bool valid = (segment.p_filesz <= segment.p_memsz) &&
+                 (segment.p_offset <= mBinaryLen) &&
+                 (segment.p_filesz <= mBinaryLen - segment.p_offset) &&
+                 (destination >= mMapping) &&
+                 (segment.p_memsz <=
+                  static_cast<size_t>(mMapping + mMappingSize - destination));
+    if (!valid) {
+      LOGE("Load segment %zu does not fit in the binary or the mapping", i);
+      return false;
+    }
+
+    // The part of the segment that is not in the binary (.bss) is zeroed.
+    memset(destination + segment.p_filesz, 0,
+           segment.p_memsz - segment.p_filesz);
+    if (!addRoute(segment.p_offset, segment.p_filesz, destination)) {
+      return false;
+    }
+    loadSegmentsEnd =
+        MAX(loadSegmentsEnd, segment.p_offset + segment.p_filesz);
+  }
+
+  mNumSectionHeaders = elfHeader->e_shnum;
+  size_t sectionHeadersSize = mNumSectionHeaders * sizeof(SectionHeader);
+  mSectionHeaders =
+      static_cast<SectionHeader *>(memoryAllocDram(sectionHeadersSize));
+  if (mSectionHeaders == nullptr) {
+    LOG_OOM();
+    return false;
+  }
+  if (!addRoute(elfHeader->e_shoff, sectionHeadersSize,
+                reinterpret_cast<uint8_t *>(mSectionHeaders))) {
+    return false;
+  }
+
+  size_t windowStart = MAX(loadSegmentsEnd, mHeadersSize);
+  if (elfHeader->e_shoff > windowStart + kSectionNamesWindowSize) {
+    windowStart = elfHeader->e_shoff - kSectionNamesWindowSize;
+  }
+  if (elfHeader->e_shoff > windowStart) {
+    mSectionNamesWindowOffset = windowStart;
+    mSectionNamesWindowSize = elfHeader->e_shoff - windowStart;
+    mSectionNamesWindow =
+        static_cast<uint8_t *>(memoryAllocDram(mSectionNamesWindowSize));
+    if (mSectionNamesWindow == nullptr) {
+      LOG_OOM();
+      return false;
+    }
+    return addRoute(mSectionNamesWindowOffset, mSectionNamesWindowSize,
+                    mSectionNamesWindow);
+  }
+  return true;
+}
+
+bool StreamingElfMapper::addRoute(size_t offset, size_t size,
+                                  uint8_t *destination) {
+  if (size == 0) {
+    return true;
+  }
+  if (mNumRoutes == kMaxRoutes) {
+    LOGE("Too many routes");
+    return false;
+  }
+  mRoutes[mNumRoutes++] = {offset, size, destination};
+  return true;
+}
+
+void StreamingElfMapper::route(size_t offset, const uint8_t *data,
+                               size_t size) {
+  for (size_t i = 0; i < mNumRoutes; i++) {
+    const Route &route = mRoutes[i];
+    size_t start = MAX(offset, route.offset);
+    size_t end = MIN(offset + size, route.offset + route.size);
+    if (start < end) {
+      memcpy(route.destination + (start - route.offset), data + (start - offset),
+             end - start);
+    }
+  }
+}
+
+bool StreamingElfMapper::locateSectionNames() {
+  const SectionHeader &namesHeader =
+      mSectionHeaders[getElfHeader()->e_shstrndx];
+  size_t offset = namesHeader.sh_offset;
+  size_t size = namesHeader.sh_size;
+  if (size == 0 || offset > mBinaryLen || size > mBinaryLen - offset) {
+    LOGE("Invalid section names at %zu (size %zu)", offset, size);
+    return false;
+  }
+
+  mSectionNames = static_cast<char *>(memoryAllocDram(size));
+  if (mSectionNames == nullptr) {
+    LOG_OOM();
+    return false;
+  }
+
+  bool success = true;
+  if (offset >= mNumBytesReceived) {
+    success = addRoute(offset, size, reinterpret_cast<uint8_t *>(mSectionNames));
+  } else if (offset >= mSectionNamesWindowOffset &&
+             offset + size <=
+                 mSectionNamesWindowOffset + mSectionNamesWindowSize) {
+    memcpy(mSectionNames,
+           &mSectionNamesWindow[offset - mSectionNamesWindowOffset], size);
+  } else {
+    LOGE("Section names at %zu (size %zu) were not kept", offset, size);
+    success = false;
+  }
+
+  // The window is no longer needed.
+  for (size_t i = 0; i < mNumRoutes; i++) {
+    if (mRoutes[i].destination == mSectionNamesWindow) {
+      mRoutes[i] = mRoutes[--mNumRoutes];
+      break;
+    }
+  }
+  memoryFreeDram(mSectionNamesWindow);
+  mSectionNamesWindow = nullptr;
+  mSectionNamesWindowSize = 0;
+
+  if (!success) {
+    memoryFreeDram(mSectionNames);
+    mSectionNames = nullptr;
+  }
+  return success;
+}
+
+bool StreamingElfMapper::finish() {
+  // The section header table is within the binary, so the section names have
+  // been located, and all the routes have been filled.
+  mIsComplete = true;
+  mNumRoutes = 0;
+  return true;
+}
+
+void StreamingElfMapper::freeAll() {
+  if (mMapping != nullptr) {
+    if (mIsTcmMapping) {
+      nanoappBinaryFree(mMapping);
+    } else {
+      nanoappBinaryDramFree(mMapping);
+    }
+    mMapping = nullptr;
+  }
+  memoryFreeDram(mSectionHeaders);
+  mSectionHeaders = nullptr;
+  memoryFreeDram(mSectionNames);
+  mSectionNames = nullptr;
+  memoryFreeDram(mSectionNamesWindow);
+  mSectionNamesWindow = nullptr;
+}
+
+}  // namespace chre
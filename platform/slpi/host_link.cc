@@ -40,9 +40,12 @@
 #include "chre/util/flatbuffers/helpers.h"
 #include "chre/util/macros.h"
 #include "chre/util/nested_data_ptr.h"
+#include "chre/util/synchronized_memory_pool.h"
+#include "chre/util/system/pooled_flatbuffer_allocator.h"
 #include "chre/util/unique_ptr.h"
 #include "chre_api/chre/version.h"
 
+#include <algorithm>
 #include <inttypes.h>
 #include <limits.h>
 
@@ -120,6 +123,47 @@ typedef void(MessageBuilderFunction)(ChreFlatBufferBuilder &builder,
 
 FixedSizeBlockingQueue<PendingMessage, kOutboundQueueSize> gOutboundQueue;
 
+//! The buffers of the messages waiting in the outbound queue are allocated
+//! from these pools rather than from the heap. Most messages fit in a small
+//! buffer, while log messages, of which only one is in flight at a time, need
+//! a large buffer.
+constexpr size_t kSmallMessageBufferSize = 256;
+constexpr size_t kNumSmallMessageBuffers = 8;
+constexpr size_t kLargeMessageBufferSize = CHRE_MESSAGE_TO_HOST_MAX_SIZE + 256;
+PooledFlatBufferAllocator<kLargeMessageBufferSize, 1> gLargeBufferAllocator;
+PooledFlatBufferAllocator<kSmallMessageBufferSize, kNumSmallMessageBuffers>
+    gMessageBufferAllocator(&gLargeBufferAllocator);
+
+//! The builders of the messages waiting in the outbound queue, which are
+//! allocated from the heap once the pool is exhausted.
+SynchronizedMemoryPool<ChreFlatBufferBuilder, kNumSmallMessageBuffers>
+    gBuilderPool;
+
+/**
+ * Allocates a builder for a message of the outbound queue, with its buffer
+ * allocated from the message buffer pools.
+ *
+ * @return The builder, or nullptr if the allocation failed. It must be
+ *         released with freeBuilder().
+ */
+ChreFlatBufferBuilder *allocateBuilder(size_t initialBufferSize) {
+  ChreFlatBufferBuilder *builder =
+      gBuilderPool.allocate(initialBufferSize, &gMessageBufferAllocator);
+  if (builder == nullptr) {
+    builder = memoryAlloc<ChreFlatBufferBuilder>(initialBufferSize,
+                                                 &gMessageBufferAllocator);
+  }
+  return builder;
+}
+
+void freeBuilder(ChreFlatBufferBuilder *builder) {
+  if (gBuilderPool.containsAddress(builder)) {
+    gBuilderPool.deallocate(builder);
+  } else {
+    memoryFreeAndDestroy(builder);
+  }
+}
+
 int copyToHostBuffer(const ChreFlatBufferBuilder &builder,
                      unsigned char *buffer, size_t bufferSize,
                      unsigned int *messageLen) {
@@ -132,7 +176,8 @@ int copyToHostBuffer(const ChreFlatBufferBuilder &builder,
          size, bufferSize);
     result = CHRE_FASTRPC_ERROR;
   } else {
-    memcpy(buffer, data, size);
+    // The message overlaps with the host buffer if it was encoded in place.
+    memmove(buffer, data, size);
     *messageLen = size;
     result = CHRE_FASTRPC_SUCCESS;
   }
@@ -181,8 +226,8 @@ bool buildAndEnqueueMessage(PendingMessageType msgType,
                             MessageBuilderFunction *msgBuilder, void *cookie) {
   bool pushed = false;
 
-  auto builder = MakeUnique<ChreFlatBufferBuilder>(initialBufferSize);
-  if (builder.isNull()) {
+  ChreFlatBufferBuilder *builder = allocateBuilder(initialBufferSize);
+  if (builder == nullptr) {
     LOGE("Couldn't allocate memory for message type %d",
          static_cast<int>(msgType));
   } else {
@@ -190,11 +235,11 @@ bool buildAndEnqueueMessage(PendingMessageType msgType,
 
     // TODO: if this fails, ideally we should block for some timeout until
     // there's space in the queue
-    if (!enqueueMessage(PendingMessage(msgType, builder.get()))) {
+    if (!enqueueMessage(PendingMessage(msgType, builder))) {
       LOGE("Couldn't push message type %d to outbound queue",
            static_cast<int>(msgType));
+      freeBuilder(builder);
     } else {
-      builder.release();
       pushed = true;
     }
   }
@@ -249,10 +294,14 @@ void handleUnloadNanoappCallback(SystemCallbackType /*type*/,
 
 int generateMessageToHost(const MessageToHost *msgToHost, unsigned char *buffer,
                           size_t bufferSize, unsigned int *messageLen) {
-  // TODO: ideally we'd construct our flatbuffer directly in the
-  // host-supplied buffer
+  // The message is encoded directly in the host-supplied buffer if it fits.
   constexpr size_t kFixedSizePortion = 88;
-  ChreFlatBufferBuilder builder(msgToHost->message.size() + kFixedSizePortion);
+  FixedBufferFlatBufferAllocator allocator(buffer, bufferSize,
+                                           &gMessageBufferAllocator);
+  ChreFlatBufferBuilder builder(
+      std::min(msgToHost->message.size() + kFixedSizePortion,
+               allocator.getMaxInitialBuilderSize()),
+      &allocator);
   HostProtocolChre::encodeNanoappMessage(
       builder, msgToHost->appId, msgToHost->toHostData.messageType,
       msgToHost->toHostData.hostEndpoint, msgToHost->message.data(),
@@ -287,7 +336,11 @@ int generateHubInfoResponse(uint16_t hostClientId, unsigned char *buffer,
   constexpr float kPeakPower = 15;
 
   // Note that this may execute prior to EventLoopManager::lateInit() completing
-  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  FixedBufferFlatBufferAllocator allocator(buffer, bufferSize,
+                                           &gMessageBufferAllocator);
+  ChreFlatBufferBuilder builder(
+      std::min(kInitialBufferSize, allocator.getMaxInitialBuilderSize()),
+      &allocator);
   HostProtocolChre::encodeHubInfoResponse(
       builder, kHubName, kVendor, kToolchain, kLegacyPlatformVersion,
       kLegacyToolchainVersion, kPeakMips, kStoppedPower, kSleepPower,
@@ -312,12 +365,11 @@ int generateMessageFromBuilder(ChreFlatBufferBuilder *builder,
   UNUSED_VAR(isEncodedLogMessage);
 #endif
 
-  builder->~ChreFlatBufferBuilder();
-  memoryFree(builder);
+  freeBuilder(builder);
   return result;
 }
 
-void sendDebugDumpData(uint16_t hostClientId, const char *debugStr,
+bool sendDebugDumpData(uint16_t hostClientId, const char *debugStr,
                        size_t debugStrSize) {
   struct DebugDumpMessageData {
     uint16_t hostClientId;
@@ -336,11 +388,12 @@ void sendDebugDumpData(uint16_t hostClientId, const char *debugStr,
   data.hostClientId = hostClientId;
   data.debugStr = debugStr;
   data.debugStrSize = debugStrSize;
-  buildAndEnqueueMessage(PendingMessageType::DebugDumpData,
-                         kFixedSizePortion + debugStrSize, msgBuilder, &data);
+  return buildAndEnqueueMessage(PendingMessageType::DebugDumpData,
+                                kFixedSizePortion + debugStrSize, msgBuilder,
+                                &data);
 }
 
-void sendDebugDumpResponse(uint16_t hostClientId, bool success,
+bool sendDebugDumpResponse(uint16_t hostClientId, bool success,
                            uint32_t dataCount) {
   struct DebugDumpResponseData {
     uint16_t hostClientId;
@@ -359,8 +412,8 @@ void sendDebugDumpResponse(uint16_t hostClientId, bool success,
   data.hostClientId = hostClientId;
   data.success = success;
   data.dataCount = dataCount;
-  buildAndEnqueueMessage(PendingMessageType::DebugDumpResponse, kInitialSize,
-                         msgBuilder, &data);
+  return buildAndEnqueueMessage(PendingMessageType::DebugDumpResponse,
+                                kInitialSize, msgBuilder, &data);
 }
 
 void sendSelfTestResponse(uint16_t hostClientId, bool success) {
@@ -559,16 +612,18 @@ extern "C" int chre_slpi_deliver_message_from_host(const unsigned char *message,
 
 }  // anonymous namespace
 
-void sendDebugDumpResultToHost(uint16_t hostClientId, const char *debugStr,
+bool sendDebugDumpResultToHost(uint16_t hostClientId, const char *debugStr,
                                size_t debugStrSize, bool complete,
                                uint32_t dataCount) {
+  bool success = true;
   if (debugStrSize > 0) {
-    sendDebugDumpData(hostClientId, debugStr, debugStrSize);
+    success = sendDebugDumpData(hostClientId, debugStr, debugStrSize);
   }
 
   if (complete) {
-    sendDebugDumpResponse(hostClientId, true /*success*/, dataCount);
+    success &= sendDebugDumpResponse(hostClientId, true /*success*/, dataCount);
   }
+  return success;
 }
 
 void HostLink::flushMessagesSentByNanoapp(uint64_t /*appId*/) {
@@ -653,9 +708,11 @@ void HostLinkBase::sendLogMessage(const uint8_t *logMessage,
                                         data->logMsgSize);
   };
 
+  // Reserve space for the logs up front so the builder takes a single block.
   constexpr size_t kInitialSize = 128;
-  buildAndEnqueueMessage(PendingMessageType::EncodedLogMessage, kInitialSize,
-                         msgBuilder, &logMessageData);
+  buildAndEnqueueMessage(PendingMessageType::EncodedLogMessage,
+                         kInitialSize + logMessageSize, msgBuilder,
+                         &logMessageData);
 }
 
 void HostLinkBase::sendLogMessageV2(const uint8_t *logMessage,
@@ -676,8 +733,37 @@ void HostLinkBase::sendLogMessageV2(const uint8_t *logMessage,
   };
 
   constexpr size_t kInitialSize = 128;
-  buildAndEnqueueMessage(PendingMessageType::EncodedLogMessage, kInitialSize,
-                         msgBuilder, &logMessageData);
+  buildAndEnqueueMessage(PendingMessageType::EncodedLogMessage,
+                         kInitialSize + logMessageSize, msgBuilder,
+                         &logMessageData);
+}
+
+void HostLinkBase::sendLogMessageV3(const uint8_t *logMessage,
+                                    size_t logMessageSize,
+                                    size_t uncompressedSize,
+                                    uint32_t numLogsDropped) {
+  struct LogMessageData {
+    const uint8_t *logMsg;
+    size_t logMsgSize;
+    size_t uncompressedSize;
+    uint32_t numLogsDropped;
+  };
+
+  LogMessageData logMessageData{logMessage, logMessageSize, uncompressedSize,
+                                numLogsDropped};
+
+  auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
+    const auto *data = static_cast<const LogMessageData *>(cookie);
+    HostProtocolChre::encodeLogMessagesV3(builder, data->logMsg,
+                                          data->logMsgSize,
+                                          data->uncompressedSize,
+                                          data->numLogsDropped);
+  };
+
+  constexpr size_t kInitialSize = 128;
+  buildAndEnqueueMessage(PendingMessageType::EncodedLogMessage,
+                         kInitialSize + logMessageSize, msgBuilder,
+                         &logMessageData);
 }
 
 void HostLinkBase::sendNanConfiguration(bool enable) {
@@ -93,6 +93,16 @@ inline uint32_t AtomicUint32::fetch_decrement() {
   return qurt_atomic_sub_return(&mValue, 1);
 }
 
+inline bool AtomicUint32::compare_exchange(uint32_t &expected,
+                                           uint32_t desired) {
+  qurt_atomic_barrier();
+  if (qurt_atomic_compare_and_set(&mValue, expected, desired)) {
+    return true;
+  }
+  expected = load();
+  return false;
+}
+
 }  // namespace chre
 
 #endif  // CHRE_PLATFORM_SLPI_ATOMIC_BASE_IMPL_H_
@@ -299,6 +299,14 @@ const char *PlatformNanoapp::getAppName() const {
   return (mAppInfo != nullptr) ? mAppInfo->name : "Unknown";
 }
 
+const char *PlatformNanoapp::getAppVendor() const {
+  return (mAppInfo != nullptr) ? mAppInfo->vendor : "Unknown";
+}
+
+const char *PlatformNanoapp::getAppBuildId() const {
+  return getAppVersionString();
+}
+
 bool PlatformNanoapp::isSystemNanoapp() const {
   // Right now, we assume that system nanoapps are always static nanoapps. Since
   // mAppInfo can only be null either prior to loading the app (in which case
@@ -17,7 +17,10 @@
 #ifndef CHRE_PLATFORM_SLPI_SEE_POWER_CONTROL_MANAGER_BASE_H_
 #define CHRE_PLATFORM_SLPI_SEE_POWER_CONTROL_MANAGER_BASE_H_
 
+#include "chre/core/power_policy.h"
+#include "chre/core/timer_pool.h"
 #include "chre/platform/atomic.h"
+#include "chre/util/time.h"
 
 #ifdef CHRE_THREAD_UTIL_ENABLED
 extern "C" {
@@ -52,9 +55,31 @@ class PowerControlManagerBase {
   void onHostWakeSuspendEvent(bool awake);
 
  protected:
+  /**
+   * Arms a timer to process an event, and so re-evaluate mPowerPolicy, when
+   * the event it stays active for is due. This removes the big image vote if
+   * the event does not come, e.g. because its timer was cancelled.
+   *
+   * @param timeToNextEvent The predicted time until the next event.
+   * @return true if the timer was armed.
+   */
+  bool armPowerPolicyTimeout(Nanoseconds timeToNextEvent);
+
+  /**
+   * Cancels the timer armed by armPowerPolicyTimeout(), if pending.
+   */
+  void cancelPowerPolicyTimeout();
+
   //! Set to true if the host is awake, false if suspended.
   AtomicBool mHostIsAwake;
 
+  //! Decides when the big image vote is removed after processing events.
+  PowerPolicy mPowerPolicy;
+
+  //! The timer armed by armPowerPolicyTimeout(), CHRE_TIMER_INVALID if none is
+  //! pending.
+  TimerHandle mPowerPolicyTimerHandle = CHRE_TIMER_INVALID;
+
 #ifdef CHRE_THREAD_UTIL_ENABLED
   //! Set to true if the thread is currently idle (no pending events),
   //! false otherwise.
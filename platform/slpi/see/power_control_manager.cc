@@ -16,6 +16,8 @@
 
 #include "chre/platform/power_control_manager.h"
 
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/log.h"
 #include "chre/platform/slpi/power_control_util.h"
 #include "chre/platform/slpi/see/island_vote_client.h"
 #include "chre/platform/system_time.h"
@@ -43,6 +45,30 @@ bool PowerControlManagerBase::voteBigImage(bool bigImage) {
   return IslandVoteClientSingleton::get()->voteBigImage(bigImage);
 }
 
+bool PowerControlManagerBase::armPowerPolicyTimeout(
+    Nanoseconds timeToNextEvent) {
+  // Processing the event of the timer re-evaluates the policy in
+  // postEventLoopProcess().
+  auto callback = [](uint16_t /*type*/, void *data, void * /*extraData*/) {
+    static_cast<PowerControlManagerBase *>(data)->mPowerPolicyTimerHandle =
+        CHRE_TIMER_INVALID;
+  };
+
+  mPowerPolicyTimerHandle =
+      EventLoopManagerSingleton::get()->setDelayedCallback(
+          SystemCallbackType::PowerPolicyTimeout, this, callback,
+          timeToNextEvent);
+  return mPowerPolicyTimerHandle != CHRE_TIMER_INVALID;
+}
+
+void PowerControlManagerBase::cancelPowerPolicyTimeout() {
+  if (mPowerPolicyTimerHandle != CHRE_TIMER_INVALID) {
+    EventLoopManagerSingleton::get()->cancelDelayedCallback(
+        mPowerPolicyTimerHandle);
+    mPowerPolicyTimerHandle = CHRE_TIMER_INVALID;
+  }
+}
+
 void PowerControlManagerBase::onHostWakeSuspendEvent(bool awake) {
   if (mHostIsAwake != awake) {
     mHostIsAwake = awake;
@@ -51,6 +77,8 @@ void PowerControlManagerBase::onHostWakeSuspendEvent(bool awake) {
       EventLoopManagerSingleton::get()
           ->getHostCommsManager()
           .resetBlameForNanoappHostWakeup();
+    } else {
+      EventLoopManagerSingleton::get()->getHostCommsManager().onHostAwake();
     }
 
     EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
@@ -80,7 +108,9 @@ void PowerControlManagerBase::onHostWakeSuspendEvent(bool awake) {
   }
 }
 
-void PowerControlManager::preEventLoopProcess(size_t /* numPendingEvents */) {}
+void PowerControlManager::preEventLoopProcess(size_t /* numPendingEvents */) {
+  mPowerPolicy.onEventLoopProcessStart();
+}
 
 void PowerControlManager::postEventLoopProcess(size_t numPendingEvents) {
 #ifdef CHRE_THREAD_UTIL_ENABLED
@@ -102,7 +132,23 @@ void PowerControlManager::postEventLoopProcess(size_t numPendingEvents) {
   }
 #endif  // CHRE_THREAD_UTIL_ENABLED
 
-  if (numPendingEvents == 0 && !slpiInUImage()) {
+  // While events are pending, the next one re-evaluates the policy.
+  if (numPendingEvents != 0) {
+    return;
+  }
+
+  // Keep big image through bursts of events instead of voting it off every
+  // time the queue empties. The pending timeout is not an expected event.
+  cancelPowerPolicyTimeout();
+  Nanoseconds timeToNextEvent = PowerPolicy::predictTimeToNextEvent();
+  bool lowPower = mPowerPolicy.onEventLoopProcessEnd(
+                      numPendingEvents, timeToNextEvent) ==
+                  PowerPolicy::State::LowPower;
+  if (!lowPower && !armPowerPolicyTimeout(timeToNextEvent)) {
+    LOGE("Failed to arm the power policy timeout");
+    lowPower = true;
+  }
+  if (lowPower && !slpiInUImage()) {
     voteBigImage(false /* bigImage */);
   }
 }
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/shared/elf_symbol_hash.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace chre {
+namespace {
+
+// The types of the 32-bit binaries the nanoapp loader supports.
+using ElfWord = uint32_t;
+using ElfAddr = uint32_t;
+
+constexpr ElfWord kBloomShift = 5;
+constexpr size_t kBloomWordBits = sizeof(ElfAddr) * CHAR_BIT;
+
+const std::vector<std::string> kExportedNames = {
+    "nanoappStart",       "nanoappHandleEvent", "nanoappEnd",
+    "_ZN7nanoapp5State6updateEv", "gNanoappState",  "nanoappHelperA",
+    "nanoappHelperB",     "nanoappHelperC",     "memcpy",
+};
+
+/**
+ * A dynamic symbol table and its hash tables, built as a linker does. The
+ * undefined symbol is at index 0 and the exported names follow it, ordered by
+ * GNU hash bucket.
+ */
+struct SymbolTable {
+  SymbolTable(std::vector<std::string> exportedNames, ElfWord numBuckets,
+              ElfWord bloomSize) {
+    std::stable_sort(exportedNames.begin(), exportedNames.end(),
+                     [numBuckets](const std::string &lhs,
+                                  const std::string &rhs) {
+                       return elfGnuHash(lhs.c_str()) % numBuckets <
+                              elfGnuHash(rhs.c_str()) % numBuckets;
+                     });
+    names.push_back("");
+    names.insert(names.end(), exportedNames.begin(), exportedNames.end());
+    buildGnuHashTable(numBuckets, bloomSize);
+    buildSysvHashTable(numBuckets);
+  }
+
+  void buildGnuHashTable(ElfWord numBuckets, ElfWord bloomSize) {
+    constexpr ElfWord kSymbolOffset = 1;
+    std::vector<ElfAddr> bloom(bloomSize, 0);
+    std::vector<ElfWord> buckets(numBuckets, 0);
+    std::vector<ElfWord> chains;
+    for (size_t i = kSymbolOffset; i < names.size(); i++) {
+      uint32_t hash = elfGnuHash(names[i].c_str());
+      bloom[(hash / kBloomWordBits) % bloomSize] |=
+          (static_cast<ElfAddr>(1) << (hash % kBloomWordBits)) |
+          (static_cast<ElfAddr>(1) << ((hash >> kBloomShift) % kBloomWordBits));
+      ElfWord bucket = hash % numBuckets;
+      if (buckets[bucket] == 0) {
+        buckets[bucket] = static_cast<ElfWord>(i);
+      }
+      bool isLastOfBucket =
+          i + 1 == names.size() ||
+          elfGnuHash(names[i + 1].c_str()) % numBuckets != bucket;
+      chains.push_back((hash & ~1u) | (isLastOfBucket ? 1 : 0));
+    }
+
+    gnuHashTable = {numBuckets, kSymbolOffset, bloomSize, kBloomShift};
+    gnuHashTable.insert(gnuHashTable.end(), bloom.begin(), bloom.end());
+    gnuHashTable.insert(gnuHashTable.end(), buckets.begin(), buckets.end());
+    gnuHashTable.insert(gnuHashTable.end(), chains.begin(), chains.end());
+  }
+
+  void buildSysvHashTable(ElfWord numBuckets) {
+    std::vector<ElfWord> buckets(numBuckets, 0);
+    std::vector<ElfWord> chains(names.size(), 0);
+    for (size_t i = 1; i < names.size(); i++) {
+      ElfWord bucket = elfSysvHash(names[i].c_str()) % numBuckets;
+      chains[i] = buckets[bucket];
+      buckets[bucket] = static_cast<ElfWord>(i);
+    }
+
+    sysvHashTable = {numBuckets, static_cast<ElfWord>(names.size())};
+    sysvHashTable.insert(sysvHashTable.end(), buckets.begin(), buckets.end());
+    sysvHashTable.insert(sysvHashTable.end(), chains.begin(), chains.end());
+  }
+
+  //! Looks up a name, counting the names compared.
+  ElfWord lookup(const ElfWord *gnu, const ElfWord *sysv, const char *name) {
+    return elfHashTableLookup<ElfWord, ElfAddr>(
+        gnu, sysv, names.size(), name, [this](ElfWord index) {
+          numNamesCompared++;
+          return names[index].c_str();
+        });
+  }
+
+  ElfWord lookupGnu(const char *name) {
+    return lookup(gnuHashTable.data(), nullptr, name);
+  }
+
+  ElfWord lookupSysv(const char *name) {
+    return lookup(nullptr, sysvHashTable.data(), name);
+  }
+
+  size_t indexOf(const std::string &name) const {
+    return std::find(names.begin(), names.end(), name) - names.begin();
+  }
+
+  std::vector<std::string> names;
+  std::vector<ElfWord> gnuHashTable;
+  std::vector<ElfWord> sysvHashTable;
+  size_t numNamesCompared = 0;
+};
+
+TEST(ElfSymbolHash, HashFunctions) {
+  // Reference values from the hash functions of the GNU and System V ABIs.
+  EXPECT_EQ(elfGnuHash(""), 0x00001505u);
+  EXPECT_EQ(elfGnuHash("printf"), 0x156b2bb8u);
+  EXPECT_EQ(elfGnuHash("exit"), 0x7c967e3fu);
+  EXPECT_EQ(elfSysvHash(""), 0u);
+  EXPECT_EQ(elfSysvHash("printf"), 0x077905a6u);
+  EXPECT_EQ(elfSysvHash("exit"), 0x0006cf04u);
+}
+
+TEST(ElfSymbolHash, GnuHashTableFindsEverySymbol) {
+  for (ElfWord numBuckets : {1, 3, 16}) {
+    SymbolTable table(kExportedNames, numBuckets, /* bloomSize= */ 2);
+    for (const std::string &name : kExportedNames) {
+      EXPECT_EQ(table.lookupGnu(name.c_str()), table.indexOf(name))
+          << name << " with " << numBuckets << " buckets";
+    }
+  }
+}
+
+TEST(ElfSymbolHash, GnuHashTableMissesUnknownNamesAndPrefixes) {
+  SymbolTable table(kExportedNames, /* numBuckets= */ 1, /* bloomSize= */ 1);
+  // A single bucket and bloom word make the bloom filter pass for most names,
+  // so the chain is searched.
+  for (const char *name : {"nanoapp", "nanoappStar", "nanoappStartX",
+                           "memcp", "", "chreGetTime"}) {
+    EXPECT_EQ(table.lookupGnu(name), 0u) << name;
+  }
+}
+
+TEST(ElfSymbolHash, GnuHashBloomFilterRejectsWithoutComparingNames) {
+  SymbolTable table(kExportedNames, /* numBuckets= */ 4, /* bloomSize= */ 4);
+  const ElfAddr *bloom =
+      reinterpret_cast<const ElfAddr *>(&table.gnuHashTable[4]);
+
+  // Find names the bloom filter rejects.
+  size_t numRejected = 0;
+  for (int i = 0; i < 100; i++) {
+    std::string name = "unknownSymbol" + std::to_string(i);
+    uint32_t hash = elfGnuHash(name.c_str());
+    ElfAddr mask =
+        (static_cast<ElfAddr>(1) << (hash % kBloomWordBits)) |
+        (static_cast<ElfAddr>(1) << ((hash >> kBloomShift) % kBloomWordBits));
+    if ((bloom[(hash / kBloomWordBits) % 4] & mask) == mask) {
+      continue;
+    }
+
+    numRejected++;
+    table.numNamesCompared = 0;
+    EXPECT_EQ(table.lookupGnu(name.c_str()), 0u);
+    EXPECT_EQ(table.numNamesCompared, 0u) << name;
+  }
+  EXPECT_GT(numRejected, 0u);
+}
+
+TEST(ElfSymbolHash, GnuHashTableOnlyComparesMatchingHashes) {
+  SymbolTable table(kExportedNames, /* numBuckets= */ 1, /* bloomSize= */ 1);
+  table.numNamesCompared = 0;
+  EXPECT_EQ(table.lookupGnu("memcpy"), table.indexOf("memcpy"));
+  EXPECT_EQ(table.numNamesCompared, 1u);
+}
+
+TEST(ElfSymbolHash, SysvHashTableFindsEverySymbol) {
+  for (ElfWord numBuckets : {1, 3, 16}) {
+    SymbolTable table(kExportedNames, numBuckets, /* bloomSize= */ 1);
+    for (const std::string &name : kExportedNames) {
+      EXPECT_EQ(table.lookupSysv(name.c_str()), table.indexOf(name))
+          << name << " with " << numBuckets << " buckets";
+    }
+    for (const char *name : {"nanoapp", "nanoappStar", "memcp", ""}) {
+      EXPECT_EQ(table.lookupSysv(name), 0u) << name;
+    }
+  }
+}
+
+TEST(ElfSymbolHash, SysvHashTableStopsAtTheEndOfTheSymbolTable) {
+  SymbolTable table(kExportedNames, /* numBuckets= */ 1, /* bloomSize= */ 1);
+  // Point the bucket past the symbol table.
+  table.sysvHashTable[2] = static_cast<ElfWord>(table.names.size());
+  EXPECT_EQ(table.lookupSysv("memcpy"), 0u);
+  EXPECT_EQ(table.numNamesCompared, 0u);
+}
+
+TEST(ElfSymbolHash, FallsBackToSysvHashTable) {
+  SymbolTable table(kExportedNames, /* numBuckets= */ 3, /* bloomSize= */ 2);
+  for (const std::string &name : kExportedNames) {
+    EXPECT_EQ(table.lookup(nullptr, table.sysvHashTable.data(), name.c_str()),
+              table.indexOf(name));
+  }
+
+  // The DT_GNU_HASH table is used when there is one, even with a DT_HASH
+  // table, which is emptied here to show it is not used.
+  std::vector<ElfWord> emptySysvHashTable = {0, 0};
+  EXPECT_EQ(table.lookup(table.gnuHashTable.data(), emptySysvHashTable.data(),
+                         "memcpy"),
+            table.indexOf("memcpy"));
+  EXPECT_EQ(table.lookup(nullptr, nullptr, "memcpy"), 0u);
+}
+
+}  // namespace
+}  // namespace chre
@@ -16,7 +16,12 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cinttypes>
+#include <cstdarg>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "chre/core/event.h"
 #include "chre/platform/atomic.h"
@@ -24,6 +29,7 @@
 #include "chre/platform/mutex.h"
 #include "chre/platform/shared/bt_snoop_log.h"
 #include "chre/platform/shared/log_buffer.h"
+#include "chre/util/lz_compression.h"
 
 using testing::ContainerEq;
 
@@ -39,9 +45,28 @@ class TestLogBufferCallback : public LogBufferCallbackInterface {
   }
 };
 
+class CountingLogBufferCallback : public LogBufferCallbackInterface {
+ public:
+  void onLogsReady() {
+    mNumNotifications++;
+  }
+
+  size_t mNumNotifications = 0;
+};
+
 static constexpr size_t kDefaultBufferSize = 1024;
 
 // Helpers
+size_t encodeDeferredLog(uint8_t *buffer, size_t bufferSize,
+                         const char *logFormat, ...) {
+  va_list args;
+  va_start(args, logFormat);
+  size_t size =
+      LogBuffer::encodeDeferredLogVa(logFormat, args, buffer, bufferSize);
+  va_end(args);
+  return size;
+}
+
 void copyStringWithOffset(char *destination, const char *source,
                           size_t sourceOffset) {
   size_t strlength = strlen(source + sourceOffset);
@@ -415,13 +440,14 @@ TEST(LogBuffer, WouldCauseOverflowTest) {
 }
 
 TEST(LogBuffer, TransferTest) {
-  char buffer[kDefaultBufferSize];
+  char bufferFrom[kDefaultBufferSize];
+  char bufferTo[kDefaultBufferSize];
   const size_t kOutBufferSize = 10;
   char outBuffer[kOutBufferSize];
   size_t numLogsDropped;
   TestLogBufferCallback callback;
-  LogBuffer logBufferFrom(&callback, buffer, kDefaultBufferSize);
-  LogBuffer logBufferTo(&callback, buffer, kDefaultBufferSize);
+  LogBuffer logBufferFrom(&callback, bufferFrom, kDefaultBufferSize);
+  LogBuffer logBufferTo(&callback, bufferTo, kDefaultBufferSize);
 
   const char *str1 = "str1";
   const char *str2 = "str2";
@@ -503,6 +529,285 @@ TEST(LogBuffer, GetLogDataLengthTest) {
             LogBuffer::kNanoappTokenizedLogOffset + kLogPayloadSize);
 }
 
-// TODO(srok): Add multithreaded tests
+TEST(LogBuffer, NotificationsAreCoalesced) {
+  char buffer[kDefaultBufferSize];
+  constexpr size_t kOutBufferSize = 200;
+  char outBuffer[kOutBufferSize];
+  size_t numLogsDropped;
+  CountingLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  for (size_t i = 0; i < 5; i++) {
+    logBuffer.handleLog(LogBufferLogLevel::INFO, 0, "test");
+  }
+  EXPECT_EQ(callback.mNumNotifications, 1);
+
+  // Copying logs out re-arms the notification.
+  logBuffer.copyLogs(outBuffer, kOutBufferSize, &numLogsDropped);
+  logBuffer.handleLog(LogBufferLogLevel::INFO, 1, "test");
+  EXPECT_EQ(callback.mNumNotifications, 2);
+
+  // A log outside of the coalescing window notifies again even if the logs
+  // were not copied out.
+  logBuffer.handleLog(LogBufferLogLevel::INFO,
+                      1 + LogBuffer::kNotificationCoalescingWindowMs, "test");
+  EXPECT_EQ(callback.mNumNotifications, 3);
+}
+
+TEST(LogBuffer, ThresholdNotificationIsCoalesced) {
+  char buffer[kDefaultBufferSize];
+  CountingLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+  logBuffer.updateNotificationSetting(LogBufferNotificationSetting::THRESHOLD,
+                                      kDefaultBufferSize / 2);
+
+  std::string testLogStr(100, 'a');
+  for (size_t i = 0; i < 20; i++) {
+    logBuffer.handleLog(LogBufferLogLevel::INFO, 0, testLogStr.c_str());
+  }
+  EXPECT_EQ(callback.mNumNotifications, 1);
+}
+
+TEST(LogBuffer, CopyingNothingRearmsNotification) {
+  char buffer[kDefaultBufferSize];
+  char outBuffer[1];
+  size_t numLogsDropped;
+  CountingLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  logBuffer.handleLog(LogBufferLogLevel::INFO, 0, "test");
+  EXPECT_EQ(callback.mNumNotifications, 1);
+
+  // The log does not fit so nothing is copied, but the consumer acted on the
+  // notification and must be notified of the next log.
+  EXPECT_EQ(logBuffer.copyLogs(outBuffer, sizeof(outBuffer), &numLogsDropped),
+            0);
+  logBuffer.handleLog(LogBufferLogLevel::INFO, 1, "test");
+  EXPECT_EQ(callback.mNumNotifications, 2);
+}
+
+TEST(LogBuffer, MultiThreadedProducersDeliverAllLogs) {
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kLogsPerThread = 500;
+  // Large enough for all logs so none has to be dropped, while the consumer
+  // still drains the buffer concurrently with the producers.
+  constexpr size_t kBufferSize = 64 * 1024;
+  std::vector<uint8_t> buffer(kBufferSize);
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer.data(), kBufferSize);
+
+  std::atomic<bool> producersDone(false);
+  std::vector<std::string> logsCopied;
+
+  std::thread consumer([&]() {
+    std::vector<uint8_t> outBuffer(kBufferSize);
+    size_t numLogsDropped;
+    while (true) {
+      bool done = producersDone.load();
+      size_t bytesCopied =
+          logBuffer.copyLogs(outBuffer.data(), kBufferSize, &numLogsDropped);
+      size_t offset = 0;
+      while (offset < bytesCopied) {
+        EXPECT_EQ(outBuffer[offset],
+                  static_cast<uint8_t>(LogBufferLogLevel::INFO));
+        const char *log = reinterpret_cast<const char *>(&outBuffer[offset]) +
+                          LogBuffer::kLogDataOffset;
+        logsCopied.emplace_back(log);
+        offset += LogBuffer::kLogDataOffset + strlen(log) + 1;
+      }
+      if (done && bytesCopied == 0) {
+        break;
+      }
+    }
+  });
+
+  std::vector<std::thread> producers;
+  for (size_t i = 0; i < kNumThreads; i++) {
+    producers.emplace_back([&logBuffer, i]() {
+      for (size_t j = 0; j < kLogsPerThread; j++) {
+        logBuffer.handleLog(LogBufferLogLevel::INFO, 0, "thread %zu log %zu",
+                            i, j);
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  producersDone = true;
+  consumer.join();
+
+  EXPECT_EQ(logBuffer.getNumLogsDropped(), 0);
+  ASSERT_EQ(logsCopied.size(), kNumThreads * kLogsPerThread);
+
+  // Every log is delivered once and the logs of each thread stay in order.
+  size_t nextLogIndex[kNumThreads] = {};
+  for (const std::string &log : logsCopied) {
+    size_t thread;
+    size_t index;
+    ASSERT_EQ(sscanf(log.c_str(), "thread %zu log %zu", &thread, &index), 2);
+    ASSERT_LT(thread, kNumThreads);
+    EXPECT_EQ(index, nextLogIndex[thread]);
+    nextLogIndex[thread] = index + 1;
+  }
+  for (size_t i = 0; i < kNumThreads; i++) {
+    EXPECT_EQ(nextLogIndex[i], kLogsPerThread);
+  }
+}
+
+TEST(LogBuffer, DeferredLogEncodesArguments) {
+  const char *logFormat = "%d %u %s %c";
+  uint8_t buffer[LogBuffer::kDeferredStringLogMaxSize];
+
+  size_t size = encodeDeferredLog(buffer, sizeof(buffer), logFormat, -2, 300u,
+                                  "ab", 'c');
+
+  int32_t formatOffset = static_cast<int32_t>(logFormat - chreLogFormatAnchor);
+  std::vector<uint8_t> expected = {
+      static_cast<uint8_t>(formatOffset),
+      static_cast<uint8_t>(formatOffset >> 8),
+      static_cast<uint8_t>(formatOffset >> 16),
+      static_cast<uint8_t>(formatOffset >> 24),
+      0x03,              // -2 zigzag encoded
+      0xac, 0x02,        // 300 as a varint
+      'a', 'b', '\0',    // NUL-terminated string
+      'c'};              // char as a varint
+  ASSERT_EQ(size, expected.size());
+  EXPECT_THAT(std::vector<uint8_t>(buffer, buffer + size),
+              ContainerEq(expected));
+}
+
+TEST(LogBuffer, DeferredLogRejectsUnsupportedOrOversizedLogs) {
+  uint8_t buffer[LogBuffer::kDeferredStringLogMaxSize];
+  EXPECT_EQ(encodeDeferredLog(buffer, sizeof(buffer), "%Lf",
+                              static_cast<long double>(1.0)),
+            0);
+
+  std::string longString(LogBuffer::kDeferredStringLogMaxSize, 'a');
+  EXPECT_EQ(encodeDeferredLog(buffer, sizeof(buffer), "%s", longString.c_str()),
+            0);
+}
+
+TEST(LogBuffer, DeferredLogAddedToBuffer) {
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  uint8_t encodedLog[LogBuffer::kDeferredStringLogMaxSize];
+  size_t size = encodeDeferredLog(encodedLog, sizeof(encodedLog),
+                                  "value %d", 42);
+  ASSERT_GT(size, 0);
+  logBuffer.handleDeferredLog(LogBufferLogLevel::INFO, 0, encodedLog, size);
+
+  uint8_t outBuffer[kDefaultBufferSize];
+  size_t numLogsDropped;
+  size_t bytesCopied =
+      logBuffer.copyLogs(outBuffer, sizeof(outBuffer), &numLogsDropped);
+  EXPECT_EQ(bytesCopied, LogBuffer::kLogDataOffset +
+                             LogBuffer::kDeferredStringLogOffset + size);
+  EXPECT_EQ(outBuffer[0] >> 4, static_cast<uint8_t>(LogType::DEFERRED_STRING));
+  EXPECT_EQ(outBuffer[LogBuffer::kLogDataOffset], size);
+  EXPECT_EQ(memcmp(&outBuffer[LogBuffer::kLogDataOffset +
+                              LogBuffer::kDeferredStringLogOffset],
+                   encodedLog, size),
+            0);
+}
+
+TEST(LogBuffer, DeferredLogEncodesOnlyThePrecisionOfAString) {
+  // As with printf, the string does not need to be NULL terminated if the
+  // precision is shorter than it.
+  const char unterminated[] = {'a', 'b', 'c', 'd'};
+  uint8_t buffer[LogBuffer::kDeferredStringLogMaxSize];
+
+  size_t size = encodeDeferredLog(buffer, sizeof(buffer), "%.*s %.2s", 3,
+                                  unterminated, unterminated);
+
+  std::vector<uint8_t> expected = {0x06,  // 3 zigzag encoded
+                                   'a', 'b', 'c', '\0', 'a', 'b', '\0'};
+  ASSERT_EQ(size, sizeof(int32_t) + expected.size());
+  EXPECT_THAT(std::vector<uint8_t>(buffer + sizeof(int32_t), buffer + size),
+              ContainerEq(expected));
+}
+
+TEST(LogBuffer, DeferredLogTakesLessSpaceThanStringLog) {
+  constexpr size_t kNumLogs = 1000;
+  constexpr size_t kBufferSize = 4096;
+  const char *logFormat = "Sensor %u sample rate %" PRIu32 " latency %" PRIu64
+                          " ns bias %f";
+  char stringBuffer[kBufferSize];
+  char deferredBuffer[kBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer stringLogBuffer(&callback, stringBuffer, kBufferSize);
+  LogBuffer deferredLogBuffer(&callback, deferredBuffer, kBufferSize);
+
+  for (size_t i = 0; i < kNumLogs; i++) {
+    stringLogBuffer.handleLog(LogBufferLogLevel::INFO, 0, logFormat, 3u,
+                              static_cast<uint32_t>(i), UINT64_C(20000000),
+                              0.5);
+
+    uint8_t encodedLog[LogBuffer::kDeferredStringLogMaxSize];
+    size_t size = encodeDeferredLog(encodedLog, sizeof(encodedLog), logFormat,
+                                    3u, static_cast<uint32_t>(i),
+                                    UINT64_C(20000000), 0.5);
+    ASSERT_GT(size, 0);
+    deferredLogBuffer.handleDeferredLog(LogBufferLogLevel::INFO, 0, encodedLog,
+                                        size);
+  }
+
+  // Both buffers are full, so the buffer holding more logs uses fewer bytes
+  // per log.
+  size_t stringLogsHeld = kNumLogs - stringLogBuffer.getNumLogsDropped();
+  size_t deferredLogsHeld = kNumLogs - deferredLogBuffer.getNumLogsDropped();
+  ASSERT_GT(stringLogsHeld, 0);
+  EXPECT_GT(deferredLogsHeld, 2 * stringLogsHeld);
+}
+
+TEST(LogBuffer, LogCompressionRatio) {
+  // Log lines modeled after a recorded CHRE session, interleaving system and
+  // nanoapp logs.
+  const char *kLogCorpus[] = {
+      "Nanoapp 0x476f6f676c00100b sent event 0x%" PRIx16 " to host",
+      "[WIFI] Scan request from nanoapp %" PRIu16 " accepted",
+      "[WIFI] Scan results: %" PRIu8 " APs, %" PRIu32 " ms",
+      "[BLE] Scan started with %" PRIu8 " filters, mode %" PRIu8,
+      "[GNSS] Location update: accuracy %" PRIu32 " m",
+      "Sensor 0x%" PRIx8 " sample rate %" PRIu32 " latency %" PRIu32 " us",
+      "Host awake %" PRIu8 ", pending logs %" PRIu32,
+      "Nanoapp %" PRIu16 " allocated %" PRIu32 " bytes",
+  };
+  constexpr size_t kCorpusSize = sizeof(kLogCorpus) / sizeof(kLogCorpus[0]);
+  constexpr size_t kBufferSize = 4096;
+  char buffer[kBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kBufferSize);
+
+  uint32_t timestampMs = 123456;
+  for (size_t i = 0; !logBuffer.logWouldCauseOverflow(64); i++) {
+    timestampMs += i % 3;
+    logBuffer.handleLog(LogBufferLogLevel::INFO, timestampMs,
+                        kLogCorpus[i % kCorpusSize],
+                        static_cast<uint32_t>(i % 7),
+                        static_cast<uint32_t>(i * 13 % 1000),
+                        static_cast<uint32_t>(i % 5));
+  }
+  uint8_t logData[kBufferSize];
+  size_t numLogsDropped;
+  size_t logDataSize = logBuffer.copyLogs(logData, sizeof(logData), &numLogsDropped);
+  ASSERT_GT(logDataSize, 0);
+
+  LzCompressor compressor;
+  uint8_t compressed[kBufferSize];
+  size_t compressedSize = compressor.compress(logData, logDataSize, compressed,
+                                              sizeof(compressed));
+  ASSERT_GT(compressedSize, 0);
+  EXPECT_LT(compressedSize, logDataSize / 2);
+
+  uint8_t decompressed[kBufferSize];
+  size_t decompressedSize = 0;
+  ASSERT_TRUE(lzDecompress(compressed, compressedSize, decompressed,
+                           sizeof(decompressed), &decompressedSize));
+  EXPECT_THAT(std::vector<uint8_t>(decompressed,
+                                   decompressed + decompressedSize),
+              ContainerEq(std::vector<uint8_t>(logData, logData + logDataSize)));
+}
 
 }  // namespace chre
@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/shared/streaming_elf_mapper.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "chre/platform/shared/memory.h"
+#include "gtest/gtest.h"
+
+namespace chre {
+namespace {
+
+//! Tracks the memory used by the nanoapp binary and loader allocations, which
+//! the Linux platform does not implement.
+struct MemoryTracker {
+  std::map<void *, size_t> allocations;
+  size_t currentBytes = 0;
+  size_t peakBytes = 0;
+
+  void *allocate(size_t size, size_t alignment) {
+    void *pointer = nullptr;
+    if (posix_memalign(&pointer, std::max(alignment, sizeof(void *)),
+                       size == 0 ? 1 : size) != 0) {
+      return nullptr;
+    }
+    allocations[pointer] = size;
+    currentBytes += size;
+    peakBytes = std::max(peakBytes, currentBytes);
+    return pointer;
+  }
+
+  void free(void *pointer) {
+    if (pointer != nullptr) {
+      currentBytes -= allocations[pointer];
+      allocations.erase(pointer);
+      ::free(pointer);
+    }
+  }
+
+  void reset() {
+    peakBytes = currentBytes;
+  }
+};
+
+MemoryTracker gMemory;
+
+}  // namespace
+
+void *nanoappBinaryAlloc(size_t size, size_t alignment) {
+  return gMemory.allocate(size, alignment);
+}
+
+void *nanoappBinaryDramAlloc(size_t size, size_t alignment) {
+  return gMemory.allocate(size, alignment);
+}
+
+void nanoappBinaryFree(void *pointer) {
+  gMemory.free(pointer);
+}
+
+void nanoappBinaryDramFree(void *pointer) {
+  gMemory.free(pointer);
+}
+
+void *memoryAllocDram(size_t size) {
+  return gMemory.allocate(size, 0 /* alignment */);
+}
+
+void memoryFreeDram(void *pointer) {
+  gMemory.free(pointer);
+}
+
+namespace {
+
+using ElfHeader = StreamingElfMapper::ElfHeader;
+using ProgramHeader = StreamingElfMapper::ProgramHeader;
+using SectionHeader = StreamingElfMapper::SectionHeader;
+
+constexpr size_t kTextSize = 0x400;
+constexpr size_t kDataOffset = kTextSize;
+constexpr size_t kDataFileSize = 0x100;
+constexpr size_t kDataMemSize = 0x300;
+constexpr size_t kMappingSize = kDataOffset + kDataMemSize;
+constexpr char kSectionNames[] = "\0.text\0.data\0.shstrtab\0.symtab";
+constexpr size_t kNumSections = 5;
+
+// Section types, which the loader does not need.
+constexpr uint32_t kSectionTypeProgBits = 1;
+constexpr uint32_t kSectionTypeSymTab = 2;
+constexpr uint32_t kSectionTypeStrTab = 3;
+
+uint8_t patternByte(size_t offset) {
+  return static_cast<uint8_t>(offset * 7 + 3);
+}
+
+/**
+ * Builds a nanoapp-like 32-bit ELF binary: a read-only segment holding the
+ * headers, a writable segment with .bss, symbols and debug info that are not
+ * loaded, the section names and the section header table.
+ *
+ * @param droppedSize The size of the data that is not loaded.
+ * @param namesAfterSectionHeaders Whether the section names follow the section
+ *     header table instead of preceding it.
+ */
+std::vector<uint8_t> buildBinary(size_t droppedSize,
+                                 bool namesAfterSectionHeaders = false) {
+  size_t droppedOffset = kDataOffset + kDataFileSize;
+  size_t namesOffset = droppedOffset + droppedSize;
+  size_t sectionHeadersOffset = namesOffset + sizeof(kSectionNames);
+  sectionHeadersOffset = (sectionHeadersOffset + 3) & ~static_cast<size_t>(3);
+  size_t binarySize = sectionHeadersOffset + kNumSections * sizeof(SectionHeader);
+  if (namesAfterSectionHeaders) {
+    sectionHeadersOffset = (namesOffset + 3) & ~static_cast<size_t>(3);
+    namesOffset = sectionHeadersOffset + kNumSections * sizeof(SectionHeader);
+    binarySize = namesOffset + sizeof(kSectionNames);
+  }
+
+  std::vector<uint8_t> binary(binarySize);
+  for (size_t i = 0; i < binary.size(); i++) {
+    binary[i] = patternByte(i);
+  }
+
+  ElfHeader elfHeader = {};
+  memcpy(elfHeader.e_ident, ELFMAG, SELFMAG);
+  elfHeader.e_ident[EI_CLASS] = ELFCLASS32;
+  elfHeader.e_phoff = sizeof(ElfHeader);
+  elfHeader.e_shoff = sectionHeadersOffset;
+  elfHeader.e_ehsize = sizeof(ElfHeader);
+  elfHeader.e_phentsize = sizeof(ProgramHeader);
+  elfHeader.e_phnum = 3;
+  elfHeader.e_shentsize = sizeof(SectionHeader);
+  elfHeader.e_shnum = kNumSections;
+  elfHeader.e_shstrndx = 3;
+  memcpy(binary.data(), &elfHeader, sizeof(elfHeader));
+
+  ProgramHeader programHeaders[3] = {};
+  programHeaders[0].p_type = PT_LOAD;
+  programHeaders[0].p_filesz = kTextSize;
+  programHeaders[0].p_memsz = kTextSize;
+  programHeaders[0].p_flags = PF_R | PF_X;
+  programHeaders[0].p_align = 0x10;
+  programHeaders[1].p_type = PT_LOAD;
+  programHeaders[1].p_offset = kDataOffset;
+  programHeaders[1].p_vaddr = kDataOffset;
+  programHeaders[1].p_filesz = kDataFileSize;
+  programHeaders[1].p_memsz = kDataMemSize;
+  programHeaders[1].p_flags = PF_R | PF_W;
+  programHeaders[1].p_align = 0x10;
+  programHeaders[2].p_type = PT_DYNAMIC;
+  programHeaders[2].p_offset = kDataOffset;
+  programHeaders[2].p_vaddr = kDataOffset;
+  programHeaders[2].p_filesz = 0x40;
+  programHeaders[2].p_memsz = 0x40;
+  memcpy(binary.data() + elfHeader.e_phoff, programHeaders,
+         sizeof(programHeaders));
+
+  SectionHeader sectionHeaders[kNumSections] = {};
+  sectionHeaders[1] = {1, kSectionTypeProgBits, 0, 0, 0, kTextSize, 0, 0, 0, 0};
+  sectionHeaders[2] = {7, kSectionTypeProgBits, 0, kDataOffset, kDataOffset,
+                       kDataFileSize, 0, 0, 0, 0};
+  sectionHeaders[3] = {13, kSectionTypeStrTab, 0, 0, static_cast<uint32_t>(namesOffset),
+                       sizeof(kSectionNames), 0, 0, 0, 0};
+  sectionHeaders[4] = {23, kSectionTypeSymTab, 0, 0,
+                       static_cast<uint32_t>(droppedOffset),
+                       static_cast<uint32_t>(droppedSize), 0, 0, 0, 0};
+  memcpy(binary.data() + sectionHeadersOffset, sectionHeaders,
+         sizeof(sectionHeaders));
+  memcpy(binary.data() + namesOffset, kSectionNames, sizeof(kSectionNames));
+  return binary;
+}
+
+bool streamBinary(StreamingElfMapper &mapper,
+                  const std::vector<uint8_t> &binary, size_t fragmentSize) {
+  for (size_t offset = 0; offset < binary.size(); offset += fragmentSize) {
+    size_t size = std::min(fragmentSize, binary.size() - offset);
+    if (!mapper.append(binary.data() + offset, size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void expectMapped(StreamingElfMapper &mapper,
+                  const std::vector<uint8_t> &binary) {
+  ASSERT_TRUE(mapper.isComplete());
+  EXPECT_EQ(mapper.getNumBytesReceived(), binary.size());
+  EXPECT_EQ(mapper.getMappingSize(), kMappingSize);
+  EXPECT_EQ(mapper.getNumSectionHeaders(), kNumSections);
+
+  auto *mapping = reinterpret_cast<uint8_t *>(mapper.getLoadBias());
+  EXPECT_EQ(memcmp(mapping, binary.data(), kDataOffset + kDataFileSize), 0);
+  for (size_t i = kDataOffset + kDataFileSize; i < kMappingSize; i++) {
+    ASSERT_EQ(mapping[i], 0) << "at " << i;
+  }
+
+  const auto *elfHeader = reinterpret_cast<const ElfHeader *>(binary.data());
+  SectionHeader *sectionHeaders = mapper.releaseSectionHeaders();
+  char *sectionNames = mapper.releaseSectionNames();
+  EXPECT_EQ(memcmp(sectionHeaders, binary.data() + elfHeader->e_shoff,
+                   kNumSections * sizeof(SectionHeader)),
+            0);
+  EXPECT_STREQ(&sectionNames[sectionHeaders[3].sh_name], ".shstrtab");
+  EXPECT_STREQ(&sectionNames[sectionHeaders[4].sh_name], ".symtab");
+  memoryFreeDram(sectionHeaders);
+  memoryFreeDram(sectionNames);
+}
+
+}  // namespace
+
+TEST(StreamingElfMapper, MapsBinaryForAnyFragmentSize) {
+  std::vector<uint8_t> binary = buildBinary(0x2000);
+  for (size_t fragmentSize : {size_t(1), size_t(7), size_t(64), size_t(1000),
+                              binary.size()}) {
+    StreamingElfMapper mapper(binary.size(), false /* mapIntoTcm */);
+    ASSERT_TRUE(streamBinary(mapper, binary, fragmentSize)) << fragmentSize;
+    expectMapped(mapper, binary);
+  }
+  EXPECT_EQ(gMemory.currentBytes, 0);
+}
+
+TEST(StreamingElfMapper, MapsSectionNamesAfterSectionHeaders) {
+  std::vector<uint8_t> binary =
+      buildBinary(0x2000, true /* namesAfterSectionHeaders */);
+  StreamingElfMapper mapper(binary.size(), true /* mapIntoTcm */);
+  ASSERT_TRUE(streamBinary(mapper, binary, 100));
+  EXPECT_TRUE(mapper.isTcmMapping());
+  expectMapped(mapper, binary);
+}
+
+TEST(StreamingElfMapper, HandsOverMapping) {
+  std::vector<uint8_t> binary = buildBinary(0x100);
+  uint8_t *mapping = nullptr;
+  {
+    StreamingElfMapper mapper(binary.size(), false /* mapIntoTcm */);
+    ASSERT_TRUE(streamBinary(mapper, binary, 256));
+    mapping = mapper.releaseMapping();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mapping), mapper.getLoadBias());
+  }
+  EXPECT_EQ(gMemory.currentBytes, kMappingSize);
+  nanoappBinaryDramFree(mapping);
+  EXPECT_EQ(gMemory.currentBytes, 0);
+}
+
+TEST(StreamingElfMapper, HandsOverWhatTheLoaderReads) {
+  std::vector<uint8_t> binary = buildBinary(0x2000);
+  StreamingElfMapper mapper(binary.size(), false /* mapIntoTcm */);
+  ASSERT_TRUE(streamBinary(mapper, binary, 512));
+
+  // Take everything over as NanoappLoader(StreamingElfMapper &) does, after
+  // which the mapper owns nothing.
+  uint8_t *headers = mapper.getHeaders();
+  uintptr_t loadBias = mapper.getLoadBias();
+  size_t numSectionHeaders = mapper.getNumSectionHeaders();
+  uint8_t *mapping = mapper.releaseMapping();
+  SectionHeader *sectionHeaders = mapper.releaseSectionHeaders();
+  char *sectionNames = mapper.releaseSectionNames();
+  EXPECT_EQ(mapper.releaseMapping(), nullptr);
+  EXPECT_EQ(mapper.releaseSectionHeaders(), nullptr);
+  EXPECT_EQ(mapper.releaseSectionNames(), nullptr);
+
+  // The ELF and program headers are kept in the binary layout.
+  const auto *elfHeader = reinterpret_cast<const ElfHeader *>(headers);
+  EXPECT_EQ(memcmp(headers, binary.data(),
+                   elfHeader->e_phoff +
+                       elfHeader->e_phnum * sizeof(ProgramHeader)),
+            0);
+
+  // Sections are found by name, and their file offsets resolve into the
+  // mapping through the load segments, as NanoappLoader::getMappedData() does.
+  const auto *programHeaders =
+      reinterpret_cast<const ProgramHeader *>(headers + elfHeader->e_phoff);
+  const SectionHeader *dataSection = nullptr;
+  for (size_t i = 0; i < numSectionHeaders; i++) {
+    if (strcmp(&sectionNames[sectionHeaders[i].sh_name], ".data") == 0) {
+      dataSection = &sectionHeaders[i];
+    }
+  }
+  ASSERT_NE(dataSection, nullptr);
+  const uint8_t *data = nullptr;
+  for (size_t i = 0; i < elfHeader->e_phnum; i++) {
+    const ProgramHeader &ph = programHeaders[i];
+    if (ph.p_type == PT_LOAD && dataSection->sh_offset >= ph.p_offset &&
+        dataSection->sh_offset < ph.p_offset + ph.p_filesz) {
+      data = reinterpret_cast<const uint8_t *>(loadBias + ph.p_vaddr +
+                                               dataSection->sh_offset -
+                                               ph.p_offset);
+    }
+  }
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(data, mapping + kDataOffset);
+  EXPECT_EQ(memcmp(data, binary.data() + dataSection->sh_offset,
+                   dataSection->sh_size),
+            0);
+
+  // The loader frees what it took over with the matching functions.
+  nanoappBinaryDramFree(mapping);
+  memoryFreeDram(sectionHeaders);
+  memoryFreeDram(sectionNames);
+}
+
+TEST(StreamingElfMapper, RejectsMalformedBinaries) {
+  std::vector<uint8_t> binary = buildBinary(0x100);
+  size_t numBytesBefore = gMemory.currentBytes;
+
+  std::vector<uint8_t> badMagic = binary;
+  badMagic[1] = 'X';
+  StreamingElfMapper badMagicMapper(badMagic.size(), false);
+  EXPECT_FALSE(streamBinary(badMagicMapper, badMagic, 64));
+
+  std::vector<uint8_t> tooManyHeaders = binary;
+  reinterpret_cast<ElfHeader *>(tooManyHeaders.data())->e_phnum = 100;
+  StreamingElfMapper tooManyHeadersMapper(tooManyHeaders.size(), false);
+  EXPECT_FALSE(streamBinary(tooManyHeadersMapper, tooManyHeaders, 64));
+
+  std::vector<uint8_t> badSectionHeaders = binary;
+  reinterpret_cast<ElfHeader *>(badSectionHeaders.data())->e_shoff =
+      binary.size() - 4;
+  StreamingElfMapper badSectionHeadersMapper(badSectionHeaders.size(), false);
+  EXPECT_FALSE(streamBinary(badSectionHeadersMapper, badSectionHeaders, 64));
+
+  // The section names are far before the section header table, in data that
+  // has been dropped.
+  std::vector<uint8_t> namesDropped = buildBinary(0x2000);
+  auto *elfHeader = reinterpret_cast<ElfHeader *>(namesDropped.data());
+  auto *sectionHeaders =
+      reinterpret_cast<SectionHeader *>(namesDropped.data() + elfHeader->e_shoff);
+  sectionHeaders[3].sh_offset = kDataOffset + kDataFileSize;
+  StreamingElfMapper namesDroppedMapper(namesDropped.size(), false);
+  EXPECT_FALSE(streamBinary(namesDroppedMapper, namesDropped, 64));
+  EXPECT_EQ(namesDroppedMapper.releaseSectionNames(), nullptr);
+
+  // Nothing else than the mapping and the section headers is allocated for a
+  // binary that fails to map.
+  EXPECT_LE(gMemory.currentBytes - numBytesBefore,
+            kMappingSize + kNumSections * sizeof(SectionHeader));
+}
+
+TEST(StreamingElfMapper, RejectsOverflow) {
+  std::vector<uint8_t> binary = buildBinary(0x100);
+  StreamingElfMapper mapper(binary.size() - 1, false /* mapIntoTcm */);
+  EXPECT_FALSE(mapper.append(binary.data(), binary.size()));
+
+  StreamingElfMapper completeMapper(binary.size(), false /* mapIntoTcm */);
+  ASSERT_TRUE(streamBinary(completeMapper, binary, 64));
+  EXPECT_FALSE(completeMapper.append(binary.data(), 1));
+}
+
+TEST(StreamingElfMapper, StreamedLoadPeakMemoryIsBounded) {
+  // A nanoapp where most of the binary is symbols, debug info and the token
+  // database, which are not loaded.
+  std::vector<uint8_t> binary = buildBinary(64 * 1024);
+
+  // The buffered load holds the whole binary while it allocates the mapping,
+  // the section headers and the section names.
+  size_t bufferedPeakBytes = binary.size() + kMappingSize +
+                             kNumSections * sizeof(SectionHeader) +
+                             sizeof(kSectionNames);
+
+  gMemory.reset();
+  StreamingElfMapper mapper(binary.size(), false /* mapIntoTcm */);
+  ASSERT_TRUE(streamBinary(mapper, binary, 4000));
+  size_t streamingPeakBytes = gMemory.peakBytes;
+  expectMapped(mapper, binary);
+
+  EXPECT_LE(streamingPeakBytes,
+            kMappingSize + StreamingElfMapper::kSectionNamesWindowSize +
+                kNumSections * sizeof(SectionHeader) + sizeof(kSectionNames));
+  EXPECT_LT(streamingPeakBytes * 2, bufferedPeakBytes);
+}
+
+}  // namespace chre
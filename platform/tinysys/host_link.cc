@@ -29,6 +29,8 @@
 #include "chre/platform/system_timer.h"
 #include "chre/util/flatbuffers/helpers.h"
 #include "chre/util/nested_data_ptr.h"
+#include "chre/util/synchronized_memory_pool.h"
+#include "chre/util/system/pooled_flatbuffer_allocator.h"
 #include "chre_api/chre.h"
 
 #include "dma_api.h"
@@ -38,7 +40,7 @@
 #include "scp_dram_region.h"
 
 // Because the LOGx macros are being redirected to logcat through
-// HostLink::sendLogMessageV2 and HostLink::send, calling them from
+// HostLink::sendLogMessageV2/V3 and HostLink::send, calling them from
 // inside HostLink impl could result in endless recursion.
 // So redefine them to just printf function to SCP console.
 #if CHRE_MINIMUM_LOG_LEVEL >= CHRE_LOG_LEVEL_ERROR
@@ -132,6 +134,8 @@ enum class PendingMessageType {
   NanConfigurationRequest,
   PulseRequest,
   PulseResponse,
+  NanoappMessageBatch,
+  StructuredDebugDumpData,
 };
 
 struct PendingMessage {
@@ -166,10 +170,54 @@ DRAM_REGION_VARIABLE FixedSizeBlockingQueue<PendingMessage, kOutboundQueueSize>
 typedef void(MessageBuilderFunction)(ChreFlatBufferBuilder &builder,
                                      void *cookie);
 
+//! The buffers of the messages sent to the host are allocated from these
+//! pools rather than from the heap. Most messages fit in a small buffer, while
+//! log messages, of which only one is in flight at a time, need a large buffer.
+constexpr size_t kSmallMessageBufferSize = 256;
+constexpr size_t kNumSmallMessageBuffers = 8;
+constexpr size_t kLargeMessageBufferSize = CHRE_MESSAGE_TO_HOST_MAX_SIZE + 256;
+DRAM_REGION_VARIABLE PooledFlatBufferAllocator<kLargeMessageBufferSize, 1>
+    gLargeBufferAllocator;
+DRAM_REGION_VARIABLE
+PooledFlatBufferAllocator<kSmallMessageBufferSize, kNumSmallMessageBuffers>
+    gMessageBufferAllocator(&gLargeBufferAllocator);
+
+//! The builders of the messages waiting in the outbound queue, which are
+//! allocated from the heap once the pool is exhausted.
+DRAM_REGION_VARIABLE
+SynchronizedMemoryPool<ChreFlatBufferBuilder, kNumSmallMessageBuffers>
+    gBuilderPool;
+
 inline HostCommsManager &getHostCommsManager() {
   return EventLoopManagerSingleton::get()->getHostCommsManager();
 }
 
+/**
+ * Allocates a builder for a message of the outbound queue, with its buffer
+ * allocated from the message buffer pools.
+ *
+ * @return The builder, or nullptr if the allocation failed. It must be
+ *         released with freeBuilder().
+ */
+DRAM_REGION_FUNCTION ChreFlatBufferBuilder *allocateBuilder(
+    size_t initialBufferSize) {
+  ChreFlatBufferBuilder *builder =
+      gBuilderPool.allocate(initialBufferSize, &gMessageBufferAllocator);
+  if (builder == nullptr) {
+    builder = memoryAlloc<ChreFlatBufferBuilder>(initialBufferSize,
+                                                 &gMessageBufferAllocator);
+  }
+  return builder;
+}
+
+DRAM_REGION_FUNCTION void freeBuilder(ChreFlatBufferBuilder *builder) {
+  if (gBuilderPool.containsAddress(builder)) {
+    gBuilderPool.deallocate(builder);
+  } else {
+    memoryFreeAndDestroy(builder);
+  }
+}
+
 DRAM_REGION_FUNCTION bool generateMessageFromBuilder(
     ChreFlatBufferBuilder *builder) {
   CHRE_ASSERT(builder != nullptr);
@@ -178,8 +226,7 @@ DRAM_REGION_FUNCTION bool generateMessageFromBuilder(
       HostLinkBase::send(builder->GetBufferPointer(), builder->GetSize());
 
   // clean up
-  builder->~ChreFlatBufferBuilder();
-  memoryFree(builder);
+  freeBuilder(builder);
   return result;
 }
 
@@ -188,7 +235,8 @@ DRAM_REGION_FUNCTION bool generateMessageToHost(const HostMessage *message) {
   // TODO(b/285219398): ideally we'd construct our flatbuffer directly in the
   // host-supplied buffer
   constexpr size_t kFixedReserveSize = 88;
-  ChreFlatBufferBuilder builder(message->message.size() + kFixedReserveSize);
+  ChreFlatBufferBuilder builder(message->message.size() + kFixedReserveSize,
+                                &gMessageBufferAllocator);
   HostProtocolChre::encodeNanoappMessage(
       builder, message->appId, message->toHostData.messageType,
       message->toHostData.hostEndpoint, message->message.data(),
@@ -222,7 +270,7 @@ DRAM_REGION_FUNCTION int generateHubInfoResponse(uint16_t hostClientId) {
       IS_BIT_SET(chreGetCapabilities(), CHRE_CAPABILITIES_RELIABLE_MESSAGES);
 
   // Note that this may execute prior to EventLoopManager::lateInit() completing
-  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  ChreFlatBufferBuilder builder(kInitialBufferSize, &gMessageBufferAllocator);
   HostProtocolChre::encodeHubInfoResponse(
       builder, kHubName, kVendor, kToolchain, kLegacyPlatformVersion,
       kLegacyToolchainVersion, kPeakMips, kStoppedPower, kSleepPower,
@@ -257,6 +305,8 @@ DRAM_REGION_FUNCTION bool dequeueMessage(PendingMessage pendingMsg) {
     case PendingMessageType::MetricLog:
     case PendingMessageType::NanConfigurationRequest:
     case PendingMessageType::PulseResponse:
+    case PendingMessageType::NanoappMessageBatch:
+    case PendingMessageType::StructuredDebugDumpData:
       result = generateMessageFromBuilder(pendingMsg.data.builder);
       break;
 
@@ -298,18 +348,18 @@ DRAM_REGION_FUNCTION bool buildAndEnqueueMessage(
   LOGV("%s: message type %d, size %zu", __func__, msgType, initialBufferSize);
   bool pushed = false;
 
-  auto builder = MakeUnique<ChreFlatBufferBuilder>(initialBufferSize);
-  if (builder.isNull()) {
+  ChreFlatBufferBuilder *builder = allocateBuilder(initialBufferSize);
+  if (builder == nullptr) {
     LOGE("Couldn't allocate memory for message type %d",
          static_cast<int>(msgType));
   } else {
     msgBuilder(*builder, cookie);
 
-    if (!enqueueMessage(PendingMessage(msgType, builder.get()))) {
+    if (!enqueueMessage(PendingMessage(msgType, builder))) {
       LOGE("Couldn't push message type %d to outbound queue",
            static_cast<int>(msgType));
+      freeBuilder(builder);
     } else {
-      builder.release();
       pushed = true;
     }
   }
@@ -363,22 +413,25 @@ DRAM_REGION_FUNCTION void handleUnloadNanoappCallback(uint16_t /*type*/,
   }
 
   constexpr size_t kInitialBufferSize = 52;
-  auto builder = MakeUnique<ChreFlatBufferBuilder>(kInitialBufferSize);
-  HostProtocolChre::encodeUnloadNanoappResponse(*builder, cbData->hostClientId,
-                                                cbData->transactionId, success);
-
-  if (!enqueueMessage(PendingMessage(PendingMessageType::UnloadNanoappResponse,
-                                     builder.get()))) {
-    LOGE("Failed to send unload response to host: %x transactionID: 0x%x",
-         cbData->hostClientId, cbData->transactionId);
+  ChreFlatBufferBuilder *builder = allocateBuilder(kInitialBufferSize);
+  if (builder == nullptr) {
+    LOG_OOM();
   } else {
-    builder.release();
+    HostProtocolChre::encodeUnloadNanoappResponse(
+        *builder, cbData->hostClientId, cbData->transactionId, success);
+
+    if (!enqueueMessage(PendingMessage(
+            PendingMessageType::UnloadNanoappResponse, builder))) {
+      LOGE("Failed to send unload response to host: %x transactionID: 0x%x",
+           cbData->hostClientId, cbData->transactionId);
+      freeBuilder(builder);
+    }
   }
 
   memoryFree(data);
 }
 
-DRAM_REGION_FUNCTION void sendDebugDumpData(uint16_t hostClientId,
+DRAM_REGION_FUNCTION bool sendDebugDumpData(uint16_t hostClientId,
                                             const char *debugStr,
                                             size_t debugStrSize) {
   struct DebugDumpMessageData {
@@ -398,11 +451,12 @@ DRAM_REGION_FUNCTION void sendDebugDumpData(uint16_t hostClientId,
   data.hostClientId = hostClientId;
   data.debugStr = debugStr;
   data.debugStrSize = debugStrSize;
-  buildAndEnqueueMessage(PendingMessageType::DebugDumpData,
-                         kFixedSizePortion + debugStrSize, msgBuilder, &data);
+  return buildAndEnqueueMessage(PendingMessageType::DebugDumpData,
+                                kFixedSizePortion + debugStrSize, msgBuilder,
+                                &data);
 }
 
-DRAM_REGION_FUNCTION void sendDebugDumpResponse(uint16_t hostClientId,
+DRAM_REGION_FUNCTION bool sendDebugDumpResponse(uint16_t hostClientId,
                                                 bool success,
                                                 uint32_t dataCount) {
   struct DebugDumpResponseData {
@@ -422,23 +476,38 @@ DRAM_REGION_FUNCTION void sendDebugDumpResponse(uint16_t hostClientId,
   data.hostClientId = hostClientId;
   data.success = success;
   data.dataCount = dataCount;
-  buildAndEnqueueMessage(PendingMessageType::DebugDumpResponse, kInitialSize,
-                         msgBuilder, &data);
+  return buildAndEnqueueMessage(PendingMessageType::DebugDumpResponse,
+                                kInitialSize, msgBuilder, &data);
 }
 }  // anonymous namespace
 
-DRAM_REGION_FUNCTION void sendDebugDumpResultToHost(uint16_t hostClientId,
+DRAM_REGION_FUNCTION bool sendDebugDumpResultToHost(uint16_t hostClientId,
                                                     const char *debugStr,
                                                     size_t debugStrSize,
                                                     bool complete,
                                                     uint32_t dataCount) {
   LOGV("%s: host client id %d", __func__, hostClientId);
+  bool success = true;
   if (debugStrSize > 0) {
-    sendDebugDumpData(hostClientId, debugStr, debugStrSize);
+    success = sendDebugDumpData(hostClientId, debugStr, debugStrSize);
   }
   if (complete) {
-    sendDebugDumpResponse(hostClientId, /* success= */ true, dataCount);
+    success &= sendDebugDumpResponse(hostClientId, /* success= */ true,
+                                     dataCount);
   }
+  return success;
+}
+
+DRAM_REGION_FUNCTION bool sendStructuredDebugDumpToHost(uint16_t hostClientId) {
+  auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
+    HostProtocolChre::encodeStructuredDebugDump(
+        builder, *static_cast<const uint16_t *>(cookie));
+  };
+
+  // Room for the event loop and heap state, and a few nanoapps.
+  constexpr size_t kInitialSize = 512;
+  return buildAndEnqueueMessage(PendingMessageType::StructuredDebugDumpData,
+                                kInitialSize, msgBuilder, &hostClientId);
 }
 
 DRAM_REGION_FUNCTION HostLinkBase::HostLinkBase() {
@@ -667,6 +736,47 @@ DRAM_REGION_FUNCTION void HostLinkBase::sendLogMessageV2(
 #endif
 }
 
+DRAM_REGION_FUNCTION void HostLinkBase::sendLogMessageV3(
+    const uint8_t *logMessage, size_t logMessageSize, size_t uncompressedSize,
+    uint32_t numLogsDropped) {
+  LOGV("%s: size %zu (%zu uncompressed)", __func__, logMessageSize,
+       uncompressedSize);
+  struct LogMessageData {
+    const uint8_t *logMsg;
+    size_t logMsgSize;
+    size_t uncompressedSize;
+    uint32_t numLogsDropped;
+  };
+
+  LogMessageData logMessageData{logMessage, logMessageSize, uncompressedSize,
+                                numLogsDropped};
+
+  auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
+    const auto *data = static_cast<const LogMessageData *>(cookie);
+    HostProtocolChre::encodeLogMessagesV3(builder, data->logMsg,
+                                          data->logMsgSize,
+                                          data->uncompressedSize,
+                                          data->numLogsDropped);
+  };
+
+  constexpr size_t kInitialSize = 128;
+  bool result = false;
+  if (isInitialized()) {
+    result = buildAndEnqueueMessage(
+        PendingMessageType::EncodedLogMessage,
+        kInitialSize + logMessageSize + sizeof(uint32_t) * 2, msgBuilder,
+        &logMessageData);
+  }
+
+#ifdef CHRE_USE_BUFFERED_LOGGING
+  if (LogBufferManagerSingleton::isInitialized()) {
+    LogBufferManagerSingleton::get()->onLogsSentToHost(result);
+  }
+#else
+  UNUSED_VAR(result);
+#endif
+}
+
 DRAM_REGION_FUNCTION bool HostLink::sendMessage(HostMessage const *message) {
   LOGV("HostLink::%s size(%zu)", __func__, message->message.size());
   bool success = false;
@@ -680,6 +790,45 @@ DRAM_REGION_FUNCTION bool HostLink::sendMessage(HostMessage const *message) {
   return success;
 }
 
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+DRAM_REGION_FUNCTION bool HostLink::sendMessageBatch(
+    const HostMessage *const *messages, size_t numMessages) {
+  LOGV("HostLink::%s count(%zu)", __func__, numMessages);
+  if (!isInitialized()) {
+    LOGW("Dropping outbound message batch: host link not initialized yet");
+    return false;
+  }
+
+  struct BatchData {
+    const HostMessage *const *messages;
+    size_t numMessages;
+  };
+  auto msgBuilder = [](ChreFlatBufferBuilder &builder, void *cookie) {
+    auto *data = static_cast<const BatchData *>(cookie);
+    HostProtocolChre::encodeNanoappMessageBatch(builder, data->messages,
+                                                data->numMessages);
+  };
+
+  // The batch is encoded right away, so the messages are complete once queued
+  constexpr size_t kFixedReserveSizePerMessage = 88;
+  size_t initialBufferSize = 0;
+  for (size_t i = 0; i < numMessages; i++) {
+    initialBufferSize +=
+        messages[i]->message.size() + kFixedReserveSizePerMessage;
+  }
+  BatchData batchData = {messages, numMessages};
+  bool success =
+      buildAndEnqueueMessage(PendingMessageType::NanoappMessageBatch,
+                             initialBufferSize, msgBuilder, &batchData);
+  if (success) {
+    for (size_t i = 0; i < numMessages; i++) {
+      getHostCommsManager().onMessageToHostComplete(messages[i]);
+    }
+  }
+  return success;
+}
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
 bool HostLink::sendMessageDeliveryStatus(uint32_t /* messageSequenceNumber */,
                                          uint8_t /* errorCode */) {
   return false;
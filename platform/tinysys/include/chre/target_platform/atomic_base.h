@@ -114,6 +114,20 @@ class AtomicUint32Base : public AtomicBase<uint32_t> {
   uint32_t sub(uint32_t arg) {
     return atomic_add(&mValue, ~arg + 1);
   }
+
+  /**
+   * Atomically replace the stored 32-bit word if it holds the expected value.
+   *
+   * @param expected The value the word is expected to hold. Updated with the
+   *        current value if the swap fails.
+   * @param desired Value to be assigned if the comparison succeeds.
+   * @return true if the stored word was replaced.
+   */
+  bool compareAndSwap(uint32_t &expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(&mValue, &expected, desired,
+                                       false /* weak */, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST);
+  }
 };
 
 }  // namespace chre
@@ -29,11 +29,21 @@ namespace chre {
 
 /**
  * Helper function to send debug dump result to host.
+ *
+ * @return true if the messages were enqueued to be sent to the host.
  */
-void sendDebugDumpResultToHost(uint16_t hostClientId, const char *debugStr,
+bool sendDebugDumpResultToHost(uint16_t hostClientId, const char *debugStr,
                                size_t debugStrSize, bool complete,
                                uint32_t dataCount);
 
+/**
+ * Helper function to send the state of the framework to the host as a
+ * StructuredDebugDumpData message.
+ *
+ * @return true if the message was enqueued.
+ */
+bool sendStructuredDebugDumpToHost(uint16_t hostClientId);
+
 /**
  * @brief Platform specific host link.
  */
@@ -105,6 +115,18 @@ class HostLinkBase {
                         size_t /*logMessageSize*/,
                         uint32_t /*num_logs_dropped*/);
 
+  /**
+   * Enqueues a V3 log message to be sent to the host.
+   *
+   * @param logMessage Pointer to a buffer that has V2 log messages compressed
+   * in the LZ4 block format
+   * @param logMessageSize length of the compressed log message buffer
+   * @param uncompressedSize length of the log message buffer once decompressed
+   * @param numLogsDropped the number of logs dropped since CHRE started
+   */
+  void sendLogMessageV3(const uint8_t *logMessage, size_t logMessageSize,
+                        size_t uncompressedSize, uint32_t numLogsDropped);
+
   /**
    * Enqueues a NAN configuration request to be sent to the host.
    *
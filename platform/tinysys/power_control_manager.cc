@@ -32,6 +32,8 @@ void PowerControlManagerBase::onHostWakeSuspendEvent(bool awake) {
       EventLoopManagerSingleton::get()
           ->getHostCommsManager()
           .resetBlameForNanoappHostWakeup();
+    } else {
+      EventLoopManagerSingleton::get()->getHostCommsManager().onHostAwake();
     }
 #ifdef CHRE_USE_BUFFERED_LOGGING
     if (awake) {
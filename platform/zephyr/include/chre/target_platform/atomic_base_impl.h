@@ -79,6 +79,15 @@ inline uint32_t AtomicUint32::fetch_decrement() {
   return atomic_dec(&value);
 }
 
+inline bool AtomicUint32::compare_exchange(uint32_t &expected,
+                                           uint32_t desired) {
+  if (atomic_cas(&value, expected, desired)) {
+    return true;
+  }
+  expected = atomic_get(&value);
+  return false;
+}
+
 }  // namespace chre
 
 #endif  // CHRE_PLATFORM_ZEPHYR_ATOMIC_BASE_IMPL_H_
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Quit if any command produces an error.
+set -e
+
+BUILD_ONLY="false"
+while getopts "b" opt; do
+  case ${opt} in
+    b)
+      BUILD_ONLY="true"
+      ;;
+  esac
+done
+
+# Build and run the CHRE microbenchmark binary.
+JOB_COUNT=$((`grep -c ^processor /proc/cpuinfo`))
+OUT_DIR=./out/google_x86_benchmark
+
+# Export the variant Makefile.
+export CHRE_VARIANT_MK_INCLUDES="$CHRE_VARIANT_MK_INCLUDES \
+  variant/benchmark/variant.mk"
+
+make clean
+make google_x86_benchmark -j$JOB_COUNT
+
+if [ "$BUILD_ONLY" = "false" ]; then
+$OUT_DIR/libchre --benchmark_out=$OUT_DIR/benchmark_results.json \
+  --benchmark_out_format=json ${@:1}
+else
+    if [ ! -f $OUT_DIR/libchre ]; then
+        echo  "$OUT_DIR/libchre does not exist."
+        exit 1
+    fi
+fi
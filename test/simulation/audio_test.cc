@@ -17,7 +17,9 @@
 #include "chre_api/chre/audio.h"
 
 #include <cstdint>
+#include <utility>
 
+#include "chre/core/event.h"
 #include "chre/core/event_loop_manager.h"
 #include "chre/core/settings.h"
 #include "chre/platform/linux/pal_audio.h"
@@ -25,6 +27,7 @@
 #include "chre/util/system/napp_permissions.h"
 #include "chre_api/chre/event.h"
 #include "chre_api/chre/user_settings.h"
+#include "chre_ext/audio_features.h"
 
 #include "gtest/gtest.h"
 #include "inc/test_util.h"
@@ -168,5 +171,217 @@ TEST_F(TestBase, AudioUnsubscribeToDataEventsOnUnload) {
   EXPECT_FALSE(chrePalAudioIsHandle0Enabled());
 }
 
+CREATE_CHRE_TEST_EVENT(AUDIO_DATA_RECEIVED, 0);
+
+//! What a nanoapp saw of the audio data events it received.
+struct AudioDataSummary {
+  uint32_t sampleCount;
+  bool samplesMatch;
+  //! Whether the events were the ones sent by the PAL.
+  bool fromPlatform;
+};
+
+//! The number of audio data events received by each WindowNanoapp.
+uint32_t gNumAudioDataEvents[chre::kMaxMulticastTargets + 1];
+
+//! Requests audio from handle 0 and checks that each audio data event holds
+//! the samples the Linux PAL generated for its timestamp.
+class WindowNanoapp : public TestNanoapp {
+ public:
+  WindowNanoapp(uint32_t index, uint64_t bufferDuration,
+                uint64_t deliveryInterval)
+      : TestNanoapp(
+            TestNanoappInfo{.name = "Window",
+                            .id = 0x1234 + index,
+                            .perms = NanoappPermissions::CHRE_PERMS_AUDIO}),
+        mIndex(index),
+        mBufferDuration(bufferDuration),
+        mDeliveryInterval(deliveryInterval) {}
+
+  bool start() override {
+    gNumAudioDataEvents[mIndex] = 0;
+    return chreAudioConfigureSource(0 /*handle*/, true /*enable*/,
+                                    mBufferDuration, mDeliveryInterval);
+  }
+
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    if (eventType == CHRE_EVENT_AUDIO_DATA) {
+      auto event = static_cast<const struct chreAudioDataEvent *>(eventData);
+      uint64_t firstSample =
+          event->timestamp * event->sampleRate / kOneSecondInNanoseconds;
+      for (uint32_t i = 0; i < event->sampleCount; i++) {
+        if (event->samplesULaw8[i] != static_cast<uint8_t>(firstSample + i)) {
+          mSamplesMatch = false;
+        }
+      }
+      if (event != chrePalAudioGetHandle0LastEvent()) {
+        mFromPlatform = false;
+      }
+
+      gNumAudioDataEvents[mIndex]++;
+      if (gNumAudioDataEvents[mIndex] == kNumEvents) {
+        TestEventQueueSingleton::get()->pushEvent(
+            AUDIO_DATA_RECEIVED, AudioDataSummary{
+                                     .sampleCount = event->sampleCount,
+                                     .samplesMatch = mSamplesMatch,
+                                     .fromPlatform = mFromPlatform,
+                                 });
+      }
+    }
+  }
+
+  static constexpr uint32_t kNumEvents = 3;
+
+ private:
+  const uint32_t mIndex;
+  const uint64_t mBufferDuration;
+  const uint64_t mDeliveryInterval;
+  bool mSamplesMatch = true;
+  bool mFromPlatform = true;
+};
+
+TEST_F(TestBase, AudioEventsOfASingleNanoappAreNotCopied) {
+  constexpr uint64_t kInterval = 50 * kOneMillisecondInNanoseconds;
+  uint64_t appId =
+      loadNanoapp(MakeUnique<WindowNanoapp>(0, kInterval, kInterval));
+
+  AudioDataSummary summary;
+  waitForEvent(AUDIO_DATA_RECEIVED, &summary);
+  EXPECT_EQ(summary.sampleCount, 800u);
+  EXPECT_TRUE(summary.samplesMatch);
+  EXPECT_TRUE(summary.fromPlatform);
+
+  unloadNanoapp(appId);
+  EXPECT_FALSE(chrePalAudioIsHandle0Enabled());
+}
+
+TEST_F(TestBase, AudioEventsOfTooManyNanoappsForAMulticastAreWindows) {
+  constexpr uint64_t kInterval = 50 * kOneMillisecondInNanoseconds;
+  constexpr uint32_t kNumNanoapps = kMaxMulticastTargets + 1;
+  uint64_t appIds[kNumNanoapps];
+  for (uint32_t i = 0; i < kNumNanoapps; i++) {
+    appIds[i] = loadNanoapp(MakeUnique<WindowNanoapp>(i, kInterval, kInterval));
+  }
+
+  for (uint32_t i = 0; i < kNumNanoapps; i++) {
+    AudioDataSummary summary;
+    waitForEvent(AUDIO_DATA_RECEIVED, &summary);
+    EXPECT_EQ(summary.sampleCount, 800u);
+    EXPECT_TRUE(summary.samplesMatch);
+    EXPECT_FALSE(summary.fromPlatform);
+  }
+
+  for (uint64_t appId : appIds) {
+    unloadNanoapp(appId);
+  }
+  EXPECT_FALSE(chrePalAudioIsHandle0Enabled());
+}
+
+TEST_F(TestBase, AudioWindowsOfNanoappsShareCaptures) {
+  constexpr uint64_t kFastInterval = 50 * kOneMillisecondInNanoseconds;
+  constexpr uint64_t kSlowInterval = 2 * kFastInterval;
+  uint32_t platformEventCount = chrePalAudioGetHandle0EventCount();
+
+  uint64_t fastAppId = loadNanoapp(
+      MakeUnique<WindowNanoapp>(0, kFastInterval, kFastInterval));
+  uint64_t slowAppId = loadNanoapp(
+      MakeUnique<WindowNanoapp>(1, kSlowInterval, kSlowInterval));
+
+  // Each nanoapp gets windows of its own size, in either order
+  AudioDataSummary summaries[2];
+  waitForEvent(AUDIO_DATA_RECEIVED, &summaries[0]);
+  waitForEvent(AUDIO_DATA_RECEIVED, &summaries[1]);
+  if (summaries[0].sampleCount > summaries[1].sampleCount) {
+    std::swap(summaries[0], summaries[1]);
+  }
+  EXPECT_EQ(summaries[0].sampleCount, 800u);
+  EXPECT_TRUE(summaries[0].samplesMatch);
+  EXPECT_EQ(summaries[1].sampleCount, 1600u);
+  EXPECT_TRUE(summaries[1].samplesMatch);
+  EXPECT_FALSE(summaries[1].fromPlatform);
+
+  unloadNanoapp(slowAppId);
+  unloadNanoapp(fastAppId);
+  EXPECT_FALSE(chrePalAudioIsHandle0Enabled());
+
+  // The slow nanoapp is served by the events of the fast one, once aligned
+  // with it.
+  platformEventCount = chrePalAudioGetHandle0EventCount() - platformEventCount;
+  EXPECT_GE(gNumAudioDataEvents[1], WindowNanoapp::kNumEvents);
+  EXPECT_LE(platformEventCount, gNumAudioDataEvents[0] + 2);
+}
+
+CREATE_CHRE_TEST_EVENT(AUDIO_FEATURES_RECEIVED, 1);
+
+//! What a nanoapp saw of the audio feature events it received.
+struct AudioFeatureSummary {
+  uint32_t frameSize;
+  uint16_t numBins;
+  bool framesInOrder;
+};
+
+//! Requests audio features from handle 0 and checks that each event starts
+//! after the frames of the previous one.
+class FeatureNanoapp : public TestNanoapp {
+ public:
+  FeatureNanoapp()
+      : TestNanoapp(
+            TestNanoappInfo{.perms = NanoappPermissions::CHRE_PERMS_AUDIO}) {}
+
+  bool start() override {
+    return chreextAudioConfigureFeatures(
+        0 /*handle*/, true /*enable*/, 50 * kOneMillisecondInNanoseconds,
+        kFrameSize, kFrameSize / 2 /*hopSize*/, kNumBins);
+  }
+
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    if (eventType == CHREEXT_EVENT_AUDIO_FEATURES) {
+      auto event =
+          static_cast<const struct chreextAudioFeatureEvent *>(eventData);
+      if (event->numFrames == 0 || event->timestamp < mNextFrameTimestamp) {
+        mFramesInOrder = false;
+      }
+      mNextFrameTimestamp = event->timestamp +
+                            uint64_t{event->numFrames} * event->hopSize *
+                                kOneSecondInNanoseconds / event->sampleRate;
+
+      mNumEvents++;
+      if (mNumEvents == kNumEvents) {
+        TestEventQueueSingleton::get()->pushEvent(
+            AUDIO_FEATURES_RECEIVED,
+            AudioFeatureSummary{
+                .frameSize = event->frameSize,
+                .numBins = event->numBins,
+                .framesInOrder = mFramesInOrder,
+            });
+      }
+    }
+  }
+
+  static constexpr uint32_t kFrameSize = 256;
+  static constexpr uint16_t kNumBins = 32;
+  static constexpr uint32_t kNumEvents = 3;
+
+ private:
+  uint32_t mNumEvents = 0;
+  uint64_t mNextFrameTimestamp = 0;
+  bool mFramesInOrder = true;
+};
+
+TEST_F(TestBase, AudioFeaturesAreDeliveredToSubscribers) {
+  uint64_t appId = loadNanoapp(MakeUnique<FeatureNanoapp>());
+
+  AudioFeatureSummary summary;
+  waitForEvent(AUDIO_FEATURES_RECEIVED, &summary);
+  EXPECT_EQ(summary.frameSize, FeatureNanoapp::kFrameSize);
+  EXPECT_EQ(summary.numBins, FeatureNanoapp::kNumBins);
+  EXPECT_TRUE(summary.framesInOrder);
+
+  unloadNanoapp(appId);
+  EXPECT_FALSE(chrePalAudioIsHandle0Enabled());
+}
+
 }  // namespace
 }  // namespace chre
\ No newline at end of file
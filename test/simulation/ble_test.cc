@@ -19,12 +19,15 @@
 #include "test_base.h"
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/core/settings.h"
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/linux/pal_ble.h"
+#include "chre/platform/system_time.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre_api/chre/ble.h"
 #include "chre_api/chre/user_settings.h"
@@ -93,6 +96,10 @@ class BleTestNanoapp : public TestNanoapp {
       : TestNanoapp(
             TestNanoappInfo{.perms = NanoappPermissions::CHRE_PERMS_BLE}) {}
 
+  explicit BleTestNanoapp(uint64_t id)
+      : TestNanoapp(TestNanoappInfo{
+            .id = id, .perms = NanoappPermissions::CHRE_PERMS_BLE}) {}
+
   bool start() override {
     chreUserSettingConfigureEvents(CHRE_USER_SETTING_BLE_AVAILABLE,
                                    true /* enable */);
@@ -862,5 +869,192 @@ TEST_F(TestBase, BleFlush) {
   ASSERT_FALSE(success);
 }
 
+/**
+ * Builds a report holding the service data of a 16-bit UUID, in the same
+ * memory layout as the simulated BLE PAL so that it releases it.
+ */
+void populateServiceDataReport(chreBleAdvertisingReport &report,
+                               uint16_t uuid) {
+  auto *data = static_cast<uint8_t *>(memoryAlloc(7));
+  ASSERT_NE(data, nullptr);
+  data[0] = 0x06;
+  data[1] = CHRE_BLE_AD_TYPE_SERVICE_DATA_WITH_UUID_16_LE;
+  data[2] = uuid & 0xff;
+  data[3] = uuid >> 8;
+  data[4] = 0x01;
+  data[5] = 0x02;
+  data[6] = 0x03;
+  report.timestamp = SystemTime::getMonotonicTime().toRawNanoseconds();
+  report.rssi = -60;
+  report.data = data;
+  report.dataLength = 7;
+}
+
+/**
+ * This test simulates several nanoapps scanning for the service data of
+ * different UUIDs, as Nearby and vendor nanoapps do, and verifies that each of
+ * them only receives the reports matching its own filters rather than those
+ * matching the filters of any of them.
+ */
+TEST_F(TestBase, BleAdvertisementsAreDeliveredPerNanoapp) {
+  CREATE_CHRE_TEST_EVENT(START_SCAN, 0);
+  CREATE_CHRE_TEST_EVENT(SCAN_STARTED, 1);
+  CREATE_CHRE_TEST_EVENT(GET_STATS, 2);
+  CREATE_CHRE_TEST_EVENT(ADVERTISEMENTS_POSTED, 3);
+
+  struct Stats {
+    uint32_t numEvents;
+    uint32_t numReports;
+    uint32_t numMatchingReports;
+  };
+
+  class App : public BleTestNanoapp {
+   public:
+    App(uint64_t id, uint16_t uuid) : BleTestNanoapp(id), mUuid(uuid) {}
+
+    void handleEvent(uint32_t, uint16_t eventType,
+                     const void *eventData) override {
+      switch (eventType) {
+        case CHRE_EVENT_BLE_ASYNC_RESULT: {
+          auto *event = static_cast<const struct chreAsyncResult *>(eventData);
+          if (event->errorCode == CHRE_ERROR_NONE &&
+              event->requestType == CHRE_BLE_REQUEST_TYPE_START_SCAN) {
+            TestEventQueueSingleton::get()->pushEvent(SCAN_STARTED);
+          }
+          break;
+        }
+
+        case CHRE_EVENT_BLE_ADVERTISEMENT: {
+          auto *event =
+              static_cast<const struct chreBleAdvertisementEvent *>(eventData);
+          mStats.numEvents++;
+          for (uint16_t i = 0; i < event->numReports; i++) {
+            mStats.numReports++;
+            if (hasServiceData(event->reports[i])) {
+              mStats.numMatchingReports++;
+            }
+          }
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case START_SCAN: {
+              chreBleGenericFilter genericFilter = {};
+              genericFilter.type =
+                  CHRE_BLE_AD_TYPE_SERVICE_DATA_WITH_UUID_16_LE;
+              genericFilter.len = 2;
+              genericFilter.data[0] = mUuid & 0xff;
+              genericFilter.data[1] = mUuid >> 8;
+              genericFilter.dataMask[0] = 0xff;
+              genericFilter.dataMask[1] = 0xff;
+              chreBleScanFilterV1_9 filter = {};
+              filter.rssiThreshold = CHRE_BLE_RSSI_THRESHOLD_NONE;
+              filter.genericFilterCount = 1;
+              filter.genericFilters = &genericFilter;
+              const bool success = chreBleStartScanAsyncV1_9(
+                  CHRE_BLE_SCAN_MODE_AGGRESSIVE, 0, &filter, nullptr);
+              TestEventQueueSingleton::get()->pushEvent(START_SCAN, success);
+              break;
+            }
+
+            case GET_STATS: {
+              TestEventQueueSingleton::get()->pushEvent(GET_STATS, mStats);
+              break;
+            }
+          }
+          break;
+        }
+      }
+    }
+
+   private:
+    //! The check a nanoapp does on each report it receives.
+    bool hasServiceData(const chreBleAdvertisingReport &report) const {
+      for (size_t i = 0; i + 3 < report.dataLength;
+           i += report.data[i] + 1) {
+        if (report.data[i] >= 3 &&
+            report.data[i + 1] ==
+                CHRE_BLE_AD_TYPE_SERVICE_DATA_WITH_UUID_16_LE &&
+            report.data[i + 2] == (mUuid & 0xff) &&
+            report.data[i + 3] == (mUuid >> 8)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    const uint16_t mUuid;
+    Stats mStats = {};
+  };
+
+  constexpr uint16_t kUuids[] = {0xfe2c, 0xfcb1, 0xfd5a};
+  constexpr size_t kNumApps = sizeof(kUuids) / sizeof(kUuids[0]);
+  // Every fourth report is from a device none of the nanoapps scans for.
+  constexpr uint16_t kOtherUuid = 0xfeaa;
+  constexpr size_t kNumPlatformEvents = 32;
+  constexpr size_t kNumPlatformEventsPerRound = 8;
+  constexpr uint16_t kNumReportsPerEvent = 16;
+
+  uint64_t appIds[kNumApps];
+  for (size_t i = 0; i < kNumApps; i++) {
+    appIds[i] = loadNanoapp(MakeUnique<App>(0x0123456789000001 + i, kUuids[i]));
+    bool success;
+    sendEventToNanoapp(appIds[i], START_SCAN);
+    waitForEvent(START_SCAN, &success);
+    ASSERT_TRUE(success);
+    waitForEvent(SCAN_STARTED);
+  }
+  ASSERT_TRUE(chrePalIsBleEnabled());
+
+  for (size_t i = 0; i < kNumPlatformEvents; i += kNumPlatformEventsPerRound) {
+    // Post the platform events in rounds, as the PAL would, to stay within the
+    // capacity of the event queue.
+    for (size_t j = 0; j < kNumPlatformEventsPerRound; j++) {
+      auto *event = static_cast<chreBleAdvertisementEvent *>(
+          memoryAlloc(sizeof(chreBleAdvertisementEvent)));
+      auto *reports = static_cast<chreBleAdvertisingReport *>(
+          memoryAlloc(kNumReportsPerEvent * sizeof(chreBleAdvertisingReport)));
+      ASSERT_NE(event, nullptr);
+      ASSERT_NE(reports, nullptr);
+      memset(event, 0, sizeof(chreBleAdvertisementEvent));
+      memset(reports, 0,
+             kNumReportsPerEvent * sizeof(chreBleAdvertisingReport));
+      for (uint16_t k = 0; k < kNumReportsPerEvent; k++) {
+        populateServiceDataReport(
+            reports[k], (k % 4 < kNumApps) ? kUuids[k % 4] : kOtherUuid);
+      }
+      event->numReports = kNumReportsPerEvent;
+      event->reports = reports;
+      EventLoopManagerSingleton::get()
+          ->getBleRequestManager()
+          .handleAdvertisementEvent(event);
+    }
+
+    // Once this callback runs, the advertisement events of the round have all
+    // been posted to the nanoapps, ahead of any event posted afterwards.
+    EventLoopManagerSingleton::get()->deferCallback(
+        SystemCallbackType::BleAdvertisementEvent, nullptr,
+        [](uint16_t /*type*/, void * /*data*/, void * /*extraData*/) {
+          TestEventQueueSingleton::get()->pushEvent(ADVERTISEMENTS_POSTED);
+        });
+    waitForEvent(ADVERTISEMENTS_POSTED);
+  }
+
+  for (size_t i = 0; i < kNumApps; i++) {
+    Stats stats;
+    sendEventToNanoapp(appIds[i], GET_STATS);
+    waitForEvent(GET_STATS, &stats);
+    EXPECT_EQ(stats.numEvents, kNumPlatformEvents);
+    EXPECT_EQ(stats.numReports, kNumPlatformEvents * kNumReportsPerEvent / 4);
+    EXPECT_EQ(stats.numMatchingReports, stats.numReports);
+  }
+
+  for (uint64_t appId : appIds) {
+    unloadNanoapp(appId);
+  }
+}
+
 }  // namespace
 }  // namespace chre
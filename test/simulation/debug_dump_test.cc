@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/memory_manager.h"
+#include "chre/platform/system_time.h"
+#include "chre/util/system/debug_dump.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/re.h"
+#include "chre_host/generated/host_messages_generated.h"
+#include "chre_host/host_protocol_host.h"
+
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+using ::android::chre::HostProtocolHost;
+
+//! The debug dumps of the same framework state, as text and as structured
+//! data.
+struct DebugDumps {
+  std::string text;
+  fbs::StructuredDebugDumpDataT data;
+};
+
+std::vector<int8_t> toByteVector(const char *str) {
+  return std::vector<int8_t>(str, str + strlen(str) + 1);
+}
+
+//! Collects the text the hub prints in place of the structured debug dump.
+void collectTextDebugDump(std::string &text) {
+  DebugDumpWrapper debugDump(1024 /*bufferSize*/);
+  EventLoopManagerSingleton::get()->getMemoryManager().logStateToBuffer(
+      debugDump);
+  EventLoopManagerSingleton::get()->getEventLoop().logStateToBuffer(debugDump);
+  for (const UniquePtr<char> &buffer : debugDump.getBuffers()) {
+    text += buffer.get();
+  }
+}
+
+//! Collects the fields HostProtocolChre::encodeStructuredDebugDump() sends.
+void collectStructuredDebugDump(fbs::StructuredDebugDumpDataT &data) {
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  const MemoryManager &memoryManager =
+      EventLoopManagerSingleton::get()->getMemoryManager();
+  Nanoseconds timeSinceWakeupBucketCycled =
+      SystemTime::getMonotonicTime() -
+      eventLoop.getTimeLastWakeupBucketCycled();
+
+  data.max_event_pool_usage = eventLoop.getMaxEventQueueSize();
+  data.event_pool_size = EventLoop::getEventPoolSize();
+  data.num_dropped_low_priority_events = eventLoop.getNumEventsDropped();
+  data.wakeup_bucket_cycled_mins_ago =
+      timeSinceWakeupBucketCycled.toRawNanoseconds() / kOneMinuteInNanoseconds;
+  data.wakeup_bucket_duration_mins =
+      EventLoop::getWakeupBucketInterval().toRawNanoseconds() /
+      kOneMinuteInNanoseconds;
+  data.nanoapp_heap_allocated_bytes = memoryManager.getTotalAllocatedBytes();
+  data.nanoapp_heap_peak_allocated_bytes =
+      memoryManager.getPeakAllocatedBytes();
+  data.nanoapp_heap_allocation_count = memoryManager.getAllocationCount();
+
+  eventLoop.forEachNanoapp(
+      [](const Nanoapp *nanoapp, void *cookie) {
+        auto entry = std::make_unique<fbs::DebugDumpNanoappT>();
+        entry->app_id = nanoapp->getAppId();
+        entry->instance_id = nanoapp->getInstanceId();
+        entry->version = nanoapp->getAppVersion();
+        entry->target_api_version = nanoapp->getTargetApiVersion();
+        entry->name = toByteVector(nanoapp->getAppName());
+        entry->vendor = toByteVector(nanoapp->getAppVendor());
+        entry->build = toByteVector(nanoapp->getAppBuildId());
+        entry->is_system = nanoapp->isSystemNanoapp();
+        entry->allocated_bytes = nanoapp->getTotalAllocatedBytes();
+        entry->peak_allocated_bytes = nanoapp->getPeakAllocatedBytes();
+        entry->max_event_time_ms = nanoapp->getMaxEventProcessTime();
+        entry->total_event_time_ms = nanoapp->getEventProcessTimeSinceBoot();
+        entry->num_wakeups = nanoapp->getNumWakeupsSinceBoot();
+        entry->num_messages_sent = nanoapp->getNumMessagesSentSinceBoot();
+        auto *data = static_cast<fbs::StructuredDebugDumpDataT *>(cookie);
+        data->nanoapps.push_back(std::move(entry));
+      },
+      &data);
+}
+
+TEST_F(TestBase, StructuredDebugDumpRendersAsTheTextDebugDump) {
+  CREATE_CHRE_TEST_EVENT(ALLOCATE, 0);
+  CREATE_CHRE_TEST_EVENT(COLLECT_DEBUG_DUMPS, 1);
+
+  class App : public TestNanoapp {
+   public:
+    void handleEvent(uint32_t, uint16_t eventType,
+                     const void *eventData) override {
+      switch (eventType) {
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case ALLOCATE: {
+              auto bytes = static_cast<const uint32_t *>(event->data);
+              void *ptr = chreHeapAlloc(*bytes);
+              TestEventQueueSingleton::get()->pushEvent(ALLOCATE, ptr);
+              break;
+            }
+            case COLLECT_DEBUG_DUMPS: {
+              auto dumps = *static_cast<DebugDumps *const *>(event->data);
+              collectTextDebugDump(dumps->text);
+              collectStructuredDebugDump(dumps->data);
+              TestEventQueueSingleton::get()->pushEvent(COLLECT_DEBUG_DUMPS);
+              break;
+            }
+          }
+        }
+      }
+    }
+  };
+
+  uint64_t appId = loadNanoapp(MakeUnique<App>());
+
+  void *ptr;
+  sendEventToNanoapp(appId, ALLOCATE, 100);
+  waitForEvent(ALLOCATE, &ptr);
+  ASSERT_NE(ptr, nullptr);
+
+  DebugDumps dumps;
+  sendEventToNanoapp(appId, COLLECT_DEBUG_DUMPS, &dumps);
+  waitForEvent(COLLECT_DEBUG_DUMPS);
+  ASSERT_EQ(dumps.data.nanoapps.size(), 1);
+
+  // The host only renders the totals of the wakeup and message histograms, so
+  // the text is compared up to them.
+  std::string text = dumps.text;
+  size_t histogramPos = text.find("\nHistogram stat buckets");
+  ASSERT_NE(histogramPos, std::string::npos);
+  text.resize(histogramPos);
+
+  std::string rendered =
+      HostProtocolHost::formatStructuredDebugDump(dumps.data);
+  size_t totalsPos = rendered.find("| Total w/u");
+  ASSERT_NE(totalsPos, std::string::npos);
+  rendered.resize(rendered.rfind('\n', totalsPos));
+
+  EXPECT_EQ(rendered, text);
+}
+
+}  // namespace
+}  // namespace chre
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/core/host_comms_manager.h"
+#include "chre/platform/host_link.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/event.h"
+#include "chre_api/chre/re.h"
+#include "gtest/gtest.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+constexpr uint32_t kMessageType = 1234;
+constexpr uint16_t kHostEndpointId = 123;
+constexpr size_t kMessageSize = 4096;
+
+CREATE_CHRE_TEST_EVENT(SEND_MESSAGE, 0);
+CREATE_CHRE_TEST_EVENT(MESSAGE_RELEASED, 1);
+CREATE_CHRE_TEST_EVENT(SEND_SMALL_MESSAGES, 2);
+CREATE_CHRE_TEST_EVENT(WAIT, 3);
+
+//! What the nanoapp saw of a message from the host.
+struct ReceivedMessage {
+  const void *data;
+  uint32_t messageSize;
+  uint32_t messageType;
+  uint16_t hostEndpoint;
+  bool contentMatches;
+  bool released;
+};
+
+//! The buffer the messages are received in, or sent from by the nanoapp.
+uint8_t gMessageBuffer[kMessageSize];
+
+//! Whether gMessageBuffer was released.
+bool gMessageBufferReleased;
+
+void fillMessageBuffer() {
+  for (size_t i = 0; i < kMessageSize; i++) {
+    gMessageBuffer[i] = static_cast<uint8_t>(i * 7);
+  }
+  gMessageBufferReleased = false;
+}
+
+bool messageBufferMatches(const void *data) {
+  for (size_t i = 0; i < kMessageSize; i++) {
+    if (static_cast<const uint8_t *>(data)[i] != static_cast<uint8_t>(i * 7)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Reports the messages from the host it receives and, on request, sends
+//! gMessageBuffer to the host or reports when a timer expires.
+class MessageNanoapp : public TestNanoapp {
+ public:
+  void handleEvent(uint32_t, uint16_t eventType,
+                   const void *eventData) override {
+    switch (eventType) {
+      case CHRE_EVENT_MESSAGE_FROM_HOST: {
+        auto message = static_cast<const chreMessageFromHostData *>(eventData);
+        ReceivedMessage received = {
+            .data = message->message,
+            .messageSize = message->messageSize,
+            .messageType = message->messageType,
+            .hostEndpoint = message->hostEndpoint,
+            .contentMatches = message->messageSize == kMessageSize &&
+                              messageBufferMatches(message->message),
+            .released = gMessageBufferReleased,
+        };
+        TestEventQueueSingleton::get()->pushEvent(
+            CHRE_EVENT_MESSAGE_FROM_HOST, received);
+        break;
+      }
+
+      case CHRE_EVENT_TEST_EVENT: {
+        auto event = static_cast<const TestEvent *>(eventData);
+        if (event->type == SEND_MESSAGE) {
+          bool success = chreSendMessageToHostEndpoint(
+              gMessageBuffer, kMessageSize, kMessageType,
+              CHRE_HOST_ENDPOINT_BROADCAST,
+              [](void *message, size_t /*messageSize*/) {
+                EXPECT_EQ(message, gMessageBuffer);
+                gMessageBufferReleased = true;
+                TestEventQueueSingleton::get()->pushEvent(MESSAGE_RELEASED);
+              });
+          TestEventQueueSingleton::get()->pushEvent(SEND_MESSAGE, success);
+        } else if (event->type == SEND_SMALL_MESSAGES) {
+          // Small messages in a row, with their index as message type
+          static uint8_t smallMessage[16];
+          auto numMessages = *static_cast<uint32_t *>(event->data);
+          bool success = true;
+          for (uint32_t i = 0; i < numMessages; i++) {
+            success &= chreSendMessageToHostEndpoint(
+                smallMessage, sizeof(smallMessage), i,
+                CHRE_HOST_ENDPOINT_BROADCAST, /* freeCallback= */ nullptr);
+          }
+          TestEventQueueSingleton::get()->pushEvent(SEND_SMALL_MESSAGES,
+                                                    success);
+        } else if (event->type == WAIT) {
+          auto duration = *static_cast<uint64_t *>(event->data);
+          chreTimerSet(duration, /* cookie= */ nullptr, /* oneShot= */ true);
+        }
+        break;
+      }
+
+      case CHRE_EVENT_TIMER: {
+        TestEventQueueSingleton::get()->pushEvent(WAIT);
+        break;
+      }
+    }
+  }
+};
+
+TEST_F(TestBase, RetainedMessageFromHostIsNotCopied) {
+  uint64_t appId = loadNanoapp(MakeUnique<MessageNanoapp>());
+  fillMessageBuffer();
+
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .sendMessageToNanoappFromHost(
+          appId, kMessageType, kHostEndpointId, gMessageBuffer, kMessageSize,
+          /* isReliable= */ false, /* messageSequenceNumber= */ 0,
+          [](void *releaseData) {
+            EXPECT_EQ(releaseData, gMessageBuffer);
+            gMessageBufferReleased = true;
+            TestEventQueueSingleton::get()->pushEvent(
+                MESSAGE_RELEASED);
+          },
+          gMessageBuffer);
+
+  ReceivedMessage received;
+  waitForEvent(CHRE_EVENT_MESSAGE_FROM_HOST, &received);
+  EXPECT_EQ(received.data, gMessageBuffer);
+  EXPECT_TRUE(received.contentMatches);
+  EXPECT_EQ(received.messageType, kMessageType);
+  EXPECT_EQ(received.hostEndpoint, kHostEndpointId);
+  EXPECT_FALSE(received.released);
+  waitForEvent(MESSAGE_RELEASED);
+}
+
+TEST_F(TestBase, RetainedMessageFromHostIsReleasedIfNotDelivered) {
+  fillMessageBuffer();
+
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .sendMessageToNanoappFromHost(
+          /* appId= */ 0x1234, kMessageType, kHostEndpointId, gMessageBuffer,
+          kMessageSize, /* isReliable= */ false,
+          /* messageSequenceNumber= */ 0,
+          [](void * /*releaseData*/) {
+            gMessageBufferReleased = true;
+            TestEventQueueSingleton::get()->pushEvent(
+                MESSAGE_RELEASED);
+          },
+          nullptr);
+
+  waitForEvent(MESSAGE_RELEASED);
+}
+
+TEST_F(TestBase, LoopbackMessageIsDeliveredWithoutCopy) {
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .setMessageLoopbackEnabled(true);
+  uint64_t appId = loadNanoapp(MakeUnique<MessageNanoapp>());
+  fillMessageBuffer();
+
+  sendEventToNanoapp(appId, SEND_MESSAGE);
+  bool success;
+  waitForEvent(SEND_MESSAGE, &success);
+  EXPECT_TRUE(success);
+
+  // The nanoapp receives its own buffer back, which is only freed once it was
+  // handled
+  ReceivedMessage received;
+  waitForEvent(CHRE_EVENT_MESSAGE_FROM_HOST, &received);
+  EXPECT_EQ(received.data, gMessageBuffer);
+  EXPECT_TRUE(received.contentMatches);
+  EXPECT_EQ(received.messageType, kMessageType);
+  EXPECT_EQ(received.hostEndpoint, CHRE_HOST_ENDPOINT_UNSPECIFIED);
+  EXPECT_FALSE(received.released);
+  waitForEvent(MESSAGE_RELEASED);
+
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .setMessageLoopbackEnabled(false);
+}
+
+#ifdef CHRE_HOST_MESSAGE_BATCHING_ENABLED
+uint32_t getNumMessageBatchesSent() {
+  return EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .getNumMessageBatchesSent();
+}
+
+//! Receives the small messages looped back to the nanoapp, and checks that
+//! they are in order.
+void receiveSmallMessages(uint32_t numMessages) {
+  for (uint32_t i = 0; i < numMessages; i++) {
+    ReceivedMessage received;
+    TestEventQueueSingleton::get()->waitForEvent(CHRE_EVENT_MESSAGE_FROM_HOST,
+                                                 &received);
+    EXPECT_EQ(received.messageType, i);
+  }
+}
+
+TEST_F(TestBase, SmallMessagesToHostAreBatched) {
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .setMessageLoopbackEnabled(true);
+  uint64_t appId = loadNanoapp(MakeUnique<MessageNanoapp>());
+  uint32_t numBatchesBefore = getNumMessageBatchesSent();
+
+  // Fewer messages than a batch holds are sent once the latency budget has
+  // elapsed, a full batch right away
+  constexpr uint32_t kNumMessages = CHRE_HOST_MESSAGE_BATCH_MAX_MESSAGES + 2;
+  sendEventToNanoapp(appId, SEND_SMALL_MESSAGES, kNumMessages);
+  bool success;
+  waitForEvent(SEND_SMALL_MESSAGES, &success);
+  EXPECT_TRUE(success);
+  receiveSmallMessages(kNumMessages);
+  EXPECT_EQ(getNumMessageBatchesSent(), numBatchesBefore + 2);
+
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .setMessageLoopbackEnabled(false);
+}
+
+//! Runs on the virtual clock, so that the time a batch waits for is exact.
+class HostMessageBatchingTest : public TestBase {
+ protected:
+  bool useVirtualTime() const override {
+    return true;
+  }
+};
+
+TEST_F(HostMessageBatchingTest, SmallMessagesToHostWaitForHostWakeup) {
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .setMessageLoopbackEnabled(true);
+  uint64_t appId = loadNanoapp(MakeUnique<MessageNanoapp>());
+  uint32_t numBatchesBefore = getNumMessageBatchesSent();
+  PowerControlManager &powerControlManager =
+      EventLoopManagerSingleton::get()->getEventLoop().getPowerControlManager();
+  powerControlManager.onHostWakeSuspendEvent(/* awake= */ false);
+
+  constexpr uint32_t kNumMessages = 2;
+  sendEventToNanoapp(appId, SEND_SMALL_MESSAGES, kNumMessages);
+  bool success;
+  waitForEvent(SEND_SMALL_MESSAGES, &success);
+  EXPECT_TRUE(success);
+
+  // Much longer than the latency budget while the host is awake
+  uint64_t waitDuration =
+      10 * CHRE_HOST_MESSAGE_BATCH_LATENCY_MS * kOneMillisecondInNanoseconds;
+  sendEventToNanoapp(appId, WAIT, waitDuration);
+  waitForEvent(WAIT);
+  EXPECT_EQ(getNumMessageBatchesSent(), numBatchesBefore);
+
+  powerControlManager.onHostWakeSuspendEvent(/* awake= */ true);
+  receiveSmallMessages(kNumMessages);
+  EXPECT_EQ(getNumMessageBatchesSent(), numBatchesBefore + 1);
+
+  EventLoopManagerSingleton::get()
+      ->getHostCommsManager()
+      .setMessageLoopbackEnabled(false);
+}
+#endif  // CHRE_HOST_MESSAGE_BATCHING_ENABLED
+
+}  // namespace
+}  // namespace chre
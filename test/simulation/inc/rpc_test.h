@@ -40,6 +40,11 @@ class RpcTestService final
   // See generated IncrementService::Service for more details.
   pw::Status Increment(const chre_rpc_NumberMessage &request,
                        chre_rpc_NumberMessage &response);
+
+  // Count RPC server streaming service definition.
+  // See generated CountService::Service for more details.
+  void Count(const chre_rpc_NumberMessage &request,
+             pw::rpc::NanopbServerWriter<chre_rpc_NumberMessage> &writer);
 };
 
 class Env {
@@ -48,6 +53,7 @@ class Env {
   chre::RpcServer mServer;
   chre::RpcClient mClient{kPwRcpServerAppId};
   pw::rpc::NanopbUnaryReceiver<chre_rpc_NumberMessage> mIncrementCall;
+  pw::rpc::NanopbClientReader<chre_rpc_NumberMessage> mCountCall;
   uint32_t mNumber;
 
   void closeServer() {
@@ -65,6 +65,17 @@ class TestBase : public testing::Test {
     return 5 * kOneSecondInNanoseconds;
   }
 
+  /**
+   * This method can be overridden in a derived class if desired.
+   *
+   * @return true to run the test with the VirtualClock: timers and PAL tasks
+   *         run as soon as the test and the event loop are idle, in the order
+   *         of their deadlines, and the timeout is in virtual time.
+   */
+  virtual bool useVirtualTime() const {
+    return false;
+  }
+
   /**
    * A convenience method to invoke waitForEvent() for the TestEventQueue
    * singleton.
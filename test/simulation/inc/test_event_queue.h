@@ -21,6 +21,7 @@
 
 #include <cinttypes>
 
+#include "chre/platform/linux/virtual_clock.h"
 #include "chre/platform/memory.h"
 #include "chre/util/fixed_size_blocking_queue.h"
 #include "chre/util/memory.h"
@@ -56,11 +57,16 @@ namespace chre {
  * Note 2) The CHRE_EVENT_SIMULATION_TEST_TIMEOUT event type can be used to
  * abort the test due to a timeout (this usage is recommended in order to avoid
  * the test framework from stalling).
+ * Note 3) With the virtual time, the test thread holds the VirtualClock except
+ * while it waits for an event, and each pushed event holds it until the test
+ * thread consumes it, so that the time only advances while the test is
+ * blocked.
  */
 class TestEventQueue : public NonCopyable {
  public:
   //! Push an event to the queue.
   void pushEvent(uint16_t eventType) {
+    holdVirtualClock();
     mQueue.push({eventType});
   }
 
@@ -83,6 +89,7 @@ class TestEventQueue : public NonCopyable {
     auto ptr = memoryAlloc<T>();
     ASSERT_NE(ptr, nullptr);
     *ptr = eventData;
+    holdVirtualClock();
     mQueue.push({eventType, static_cast<void *>(ptr)});
   }
 
@@ -90,6 +97,7 @@ class TestEventQueue : public NonCopyable {
   void waitForEvent(uint16_t eventType) {
     LOGD("Waiting for event type 0x%" PRIx16, eventType);
     while (true) {
+      releaseVirtualClock();
       auto event = mQueue.pop();
       LOGD("Got event type 0x%" PRIx16, event.type);
       ASSERT_NE(event.type, CHRE_EVENT_SIMULATION_TEST_TIMEOUT)
@@ -107,6 +115,7 @@ class TestEventQueue : public NonCopyable {
     static_assert(std::is_trivial<T>::value);
     LOGD("Waiting for event type 0x%" PRIx16, eventType);
     while (true) {
+      releaseVirtualClock();
       auto event = mQueue.pop();
       LOGD("Got event type 0x%" PRIx16, event.type);
       ASSERT_NE(event.type, CHRE_EVENT_SIMULATION_TEST_TIMEOUT)
@@ -125,11 +134,25 @@ class TestEventQueue : public NonCopyable {
     while (!mQueue.empty()) {
       auto event = mQueue.pop();
       memoryFree(event.data);
+      releaseVirtualClock();
     }
   }
 
  private:
   static const size_t kQueueCapacity = 64;
+
+  static void holdVirtualClock() {
+    if (platform_linux::VirtualClockSingleton::isInitialized()) {
+      platform_linux::VirtualClockSingleton::get()->hold();
+    }
+  }
+
+  static void releaseVirtualClock() {
+    if (platform_linux::VirtualClockSingleton::isInitialized()) {
+      platform_linux::VirtualClockSingleton::get()->release();
+    }
+  }
+
   FixedSizeBlockingQueue<TestEvent, kQueueCapacity> mQueue;
 };
 
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include "chre/core/event.h"
+#include "chre/core/event_loop_manager.h"
+#include "chre/util/macros.h"
+#include "chre_api/chre/event.h"
+
+#include "gtest/gtest.h"
+#include "inc/test_util.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(MULTICAST_EVENT_FREED, 0);
+
+constexpr uint16_t kMulticastEventType = CHRE_EVENT_FIRST_USER_VALUE;
+constexpr size_t kNumNanoapps = 3;
+
+//! The number of multicast events received by each nanoapp.
+uint32_t gNumEventsReceived[kNumNanoapps];
+
+class MulticastNanoapp : public TestNanoapp {
+ public:
+  explicit MulticastNanoapp(uint32_t index)
+      : TestNanoapp(TestNanoappInfo{.id = 0x1234 + index}), mIndex(index) {}
+
+  void handleEvent(uint32_t, uint16_t eventType, const void *) override {
+    if (eventType == kMulticastEventType) {
+      gNumEventsReceived[mIndex]++;
+    }
+  }
+
+ private:
+  const uint32_t mIndex;
+};
+
+void freeMulticastEvent(uint16_t, void *eventData) {
+  auto *numFrees = static_cast<uint32_t *>(eventData);
+  (*numFrees)++;
+  TestEventQueueSingleton::get()->pushEvent(MULTICAST_EVENT_FREED);
+}
+
+TEST_F(TestBase, MulticastEventIsDeliveredToItsTargetsOnly) {
+  uint16_t instanceIds[kNumNanoapps];
+  for (uint32_t i = 0; i < kNumNanoapps; i++) {
+    gNumEventsReceived[i] = 0;
+    uint64_t appId = loadNanoapp(MakeUnique<MulticastNanoapp>(i));
+    ASSERT_TRUE(EventLoopManagerSingleton::get()
+                    ->getEventLoop()
+                    .findNanoappInstanceIdByAppId(appId, &instanceIds[i]));
+  }
+
+  uint16_t targets[] = {instanceIds[0], instanceIds[2]};
+  uint32_t numFrees = 0;
+  EventLoopManagerSingleton::get()->getEventLoop().postMulticastEventOrDie(
+      kMulticastEventType, &numFrees, freeMulticastEvent, targets,
+      ARRAY_SIZE(targets));
+  waitForEvent(MULTICAST_EVENT_FREED);
+
+  // The free callback is invoked once, after all the targets got the event.
+  EXPECT_EQ(numFrees, 1u);
+  EXPECT_EQ(gNumEventsReceived[0], 1u);
+  EXPECT_EQ(gNumEventsReceived[1], 0u);
+  EXPECT_EQ(gNumEventsReceived[2], 1u);
+}
+
+}  // namespace
+}  // namespace chre
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/power_control_manager.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/re.h"
+
+#include "gtest/gtest.h"
+#include "inc/test_util.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+CREATE_CHRE_TEST_EVENT(START_TIMER, 0);
+CREATE_CHRE_TEST_EVENT(TIMER_DONE, 1);
+
+constexpr uint32_t kNumTimerEvents = 50;
+
+uint32_t getNumPowerStateTransitions() {
+  return EventLoopManagerSingleton::get()
+      ->getEventLoop()
+      .getPowerControlManager()
+      .getNumPowerStateTransitions();
+}
+
+TEST_F(TestBase, PowerPolicyStaysActiveThroughPeriodicTimer) {
+  class App : public TestNanoapp {
+   public:
+    void handleEvent(uint32_t, uint16_t eventType,
+                     const void *eventData) override {
+      switch (eventType) {
+        case CHRE_EVENT_TIMER: {
+          if (++mCount == kNumTimerEvents) {
+            chreTimerCancel(mHandle);
+            TestEventQueueSingleton::get()->pushEvent(TIMER_DONE);
+          }
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == START_TIMER) {
+            mHandle = chreTimerSet(kOneMillisecondInNanoseconds,
+                                   nullptr /*cookie*/, false /*oneShot*/);
+          }
+          break;
+        }
+      }
+    }
+
+   protected:
+    uint32_t mHandle = CHRE_TIMER_INVALID;
+    uint32_t mCount = 0;
+  };
+
+  uint64_t appId = loadNanoapp(MakeUnique<App>());
+
+  uint32_t numTransitionsBefore = getNumPowerStateTransitions();
+  sendEventToNanoapp(appId, START_TIMER);
+  waitForEvent(TIMER_DONE);
+  uint32_t numTransitions =
+      getNumPowerStateTransitions() - numTransitionsBefore;
+
+  // Entering the low-power state whenever the queue empties would take two
+  // transitions per event.
+  EXPECT_LT(numTransitions, kNumTimerEvents / 2);
+}
+
+}  // namespace
+}  // namespace chre
@@ -43,6 +43,21 @@ pw::Status RpcTestService::Increment(const chre_rpc_NumberMessage &request,
   return pw::OkStatus();
 }
 
+void RpcTestService::Count(
+    const chre_rpc_NumberMessage &request,
+    pw::rpc::NanopbServerWriter<chre_rpc_NumberMessage> &writer) {
+  for (uint32_t i = 0; i < request.number; i++) {
+    EnvSingleton::get()->mServer.setPermissionForNextMessage(
+        CHRE_MESSAGE_PERMISSION_NONE);
+    chre_rpc_NumberMessage response;
+    response.number = i;
+    writer.Write(response).IgnoreError();
+  }
+  EnvSingleton::get()->mServer.setPermissionForNextMessage(
+      CHRE_MESSAGE_PERMISSION_NONE);
+  writer.Finish().IgnoreError();
+}
+
 namespace {
 
 TEST_F(TestBase, PwRpcCanPublishServicesInNanoappStart) {
@@ -353,6 +368,133 @@ TEST_F(TestBase, PwRpcClientNanoappCanRequestServerNanoapp) {
   EnvSingleton::deinit();
 }
 
+TEST_F(TestBase, PwRpcServerStreamIsBatchedForBatchingClients) {
+  CREATE_CHRE_TEST_EVENT(COUNT_REQUEST, 0);
+
+  constexpr uint32_t kNumResponses = 500;
+  static uint32_t numRequestedResponses;
+  static uint32_t numResponseEvents;
+  static uint32_t numResponses;
+  numRequestedResponses = kNumResponses;
+  numResponseEvents = 0;
+  numResponses = 0;
+
+  class ClientApp : public TestNanoapp {
+   public:
+    ClientApp() : TestNanoapp(TestNanoappInfo{.id = kPwRcpClientAppId}) {}
+
+    void handleEvent(uint32_t senderInstanceId, uint16_t eventType,
+                     const void *eventData) override {
+      Env *env = EnvSingleton::get();
+
+      env->mClient.handleEvent(senderInstanceId, eventType, eventData);
+      switch (eventType) {
+        case CHRE_EVENT_RPC_RESPONSE:
+          numResponseEvents++;
+          break;
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == COUNT_REQUEST) {
+            auto client =
+                env->mClient.get<rpc::pw_rpc::nanopb::RpcTestService::Client>();
+            bool batchRequests = *static_cast<bool *>(event->data);
+            if (client.has_value()) {
+              // Batching the requests tells the server that the client reads
+              // batched responses.
+              if (batchRequests) {
+                env->mClient.startBatch();
+                chre_rpc_NumberMessage incrementRequest;
+                incrementRequest.number = 0;
+                env->mIncrementCall = client->Increment(
+                    incrementRequest,
+                    [](const chre_rpc_NumberMessage & /*response*/,
+                       pw::Status /*status*/) {});
+              }
+              chre_rpc_NumberMessage countRequest;
+              countRequest.number = numRequestedResponses;
+              env->mCountCall = client->Count(
+                  countRequest,
+                  [](const chre_rpc_NumberMessage &response) {
+                    if (response.number == numResponses) {
+                      numResponses++;
+                    }
+                  },
+                  [](pw::Status status) {
+                    TestEventQueueSingleton::get()->pushEvent(COUNT_REQUEST,
+                                                              status.ok());
+                  });
+              if (batchRequests) {
+                env->mClient.flushBatch();
+              }
+            } else {
+              TestEventQueueSingleton::get()->pushEvent(COUNT_REQUEST, false);
+            }
+          }
+          break;
+        }
+      }
+    }
+
+    void end() {
+      EnvSingleton::get()->closeClient();
+    }
+  };
+
+  class ServerApp : public TestNanoapp {
+   public:
+    ServerApp() : TestNanoapp(TestNanoappInfo{.id = kPwRcpServerAppId}) {}
+
+    bool start() override {
+      chre::RpcServer::Service service = {
+          .service = EnvSingleton::get()->mRpcTestService,
+          .id = 0xca8f7150a3f05847,
+          .version = 0x01020034};
+      return EnvSingleton::get()->mServer.registerServices(1, &service);
+    }
+
+    void handleEvent(uint32_t senderInstanceId, uint16_t eventType,
+                     const void *eventData) override {
+      EnvSingleton::get()->mServer.handleEvent(senderInstanceId, eventType,
+                                               eventData);
+    }
+
+    void end() {
+      EnvSingleton::get()->closeServer();
+    }
+  };
+
+  EnvSingleton::init();
+  uint64_t serverId = loadNanoapp(MakeUnique<ServerApp>());
+  uint64_t clientId = loadNanoapp(MakeUnique<ClientApp>());
+  bool status = false;
+
+  sendEventToNanoapp(clientId, COUNT_REQUEST, /* batchRequests= */ true);
+  waitForEvent(COUNT_REQUEST, &status);
+
+  EXPECT_TRUE(status);
+  EXPECT_EQ(numResponses, kNumResponses);
+  // The responses written by one server call share a few events instead of
+  // taking one event and one allocation each.
+  EXPECT_LT(numResponseEvents, kNumResponses / 10);
+
+  // A client sending single packets may not read batches, so each response
+  // takes its own event.
+  constexpr uint32_t kNumSingleResponses = 20;
+  numRequestedResponses = kNumSingleResponses;
+  numResponseEvents = 0;
+  numResponses = 0;
+  sendEventToNanoapp(clientId, COUNT_REQUEST, /* batchRequests= */ false);
+  waitForEvent(COUNT_REQUEST, &status);
+
+  EXPECT_TRUE(status);
+  EXPECT_EQ(numResponses, kNumSingleResponses);
+  EXPECT_GT(numResponseEvents, kNumSingleResponses);
+
+  unloadNanoapp(serverId);
+  unloadNanoapp(clientId);
+  EnvSingleton::deinit();
+}
+
 TEST_F(TestBase, PwRpcRpcClientHasServiceCheckForAMatchingService) {
   CREATE_CHRE_TEST_EVENT(QUERY_HAS_SERVICE, 0);
 
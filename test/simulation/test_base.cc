@@ -22,6 +22,7 @@
 #include "chre/core/init.h"
 #include "chre/platform/linux/platform_log.h"
 #include "chre/platform/linux/task_util/task_manager.h"
+#include "chre/platform/linux/virtual_clock.h"
 #include "chre/util/time.h"
 #include "chre_api/chre/version.h"
 #include "inc/test_util.h"
@@ -44,6 +45,12 @@ namespace chre {
  * this test.
  */
 void TestBase::SetUp() {
+  if (useVirtualTime()) {
+    // Initialized first so that all timers and tasks use it. The test thread
+    // holds the clock while it runs, see TestEventQueue.
+    platform_linux::VirtualClockSingleton::init();
+    platform_linux::VirtualClockSingleton::get()->hold();
+  }
   // TODO(b/346903946): remove these extra prints once init failure is resolved
   printf("SetUp(): log\n");
   chre::PlatformLogSingleton::init();
@@ -83,6 +90,9 @@ void TestBase::TearDown() {
   deleteNanoappInfos();
   unregisterAllTestNanoapps();
   chre::PlatformLogSingleton::deinit();
+  if (platform_linux::VirtualClockSingleton::isInitialized()) {
+    platform_linux::VirtualClockSingleton::deinit();
+  }
 }
 
 TEST_F(TestBase, CanLoadAndStartSingleNanoapp) {
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include "chre/platform/system_time.h"
+#include "chre/util/time.h"
+#include "chre_api/chre/re.h"
+#include "chre_api/chre/sensor.h"
+
+#include "gtest/gtest.h"
+#include "inc/test_util.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+constexpr uint64_t kOneHourInNanoseconds = 60 * kOneMinuteInNanoseconds;
+
+class VirtualTimeTest : public TestBase {
+ protected:
+  bool useVirtualTime() const override {
+    return true;
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 2 * kOneHourInNanoseconds;
+  }
+};
+
+CREATE_CHRE_TEST_EVENT(START, 0);
+CREATE_CHRE_TEST_EVENT(DONE, 1);
+
+//! Records the intervals between the events of a periodic source.
+struct PeriodicEventStats {
+  uint32_t count;
+  uint32_t numIrregularIntervals;
+  uint64_t lastTime;
+
+  void record(uint64_t period) {
+    uint64_t now = chreGetTime();
+    if (count > 0 && now - lastTime != period) {
+      numIrregularIntervals++;
+    }
+    lastTime = now;
+    count++;
+  }
+};
+
+struct Results {
+  PeriodicEventStats timer;
+  PeriodicEventStats sensor;
+};
+
+TEST_F(VirtualTimeTest, AnHourOfTimerAndSensorTrafficIsExact) {
+  constexpr uint64_t kTimerPeriod = kOneSecondInNanoseconds;
+  constexpr uint64_t kSensorInterval = 100 * kOneMillisecondInNanoseconds;
+  constexpr uint32_t kNumTimerEvents = kOneHourInNanoseconds / kTimerPeriod;
+
+  class App : public TestNanoapp {
+   public:
+    void handleEvent(uint32_t, uint16_t eventType,
+                     const void *eventData) override {
+      switch (eventType) {
+        case CHRE_EVENT_TIMER: {
+          mResults.timer.record(kTimerPeriod);
+          if (mResults.timer.count == kNumTimerEvents) {
+            chreTimerCancel(mTimerHandle);
+            chreSensorConfigureModeOnly(mSensorHandle,
+                                        CHRE_SENSOR_CONFIGURE_MODE_DONE);
+            TestEventQueueSingleton::get()->pushEvent(DONE, mResults);
+          }
+          break;
+        }
+
+        case CHRE_EVENT_SENSOR_UNCALIBRATED_ACCELEROMETER_DATA: {
+          mResults.sensor.record(kSensorInterval);
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == START) {
+            ASSERT_TRUE(chreSensorFindDefault(
+                CHRE_SENSOR_TYPE_UNCALIBRATED_ACCELEROMETER, &mSensorHandle));
+            ASSERT_TRUE(chreSensorConfigure(
+                mSensorHandle, CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS,
+                kSensorInterval, /* latency= */ 0));
+            mTimerHandle = chreTimerSet(kTimerPeriod, nullptr /*cookie*/,
+                                        false /*oneShot*/);
+          }
+          break;
+        }
+      }
+    }
+
+   protected:
+    uint32_t mSensorHandle = 0;
+    uint32_t mTimerHandle = CHRE_TIMER_INVALID;
+    Results mResults = {};
+  };
+
+  uint64_t appId = loadNanoapp(MakeUnique<App>());
+
+  Nanoseconds start = SystemTime::getMonotonicTime();
+  sendEventToNanoapp(appId, START);
+  Results results;
+  waitForEvent(DONE, &results);
+  Nanoseconds elapsed = SystemTime::getMonotonicTime() - start;
+
+  EXPECT_EQ(elapsed.toRawNanoseconds(), kOneHourInNanoseconds);
+  EXPECT_EQ(results.timer.numIrregularIntervals, 0);
+  EXPECT_EQ(results.sensor.numIrregularIntervals, 0);
+  // The last sample is due with the last timer event, which was scheduled
+  // first and stops the sensor.
+  EXPECT_EQ(results.sensor.count,
+            kOneHourInNanoseconds / kSensorInterval - 1);
+}
+
+TEST_F(VirtualTimeTest, TimeDoesNotAdvanceWhileTheTestRuns) {
+  CREATE_CHRE_TEST_EVENT(SET_TIMER, 2);
+
+  class App : public TestNanoapp {
+   public:
+    void handleEvent(uint32_t, uint16_t eventType,
+                     const void *eventData) override {
+      switch (eventType) {
+        case CHRE_EVENT_TIMER: {
+          TestEventQueueSingleton::get()->pushEvent(CHRE_EVENT_TIMER);
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == SET_TIMER) {
+            chreTimerSet(kOneMillisecondInNanoseconds, nullptr /*cookie*/,
+                         true /*oneShot*/);
+            TestEventQueueSingleton::get()->pushEvent(SET_TIMER);
+          }
+          break;
+        }
+      }
+    }
+  };
+
+  uint64_t appId = loadNanoapp(MakeUnique<App>());
+
+  Nanoseconds start = SystemTime::getMonotonicTime();
+  sendEventToNanoapp(appId, SET_TIMER);
+  waitForEvent(SET_TIMER);
+  // The timer is due, but the time does not advance until the test waits.
+  EXPECT_EQ(SystemTime::getMonotonicTime(), start);
+
+  waitForEvent(CHRE_EVENT_TIMER);
+  EXPECT_EQ(SystemTime::getMonotonicTime() - start,
+            Nanoseconds(kOneMillisecondInNanoseconds));
+}
+
+}  // namespace
+}  // namespace chre
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "chre/util/array_queue.h"
+#include "chre/util/dynamic_vector.h"
+#include "chre/util/priority_queue.h"
+#include "chre/util/segmented_queue.h"
+
+namespace chre {
+namespace {
+
+//! An element about the size of an event in the event queues.
+struct Element {
+  uint32_t values[8];
+};
+
+constexpr size_t kQueueCapacity = 256;
+constexpr size_t kSegmentedQueueBlockSize = 32;
+
+//! Deadlines in a pseudo-random order, generated the same way on every run.
+void fillDeadlines(DynamicVector<uint64_t> &deadlines, size_t count) {
+  uint64_t value = 0x2545f4914f6cdd1d;
+  deadlines.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    value = value * 6364136223846793005 + 1442695040888963407;
+    deadlines.push_back(value >> 16);
+  }
+}
+
+void BM_ArrayQueuePushPop(benchmark::State &state) {
+  const size_t depth = static_cast<size_t>(state.range(0));
+  ArrayQueue<Element, kQueueCapacity> queue;
+  Element element = {};
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < depth; i++) {
+      element.values[0] = static_cast<uint32_t>(i);
+      queue.push(element);
+    }
+    while (!queue.empty()) {
+      benchmark::DoNotOptimize(queue.front());
+      queue.pop();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_ArrayQueuePushPop)->Arg(1)->Arg(16)->Arg(kQueueCapacity);
+
+void BM_SegmentedQueuePushPop(benchmark::State &state) {
+  const size_t depth = static_cast<size_t>(state.range(0));
+  SegmentedQueue<Element, kSegmentedQueueBlockSize> queue(
+      kQueueCapacity / kSegmentedQueueBlockSize);
+  Element element = {};
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < depth; i++) {
+      element.values[0] = static_cast<uint32_t>(i);
+      queue.push(element);
+    }
+    while (!queue.empty()) {
+      benchmark::DoNotOptimize(queue.front());
+      queue.pop();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_SegmentedQueuePushPop)->Arg(1)->Arg(16)->Arg(kQueueCapacity);
+
+void BM_PriorityQueuePushPop(benchmark::State &state) {
+  const size_t count = static_cast<size_t>(state.range(0));
+  DynamicVector<uint64_t> deadlines;
+  fillDeadlines(deadlines, count);
+  PriorityQueue<uint64_t, std::greater<uint64_t>> queue;
+
+  for (auto _ : state) {
+    for (uint64_t deadline : deadlines) {
+      queue.push(deadline);
+    }
+    while (!queue.empty()) {
+      benchmark::DoNotOptimize(queue.top());
+      queue.pop();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PriorityQueuePushPop)->Arg(8)->Arg(64)->Arg(512);
+
+void BM_DynamicVectorPushBack(benchmark::State &state) {
+  const size_t count = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    DynamicVector<uint32_t> vector;
+    for (size_t i = 0; i < count; i++) {
+      vector.push_back(static_cast<uint32_t>(i));
+    }
+    benchmark::DoNotOptimize(vector.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DynamicVectorPushBack)->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_DynamicVectorPushBackReserved(benchmark::State &state) {
+  const size_t count = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    DynamicVector<uint32_t> vector;
+    vector.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      vector.push_back(static_cast<uint32_t>(i));
+    }
+    benchmark::DoNotOptimize(vector.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DynamicVectorPushBackReserved)->Arg(16)->Arg(256)->Arg(4096);
+
+}  // namespace
+}  // namespace chre
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/util/memory_pool.h"
+#include "chre/util/synchronized_expandable_memory_pool.h"
+
+namespace chre {
+namespace {
+
+//! An element about the size of an event in the event pools.
+struct Element {
+  uint32_t values[8];
+};
+
+constexpr size_t kPoolCapacity = 256;
+constexpr size_t kExpandablePoolBlockSize = 32;
+constexpr size_t kExpandablePoolMaxBlocks =
+    kPoolCapacity / kExpandablePoolBlockSize;
+
+//! Allocates count elements from the pool, then releases them in the order
+//! they were allocated.
+template <typename PoolType>
+void allocateAndDeallocate(benchmark::State &state, PoolType &pool) {
+  const size_t count = static_cast<size_t>(state.range(0));
+  Element *elements[kPoolCapacity];
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; i++) {
+      elements[i] = pool.allocate();
+    }
+    benchmark::DoNotOptimize(elements);
+    for (size_t i = 0; i < count; i++) {
+      pool.deallocate(elements[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+void BM_MemoryPoolAllocate(benchmark::State &state) {
+  MemoryPool<Element, kPoolCapacity> pool;
+  allocateAndDeallocate(state, pool);
+}
+BENCHMARK(BM_MemoryPoolAllocate)->Arg(1)->Arg(32)->Arg(kPoolCapacity);
+
+void BM_SynchronizedExpandableMemoryPoolAllocate(benchmark::State &state) {
+  SynchronizedExpandableMemoryPool<Element, kExpandablePoolBlockSize,
+                                   kExpandablePoolMaxBlocks>
+      pool;
+  allocateAndDeallocate(state, pool);
+}
+BENCHMARK(BM_SynchronizedExpandableMemoryPoolAllocate)
+    ->Arg(1)
+    ->Arg(32)
+    ->Arg(kPoolCapacity);
+
+//! Allocations from several threads at once, as when events are posted from
+//! the PAL threads and freed by the event loop.
+void BM_SynchronizedExpandableMemoryPoolContended(benchmark::State &state) {
+  static SynchronizedExpandableMemoryPool<Element, kExpandablePoolBlockSize,
+                                          kExpandablePoolMaxBlocks>
+      pool;
+  constexpr size_t kAllocationsPerIteration = 8;
+  Element *elements[kAllocationsPerIteration];
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < kAllocationsPerIteration; i++) {
+      elements[i] = pool.allocate();
+    }
+    benchmark::DoNotOptimize(elements);
+    for (size_t i = 0; i < kAllocationsPerIteration; i++) {
+      pool.deallocate(elements[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kAllocationsPerIteration);
+}
+BENCHMARK(BM_SynchronizedExpandableMemoryPoolContended)->ThreadRange(1, 4);
+
+}  // namespace
+}  // namespace chre
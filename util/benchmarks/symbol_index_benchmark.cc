@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "chre/util/symbol_index.h"
+
+namespace chre {
+namespace {
+
+//! About the number of symbols exported to nanoapps.
+constexpr size_t kNumSymbols = 160;
+
+struct Entry {
+  void *data;
+  const char *dataName;
+};
+
+//! Symbols named like the CHRE API, which share a long common prefix as the
+//! exported symbols do.
+struct SymbolTable {
+  SymbolTable() {
+    char name[32];
+    for (size_t i = 0; i < kNumSymbols; i++) {
+      snprintf(name, sizeof(name), "chreApiFunction%zu", i);
+      names.push_back(name);
+    }
+    for (const std::string &symbolName : names) {
+      entries.push_back({nullptr, symbolName.c_str()});
+    }
+
+    // The relocations of a large nanoapp: each API is imported through a few
+    // relocations, and a few names are resolved against the nanoapp itself
+    // after failing to resolve in the exported symbols.
+    for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < kNumSymbols; j += 2) {
+        relocations.push_back(names[(j * 7 + i) % kNumSymbols]);
+      }
+      relocations.push_back("_ZN7nanoapp5State6updateEv");
+      relocations.push_back("_ZTVN10__cxxabiv117__class_type_infoE");
+    }
+  }
+
+  std::vector<std::string> names;
+  std::vector<Entry> entries;
+  std::vector<std::string> relocations;
+};
+
+void BM_SymbolIndexLinearScan(benchmark::State &state) {
+  SymbolTable table;
+  for (auto _ : state) {
+    for (const std::string &relocation : table.relocations) {
+      const Entry *found = nullptr;
+      for (const Entry &entry : table.entries) {
+        if (strcmp(entry.dataName, relocation.c_str()) == 0) {
+          found = &entry;
+          break;
+        }
+      }
+      benchmark::DoNotOptimize(found);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * table.relocations.size());
+}
+BENCHMARK(BM_SymbolIndexLinearScan);
+
+void BM_SymbolIndexFind(benchmark::State &state) {
+  SymbolTable table;
+  SymbolIndex<Entry, kNumSymbols> index;
+  if (!index.add(table.entries.data(), table.entries.size())) {
+    state.SkipWithError("Failed to build the index");
+    return;
+  }
+  for (auto _ : state) {
+    for (const std::string &relocation : table.relocations) {
+      benchmark::DoNotOptimize(index.find(relocation.c_str()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * table.relocations.size());
+}
+BENCHMARK(BM_SymbolIndexFind);
+
+}  // namespace
+}  // namespace chre
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "chre/core/event_loop_common.h"
+#include "chre/core/timer_pool.h"
+#include "chre/util/time.h"
+#include "chre/util/transaction_manager.h"
+
+namespace chre {
+namespace {
+
+constexpr Nanoseconds kTimeout = Milliseconds(10);
+constexpr uint16_t kMaxAttempts = 3;
+
+class NullTransactionManagerCallback : public TransactionManagerCallback {
+ public:
+  void onTransactionAttempt(uint32_t /*transactionId*/,
+                            uint16_t /*groupId*/) override {}
+  void onTransactionFailure(uint32_t /*transactionId*/,
+                            uint16_t /*groupId*/) override {}
+};
+
+//! A timer pool that never fires.
+class NullTimerPool {
+ public:
+  TimerHandle setSystemTimer(Nanoseconds /*duration*/,
+                             SystemEventCallbackFunction * /*callback*/,
+                             SystemCallbackType /*callbackType*/,
+                             void * /*data*/) {
+    return mNextHandle++;
+  }
+
+  bool cancelSystemTimer(TimerHandle /*handle*/) {
+    return true;
+  }
+
+ private:
+  TimerHandle mNextHandle = 1;
+};
+
+//! Keeps kCapacity transactions pending and completes them out of order, as
+//! reliable messages that are acknowledged out of order do. Each iteration is
+//! one remove() and one add().
+template <size_t kCapacity>
+void BM_TransactionManagerOutOfOrderCompletion(benchmark::State &state) {
+  NullTransactionManagerCallback cb;
+  NullTimerPool timerPool;
+  TransactionManager<kCapacity, NullTimerPool> tm(cb, timerPool, kTimeout,
+                                                   kMaxAttempts);
+  std::mt19937 random(kCapacity);
+  uint32_t ids[kCapacity];
+  uint16_t nextGroupId = 0;
+  for (size_t i = 0; i < kCapacity; i++) {
+    tm.add(nextGroupId++, &ids[i]);
+  }
+
+  for (auto _ : state) {
+    size_t victim = random() % kCapacity;
+    tm.remove(ids[victim]);
+    tm.add(nextGroupId++, &ids[victim]);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_TransactionManagerOutOfOrderCompletion, 32);
+BENCHMARK_TEMPLATE(BM_TransactionManagerOutOfOrderCompletion, 128);
+BENCHMARK_TEMPLATE(BM_TransactionManagerOutOfOrderCompletion, 1024);
+
+}  // namespace
+}  // namespace chre
@@ -16,8 +16,10 @@
 
 #include "chre/util/duplicate_message_detector.h"
 
+#include "chre/platform/log.h"
 #include "chre/platform/system_time.h"
 
+#include <cinttypes>
 #include <cstdint>
 
 namespace chre {
@@ -34,7 +36,6 @@ Optional<chreError> DuplicateMessageDetector::findOrAdd(
   if (record == nullptr) {
     record = addLocked(messageSequenceNumber, hostEndpoint);
     if (record == nullptr) {
-      LOG_OOM();
       if (outIsDuplicate != nullptr) {
         *outIsDuplicate = true;
       }
@@ -59,13 +60,13 @@ bool DuplicateMessageDetector::findAndSetError(uint32_t messageSequenceNumber,
 
 void DuplicateMessageDetector::removeOldEntries() {
   Nanoseconds now = SystemTime::getMonotonicTime();
-  while (!mReliableMessageRecordQueue.empty()) {
-    ReliableMessageRecord &record = mReliableMessageRecordQueue.top();
-    if (record.timestamp + kTimeout <= now) {
-      mReliableMessageRecordQueue.pop();
-    } else {
-      break;
-    }
+  while (mNumRecords > 0 &&
+         mStorage->records[mFirstRecord].timestamp + kTimeout <= now) {
+    removeOldestLocked();
+  }
+  if (mNumRecords == 0) {
+    mStorage.reset();
+    mFirstRecord = 0;
   }
 }
 
@@ -73,30 +74,51 @@ DuplicateMessageDetector::ReliableMessageRecord*
     DuplicateMessageDetector::addLocked(
         uint32_t messageSequenceNumber,
         uint16_t hostEndpoint) {
-  bool success = mReliableMessageRecordQueue.push(
-      ReliableMessageRecord{
-          .timestamp = SystemTime::getMonotonicTime(),
-          .messageSequenceNumber = messageSequenceNumber,
-          .hostEndpoint = hostEndpoint,
-          .error = Optional<chreError>()});
-  return success
-      ? findLocked(messageSequenceNumber, hostEndpoint, /* reverse= */ true)
-      : nullptr;
+  if (mNumRecords == kMaxRecords) {
+    removeOldEntries();
+    if (mNumRecords == kMaxRecords) {
+      LOGE("Too many reliable messages to add message %" PRIu32,
+           messageSequenceNumber);
+      return nullptr;
+    }
+  }
+  if (mStorage.isNull()) {
+    mStorage = MakeUnique<RecordStorage>();
+    if (mStorage.isNull()) {
+      LOG_OOM();
+      return nullptr;
+    }
+  }
+
+  size_t slot = (mFirstRecord + mNumRecords) % kMaxRecords;
+  mStorage->records[slot] = ReliableMessageRecord{
+      .timestamp = SystemTime::getMonotonicTime(),
+      .messageSequenceNumber = messageSequenceNumber,
+      .hostEndpoint = hostEndpoint,
+      .error = Optional<chreError>()};
+  ++mNumRecords;
+  mStorage->index.insert(messageSequenceNumber, static_cast<uint16_t>(slot));
+  return &mStorage->records[slot];
 }
 
 DuplicateMessageDetector::ReliableMessageRecord*
   DuplicateMessageDetector::findLocked(uint32_t messageSequenceNumber,
-                                       uint16_t hostEndpoint,
-                                       bool reverse) {
-  for (size_t i = 0; i < mReliableMessageRecordQueue.size(); ++i) {
-    size_t index = reverse ? mReliableMessageRecordQueue.size() - i - 1 : i;
-    ReliableMessageRecord &record = mReliableMessageRecordQueue[index];
-    if (record.messageSequenceNumber == messageSequenceNumber &&
-        record.hostEndpoint == hostEndpoint) {
-      return &record;
-    }
+                                       uint16_t hostEndpoint) {
+  if (mStorage.isNull()) {
+    return nullptr;
   }
-  return nullptr;
+  const uint16_t *slot = mStorage->index.find(
+      messageSequenceNumber, [this, hostEndpoint](uint16_t candidate) {
+        return mStorage->records[candidate].hostEndpoint == hostEndpoint;
+      });
+  return (slot == nullptr) ? nullptr : &mStorage->records[*slot];
+}
+
+void DuplicateMessageDetector::removeOldestLocked() {
+  mStorage->index.erase(mStorage->records[mFirstRecord].messageSequenceNumber,
+                        static_cast<uint16_t>(mFirstRecord));
+  mFirstRecord = (mFirstRecord + 1) % kMaxRecords;
+  --mNumRecords;
 }
 
 }  // namespace chre
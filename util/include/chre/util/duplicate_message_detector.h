@@ -19,11 +19,20 @@
 
 #include "chre/util/non_copyable.h"
 #include "chre/util/optional.h"
-#include "chre/util/priority_queue.h"
+#include "chre/util/sequence_number_index.h"
 #include "chre/util/time.h"
+#include "chre/util/unique_ptr.h"
 #include "chre_api/chre.h"
 
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// The maximum number of reliable messages the duplicate message detector keeps
+// a record of. This default value can be overridden in the variant-specific
+// makefile.
+#ifndef CHRE_DUPLICATE_MESSAGE_DETECTOR_MAX_RECORDS
+#define CHRE_DUPLICATE_MESSAGE_DETECTOR_MAX_RECORDS 64
+#endif
 
 namespace chre {
 
@@ -45,6 +54,14 @@ namespace chre {
  *
  * Call removeOldEntries() to remove any messages that have been in the detector
  * for longer than the timeout specified in the constructor.
+ *
+ * The detector keeps up to CHRE_DUPLICATE_MESSAGE_DETECTOR_MAX_RECORDS
+ * records, in the order they were added, and finds them through a hash index
+ * on the message sequence number. The records are allocated with the first
+ * one and freed once they have all timed out. If the detector is full of
+ * records that have not timed out, new messages are rejected with
+ * CHRE_ERROR_NO_MEMORY, as a record that is dropped early would let a
+ * retransmitted message be delivered twice.
  */
 class DuplicateMessageDetector : public NonCopyable {
  public:
@@ -59,6 +76,12 @@ class DuplicateMessageDetector : public NonCopyable {
     }
   };
 
+  //! The maximum number of records.
+  static constexpr size_t kMaxRecords =
+      CHRE_DUPLICATE_MESSAGE_DETECTOR_MAX_RECORDS;
+  static_assert(kMaxRecords > 0 && kMaxRecords < UINT16_MAX,
+                "Invalid number of records");
+
   DuplicateMessageDetector() = delete;
   DuplicateMessageDetector(Nanoseconds timeout):
       kTimeout(timeout) {}
@@ -69,7 +92,8 @@ class DuplicateMessageDetector : public NonCopyable {
   //! detector. Returns the error code previously recorded for the message, or
   //! an empty Optional if the message is not a duplicate. If outIsDuplicate is
   //! not nullptr, it will be set to true if the message is a duplicate (was
-  //! found), or false otherwise.
+  //! found), or false otherwise. If the message could not be added, returns
+  //! CHRE_ERROR_NO_MEMORY and sets outIsDuplicate to true.
   Optional<chreError> findOrAdd(uint32_t messageSequenceNumber,
                                 uint16_t hostEndpoint,
                                 bool *outIsDuplicate = nullptr);
@@ -89,21 +113,36 @@ class DuplicateMessageDetector : public NonCopyable {
   //! message timeout.
   Nanoseconds kTimeout;
 
-  //! The queue of reliable message records.
-  PriorityQueue<ReliableMessageRecord, std::greater<ReliableMessageRecord>>
-      mReliableMessageRecordQueue;
+  struct RecordStorage {
+    //! The reliable message records, as a circular buffer in the order they
+    //! were added, which is also the order they time out in.
+    ReliableMessageRecord records[kMaxRecords];
+
+    //! Index from the message sequence number of each record to its slot.
+    SequenceNumberIndex<kMaxRecords> index;
+  };
 
-  //! Adds a new message to the detector. Returns the message record, or nullptr
-  //! if the message could not be added. Not thread safe.
+  //! The records, or null if there are none.
+  UniquePtr<RecordStorage> mStorage;
+
+  //! The slot of the oldest record.
+  size_t mFirstRecord = 0;
+
+  //! The number of records.
+  size_t mNumRecords = 0;
+
+  //! Adds a new message to the detector. Returns the message record, or
+  //! nullptr if the message could not be added. Not thread safe.
   ReliableMessageRecord *addLocked(uint32_t messageSequenceNumber,
                                    uint16_t hostEndpoint);
 
   //! Finds the message with the given message sequence number and host
-  //! endpoint, else returns nullptr. Not thread safe. If reverse is true,
-  //! this function searches from the end of the queue.
+  //! endpoint, else returns nullptr. Not thread safe.
   ReliableMessageRecord *findLocked(uint32_t messageSequenceNumber,
-                                    uint16_t hostEndpoint,
-                                    bool reverse = false);
+                                    uint16_t hostEndpoint);
+
+  //! Removes the oldest record. Not thread safe.
+  void removeOldestLocked();
 };
 
 }  // namespace chre
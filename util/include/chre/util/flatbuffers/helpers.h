@@ -37,6 +37,53 @@ class FlatBufferAllocator : public flatbuffers::Allocator {
   }
 };
 
+//! Flatbuffers allocator that serves a caller-provided buffer, e.g. the TX
+//! buffer of a transport, so that a message can be encoded in place. The
+//! buffer is served to one allocation at a time, and any allocation that does
+//! not fit is forwarded to the fallback allocator.
+//!
+//! Note that FlatBufferBuilder fills its buffer from the end, so the encoded
+//! message ends at the end of the buffer when it was encoded in place.
+class FixedBufferFlatBufferAllocator : public flatbuffers::Allocator {
+ public:
+  FixedBufferFlatBufferAllocator(uint8_t *buffer, size_t bufferSize,
+                                 flatbuffers::Allocator *fallbackAllocator)
+      : mBuffer(buffer),
+        mBufferSize(bufferSize),
+        mFallbackAllocator(fallbackAllocator) {}
+
+  uint8_t *allocate(size_t size) override {
+    if (!mBufferInUse && size <= mBufferSize) {
+      mBufferInUse = true;
+      return mBuffer;
+    }
+    return mFallbackAllocator->allocate(size);
+  }
+
+  void deallocate(uint8_t *p, size_t size) override {
+    if (p == mBuffer) {
+      mBufferInUse = false;
+    } else {
+      mFallbackAllocator->deallocate(p, size);
+    }
+  }
+
+  //! @return The largest initial size of a FlatBufferBuilder whose first
+  //!     allocation is served from the fixed buffer.
+  size_t getMaxInitialBuilderSize() const {
+    // FlatBufferBuilder rounds its allocations up to its minimum alignment.
+    constexpr size_t kMinAlignment =
+        flatbuffers::AlignOf<flatbuffers::largest_scalar_t>();
+    return mBufferSize & ~(kMinAlignment - 1);
+  }
+
+ private:
+  uint8_t *const mBuffer;
+  const size_t mBufferSize;
+  flatbuffers::Allocator *const mFallbackAllocator;
+  bool mBufferInUse = false;
+};
+
 //! CHRE-specific FlatBufferBuilder that utilizes CHRE's allocator and adds
 //! additional helper methods that make use of CHRE utilities.
 class ChreFlatBufferBuilder : public flatbuffers::FlatBufferBuilder {
@@ -44,6 +91,15 @@ class ChreFlatBufferBuilder : public flatbuffers::FlatBufferBuilder {
   explicit ChreFlatBufferBuilder(size_t initialSize = 1024)
       : flatbuffers::FlatBufferBuilder(initialSize, &mAllocator) {}
 
+  /**
+   * Constructs a builder that gets its buffer from the given allocator, e.g.
+   * to reuse pooled or fixed buffers rather than allocating from the heap.
+   *
+   * @param allocator The allocator, which must outlive the builder.
+   */
+  ChreFlatBufferBuilder(size_t initialSize, flatbuffers::Allocator *allocator)
+      : flatbuffers::FlatBufferBuilder(initialSize, allocator) {}
+
   // This is defined in flatbuffers::FlatBufferBuilder, but must be further
   // defined here since template functions aren't inherited.
   template <typename T>
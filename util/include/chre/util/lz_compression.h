@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_LZ_COMPRESSION_H_
+#define CHRE_UTIL_LZ_COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+/**
+ * A small-footprint LZ77 compressor producing the LZ4 block format, so the
+ * output can be decompressed with lzDecompress() or any LZ4 block decoder.
+ *
+ * The compressor favors a low memory use over the compression ratio: matches
+ * are found through a single-entry hash table of kHashTableSize positions, and
+ * the input itself is used as the window, so no memory other than the hash
+ * table is needed. The input size is limited to kMaxInputSize so that the hash
+ * table can store 16-bit positions.
+ */
+class LzCompressor : public NonCopyable {
+ public:
+  //! The maximum size of an input buffer.
+  static constexpr size_t kMaxInputSize = UINT16_MAX;
+
+  /**
+   * Compresses a buffer.
+   *
+   * @param src The buffer to compress.
+   * @param srcSize The size of src, at most kMaxInputSize.
+   * @param dst The buffer to write the compressed data to.
+   * @param dstCapacity The size of dst.
+   * @return The size of the compressed data, or 0 if srcSize is 0, is larger
+   *     than kMaxInputSize, or if the compressed data does not fit in dst.
+   */
+  size_t compress(const uint8_t *src, size_t srcSize, uint8_t *dst,
+                  size_t dstCapacity);
+
+ private:
+  static constexpr uint32_t kHashBits = 9;
+  static constexpr size_t kHashTableSize = 1 << kHashBits;
+
+  //! Maps the hash of 4 bytes of input to the last position they were seen at.
+  uint16_t mHashTable[kHashTableSize];
+};
+
+/**
+ * Decompresses a buffer in the LZ4 block format, as produced by LzCompressor.
+ *
+ * @param src The compressed buffer.
+ * @param srcSize The size of src.
+ * @param dst The buffer to write the decompressed data to.
+ * @param dstCapacity The size of dst.
+ * @param decompressedSize Set to the size of the decompressed data on success.
+ * @return true if src was fully decompressed, false if it is malformed or if
+ *     the decompressed data does not fit in dst.
+ */
+bool lzDecompress(const uint8_t *src, size_t srcSize, uint8_t *dst,
+                  size_t dstCapacity, size_t *decompressedSize);
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_LZ_COMPRESSION_H_
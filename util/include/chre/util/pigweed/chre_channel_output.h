@@ -24,38 +24,191 @@
 #include "pw_rpc/channel.h"
 #include "pw_span/span.h"
 
+/**
+ * The number of message buffers that a nanoapp channel output keeps for reuse
+ * once their event has been consumed. Messages sent while all of them are in
+ * flight are allocated and freed with their event. A kept buffer is reused
+ * for messages that fit in it, else replaced by one of the size needed.
+ * This default value can be overridden in the variant-specific makefile.
+ */
+#ifndef CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE
+#define CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE 2
+#endif
+
 namespace chre {
 
 /**
  * Message format used for communicating between nanoapps since CHRE doesn't
  * have a standard format for this as part of the API definition.
+ *
+ * A message carries either a single RPC packet, as is, or a batch of packets.
+ * A batch starts with a 0 byte, which can't start an RPC packet, and the
+ * version of the batch format, 1. Each of its packets follows, preceded by its
+ * size as a uint16_t in the native byte order. Use getNextNanoappPacket() to
+ * read the packets of either kind of message.
+ *
+ * Nanoapps built with an older version of this util only read single packets,
+ * so batches are only sent to a nanoapp that sent one, see
+ * isNanoappMessageBatch().
  */
 struct ChrePigweedNanoappMessage {
+  //! The size of msg.
   size_t msgSize;
   uint8_t msg[];
 };
 
+/**
+ * Reads the next RPC packet of a nanoapp message.
+ *
+ * @param message The message received from a nanoapp.
+ * @param offset The offset of the packet in message.msg, 0 for the first one.
+ *        Updated to the offset of the following packet.
+ * @param packet Set to the packet on success.
+ * @return false at the end of the message or if it is malformed.
+ */
+bool getNextNanoappPacket(const ChrePigweedNanoappMessage &message,
+                          size_t *offset, pw::span<const std::byte> *packet);
+
+/**
+ * @param message The message received from a nanoapp.
+ * @return whether the message is a batch, which tells that the sending
+ *         nanoapp can read batches too.
+ */
+bool isNanoappMessageBatch(const ChrePigweedNanoappMessage &message);
+
+/**
+ * Base class of the channel outputs between two nanoapps.
+ *
+ * The packets are copied into message buffers sized to their contents, that
+ * are reused once the receiving nanoapp has consumed their event, so that
+ * sending a packet does not allocate memory in the steady state.
+ *
+ * Between startBatch() and flushBatch(), the packets sent to the same nanoapp
+ * are appended to a single batch message, sent when it is full or flushed.
+ * This lets a nanoapp issue or answer many RPCs with a handful of events. A
+ * batch of a single packet is sent as that packet. Batches must only be sent
+ * to nanoapps that read them.
+ */
+class ChreNanoappChannelOutput : public pw::rpc::ChannelOutput {
+ public:
+  /**
+   * Frees the buffers of the pool, the ones in flight being freed with their
+   * event. Buffered packets are dropped.
+   *
+   * Must be called from the nanoapp end.
+   */
+  void releaseBuffers();
+
+  /**
+   * Starts buffering the packets sent over this channel output. Batches can be
+   * nested, the packets being sent by the outermost flushBatch().
+   */
+  void startBatch();
+
+  /**
+   * Ends a batch started by startBatch(), sending the buffered packets at the
+   * end of the outermost batch.
+   *
+   * @return The status of sending the last buffered message.
+   */
+  pw::Status flushBatch();
+
+  size_t MaximumTransmissionUnit() override;
+
+  pw::Status Send(pw::span<const std::byte> buffer) override;
+
+ protected:
+  /**
+   * @param eventType The event type of the messages sent over this output.
+   */
+  explicit ChreNanoappChannelOutput(uint16_t eventType)
+      : ChannelOutput("CHRE"), mEventType(eventType) {}
+
+  /**
+   * Sets the nanoapp that packets are sent to. The packets buffered for the
+   * previous nanoapp are sent first.
+   *
+   * @return The status of sending the buffered packets.
+   */
+  pw::Status setTarget(uint32_t instanceId);
+
+ private:
+  struct MessageBuffer;
+
+  static void freeMessageCallback(uint16_t eventType, void *eventData);
+
+  /**
+   * @param capacity The room needed for the contents of the message.
+   * @param owner The output the buffer returns to, nullptr if not pooled.
+   * @return A new buffer, nullptr if out of memory.
+   */
+  static MessageBuffer *allocateBuffer(size_t capacity,
+                                       ChreNanoappChannelOutput *owner);
+
+  /**
+   * @param capacity The room needed for the contents of the message.
+   * @return An unused message buffer from the pool, or an allocated one if all
+   *         of them are in flight, nullptr if out of memory.
+   */
+  MessageBuffer *acquireBuffer(size_t capacity);
+
+  /**
+   * Returns a buffer whose event has been freed to the pool.
+   */
+  void releaseBuffer(MessageBuffer *buffer);
+
+  /**
+   * Sends the pending message, if any.
+   */
+  pw::Status sendPendingMessage();
+
+  /**
+   * Sends a message to the target nanoapp. The buffer is released when its
+   * event is freed, including when it fails to be sent.
+   */
+  pw::Status sendMessage(MessageBuffer *buffer);
+
+  const uint16_t mEventType;
+  uint16_t mTargetInstanceId = 0;
+
+  //! The depth of nested batches, packets are sent immediately when 0.
+  uint8_t mBatchDepth = 0;
+
+  //! The batch being filled, nullptr when no packets are buffered.
+  MessageBuffer *mPendingBuffer = nullptr;
+
+  //! The number of packets of the pending batch.
+  size_t mNumPendingPackets = 0;
+
+  //! The buffers of the pool, allocated the first time they are needed.
+  MessageBuffer *mBuffers[CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE] = {};
+
+  //! Whether each buffer of the pool is pending or in flight.
+  bool mBufferInUse[CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE] = {};
+};
+
 /**
  * Channel output that must be used on the server side of the channel between
  * two nanoapps.
  */
-class ChreServerNanoappChannelOutput : public pw::rpc::ChannelOutput {
+class ChreServerNanoappChannelOutput : public ChreNanoappChannelOutput {
  public:
   explicit ChreServerNanoappChannelOutput(RpcPermission &permission)
-      : ChannelOutput("CHRE"), mPermission(permission) {}
+      : ChreNanoappChannelOutput(CHRE_EVENT_RPC_RESPONSE),
+        mPermission(permission) {}
 
   /**
    * Sets the nanoapp instance ID that is being communicated with over this
    * channel output.
+   *
+   * @return The status of sending the responses buffered for the previous
+   *         client.
    */
-  void setClient(uint32_t nanoappInstanceId);
-
-  size_t MaximumTransmissionUnit() override;
+  pw::Status setClient(uint32_t nanoappInstanceId);
 
   pw::Status Send(pw::span<const std::byte> buffer) override;
 
  private:
-  uint16_t mClientInstanceId = 0;
   RpcPermission &mPermission;
 };
 
@@ -63,9 +216,10 @@ class ChreServerNanoappChannelOutput : public pw::rpc::ChannelOutput {
  * Channel output that must be used on the client side of the channel between
  * two nanoapps.
  */
-class ChreClientNanoappChannelOutput : public pw::rpc::ChannelOutput {
+class ChreClientNanoappChannelOutput : public ChreNanoappChannelOutput {
  public:
-  ChreClientNanoappChannelOutput() : ChannelOutput("CHRE") {}
+  ChreClientNanoappChannelOutput()
+      : ChreNanoappChannelOutput(CHRE_EVENT_RPC_REQUEST) {}
 
   /**
    * Sets the server instance ID.
@@ -73,15 +227,10 @@ class ChreClientNanoappChannelOutput : public pw::rpc::ChannelOutput {
    * This method must only be called for clients.
    *
    * @param instanceId The instance ID of the server.
+   * @return The status of sending the requests buffered for the previous
+   *         server.
    */
-  void setServer(uint32_t instanceId);
-
-  size_t MaximumTransmissionUnit() override;
-
-  pw::Status Send(pw::span<const std::byte> buffer) override;
-
- private:
-  uint16_t mServerInstanceId = 0;
+  pw::Status setServer(uint32_t instanceId);
 };
 
 /**
@@ -83,6 +83,23 @@ class RpcClient : public NonCopyable {
    */
   bool hasService(uint64_t id, uint32_t version);
 
+  /**
+   * Starts buffering the requests to the server, so that the requests issued
+   * until flushBatch() share as few events as possible. Only use it for
+   * servers that read batches: the responses are then batched too.
+   *
+   * Batches can be nested, the requests being sent by the outermost
+   * flushBatch().
+   */
+  void startBatch();
+
+  /**
+   * Ends a batch started by startBatch().
+   *
+   * @return whether the buffered requests were sent successfully.
+   */
+  bool flushBatch();
+
   /**
    * Must be called from nanoapp end.
    */
@@ -127,8 +144,8 @@ Optional<T> RpcClient::get() {
     }
 
     mChannelId = chreGetInstanceId();
-    mChannelOutput.setServer(info.instanceId);
-    if (!mRpcClient.OpenChannel(mChannelId, mChannelOutput).ok()) {
+    if (!mChannelOutput.setServer(info.instanceId).ok() ||
+        !mRpcClient.OpenChannel(mChannelId, mChannelOutput).ok()) {
       return Optional<T>();
     }
   }
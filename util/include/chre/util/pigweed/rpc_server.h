@@ -95,12 +95,31 @@ class RpcServer : public NonCopyable {
    */
   void setPermissionForNextMessage(uint32_t permission);
 
+  /**
+   * Starts buffering the responses to nanoapp clients, so that the responses
+   * sent until flushBatch() share as few events as possible. Only use it for
+   * clients that read batches. handleEvent() already batches the responses to
+   * the requests of a batch.
+   *
+   * Batches can be nested, the responses being sent by the outermost
+   * flushBatch().
+   */
+  void startBatch();
+
+  /**
+   * Ends a batch started by startBatch().
+   *
+   * @return whether the buffered responses were sent successfully.
+   */
+  bool flushBatch();
+
   /**
    * Handles events related to RPC services.
    *
    * Handles the following events:
    * - CHRE_EVENT_MESSAGE_FROM_HOST: respond to host RPC requests,
-   * - CHRE_EVENT_RPC_REQUEST: respond to nanoapp RPC requests,
+   * - CHRE_EVENT_RPC_REQUEST: respond to nanoapp RPC requests, the responses
+   *   being batched if the requests were,
    * - CHRE_EVENT_HOST_ENDPOINT_NOTIFICATION: close the channel when the host
    *   terminates,
    * - CHRE_EVENT_NANOAPP_STOPPED: close the channel when a nanoapp
@@ -141,11 +160,21 @@ class RpcServer : public NonCopyable {
    * event.
    *
    * @param eventData  The associated data, if any.
-   * @return whether the RPC was handled successfully.
+   * @return whether the RPCs were handled successfully.
    */
   bool handleMessageFromNanoapp(uint32_t senderInstanceId,
                                 const void *eventData);
 
+  /**
+   * Handles one of the packets of a message from a nanoapp client.
+   *
+   * @param senderInstanceId The Instance ID of the client.
+   * @param packet The RPC packet.
+   * @return whether the RPC was handled successfully.
+   */
+  bool handleNanoappPacket(uint32_t senderInstanceId,
+                           pw::span<const std::byte> packet);
+
   /**
    * Closes the Pigweed channel when a host client disconnects.
    *
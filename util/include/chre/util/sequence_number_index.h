@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_SEQUENCE_NUMBER_INDEX_H_
+#define CHRE_UTIL_SEQUENCE_NUMBER_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+/**
+ * A fixed-capacity hash index from 32-bit sequence numbers (e.g. transaction
+ * IDs or message sequence numbers) to values, typically the location of the
+ * record holding that sequence number in another container. This allows
+ * finding the record in O(1) instead of scanning the container.
+ *
+ * Sequence numbers are usually consecutive, so they are spread over the table
+ * with Fibonacci hashing. Collisions are resolved by linear probing, and
+ * erase() shifts the following entries back instead of leaving tombstones, so
+ * lookups do not degrade as entries come and go. The table has at least twice
+ * as many slots as entries, which keeps the probe sequences short.
+ *
+ * Several entries may have the same sequence number (e.g. the same number used
+ * by different host endpoints). find() takes a matcher to tell them apart.
+ * The values may be modified in place, but the sequence numbers may not.
+ *
+ * @tparam kMaxEntries The maximum number of entries in the index.
+ * @tparam ValueType The type of the values, which must be default
+ *     constructible, copyable and equality comparable.
+ */
+template <size_t kMaxEntries, typename ValueType = uint16_t>
+class SequenceNumberIndex : public NonCopyable {
+ public:
+  static_assert(kMaxEntries > 0 && kMaxEntries <= (UINT32_C(1) << 30),
+                "Invalid number of entries");
+
+  /**
+   * Adds an entry to the index.
+   *
+   * @return false if the index is full.
+   */
+  bool insert(uint32_t sequenceNumber, const ValueType &value) {
+    if (mSize == kMaxEntries) {
+      return false;
+    }
+    size_t i = homeSlot(sequenceNumber);
+    while (mSlots[i].used) {
+      i = (i + 1) & kSlotMask;
+    }
+    mSlots[i].sequenceNumber = sequenceNumber;
+    mSlots[i].value = value;
+    mSlots[i].used = true;
+    mSize++;
+    return true;
+  }
+
+  /**
+   * Finds the first entry with a sequence number for which the matcher
+   * returns true.
+   *
+   * @param matcher Called with the value of each entry with the sequence
+   *     number, as bool(const ValueType &).
+   * @return The value of the entry, or nullptr if none matched.
+   */
+  template <typename Matcher>
+  const ValueType *find(uint32_t sequenceNumber, Matcher matcher) const {
+    for (size_t i = homeSlot(sequenceNumber); mSlots[i].used;
+         i = (i + 1) & kSlotMask) {
+      if (mSlots[i].sequenceNumber == sequenceNumber &&
+          matcher(mSlots[i].value)) {
+        return &mSlots[i].value;
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename Matcher>
+  ValueType *find(uint32_t sequenceNumber, Matcher matcher) {
+    return const_cast<ValueType *>(
+        static_cast<const SequenceNumberIndex *>(this)->find(sequenceNumber,
+                                                             matcher));
+  }
+
+  /**
+   * @return The value of the first entry with a sequence number, or nullptr
+   *     if there is none.
+   */
+  const ValueType *find(uint32_t sequenceNumber) const {
+    return find(sequenceNumber, [](const ValueType &) { return true; });
+  }
+
+  ValueType *find(uint32_t sequenceNumber) {
+    return find(sequenceNumber, [](const ValueType &) { return true; });
+  }
+
+  /**
+   * Removes the entry with a sequence number and value.
+   *
+   * @return false if there was no such entry.
+   */
+  bool erase(uint32_t sequenceNumber, const ValueType &value) {
+    size_t i = homeSlot(sequenceNumber);
+    while (mSlots[i].used && (mSlots[i].sequenceNumber != sequenceNumber ||
+                              !(mSlots[i].value == value))) {
+      i = (i + 1) & kSlotMask;
+    }
+    if (!mSlots[i].used) {
+      return false;
+    }
+
+    // Moves back the following entries of the probe sequence that would not
+    // be found anymore once slot i is empty.
+    for (size_t j = (i + 1) & kSlotMask; mSlots[j].used;
+         j = (j + 1) & kSlotMask) {
+      size_t home = homeSlot(mSlots[j].sequenceNumber);
+      bool homeInRange =
+          (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+      if (!homeInRange) {
+        mSlots[i] = mSlots[j];
+        i = j;
+      }
+    }
+    mSlots[i].used = false;
+    mSize--;
+    return true;
+  }
+
+  /**
+   * Removes all the entries.
+   */
+  void clear() {
+    for (Slot &slot : mSlots) {
+      slot.used = false;
+    }
+    mSize = 0;
+  }
+
+  size_t size() const {
+    return mSize;
+  }
+
+  bool full() const {
+    return mSize == kMaxEntries;
+  }
+
+ private:
+  //! The number of slots: the smallest power of two that is at least twice
+  //! the number of entries.
+  static constexpr size_t kNumSlots = [] {
+    size_t numSlots = 2;
+    while (numSlots < 2 * kMaxEntries) {
+      numSlots *= 2;
+    }
+    return numSlots;
+  }();
+  static constexpr size_t kSlotMask = kNumSlots - 1;
+  static constexpr uint32_t kSlotBits = [] {
+    uint32_t bits = 0;
+    while ((size_t{1} << bits) < kNumSlots) {
+      bits++;
+    }
+    return bits;
+  }();
+
+  struct Slot {
+    uint32_t sequenceNumber = 0;
+    ValueType value{};
+    bool used = false;
+  };
+
+  static size_t homeSlot(uint32_t sequenceNumber) {
+    // The top bits of the product by 2^32 / phi, which spreads consecutive
+    // numbers evenly over the table.
+    return (sequenceNumber * UINT32_C(2654435769)) >> (32 - kSlotBits);
+  }
+
+  Slot mSlots[kNumSlots];
+  size_t mSize = 0;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_SEQUENCE_NUMBER_INDEX_H_
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_SYMBOL_INDEX_H_
+#define CHRE_UTIL_SYMBOL_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+/**
+ * An index over tables of named entries (e.g. the symbols exported to
+ * nanoapps), allowing a lookup by name in O(log n) instead of a linear scan
+ * of the tables.
+ *
+ * The index holds the hash of each name, sorted, along with a pointer to the
+ * entry. A lookup binary searches the hash of the name and only compares the
+ * strings of the entries with the same hash.
+ *
+ * @tparam Entry The type of the entries, which must have a null-terminated
+ *     const char *dataName member.
+ * @tparam kCapacity The maximum number of entries in the index.
+ */
+template <typename Entry, size_t kCapacity>
+class SymbolIndex : public NonCopyable {
+ public:
+  /**
+   * Computes the 32-bit FNV-1a hash of a null-terminated name. This is
+   * constexpr so the hash of known names can be computed at compile time.
+   */
+  static constexpr uint32_t hashName(const char *name) {
+    uint32_t hash = UINT32_C(2166136261);
+    while (*name != '\0') {
+      hash = (hash ^ static_cast<uint8_t>(*name++)) * UINT32_C(16777619);
+    }
+    return hash;
+  }
+
+  /**
+   * Adds a table of entries to the index. If several entries share a name,
+   * find() returns the one that was added first, as a linear scan of the
+   * tables in the order they were added would.
+   *
+   * @param entries The entries, which must outlive the index.
+   * @param count The number of entries.
+   * @return false if the index does not have the capacity for all the entries,
+   *     in which case it is left unchanged.
+   */
+  bool add(const Entry *entries, size_t count) {
+    if (count > kCapacity - mSize) {
+      return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      // Insertion sort, stable so that duplicate names keep their order. The
+      // index is only built once, so the quadratic cost does not matter.
+      Slot slot = {hashName(entries[i].dataName), &entries[i]};
+      size_t j = mSize++;
+      while (j > 0 && mSlots[j - 1].hash > slot.hash) {
+        mSlots[j] = mSlots[j - 1];
+        j--;
+      }
+      mSlots[j] = slot;
+    }
+    return true;
+  }
+
+  /**
+   * @param name The null-terminated name to find.
+   * @return The first entry added with this name, or nullptr if none.
+   */
+  const Entry *find(const char *name) const {
+    uint32_t hash = hashName(name);
+
+    size_t low = 0;
+    size_t high = mSize;
+    while (low < high) {
+      size_t mid = low + (high - low) / 2;
+      if (mSlots[mid].hash < hash) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+
+    for (size_t i = low; i < mSize && mSlots[i].hash == hash; i++) {
+      if (strcmp(mSlots[i].entry->dataName, name) == 0) {
+        return mSlots[i].entry;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @return The number of entries in the index.
+   */
+  size_t size() const {
+    return mSize;
+  }
+
+ private:
+  struct Slot {
+    uint32_t hash;
+    const Entry *entry;
+  };
+
+  //! The entries sorted by the hash of their name.
+  Slot mSlots[kCapacity];
+
+  //! The number of valid entries in mSlots.
+  size_t mSize = 0;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_SYMBOL_INDEX_H_
@@ -17,10 +17,12 @@
 #ifndef CHRE_UTIL_SYNCHRONIZED_EXPANDABLE_MEMORY_POOL_H_
 #define CHRE_UTIL_SYNCHRONIZED_EXPANDABLE_MEMORY_POOL_H_
 
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/platform/atomic.h"
 #include "chre/platform/mutex.h"
-#include "chre/util/fixed_size_vector.h"
-#include "chre/util/memory_pool.h"
-#include "chre/util/unique_ptr.h"
+#include "chre/util/non_copyable.h"
 
 namespace chre {
 
@@ -33,6 +35,16 @@ namespace chre {
  * thrashing. These properties lead to a lower memory usage in average time and
  * also prevents heap fragmentation.
  *
+ * Allocations and deallocations do not take a lock unless a block needs to be
+ * added or removed:
+ * - Each block keeps its free slots in a lock-free list. Its head holds the
+ *   number of free slots and a counter incremented by every update to avoid
+ *   the ABA problem, so it is updated with a single compare-and-swap.
+ * - The lowest block that may have a free slot is cached, so allocations
+ *   start probing the blocks from there.
+ * - The block of a deallocated element is found by comparing its address
+ *   with the blocks, which takes no memory per element.
+ *
  * @tparam ElementType the element to store in ths expandable memory pool.
  * @tparam kMemoryPoolSize the size of each element pool (each block).
  * @tparam kMaxMemoryPoolCount the maximum number of memory blocks.
@@ -40,8 +52,11 @@ namespace chre {
 template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 class SynchronizedExpandableMemoryPool : public NonCopyable {
-  using Block = ::chre::MemoryPool<ElementType, kMemoryPoolSize>;
   static_assert(kMemoryPoolSize > 0);
+  // The head of the free list packs a slot index and the number of free slots
+  // in 10 bits each.
+  static_assert(kMemoryPoolSize < 0x3ff);
+  static_assert(kMaxMemoryPoolCount > 0);
 
  public:
   /**
@@ -55,10 +70,12 @@ class SynchronizedExpandableMemoryPool : public NonCopyable {
    */
   SynchronizedExpandableMemoryPool(size_t staticBlockCount = 1);
 
+  ~SynchronizedExpandableMemoryPool();
+
   /**
    * Allocates space for an object, constructs it and returns the pointer to
-   * that object. This method is thread-safe and a lock will be acquired
-   * upon entry to this method.
+   * that object. This method is thread-safe and only acquires a lock if a new
+   * block needs to be allocated.
    *
    * @param  The arguments to be forwarded to the constructor of the object.
    * @return A pointer to a constructed object or nullptr if the allocation
@@ -71,7 +88,7 @@ class SynchronizedExpandableMemoryPool : public NonCopyable {
    * Releases the memory of a previously allocated element. The pointer provided
    * here must be one that was produced by a previous call to the allocate()
    * function. The destructor is invoked on the object. This method is
-   * thread-safe and a lock will be acquired upon entry to this method.
+   * thread-safe and only acquires a lock if a block may need to be released.
    *
    * @param A pointer to an element that was previously allocated by the
    *        allocate() function.
@@ -94,28 +111,130 @@ class SynchronizedExpandableMemoryPool : public NonCopyable {
   inline bool full();
 
  private:
+  struct Block;
+
+  //! The storage of an element. A pointer to an element is also a pointer to
+  //! its slot.
+  union Slot {
+    alignas(ElementType) uint8_t element[sizeof(ElementType)];
+    //! The index of the next free slot while this slot is free.
+    uint16_t nextFreeSlot;
+  };
+
+  struct Block : public NonCopyable {
+    Block();
+
+    /**
+     * Pops a free slot from the free list.
+     *
+     * @return the slot or nullptr if the block is full.
+     */
+    Slot *pop();
+
+    /**
+     * Pushes a slot on the free list.
+     *
+     * @return the number of free slots after pushing.
+     */
+    uint32_t push(Slot *slot);
+
+    /**
+     * @return the number of free slots.
+     */
+    uint32_t getFreeSlotCount() const {
+      return (freeListHead.load() >> kCountShift) & kIndexMask;
+    }
+
+    Slot slots[kMemoryPoolSize];
+    //! The index of the first free slot in bits 0-9, the number of free slots
+    //! in bits 10-19, and a counter incremented by every update in bits 20-31.
+    //!
+    //! The count alone does not prevent the ABA problem: while a pop is between
+    //! reading the head and exchanging it, other threads can pop the head and
+    //! its next slot, then push an allocated slot and the head back. The head
+    //! and count are unchanged but the next slot is now allocated. With the
+    //! counter, the exchange only succeeds wrongly if exactly a multiple of
+    //! 4096 updates happen in that window of a few instructions.
+    AtomicUint32 freeListHead;
+  };
+
+  static constexpr uint32_t kIndexMask = 0x3ff;
+  static constexpr uint32_t kCountShift = 10;
+  static constexpr uint32_t kTagShift = 20;
+
+  //! The index of the head of an empty free list.
+  static constexpr uint32_t kNoFreeSlot = kIndexMask;
+
   //! Number of blocks that will be allocate in the beginning and will only be
   //! deallocate by the destructor.
   const size_t kStaticBlockCount;
 
-  //! Number of elements that this memory pool currently hold.
-  size_t mSize = 0;
-
-  //! The mutex used to guard access to this memory pool.
+  //! The mutex used to guard adding and removing blocks.
   Mutex mMutex;
 
-  //! A fixed sized container that wraps around non-synchronized
-  //! MemoryPools used to implement this thread-safe and expandable version
-  //! version.
-  FixedSizeVector<UniquePtr<Block>, kMaxMemoryPoolCount> mMemoryPoolPtrs;
+  //! The blocks, of which the first mBlockCount are used for allocations.
+  Block *mBlocks[kMaxMemoryPoolCount] = {};
+
+  //! The number of blocks allocations are made from.
+  AtomicUint32 mBlockCount{0};
+
+  //! The lowest index of a block that may have a free slot. It may be raised
+  //! past a block whose slot is freed concurrently, so the blocks below it are
+  //! scanned before an allocation fails.
+  AtomicUint32 mFirstFreeBlockHint{0};
+
+  //! The number of allocations in progress. A block is only released if no
+  //! allocation is in progress, as an allocation may still be accessing it.
+  AtomicUint32 mActiveAllocations{0};
 
   /**
-   * Push one memory pool to the end of the vector.
+   * Tries to allocate a slot from the blocks allocations are made from.
+   *
+   * @return the slot or nullptr if all the blocks are full.
+   */
+  Slot *allocateSlot();
+
+  /**
+   * Pops a free slot from the blocks in [begin, end).
+   *
+   * @return the slot or nullptr if these blocks are full.
+   */
+  Slot *allocateSlotFromBlocks(uint32_t begin, uint32_t end);
+
+  /**
+   * @return true if a block allocations are made from has a free slot. Must be
+   *     called with mMutex held.
+   */
+  bool hasFreeSlot();
+
+  /**
+   * Finds the index of the block containing a slot. The block of an allocated
+   * slot is not released, so its entry in mBlocks is stable.
+   *
+   * @return the index of the block, or kMaxMemoryPoolCount if the slot is not
+   *     from this pool.
+   */
+  uint32_t findBlockIndex(const Slot *slot) const;
+
+  /**
+   * Push one memory pool to the end of the vector. Must be called with mMutex
+   * held.
    *
    * @return true if a new memory pool can be allocated.
    */
   bool pushOneBlock();
 
+  /**
+   * Releases the trailing empty blocks, keeping one if the previous block is
+   * more than half full to avoid thrashing. Must be called with mMutex held.
+   */
+  void releaseEmptyBlocks();
+
+  /**
+   * Lowers mFirstFreeBlockHint to the given block index if needed.
+   */
+  void lowerFirstFreeBlockHint(uint32_t index);
+
   /**
    * @return true if this block is more than half full.
    */
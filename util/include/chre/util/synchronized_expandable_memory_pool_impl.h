@@ -19,13 +19,68 @@
 
 // IWYU pragma: private
 #include <algorithm>
+#include <new>
+#include <utility>
 
+#include "chre/platform/assert.h"
+#include "chre/platform/log.h"
 #include "chre/util/lock_guard.h"
-#include "chre/util/memory_pool.h"
+#include "chre/util/memory.h"
 #include "chre/util/synchronized_expandable_memory_pool.h"
 
 namespace chre {
 
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                 kMaxMemoryPoolCount>::Block::Block()
+    : freeListHead(kMemoryPoolSize << kCountShift) {
+  for (size_t i = 0; i < kMemoryPoolSize; i++) {
+    slots[i].nextFreeSlot =
+        static_cast<uint16_t>((i + 1 < kMemoryPoolSize) ? i + 1 : kNoFreeSlot);
+  }
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+typename SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                          kMaxMemoryPoolCount>::Slot *
+SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                 kMaxMemoryPoolCount>::Block::pop() {
+  uint32_t head = freeListHead.load();
+  while (true) {
+    uint32_t slotIndex = head & kIndexMask;
+    if (slotIndex == kNoFreeSlot) {
+      return nullptr;
+    }
+    // The next index may be stale if another thread popped this slot in the
+    // meantime, in which case the tag has changed and the exchange fails.
+    uint32_t next = slots[slotIndex].nextFreeSlot;
+    uint32_t count = ((head >> kCountShift) & kIndexMask) - 1;
+    uint32_t tag = (head >> kTagShift) + 1;
+    if (freeListHead.compare_exchange(
+            head, (tag << kTagShift) | (count << kCountShift) | next)) {
+      return &slots[slotIndex];
+    }
+  }
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+uint32_t SynchronizedExpandableMemoryPool<
+    ElementType, kMemoryPoolSize, kMaxMemoryPoolCount>::Block::push(Slot *slot) {
+  uint32_t slotIndex = static_cast<uint32_t>(slot - slots);
+  uint32_t head = freeListHead.load();
+  uint32_t count;
+  do {
+    slot->nextFreeSlot = static_cast<uint16_t>(head & kIndexMask);
+    count = ((head >> kCountShift) & kIndexMask) + 1;
+  } while (!freeListHead.compare_exchange(
+      head, (((head >> kTagShift) + 1) << kTagShift) | (count << kCountShift) |
+                slotIndex));
+  return count;
+}
+
 template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
@@ -34,37 +89,52 @@ SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
     : kStaticBlockCount(staticBlockCount) {
   CHRE_ASSERT(staticBlockCount > 0);
   CHRE_ASSERT(kMaxMemoryPoolCount >= staticBlockCount);
+  LockGuard<Mutex> lock(mMutex);
   for (uint8_t i = 0; i < kStaticBlockCount; i++) {
     pushOneBlock();
   }
 }
 
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                 kMaxMemoryPoolCount>::
+    ~SynchronizedExpandableMemoryPool() {
+  // As for MemoryPool, elements that were not deallocated are not destroyed.
+  for (Block *block : mBlocks) {
+    if (block != nullptr) {
+      memoryFreeAndDestroy(block);
+    }
+  }
+}
+
 template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 template <typename... Args>
 ElementType *SynchronizedExpandableMemoryPool<
     ElementType, kMemoryPoolSize,
     kMaxMemoryPoolCount>::allocate(Args &&...args) {
-  LockGuard<Mutex> lock(mMutex);
-  ElementType *result = nullptr;
-
-  // TODO(b/259286151): Optimizing using pointer to a non-full block
-  for (UniquePtr<Block> &memoryPool : mMemoryPoolPtrs) {
-    result = memoryPool->allocate(args...);
-    if (result != nullptr) {
-      break;
+  // Blocks are not released while an allocation is in progress.
+  mActiveAllocations.fetch_increment();
+  Slot *slot = allocateSlot();
+  if (slot == nullptr) {
+    LockGuard<Mutex> lock(mMutex);
+    // Another thread may have added a block or released slots meanwhile. A
+    // scan misses the slots released behind it, so it is retried until no
+    // block has a free slot before adding a block.
+    slot = allocateSlot();
+    while (slot == nullptr && hasFreeSlot()) {
+      slot = allocateSlot();
+    }
+    if (slot == nullptr && pushOneBlock()) {
+      slot = mBlocks[mBlockCount.load() - 1]->pop();
     }
   }
+  mActiveAllocations.fetch_decrement();
 
-  if (result == nullptr && pushOneBlock()) {
-    result = mMemoryPoolPtrs.back()->allocate(args...);
-  }
-
-  if (result != nullptr) {
-    ++mSize;
-  }
-
-  return result;
+  return (slot == nullptr)
+             ? nullptr
+             : new (slot->element) ElementType(std::forward<Args>(args)...);
 }
 
 template <typename ElementType, size_t kMemoryPoolSize,
@@ -72,25 +142,28 @@ template <typename ElementType, size_t kMemoryPoolSize,
 void SynchronizedExpandableMemoryPool<
     ElementType, kMemoryPoolSize,
     kMaxMemoryPoolCount>::deallocate(ElementType *element) {
-  bool success = false;
-  LockGuard<Mutex> lock(mMutex);
-  for (UniquePtr<Block> &memoryPool : mMemoryPoolPtrs) {
-    if (memoryPool->containsAddress(element)) {
-      success = true;
-      memoryPool->deallocate(element);
-      break;
-    }
-  }
-  if (!success) {
+  Slot *slot = reinterpret_cast<Slot *>(element);
+  uint32_t blockIndex = findBlockIndex(slot);
+  if (blockIndex == kMaxMemoryPoolCount) {
+    LOGE("Invalid pointer to deallocate");
     CHRE_ASSERT(false);
-  } else {
-    --mSize;
-    while (
-        mMemoryPoolPtrs.size() > std::max(kStaticBlockCount, size_t(1)) &&
-        mMemoryPoolPtrs.back()->empty() &&
-        !isHalfFullBlock(mMemoryPoolPtrs[mMemoryPoolPtrs.size() - 2].get())) {
-      mMemoryPoolPtrs.pop_back();
-    }
+    return;
+  }
+  Block *block = mBlocks[blockIndex];
+
+  element->~ElementType();
+  // The block may be released once the slot is pushed, it must not be
+  // accessed afterwards.
+  uint32_t freeSlotCount = block->push(slot);
+  lowerFirstFreeBlockHint(blockIndex);
+
+  // Releasing blocks is only possible if the last block became empty or the
+  // one before became less than half full.
+  uint32_t blockCount = mBlockCount.load();
+  if (blockCount > std::max(kStaticBlockCount, size_t(1)) &&
+      blockIndex + 2 >= blockCount && freeSlotCount >= kMemoryPoolSize / 2) {
+    LockGuard<Mutex> lock(mMutex);
+    releaseEmptyBlocks();
   }
 }
 
@@ -98,24 +171,95 @@ template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 size_t SynchronizedExpandableMemoryPool<
     ElementType, kMemoryPoolSize, kMaxMemoryPoolCount>::getFreeSpaceCount() {
+  size_t freeSpaceCount = kMaxMemoryPoolCount * kMemoryPoolSize;
   LockGuard<Mutex> lock(mMutex);
-  return kMaxMemoryPoolCount * kMemoryPoolSize - mSize;
+  for (uint32_t i = 0; i < mBlockCount.load(); i++) {
+    freeSpaceCount -= kMemoryPoolSize - mBlocks[i]->getFreeSlotCount();
+  }
+  return freeSpaceCount;
 }
 
 template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 bool SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
                                       kMaxMemoryPoolCount>::full() {
-  LockGuard<Mutex> lock(mMutex);
-  return kMaxMemoryPoolCount * kMemoryPoolSize == mSize;
+  return getFreeSpaceCount() == 0;
 }
 
 template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 size_t SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
                                         kMaxMemoryPoolCount>::getBlockCount() {
-  LockGuard<Mutex> lock(mMutex);
-  return mMemoryPoolPtrs.size();
+  return mBlockCount.load();
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+typename SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                          kMaxMemoryPoolCount>::Slot *
+SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                 kMaxMemoryPoolCount>::allocateSlot() {
+  // The lower blocks are filled first so that the last blocks can be released.
+  uint32_t blockCount = mBlockCount.load();
+  uint32_t hint = mFirstFreeBlockHint.load();
+  uint32_t begin = std::min(hint, blockCount);
+  for (uint32_t i = begin; i < blockCount; i++) {
+    Slot *slot = mBlocks[i]->pop();
+    if (slot != nullptr) {
+      if (i != hint) {
+        // The blocks before this one were full. A slot may have been freed in
+        // one of them since, leaving the hint too high until a deallocation
+        // lowers it again.
+        mFirstFreeBlockHint.compare_exchange(hint, i);
+      }
+      return slot;
+    }
+  }
+
+  // The hint may be above a block whose slot was freed concurrently.
+  return allocateSlotFromBlocks(0, begin);
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+typename SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                          kMaxMemoryPoolCount>::Slot *
+SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                 kMaxMemoryPoolCount>::
+    allocateSlotFromBlocks(uint32_t begin, uint32_t end) {
+  Slot *slot = nullptr;
+  for (uint32_t i = begin; i < end && slot == nullptr; i++) {
+    slot = mBlocks[i]->pop();
+  }
+  return slot;
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+bool SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
+                                      kMaxMemoryPoolCount>::hasFreeSlot() {
+  uint32_t blockCount = mBlockCount.load();
+  for (uint32_t i = 0; i < blockCount; i++) {
+    if (mBlocks[i]->getFreeSlotCount() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+uint32_t SynchronizedExpandableMemoryPool<
+    ElementType, kMemoryPoolSize,
+    kMaxMemoryPoolCount>::findBlockIndex(const Slot *slot) const {
+  for (uint32_t i = 0; i < kMaxMemoryPoolCount; i++) {
+    const Block *block = mBlocks[i];
+    if (block != nullptr && block->slots <= slot &&
+        slot < block->slots + kMemoryPoolSize) {
+      return i;
+    }
+  }
+  return kMaxMemoryPoolCount;
 }
 
 template <typename ElementType, size_t kMemoryPoolSize,
@@ -123,11 +267,12 @@ template <typename ElementType, size_t kMemoryPoolSize,
 bool SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
                                       kMaxMemoryPoolCount>::pushOneBlock() {
   bool success = false;
-  if (mMemoryPoolPtrs.size() < kMaxMemoryPoolCount) {
-    auto newBlock = MakeUnique<Block>();
-    if (!newBlock.isNull()) {
+  uint32_t blockCount = mBlockCount.load();
+  if (blockCount < kMaxMemoryPoolCount) {
+    mBlocks[blockCount] = memoryAlloc<Block>();
+    if (mBlocks[blockCount] != nullptr) {
       success = true;
-      mMemoryPoolPtrs.push_back(std::move(newBlock));
+      mBlockCount.store(blockCount + 1);
     }
   }
 
@@ -138,13 +283,46 @@ bool SynchronizedExpandableMemoryPool<ElementType, kMemoryPoolSize,
   return success;
 }
 
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+void SynchronizedExpandableMemoryPool<
+    ElementType, kMemoryPoolSize, kMaxMemoryPoolCount>::releaseEmptyBlocks() {
+  uint32_t blockCount = mBlockCount.load();
+  while (blockCount > std::max(kStaticBlockCount, size_t(1)) &&
+         mBlocks[blockCount - 1]->getFreeSlotCount() == kMemoryPoolSize &&
+         !isHalfFullBlock(mBlocks[blockCount - 2])) {
+    // Stop allocating from the block, then make sure no allocation that
+    // started before is accessing it and that it is still empty.
+    Block *block = mBlocks[blockCount - 1];
+    mBlockCount.store(blockCount - 1);
+    if (mActiveAllocations.load() != 0 ||
+        block->getFreeSlotCount() != kMemoryPoolSize) {
+      mBlockCount.store(blockCount);
+      break;
+    }
+    memoryFreeAndDestroy(block);
+    mBlocks[--blockCount] = nullptr;
+  }
+}
+
+template <typename ElementType, size_t kMemoryPoolSize,
+          size_t kMaxMemoryPoolCount>
+void SynchronizedExpandableMemoryPool<
+    ElementType, kMemoryPoolSize,
+    kMaxMemoryPoolCount>::lowerFirstFreeBlockHint(uint32_t index) {
+  uint32_t hint = mFirstFreeBlockHint.load();
+  while (index < hint && !mFirstFreeBlockHint.compare_exchange(hint, index)) {
+  }
+}
+
 template <typename ElementType, size_t kMemoryPoolSize,
           size_t kMaxMemoryPoolCount>
 bool SynchronizedExpandableMemoryPool<
     ElementType, kMemoryPoolSize,
     kMaxMemoryPoolCount>::isHalfFullBlock(Block *block) {
-  return block->getFreeBlockCount() < kMemoryPoolSize / 2;
+  return block->getFreeSlotCount() < kMemoryPoolSize / 2;
 }
+
 }  // namespace chre
 
 #endif  // CHRE_UTIL_SYNCHRONIZED_EXPANDABLE_MEMORY_POOL_IMPL_H_
@@ -71,6 +71,14 @@ class SynchronizedMemoryPool : public NonCopyable {
    */
   ElementType *find(MatchingFunction *matchingFunction, void *data);
 
+  /**
+   * @see MemoryPool::containsAddress. The range of addresses managed by the
+   * pool never changes, so no lock is acquired.
+   */
+  bool containsAddress(ElementType *element) {
+    return mMemoryPool.containsAddress(element);
+  }
+
   /**
    * @return the number of unused blocks in this memory pool.
    */
@@ -30,12 +30,47 @@ namespace chre {
 /**
  * Class to hold information about debug dump buffers so that
  * multiple debug dump commits can be called on buffers.
+ *
+ * By default all the buffers of a debug dump are kept until clear() is called.
+ * In streaming mode, each buffer that fills up is passed to a flush callback
+ * and reused once consumed, so that the memory held by a debug dump session
+ * is bounded by a fixed number of buffers whatever the size of the dump.
  */
 class DebugDumpWrapper {
  public:
+  /**
+   * Consumes a buffer that filled up in streaming mode.
+   *
+   * @param buffer The null-terminated content of the buffer, only valid for
+   *     the duration of the call.
+   * @param cookie The cookie given to the constructor.
+   * @return false if the buffer can not be consumed now. It is then kept and
+   *     passed again, before the following buffers, the next time a buffer
+   *     fills up or flush() is called.
+   */
+  typedef bool(FlushCallback)(const char *buffer, void *cookie);
+
   explicit DebugDumpWrapper(size_t bufferSize)
       : kBuffSize(bufferSize), mCurrBuff(nullptr) {}
 
+  /**
+   * Creates a wrapper in streaming mode.
+   *
+   * @param bufferSize The size of each buffer.
+   * @param maxBuffers The maximum number of buffers allocated at once, at
+   *     least 1. Strings printed while all of them are waiting to be consumed
+   *     are dropped.
+   * @param flushCallback The function consuming the buffers.
+   * @param cookie Passed to flushCallback.
+   */
+  DebugDumpWrapper(size_t bufferSize, size_t maxBuffers,
+                   FlushCallback *flushCallback, void *cookie)
+      : kBuffSize(bufferSize),
+        mCurrBuff(nullptr),
+        mMaxBuffers(maxBuffers),
+        mFlushCallback(flushCallback),
+        mFlushCookie(cookie) {}
+
   /**
    * Add formatted string to buffers handling allocating a new buffer if
    * necessary.
@@ -55,18 +90,38 @@ class DebugDumpWrapper {
   void printVaList(const char *formatStr, va_list argList);
 
   /**
-   * @return The buffers collected that total up to the full debug dump.
+   * @return The buffers collected that total up to the full debug dump. In
+   *     streaming mode, the buffers currently allocated.
    */
   const DynamicVector<UniquePtr<char>> &getBuffers() const {
     return mBuffers;
   }
 
+  /**
+   * In streaming mode, passes the buffers waiting to be consumed and then the
+   * current buffer, if not empty, to the flush callback.
+   *
+   * @return true if all the buffers were consumed.
+   */
+  bool flush();
+
+  /**
+   * @return The number of strings dropped in streaming mode since the last
+   *     call to clear().
+   */
+  size_t getNumDroppedStrings() const {
+    return mNumDroppedStrings;
+  }
+
   /**
    * Clear all the debug dump buffers.
    */
   void clear() {
     mCurrBuff = nullptr;
     mBuffers.clear();
+    mFreeBuffers.clear();
+    mFullBuffers.clear();
+    mNumDroppedStrings = 0;
   }
 
   /**
@@ -87,13 +142,39 @@ class DebugDumpWrapper {
   //! List of allocated buffers for the debug dump session
   DynamicVector<UniquePtr<char>> mBuffers;
 
+  //! The maximum number of buffers in streaming mode, 0 when not streaming.
+  const size_t mMaxBuffers = 0;
+  //! The function consuming the buffers in streaming mode.
+  FlushCallback *const mFlushCallback = nullptr;
+  void *const mFlushCookie = nullptr;
+
+  //! Buffers of mBuffers that can be reused in streaming mode.
+  DynamicVector<char *> mFreeBuffers;
+  //! Buffers of mBuffers waiting to be consumed in streaming mode, in order.
+  DynamicVector<char *> mFullBuffers;
+  //! The number of strings dropped as all the buffers were full.
+  size_t mNumDroppedStrings = 0;
+
+  bool isStreaming() const {
+    return mMaxBuffers > 0;
+  }
+
   /**
    * Set the current buffer to new buffer and append it to back of buffers.
    *
+   * In streaming mode, the current buffer is first queued to be consumed and
+   * the new buffer is a consumed one when possible.
+   *
    * @return true if successfully allocated memory for new buffer.
    */
   bool allocNewBuffer();
 
+  /**
+   * Passes the full buffers to the flush callback, in order, until one of
+   * them is not consumed.
+   */
+  void flushFullBuffers();
+
   /**
    * Insert a string onto the end of current buffer.
    *
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_SYSTEM_POOLED_FLATBUFFER_ALLOCATOR_H_
+#define CHRE_UTIL_SYSTEM_POOLED_FLATBUFFER_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chre/util/flatbuffers/helpers.h"
+#include "chre/util/non_copyable.h"
+#include "chre/util/synchronized_memory_pool.h"
+
+namespace chre {
+
+/**
+ * A thread-safe flatbuffers allocator that serves buffers from a pool of
+ * fixed-size blocks, so that encoding a message does not allocate from the
+ * heap as long as its buffer fits in a free block.
+ *
+ * Allocations that are larger than a block, or made while all the blocks are
+ * in use, are forwarded to the fallback allocator. Allocators can be chained
+ * this way, e.g. a pool of small blocks for most messages falling back to a
+ * pool of a few large blocks for log messages, itself falling back to the
+ * heap.
+ *
+ * @tparam kBlockSize The size of a block in bytes.
+ * @tparam kNumBlocks The number of blocks in the pool.
+ */
+template <size_t kBlockSize, size_t kNumBlocks>
+class PooledFlatBufferAllocator : public flatbuffers::Allocator,
+                                  public NonCopyable {
+ public:
+  /**
+   * @param fallbackAllocator The allocator used when a buffer cannot be served
+   *     from the pool, which must outlive this allocator. The CHRE heap is used
+   *     if nullptr.
+   */
+  explicit PooledFlatBufferAllocator(
+      flatbuffers::Allocator *fallbackAllocator = nullptr)
+      : mFallbackAllocator(fallbackAllocator != nullptr
+                               ? fallbackAllocator
+                               : &mHeapAllocator) {}
+
+  uint8_t *allocate(size_t size) override {
+    Block *block = (size <= kBlockSize) ? mBlocks.allocate() : nullptr;
+    return (block != nullptr) ? block->data
+                              : mFallbackAllocator->allocate(size);
+  }
+
+  void deallocate(uint8_t *p, size_t size) override {
+    Block *block = reinterpret_cast<Block *>(p);
+    if (mBlocks.containsAddress(block)) {
+      mBlocks.deallocate(block);
+    } else {
+      mFallbackAllocator->deallocate(p, size);
+    }
+  }
+
+  /**
+   * @return the number of blocks that are not in use.
+   */
+  size_t getFreeBlockCount() {
+    return mBlocks.getFreeBlockCount();
+  }
+
+ private:
+  struct Block {
+    //! Leaves the block uninitialized, the builder writes it before reading.
+    Block() {}
+
+    alignas(alignof(max_align_t)) uint8_t data[kBlockSize];
+  };
+
+  SynchronizedMemoryPool<Block, kNumBlocks> mBlocks;
+  FlatBufferAllocator mHeapAllocator;
+  flatbuffers::Allocator *const mFallbackAllocator;
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_SYSTEM_POOLED_FLATBUFFER_ALLOCATOR_H_
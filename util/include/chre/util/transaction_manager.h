@@ -19,9 +19,10 @@
 
 #include <cstdint>
 
-#include "chre/util/array_queue.h"
+#include "chre/util/container_support.h"
 #include "chre/util/non_copyable.h"
 #include "chre/util/optional.h"
+#include "chre/util/sequence_number_index.h"
 #include "chre/util/time.h"
 
 namespace chre {
@@ -63,6 +64,10 @@ class TransactionManagerCallback {
  *      remove the transaction (note that this is the only circumstance under
  *      which onTransactionFailure() is called)
  *
+ * Transactions and groups are found by ID through hash indices, so add() and
+ * remove() take constant time regardless of the number of pending
+ * transactions, unless the transaction with the earliest timeout is removed.
+ *
  * @param kMaxTransactions The maximum number of pending transactions
  * (statically allocated)
  * @param TimerPoolType A chre::TimerPool-like class, which supports methods
@@ -72,6 +77,9 @@ class TransactionManagerCallback {
 template <size_t kMaxTransactions, class TimerPoolType>
 class TransactionManager : public NonCopyable {
  public:
+  static_assert(kMaxTransactions > 0 && kMaxTransactions < UINT16_MAX,
+                "Invalid number of transactions");
+
   /**
    * @param cb Callback
    * @param timerPool TimerPool-like object to use for retry timers
@@ -87,6 +95,10 @@ class TransactionManager : public NonCopyable {
         mTimerPool(timerPool),
         mCb(cb) {
     CHRE_ASSERT(timeout.toRawNanoseconds() > 0);
+    for (size_t i = 0; i < kMaxTransactions; ++i) {
+      mTransactions[i].next = static_cast<uint16_t>(i + 1);
+    }
+    mTransactions[kMaxTransactions - 1].next = kInvalidSlot;
   }
 
   /**
@@ -132,13 +144,32 @@ class TransactionManager : public NonCopyable {
    */
   bool remove(uint32_t transactionId);
 
+  /**
+   * @return The number of pending transactions.
+   */
+  size_t size() const {
+    return mNumTransactions;
+  }
+
  private:
+  //! Marks the end of a list of slots.
+  static constexpr uint16_t kInvalidSlot = UINT16_MAX;
+
   //! Stores transaction-related data.
   struct Transaction {
-    Transaction(uint32_t id_, uint16_t groupId_) : id(id_), groupId(groupId_) {}
+    uint32_t id = 0;
+    uint16_t groupId = 0;
+
+    //! The next slot in the list this slot belongs to: the pending
+    //! transactions in the order they were added, or the free slots
+    uint16_t next = kInvalidSlot;
+
+    //! The previous pending transaction, in the order they were added
+    uint16_t prev = kInvalidSlot;
 
-    uint32_t id;
-    uint16_t groupId;
+    //! The next and previous pending transactions in the same group
+    uint16_t nextInGroup = kInvalidSlot;
+    uint16_t prevInGroup = kInvalidSlot;
 
     //! Counts up by 1 on each attempt, 0 when pending first attempt
     uint8_t attemptCount = 0;
@@ -149,6 +180,16 @@ class TransactionManager : public NonCopyable {
     Nanoseconds timeout = Nanoseconds(UINT64_MAX);
   };
 
+  //! The pending transactions of a group, in the order they were added
+  struct Group {
+    uint16_t first;
+    uint16_t last;
+
+    bool operator==(const Group &other) const {
+      return first == other.first && last == other.last;
+    }
+  };
+
   //! RAII helper to set a boolean to true and restore to false at end of scope
   class ScopedFlag {
    public:
@@ -178,8 +219,22 @@ class TransactionManager : public NonCopyable {
   //! Handle of timer that expires, or CHRE_TIMER_INVALID if none
   uint32_t mTimerHandle = CHRE_TIMER_INVALID;
 
-  //! Set of active transactions
-  ArrayQueue<Transaction, kMaxTransactions> mTransactions;
+  //! When the timer expires, if mTimerHandle is valid
+  Nanoseconds mTimerExpiry = Nanoseconds(UINT64_MAX);
+
+  //! Storage of the transactions. The pending transactions form a FIFO list
+  //! from mFirst to mLast, and the other slots a list from mFirstFree.
+  Transaction mTransactions[kMaxTransactions];
+  uint16_t mFirst = kInvalidSlot;
+  uint16_t mLast = kInvalidSlot;
+  uint16_t mFirstFree = 0;
+  size_t mNumTransactions = 0;
+
+  //! Index from the ID of each pending transaction to its slot
+  SequenceNumberIndex<kMaxTransactions> mIndex;
+
+  //! Index from the ID of each group with pending transactions to them
+  SequenceNumberIndex<kMaxTransactions, Group> mGroups;
 
   //! Callback given to mTimerPool, invoked when the next expiring transaction
   //! has timed out
@@ -194,6 +249,14 @@ class TransactionManager : public NonCopyable {
   //! @return a pseudorandom ID for a transaction in the range of [0, 2^30 - 1]
   uint32_t generatePseudoRandomId();
 
+  //! Adds a transaction at the end of the list of pending transactions and of
+  //! its group
+  void allocateTransaction(uint32_t id, uint16_t groupId);
+
+  //! Removes a transaction from the list of pending transactions and of its
+  //! group, and frees its slot
+  void freeTransaction(uint16_t slot);
+
   //! If the last added transaction is the only one in its group, start it;
   //! otherwise do nothing
   void maybeStartLastTransaction();
@@ -206,7 +269,7 @@ class TransactionManager : public NonCopyable {
   //! set the timer
   void startTransaction(Transaction &transaction);
 
-  //! Updates the timer to the proper state for mTransactions
+  //! Updates the timer to the proper state for the pending transactions
   void updateTimer();
 
   //! Sets the timer to expire after a delay
@@ -40,7 +40,7 @@ bool TransactionManager<kMaxTransactions, TimerPoolType>::add(uint16_t groupId,
   CHRE_ASSERT(id != nullptr);
   CHRE_ASSERT(!mInCallback);
 
-  if (mTransactions.full()) {
+  if (mNumTransactions == kMaxTransactions) {
     LOGE("Can't add new transaction: storage is full");
     return false;
   }
@@ -49,11 +49,11 @@ bool TransactionManager<kMaxTransactions, TimerPoolType>::add(uint16_t groupId,
     mNextTransactionId = generatePseudoRandomId();
   }
   *id = (mNextTransactionId.value())++;
-  mTransactions.emplace(*id, groupId);
+  allocateTransaction(*id, groupId);
 
   maybeStartLastTransaction();
-  if (mTransactions.size() == 1) {
-    setTimerAbsolute(mTransactions.back().timeout);
+  if (mNumTransactions == 1) {
+    setTimerAbsolute(mTransactions[mLast].timeout);
   }
   return true;
 }
@@ -62,21 +62,106 @@ template <size_t kMaxTransactions, class TimerPoolType>
 bool TransactionManager<kMaxTransactions, TimerPoolType>::remove(
     uint32_t transactionId) {
   CHRE_ASSERT(!mInCallback);
-  for (size_t i = 0; i < mTransactions.size(); ++i) {
-    Transaction &transaction = mTransactions[i];
-    if (transaction.id == transactionId) {
-      uint16_t groupId = transaction.groupId;
-      bool transactionWasStarted = transaction.attemptCount > 0;
-      mTransactions.remove(i);
-
-      if (transactionWasStarted) {
-        startNextTransactionInGroup(groupId);
-        updateTimer();
-      }
-      return true;
+  const uint16_t *slot = mIndex.find(transactionId);
+  if (slot == nullptr) {
+    return false;
+  }
+
+  Transaction &transaction = mTransactions[*slot];
+  uint16_t groupId = transaction.groupId;
+  bool transactionWasStarted = transaction.attemptCount > 0;
+  Nanoseconds timeout = transaction.timeout;
+  freeTransaction(*slot);
+
+  if (transactionWasStarted) {
+    startNextTransactionInGroup(groupId);
+    // The other started transactions, including the one that was just
+    // started, time out at or after the timer expiry, so the timer only needs
+    // to be updated if it was set for this transaction.
+    if (mNumTransactions == 0 || mTimerHandle == CHRE_TIMER_INVALID ||
+        timeout <= mTimerExpiry) {
+      updateTimer();
     }
   }
-  return false;
+  return true;
+}
+
+template <size_t kMaxTransactions, class TimerPoolType>
+void TransactionManager<kMaxTransactions, TimerPoolType>::allocateTransaction(
+    uint32_t id, uint16_t groupId) {
+  CHRE_ASSERT(mFirstFree != kInvalidSlot);
+  uint16_t slot = mFirstFree;
+  Transaction &transaction = mTransactions[slot];
+  mFirstFree = transaction.next;
+
+  transaction.id = id;
+  transaction.groupId = groupId;
+  transaction.attemptCount = 0;
+  transaction.timeout = Nanoseconds(UINT64_MAX);
+  transaction.prev = mLast;
+  transaction.next = kInvalidSlot;
+  if (mLast == kInvalidSlot) {
+    mFirst = slot;
+  } else {
+    mTransactions[mLast].next = slot;
+  }
+  mLast = slot;
+
+  transaction.nextInGroup = kInvalidSlot;
+  Group *group = mGroups.find(groupId);
+  if (group == nullptr) {
+    transaction.prevInGroup = kInvalidSlot;
+    mGroups.insert(groupId, Group{slot, slot});
+  } else {
+    transaction.prevInGroup = group->last;
+    mTransactions[group->last].nextInGroup = slot;
+    group->last = slot;
+  }
+
+  // Can't fail: the indices have the capacity for all the transactions
+  mIndex.insert(id, slot);
+  ++mNumTransactions;
+}
+
+template <size_t kMaxTransactions, class TimerPoolType>
+void TransactionManager<kMaxTransactions, TimerPoolType>::freeTransaction(
+    uint16_t slot) {
+  Transaction &transaction = mTransactions[slot];
+  mIndex.erase(transaction.id, slot);
+
+  if (transaction.prev == kInvalidSlot) {
+    mFirst = transaction.next;
+  } else {
+    mTransactions[transaction.prev].next = transaction.next;
+  }
+  if (transaction.next == kInvalidSlot) {
+    mLast = transaction.prev;
+  } else {
+    mTransactions[transaction.next].prev = transaction.prev;
+  }
+
+  Group *group = mGroups.find(transaction.groupId);
+  CHRE_ASSERT(group != nullptr);
+  if (transaction.prevInGroup == kInvalidSlot) {
+    group->first = transaction.nextInGroup;
+  } else {
+    mTransactions[transaction.prevInGroup].nextInGroup =
+        transaction.nextInGroup;
+  }
+  if (transaction.nextInGroup == kInvalidSlot) {
+    group->last = transaction.prevInGroup;
+  } else {
+    mTransactions[transaction.nextInGroup].prevInGroup =
+        transaction.prevInGroup;
+  }
+  if (group->first == kInvalidSlot) {
+    mGroups.erase(transaction.groupId, *group);
+  }
+  --mNumTransactions;
+
+  transaction.prev = kInvalidSlot;
+  transaction.next = mFirstFree;
+  mFirstFree = slot;
 }
 
 template <size_t kMaxTransactions, class TimerPoolType>
@@ -101,28 +186,21 @@ TransactionManager<kMaxTransactions, TimerPoolType>::generatePseudoRandomId() {
 template <size_t kMaxTransactions, class TimerPoolType>
 void TransactionManager<kMaxTransactions,
                         TimerPoolType>::maybeStartLastTransaction() {
-  Transaction &lastTransaction = mTransactions.back();
-
-  for (const Transaction &transaction : mTransactions) {
-    if (transaction.groupId == lastTransaction.groupId &&
-        transaction.id != lastTransaction.id) {
-      // Have at least one pending request for this group, so this transaction
-      // will only be started via removeTransaction()
-      return;
-    }
-  }
+  Transaction &lastTransaction = mTransactions[mLast];
 
-  startTransaction(lastTransaction);
+  // If there is at least one pending request for this group, this transaction
+  // will only be started via removeTransaction()
+  if (lastTransaction.prevInGroup == kInvalidSlot) {
+    startTransaction(lastTransaction);
+  }
 }
 
 template <size_t kMaxTransactions, class TimerPoolType>
 void TransactionManager<kMaxTransactions, TimerPoolType>::
     startNextTransactionInGroup(uint16_t groupId) {
-  for (Transaction &transaction : mTransactions) {
-    if (transaction.groupId == groupId) {
-      startTransaction(transaction);
-      return;
-    }
+  const Group *group = mGroups.find(groupId);
+  if (group != nullptr) {
+    startTransaction(mTransactions[group->first]);
   }
 }
 
@@ -141,13 +219,14 @@ void TransactionManager<kMaxTransactions, TimerPoolType>::startTransaction(
 template <size_t kMaxTransactions, class TimerPoolType>
 void TransactionManager<kMaxTransactions, TimerPoolType>::updateTimer() {
   mTimerPool.cancelSystemTimer(mTimerHandle);
-  if (mTransactions.empty()) {
+  if (mNumTransactions == 0) {
     mTimerHandle = CHRE_TIMER_INVALID;
   } else {
     Nanoseconds nextTimeout(UINT64_MAX);
-    for (const Transaction &transaction : mTransactions) {
-      if (transaction.timeout < nextTimeout) {
-        nextTimeout = transaction.timeout;
+    for (uint16_t slot = mFirst; slot != kInvalidSlot;
+         slot = mTransactions[slot].next) {
+      if (mTransactions[slot].timeout < nextTimeout) {
+        nextTimeout = mTransactions[slot].timeout;
       }
     }
     // If we hit this assert, we only have transactions that haven't been
@@ -172,12 +251,13 @@ void TransactionManager<kMaxTransactions, TimerPoolType>::setTimerAbsolute(
   Nanoseconds now = SystemTime::getMonotonicTime();
   Nanoseconds delay = (expiry > now) ? expiry - now : kMinDelay;
   setTimer(delay);
+  mTimerExpiry = now + delay;
 }
 
 template <size_t kMaxTransactions, class TimerPoolType>
 void TransactionManager<kMaxTransactions, TimerPoolType>::handleTimerExpiry() {
   mTimerHandle = CHRE_TIMER_INVALID;
-  if (mTransactions.empty()) {
+  if (mNumTransactions == 0) {
     LOGW("Got timer callback with no pending transactions");
     return;
   }
@@ -189,15 +269,19 @@ void TransactionManager<kMaxTransactions, TimerPoolType>::handleTimerExpiry() {
   //   update the timer
   Nanoseconds now = SystemTime::getMonotonicTime();
   Nanoseconds nextTimeout(UINT64_MAX);
-  for (size_t i = 0; i < mTransactions.size(); /* ++i at end of scope */) {
-    Transaction &transaction = mTransactions[i];
+  for (uint16_t slot = mFirst; slot != kInvalidSlot;
+       /* slot = next at end of scope */) {
+    Transaction &transaction = mTransactions[slot];
+    uint16_t next = transaction.next;
     if (transaction.timeout <= now) {
       if (++transaction.attemptCount > kMaxAttempts) {
         Transaction transactionCopy = transaction;
-        mTransactions.remove(i);  // Invalidates transaction reference
+        freeTransaction(slot);  // Invalidates transaction reference
         handleTransactionFailure(transactionCopy);
-        // Since mTransactions is FIFO, any pending transactions in this group
-        // will appear after this one, so we don't need to restart the loop
+        // Since the transactions are in FIFO order, any pending transactions
+        // in this group will appear after this one, so we don't need to
+        // restart the loop
+        slot = next;
         continue;
       } else {
         transaction.timeout = now + kTimeout;
@@ -210,10 +294,10 @@ void TransactionManager<kMaxTransactions, TimerPoolType>::handleTimerExpiry() {
     if (transaction.timeout < nextTimeout) {
       nextTimeout = transaction.timeout;
     }
-    ++i;
+    slot = next;
   }
 
-  if (!mTransactions.empty()) {
+  if (mNumTransactions != 0) {
     setTimerAbsolute(nextTimeout);
   }
 }
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/lz_compression.h"
+
+#include <cstring>
+
+namespace chre {
+
+namespace {
+
+// Constants of the LZ4 block format.
+constexpr size_t kMinMatchLength = 4;
+//! The last match must start at least this many bytes before the end.
+constexpr size_t kMatchStartLimit = 12;
+//! The last bytes of a block are always literals.
+constexpr size_t kLastLiterals = 5;
+constexpr uint8_t kTokenLengthMask = 0xf;
+constexpr size_t kMaxOffset = UINT16_MAX;
+
+uint32_t read32(const uint8_t *src) {
+  uint32_t value;
+  memcpy(&value, src, sizeof(value));
+  return value;
+}
+
+size_t getExtraLengthSize(size_t length) {
+  return (length < kTokenLengthMask) ? 0 : (length - kTokenLengthMask) / 255 + 1;
+}
+
+uint8_t *writeExtraLength(uint8_t *dst, size_t length) {
+  if (length >= kTokenLengthMask) {
+    length -= kTokenLengthMask;
+    while (length >= 255) {
+      *dst++ = 255;
+      length -= 255;
+    }
+    *dst++ = static_cast<uint8_t>(length);
+  }
+  return dst;
+}
+
+/**
+ * Writes a sequence made of literals followed by a match. matchLength is 0 for
+ * the last sequence, which only holds literals.
+ *
+ * @return The position after the sequence, or nullptr if it does not fit.
+ */
+uint8_t *writeSequence(uint8_t *dst, const uint8_t *dstEnd,
+                       const uint8_t *literals, size_t literalLength,
+                       size_t offset, size_t matchLength) {
+  size_t size = 1 + getExtraLengthSize(literalLength) + literalLength;
+  if (matchLength > 0) {
+    size += sizeof(uint16_t) +
+            getExtraLengthSize(matchLength - kMinMatchLength);
+  }
+  if (size > static_cast<size_t>(dstEnd - dst)) {
+    return nullptr;
+  }
+
+  uint8_t literalNibble = (literalLength < kTokenLengthMask)
+                              ? static_cast<uint8_t>(literalLength)
+                              : kTokenLengthMask;
+  uint8_t matchNibble = 0;
+  if (matchLength > 0) {
+    size_t encodedMatchLength = matchLength - kMinMatchLength;
+    matchNibble = (encodedMatchLength < kTokenLengthMask)
+                      ? static_cast<uint8_t>(encodedMatchLength)
+                      : kTokenLengthMask;
+  }
+  *dst++ = static_cast<uint8_t>(literalNibble << 4 | matchNibble);
+  dst = writeExtraLength(dst, literalLength);
+  memcpy(dst, literals, literalLength);
+  dst += literalLength;
+
+  if (matchLength > 0) {
+    *dst++ = static_cast<uint8_t>(offset);
+    *dst++ = static_cast<uint8_t>(offset >> 8);
+    dst = writeExtraLength(dst, matchLength - kMinMatchLength);
+  }
+  return dst;
+}
+
+/**
+ * Reads the extension bytes of a length whose token nibble was saturated.
+ */
+bool readExtraLength(const uint8_t *&src, const uint8_t *srcEnd,
+                     size_t *length) {
+  if (*length == kTokenLengthMask) {
+    uint8_t byte;
+    do {
+      if (src == srcEnd) {
+        return false;
+      }
+      byte = *src++;
+      *length += byte;
+    } while (byte == 255);
+  }
+  return true;
+}
+
+}  // namespace
+
+size_t LzCompressor::compress(const uint8_t *src, size_t srcSize, uint8_t *dst,
+                              size_t dstCapacity) {
+  if (srcSize == 0 || srcSize > kMaxInputSize) {
+    return 0;
+  }
+
+  // Stale or zero entries are harmless since candidates are always verified.
+  memset(mHashTable, 0, sizeof(mHashTable));
+  const uint8_t *dstEnd = dst + dstCapacity;
+  uint8_t *out = dst;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + kMatchStartLimit <= srcSize) {
+    uint32_t sequence = read32(&src[pos]);
+    uint32_t hash = (sequence * UINT32_C(2654435761)) >> (32 - kHashBits);
+    size_t candidate = mHashTable[hash];
+    mHashTable[hash] = static_cast<uint16_t>(pos);
+
+    if (candidate >= pos || pos - candidate > kMaxOffset ||
+        read32(&src[candidate]) != sequence) {
+      pos++;
+      continue;
+    }
+
+    size_t matchLength = kMinMatchLength;
+    size_t maxMatchLength = srcSize - kLastLiterals - pos;
+    while (matchLength < maxMatchLength &&
+           src[candidate + matchLength] == src[pos + matchLength]) {
+      matchLength++;
+    }
+
+    out = writeSequence(out, dstEnd, &src[anchor], pos - anchor,
+                        pos - candidate, matchLength);
+    if (out == nullptr) {
+      return 0;
+    }
+    pos += matchLength;
+    anchor = pos;
+  }
+
+  out = writeSequence(out, dstEnd, &src[anchor], srcSize - anchor,
+                      0 /* offset */, 0 /* matchLength */);
+  return (out == nullptr) ? 0 : static_cast<size_t>(out - dst);
+}
+
+bool lzDecompress(const uint8_t *src, size_t srcSize, uint8_t *dst,
+                  size_t dstCapacity, size_t *decompressedSize) {
+  const uint8_t *srcEnd = src + srcSize;
+  size_t outSize = 0;
+  while (src < srcEnd) {
+    uint8_t token = *src++;
+
+    size_t literalLength = token >> 4;
+    if (!readExtraLength(src, srcEnd, &literalLength) ||
+        literalLength > static_cast<size_t>(srcEnd - src) ||
+        literalLength > dstCapacity - outSize) {
+      return false;
+    }
+    memcpy(&dst[outSize], src, literalLength);
+    src += literalLength;
+    outSize += literalLength;
+
+    if (src == srcEnd) {
+      // The last sequence only holds literals.
+      break;
+    }
+
+    if (srcEnd - src < static_cast<ptrdiff_t>(sizeof(uint16_t))) {
+      return false;
+    }
+    size_t offset = src[0] | (static_cast<size_t>(src[1]) << 8);
+    src += sizeof(uint16_t);
+    size_t matchLength = token & kTokenLengthMask;
+    if (offset == 0 || offset > outSize ||
+        !readExtraLength(src, srcEnd, &matchLength)) {
+      return false;
+    }
+    matchLength += kMinMatchLength;
+    if (matchLength > dstCapacity - outSize) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, so copy byte by byte.
+    for (size_t i = 0; i < matchLength; i++) {
+      dst[outSize + i] = dst[outSize - offset + i];
+    }
+    outSize += matchLength;
+  }
+
+  *decompressedSize = outSize;
+  return true;
+}
+
+}  // namespace chre
@@ -16,91 +16,346 @@
 
 #include "chre/util/pigweed/chre_channel_output.h"
 
+#include <cinttypes>
 #include <cstdint>
+#include <cstring>
 
 #include "chre/util/nanoapp/callbacks.h"
+#include "chre/util/nanoapp/log.h"
 #include "chre/util/pigweed/rpc_helper.h"
 
+#ifndef LOG_TAG
+#define LOG_TAG "[ChreChannelOutput]"
+#endif  // LOG_TAG
+
 namespace chre {
+
+/**
+ * A message buffer, followed in the same allocation by the message sent to
+ * the nanoapp.
+ */
+struct alignas(alignof(ChrePigweedNanoappMessage))
+    ChreNanoappChannelOutput::MessageBuffer {
+  //! The output the buffer is returned to when its event is freed, nullptr if
+  //! the buffer is freed with its event.
+  ChreNanoappChannelOutput *owner;
+
+  //! The room for the contents of the message, in bytes.
+  size_t capacity;
+
+  ChrePigweedNanoappMessage *getMessage() {
+    return reinterpret_cast<ChrePigweedNanoappMessage *>(this + 1);
+  }
+
+  static MessageBuffer *fromMessage(void *message) {
+    return static_cast<MessageBuffer *>(message) - 1;
+  }
+};
+
 namespace {
 
-void nappMessageFreeCb(uint16_t /* eventType */, void *eventData) {
-  chreHeapFree(eventData);
+//! The largest contents of a message.
+constexpr size_t kMaxMessageSize =
+    CHRE_MESSAGE_TO_HOST_MAX_SIZE - sizeof(ChrePigweedNanoappMessage);
+
+//! The first byte of a batch. An RPC packet can't start with it, as it would
+//! be the tag of the invalid protobuf field 0.
+constexpr uint8_t kBatchMarker = 0x00;
+
+//! The version of the batch format, following its marker.
+constexpr uint8_t kBatchVersion = 1;
+
+//! The size of the marker and version of a batch.
+constexpr size_t kBatchHeaderSize = 2;
+
+//! The largest packet that is batched, larger ones being sent alone.
+constexpr size_t kMaxBatchedPacketSize =
+    (kMaxMessageSize - kBatchHeaderSize - sizeof(uint16_t) < UINT16_MAX)
+        ? kMaxMessageSize - kBatchHeaderSize - sizeof(uint16_t)
+        : UINT16_MAX;
+
+}  // namespace
+
+bool getNextNanoappPacket(const ChrePigweedNanoappMessage &message,
+                          size_t *offset, pw::span<const std::byte> *packet) {
+  if (message.msgSize == 0) {
+    return false;
+  }
+
+  if (message.msg[0] != kBatchMarker) {
+    // A single packet, as is.
+    if (*offset != 0) {
+      return false;
+    }
+    *packet = pw::span(reinterpret_cast<const std::byte *>(message.msg),
+                       message.msgSize);
+    *offset = message.msgSize;
+    return true;
+  }
+
+  if (*offset == 0) {
+    if (message.msgSize < kBatchHeaderSize ||
+        message.msg[1] != kBatchVersion) {
+      LOGE("Unsupported nanoapp message version");
+      return false;
+    }
+    *offset = kBatchHeaderSize;
+  }
+
+  if (*offset + sizeof(uint16_t) > message.msgSize) {
+    return false;
+  }
+
+  uint16_t packetSize;
+  memcpy(&packetSize, &message.msg[*offset], sizeof(packetSize));
+  size_t packetOffset = *offset + sizeof(packetSize);
+  if (packetSize > message.msgSize - packetOffset) {
+    LOGE("Malformed nanoapp message");
+    return false;
+  }
+
+  *packet = pw::span(reinterpret_cast<const std::byte *>(
+                         &message.msg[packetOffset]),
+                     packetSize);
+  *offset = packetOffset + packetSize;
+  return true;
 }
 
-/**
- * Sends the buffer to the nanoapp.
- *
- * The buffer is first wrapped into a ChrePigweedNanoappMessage struct.
- *
- * @param targetInstanceId The nanoapp to send the message to
- * @param eventType The event to send to the nanoapp
- * @param buffer The buffer to send
- * @return The status of the operation
- */
-pw::Status sendToNanoapp(uint32_t targetInstanceId, uint16_t eventType,
-                         pw::span<const std::byte> buffer) {
-  CHRE_ASSERT(targetInstanceId != 0);
+bool isNanoappMessageBatch(const ChrePigweedNanoappMessage &message) {
+  return message.msgSize != 0 && message.msg[0] == kBatchMarker;
+}
 
-  if (buffer.size() > 0) {
-    auto *data = static_cast<ChrePigweedNanoappMessage *>(
-        chreHeapAlloc(static_cast<uint32_t>(
-            buffer.size() + sizeof(ChrePigweedNanoappMessage))));
-    if (data == nullptr) {
-      return PW_STATUS_RESOURCE_EXHAUSTED;
+void ChreNanoappChannelOutput::releaseBuffers() {
+  if (mPendingBuffer != nullptr) {
+    releaseBuffer(mPendingBuffer);
+    mPendingBuffer = nullptr;
+  }
+  mNumPendingPackets = 0;
+  mBatchDepth = 0;
+
+  for (size_t i = 0; i < CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE; i++) {
+    if (mBuffers[i] != nullptr) {
+      if (mBufferInUse[i]) {
+        mBuffers[i]->owner = nullptr;
+      } else {
+        chreHeapFree(mBuffers[i]);
+      }
+      mBuffers[i] = nullptr;
+      mBufferInUse[i] = false;
+    }
+  }
+}
+
+void ChreNanoappChannelOutput::startBatch() {
+  CHRE_ASSERT(mBatchDepth < UINT8_MAX);
+  mBatchDepth++;
+}
+
+pw::Status ChreNanoappChannelOutput::flushBatch() {
+  CHRE_ASSERT(mBatchDepth > 0);
+  if (mBatchDepth > 0) {
+    mBatchDepth--;
+  }
+
+  return (mBatchDepth == 0) ? sendPendingMessage() : PW_STATUS_OK;
+}
+
+size_t ChreNanoappChannelOutput::MaximumTransmissionUnit() {
+  return kMaxMessageSize;
+}
+
+pw::Status ChreNanoappChannelOutput::Send(pw::span<const std::byte> buffer) {
+  CHRE_ASSERT(mTargetInstanceId != 0);
+
+  if (buffer.size() == 0) {
+    return PW_STATUS_OK;
+  }
+  if (buffer.size() > kMaxMessageSize) {
+    return PW_STATUS_INVALID_ARGUMENT;
+  }
+
+  size_t packetSize = sizeof(uint16_t) + buffer.size();
+  if (mPendingBuffer != nullptr &&
+      (mBatchDepth == 0 || buffer.size() > kMaxBatchedPacketSize ||
+       mPendingBuffer->getMessage()->msgSize + packetSize > kMaxMessageSize)) {
+    pw::Status status = sendPendingMessage();
+    if (!status.ok()) {
+      return status;
     }
+  }
 
-    data->msgSize = buffer.size();
-    memcpy(data->msg, buffer.data(), buffer.size());
+  if (mBatchDepth == 0 || buffer.size() > kMaxBatchedPacketSize) {
+    MessageBuffer *single = acquireBuffer(buffer.size());
+    if (single == nullptr) {
+      return PW_STATUS_RESOURCE_EXHAUSTED;
+    }
+    single->getMessage()->msgSize = buffer.size();
+    memcpy(single->getMessage()->msg, buffer.data(), buffer.size());
+    return sendMessage(single);
+  }
 
-    if (!chreSendEvent(eventType, data, nappMessageFreeCb, targetInstanceId)) {
-      return PW_STATUS_INVALID_ARGUMENT;
+  if (mPendingBuffer == nullptr) {
+    mPendingBuffer = acquireBuffer(kBatchHeaderSize + packetSize);
+    if (mPendingBuffer == nullptr) {
+      return PW_STATUS_RESOURCE_EXHAUSTED;
+    }
+    ChrePigweedNanoappMessage *message = mPendingBuffer->getMessage();
+    message->msg[0] = kBatchMarker;
+    message->msg[1] = kBatchVersion;
+    message->msgSize = kBatchHeaderSize;
+    mNumPendingPackets = 0;
+  } else if (mPendingBuffer->getMessage()->msgSize + packetSize >
+             mPendingBuffer->capacity) {
+    // The batch grows geometrically, so that it is moved a few times at most.
+    size_t size = mPendingBuffer->getMessage()->msgSize + packetSize;
+    size_t capacity = 2 * mPendingBuffer->capacity;
+    if (capacity > kMaxMessageSize) {
+      capacity = kMaxMessageSize;
     }
+    MessageBuffer *grown = acquireBuffer((capacity > size) ? capacity : size);
+    if (grown == nullptr) {
+      return PW_STATUS_RESOURCE_EXHAUSTED;
+    }
+    memcpy(grown->getMessage(), mPendingBuffer->getMessage(),
+           sizeof(ChrePigweedNanoappMessage) +
+               mPendingBuffer->getMessage()->msgSize);
+    releaseBuffer(mPendingBuffer);
+    mPendingBuffer = grown;
   }
 
+  ChrePigweedNanoappMessage *message = mPendingBuffer->getMessage();
+  auto size = static_cast<uint16_t>(buffer.size());
+  memcpy(&message->msg[message->msgSize], &size, sizeof(size));
+  memcpy(&message->msg[message->msgSize + sizeof(size)], buffer.data(),
+         buffer.size());
+  message->msgSize += packetSize;
+  mNumPendingPackets++;
   return PW_STATUS_OK;
 }
 
-}  // namespace
+pw::Status ChreNanoappChannelOutput::setTarget(uint32_t instanceId) {
+  CHRE_ASSERT(instanceId <= kRpcNanoappMaxId);
+  auto targetInstanceId = static_cast<uint16_t>(
+      (instanceId <= kRpcNanoappMaxId) ? instanceId : 0);
+  pw::Status status = PW_STATUS_OK;
+  if (targetInstanceId != mTargetInstanceId) {
+    status = sendPendingMessage();
+    mTargetInstanceId = targetInstanceId;
+  }
+  return status;
+}
 
-void ChreServerNanoappChannelOutput::setClient(uint32_t nanoappInstanceId) {
-  CHRE_ASSERT(nanoappInstanceId <= kRpcNanoappMaxId);
-  if (nanoappInstanceId <= kRpcNanoappMaxId) {
-    mClientInstanceId = static_cast<uint16_t>(nanoappInstanceId);
+void ChreNanoappChannelOutput::freeMessageCallback(uint16_t /* eventType */,
+                                                   void *eventData) {
+  MessageBuffer *buffer = MessageBuffer::fromMessage(eventData);
+  if (buffer->owner != nullptr) {
+    buffer->owner->releaseBuffer(buffer);
   } else {
-    mClientInstanceId = 0;
+    chreHeapFree(buffer);
   }
 }
 
-size_t ChreServerNanoappChannelOutput::MaximumTransmissionUnit() {
-  return CHRE_MESSAGE_TO_HOST_MAX_SIZE - sizeof(ChrePigweedNanoappMessage);
+ChreNanoappChannelOutput::MessageBuffer *
+ChreNanoappChannelOutput::allocateBuffer(size_t capacity,
+                                         ChreNanoappChannelOutput *owner) {
+  auto *buffer = static_cast<MessageBuffer *>(
+      chreHeapAlloc(static_cast<uint32_t>(sizeof(MessageBuffer) +
+                                          sizeof(ChrePigweedNanoappMessage) +
+                                          capacity)));
+  if (buffer != nullptr) {
+    buffer->owner = owner;
+    buffer->capacity = capacity;
+  }
+  return buffer;
 }
 
-pw::Status ChreServerNanoappChannelOutput::Send(
-    pw::span<const std::byte> buffer) {
-  // The permission is not enforced across nanoapps but we still need to
-  // reset the value as it is only applicable to the next message.
-  mPermission.getAndReset();
+ChreNanoappChannelOutput::MessageBuffer *
+ChreNanoappChannelOutput::acquireBuffer(size_t capacity) {
+  size_t freeIndex = CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE;
+  for (size_t i = 0; i < CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE; i++) {
+    if (!mBufferInUse[i]) {
+      if (mBuffers[i] != nullptr && mBuffers[i]->capacity >= capacity) {
+        mBufferInUse[i] = true;
+        return mBuffers[i];
+      }
+      if (freeIndex == CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE) {
+        freeIndex = i;
+      }
+    }
+  }
+
+  if (freeIndex == CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE) {
+    return allocateBuffer(capacity, nullptr /* owner */);
+  }
 
-  return sendToNanoapp(mClientInstanceId, CHRE_EVENT_RPC_RESPONSE, buffer);
+  // No unused buffer is large enough, one is replaced by a buffer of the
+  // requested size.
+  chreHeapFree(mBuffers[freeIndex]);
+  mBuffers[freeIndex] = allocateBuffer(capacity, this);
+  mBufferInUse[freeIndex] = (mBuffers[freeIndex] != nullptr);
+  return mBuffers[freeIndex];
 }
 
-void ChreClientNanoappChannelOutput::setServer(uint32_t instanceId) {
-  CHRE_ASSERT(instanceId <= kRpcNanoappMaxId);
-  if (instanceId <= kRpcNanoappMaxId) {
-    mServerInstanceId = static_cast<uint16_t>(instanceId);
-  } else {
-    mServerInstanceId = 0;
+void ChreNanoappChannelOutput::releaseBuffer(MessageBuffer *buffer) {
+  if (buffer->owner == nullptr) {
+    chreHeapFree(buffer);
+    return;
+  }
+
+  for (size_t i = 0; i < CHRE_PIGWEED_NANOAPP_MESSAGE_POOL_SIZE; i++) {
+    if (mBuffers[i] == buffer) {
+      mBufferInUse[i] = false;
+      return;
+    }
   }
 }
 
-size_t ChreClientNanoappChannelOutput::MaximumTransmissionUnit() {
-  return CHRE_MESSAGE_TO_HOST_MAX_SIZE - sizeof(ChrePigweedNanoappMessage);
+pw::Status ChreNanoappChannelOutput::sendPendingMessage() {
+  if (mPendingBuffer == nullptr) {
+    return PW_STATUS_OK;
+  }
+
+  MessageBuffer *buffer = mPendingBuffer;
+  mPendingBuffer = nullptr;
+  if (mNumPendingPackets == 1) {
+    // A lone packet is sent as is, as when not batching.
+    ChrePigweedNanoappMessage *message = buffer->getMessage();
+    message->msgSize -= kBatchHeaderSize + sizeof(uint16_t);
+    memmove(message->msg, &message->msg[kBatchHeaderSize + sizeof(uint16_t)],
+            message->msgSize);
+  }
+  mNumPendingPackets = 0;
+  return sendMessage(buffer);
+}
+
+pw::Status ChreNanoappChannelOutput::sendMessage(MessageBuffer *buffer) {
+  // The buffer is returned to the pool by the free callback, possibly before
+  // chreSendEvent() returns.
+  if (!chreSendEvent(mEventType, buffer->getMessage(), freeMessageCallback,
+                     mTargetInstanceId)) {
+    LOGE("Failed to send RPC packets to nanoapp %" PRIu16, mTargetInstanceId);
+    return PW_STATUS_INVALID_ARGUMENT;
+  }
+
+  return PW_STATUS_OK;
 }
 
-pw::Status ChreClientNanoappChannelOutput::Send(
+pw::Status ChreServerNanoappChannelOutput::setClient(
+    uint32_t nanoappInstanceId) {
+  return setTarget(nanoappInstanceId);
+}
+
+pw::Status ChreServerNanoappChannelOutput::Send(
     pw::span<const std::byte> buffer) {
-  return sendToNanoapp(mServerInstanceId, CHRE_EVENT_RPC_REQUEST, buffer);
+  // The permission is not enforced across nanoapps but we still need to
+  // reset the value as it is only applicable to the next message.
+  mPermission.getAndReset();
+
+  return ChreNanoappChannelOutput::Send(buffer);
+}
+
+pw::Status ChreClientNanoappChannelOutput::setServer(uint32_t instanceId) {
+  return setTarget(instanceId);
 }
 
 void ChreServerHostChannelOutput::setHostEndpoint(uint16_t hostEndpoint) {
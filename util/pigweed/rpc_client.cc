@@ -58,15 +58,22 @@ bool RpcClient::hasService(uint64_t id, uint32_t version) {
   return false;
 }
 
+void RpcClient::startBatch() {
+  mChannelOutput.startBatch();
+}
+
+bool RpcClient::flushBatch() {
+  return mChannelOutput.flushBatch().ok();
+}
+
 void RpcClient::close() {
   chreConfigureNanoappInfoEvents(false);
+  mChannelOutput.releaseBuffers();
 }
 
 bool RpcClient::handleMessageFromServer(uint32_t senderInstanceId,
                                         const void *eventData) {
   auto data = static_cast<const chre::ChrePigweedNanoappMessage *>(eventData);
-  pw::span packet(reinterpret_cast<const std::byte *>(data->msg),
-                  data->msgSize);
   struct chreNanoappInfo info;
 
   if (!chreGetNanoappInfoByAppId(mServerNanoappId, &info) ||
@@ -78,14 +85,24 @@ bool RpcClient::handleMessageFromServer(uint32_t senderInstanceId,
     return false;
   }
 
-  pw::Status status = mRpcClient.ProcessPacket(packet);
+  size_t offset = 0;
+  pw::span<const std::byte> packet;
+  bool success = true;
 
-  if (status != pw::OkStatus()) {
-    LOGE("Failed to process the packet");
-    return false;
+  // Requests issued by the response callbacks to a batch are sent together.
+  // Servers that send single packets may not read batches.
+  bool batch = isNanoappMessageBatch(*data);
+  if (batch) {
+    startBatch();
+  }
+  while (getNextNanoappPacket(*data, &offset, &packet)) {
+    if (mRpcClient.ProcessPacket(packet) != pw::OkStatus()) {
+      LOGE("Failed to process the packet");
+      success = false;
+    }
   }
 
-  return true;
+  return (!batch || flushBatch()) && success && offset == data->msgSize;
 }
 
 void RpcClient::handleNanoappStopped(const void *eventData) {
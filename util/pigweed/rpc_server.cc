@@ -64,13 +64,30 @@ void RpcServer::setPermissionForNextMessage(uint32_t permission) {
   mPermission.set(permission);
 }
 
+void RpcServer::startBatch() {
+  mNanoappOutput.startBatch();
+}
+
+bool RpcServer::flushBatch() {
+  return mNanoappOutput.flushBatch().ok();
+}
+
 bool RpcServer::handleEvent(uint32_t senderInstanceId, uint16_t eventType,
                             const void *eventData) {
   switch (eventType) {
     case CHRE_EVENT_MESSAGE_FROM_HOST:
       return handleMessageFromHost(eventData);
-    case CHRE_EVENT_RPC_REQUEST:
-      return handleMessageFromNanoapp(senderInstanceId, eventData);
+    case CHRE_EVENT_RPC_REQUEST: {
+      // The responses to the packets of a batch are sent together. Clients
+      // that send single packets may not read batches.
+      bool batch = isNanoappMessageBatch(
+          *static_cast<const ChrePigweedNanoappMessage *>(eventData));
+      if (batch) {
+        startBatch();
+      }
+      bool success = handleMessageFromNanoapp(senderInstanceId, eventData);
+      return (!batch || flushBatch()) && success;
+    }
     case CHRE_EVENT_HOST_ENDPOINT_NOTIFICATION:
       handleHostClientNotification(eventData);
       return true;
@@ -89,6 +106,7 @@ void RpcServer::close() {
     chreConfigureHostEndpointNotifications(mConnectedHosts[0], false);
     mConnectedHosts.erase(0);
   }
+  mNanoappOutput.releaseBuffers();
 }
 
 bool RpcServer::handleMessageFromHost(const void *eventData) {
@@ -141,9 +159,19 @@ bool RpcServer::handleMessageFromHost(const void *eventData) {
 bool RpcServer::handleMessageFromNanoapp(uint32_t senderInstanceId,
                                          const void *eventData) {
   const auto data = static_cast<const ChrePigweedNanoappMessage *>(eventData);
-  pw::span packet(reinterpret_cast<const std::byte *>(data->msg),
-                  data->msgSize);
+  size_t offset = 0;
+  pw::span<const std::byte> packet;
+  bool success = true;
+
+  while (getNextNanoappPacket(*data, &offset, &packet)) {
+    success &= handleNanoappPacket(senderInstanceId, packet);
+  }
+
+  return success && offset == data->msgSize;
+}
 
+bool RpcServer::handleNanoappPacket(uint32_t senderInstanceId,
+                                    pw::span<const std::byte> packet) {
   pw::Result<uint32_t> result = pw::rpc::ExtractChannelId(packet);
   if (result.status() != PW_STATUS_OK) {
     LOGE("Unable to extract channel ID from packet");
@@ -156,7 +184,13 @@ bool RpcServer::handleMessageFromNanoapp(uint32_t senderInstanceId,
 
   chreConfigureNanoappInfoEvents(true);
 
-  mNanoappOutput.setClient(senderInstanceId);
+  // The packet is handled even if the responses buffered for the previous
+  // client could not be sent, the failure being reported.
+  bool success = mNanoappOutput.setClient(senderInstanceId).ok();
+  if (!success) {
+    LOGE("Failed to send the responses to the previous client");
+  }
+
   pw::Status status = mServer.OpenChannel(result.value(), mNanoappOutput);
   if (status != pw::OkStatus() && status != pw::Status::AlreadyExists()) {
     LOGE("Failed to open channel");
@@ -169,7 +203,7 @@ bool RpcServer::handleMessageFromNanoapp(uint32_t senderInstanceId,
     return false;
   }
 
-  return true;
+  return success;
 }
 
 void RpcServer::handleHostClientNotification(const void *eventData) {
@@ -34,10 +34,12 @@ void DebugDumpWrapper::printVaList(const char *formatStr, va_list argList) {
   va_list argListCopy;
   va_copy(argListCopy, argList);
 
+  bool success = false;
   if (mCurrBuff != nullptr || allocNewBuffer()) {
     bool sizeValid;
     size_t sizeOfStr;
-    if (!insertString(formatStr, argList, &sizeValid, &sizeOfStr)) {
+    success = insertString(formatStr, argList, &sizeValid, &sizeOfStr);
+    if (!success) {
       if (!sizeValid) {
         LOGE("Error inserting string into buffer in debug dump");
       } else if (sizeOfStr >= kBuffSize) {
@@ -47,27 +49,82 @@ void DebugDumpWrapper::printVaList(const char *formatStr, va_list argList) {
       } else if (allocNewBuffer()) {
         // Insufficient space left in buffer, allocate a new one and it's
         // guaranteed to succeed.
-        bool success =
-            insertString(formatStr, argListCopy, &sizeValid, &sizeOfStr);
+        success = insertString(formatStr, argListCopy, &sizeValid, &sizeOfStr);
         CHRE_ASSERT(success);
       }
     }
   }
+
+  if (!success && isStreaming()) {
+    mNumDroppedStrings++;
+  }
   va_end(argListCopy);
 }
 
+bool DebugDumpWrapper::flush() {
+  if (isStreaming()) {
+    if (mCurrBuff != nullptr && mBuffPos > 0) {
+      mFullBuffers.push_back(mCurrBuff);
+      mCurrBuff = nullptr;
+    }
+    flushFullBuffers();
+  }
+  return mFullBuffers.empty();
+}
+
 bool DebugDumpWrapper::allocNewBuffer() {
-  mCurrBuff = static_cast<char *>(memoryAlloc(kBuffSize));
-  if (mCurrBuff == nullptr) {
-    LOG_OOM();
+  char *reusedBuffer = nullptr;
+  if (isStreaming()) {
+    // The queues have room for all the buffers, see below.
+    if (mCurrBuff != nullptr) {
+      mFullBuffers.push_back(mCurrBuff);
+      mCurrBuff = nullptr;
+    }
+    flushFullBuffers();
+
+    if (!mFreeBuffers.empty()) {
+      reusedBuffer = mFreeBuffers.back();
+      mFreeBuffers.pop_back();
+    } else if (mBuffers.size() >= mMaxBuffers) {
+      return false;
+    } else if (!mFreeBuffers.reserve(mMaxBuffers) ||
+               !mFullBuffers.reserve(mMaxBuffers)) {
+      LOG_OOM();
+      return false;
+    }
+  }
+
+  if (reusedBuffer != nullptr) {
+    mCurrBuff = reusedBuffer;
   } else {
-    mBuffers.emplace_back(mCurrBuff);
+    mCurrBuff = static_cast<char *>(memoryAlloc(kBuffSize));
+    if (mCurrBuff == nullptr) {
+      LOG_OOM();
+    } else {
+      mBuffers.emplace_back(mCurrBuff);
+    }
+  }
+
+  if (mCurrBuff != nullptr) {
     mBuffPos = 0;
     mCurrBuff[0] = '\0';
   }
   return mCurrBuff != nullptr;
 }
 
+void DebugDumpWrapper::flushFullBuffers() {
+  size_t numConsumed = 0;
+  while (numConsumed < mFullBuffers.size() &&
+         mFlushCallback(mFullBuffers[numConsumed], mFlushCookie)) {
+    mFreeBuffers.push_back(mFullBuffers[numConsumed]);
+    numConsumed++;
+  }
+
+  for (; numConsumed > 0; numConsumed--) {
+    mFullBuffers.erase(0);
+  }
+}
+
 bool DebugDumpWrapper::insertString(const char *formatStr, va_list argList,
                                     bool *sizeValid, size_t *sizeOfStr) {
   CHRE_ASSERT(mCurrBuff != nullptr);
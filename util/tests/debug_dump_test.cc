@@ -17,6 +17,9 @@
 #include "gtest/gtest.h"
 
 #include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include "chre/util/system/debug_dump.h"
 
@@ -153,3 +156,96 @@ TEST(DebugDumpWrapper, PrintVaListTwoStrings) {
   strcat(bothStr, str2);
   EXPECT_TRUE(strcmp(buffers.front().get(), bothStr) == 0);
 }
+
+//! Collects the buffers flushed by a streaming DebugDumpWrapper.
+struct FlushedBuffers {
+  std::vector<std::string> buffers;
+  bool accept = true;
+
+  static bool flush(const char *buffer, void *cookie) {
+    auto *flushed = static_cast<FlushedBuffers *>(cookie);
+    if (flushed->accept) {
+      flushed->buffers.push_back(buffer);
+    }
+    return flushed->accept;
+  }
+};
+
+TEST(DebugDumpWrapper, StreamingFlushesBuffersInOrder) {
+  FlushedBuffers flushed;
+  DebugDumpWrapper debugDump(5, 2, FlushedBuffers::flush, &flushed);
+  debugDump.print("%s", "ab");
+  debugDump.print("%s", "cd");
+  EXPECT_TRUE(flushed.buffers.empty());
+
+  debugDump.print("%s", "ef");
+  ASSERT_EQ(flushed.buffers.size(), 1);
+  EXPECT_EQ(flushed.buffers[0], "abcd");
+
+  EXPECT_TRUE(debugDump.flush());
+  ASSERT_EQ(flushed.buffers.size(), 2);
+  EXPECT_EQ(flushed.buffers[1], "ef");
+
+  // An empty buffer is not flushed.
+  EXPECT_TRUE(debugDump.flush());
+  EXPECT_EQ(flushed.buffers.size(), 2);
+}
+
+TEST(DebugDumpWrapper, StreamingMemoryIsBounded) {
+  FlushedBuffers flushed;
+  constexpr size_t kMaxBuffers = 2;
+  DebugDumpWrapper debugDump(kStandardBufferSize, kMaxBuffers,
+                             FlushedBuffers::flush, &flushed);
+  const char *str = "aaaaaaaaa";
+  // 120000 chars, that would take 30 buffers without streaming.
+  constexpr size_t kNumPrints = 12000;
+  size_t maxNumBuffers = 0;
+  for (size_t i = 0; i < kNumPrints; i++) {
+    debugDump.print("%s", str);
+    maxNumBuffers = std::max(maxNumBuffers, debugDump.getBuffers().size());
+  }
+  EXPECT_TRUE(debugDump.flush());
+
+  // The buffers are consumed synchronously, so a single one is reused.
+  EXPECT_LE(maxNumBuffers, kMaxBuffers);
+  EXPECT_EQ(maxNumBuffers, 1);
+  size_t numChars = 0;
+  for (const std::string &buffer : flushed.buffers) {
+    EXPECT_LT(buffer.size(), kStandardBufferSize);
+    numChars += buffer.size();
+  }
+  EXPECT_EQ(numChars, kNumPrints * strlen(str));
+  EXPECT_EQ(debugDump.getNumDroppedStrings(), 0);
+}
+
+TEST(DebugDumpWrapper, StreamingDropsStringsWhenBuffersAreNotConsumed) {
+  FlushedBuffers flushed;
+  flushed.accept = false;
+  DebugDumpWrapper debugDump(4, 2, FlushedBuffers::flush, &flushed);
+  debugDump.print("%s", "ab");
+  debugDump.print("%s", "cd");
+  // Both buffers wait to be consumed.
+  debugDump.print("%s", "ef");
+  debugDump.print("%s", "gh");
+  EXPECT_EQ(debugDump.getBuffers().size(), 2);
+  EXPECT_EQ(debugDump.getNumDroppedStrings(), 2);
+  EXPECT_FALSE(debugDump.flush());
+  EXPECT_TRUE(flushed.buffers.empty());
+
+  flushed.accept = true;
+  EXPECT_TRUE(debugDump.flush());
+  ASSERT_EQ(flushed.buffers.size(), 2);
+  EXPECT_EQ(flushed.buffers[0], "ab");
+  EXPECT_EQ(flushed.buffers[1], "cd");
+
+  // The consumed buffers are reused.
+  debugDump.print("%s", "ij");
+  EXPECT_TRUE(debugDump.flush());
+  EXPECT_EQ(debugDump.getBuffers().size(), 2);
+  ASSERT_EQ(flushed.buffers.size(), 3);
+  EXPECT_EQ(flushed.buffers[2], "ij");
+
+  debugDump.clear();
+  EXPECT_EQ(debugDump.getBuffers().size(), 0);
+  EXPECT_EQ(debugDump.getNumDroppedStrings(), 0);
+}
@@ -25,7 +25,7 @@ using chre::platform_linux::SystemTimeOverride;
 namespace chre {
 
 constexpr Nanoseconds kTimeout = Nanoseconds(100);
-constexpr uint32_t kNumMessages = 100;
+constexpr uint32_t kNumMessages = DuplicateMessageDetector::kMaxRecords;
 
 TEST(DuplicateMessageDetectorTest, AddMessageCanBeFound) {
   DuplicateMessageDetector duplicateMessageDetector(kTimeout);
@@ -98,4 +98,58 @@ TEST(DuplicateMessageDetectorTest, RemoveOldEntriesDoesNotRemoveRecentEntries) {
   }
 }
 
+TEST(DuplicateMessageDetectorTest, FullDetectorRejectsNewMessages) {
+  DuplicateMessageDetector duplicateMessageDetector(kTimeout);
+  SystemTimeOverride override(0);
+
+  // The same sequence numbers with different host endpoints are different
+  // messages
+  for (size_t i = 0; i < kNumMessages; ++i) {
+    bool isDuplicate = true;
+    EXPECT_FALSE(duplicateMessageDetector.findOrAdd(i / 2, i % 2, &isDuplicate)
+                     .has_value());
+    EXPECT_FALSE(isDuplicate);
+  }
+
+  bool isDuplicate = false;
+  Optional<chreError> error = duplicateMessageDetector.findOrAdd(
+      kNumMessages, /*hostEndpoint=*/0, &isDuplicate);
+  ASSERT_TRUE(error.has_value());
+  EXPECT_EQ(error.value(), CHRE_ERROR_NO_MEMORY);
+  EXPECT_TRUE(isDuplicate);
+
+  // No record was dropped
+  for (size_t i = 0; i < kNumMessages; ++i) {
+    EXPECT_TRUE(duplicateMessageDetector.findAndSetError(i / 2, i % 2,
+                                                         CHRE_ERROR_NONE));
+  }
+  EXPECT_FALSE(duplicateMessageDetector.findAndSetError(
+      kNumMessages, /*hostEndpoint=*/0, CHRE_ERROR_NONE));
+}
+
+TEST(DuplicateMessageDetectorTest, FullDetectorReusesTimedOutRecords) {
+  DuplicateMessageDetector duplicateMessageDetector(kTimeout);
+
+  for (size_t i = 0; i < kNumMessages; ++i) {
+    SystemTimeOverride override(i);
+    EXPECT_FALSE(duplicateMessageDetector.findOrAdd(i, i).has_value());
+  }
+
+  // Only the record of the first message has timed out
+  SystemTimeOverride override(kTimeout);
+  bool isDuplicate = true;
+  EXPECT_FALSE(duplicateMessageDetector
+                   .findOrAdd(kNumMessages, kNumMessages, &isDuplicate)
+                   .has_value());
+  EXPECT_FALSE(isDuplicate);
+
+  EXPECT_FALSE(duplicateMessageDetector.findAndSetError(0, 0, CHRE_ERROR_NONE));
+  for (size_t i = 1; i <= kNumMessages; ++i) {
+    EXPECT_TRUE(duplicateMessageDetector.findAndSetError(i, i,
+                                                         CHRE_ERROR_NONE));
+  }
+  EXPECT_TRUE(
+      duplicateMessageDetector.findOrAdd(kNumMessages + 1, 0).has_value());
+}
+
 }  // namespace chre
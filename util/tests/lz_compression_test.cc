@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "chre/util/lz_compression.h"
+
+using ::chre::lzDecompress;
+using ::chre::LzCompressor;
+
+namespace {
+
+std::vector<uint8_t> roundTrip(const std::vector<uint8_t> &input,
+                               size_t *compressedSize) {
+  LzCompressor compressor;
+  std::vector<uint8_t> compressed(input.size() + input.size() / 255 + 16);
+  *compressedSize = compressor.compress(input.data(), input.size(),
+                                        compressed.data(), compressed.size());
+  EXPECT_GT(*compressedSize, 0);
+
+  std::vector<uint8_t> output(input.size());
+  size_t decompressedSize = 0;
+  EXPECT_TRUE(lzDecompress(compressed.data(), *compressedSize, output.data(),
+                           output.size(), &decompressedSize));
+  output.resize(decompressedSize);
+  return output;
+}
+
+std::vector<uint8_t> toBytes(const std::string &string) {
+  return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+}  // namespace
+
+TEST(LzCompression, RoundTripsShortInputs) {
+  for (const char *string : {"a", "abcd", "hello world", "aaaaaaaaaaaaa"}) {
+    size_t compressedSize;
+    std::vector<uint8_t> input = toBytes(string);
+    EXPECT_EQ(roundTrip(input, &compressedSize), input);
+  }
+}
+
+TEST(LzCompression, CompressesRepetitiveInput) {
+  std::string string;
+  for (int i = 0; i < 100; i++) {
+    string += "[WIFI] Scan request from nanoapp " + std::to_string(i % 7) +
+              " accepted\n";
+  }
+  std::vector<uint8_t> input = toBytes(string);
+
+  size_t compressedSize;
+  EXPECT_EQ(roundTrip(input, &compressedSize), input);
+  EXPECT_LT(compressedSize, input.size() / 4);
+}
+
+TEST(LzCompression, RoundTripsLongRunsAndLiterals) {
+  // Literal and match lengths above 15 + 255 exercise the extra length bytes.
+  std::vector<uint8_t> input(1000, 'x');
+  std::mt19937 random(42);
+  for (int i = 0; i < 600; i++) {
+    input.push_back(static_cast<uint8_t>(random()));
+  }
+  input.insert(input.end(), 700, 'y');
+
+  size_t compressedSize;
+  EXPECT_EQ(roundTrip(input, &compressedSize), input);
+}
+
+TEST(LzCompression, RoundTripsIncompressibleInput) {
+  std::vector<uint8_t> input(4096);
+  std::mt19937 random(7);
+  for (uint8_t &byte : input) {
+    byte = static_cast<uint8_t>(random());
+  }
+
+  size_t compressedSize;
+  EXPECT_EQ(roundTrip(input, &compressedSize), input);
+  EXPECT_GT(compressedSize, input.size());
+}
+
+TEST(LzCompression, CompressFailsWhenOutputDoesNotFit) {
+  LzCompressor compressor;
+  std::vector<uint8_t> input = toBytes("no repetition in this string");
+  uint8_t output[8];
+  EXPECT_EQ(compressor.compress(input.data(), input.size(), output,
+                                sizeof(output)),
+            0);
+  EXPECT_EQ(compressor.compress(input.data(), 0, output, sizeof(output)), 0);
+
+  std::vector<uint8_t> largeInput(LzCompressor::kMaxInputSize + 1);
+  std::vector<uint8_t> largeOutput(largeInput.size() * 2);
+  EXPECT_EQ(compressor.compress(largeInput.data(), largeInput.size(),
+                                largeOutput.data(), largeOutput.size()),
+            0);
+}
+
+TEST(LzCompression, DecodesKnownBlock) {
+  // "abcabcabcabcabcabcabcabcabcabc!!!!!": 3 literals, then a 27 byte match at
+  // offset 3, then 5 final literals.
+  const uint8_t block[] = {0x3f, 'a', 'b', 'c', 0x03, 0x00, 0x08,
+                           0x50, '!', '!', '!', '!', '!'};
+  uint8_t output[64];
+  size_t decompressedSize;
+  ASSERT_TRUE(lzDecompress(block, sizeof(block), output, sizeof(output),
+                           &decompressedSize));
+  EXPECT_EQ(std::string(reinterpret_cast<char *>(output), decompressedSize),
+            "abcabcabcabcabcabcabcabcabcabc!!!!!");
+}
+
+TEST(LzCompression, DecompressRejectsMalformedInput) {
+  uint8_t output[64];
+  size_t decompressedSize;
+
+  // The offset points before the start of the output.
+  const uint8_t badOffset[] = {0x10, 'a', 0x02, 0x00, 0x00};
+  EXPECT_FALSE(lzDecompress(badOffset, sizeof(badOffset), output,
+                            sizeof(output), &decompressedSize));
+
+  // The literals run past the end of the input.
+  const uint8_t truncated[] = {0x50, 'a', 'b'};
+  EXPECT_FALSE(lzDecompress(truncated, sizeof(truncated), output,
+                            sizeof(output), &decompressedSize));
+
+  // The output does not fit.
+  const uint8_t longMatch[] = {0x1f, 'a', 0x01, 0x00, 0xff, 0x10};
+  EXPECT_FALSE(lzDecompress(longMatch, sizeof(longMatch), output,
+                            sizeof(output), &decompressedSize));
+}
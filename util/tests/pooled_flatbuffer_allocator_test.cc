@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/system/pooled_flatbuffer_allocator.h"
+
+#include <cstring>
+#include <vector>
+
+#include "chre/platform/shared/generated/host_messages_generated.h"
+#include "chre/util/flatbuffers/helpers.h"
+#include "gtest/gtest.h"
+
+using chre::ChreFlatBufferBuilder;
+using chre::FixedBufferFlatBufferAllocator;
+using chre::FlatBufferAllocator;
+using chre::PooledFlatBufferAllocator;
+
+namespace {
+
+//! Counts the allocations that reach the heap.
+class CountingHeapAllocator : public FlatBufferAllocator {
+ public:
+  uint8_t *allocate(size_t size) override {
+    mNumAllocations++;
+    return FlatBufferAllocator::allocate(size);
+  }
+
+  size_t mNumAllocations = 0;
+};
+
+// Sizes matching the host links.
+constexpr size_t kSmallBufferSize = 256;
+constexpr size_t kNumSmallBuffers = 8;
+constexpr size_t kMaxMessageSize = 4096;
+constexpr size_t kLargeBufferSize = kMaxMessageSize + 256;
+
+//! Encodes a nanoapp message the way the host links do.
+void encodeNanoappMessage(ChreFlatBufferBuilder &builder, size_t payloadSize) {
+  std::vector<uint8_t> payload(payloadSize, 0xab);
+  auto message = chre::fbs::CreateNanoappMessage(
+      builder, 0x0123456789abcdef /* appId */, 1 /* messageType */,
+      0xfffe /* hostEndpoint */,
+      builder.CreateVector(payload.data(), payload.size()));
+  chre::fbs::HostAddress hostAddr(0);
+  builder.Finish(chre::fbs::CreateMessageContainer(
+      builder, chre::fbs::ChreMessage::NanoappMessage, message.Union(),
+      &hostAddr));
+}
+
+//! Encodes a log message the way the host links do.
+void encodeLogMessage(ChreFlatBufferBuilder &builder, size_t logSize) {
+  std::vector<int8_t> logs(logSize, 'l');
+  auto message = chre::fbs::CreateLogMessageV2(
+      builder, builder.CreateVector(logs.data(), logs.size()),
+      0 /* numLogsDropped */);
+  chre::fbs::HostAddress hostAddr(0);
+  builder.Finish(chre::fbs::CreateMessageContainer(
+      builder, chre::fbs::ChreMessage::LogMessageV2, message.Union(),
+      &hostAddr));
+}
+
+bool isValidMessage(const uint8_t *message, size_t size) {
+  flatbuffers::Verifier verifier(message, size);
+  return chre::fbs::VerifyMessageContainerBuffer(verifier);
+}
+
+}  // namespace
+
+TEST(PooledFlatBufferAllocator, PooledMessagesDoNotReachTheHeap) {
+  constexpr size_t kNumMessages = 100;
+  constexpr size_t kNanoappMessageInitialSize = 88 + 32;
+  constexpr size_t kLogSize = kMaxMessageSize - 128;
+  constexpr size_t kLogMessageInitialSize = 128 + kLogSize;
+
+  CountingHeapAllocator heapAllocator;
+  for (size_t i = 0; i < kNumMessages; i++) {
+    ChreFlatBufferBuilder builder(kNanoappMessageInitialSize, &heapAllocator);
+    encodeNanoappMessage(builder, 32);
+  }
+  size_t heapNanoappAllocations = heapAllocator.mNumAllocations;
+  heapAllocator.mNumAllocations = 0;
+  for (size_t i = 0; i < kNumMessages; i++) {
+    ChreFlatBufferBuilder builder(kLogMessageInitialSize, &heapAllocator);
+    encodeLogMessage(builder, kLogSize);
+  }
+  size_t heapLogAllocations = heapAllocator.mNumAllocations;
+
+  CountingHeapAllocator fallbackAllocator;
+  PooledFlatBufferAllocator<kLargeBufferSize, 1> largeBufferAllocator(
+      &fallbackAllocator);
+  PooledFlatBufferAllocator<kSmallBufferSize, kNumSmallBuffers>
+      allocator(&largeBufferAllocator);
+  for (size_t i = 0; i < kNumMessages; i++) {
+    ChreFlatBufferBuilder builder(kNanoappMessageInitialSize, &allocator);
+    encodeNanoappMessage(builder, 32);
+    EXPECT_TRUE(isValidMessage(builder.GetBufferPointer(), builder.GetSize()));
+  }
+  size_t pooledNanoappAllocations = fallbackAllocator.mNumAllocations;
+  for (size_t i = 0; i < kNumMessages; i++) {
+    ChreFlatBufferBuilder builder(kLogMessageInitialSize, &allocator);
+    encodeLogMessage(builder, kLogSize);
+    EXPECT_TRUE(isValidMessage(builder.GetBufferPointer(), builder.GetSize()));
+  }
+  size_t pooledLogAllocations =
+      fallbackAllocator.mNumAllocations - pooledNanoappAllocations;
+
+  EXPECT_GE(heapNanoappAllocations, kNumMessages);
+  EXPECT_GE(heapLogAllocations, kNumMessages);
+  EXPECT_EQ(pooledNanoappAllocations, 0);
+  EXPECT_EQ(pooledLogAllocations, 0);
+  EXPECT_EQ(allocator.getFreeBlockCount(), kNumSmallBuffers);
+  EXPECT_EQ(largeBufferAllocator.getFreeBlockCount(), 1);
+}
+
+TEST(PooledFlatBufferAllocator, FallsBackWhenPoolIsExhausted) {
+  CountingHeapAllocator fallbackAllocator;
+  PooledFlatBufferAllocator<kSmallBufferSize, 2> allocator(&fallbackAllocator);
+
+  uint8_t *first = allocator.allocate(kSmallBufferSize);
+  uint8_t *second = allocator.allocate(16);
+  EXPECT_EQ(fallbackAllocator.mNumAllocations, 0);
+  EXPECT_EQ(allocator.getFreeBlockCount(), 0);
+
+  uint8_t *third = allocator.allocate(16);
+  uint8_t *large = allocator.allocate(kSmallBufferSize + 1);
+  EXPECT_EQ(fallbackAllocator.mNumAllocations, 2);
+
+  for (uint8_t *buffer : {first, second, third, large}) {
+    ASSERT_NE(buffer, nullptr);
+    allocator.deallocate(buffer, 0);
+  }
+  EXPECT_EQ(allocator.getFreeBlockCount(), 2);
+}
+
+TEST(FixedBufferFlatBufferAllocator, EncodesInPlace) {
+  uint8_t txBuffer[300];
+  CountingHeapAllocator fallbackAllocator;
+  FixedBufferFlatBufferAllocator allocator(txBuffer, sizeof(txBuffer),
+                                           &fallbackAllocator);
+  ChreFlatBufferBuilder builder(allocator.getMaxInitialBuilderSize(),
+                                &allocator);
+  encodeNanoappMessage(builder, 64);
+
+  EXPECT_EQ(fallbackAllocator.mNumAllocations, 0);
+  EXPECT_GE(builder.GetBufferPointer(), txBuffer);
+  EXPECT_EQ(builder.GetBufferPointer() + builder.GetSize(),
+            txBuffer + allocator.getMaxInitialBuilderSize());
+
+  size_t size = builder.GetSize();
+  memmove(txBuffer, builder.GetBufferPointer(), size);
+  EXPECT_TRUE(isValidMessage(txBuffer, size));
+}
+
+TEST(FixedBufferFlatBufferAllocator, FallsBackWhenMessageDoesNotFit) {
+  uint8_t txBuffer[128];
+  CountingHeapAllocator fallbackAllocator;
+  FixedBufferFlatBufferAllocator allocator(txBuffer, sizeof(txBuffer),
+                                           &fallbackAllocator);
+  ChreFlatBufferBuilder builder(allocator.getMaxInitialBuilderSize(),
+                                &allocator);
+  encodeNanoappMessage(builder, 200);
+
+  EXPECT_GT(fallbackAllocator.mNumAllocations, 0);
+  EXPECT_TRUE(isValidMessage(builder.GetBufferPointer(), builder.GetSize()));
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/sequence_number_index.h"
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace chre {
+namespace {
+
+TEST(SequenceNumberIndex, InsertFindErase) {
+  SequenceNumberIndex<4> index;
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_EQ(index.find(1), nullptr);
+
+  EXPECT_TRUE(index.insert(1, 10));
+  EXPECT_TRUE(index.insert(2, 20));
+  EXPECT_EQ(index.size(), 2);
+  ASSERT_NE(index.find(1), nullptr);
+  EXPECT_EQ(*index.find(1), 10);
+  ASSERT_NE(index.find(2), nullptr);
+  EXPECT_EQ(*index.find(2), 20);
+  EXPECT_EQ(index.find(3), nullptr);
+
+  EXPECT_FALSE(index.erase(1, 20));
+  EXPECT_TRUE(index.erase(1, 10));
+  EXPECT_FALSE(index.erase(1, 10));
+  EXPECT_EQ(index.find(1), nullptr);
+  EXPECT_EQ(index.size(), 1);
+
+  *index.find(2) = 21;
+  EXPECT_EQ(*index.find(2), 21);
+
+  index.clear();
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_EQ(index.find(2), nullptr);
+}
+
+TEST(SequenceNumberIndex, DuplicateSequenceNumbers) {
+  SequenceNumberIndex<4> index;
+  EXPECT_TRUE(index.insert(7, 1));
+  EXPECT_TRUE(index.insert(7, 2));
+  EXPECT_TRUE(index.insert(7, 3));
+
+  const uint16_t *value =
+      index.find(7, [](const uint16_t &entry) { return entry == 2; });
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 2);
+  EXPECT_EQ(index.find(7, [](const uint16_t &entry) { return entry == 4; }),
+            nullptr);
+
+  EXPECT_TRUE(index.erase(7, 2));
+  EXPECT_EQ(index.find(7, [](const uint16_t &entry) { return entry == 2; }),
+            nullptr);
+  EXPECT_NE(index.find(7, [](const uint16_t &entry) { return entry == 1; }),
+            nullptr);
+  EXPECT_NE(index.find(7, [](const uint16_t &entry) { return entry == 3; }),
+            nullptr);
+}
+
+TEST(SequenceNumberIndex, Full) {
+  SequenceNumberIndex<3> index;
+  EXPECT_TRUE(index.insert(0, 0));
+  EXPECT_TRUE(index.insert(1, 1));
+  EXPECT_TRUE(index.insert(2, 2));
+  EXPECT_TRUE(index.full());
+  EXPECT_FALSE(index.insert(3, 3));
+  EXPECT_EQ(index.find(3), nullptr);
+
+  EXPECT_TRUE(index.erase(1, 1));
+  EXPECT_FALSE(index.full());
+  EXPECT_TRUE(index.insert(3, 3));
+  EXPECT_EQ(*index.find(3), 3);
+}
+
+TEST(SequenceNumberIndex, MatchesMultimapUnderRandomOperations) {
+  constexpr size_t kMaxEntries = 64;
+  SequenceNumberIndex<kMaxEntries> index;
+  std::multimap<uint32_t, uint16_t> reference;
+  std::mt19937 random(1234);
+
+  for (uint16_t i = 0; i < 20000; ++i) {
+    // Mostly consecutive sequence numbers, as they are in practice, with a
+    // few repeated and a few far apart ones
+    uint32_t sequenceNumber = (random() % 8 == 0) ? random() : i / 2;
+    if (reference.size() < kMaxEntries && random() % 2 == 0) {
+      EXPECT_TRUE(index.insert(sequenceNumber, i));
+      reference.emplace(sequenceNumber, i);
+    } else if (!reference.empty()) {
+      auto it = reference.begin();
+      std::advance(it, random() % reference.size());
+      EXPECT_TRUE(index.erase(it->first, it->second));
+      reference.erase(it);
+    }
+    ASSERT_EQ(index.size(), reference.size());
+  }
+
+  for (const auto &[sequenceNumber, value] : reference) {
+    uint16_t expected = value;
+    EXPECT_NE(index.find(sequenceNumber,
+                         [expected](const uint16_t &entry) {
+                           return entry == expected;
+                         }),
+              nullptr);
+  }
+  EXPECT_EQ(index.find(UINT32_MAX), nullptr);
+}
+
+}  // namespace
+}  // namespace chre
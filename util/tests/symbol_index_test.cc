@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/symbol_index.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using chre::SymbolIndex;
+
+namespace {
+
+struct Entry {
+  void *data;
+  const char *dataName;
+};
+
+// A subset of the symbols exported to nanoapps.
+const char *const kExportedNames[] = {
+    "asin",
+    "atan2",
+    "cos",
+    "floor",
+    "ceil",
+    "fmax",
+    "fmin",
+    "frexp",
+    "round",
+    "sin",
+    "sqrt",
+    "acosf",
+    "asinf",
+    "atan2f",
+    "ceilf",
+    "cosf",
+    "expf",
+    "fabsf",
+    "floorf",
+    "fmaxf",
+    "fminf",
+    "fmodf",
+    "log10f",
+    "log1pf",
+    "log2f",
+    "logf",
+    "lrintf",
+    "lroundf",
+    "powf",
+    "remainderf",
+    "roundf",
+    "sinf",
+    "sqrtf",
+    "tanf",
+    "tanhf",
+    "__cxa_pure_virtual",
+    "__cxa_atexit",
+    "atexit",
+    "_ZdlPvj",
+    "dlsym",
+    "isgraph",
+    "memcmp",
+    "memcpy",
+    "memmove",
+    "memset",
+    "snprintf",
+    "strcmp",
+    "strlen",
+    "strncmp",
+    "tolower",
+    "chreAbort",
+    "chreAudioConfigureSource",
+    "chreAudioGetSource",
+    "chreBleGetCapabilities",
+    "chreBleGetFilterCapabilities",
+    "chreBleFlushAsync",
+    "chreBleStartScanAsync",
+    "chreBleStartScanAsyncV1_9",
+    "chreBleStopScanAsync",
+    "chreBleStopScanAsyncV1_9",
+    "chreBleReadRssiAsync",
+    "chreBleGetScanStatus",
+    "chreConfigureDebugDumpEvent",
+    "chreConfigureHostSleepStateEvents",
+    "chreConfigureNanoappInfoEvents",
+    "chreDebugDumpLog",
+    "chreGetApiVersion",
+    "chreGetCapabilities",
+    "chreGetMessageToHostMaxSize",
+    "chreGetAppId",
+    "chreGetInstanceId",
+    "chreGetEstimatedHostTimeOffset",
+    "chreGetNanoappInfoByAppId",
+    "chreGetNanoappInfoByInstanceId",
+    "chreGetPlatformId",
+    "chreGetSensorInfo",
+    "chreGetSensorSamplingStatus",
+    "chreGetTime",
+    "chreGetVersion",
+    "chreGnssConfigurePassiveLocationListener",
+    "chreGnssGetCapabilities",
+    "chreGnssLocationSessionStartAsync",
+    "chreGnssLocationSessionStopAsync",
+    "chreGnssMeasurementSessionStartAsync",
+    "chreGnssMeasurementSessionStopAsync",
+    "chreHeapAlloc",
+    "chreHeapFree",
+    "chreIsHostAwake",
+    "chreLog",
+    "chreSendEvent",
+    "chreSendMessageToHost",
+    "chreSendMessageToHostEndpoint",
+    "chreSendMessageWithPermissions",
+    "chreSendReliableMessageAsync",
+    "chreSensorConfigure",
+    "chreSensorConfigureBiasEvents",
+    "chreSensorFind",
+    "chreSensorFindDefault",
+    "chreSensorFlushAsync",
+    "chreSensorGetThreeAxisBias",
+    "chreTimerCancel",
+    "chreTimerSet",
+    "chreUserSettingConfigureEvents",
+    "chreUserSettingGetState",
+    "chreWifiConfigureScanMonitorAsync",
+    "chreWifiGetCapabilities",
+    "chreWifiRequestScanAsync",
+    "chreWifiRequestRangingAsync",
+    "chreWifiNanRequestRangingAsync",
+    "chreWifiNanSubscribe",
+    "chreWifiNanSubscribeCancel",
+    "chreWwanGetCapabilities",
+    "chreWwanGetCellInfoAsync",
+    "platform_chreDebugDumpVaLog",
+    "chreConfigureHostEndpointNotifications",
+    "chrePublishRpcServices",
+    "chreGetHostEndpointInfo",
+};
+constexpr size_t kNumExportedNames =
+    sizeof(kExportedNames) / sizeof(kExportedNames[0]);
+
+std::vector<Entry> makeEntries() {
+  std::vector<Entry> entries;
+  for (size_t i = 0; i < kNumExportedNames; i++) {
+    entries.push_back({reinterpret_cast<void *>(i + 1), kExportedNames[i]});
+  }
+  return entries;
+}
+
+//! The lookup NanoappLoader::findExportedSymbol() used to perform.
+const Entry *findLinear(const std::vector<Entry> &entries, const char *name) {
+  size_t nameLen = strlen(name);
+  for (const Entry &entry : entries) {
+    if (nameLen == strlen(entry.dataName) &&
+        strncmp(name, entry.dataName, nameLen) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(SymbolIndex, FindsAllEntries) {
+  std::vector<Entry> entries = makeEntries();
+  SymbolIndex<Entry, kNumExportedNames> index;
+  ASSERT_TRUE(index.add(entries.data(), entries.size()));
+  EXPECT_EQ(index.size(), kNumExportedNames);
+
+  for (const Entry &entry : entries) {
+    EXPECT_EQ(index.find(entry.dataName), &entry);
+  }
+  EXPECT_EQ(index.find("chreNotAnApi"), nullptr);
+  EXPECT_EQ(index.find("chreLo"), nullptr);
+  EXPECT_EQ(index.find("chreLogX"), nullptr);
+  EXPECT_EQ(index.find(""), nullptr);
+}
+
+TEST(SymbolIndex, FirstTableWinsOnDuplicateNames) {
+  Entry core[] = {{reinterpret_cast<void *>(1), "chreLog"},
+                  {reinterpret_cast<void *>(2), "memcpy"}};
+  Entry vendor[] = {{reinterpret_cast<void *>(3), "vendorApi"},
+                    {reinterpret_cast<void *>(4), "chreLog"}};
+  SymbolIndex<Entry, 4> index;
+  ASSERT_TRUE(index.add(core, 2));
+  ASSERT_TRUE(index.add(vendor, 2));
+
+  EXPECT_EQ(index.find("chreLog"), &core[0]);
+  EXPECT_EQ(index.find("vendorApi"), &vendor[0]);
+}
+
+TEST(SymbolIndex, RejectsTablesOverCapacity) {
+  Entry entries[] = {{nullptr, "a"}, {nullptr, "b"}, {nullptr, "c"}};
+  SymbolIndex<Entry, 2> index;
+  EXPECT_FALSE(index.add(entries, 3));
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_TRUE(index.add(entries, 2));
+  EXPECT_FALSE(index.add(&entries[2], 1));
+  EXPECT_EQ(index.find("c"), nullptr);
+}
+
+TEST(SymbolIndex, HashIsComputedAtCompileTime) {
+  using Index = SymbolIndex<Entry, 1>;
+  constexpr uint32_t kHash = Index::hashName("chreLog");
+  static_assert(kHash != Index::hashName("chreLoh"), "");
+  EXPECT_EQ(kHash, Index::hashName(std::string("chreLog").c_str()));
+}
+
+TEST(SymbolIndex, ResolvesRelocationsAsALinearScanDoes) {
+  // The symbols referenced by the relocations of a large nanoapp: each API is
+  // imported through a few relocations, and a few names are resolved against
+  // the nanoapp itself after failing to resolve in the exported symbols.
+  std::vector<std::string> relocations;
+  for (int i = 0; i < 4; i++) {
+    for (size_t j = 0; j < kNumExportedNames; j += 2) {
+      relocations.push_back(kExportedNames[(j * 7 + i) % kNumExportedNames]);
+    }
+    relocations.push_back("_ZN7nanoapp5State6updateEv");
+    relocations.push_back("_ZTVN10__cxxabiv117__class_type_infoE");
+  }
+
+  std::vector<Entry> entries = makeEntries();
+  SymbolIndex<Entry, kNumExportedNames> index;
+  ASSERT_TRUE(index.add(entries.data(), entries.size()));
+  for (const std::string &name : relocations) {
+    EXPECT_EQ(index.find(name.c_str()), findLinear(entries, name.c_str()));
+  }
+}
@@ -16,6 +16,9 @@
 
 #include "chre/util/synchronized_expandable_memory_pool.h"
 
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 using chre::SynchronizedExpandableMemoryPool;
@@ -42,6 +45,51 @@ class ConstructorCount {
 
 ssize_t ConstructorCount::sConstructedCounter = 0;
 
+//! An element the size of an event.
+struct FakeEvent {
+  FakeEvent(uint16_t type_, uint32_t data_) : type(type_), data(data_) {}
+  uint16_t type;
+  uint32_t data;
+  void *pointers[4];
+};
+
+constexpr size_t kEventsPerBlock = 16;
+constexpr size_t kMaxEventBlocks = 4;
+constexpr size_t kInFlight = 8;
+
+/**
+ * Runs producers that each keep a window of events in flight, like the
+ * producers of events posted to the event loop. Each producer frees an event
+ * before allocating the next one, so an allocation must never fail if the
+ * windows of all the producers fit in the pool.
+ */
+template <typename Pool>
+void runProducers(Pool &pool, size_t numThreads, size_t numIterations) {
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; t++) {
+    threads.emplace_back([&pool, t, numIterations]() {
+      FakeEvent *inFlight[kInFlight] = {};
+      for (size_t i = 0; i < numIterations; i++) {
+        FakeEvent *&event = inFlight[i % kInFlight];
+        if (event != nullptr) {
+          EXPECT_EQ(event->data, i - kInFlight);
+          pool.deallocate(event);
+        }
+        event = pool.allocate(static_cast<uint16_t>(t), i);
+        ASSERT_NE(event, nullptr);
+      }
+      for (FakeEvent *event : inFlight) {
+        if (event != nullptr) {
+          pool.deallocate(event);
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
 }  // namespace
 
 TEST(SynchronizedExpandAbleMemoryPool, InitStateTest) {
@@ -102,3 +150,50 @@ TEST(SynchronizedExpandAbleMemoryPool, HysteresisDeallocation) {
   EXPECT_EQ(testMemoryPool.getFreeSpaceCount(), blockSize * maxBlockCount);
   EXPECT_EQ(testMemoryPool.getBlockCount(), staticBlockCount);
 }
+
+TEST(SynchronizedExpandAbleMemoryPool, FindsOwnerAcrossBlocks) {
+  constexpr uint8_t blockSize = 4;
+  constexpr uint8_t maxBlockCount = 4;
+  SynchronizedExpandableMemoryPool<ConstructorCount, blockSize, maxBlockCount>
+      testMemoryPool;
+  ConstructorCount *elements[blockSize * maxBlockCount];
+
+  for (int i = 0; i < blockSize * maxBlockCount; i++) {
+    elements[i] = testMemoryPool.allocate(i);
+    ASSERT_NE(elements[i], nullptr);
+  }
+  EXPECT_TRUE(testMemoryPool.full());
+  EXPECT_EQ(testMemoryPool.allocate(0), nullptr);
+
+  // Free one slot in each block, in the reverse order of the blocks.
+  for (int block = maxBlockCount - 1; block >= 0; block--) {
+    testMemoryPool.deallocate(elements[block * blockSize + 1]);
+  }
+  EXPECT_EQ(testMemoryPool.getFreeSpaceCount(), maxBlockCount);
+  EXPECT_EQ(testMemoryPool.getBlockCount(), maxBlockCount);
+
+  // The slots are reused, the lowest block first.
+  for (int block = 0; block < maxBlockCount; block++) {
+    ConstructorCount *element = testMemoryPool.allocate(100 + block);
+    EXPECT_EQ(element, elements[block * blockSize + 1]);
+    EXPECT_EQ(element->getValue(), 100 + block);
+  }
+  EXPECT_TRUE(testMemoryPool.full());
+
+  for (ConstructorCount *element : elements) {
+    testMemoryPool.deallocate(element);
+  }
+  EXPECT_EQ(ConstructorCount::sConstructedCounter, 0);
+  EXPECT_EQ(testMemoryPool.getBlockCount(), 1);
+}
+
+TEST(SynchronizedExpandAbleMemoryPool, ConcurrentProducers) {
+  SynchronizedExpandableMemoryPool<FakeEvent, kEventsPerBlock, kMaxEventBlocks>
+      pool;
+  // The windows of the producers fill the pool, so an allocation failing
+  // while a slot is free fails the test.
+  constexpr size_t kNumThreads = kEventsPerBlock * kMaxEventBlocks / kInFlight;
+  runProducers(pool, kNumThreads, 20000 /* numIterations */);
+  EXPECT_EQ(pool.getFreeSpaceCount(), kEventsPerBlock * kMaxEventBlocks);
+  EXPECT_EQ(pool.getBlockCount(), 1);
+}
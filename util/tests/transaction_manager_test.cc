@@ -18,6 +18,8 @@
 
 #include <algorithm>
 #include <map>
+#include <random>
+#include <vector>
 
 #include "chre/core/event_loop_common.h"
 #include "chre/core/timer_pool.h"
@@ -348,4 +350,65 @@ TEST_F(TransactionManagerTest, CallbackUsesCorrectGroupId) {
   mFakeTimerPool.invokeNextTimer(mTime);
 }
 
+TEST_F(TransactionManagerTest, ManyTransactionsRemovedInAnyOrder) {
+  constexpr size_t kNumTransactions = 256;
+  constexpr uint16_t kNumGroups = 8;
+  TransactionManager<kNumTransactions, FakeTimerPool> tm(
+      mFakeCb, mFakeTimerPool, kTimeout, kMaxAttempts);
+
+  // Transactions are added round robin to the groups
+  std::vector<uint32_t> ids(kNumTransactions);
+  for (size_t i = 0; i < kNumTransactions; i++) {
+    ASSERT_TRUE(tm.add(i % kNumGroups, &ids[i]));
+  }
+  uint32_t id;
+  EXPECT_FALSE(tm.add(/*groupId=*/0, &id));
+  EXPECT_EQ(tm.size(), kNumTransactions);
+
+  // Only the first transaction of each group started
+  ASSERT_EQ(mFakeCb.mTries.size(), kNumGroups);
+  for (size_t i = 0; i < kNumGroups; i++) {
+    EXPECT_EQ(mFakeCb.mTries[i], ids[i]);
+  }
+
+  // Removing pending transactions in any order does not start anything
+  std::vector<size_t> pending;
+  for (size_t i = kNumGroups; i < kNumTransactions; i++) {
+    if (i % 3 == 0) {
+      pending.push_back(i);
+    }
+  }
+  std::shuffle(pending.begin(), pending.end(), std::mt19937(42));
+  for (size_t i : pending) {
+    EXPECT_TRUE(tm.remove(ids[i]));
+    EXPECT_FALSE(tm.remove(ids[i]));
+  }
+  EXPECT_EQ(mFakeCb.mTries.size(), kNumGroups);
+
+  // Completing the started transactions starts the remaining ones of each
+  // group in the order they were added
+  size_t numRemaining = kNumTransactions - pending.size();
+  EXPECT_EQ(tm.size(), numRemaining);
+  for (size_t i = 0; i < kNumTransactions; i++) {
+    if (i >= kNumGroups && i % 3 == 0) {
+      continue;
+    }
+    EXPECT_NE(std::find(mFakeCb.mTries.begin(), mFakeCb.mTries.end(), ids[i]),
+              mFakeCb.mTries.end());
+    EXPECT_TRUE(tm.remove(ids[i]));
+  }
+  EXPECT_EQ(mFakeCb.mTries.size(), numRemaining);
+  EXPECT_EQ(tm.size(), 0);
+  EXPECT_EQ(mFakeCb.mFailures.size(), 0);
+  EXPECT_FALSE(mFakeTimerPool.invokeNextTimer(mTime));
+
+  // The storage can be reused
+  for (size_t i = 0; i < kNumTransactions; i++) {
+    ASSERT_TRUE(tm.add(/*groupId=*/0, &ids[i]));
+  }
+  for (size_t i = 0; i < kNumTransactions; i++) {
+    EXPECT_TRUE(tm.remove(ids[i]));
+  }
+}
+
 }  // namespace chre
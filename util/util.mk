@@ -14,6 +14,7 @@ COMMON_SRCS += $(CHRE_PREFIX)/util/duplicate_message_detector.cc
 COMMON_SRCS += $(CHRE_PREFIX)/util/dynamic_vector_base.cc
 COMMON_SRCS += $(CHRE_PREFIX)/util/hash.cc
 COMMON_SRCS += $(CHRE_PREFIX)/util/intrusive_list_base.cc
+COMMON_SRCS += $(CHRE_PREFIX)/util/lz_compression.cc
 COMMON_SRCS += $(CHRE_PREFIX)/util/nanoapp/audio.cc
 COMMON_SRCS += $(CHRE_PREFIX)/util/nanoapp/ble.cc
 COMMON_SRCS += $(CHRE_PREFIX)/util/nanoapp/callbacks.cc
@@ -39,20 +40,31 @@ GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/fixed_size_vector_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/heap_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/intrusive_list_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/lock_guard_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/lz_compression_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/memory_pool_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/optional_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/pooled_flatbuffer_allocator_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/priority_queue_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/raw_storage_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/ref_base_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/segmented_queue_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/sequence_number_index_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/shared_ptr_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/singleton_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/stats_container_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/symbol_index_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/synchronized_expandable_memory_pool_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/synchronized_memory_pool_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/time_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/unique_ptr_test.cc
 
+# Benchmark Source Files #######################################################
+
+BENCHMARK_SRCS += $(CHRE_PREFIX)/util/benchmarks/containers_benchmark.cc
+BENCHMARK_SRCS += $(CHRE_PREFIX)/util/benchmarks/memory_pool_benchmark.cc
+BENCHMARK_SRCS += $(CHRE_PREFIX)/util/benchmarks/symbol_index_benchmark.cc
+BENCHMARK_SRCS += $(CHRE_PREFIX)/util/benchmarks/transaction_manager_benchmark.cc
+
 # Pigweed Source Files #########################################################
 
 PIGWEED_UTIL_SRCS += $(CHRE_PREFIX)/util/pigweed/chre_channel_output.cc
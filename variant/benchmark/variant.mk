@@ -0,0 +1,18 @@
+#
+# Benchmark-Specific Makefile
+#
+
+# Build Configuration ##########################################################
+
+# The benchmarks measure an optimized build without assertions, as shipped.
+OPT_LEVEL = 2
+CHRE_ASSERTIONS_ENABLED = false
+
+# Optional Features ############################################################
+
+CHRE_BLE_SUPPORT_ENABLED = true
+CHRE_GNSS_SUPPORT_ENABLED = true
+CHRE_SENSORS_SUPPORT_ENABLED = true
+CHRE_WIFI_SUPPORT_ENABLED = true
+CHRE_WIFI_NAN_SUPPORT_ENABLED = true
+CHRE_WWAN_SUPPORT_ENABLED = true